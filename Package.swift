@@ -9,7 +9,10 @@ let package = Package(
     products: [
         .library(
             name: "ZXingCpp",
-            targets: ["ZXingCpp"])
+            targets: ["ZXingCpp"]),
+        .library(
+            name: "ZXingCppAsync",
+            targets: ["ZXingCppAsync"])
     ],
     targets: [
         .target(
@@ -23,10 +26,17 @@ let package = Package(
             path: "wrappers/ios/Sources/Wrapper",
             publicHeadersPath: ".",
             linkerSettings: [
+                .linkedFramework("AVFoundation"),
                 .linkedFramework("CoreGraphics"),
                 .linkedFramework("CoreImage"),
+                .linkedFramework("CoreMedia"),
                 .linkedFramework("CoreVideo")
             ]
+        ),
+        .target(
+            name: "ZXingCppAsync",
+            dependencies: ["ZXingCpp"],
+            path: "wrappers/ios/Sources/Async"
         )
     ],
     cxxLanguageStandard: CXXLanguageStandard.gnucxx20
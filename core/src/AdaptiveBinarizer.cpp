@@ -0,0 +1,93 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AdaptiveBinarizer.h"
+
+#include "BitMatrix.h"
+#include "TraceScope.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ZXing {
+
+// A pixel is black if it is at least THRESHOLD_PERCENT percent darker than the mean of its neighborhood. The window is
+// WINDOW_DIVISOR times smaller than the larger image dimension, but at least MIN_WINDOW pixels wide.
+static constexpr int THRESHOLD_PERCENT = 15;
+static constexpr int WINDOW_DIVISOR = 4;
+static constexpr int MIN_WINDOW = 16;
+
+AdaptiveBinarizer::AdaptiveBinarizer(const ImageView& buffer) : BinaryBitmap(buffer) {}
+
+AdaptiveBinarizer::~AdaptiveBinarizer() = default;
+
+bool AdaptiveBinarizer::getPatternRow(int row, int rotation, PatternRow& res) const
+{
+	auto bits = getBitMatrix();
+	if (!bits)
+		return false;
+
+	// map the row of the rotated image back to a row/column of the bit matrix, see ImageView::rotated()
+	switch ((rotation + 360) % 360) {
+	case 0: { // shared with the 2D detectors, the view of a full row starts behind the leading white run
+		auto cached = getBitMatrixPatternRow(row);
+		res.assign(cached.begin() - 1, cached.end());
+		break;
+	}
+	case 90: GetPatternRow(*bits, row, res, true), std::reverse(res.begin(), res.end()); break;
+	case 180: GetPatternRow(*bits, height() - 1 - row, res, false), std::reverse(res.begin(), res.end()); break;
+	case 270: GetPatternRow(*bits, width() - 1 - row, res, true); break;
+	default: return false;
+	}
+
+	return true;
+}
+
+std::shared_ptr<const BitMatrix> AdaptiveBinarizer::getBlackMatrix() const
+{
+	ZX_TRACE_SCOPE("AdaptiveBinarizer::getBlackMatrix");
+	const int width = _buffer.width(), height = _buffer.height();
+	if (width <= 0 || height <= 0)
+		return {};
+
+	// The integral image uses unsigned 32-bit arithmetic. Sums over the whole image may wrap around, but the
+	// differences computed for a window are still exact as long as a single window sum fits into 32 bits, which is
+	// the case for windows of up to 16 million pixels.
+	const int stride = width + 1;
+	std::vector<uint32_t> integral(stride * (height + 1), 0);
+	for (int y = 0; y < height; ++y) {
+		const uint8_t* src = _buffer.data(0, y);
+		const uint32_t* above = integral.data() + y * stride;
+		uint32_t* dst = integral.data() + (y + 1) * stride;
+		uint32_t rowSum = 0;
+		for (int x = 0; x < width; ++x, src += _buffer.pixStride()) {
+			rowSum += *src;
+			dst[x + 1] = above[x + 1] + rowSum;
+		}
+	}
+
+	const int r = std::max(MIN_WINDOW, std::max(width, height) / WINDOW_DIVISOR) / 2;
+	auto res = std::make_shared<BitMatrix>(width, height, BitMatrix::ROW_ALIGNMENT);
+	for (int y = 0; y < height; ++y) {
+		const int top = std::max(0, y - r), bottom = std::min(height, y + r + 1);
+		const uint32_t* rowTop = integral.data() + top * stride;
+		const uint32_t* rowBottom = integral.data() + bottom * stride;
+		const uint8_t* src = _buffer.data(0, y);
+		auto* dst = res->row(y).begin();
+		for (int x = 0; x < width; ++x, src += _buffer.pixStride()) {
+			const int left = std::max(0, x - r), right = std::min(width, x + r + 1);
+			const uint32_t sum = rowBottom[right] - rowBottom[left] - rowTop[right] + rowTop[left];
+			const int64_t count = (bottom - top) * (right - left);
+			// pixel <= mean * (100 - THRESHOLD_PERCENT) / 100
+			dst[x] = (int64_t(*src) * count * 100 <= int64_t(sum) * (100 - THRESHOLD_PERCENT)) * BitMatrix::SET_V;
+		}
+	}
+
+	return res;
+}
+
+} // ZXing
@@ -0,0 +1,32 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "BinaryBitmap.h"
+
+namespace ZXing {
+
+/**
+* This Binarizer implements the adaptive thresholding algorithm of Bradley and Roth ("Adaptive Thresholding Using
+* the Integral Image", 2007). A pixel is considered black if it is more than a fixed percentage darker than the mean
+* of a square window around it. Using an integral image, the cost per pixel is constant, independent of the size of
+* the window.
+*
+* Compared to the HybridBinarizer with its fixed 8x8 pixel blocks, the large window copes a lot better with uneven
+* illumination (shadows, gradients). Such images otherwise often need multiple tryHarder passes. Both the linear and
+* the matrix readers use the same bit matrix.
+*/
+class AdaptiveBinarizer : public BinaryBitmap
+{
+public:
+	explicit AdaptiveBinarizer(const ImageView& buffer);
+	~AdaptiveBinarizer() override;
+
+	bool getPatternRow(int row, int rotation, PatternRow& res) const override;
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
+};
+
+} // ZXing
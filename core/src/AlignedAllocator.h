@@ -0,0 +1,41 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+namespace ZXing {
+
+/**
+ * @brief AlignedAllocator is a std::allocator replacement returning memory aligned to ALIGNMENT bytes (a cache line by
+ * default), e.g. to let the rows of a BitMatrix start at a SIMD register boundary.
+ */
+template <typename T, std::size_t ALIGNMENT = 64>
+struct AlignedAllocator
+{
+	using value_type = T;
+	static constexpr std::align_val_t alignment{std::max(ALIGNMENT, alignof(T))};
+
+	template <typename U>
+	struct rebind
+	{
+		using other = AlignedAllocator<U, ALIGNMENT>;
+	};
+
+	AlignedAllocator() noexcept = default;
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, ALIGNMENT>&) noexcept {}
+
+	T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), alignment)); }
+	void deallocate(T* p, std::size_t) noexcept { ::operator delete(p, alignment); }
+
+	friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) noexcept { return true; }
+	friend bool operator!=(const AlignedAllocator&, const AlignedAllocator&) noexcept { return false; }
+};
+
+} // ZXing
@@ -0,0 +1,64 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ArenaResource.h"
+
+#ifdef ZX_HAVE_PMR
+
+namespace ZXing {
+
+void* ArenaResource::Upstream::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	void* p = resource->allocate(bytes, alignment);
+	requested += bytes;
+	return p;
+}
+
+void ArenaResource::Upstream::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+	resource->deallocate(p, bytes, alignment);
+}
+
+ArenaResource::ArenaResource(std::pmr::memory_resource* upstream)
+	: _upstream(upstream ? upstream : std::pmr::get_default_resource())
+{
+	_arena.emplace(&_upstream);
+}
+
+ArenaResource::~ArenaResource()
+{
+	_arena.reset();
+	if (_buffer)
+		_upstream.resource->deallocate(_buffer, _bufferSize, alignof(std::max_align_t));
+}
+
+void* ArenaResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	std::lock_guard lock(_mutex);
+	return _arena->allocate(bytes, alignment);
+}
+
+void ArenaResource::release()
+{
+	std::lock_guard lock(_mutex);
+	if (_upstream.requested == 0) {
+		// rewinds to the start of the initial buffer
+		_arena->release();
+		return;
+	}
+
+	// the chunks of the monotonic resource grow geometrically, so their sum is at most about twice the actual need
+	_arena.reset();
+	if (_buffer)
+		_upstream.resource->deallocate(_buffer, _bufferSize, alignof(std::max_align_t));
+	_bufferSize += _upstream.requested;
+	_upstream.requested = 0;
+	_buffer = _upstream.resource->allocate(_bufferSize, alignof(std::max_align_t));
+	_arena.emplace(_buffer, _bufferSize, &_upstream);
+}
+
+} // ZXing
+
+#endif // ZX_HAVE_PMR
@@ -0,0 +1,69 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ZXConfig.h"
+
+#ifdef ZX_HAVE_PMR
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+
+namespace ZXing {
+
+/**
+ * A thread safe std::pmr::monotonic_buffer_resource that keeps its memory between sessions (e.g. BarcodeReader::read()
+ * calls): deallocate() is a no-op and release() recycles everything at once. Whatever a session needed on top of the
+ * initial buffer is added to it on the next release(), so the buffer grows to the peak usage and a steady state
+ * session does not touch the upstream resource at all.
+ */
+class ArenaResource : public std::pmr::memory_resource
+{
+	// forwards to the actual upstream and sums up what the monotonic resource requested in the current session
+	class Upstream : public std::pmr::memory_resource
+	{
+	public:
+		std::pmr::memory_resource* resource;
+		std::size_t requested = 0;
+
+		explicit Upstream(std::pmr::memory_resource* resource) : resource(resource) {}
+
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+	};
+
+	Upstream _upstream;
+	void* _buffer = nullptr;
+	std::size_t _bufferSize = 0;
+	std::optional<std::pmr::monotonic_buffer_resource> _arena;
+	std::mutex _mutex;
+
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void*, std::size_t, std::size_t) override {}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+	/// @param upstream  where the memory comes from (not owned), nullptr means std::pmr::get_default_resource()
+	explicit ArenaResource(std::pmr::memory_resource* upstream = nullptr);
+	~ArenaResource() override;
+
+	ArenaResource(const ArenaResource&) = delete;
+	ArenaResource& operator=(const ArenaResource&) = delete;
+
+	/// Ends the session, all memory allocated so far must not be used anymore.
+	void release();
+
+	/// The size of the buffer a session starts with
+	std::size_t capacity() const { return _bufferSize; }
+};
+
+} // ZXing
+
+#endif // ZX_HAVE_PMR
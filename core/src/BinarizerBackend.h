@@ -0,0 +1,44 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ImageView.h"
+
+#include <cstdint>
+
+namespace ZXing {
+
+/**
+ * @brief Hook to compute the binarized image the matrix symbol detectors work on outside of the library, e.g. with a
+ * compute shader on an otherwise idle GPU, see DecodeHints::setBinarizerBackend().
+ *
+ * It replaces the local thresholding of Binarizer::LocalAverage, the linear readers still threshold their rows on the
+ * CPU. binarize() may be called from several threads at the same time (see DecodeHints::threads()).
+ */
+class BinarizerBackend
+{
+public:
+	virtual ~BinarizerBackend() = default;
+
+	/**
+	 * Announce that the given layer of the image pyramid is going to be binarized soon, so the work (upload, luminance
+	 * extraction, thresholding) can be started asynchronously while the CPU processes the previous layer. The default
+	 * does nothing. Not every layer is announced, the view stays valid until the read call returns.
+	 */
+	virtual void prepare([[maybe_unused]] const ImageView& iv) {}
+
+	/**
+	 * Binarize a luminance image
+	 *
+	 * @param iv  the luminance image (ImageFormat::Lum, possibly with a pixStride > 1)
+	 * @param dst  iv.width() * iv.height() bytes, row by row without padding, to be set to 0xff for dark and 0 for light
+	 *             pixels
+	 * @return false to let the built-in binarizer do the work instead
+	 */
+	virtual bool binarize(const ImageView& iv, uint8_t* dst) = 0;
+};
+
+} // ZXing
@@ -6,41 +6,86 @@
 #include "BinaryBitmap.h"
 
 #include "BitMatrix.h"
+#include "Pattern.h"
+#include "StatsScope.h"
+#include "TraceScope.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <mutex>
+#include <vector>
 
 namespace ZXing {
 
 struct BinaryBitmap::Cache
 {
+#ifdef ZX_HAVE_PMR
+	// the rows (and the row vector itself) are allocated from the resource passed to the constructor
+	using Row = std::pmr::vector<PatternType>;
+	using Rows = std::pmr::vector<Row>;
+
+	explicit Cache(std::pmr::memory_resource* resource = nullptr)
+		: rows(resource ? resource : std::pmr::get_default_resource())
+	{}
+#else
+	using Row = PatternRow;
+	using Rows = std::vector<Row>;
+#endif
+
 	std::once_flag once;
 	std::shared_ptr<const BitMatrix> matrix;
+	std::unique_ptr<std::once_flag[]> rowsOnce;
+	Rows rows;
+	std::unique_ptr<std::once_flag> tilesOnce;
+	Matrix<TileClass> tiles;
+
+	void resetTiles() { tilesOnce = std::make_unique<std::once_flag>(); }
+
+	void resetRows()
+	{
+		int height = matrix ? matrix->height() : 0;
+		rowsOnce = std::make_unique<std::once_flag[]>(height);
+		rows.clear();
+		rows.resize(height);
+	}
+
+	// turn the already computed rows into the ones of the inverted matrix, the once_flags stay valid
+	void invertRows()
+	{
+		for (auto& row : rows) {
+			if (row.empty())
+				continue;
+			// a pattern row always starts and ends with a white run (potentially of length 0), see GetPatternRow
+			if (row.front() == 0)
+				row.erase(row.begin());
+			else
+				row.insert(row.begin(), 0);
+			if (row.back() == 0)
+				row.pop_back();
+			else
+				row.push_back(0);
+		}
+	}
 };
 
 BitMatrix BinaryBitmap::binarize(const uint8_t threshold) const
 {
-	BitMatrix res(width(), height());
-
-	if (_buffer.pixStride() == 1 && _buffer.rowStride() == _buffer.width()) {
-		// Specialize for a packed buffer with pixStride 1 to support auto vectorization (16x speedup on AVX2)
-		auto dst = res.row(0).begin();
-		for (auto src = _buffer.data(0, 0), end = _buffer.data(0, height()); src != end; ++src, ++dst)
-			*dst = (*src <= threshold) * BitMatrix::SET_V;
-	} else {
-		auto processLine = [&res, threshold](int y, const auto* src, const int stride) {
-			for (auto& dst : res.row(y)) {
-				dst = (*src <= threshold) * BitMatrix::SET_V;
-				src += stride;
-			}
-		};
-		for (int y = 0; y < res.height(); ++y) {
-			auto src = _buffer.data(0, y) + GreenIndex(_buffer.format());
-			// Specialize the inner loop for strides 1 and 4 to support auto vectorization
-			switch (_buffer.pixStride()) {
-			case 1: processLine(y, src, 1); break;
-			case 4: processLine(y, src, 4); break;
-			default: processLine(y, src, _buffer.pixStride()); break;
-			}
+	BitMatrix res(width(), height(), BitMatrix::ROW_ALIGNMENT);
+
+	auto processLine = [&res, threshold](int y, const auto* src, const int stride) {
+		for (auto& dst : res.row(y)) {
+			dst = (*src <= threshold) * BitMatrix::SET_V;
+			src += stride;
+		}
+	};
+	for (int y = 0; y < res.height(); ++y) {
+		auto src = _buffer.data(0, y) + GreenIndex(_buffer.format());
+		// Specialize the inner loop for strides 1 and 4 to support auto vectorization (16x speedup on AVX2), the rows of
+		// res start at a register boundary
+		switch (_buffer.pixStride()) {
+		case 1: processLine(y, src, 1); break;
+		case 4: processLine(y, src, 4); break;
+		default: processLine(y, src, _buffer.pixStride()); break;
 		}
 	}
 
@@ -53,47 +98,145 @@ BinaryBitmap::~BinaryBitmap() = default;
 
 const BitMatrix* BinaryBitmap::getBitMatrix() const
 {
-	std::call_once(_cache->once, [&](){_cache->matrix = getBlackMatrix();});
+	std::call_once(_cache->once, [&]() {
+		StatsScope scope(DecodeStats::Stage::Binarize);
+		_cache->matrix = getBlackMatrix();
+		_cache->resetRows();
+		_cache->resetTiles();
+	});
 	return _cache->matrix.get();
 }
 
+PatternView BinaryBitmap::getBitMatrixPatternRow(int y) const
+{
+	auto matrix = getBitMatrix();
+	auto& row = _cache->rows[y];
+	std::call_once(_cache->rowsOnce[y], [&]() { GetPatternRow(matrix->row(y), row, matrix->rowPitch() - matrix->width()); });
+	return {row.data() + 1, Size(row) - 1, row.data(), row.data() + row.size()};
+}
+
+const Matrix<TileClass>& BinaryBitmap::tileClasses() const
+{
+	auto matrix = getBitMatrix();
+	std::call_once(*_cache->tilesOnce, [&]() { _cache->tiles = ClassifyTiles(*matrix, TileSize); });
+	return _cache->tiles;
+}
+
+#ifdef ZX_HAVE_PMR
+void BinaryBitmap::setMemoryResource(std::pmr::memory_resource* resource)
+{
+	// a pmr container can not change its resource, the (still empty) cache is simply replaced
+	_cache = std::make_unique<Cache>(resource);
+}
+#endif
+
 void BinaryBitmap::invert()
 {
 	if (_cache->matrix) {
 		auto matrix = const_cast<BitMatrix*>(_cache->matrix.get());
 		matrix->flipAll();
+		_cache->invertRows();
 	}
 	_inverted = true;
 }
 
-template <typename F>
-void SumFilter(const BitMatrix& in, BitMatrix& out, F func)
+/**
+ * Applies the 3x3 filter op (bitwise OR for dilate, AND for erode) in place. The matrix is processed as if it was one
+ * linear array (without row padding) from position (1, 1) to (width - 2, height - 2), i.e. the first and last column
+ * also get computed (with neighbors wrapping around to the adjacent row).
+ *
+ * With the bit values being 0 and 0xff, the 3x3 neighborhood can be computed as a horizontal 1x3 pass followed by a
+ * vertical 3x1 pass. To get by without a second full size matrix, the horizontal results of only 3 rows are kept in
+ * a ring buffer. All inner loops are simple contiguous byte operations the compiler can auto-vectorize.
+ */
+template <typename OP>
+static void Filter3x3InPlace(BitMatrix& matrix, OP op)
 {
-	const auto* in0 = in.row(0).begin();
-	const auto* in1 = in.row(1).begin();
-	const auto* in2 = in.row(2).begin();
-
-	for (auto *out1 = out.row(1).begin() + 1, *end = out.row(out.height() - 1).begin() - 1; out1 != end; ++in0, ++in1, ++in2, ++out1) {
-		int sum = 0;
-		for (int j = 0; j < 3; ++j)
-			sum += in0[j] + in1[j] + in2[j];
-
-		*out1 = func(sum);
+	const int w = matrix.width(), h = matrix.height();
+	std::vector<uint8_t> buf(3 * w, 0);
+	auto hrow = [&](int r) { return buf.data() + (r % 3) * w; };
+
+	// horizontal pass for row r, only the linear positions [1, w * h - 2] are needed, the first and the last pixel of
+	// the row have the last pixel of the previous and the first one of the next row as neighbor
+	auto horizontal = [&](int r) {
+		uint8_t* __restrict dst = hrow(r);
+		const uint8_t* src = matrix.row(r).begin();
+		for (int x = 1; x < w - 1; ++x)
+			dst[x] = op(op(src[x - 1], src[x]), src[x + 1]);
+		if (r > 0)
+			dst[0] = op(op(matrix.row(r - 1).end()[-1], src[0]), src[1]);
+		if (r < h - 1)
+			dst[w - 1] = op(op(src[w - 2], src[w - 1]), matrix.row(r + 1).begin()[0]);
+	};
+
+	horizontal(0);
+	horizontal(1);
+	for (int y = 1; y < h - 1; ++y) {
+		// needs to happen before row y is overwritten, as the first pixel of row y + 1 depends on the last of row y
+		horizontal(y + 1);
+		const uint8_t* __restrict a = hrow(y - 1);
+		const uint8_t* __restrict b = hrow(y);
+		const uint8_t* __restrict c = hrow(y + 1);
+		uint8_t* __restrict dst = matrix.row(y).begin();
+		for (int x = y == 1 ? 1 : 0, end = y == h - 2 ? w - 1 : w; x < end; ++x)
+			dst[x] = op(op(a[x], b[x]), c[x]);
 	}
 }
 
 void BinaryBitmap::close()
 {
-	if (_cache->matrix) {
+	static_assert(BitMatrix::SET_V == 0xff && BitMatrix::UNSET_V == 0, "Filter3x3InPlace relies on bitwise operations");
+
+	if (_cache->matrix && _cache->matrix->width() >= 3 && _cache->matrix->height() >= 3) {
+		ZX_TRACE_SCOPE("BinaryBitmap::close");
+		StatsScope scope(DecodeStats::Stage::Binarize);
 		auto& matrix = *const_cast<BitMatrix*>(_cache->matrix.get());
-		BitMatrix tmp(matrix.width(), matrix.height());
+		const int w = matrix.width(), h = matrix.height();
+		auto first = matrix.row(0), last = matrix.row(h - 1);
+		auto& secondFirst = matrix.row(1).begin()[0];
+		auto& secondLastLast = matrix.row(h - 2).end()[-1];
+
+		// the filter does not touch the first and last w + 1 positions: the dilated image needs them to be unset, the
+		// closed image keeps the original values
+		std::vector<uint8_t> head(first.begin(), first.end()), tail(last.begin(), last.end());
+		head.push_back(secondFirst);
+		tail.push_back(secondLastLast);
+		auto setBorder = [&](auto headIt, auto tailIt) {
+			std::copy_n(headIt, w, first.begin());
+			secondFirst = headIt[w];
+			std::copy_n(tailIt, w, last.begin());
+			secondLastLast = tailIt[w];
+		};
 
 		// dilate
-		SumFilter(matrix, tmp, [](int sum) { return (sum > 0 * BitMatrix::SET_V) * BitMatrix::SET_V; });
+		Filter3x3InPlace(matrix, [](uint8_t a, uint8_t b) -> uint8_t { return a | b; });
+		std::vector<uint8_t> unset(w + 1, BitMatrix::UNSET_V);
+		setBorder(unset.begin(), unset.begin());
 		// erode
-		SumFilter(tmp, matrix, [](int sum) { return (sum == 9 * BitMatrix::SET_V) * BitMatrix::SET_V; });
+		Filter3x3InPlace(matrix, [](uint8_t a, uint8_t b) -> uint8_t { return a & b; });
+		setBorder(head.begin(), tail.begin());
+		_cache->resetRows();
+		_cache->resetTiles();
 	}
 	_closed = true;
 }
 
+void BinaryBitmap::mask(const std::vector<Rect>& regions)
+{
+	auto matrix = const_cast<BitMatrix*>(getBitMatrix());
+	if (!matrix)
+		return;
+
+	for (auto r : regions) {
+		int left = std::max(0, r.left);
+		int top = std::max(0, r.top);
+		int right = std::min(matrix->width(), r.left + r.width);
+		int bottom = std::min(matrix->height(), r.top + r.height);
+		for (int y = top; y < bottom; ++y)
+			std::fill(matrix->row(y).begin() + left, matrix->row(y).begin() + std::max(left, right), BitMatrix::UNSET_V);
+	}
+	if (!regions.empty())
+		_cache->resetRows();
+}
+
 } // ZXing
@@ -8,16 +8,22 @@
 #pragma once
 
 #include "ImageView.h"
+#include "Pattern.h"
+#include "TileClassifier.h"
+#include "ZXConfig.h"
 
 #include <cstdint>
 #include <memory>
 #include <vector>
 
+#ifdef ZX_HAVE_PMR
+#include <memory_resource>
+#endif
+
 namespace ZXing {
 
 class BitMatrix;
-
-using PatternRow = std::vector<uint16_t>;
+class Executor;
 
 /**
 * This class is the core bitmap class used by ZXing to represent 1 bit data. Reader objects
@@ -29,6 +35,8 @@ class BinaryBitmap
 	std::unique_ptr<Cache> _cache;
 	bool _inverted = false;
 	bool _closed = false;
+	Executor* _executor = nullptr;
+	float _minModuleSize = 0, _maxModuleSize = 0;
 
 protected:
 	const ImageView _buffer;
@@ -49,18 +57,72 @@ public:
 	int width() const { return _buffer.width(); }
 	int height() const { return _buffer.height(); }
 
+	/// The image this bitmap binarizes, the coordinates are the same as in getBitMatrix()
+	const ImageView& buffer() const { return _buffer; }
+
 	/**
 	* Converts one row of luminance data to a vector of ints denoting the widths of the bars and spaces.
 	*/
 	virtual bool getPatternRow(int row, int rotation, PatternRow& res) const = 0;
 
+	/**
+	* The widths returned by getPatternRow are in units of 1/patternRowScale() pixels.
+	*/
+	virtual int patternRowScale() const { return 1; }
+
 	const BitMatrix* getBitMatrix() const;
 
+	/**
+	* Returns the run-length encoded row y of getBitMatrix() (see GetPatternRow). The rows are computed on demand
+	* and cached, so that multiple detectors working on the same bitmap don't have to re-scan the same pixels.
+	* getBitMatrix() must not be nullptr. The view is invalidated by invert(), close() and mask().
+	*/
+	PatternView getBitMatrixPatternRow(int y) const;
+
+	/// The tile size of tileClasses()
+	static constexpr int TileSize = 32;
+
+	/**
+	* Returns the TileClass of every TileSize x TileSize tile of getBitMatrix() (see ClassifyTiles), computed on demand
+	* and cached. getBitMatrix() must not be nullptr. The classes stay valid after invert() (which does not move any
+	* edge) and mask() (which only removes some), close() resets them.
+	*/
+	const Matrix<TileClass>& tileClasses() const;
+
 	void invert();
 	bool inverted() const { return _inverted; }
 
 	void close();
 	bool closed() const { return _closed; }
+
+	/**
+	* Clears (sets to white) the given regions of the BitMatrix, e.g. to prevent 2D detectors from finding
+	* already known symbols again. Only affects getBitMatrix(), not getPatternRow().
+	*/
+	void mask(const std::vector<Rect>& regions);
+
+	/**
+	* Optional Executor the binarizer and the readers working on this bitmap may use for internal parallelism
+	* (not owned, nullptr means sequential processing).
+	*/
+	void setExecutor(Executor* executor) { _executor = executor; }
+	Executor* executor() const { return _executor; }
+
+	/**
+	* Optional expected size range of the symbol modules in pixels of this bitmap (0 = unknown), see
+	* DecodeHints::setModuleSizeRange(). Readers may use it to prune their search.
+	*/
+	void setModuleSizeRange(float min, float max) { _minModuleSize = min, _maxModuleSize = max; }
+	float minModuleSize() const { return _minModuleSize; }
+	float maxModuleSize() const { return _maxModuleSize; }
+
+#ifdef ZX_HAVE_PMR
+	/**
+	* Optional memory resource the cached pattern rows are allocated from (not owned, nullptr means the default resource).
+	* Must be set before the first call to getBitMatrix() and outlive this bitmap.
+	*/
+	void setMemoryResource(std::pmr::memory_resource* resource);
+#endif
 };
 
 } // ZXing
@@ -8,30 +8,55 @@
 
 #include "ByteArray.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <stdexcept>
 
 namespace ZXing {
 
+void BitArray::appendBitArray(const BitArray& other)
+{
+	if (_size % 64 == 0) {
+		_words.insert(_words.end(), other._words.begin(), other._words.end());
+		_size += other._size;
+		return;
+	}
+	int i = 0;
+	for (; i + 32 <= other.size(); i += 32)
+		appendBits(other.getBits(i, 32), 32);
+	appendBits(other.getBits(i, other.size() - i), other.size() - i);
+}
+
+void BitArray::reverse()
+{
+	BitArray res(_size);
+	for (int i = 0; i < _size; ++i)
+		if (get(i))
+			res._words[(_size - 1 - i) / 64] |= Mask(_size - 1 - i);
+	*this = std::move(res);
+}
+
 void
 BitArray::bitwiseXOR(const BitArray& other)
 {
 	if (size() != other.size()) {
 		throw std::invalid_argument("BitArray::xor(): Sizes don't match");
 	}
-	for (size_t i = 0; i < _bits.size(); i++) {
-		// The last int could be incomplete (i.e. not have 32 bits in
-		// it) but there is no problem since 0 XOR 0 == 0.
-		_bits[i] ^= other._bits[i];
+	for (size_t i = 0; i < _words.size(); i++) {
+		// The unused bits of the last word are 0 in both, so they stay 0.
+		_words[i] ^= other._words[i];
 	}
 }
 
 ByteArray BitArray::toBytes(int bitOffset, int numBytes) const
 {
 	ByteArray res(numBytes == -1 ? (size() - bitOffset + 7) / 8 : numBytes);
-	for (int i = 0; i < Size(res); i++)
-		for (int j = 0; j < 8; j++)
-			AppendBit(res[i], (numBytes != -1 || bitOffset < size()) ? get(bitOffset++) : 0);
+	for (int i = 0; i < Size(res); i++, bitOffset += 8) {
+		int n = std::min(8, size() - bitOffset);
+		if (n < 8 && numBytes != -1)
+			throw std::out_of_range("BitArray::toBytes() out of range.");
+		res[i] = narrow_cast<uint8_t>(getBits(bitOffset, n) << (8 - n));
+	}
 	return res;
 }
 
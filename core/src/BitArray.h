@@ -25,10 +25,14 @@ class ByteArray;
 
 /**
 * A simple, fast array of bits.
+*
+* The bits are packed into 64 bit words, most significant bit first, i.e. bit i is bit 63 - i % 64 of word i / 64. The
+* unused bits of the last word are always 0. Appending, reading and xor-ing works on whole words wherever possible.
 */
 class BitArray
 {
-	std::vector<uint8_t> _bits;
+	std::vector<uint64_t> _words;
+	int _size = 0;
 
 	friend class BitMatrix;
 
@@ -37,33 +41,101 @@ class BitArray
 	BitArray(const BitArray &) = default;
 	BitArray& operator=(const BitArray &) = delete;
 
+	static constexpr uint64_t Mask(int i) noexcept { return uint64_t(1) << (63 - i % 64); }
+
 public:
 
-	using Iterator = std::vector<uint8_t>::const_iterator;
+	/**
+	* Random access iterator over the (read only) bits, dereferencing yields a bool.
+	*/
+	class Iterator
+	{
+		const uint64_t* _words = nullptr;
+		int _pos = 0;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using difference_type = int;
+		using value_type = bool;
+		using pointer = void;
+		using reference = bool;
+
+		Iterator() = default;
+		Iterator(const uint64_t* words, int pos) noexcept : _words(words), _pos(pos) {}
+
+		bool operator*() const noexcept { return _words[_pos / 64] & Mask(_pos); }
+		bool operator[](int i) const noexcept { return *(*this + i); }
+
+		Iterator& operator++() noexcept { return ++_pos, *this; }
+		Iterator operator++(int) noexcept { return {_words, _pos++}; }
+		Iterator& operator--() noexcept { return --_pos, *this; }
+		Iterator operator--(int) noexcept { return {_words, _pos--}; }
+		Iterator& operator+=(int n) noexcept { return _pos += n, *this; }
+		Iterator& operator-=(int n) noexcept { return _pos -= n, *this; }
+		Iterator operator+(int n) const noexcept { return {_words, _pos + n}; }
+		Iterator operator-(int n) const noexcept { return {_words, _pos - n}; }
+		int operator-(const Iterator& rhs) const noexcept { return _pos - rhs._pos; }
+
+		bool operator==(const Iterator& rhs) const noexcept { return _pos == rhs._pos; }
+		bool operator!=(const Iterator& rhs) const noexcept { return _pos != rhs._pos; }
+		bool operator<(const Iterator& rhs) const noexcept { return _pos < rhs._pos; }
+		bool operator<=(const Iterator& rhs) const noexcept { return _pos <= rhs._pos; }
+		bool operator>(const Iterator& rhs) const noexcept { return _pos > rhs._pos; }
+		bool operator>=(const Iterator& rhs) const noexcept { return _pos >= rhs._pos; }
+	};
 
 	BitArray() = default;
 
-	explicit BitArray(int size) : _bits(size, 0) {}
+	explicit BitArray(int size) : _words((size + 63) / 64, 0), _size(size) {}
 
 	BitArray(BitArray&& other) noexcept = default;
 	BitArray& operator=(BitArray&& other) noexcept = default;
 
 	BitArray copy() const { return *this; }
 
-	int size() const noexcept { return Size(_bits); }
+	int size() const noexcept { return _size; }
 
 	int sizeInBytes() const noexcept { return (size() + 7) / 8; }
 
-	bool get(int i) const { return _bits.at(i) != 0; }
-	void set(int i, bool val) { _bits.at(i) = val; }
+	bool get(int i) const
+	{
+		if (i < 0 || i >= _size)
+			throw std::out_of_range("BitArray::get() out of range.");
+		return _words[i / 64] & Mask(i);
+	}
+
+	void set(int i, bool val)
+	{
+		if (i < 0 || i >= _size)
+			throw std::out_of_range("BitArray::set() out of range.");
+		if (val)
+			_words[i / 64] |= Mask(i);
+		else
+			_words[i / 64] &= ~Mask(i);
+	}
+
+	/**
+	* @return the numBits (<= 32) bits starting at pos, the first one in the most-significant position
+	*/
+	int getBits(int pos, int numBits) const
+	{
+		assert(0 <= numBits && numBits <= 32 && 0 <= pos && pos + numBits <= _size);
+		if (numBits == 0)
+			return 0;
+		int offset = pos % 64;
+		uint64_t v = _words[pos / 64] << offset;
+		if (offset + numBits > 64)
+			v |= _words[pos / 64 + 1] >> (64 - offset);
+		return static_cast<int>(static_cast<uint32_t>(v >> (64 - numBits)));
+	}
 
 	// If you know exactly how may bits you are going to iterate
 	// and that you access bit in sequence, iterator is faster than get().
 	// However, be extremely careful since there is no check whatsoever.
 	// (Performance is the reason for the iterator to exist in the first place.)
-	Iterator iterAt(int i) const noexcept { return {_bits.cbegin() + i}; }
-	Iterator begin() const noexcept { return _bits.cbegin(); }
-	Iterator end() const noexcept { return _bits.cend(); }
+	Iterator iterAt(int i) const noexcept { return {_words.data(), i}; }
+	Iterator begin() const noexcept { return iterAt(0); }
+	Iterator end() const noexcept { return iterAt(_size); }
 
 	/**
 	* Appends the least-significant bits, from value, in order from most-significant to
@@ -71,22 +143,34 @@ public:
 	* 0, 1, 1, 1, 1, 0 in that order.
 	*
 	* @param value {@code int} containing bits to append
-	* @param numBits bits from value to append
+	* @param numBits bits from value to append (<= 32)
 	*/
 	void appendBits(int value, int numBits)
 	{
-		for (; numBits; --numBits)
-			_bits.push_back((value >> (numBits-1)) & 1);
+		assert(0 <= numBits && numBits <= 32);
+		if (numBits == 0)
+			return;
+		uint64_t v = static_cast<uint32_t>(value) & (~uint64_t(0) >> (64 - numBits));
+		int free = 64 - _size % 64;
+		if (free == 64)
+			_words.push_back(0);
+		if (numBits <= free) {
+			_words.back() |= v << (free - numBits);
+		} else {
+			_words.back() |= v >> (numBits - free);
+			_words.push_back(v << (64 - (numBits - free)));
+		}
+		_size += numBits;
 	}
 
-	void appendBit(bool bit) { _bits.push_back(bit); }
+	void appendBit(bool bit) { appendBits(bit, 1); }
 
-	void appendBitArray(const BitArray& other) { _bits.insert(_bits.end(), other.begin(), other.end()); }
+	void appendBitArray(const BitArray& other);
 
 	/**
 	* Reverses all bits in the array.
 	*/
-	void reverse() { std::reverse(_bits.begin(), _bits.end()); }
+	void reverse();
 
 	void bitwiseXOR(const BitArray& other);
 
@@ -100,7 +184,7 @@ public:
 	using Range = ZXing::Range<Iterator>;
 	Range range() const { return {begin(), end()}; }
 
-	friend bool operator==(const BitArray& a, const BitArray& b) { return a._bits == b._bits; }
+	friend bool operator==(const BitArray& a, const BitArray& b) { return a._size == b._size && a._words == b._words; }
 };
 
 template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
@@ -127,12 +211,7 @@ T ToInt(const BitArray& bits, int pos = 0, int count = 8 * sizeof(T))
 	assert(0 <= pos && pos + count <= bits.size());
 
 	count = std::min(count, bits.size());
-	int res = 0;
-	auto it = bits.iterAt(pos);
-	for (int i = 0; i < count; ++i, ++it)
-		AppendBit(res, *it);
-
-	return res;
+	return static_cast<T>(bits.getBits(pos, count));
 }
 
 template <typename T = int, typename = std::enable_if_t<std::is_integral_v<T>>>
@@ -6,12 +6,17 @@
 
 #include "BitMatrix.h"
 
+#include "BitHacks.h"
 #include "Pattern.h"
 
 #include <algorithm>
 #include <stdexcept>
 #include <utility>
 
+#ifdef ZX_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace ZXing {
 
 void
@@ -29,44 +34,178 @@ BitMatrix::setRegion(int left, int top, int width, int height)
 		throw std::invalid_argument("BitMatrix::setRegion(): The region must fit inside the matrix");
 	}
 	for (int y = top; y < bottom; y++) {
-		auto offset = y * _width;
+		auto offset = y * _pitch;
 		for (int x = left; x < right; x++) {
 			_bits[offset + x] = SET_V;
 		}
 	}
 }
 
+void
+BitMatrix::flipAll()
+{
+	if (_pitch == _width) {
+		for (auto& i : _bits)
+			i = !i * SET_V;
+		return;
+	}
+
+	// process whole (aligned) rows and mask the padding to keep it unset instead of stopping at the width
+	std::vector<data_t> mask(_pitch, UNSET_V);
+	std::fill_n(mask.begin(), _width, SET_V);
+	for (int y = 0; y < _height; ++y) {
+		data_t* __restrict dst = _bits.data() + y * _pitch;
+		for (int x = 0; x < _pitch; ++x)
+			dst[x] = (!dst[x] * SET_V) & mask[x];
+	}
+}
+
+// rotate90() and mirror() transpose the matrix in tiles of TILE x TILE pixels, so that the reads and the writes of a
+// tile stay within TILE cache lines each instead of touching a new cache line per pixel on one of the two sides.
+static constexpr int TILE = 16;
+
+// Writes the transposed TILE x TILE block at src to dst: row i of dst is column i of src. With SSE2 the 16 rows are
+// interleaved in registers (4 unpack stages of 8, 16, 32 and 64 bits), otherwise it is a plain pixel loop.
+static void TransposeTile(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride)
+{
+#ifdef ZX_USE_SSE2
+	__m128i a[TILE], b[TILE];
+	for (int i = 0; i < TILE; ++i)
+		a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * srcStride));
+	// b[2i], b[2i+1]: columns 0-7, 8-15 of rows 2i, 2i+1 as byte pairs
+	for (int i = 0; i < 8; ++i) {
+		b[2 * i] = _mm_unpacklo_epi8(a[2 * i], a[2 * i + 1]);
+		b[2 * i + 1] = _mm_unpackhi_epi8(a[2 * i], a[2 * i + 1]);
+	}
+	// a[4i + c]: columns 4c - 4c+3 of rows 4i - 4i+3
+	for (int i = 0; i < 4; ++i)
+		for (int c = 0; c < 2; ++c) {
+			a[4 * i + 2 * c] = _mm_unpacklo_epi16(b[4 * i + c], b[4 * i + 2 + c]);
+			a[4 * i + 2 * c + 1] = _mm_unpackhi_epi16(b[4 * i + c], b[4 * i + 2 + c]);
+		}
+	// b[8i + k]: columns 2k, 2k+1 of rows 8i - 8i+7
+	for (int i = 0; i < 2; ++i)
+		for (int c = 0; c < 4; ++c) {
+			b[8 * i + 2 * c] = _mm_unpacklo_epi32(a[8 * i + c], a[8 * i + 4 + c]);
+			b[8 * i + 2 * c + 1] = _mm_unpackhi_epi32(a[8 * i + c], a[8 * i + 4 + c]);
+		}
+	// column j of all 16 rows
+	for (int k = 0; k < 8; ++k) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (2 * k) * dstStride), _mm_unpacklo_epi64(b[k], b[8 + k]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (2 * k + 1) * dstStride), _mm_unpackhi_epi64(b[k], b[8 + k]));
+	}
+#else
+	for (int y = 0; y < TILE; ++y)
+		for (int x = 0; x < TILE; ++x)
+			dst[x * dstStride + y] = src[y * srcStride + x];
+#endif
+}
+
 void
 BitMatrix::rotate90()
 {
-	BitMatrix result(height(), width());
-	for (int x = 0; x < width(); ++x) {
-		for (int y = 0; y < height(); ++y) {
-			if (get(x, y)) {
-				result.set(y, width() - x - 1);
+	// counter clockwise: row r of the result is column width() - 1 - r, i.e. the transposed matrix upside down
+	BitMatrix result(_height, _width);
+	uint8_t* dst = result._bits.data() + (_width - 1) * _height;
+	for (int y0 = 0; y0 < _height; y0 += TILE)
+		for (int x0 = 0; x0 < _width; x0 += TILE) {
+			const int y1 = std::min(y0 + TILE, _height), x1 = std::min(x0 + TILE, _width);
+			if (y1 - y0 == TILE && x1 - x0 == TILE) {
+				TransposeTile(_bits.data() + y0 * _pitch + x0, _pitch, dst - x0 * _height + y0, -_height);
+				continue;
 			}
+			for (int x = x0; x < x1; ++x)
+				for (int y = y0; y < y1; ++y)
+					dst[y - x * _height] = _bits[y * _pitch + x];
 		}
-	}
 	*this = std::move(result);
 }
 
 void
 BitMatrix::rotate180()
 {
-	std::reverse(_bits.begin(), _bits.end());
+	if (_pitch == _width) {
+		std::reverse(_bits.begin(), _bits.end());
+		return;
+	}
+
+	// reverse the rows individually to keep the padding at their ends
+	for (int top = 0, bottom = _height - 1; top <= bottom; ++top, --bottom) {
+		std::reverse(row(top).begin(), row(top).end());
+		if (top != bottom) {
+			std::reverse(row(bottom).begin(), row(bottom).end());
+			std::swap_ranges(row(top).begin(), row(top).end(), row(bottom).begin());
+		}
+	}
 }
 
 void
 BitMatrix::mirror()
 {
-	for (int x = 0; x < _width; x++) {
-		for (int y = x + 1; y < _height; y++) {
-			if (get(x, y) != get(y, x)) {
-				flip(y, x);
-				flip(x, y);
+	// in place transposition of a square matrix, swaps (x, y) with (y, x) for all y > x
+	for (int x0 = 0; x0 < _width; x0 += TILE)
+		for (int y0 = x0; y0 < _height; y0 += TILE) {
+			const int x1 = std::min(x0 + TILE, _width), y1 = std::min(y0 + TILE, _height);
+			if (x1 - x0 == TILE && y1 - y0 == TILE) {
+				// swap the transposed tiles at (x0, y0) and (y0, x0), which is the same tile on the diagonal
+				uint8_t tmp[TILE * TILE];
+				uint8_t* a = _bits.data() + y0 * _pitch + x0;
+				uint8_t* b = _bits.data() + x0 * _pitch + y0;
+				TransposeTile(a, _pitch, tmp, TILE);
+				TransposeTile(b, _pitch, a, _pitch);
+				for (int i = 0; i < TILE; ++i)
+					std::copy_n(tmp + i * TILE, TILE, b + i * _pitch);
+				continue;
 			}
+			for (int x = x0; x < x1; ++x)
+				for (int y = std::max(y0, x + 1); y < y1; ++y)
+					std::swap(_bits[y * _pitch + x], _bits[x * _pitch + y]);
 		}
-	}
+}
+
+// The following two helpers scan 32 bytes per iteration while everything is 0 (the typical case for the margins of a
+// pure/rendered image, where the bounding box search is a good part of the total runtime) and locate the set byte
+// inside an 8 byte word with a single count leading/trailing zeros.
+using word_t = uint64_t;
+constexpr int WordSize = sizeof(word_t);
+
+// returns a pointer to the first byte != 0 in [p, end) or end
+static const uint8_t* FindFirstSet(const uint8_t* p, const uint8_t* end)
+{
+	using BitHacks::LoadU;
+	for (; end - p >= 4 * WordSize; p += 4 * WordSize)
+		if (LoadU<word_t>(p) | LoadU<word_t>(p + WordSize) | LoadU<word_t>(p + 2 * WordSize) | LoadU<word_t>(p + 3 * WordSize))
+			break;
+	for (; end - p >= WordSize; p += WordSize)
+		if (auto w = LoadU<word_t>(p))
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+			return p + BitHacks::NumberOfTrailingZeros(w) / 8;
+#else
+			return p + BitHacks::NumberOfLeadingZeros(w) / 8;
+#endif
+	while (p != end && !*p)
+		++p;
+	return p;
+}
+
+// returns a pointer behind the last byte != 0 in [begin, end) or begin
+static const uint8_t* FindLastSetEnd(const uint8_t* begin, const uint8_t* end)
+{
+	using BitHacks::LoadU;
+	for (; end - begin >= 4 * WordSize; end -= 4 * WordSize)
+		if (LoadU<word_t>(end - 4 * WordSize) | LoadU<word_t>(end - 3 * WordSize) | LoadU<word_t>(end - 2 * WordSize) |
+			LoadU<word_t>(end - WordSize))
+			break;
+	for (; end - begin >= WordSize; end -= WordSize)
+		if (auto w = LoadU<word_t>(end - WordSize))
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+			return end - BitHacks::NumberOfLeadingZeros(w) / 8;
+#else
+			return end - BitHacks::NumberOfTrailingZeros(w) / 8;
+#endif
+	while (end != begin && !end[-1])
+		--end;
+	return end;
 }
 
 bool
@@ -76,17 +215,11 @@ BitMatrix::findBoundingBox(int &left, int& top, int& width, int& height, int min
 	if (!getTopLeftOnBit(left, top) || !getBottomRightOnBit(right, bottom) || bottom - top + 1 < minSize)
 		return false;
 
-	for (int y = top; y <= bottom; y++ ) {
-		for (int x = 0; x < left; ++x)
-			if (get(x, y)) {
-				left = x;
-				break;
-			}
-		for (int x = _width-1; x > right; x--)
-			if (get(x, y)) {
-				right = x;
-				break;
-			}
+	// only the part of each row left of the current left and right of the current right needs to be looked at
+	for (int y = top; y <= bottom && (left > 0 || right < _width - 1); y++) {
+		const uint8_t* row = _bits.data() + y * _pitch;
+		left = narrow_cast<int>(FindFirstSet(row, row + left) - row);
+		right = narrow_cast<int>(FindLastSetEnd(row + right + 1, row + _width) - row) - 1;
 	}
 
 	width = right - left + 1;
@@ -94,30 +227,29 @@ BitMatrix::findBoundingBox(int &left, int& top, int& width, int& height, int min
 	return width >= minSize && height >= minSize;
 }
 
-static auto isSet = [](auto v) { return bool(v); };
-
 bool
 BitMatrix::getTopLeftOnBit(int& left, int& top) const
 {
-	int bitsOffset = (int)std::distance(_bits.begin(), std::find_if(_bits.begin(), _bits.end(), isSet));
+	int bitsOffset = narrow_cast<int>(FindFirstSet(_bits.data(), _bits.data() + _bits.size()) - _bits.data());
 	if (bitsOffset == Size(_bits)) {
 		return false;
 	}
-	top = bitsOffset / _width;
-	left = (bitsOffset % _width);
+	// the padding is never set, so the linear search can not end there
+	top = bitsOffset / _pitch;
+	left = (bitsOffset % _pitch);
 	return true;
 }
 
 bool
 BitMatrix::getBottomRightOnBit(int& right, int& bottom) const
 {
-	int bitsOffset = Size(_bits) - 1 - (int)std::distance(_bits.rbegin(), std::find_if(_bits.rbegin(), _bits.rend(), isSet));
+	int bitsOffset = narrow_cast<int>(FindLastSetEnd(_bits.data(), _bits.data() + _bits.size()) - _bits.data()) - 1;
 	if (bitsOffset < 0) {
 		return false;
 	}
 
-	bottom = bitsOffset / _width;
-	right = (bitsOffset % _width);
+	bottom = bitsOffset / _pitch;
+	right = (bitsOffset % _pitch);
 	return true;
 }
 
@@ -126,7 +258,7 @@ void GetPatternRow(const BitMatrix& matrix, int r, std::vector<uint16_t>& pr, bo
 	if (transpose)
 		GetPatternRow(matrix.col(r), pr);
 	else
-		GetPatternRow(matrix.row(r), pr);
+		GetPatternRow(matrix.row(r), pr, matrix.rowPitch() - matrix.width());
 }
 
 BitMatrix Inflate(BitMatrix&& input, int width, int height, int quietZone)
@@ -157,6 +289,35 @@ BitMatrix Inflate(BitMatrix&& input, int width, int height, int quietZone)
 	return result;
 }
 
+ScanlineRasterizer::ScanlineRasterizer(const BitMatrix& modules, int width, int height, int quietZone) : _modules(modules)
+{
+	if (modules.width() == 0 || modules.height() == 0)
+		throw std::invalid_argument("ScanlineRasterizer: empty module matrix");
+
+	const bool linear = modules.height() == 1;
+	_width = std::max(width, modules.width() + 2 * quietZone);
+	_height = linear ? std::max(1, height) : std::max(height, modules.height() + 2 * quietZone);
+	_scale = (_width - 2 * quietZone) / modules.width();
+	if (!linear)
+		_scale = std::min(_scale, (_height - 2 * quietZone) / modules.height());
+	_left = (_width - modules.width() * _scale) / 2;
+	_top = linear ? 0 : (_height - modules.height() * _scale) / 2;
+}
+
+void ScanlineRasterizer::render(int y, uint8_t* pixels, uint8_t black, uint8_t white) const
+{
+	std::fill_n(pixels, _width, white);
+
+	const bool linear = _modules.height() == 1;
+	if (!linear && (y < _top || y >= _top + _modules.height() * _scale))
+		return;
+
+	auto modules = _modules.row(linear ? 0 : (y - _top) / _scale).begin();
+	for (int x = 0; x < _modules.width(); ++x)
+		if (modules[x])
+			std::fill_n(pixels + _left + x * _scale, _scale, black);
+}
+
 BitMatrix Deflate(const BitMatrix& input, int width, int height, float top, float left, float subSampling)
 {
 	BitMatrix result(width, height);
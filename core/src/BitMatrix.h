@@ -7,9 +7,11 @@
 
 #pragma once
 
+#include "AlignedAllocator.h"
 #include "Matrix.h"
 #include "Point.h"
 #include "Range.h"
+#include "ZXConfig.h"
 
 #include <algorithm>
 #include <cstdint>
@@ -24,14 +26,19 @@ class ByteMatrix;
 
 /**
  * @brief A simple, fast 2D array of bits.
+ *
+ * The rows are stored one after the other, each rowPitch() bytes apart, starting at a 64 byte boundary. By default the
+ * pitch is the width, matrices created with a rowAlignment have their rows padded to a multiple of it, so each row starts
+ * at a SIMD register boundary and kernels can process whole registers without a scalar tail. The padding is never set.
  */
 class BitMatrix
 {
 	int _width = 0;
 	int _height = 0;
+	int _pitch = 0;
 	using data_t = uint8_t;
 
-	std::vector<data_t> _bits;
+	std::vector<data_t, AlignedAllocator<data_t>> _bits;
 	// There is nothing wrong to support this but disable to make it explicit since we may copy something very big here.
 	// Use copy() below.
 	BitMatrix(const BitMatrix&) = default;
@@ -39,7 +46,7 @@ class BitMatrix
 
 	const data_t& get(int i) const
 	{
-#if 1
+#if ZX_BITMATRIX_BOUNDS_CHECK
 		return _bits.at(i);
 #else
 		return _bits[i];
@@ -56,14 +63,20 @@ public:
 	static constexpr data_t UNSET_V = 0;
 	static_assert(bool(SET_V) && !bool(UNSET_V), "SET_V needs to evaluate to true, UNSET_V to false, see iterator usage");
 
+	static constexpr int ROW_ALIGNMENT = 32; // the rowAlignment of the matrices created by the binarizers (AVX2 register)
+
 	BitMatrix() = default;
 
+	BitMatrix(int width, int height) : BitMatrix(width, height, 1) {}
+
+	/// @param rowAlignment power of 2 (up to 64) the row pitch is rounded up to
 #if defined(__llvm__) || (defined(__GNUC__) && (__GNUC__ > 7))
 	__attribute__((no_sanitize("signed-integer-overflow")))
 #endif
-	BitMatrix(int width, int height) : _width(width), _height(height), _bits(width * height, UNSET_V)
+	BitMatrix(int width, int height, int rowAlignment)
+		: _width(width), _height(height), _pitch((width + rowAlignment - 1) & -rowAlignment), _bits(_pitch * height, UNSET_V)
 	{
-		if (width != 0 && Size(_bits) / width != height)
+		if (_pitch < width || (_pitch != 0 && Size(_bits) / _pitch != height))
 			throw std::invalid_argument("invalid size: width * height is too big");
 	}
 
@@ -74,16 +87,16 @@ public:
 
 	BitMatrix copy() const { return *this; }
 
-	Range<data_t*> row(int y) { return {_bits.data() + y * _width, _bits.data() + (y + 1) * _width}; }
-	Range<const data_t*> row(int y) const { return {_bits.data() + y * _width, _bits.data() + (y + 1) * _width}; }
+	Range<data_t*> row(int y) { return {_bits.data() + y * _pitch, _bits.data() + y * _pitch + _width}; }
+	Range<const data_t*> row(int y) const { return {_bits.data() + y * _pitch, _bits.data() + y * _pitch + _width}; }
 
 	Range<StrideIter<const data_t*>> col(int x) const
 	{
-		return {{_bits.data() + x + (_height - 1) * _width, -_width}, {_bits.data() + x - _width, -_width}};
+		return {{_bits.data() + x + (_height - 1) * _pitch, -_pitch}, {_bits.data() + x - _pitch, -_pitch}};
 	}
 
-	bool get(int x, int y) const { return get(y * _width + x); }
-	void set(int x, int y, bool val = true) { get(y * _width + x) = val * SET_V; }
+	bool get(int x, int y) const { return get(y * _pitch + x); }
+	void set(int x, int y, bool val = true) { get(y * _pitch + x) = val * SET_V; }
 
 	/**
 	* <p>Flips the given bit.</p>
@@ -93,15 +106,11 @@ public:
 	*/
 	void flip(int x, int y)
 	{
-		auto& v = get(y * _width + x);
+		auto& v = get(y * _pitch + x);
 		v = !v;
 	}
 
-	void flipAll()
-	{
-		for (auto& i : _bits)
-			i = !i * SET_V;
-	}
+	void flipAll();
 
 	/**
 	* <p>Sets a square region of the bit matrix to true.</p>
@@ -130,11 +139,22 @@ public:
 
 	int height() const { return _height; }
 
+	/// distance in bytes between the starts of two consecutive rows, the rowPitch() - width() bytes behind each row are
+	/// padding that may be read (it is always unset) but not written
+	int rowPitch() const { return _pitch; }
+
 	bool empty() const { return _bits.empty(); }
 
 	friend bool operator==(const BitMatrix& a, const BitMatrix& b)
 	{
-		return a._width == b._width && a._height == b._height && a._bits == b._bits;
+		if (a._width != b._width || a._height != b._height)
+			return false;
+		if (a._pitch == b._pitch)
+			return a._bits == b._bits; // the padding is unset in both
+		for (int y = 0; y < a._height; ++y)
+			if (!std::equal(a.row(y).begin(), a.row(y).end(), b.row(y).begin()))
+				return false;
+		return true;
 	}
 
 	template <typename T>
@@ -145,6 +165,10 @@ public:
 
 	bool get(PointI p) const { return get(p.x, p.y); }
 	bool get(PointF p) const { return get(PointI(p)); }
+
+	/// Same as get() but without bounds check, the caller has to make sure that isIn(p) is true.
+	bool getUnchecked(PointI p) const { return _bits[p.y * _pitch + p.x]; }
+	bool getUnchecked(PointF p) const { return getUnchecked(PointI(p)); }
 	void set(PointI p, bool v = true) { set(p.x, p.y, v); }
 	void set(PointF p, bool v = true) { set(PointI(p), v); }
 };
@@ -161,6 +185,30 @@ void GetPatternRow(const BitMatrix& matrix, int r, std::vector<uint16_t>& pr, bo
  */
 BitMatrix Inflate(BitMatrix&& input, int width, int height, int quietZone);
 
+/**
+ * @brief ScanlineRasterizer renders a module matrix scaled up to (at least) width x height pixels one scanline at a time
+ *
+ * The layout (integer scale factor, quiet zone, centered in the padding) is the same as the one of Inflate(), but the
+ * full resolution image never exists in memory. A matrix with a single row (a linear barcode, see
+ * MultiFormatWriter::encodeModules) is stretched to the full height without vertical quiet zone.
+ */
+class ScanlineRasterizer
+{
+	const BitMatrix& _modules;
+	int _width, _height, _scale, _left, _top;
+
+public:
+	/// @param quietZone size of quiet zone in modules, modules has to outlive the rasterizer
+	ScanlineRasterizer(const BitMatrix& modules, int width, int height, int quietZone);
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	int scale() const { return _scale; }
+
+	/// Writes the width() pixels of scanline y (0 <= y < height()) to pixels
+	void render(int y, uint8_t* pixels, uint8_t black = 0, uint8_t white = 0xff) const;
+};
+
 /**
  * @brief Deflate (crop + subsample) a bit matrix
  * @param matrix
@@ -5,13 +5,60 @@
 
 #pragma once
 
+#include "BitHacks.h"
 #include "BitMatrix.h"
+#include "ZXConfig.h"
 
 #include <array>
 #include <climits>
 
+#if defined(ZX_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace ZXing {
 
+/**
+ * @brief RunLength returns the number of steps from p[0] to the first of p[stride], p[2 * stride] ... p[n * stride] that
+ * is different from p[0], or n + 1 if all of them are equal (nothing beyond p[n * stride] is read and nothing at all
+ * if n < 1, p may point past the border then).
+ *
+ * Along a row (stride +/-1) 16 pixels are compared at once.
+ */
+inline int RunLength(const uint8_t* p, int stride, int n)
+{
+	if (n < 1)
+		return 1;
+	const uint8_t v = p[0];
+	int i = 1;
+#if defined(ZX_USE_SSE2)
+	const __m128i vv = _mm_set1_epi8(static_cast<char>(v));
+	if (stride == 1) {
+		for (; i + 15 <= n; i += 16)
+			if (int diff = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), vv)) & 0xFFFF)
+				return i + BitHacks::NumberOfTrailingZeros(diff);
+	} else if (stride == -1) {
+		// byte 15 of the block is p[-i], the nearest one
+		for (; i + 15 <= n; i += 16)
+			if (int diff = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p - i - 15)), vv)) & 0xFFFF)
+				return i + 15 - BitHacks::HighestBitSet(diff);
+	}
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+	const uint8x16_t vv = vdupq_n_u8(v);
+	if (stride == 1)
+		for (; i + 15 <= n && vminvq_u8(vceqq_u8(vld1q_u8(p + i), vv)) == 0xFF; i += 16)
+			;
+	else if (stride == -1)
+		for (; i + 15 <= n && vminvq_u8(vceqq_u8(vld1q_u8(p - i - 15), vv)) == 0xFF; i += 16)
+			;
+#endif
+	while (i <= n && p[i * stride] == v)
+		++i;
+	return i;
+}
+
 enum class Direction { LEFT = -1, RIGHT = 1 };
 
 inline Direction opposite(Direction dir) noexcept
@@ -58,7 +105,7 @@ public:
 	template <typename T>
 	Value testAt(PointT<T> p) const
 	{
-		return img->isIn(p) ? Value{img->get(p)} : Value{};
+		return img->isIn(p) ? Value{img->getUnchecked(p)} : Value{};
 	}
 
 	bool blackAt(POINT pos) const noexcept { return testAt(pos).isBlack(); }
@@ -113,6 +160,9 @@ public:
 	 */
 	int stepToEdge(int nth = 1, int range = 0, bool backup = false)
 	{
+		if ((d.x == 0 || d.y == 0) && (d.x + d.y == 1 || d.x + d.y == -1) && isIn(p))
+			return stepToEdgeAxisAligned(nth, range, backup);
+
 		int steps = 0;
 		auto lv = testAt(p);
 
@@ -130,6 +180,39 @@ public:
 		return steps * (nth == 0);
 	}
 
+	// same as stepToEdge for d being one of the 4 unit vectors, scanning the pixels via pointer (and SIMD along rows)
+	int stepToEdgeAxisAligned(int nth, int range, bool backup)
+	{
+		const int x = static_cast<int>(p.x), y = static_cast<int>(p.y);
+		const int dx = static_cast<int>(d.x), dy = static_cast<int>(d.y);
+		const int stride = dy * img->rowPitch() + dx;
+		const int toBorder = dx ? (dx > 0 ? img->width() - 1 - x : x) : (dy > 0 ? img->height() - 1 - y : y);
+		const uint8_t* ptr = img->row(y).begin() + x;
+
+		int steps = 0;
+		while (nth && (!range || steps < range)) {
+			int maxSteps = range ? std::min(range, toBorder) - steps : toBorder - steps;
+			int run = RunLength(ptr + steps * stride, stride, maxSteps);
+			if (run <= maxSteps) {
+				steps += run;
+				--nth;
+			} else {
+				if (range && range <= toBorder) {
+					steps = range;
+				} else {
+					// stepping outside of the image counts as an edge and ends the search
+					steps = toBorder + 1;
+					--nth;
+				}
+				break;
+			}
+		}
+		if (backup)
+			--steps;
+		p += steps * d;
+		return steps * (nth == 0);
+	}
+
 	bool stepAlongEdge(Direction dir, bool skipCorner = false)
 	{
 		if (!edgeAt(dir))
@@ -200,7 +283,7 @@ class FastEdgeToEdgeCounter
 public:
 	FastEdgeToEdgeCounter(const BitMatrixCursorI& cur)
 	{
-		stride = cur.d.y * cur.img->width() + cur.d.x;
+		stride = cur.d.y * cur.img->rowPitch() + cur.d.x;
 		p = cur.img->row(cur.p.y).begin() + cur.p.x;
 
 		int maxStepsX = cur.d.x ? (cur.d.x > 0 ? cur.img->width() - 1 - cur.p.x : cur.p.x) : INT_MAX;
@@ -211,15 +294,10 @@ public:
 	int stepToNextEdge(int range)
 	{
 		int maxSteps = std::min(stepsToBorder, range);
-		int steps = 0;
-		do {
-			if (++steps > maxSteps) {
-				if (maxSteps == stepsToBorder)
-					break;
-				else
-					return 0;
-			}
-		} while (p[steps * stride] == p[0]);
+		int steps = RunLength(p, stride, maxSteps);
+		// reaching the border counts as an edge
+		if (steps > maxSteps && maxSteps != stepsToBorder)
+			return 0;
 
 		p += steps * stride;
 		stepsToBorder -= steps;
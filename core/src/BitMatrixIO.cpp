@@ -6,8 +6,10 @@
 
 #include "BitMatrixIO.h"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 namespace ZXing {
 
@@ -30,26 +32,39 @@ std::string ToString(const BitMatrix& matrix, char one, char zero, bool addSpace
 	return result;
 }
 
-std::string ToSVG(const BitMatrix& matrix)
+void WriteSVG(std::ostream& out, const BitMatrix& matrix, int quietZone)
 {
 	// see https://stackoverflow.com/questions/10789059/create-qr-code-in-vector-image/60638350#60638350
 
-	const int width = matrix.width();
-	const int height = matrix.height();
-	std::ostringstream out;
+	const int width = matrix.width() + 2 * quietZone;
+	const int height = matrix.height() + 2 * quietZone;
 
 	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
 		<< "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" viewBox=\"0 0 " << width << " " << height
 		<< "\" stroke=\"none\">\n"
 		<< "<path d=\"";
 
-	for (int y = 0; y < height; ++y)
-		for (int x = 0; x < width; ++x)
-			if (matrix.get(x, y))
-				out << "M" << x << "," << y << "h1v1h-1z";
+	for (int y = 0; y < matrix.height(); ++y) {
+		auto row = matrix.row(y).begin();
+		for (int x = 0; x < matrix.width();) {
+			if (!row[x]) {
+				++x;
+				continue;
+			}
+			int start = x;
+			while (x < matrix.width() && row[x])
+				++x;
+			out << "M" << start + quietZone << "," << y + quietZone << "h" << x - start << "v1h-" << x - start << "z";
+		}
+	}
 
 	out << "\"/>\n</svg>";
+}
 
+std::string ToSVG(const BitMatrix& matrix, int quietZone)
+{
+	std::ostringstream out;
+	WriteSVG(out, matrix, quietZone);
 	return out.str();
 }
 
@@ -73,12 +88,41 @@ BitMatrix ParseBitMatrix(const std::string& str, char one, bool expectSpace)
 	return mat;
 }
 
+void WritePBM(std::ostream& out, const BitMatrix& matrix, int quietZone, int scale)
+{
+	const int width = (matrix.width() + 2 * quietZone) * scale;
+	const int height = (matrix.height() + 2 * quietZone) * scale;
+	const int stride = (width + 7) / 8;
+
+	out << "P4\n" << width << ' ' << height << "\n";
+
+	// in a PBM image a set bit is black, the padding bits at the end of each row are ignored
+	std::vector<uint8_t> line(stride, 0);
+	auto writeLine = [&](int count) {
+		for (int i = 0; i < count; ++i)
+			out.write(reinterpret_cast<const char*>(line.data()), stride);
+	};
+
+	writeLine(quietZone * scale);
+
+	for (int y = 0; y < matrix.height(); ++y) {
+		std::fill(line.begin(), line.end(), 0);
+		auto row = matrix.row(y).begin();
+		for (int x = 0; x < matrix.width(); ++x)
+			if (row[x])
+				for (int px = (x + quietZone) * scale, end = px + scale; px < end; ++px)
+					line[px / 8] |= 0x80 >> (px % 8);
+		writeLine(scale);
+	}
+
+	std::fill(line.begin(), line.end(), 0);
+	writeLine(quietZone * scale);
+}
+
 void SaveAsPBM(const BitMatrix& matrix, const std::string filename, int quietZone)
 {
-	auto out = ToMatrix<uint8_t>(Inflate(matrix.copy(), 0, 0, quietZone));
-	std::ofstream file(filename);
-	file << "P5\n" << out.width() << ' ' << out.height() << "\n255\n";
-	file.write(reinterpret_cast<const char*>(out.data()), out.size());
+	std::ofstream file(filename, std::ios::binary);
+	WritePBM(file, matrix, quietZone);
 }
 
 } // ZXing
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <ostream>
 #include <string>
 
 #include "BitMatrix.h"
@@ -13,8 +14,23 @@
 namespace ZXing {
 
 std::string ToString(const BitMatrix& matrix, char one = 'X', char zero = ' ', bool addSpace = true, bool printAsCString = false);
-std::string ToSVG(const BitMatrix& matrix);
+std::string ToSVG(const BitMatrix& matrix, int quietZone = 0);
 BitMatrix ParseBitMatrix(const std::string& str, char one = 'X', bool expectSpace = true);
 void SaveAsPBM(const BitMatrix& matrix, const std::string filename, int quietZone = 0);
 
+/**
+ * @brief WriteSVG streams the matrix as an SVG document with a single <path> element
+ *
+ * Each horizontal run of set modules is one closed sub path, so the document size scales with the number of runs
+ * instead of the number of modules. One unit of the viewBox corresponds to one module.
+ */
+void WriteSVG(std::ostream& out, const BitMatrix& matrix, int quietZone = 0);
+
+/**
+ * @brief WritePBM streams the matrix as a binary (P4) PBM image with scale x scale pixels per module
+ *
+ * The rows are packed to 8 pixels per byte straight from the matrix, there is no intermediate full size image.
+ */
+void WritePBM(std::ostream& out, const BitMatrix& matrix, int quietZone = 0, int scale = 1);
+
 } // ZXing
@@ -9,69 +9,57 @@
 #include "ByteArray.h"
 #include "ZXAlgorithms.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace ZXing {
 
-int
-BitSource::available() const
+BitSource::BitSource(const ByteArray& bytes) : BitSource(bytes, 8 * Size(bytes)) {}
+
+BitSource::BitSource(const ByteArray& bytes, int numBits) : _bytes(bytes.data()), _size(numBits)
 {
-	return 8 * (Size(_bytes) - _byteOffset) - _bitOffset;
+	if (numBits < 0 || numBits > 8 * Size(bytes))
+		throw std::out_of_range("BitSource: invalid number of bits");
 }
 
-static int ReadBitsImpl(int numBits, const ByteArray& _bytes, int available, int& _byteOffset, int& _bitOffset)
+// The (up to) 8 bytes starting with the one containing the next bit, the first one in the most significant byte. If 8
+// bytes are left, the loop has a fixed trip count, which compilers turn into a single (byte swapped) 64 bit load.
+uint64_t BitSource::window() const
 {
-	if (numBits < 1 || numBits > 32 || numBits > available) {
-		throw std::out_of_range("BitSource::readBits: out of range");
-	}
-
-	int result = 0;
-
-	// First, read remainder from current byte
-	if (_bitOffset > 0) {
-		int bitsLeft = 8 - _bitOffset;
-		int toRead = numBits < bitsLeft ? numBits : bitsLeft;
-		int bitsToNotRead = bitsLeft - toRead;
-		int mask = (0xFF >> (8 - toRead)) << bitsToNotRead;
-		result = (_bytes[_byteOffset] & mask) >> bitsToNotRead;
-		numBits -= toRead;
-		_bitOffset += toRead;
-		if (_bitOffset == 8) {
-			_bitOffset = 0;
-			_byteOffset++;
-		}
+	const uint8_t* p = _bytes + _pos / 8;
+	int n = std::min(8, (_size + 7) / 8 - _pos / 8);
+	uint64_t res = 0;
+	if (n == 8) {
+		for (int i = 0; i < 8; ++i)
+			res = (res << 8) | p[i];
+	} else {
+		for (int i = 0; i < n; ++i)
+			res |= uint64_t(p[i]) << (56 - 8 * i);
 	}
+	return res << (_pos % 8);
+}
 
-	// Next read whole bytes
-	if (numBits > 0) {
-		while (numBits >= 8) {
-			result = (result << 8) | _bytes[_byteOffset];
-			_byteOffset++;
-			numBits -= 8;
-		}
-
-		// Finally read a partial byte
-		if (numBits > 0) {
-			int bitsToNotRead = 8 - numBits;
-			int mask = (0xFF >> bitsToNotRead) << bitsToNotRead;
-			result = (result << numBits) | ((_bytes[_byteOffset] & mask) >> bitsToNotRead);
-			_bitOffset += numBits;
-		}
-	}
+int BitSource::peakBits(int numBits) const
+{
+	if (numBits < 1 || numBits > 32 || numBits > available())
+		throw std::out_of_range("BitSource::readBits: out of range");
 
-	return result;
+	return static_cast<int>(static_cast<uint32_t>(window() >> (64 - numBits)));
 }
 
 int BitSource::readBits(int numBits)
 {
-	return ReadBitsImpl(numBits, _bytes, available(), _byteOffset, _bitOffset);
+	int res = peakBits(numBits);
+	_pos += numBits;
+	return res;
 }
 
-int BitSource::peakBits(int numBits) const
+BitSource& BitSource::skipBits(int numBits)
 {
-	int bitOffset = _bitOffset;
-	int byteOffset = _byteOffset;
-	return ReadBitsImpl(numBits, _bytes, available(), byteOffset, bitOffset);
+	if (numBits < 0 || numBits > available())
+		throw std::out_of_range("BitSource::skipBits: out of range");
+	_pos += numBits;
+	return *this;
 }
 
 } // ZXing
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace ZXing {
 
 class ByteArray;
@@ -14,6 +16,9 @@ class ByteArray;
 * <p>This provides an easy abstraction to read bits at a time from a sequence of bytes, where the
 * number of bits read is not often a multiple of 8.</p>
 *
+* <p>The bits are read through a 64 bit window loaded from the bytes at the current position, i.e. any
+* read of up to 57 bits touches each byte only once, regardless of the alignment.</p>
+*
 * <p>This class is thread-safe but not reentrant -- unless the caller modifies the bytes array
 * it passed in, in which case all bets are off.</p>
 *
@@ -21,9 +26,11 @@ class ByteArray;
 */
 class BitSource
 {
-	const ByteArray& _bytes;
-	int _byteOffset = 0;
-	int _bitOffset = 0;
+	const uint8_t* _bytes;
+	int _size; // number of bits
+	int _pos = 0; // index of the next bit
+
+	uint64_t window() const;
 
 public:
 	/**
@@ -31,8 +38,13 @@ public:
 	* Bits are read within a byte from most-significant to least-significant bit.
 	* IMPORTANT: Bit source DOES NOT copy data byte, thus make sure that the bytes outlive the bit source object.
 	*/
-	explicit BitSource(const ByteArray& bytes) : _bytes(bytes) {}
-	
+	explicit BitSource(const ByteArray& bytes);
+
+	/**
+	* @param numBits number of valid bits in bytes, i.e. the last byte may be used only partially
+	*/
+	BitSource(const ByteArray& bytes, int numBits);
+
 	BitSource(BitSource &) = delete;
 	BitSource& operator=(const BitSource &) = delete;
 
@@ -40,14 +52,14 @@ public:
 	* @return index of next bit in current byte which would be read by the next call to {@link #readBits(int)}.
 	*/
 	int bitOffset() const {
-		return _bitOffset;
+		return _pos % 8;
 	}
 
 	/**
 	* @return index of next byte in input byte array which would be read by the next call to {@link #readBits(int)}.
 	*/
 	int byteOffset() const {
-		return _byteOffset;
+		return _pos / 8;
 	}
 
 	/**
@@ -63,10 +75,17 @@ public:
 	*/
 	int peakBits(int numBits) const;
 
+	/**
+	* @param numBits number of bits to skip
+	*/
+	BitSource& skipBits(int numBits);
+
 	/**
 	* @return number of bits that can be read successfully
 	*/
-	int available() const;
+	int available() const {
+		return _size - _pos;
+	}
 };
 
 } // ZXing
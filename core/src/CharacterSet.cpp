@@ -19,7 +19,7 @@ struct CharacterSetName
 	CharacterSet cs;
 };
 
-static CharacterSetName NAME_TO_CHARSET[] = {
+static constexpr CharacterSetName NAME_TO_CHARSET[] = {
 	{"Cp437",		CharacterSet::Cp437},
 	{"ISO-8859-1",	CharacterSet::ISO8859_1},
 	{"ISO-8859-2",	CharacterSet::ISO8859_2},
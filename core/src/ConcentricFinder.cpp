@@ -98,20 +98,21 @@ std::optional<PointF> CenterOfRings(const BitMatrix& image, PointF center, int r
 	return sum / n;
 }
 
-static std::vector<PointF> CollectRingPoints(const BitMatrix& image, PointF center, int range, int edgeIndex, bool backup)
+// points is cleared and filled with the pixels along the edge, returns false if the edge does not go round the center
+static bool CollectRingPoints(const BitMatrix& image, PointF center, int range, int edgeIndex, bool backup,
+							  std::vector<PointF>& points)
 {
+	points.clear();
 	PointI centerI(center);
 	int radius = range;
 	BitMatrixCursorI cur(image, centerI, {0, 1});
 	if (!cur.stepToEdge(edgeIndex, radius, backup))
-		return {};
+		return false;
 	cur.turnRight(); // move clock wise and keep edge on the right/left depending on backup
 	const auto edgeDir = backup ? Direction::LEFT : Direction::RIGHT;
 
 	uint32_t neighbourMask = 0;
 	auto start = cur.p;
-	std::vector<PointF> points;
-	points.reserve(4 * range);
 
 	do {
 		log(cur.p, 4);
@@ -121,18 +122,15 @@ static std::vector<PointF> CollectRingPoints(const BitMatrix& image, PointF cent
 		neighbourMask |= (1 << (4 + dot(bresenhamDirection(cur.p - centerI), PointI(1, 3))));
 
 		if (!cur.stepAlongEdge(edgeDir))
-			return {};
+			return false;
 
 		// use L-inf norm, simply because it is a lot faster than L2-norm and sufficiently accurate
 		if (maxAbsComponent(cur.p - centerI) > radius || centerI == cur.p || Size(points) > 4 * 2 * range)
-			return {};
+			return false;
 
 	} while (cur.p != start);
 
-	if (neighbourMask != 0b111101111)
-		return {};
-
-	return points;
+	return neighbourMask == 0b111101111;
 }
 
 static std::optional<QuadrilateralF> FitQadrilateralToPoints(PointF center, std::vector<PointF>& points)
@@ -154,7 +152,7 @@ static std::optional<QuadrilateralF> FitQadrilateralToPoints(PointF center, std:
 	std::array lines{RegressionLine{corners[0] + 1, corners[1]}, RegressionLine{corners[1] + 1, corners[2]},
 					 RegressionLine{corners[2] + 1, corners[3]}, RegressionLine{corners[3] + 1, &points.back() + 1}};
 
-	if (std::any_of(lines.begin(), lines.end(), [](auto line) { return !line.isValid(); }))
+	if (std::any_of(lines.begin(), lines.end(), [](const auto& line) { return !line.isValid(); }))
 		return {};
 
 	std::array<const PointF*, 4> beg = {corners[0] + 1, corners[1] + 1, corners[2] + 1, corners[3] + 1};
@@ -191,8 +189,9 @@ static bool QuadrilateralIsPlausibleSquare(const QuadrilateralF q, int lineIndex
 
 static std::optional<QuadrilateralF> FitSquareToPoints(const BitMatrix& image, PointF center, int range, int lineIndex, bool backup)
 {
-	auto points = CollectRingPoints(image, center, range, lineIndex, backup);
-	if (points.empty())
+	// reused for all candidates, the ring of a finder pattern in a large image has thousands of points
+	thread_local std::vector<PointF> points;
+	if (!CollectRingPoints(image, center, range, lineIndex, backup, points))
 		return {};
 
 	auto res = FitQadrilateralToPoints(center, points);
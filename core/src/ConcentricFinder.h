@@ -99,6 +99,8 @@ int CheckSymmetricPattern(BitMatrixCursorI& cur, PATTERN pattern, int range, boo
 
 std::optional<PointF> CenterOfRing(const BitMatrix& image, PointI center, int range, int nth, bool requireCircle = true);
 
+std::optional<PointF> CenterOfRings(const BitMatrix& image, PointF center, int range, int numOfRings);
+
 std::optional<PointF> FinetuneConcentricPatternCenter(const BitMatrix& image, PointF center, int range, int finderPatternSize);
 
 std::optional<QuadrilateralF> FindConcentricPatternCorners(const BitMatrix& image, PointF center, int range, int ringIndex);
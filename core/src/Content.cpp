@@ -42,6 +42,7 @@ void Content::ForEachECIBlock(FUNC func) const
 
 void Content::switchEncoding(ECI eci, bool isECI)
 {
+	_guessedSize = -1;
 	// remove all non-ECI entries on first ECI entry
 	if (isECI && !hasECI)
 		encodings.clear();
@@ -62,6 +63,7 @@ void Content::switchEncoding(CharacterSet cs)
 
 void Content::append(const Content& other)
 {
+	_guessedSize = -1;
 	if (!hasECI && other.hasECI)
 		encodings.clear();
 	if (other.hasECI || !hasECI)
@@ -190,17 +192,33 @@ ByteArray Content::bytesECI() const
 
 CharacterSet Content::guessEncoding() const
 {
-	// assemble all blocks with unknown encoding
+	// text() and type() both need it, Result::text() calls both
+	if (_guessedSize == Size(bytes))
+		return _guessedEncoding;
+
+	// assemble all blocks with unknown encoding, the common case of a single one is used in place
 	ByteArray input;
-	ForEachECIBlock([&](ECI eci, int begin, int end) {
-		if (eci == ECI::Unknown)
-			input.insert(input.end(), bytes.begin() + begin, bytes.begin() + end);
+	const uint8_t* begin = nullptr;
+	size_t length = 0;
+	int blocks = 0;
+	ForEachECIBlock([&](ECI eci, int b, int e) {
+		if (eci != ECI::Unknown)
+			return;
+		if (blocks++ == 0) {
+			begin = bytes.data() + b;
+			length = e - b;
+		} else {
+			if (blocks == 2)
+				input.insert(input.end(), begin, begin + length);
+			input.insert(input.end(), bytes.begin() + b, bytes.begin() + e);
+		}
 	});
+	if (blocks > 1)
+		begin = input.data(), length = input.size();
 
-	if (input.empty())
-		return CharacterSet::Unknown;
-
-	return TextDecoder::GuessEncoding(input.data(), input.size(), CharacterSet::ISO8859_1);
+	_guessedEncoding = length ? TextDecoder::GuessEncoding(begin, length, CharacterSet::ISO8859_1) : CharacterSet::Unknown;
+	_guessedSize = Size(bytes);
+	return _guessedEncoding;
 }
 
 ContentType Content::type() const
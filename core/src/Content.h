@@ -9,7 +9,9 @@
 #include "CharacterSet.h"
 #include "DecodeHints.h"
 
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ZXing {
@@ -40,6 +42,11 @@ class Content
 	void switchEncoding(ECI eci, bool isECI);
 	std::string render(bool withECI) const;
 
+	// the cached result of guessEncoding(), valid as long as bytes has the size it had then (-1: none). The member
+	// functions changing the encodings reset it.
+	mutable int _guessedSize = -1;
+	mutable CharacterSet _guessedEncoding = CharacterSet::Unknown;
+
 public:
 	struct Encoding
 	{
@@ -59,15 +66,25 @@ public:
 	void switchEncoding(ECI eci) { switchEncoding(eci, true); }
 	void switchEncoding(CharacterSet cs);
 
-	void reserve(int count) { bytes.reserve(bytes.size() + count); }
+	/**
+	 * Makes room for (at least) count more bytes. Decoders call this once with an upper bound derived from the number of
+	 * data code words, so the content of a symbol is built with a single allocation. The capacity grows geometrically,
+	 * so the per segment calls inside a decoder do not cause a reallocation each.
+	 */
+	void reserve(int count)
+	{
+		if (bytes.capacity() < bytes.size() + count)
+			bytes.reserve(std::max(bytes.size() + count, 2 * bytes.capacity()));
+	}
 
 	void push_back(uint8_t val) { bytes.push_back(val); }
-	void append(const std::string& str) { bytes.insert(bytes.end(), str.begin(), str.end()); }
+	void append(std::string_view str) { bytes.insert(bytes.end(), str.begin(), str.end()); }
+	void append(const uint8_t* data, int count) { bytes.insert(bytes.end(), data, data + count); }
 	void append(const ByteArray& ba) { bytes.insert(bytes.end(), ba.begin(), ba.end()); }
 	void append(const Content& other);
 
 	void operator+=(char val) { push_back(val); }
-	void operator+=(const std::string& str) { append(str); }
+	void operator+=(std::string_view str) { append(str); }
 
 	void erase(int pos, int n);
 	void insert(int pos, const std::string& str);
@@ -0,0 +1,73 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "CpuFeatures.h"
+
+#include <atomic>
+
+#if defined(ZX_USE_SSE2) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(ZX_USE_NEON) && defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#elif defined(ZX_USE_NEON) && defined(__aarch64__) && defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+namespace ZXing {
+
+static uint32_t DetectCpuFeatures()
+{
+	uint32_t res = 0;
+#if defined(ZX_USE_SSE2) && defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+	__cpuid(info, 1);
+	if (info[2] & (1 << 9))
+		res |= SSSE3;
+	if (info[2] & (1 << 19))
+		res |= SSE41;
+	// AVX2 needs the OS to save the YMM registers (OSXSAVE and XCR0 bits 1 and 2)
+	const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+	if (maxLeaf >= 7 && osSavesYmm) {
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+			res |= AVX2;
+	}
+#elif defined(ZX_USE_SSE2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3"))
+		res |= SSSE3;
+	if (__builtin_cpu_supports("sse4.1"))
+		res |= SSE41;
+	if (__builtin_cpu_supports("avx2"))
+		res |= AVX2;
+#elif defined(ZX_USE_NEON) && defined(__aarch64__) && defined(__linux__)
+	if (getauxval(AT_HWCAP) & (1 << 20)) // HWCAP_ASIMDDP
+		res |= DotProd;
+#elif defined(ZX_USE_NEON) && defined(__aarch64__) && defined(__APPLE__)
+	int value = 0;
+	size_t size = sizeof(value);
+	if (sysctlbyname("hw.optional.arm.FEAT_DotProd", &value, &size, nullptr, 0) == 0 && value)
+		res |= DotProd;
+#endif
+	return res;
+}
+
+static std::atomic<uint32_t> featureMask = ~0u;
+
+uint32_t CpuFeatures()
+{
+	static const uint32_t detected = DetectCpuFeatures();
+	return detected & featureMask.load(std::memory_order_relaxed);
+}
+
+void SetCpuFeatureMask(uint32_t mask)
+{
+	featureMask.store(mask, std::memory_order_relaxed);
+}
+
+} // ZXing
@@ -0,0 +1,62 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ZXConfig.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Marks a function to be compiled for an instruction set extension the whole build is not compiled for, e.g.
+// ZX_TARGET("ssse3"). It must only be called (via SelectKernel) if the CPU supports it. MSVC does not need (nor support)
+// this, its intrinsics are always available.
+#if defined(ZX_USE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define ZX_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ZX_TARGET(isa)
+#endif
+
+namespace ZXing {
+
+/// Instruction set extensions beyond the compile time baseline of ZX_USE_SSE2 / ZX_USE_NEON (see ZXConfig.h)
+enum CpuFeature : uint32_t
+{
+	SSSE3   = 1 << 0,
+	SSE41   = 1 << 1,
+	AVX2    = 1 << 2,
+	DotProd = 1 << 3, ///< ARMv8.2 NEON dot product
+};
+
+/// The CpuFeature flags of the CPU the code runs on, detected on the first call (thread-safe)
+uint32_t CpuFeatures();
+
+/// Restrict the features CpuFeatures() reports to mask (~0 = all detected), e.g. to compare the kernel variants in tests
+void SetCpuFeatureMask(uint32_t mask);
+
+template <typename FN>
+struct Kernel
+{
+	uint32_t features; ///< the CpuFeature flags fn needs
+	FN fn;
+};
+
+/**
+ * Runtime dispatch of the variants of a SIMD kernel: returns the first one the CPU has all the features for. The list is
+ * ordered from the most to the least demanding variant, the last one (the baseline) must not need any feature.
+ * Selecting is cheap, but not free, so do it once per call of the outer loop, not per iteration.
+ */
+template <typename FN, std::size_t N>
+FN SelectKernel(const Kernel<FN> (&kernels)[N])
+{
+	static_assert(N > 0, "no kernel");
+	const uint32_t features = CpuFeatures();
+	for (const auto& k : kernels)
+		if ((k.features & features) == k.features)
+			return k.fn;
+	return kernels[N - 1].fn;
+}
+
+} // ZXing
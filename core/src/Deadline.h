@@ -0,0 +1,24 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <chrono>
+
+namespace ZXing {
+
+/**
+ * @brief Deadline is the point in time after which all (potentially) long running loops stop searching.
+ *
+ * The default (Deadline::max()) means no deadline. See DecodeHints::deadline().
+ */
+using Deadline = std::chrono::steady_clock::time_point;
+
+inline bool IsExpired(Deadline deadline) noexcept
+{
+	return deadline != Deadline::max() && std::chrono::steady_clock::now() >= deadline;
+}
+
+} // ZXing
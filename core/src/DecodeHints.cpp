@@ -6,6 +6,46 @@
 
 #include "DecodeHints.h"
 
+#include "Executor.h"
+
+#include <algorithm>
+
 namespace ZXing {
 
+DecodeHints DecodeHints::forFormats(BarcodeFormats formats) const
+{
+	DecodeHints res = *this;
+	for (const auto& o : _formatOverrides) {
+		if (!o.formats.testFlags(formats))
+			continue;
+		if (o.tryHarder)
+			res._tryHarder = *o.tryHarder;
+		if (o.tryRotate)
+			res._tryRotate = *o.tryRotate;
+		if (o.tryInvert)
+			res._tryInvert = *o.tryInvert;
+		if (o.minLineCount)
+			res._minLineCount = *o.minLineCount;
+	}
+	return res;
+}
+
+bool DecodeHints::tryInvertAny() const noexcept
+{
+	return _tryInvert || std::any_of(_formatOverrides.begin(), _formatOverrides.end(), [](const FormatOverride& o) {
+			   return o.tryInvert.value_or(false);
+		   });
+}
+
+std::shared_ptr<Executor> SelectExecutor(const DecodeHints& hints)
+{
+	if (hints.executor())
+		return std::shared_ptr<Executor>(std::shared_ptr<Executor>(), hints.executor()); // non-owning
+	if (auto executor = DefaultExecutor())
+		return executor;
+	if (hints.threads() != 1)
+		return std::make_shared<ThreadExecutor>(hints.threads());
+	return {};
+}
+
 } // ZXing
@@ -9,12 +9,25 @@
 
 #include "BarcodeFormat.h"
 #include "CharacterSet.h"
+#include "Deadline.h"
+#include "ImageView.h"
+#include "ZXConfig.h"
 
+#ifdef ZX_HAVE_PMR
+#include <memory_resource>
+#endif
+
+#include <optional>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 namespace ZXing {
 
+class BinarizerBackend;
+class DecodeStats;
+class Executor;
+
 /**
  * @brief The Binarizer enum
  *
@@ -28,6 +41,7 @@ enum class Binarizer : unsigned char // needs to be unsigned for the bitfield be
 	GlobalHistogram, ///< T = valley between the 2 largest peaks in the histogram (per line in linear case)
 	FixedThreshold,  ///< T = 127
 	BoolCast,        ///< T = 0, fastest possible
+	Adaptive,        ///< T = 85% of the mean of a large window around each pixel (Bradley/Roth, via integral image)
 };
 
 enum class EanAddOnSymbol : unsigned char // see above
@@ -46,6 +60,20 @@ enum class TextMode : unsigned char // see above
 	Escaped, ///< Use the EscapeNonGraphical() function (e.g. ASCII 29 will be transcoded to "<GS>")
 };
 
+/**
+ * @brief Options that apply to some of the BarcodeFormats only, see DecodeHints::setFormatOverrides()
+ *
+ * The values that are not set are inherited from the DecodeHints.
+ */
+struct FormatOverride
+{
+	BarcodeFormats formats;
+	std::optional<bool> tryHarder;
+	std::optional<bool> tryRotate;
+	std::optional<bool> tryInvert;
+	std::optional<uint8_t> minLineCount;
+};
+
 class DecodeHints
 {
 	bool _tryHarder                : 1;
@@ -54,23 +82,51 @@ class DecodeHints
 	bool _tryDownscale             : 1;
 	bool _isPure                   : 1;
 	bool _tryCode39ExtendedMode    : 1;
+	bool _tryDataMatrixLegacyDetector : 1;
 	bool _validateCode39CheckSum   : 1;
 	bool _validateITFCheckSum      : 1;
 	bool _returnCodabarStartEnd    : 1;
 	bool _returnErrors             : 1;
+	bool _coarseToFine             : 1;
+	bool _subPixelEdges            : 1;
+	bool _trackSymbols             : 1;
+	bool _tryLuminanceSampling     : 1;
+	bool _preClassify              : 1;
+	bool _adaptiveReaderOrder      : 1;
+	bool _escalate                 : 1;
+	bool _detectOnly               : 1;
+	bool _deriveLayerBlackPoints   : 1;
 	uint8_t _downscaleFactor       : 3;
 	EanAddOnSymbol _eanAddOnSymbol : 2;
-	Binarizer _binarizer           : 2;
+	Binarizer _binarizer           : 3;
 	TextMode _textMode             : 3;
 	CharacterSet _characterSet     : 6;
 #ifdef ZXING_BUILD_EXPERIMENTAL_API
 	bool _tryDenoise               : 1;
 #endif
 
-	uint8_t _minLineCount        = 2;
-	uint8_t _maxNumberOfSymbols  = 0xff;
-	uint16_t _downscaleThreshold = 500;
-	BarcodeFormats _formats      = BarcodeFormat::None;
+	uint8_t _minLineCount         = 2;
+	uint8_t _maxNumberOfSymbols   = 0xff;
+	uint8_t _threads              = 1;
+	uint8_t _minFrameSharpness    = 0;
+	uint8_t _frameChangeThreshold = 0;
+	uint16_t _downscaleThreshold  = 500;
+	uint16_t _tileSize            = 0;
+	uint16_t _tileOverlap         = 0;
+	float _minModuleSize          = 0;
+	float _maxModuleSize          = 0;
+	float _minConfidence          = 0;
+	BarcodeFormats _formats       = BarcodeFormat::None;
+	Executor* _executor           = nullptr;
+	BinarizerBackend* _binarizerBackend = nullptr;
+	DecodeStats* _stats           = nullptr;
+#ifdef ZX_HAVE_PMR
+	std::pmr::memory_resource* _memoryResource = nullptr;
+#endif
+	Deadline _deadline            = Deadline::max();
+	std::vector<Rect> _regionsOfInterest;
+	std::vector<FormatOverride> _formatOverrides;
+	std::vector<Binarizer> _fallbackBinarizers;
 
 public:
 	// bitfields don't get default initialized to 0 before c++20
@@ -81,10 +137,20 @@ public:
 		  _tryDownscale(1),
 		  _isPure(0),
 		  _tryCode39ExtendedMode(0),
+		  _tryDataMatrixLegacyDetector(0),
 		  _validateCode39CheckSum(0),
 		  _validateITFCheckSum(0),
 		  _returnCodabarStartEnd(0),
 		  _returnErrors(0),
+		  _coarseToFine(0),
+		  _subPixelEdges(0),
+		  _trackSymbols(0),
+		  _tryLuminanceSampling(0),
+		  _preClassify(0),
+		  _adaptiveReaderOrder(0),
+		  _escalate(0),
+		  _detectOnly(0),
+		  _deriveLayerBlackPoints(0),
 		  _downscaleFactor(3),
 		  _eanAddOnSymbol(EanAddOnSymbol::Ignore),
 		  _binarizer(Binarizer::LocalAverage),
@@ -121,6 +187,65 @@ public:
 	ZX_PROPERTY(bool, tryDenoise, setTryDenoise)
 #endif
 
+	/// Process the downscaled images from the smallest to the largest and ignore the areas of already found symbols
+	/// in the higher resolution layers (speeds up the multi-symbol use case, implies sequential processing).
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, coarseToFine, setCoarseToFine)
+
+	/// Treat tryHarder, tryRotate, tryInvert, tryDenoise and tryDownscale as an escalation policy instead of running
+	/// all of them on every image: first do a fast pass over the full resolution image (neither of them), then the
+	/// passes of the regular schedule (the thorough readers, the inverted and the closed image, the downscaled layers)
+	/// one after the other, and stop after the first one that found something. The binarized image of the full
+	/// resolution layer is shared by all its passes. Implies sequential processing of the passes.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, escalate, setEscalate)
+
+	/// Only localize the symbols: the matrix readers (and PDF417) stop after the detection and return Results with a
+	/// format and a position but without content (no sampling of the data modules beyond what the detector validates,
+	/// no error correction, no text handling). The linear readers still decode their rows, as a decoded row is what
+	/// tells a symbol from any other set of bars. Meant for aiming a second, high resolution capture at the symbols.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, detectOnly, setDetectOnly)
+
+	/// Measure the bar/space widths of linear symbols with sub-pixel precision by interpolating the threshold crossings
+	/// in the luminance data (helps with low resolution/blurry images, only affects the LocalAverage and
+	/// GlobalHistogram binarizers).
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, subPixelEdges, setSubPixelEdges)
+
+	/// When repeatedly reading similar images with the same BarcodeReader (e.g. the frames of a video stream), first try
+	/// to find the QR Code symbols of the last image again at their previous position before scanning the whole image.
+	/// This only kicks in if the last image contained at least maxNumberOfSymbols() symbols (e.g. set it to 1).
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, trackSymbols, setTrackSymbols)
+
+	/// If the modules of a detected QR Code sampled from the binarized image do not decode, sample them again from the
+	/// luminance image (bilinear interpolation, local threshold) before dropping the candidate. Helps with blurry images,
+	/// where modules close to the threshold of the binarizer flip, and saves the following tryHarder/inverted passes.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, tryLuminanceSampling, setTryLuminanceSampling)
+
+	/// Classify the tiles of the binarized image by their texture first (see ClassifyTiles) and only run the readers of
+	/// the symbologies the image shows structures of: linear readers need tiles with parallel bars, matrix readers tiles
+	/// with edges in all directions. The linear readers also skip the rows without bars. Saves detector work on images
+	/// with only some of the requested formats (or none at all), but may miss symbols the classification misjudges.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, preClassify, setPreClassify)
+
+	/// Let the reader of a BarcodeReader session keep track of how often and at what cost each symbology reader finds
+	/// a symbol and run them in the order of their expected time to the first result (cost / hit rate), instead of the
+	/// fixed one. Pays off when most images contain the same symbology and only the first (maxNumberOfSymbols == 1)
+	/// result is wanted. The statistics decay over time, so the order follows a changing input.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, adaptiveReaderOrder, setAdaptiveReaderOrder)
+
+	/// Approximate the LocalAverage black points of the second and following downscaled layers from the block statistics
+	/// (sum, min, max) of the previous layer instead of from their pixels, which makes binarizing them nearly free. The
+	/// averages are exact up to rounding, but the dynamic range of a block is that of the pixels it was averaged from,
+	/// so fewer blocks are treated as low contrast (uniform) areas than with the regular computation.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(bool, deriveLayerBlackPoints, setDeriveLayerBlackPoints)
+
 	/// Binarizer to use internally when using the ReadBarcode function
 	ZX_PROPERTY(Binarizer, binarizer, setBinarizer)
 
@@ -141,9 +266,72 @@ public:
 	/// The maximum number of symbols (barcodes) to detect / look for in the image with ReadBarcodes
 	ZX_PROPERTY(uint8_t, maxNumberOfSymbols, setMaxNumberOfSymbols)
 
+	/// The number of threads the library may use for internal parallel processing if no Executor is set (0 = all cores)
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(uint8_t, threads, setThreads)
+
+	/// Skip images whose estimated sharpness (in percent, see EstimateFrameQuality) is below this value without looking
+	/// for symbols, e.g. the motion blurred frames of a handheld scanner (0 = off). The edges of an image blurred over
+	/// n pixels (of the first downscaled layer, see downscaleThreshold) have a sharpness of about 100/n, an image without
+	/// enough contrast to be binarized one of 0. See also DecodeStats::Counter::SkippedFrames.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(uint8_t, minFrameSharpness, setMinFrameSharpness)
+
+	/// Let BarcodeReader::read() return the Results of the last image it decoded again without decoding, as long as the
+	/// mean luminance of none of the blocks of a 32 x 32 grid over the new image differs by this much or more from the
+	/// one of that image (0 = off, 1 = identical images only), e.g. for a fixed-mount scanner watching a conveyor.
+	/// See also DecodeStats::Counter::UnchangedFrames.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(uint8_t, frameChangeThreshold, setFrameChangeThreshold)
+
+	/// Stop after the pass (layer, inverted or closed image, fallback binarizer) that found a symbol with at least this
+	/// Result::confidence() instead of running the remaining passes (0 = off), e.g. 1 for symbols read without any error
+	/// correction. Like escalate, this is meant for the single symbol use case, further symbols may be missed.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(float, minConfidence, setMinConfidence)
+
+	/// Process images larger than this (in either direction) as overlapping tiles of at most tileSize x tileSize pixels
+	/// (0 = off), e.g. aerial or warehouse mosaics. The luminance copy, the image pyramid and the BitMatrix are then only
+	/// allocated for one tile at a time (per thread, tiles are distributed over the Executor if there is one), the image
+	/// itself may exceed 65535 pixels. The symbols found in more than one tile are reported once.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(uint16_t, tileSize, setTileSize)
+
+	/// The overlap of neighboring tiles in pixels, a symbol is found if it fits entirely into one of them, so this should
+	/// be at least the size of the largest symbol to expect (0 = tileSize / 4), see tileSize
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(uint16_t, tileOverlap, setTileOverlap)
+
+	/// Executor to run internal parallel work on instead of spawning threads (not owned, see also SetDefaultExecutor)
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(Executor*, executor, setExecutor)
+
+	/// Backend to compute the binarized images of Binarizer::LocalAverage with, e.g. on a GPU (not owned, default: none)
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(BinarizerBackend*, binarizerBackend, setBinarizerBackend)
+
+	/// Per stage timings and counters to accumulate the statistics of every read into (not owned, default: none)
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(DecodeStats*, stats, setStats)
+
+#ifdef ZX_HAVE_PMR
+	/// Upstream of the arena a BarcodeReader serves its transient per read allocations from (not owned, default: none,
+	/// meaning std::pmr::get_default_resource()). The Results and everything else returned by read() are unaffected.
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(std::pmr::memory_resource*, memoryResource, setMemoryResource)
+#endif
+
+	/// Point in time at which the search is stopped and whatever has been found so far is returned (default: none)
+	ZX_PROPERTY(Deadline, deadline, setDeadline)
+
 	/// If true, the Code-39 reader will try to read extended mode.
 	ZX_PROPERTY(bool, tryCode39ExtendedMode, setTryCode39ExtendedMode)
 
+	/// If true (and tryHarder is set), the DataMatrix reader falls back to the legacy white rectangle detector when the
+	/// regular one found nothing. It catches a few more symbols (e.g. with a damaged L-pattern), but scans the image
+	/// from its center outwards, which mostly adds to the time it takes to find nothing in an image without symbols.
+	ZX_PROPERTY(bool, tryDataMatrixLegacyDetector, setTryDataMatrixLegacyDetector)
+
 	/// Assume Code-39 codes employ a check digit and validate it.
 	ZX_PROPERTY(bool, validateCode39CheckSum, setValidateCode39CheckSum)
 
@@ -167,9 +355,51 @@ public:
 	DecodeHints& setCharacterSet(std::string_view v)& { return _characterSet = CharacterSetFromString(v), *this; }
 	DecodeHints&& setCharacterSet(std::string_view v) && { return _characterSet = CharacterSetFromString(v), std::move(*this); }
 
+	/// Restrict the search to the given list of regions in the image (empty = whole image). The positions of the
+	/// results are in full image coordinates.
+	const std::vector<Rect>& regionsOfInterest() const noexcept { return _regionsOfInterest; }
+	DecodeHints& setRegionsOfInterest(std::vector<Rect> v)& { return _regionsOfInterest = std::move(v), *this; }
+	DecodeHints&& setRegionsOfInterest(std::vector<Rect> v)&& { return _regionsOfInterest = std::move(v), std::move(*this); }
+
+	/// Enable the expensive options only for the formats that need them, e.g. tryHarder for DataMatrix only. The
+	/// readers are set up with the hints returned by forFormats(), so an override for one of the linear formats applies
+	/// to all of them (they share a reader), likewise for QRCode and MicroQRCode.
+	// WARNING: this API is experimental and may change/disappear
+	const std::vector<FormatOverride>& formatOverrides() const noexcept { return _formatOverrides; }
+	DecodeHints& setFormatOverrides(std::vector<FormatOverride> v)& { return _formatOverrides = std::move(v), *this; }
+	DecodeHints&& setFormatOverrides(std::vector<FormatOverride> v)&& { return _formatOverrides = std::move(v), std::move(*this); }
+
+	/// Binarizers to try in order, within the same call, if the binarizer() did not find any symbol. They work on the
+	/// luminance image and the image pyramid prepared for the first one, instead of calling ReadBarcodes() once per
+	/// binarizer. As LocalAverage and GlobalHistogram binarize the rows for the linear readers the same way, a fallback
+	/// from one of them to the other only runs the readers of the matrix formats. Neither the escalation (fast) pass nor
+	/// the denoised (closed) pass are repeated for the fallbacks.
+	/// See also DecodeStats::Counter::FallbackPasses.
+	// WARNING: this API is experimental and may change/disappear
+	const std::vector<Binarizer>& fallbackBinarizers() const noexcept { return _fallbackBinarizers; }
+	DecodeHints& setFallbackBinarizers(std::vector<Binarizer> v)& { return _fallbackBinarizers = std::move(v), *this; }
+	DecodeHints&& setFallbackBinarizers(std::vector<Binarizer> v)&& { return _fallbackBinarizers = std::move(v), std::move(*this); }
+
+	/// The expected size range of the modules (the smallest bars/squares) of the symbols in pixels of the input image, e.g.
+	/// for a fixed-mount scanner with a known reading distance (0 = unknown). With tryDownscale, the chain of downscaled
+	/// layers (see downscaleFactor) is replaced by a single one of a (not necessarily integral) factor that leaves the
+	/// smallest modules about 5 pixels large, the full resolution image is skipped then. The detectors use the range to scan
+	/// fewer rows and to reject finder pattern candidates of implausible size early. Symbols outside the range may be missed.
+	// WARNING: this API is experimental and may change/disappear
+	float minModuleSize() const noexcept { return _minModuleSize; }
+	float maxModuleSize() const noexcept { return _maxModuleSize; }
+	DecodeHints& setModuleSizeRange(float min, float max)& { return _minModuleSize = min, _maxModuleSize = max, *this; }
+	DecodeHints&& setModuleSizeRange(float min, float max)&& { return _minModuleSize = min, _maxModuleSize = max, std::move(*this); }
+
 #undef ZX_PROPERTY
 
 	bool hasFormat(BarcodeFormats f) const noexcept { return _formats.testFlags(f) || _formats.empty(); }
+
+	/// The hints with the formatOverrides() for any of the given formats applied (in order, so the last one wins)
+	DecodeHints forFormats(BarcodeFormats formats) const;
+
+	/// Whether tryInvert() is set globally or for any of the formats
+	bool tryInvertAny() const noexcept;
 };
 
 } // ZXing
@@ -0,0 +1,32 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DecodeStats.h"
+
+namespace ZXing {
+
+void DecodeStats::reset()
+{
+	for (auto& d : _durations)
+		d = 0;
+	for (auto& c : _counters)
+		c = 0;
+}
+
+const char* DecodeStats::Name(Stage stage)
+{
+	static const char* names[StageCount] = {"preprocess", "binarize", "detect", "sample", "decode", "ecc"};
+	return names[int(stage)];
+}
+
+const char* DecodeStats::Name(Counter counter)
+{
+	static const char* names[CounterCount] = {"reads", "layers", "invert_passes", "close_passes", "finder_candidates",
+											  "rows_scanned", "ec_corrections", "ec_failures", "escalations",
+											  "skipped_frames", "unchanged_frames", "fallback_passes"};
+	return names[int(counter)];
+}
+
+} // ZXing
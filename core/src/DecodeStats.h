@@ -0,0 +1,96 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace ZXing {
+
+/**
+ * @brief Per stage timings and counters of the work done while reading barcodes.
+ *
+ * Pass a pointer to an instance via DecodeHints::setStats() (not owned) to have ReadBarcodes() and BarcodeReader::read()
+ * accumulate into it. The values are never reset by the library, so they can be exported as monotonic counters (see
+ * forEach()). All members are atomic, one object may be shared between readers running concurrently. Without a stats
+ * object, the instrumentation costs a thread_local lookup per stage.
+ *
+ * The durations are exclusive, i.e. the time spent in a nested stage (e.g. ECC inside Decode) is not accounted to the
+ * enclosing one. Work an Executor runs on other threads is accounted there as well, so with internal parallelism the
+ * sum of all stages can be larger than the wall clock time.
+ */
+class DecodeStats
+{
+public:
+	enum class Stage
+	{
+		Preprocess, ///< luminance extraction and downscaling (image pyramid)
+		Binarize,   ///< computation of the BitMatrix (1D readers binarize row by row, which is part of Detect)
+		Detect,     ///< everything the readers do that is not one of the other stages (finder pattern search, row scanning)
+		Sample,     ///< sampling of the module grid of a detected matrix symbol
+		Decode,     ///< bit stream decoding and text segmentation
+		ECC,        ///< Reed-Solomon error correction
+	};
+
+	enum class Counter
+	{
+		Reads,            ///< calls to ReadBarcodes() / BarcodeReader::read()
+		Layers,           ///< image pyramid layers processed
+		InvertPasses,     ///< passes over an inverted BitMatrix (DecodeHints::tryInvert)
+		ClosePasses,      ///< passes over a closed BitMatrix (DecodeHints::tryDenoise)
+		FinderCandidates, ///< QRCode finder pattern candidates
+		RowsScanned,      ///< rows (or columns) scanned by the linear readers
+		ECCorrections,    ///< code words corrected by Reed-Solomon
+		ECFailures,       ///< Reed-Solomon blocks that could not be corrected
+		Escalations,      ///< images (or regions) the fast pass of DecodeHints::escalate found nothing in
+		SkippedFrames,    ///< images (or regions) rejected by the quality gate of DecodeHints::minFrameSharpness
+		UnchangedFrames,  ///< images not decoded because they did not change, see DecodeHints::frameChangeThreshold
+		FallbackPasses,   ///< passes over the image (pyramid) with one of the DecodeHints::fallbackBinarizers
+	};
+
+	static constexpr int StageCount = 6;
+	static constexpr int CounterCount = 12;
+
+	void add(Stage stage, std::chrono::nanoseconds duration)
+	{
+		_durations[int(stage)].fetch_add(duration.count(), std::memory_order_relaxed);
+	}
+	void add(Counter counter, int64_t n = 1) { _counters[int(counter)].fetch_add(n, std::memory_order_relaxed); }
+
+	std::chrono::nanoseconds duration(Stage stage) const
+	{
+		return std::chrono::nanoseconds(_durations[int(stage)].load(std::memory_order_relaxed));
+	}
+	int64_t count(Counter counter) const { return _counters[int(counter)].load(std::memory_order_relaxed); }
+
+	void reset();
+
+	/// lower case names, e.g. "binarize" and "rows_scanned"
+	static const char* Name(Stage stage);
+	static const char* Name(Counter counter);
+
+	/**
+	 * Call func(name, value) for every value, using the Prometheus naming conventions: the durations are reported in
+	 * seconds as "<stage>_seconds_total" and the counters as "<counter>_total", to be prefixed by the exporter.
+	 */
+	template <typename FUNC>
+	void forEach(FUNC func) const
+	{
+		for (int i = 0; i < StageCount; ++i)
+			func(std::string(Name(Stage(i))) + "_seconds_total",
+				 std::chrono::duration<double>(duration(Stage(i))).count());
+		for (int i = 0; i < CounterCount; ++i)
+			func(std::string(Name(Counter(i))) + "_total", static_cast<double>(count(Counter(i))));
+	}
+
+private:
+	std::atomic<int64_t> _durations[StageCount] = {};
+	std::atomic<int64_t> _counters[CounterCount] = {};
+};
+
+} // ZXing
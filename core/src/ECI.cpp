@@ -7,11 +7,13 @@
 
 #include "ZXAlgorithms.h"
 
-#include <map>
+#include <utility>
 
 namespace ZXing {
 
-static const std::map<ECI, CharacterSet> ECI_TO_CHARSET = {
+// a constant table (instead of a std::map) has nothing to initialize at startup. ToECI() returns the ECI of the first
+// entry of a CharacterSet, e.g. ECI::ASCII and not ECI::ISO646_Inv.
+static constexpr std::pair<ECI, CharacterSet> ECI_TO_CHARSET[] = {
 	{ECI(0), CharacterSet::Cp437},     // Obsolete
 	{ECI(1), CharacterSet::ISO8859_1}, // Obsolete
 	{ECI::Cp437, CharacterSet::Cp437}, // Obsolete but still used by PDF417 Macro fields (ISO/IEC 15438:2015 Annex H.2.3)
@@ -56,7 +58,7 @@ std::string ToString(ECI eci)
 
 CharacterSet ToCharacterSet(ECI eci)
 {
-	if (auto it = ECI_TO_CHARSET.find(eci); it != ECI_TO_CHARSET.end())
+	if (auto it = FindIf(ECI_TO_CHARSET, [eci](auto& v) { return v.first == eci; }); it != std::end(ECI_TO_CHARSET))
 		return it->second;
 
 	return CharacterSet::Unknown;
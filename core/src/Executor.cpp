@@ -0,0 +1,52 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ZXing {
+
+ThreadExecutor::ThreadExecutor(int threads)
+	: _threads(threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency())))
+{}
+
+void ThreadExecutor::parallelFor(int n, const std::function<void(int)>& func)
+{
+	std::atomic<int> next = 0;
+	auto worker = [&]() {
+		for (int i = next++; i < n; i = next++)
+			func(i);
+	};
+
+	std::vector<std::thread> pool;
+	for (int i = 1; i < std::min(_threads, n); ++i)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& t : pool)
+		t.join();
+}
+
+static std::mutex defaultExecutorMutex;
+static std::shared_ptr<Executor> defaultExecutor;
+
+void SetDefaultExecutor(std::shared_ptr<Executor> executor)
+{
+	std::lock_guard lock(defaultExecutorMutex);
+	defaultExecutor = std::move(executor);
+}
+
+std::shared_ptr<Executor> DefaultExecutor()
+{
+	std::lock_guard lock(defaultExecutorMutex);
+	return defaultExecutor;
+}
+
+} // ZXing
@@ -0,0 +1,76 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+namespace ZXing {
+
+/**
+ * @brief The Executor class is the abstraction used for all internal parallelism of the library.
+ *
+ * The library never spawns threads on its own unless explicitly asked to (see DecodeHints::threads). Instead,
+ * an application that already runs its own scheduler / work-stealing pool can implement this interface and
+ * install it either globally (SetDefaultExecutor) or per call (DecodeHints::setExecutor).
+ */
+class Executor
+{
+public:
+	virtual ~Executor() = default;
+
+	/**
+	 * Call func(i) for every i in [0, n), potentially concurrently and in any order. The function must not return
+	 * before all calls have finished. It is valid to simply run all calls sequentially on the calling thread.
+	 *
+	 * func never throws, exceptions are caught and transported by the caller.
+	 */
+	virtual void parallelFor(int n, const std::function<void(int)>& func) = 0;
+
+	/**
+	 * @brief concurrency is the number of calls the executor is able to run in parallel (used to size work chunks)
+	 */
+	virtual int concurrency() const = 0;
+};
+
+/**
+ * @brief ThreadExecutor is a simple Executor that spawns up to `threads` std::threads on each parallelFor call.
+ */
+class ThreadExecutor : public Executor
+{
+	int _threads;
+
+public:
+	/// @param threads number of threads to use, 0 means std::thread::hardware_concurrency()
+	explicit ThreadExecutor(int threads = 0);
+
+	void parallelFor(int n, const std::function<void(int)>& func) override;
+	int concurrency() const override { return _threads; }
+};
+
+/**
+ * @brief SetDefaultExecutor installs a process wide Executor used if DecodeHints::executor() is not set.
+ *
+ * Pass nullptr to uninstall. The executor is shared (owned) by the library until it is replaced.
+ */
+void SetDefaultExecutor(std::shared_ptr<Executor> executor);
+
+/**
+ * @brief DefaultExecutor returns the Executor installed by SetDefaultExecutor or nullptr.
+ */
+std::shared_ptr<Executor> DefaultExecutor();
+
+class DecodeHints;
+
+/**
+ * @brief SelectExecutor returns the Executor to be used for the given hints or nullptr for sequential processing.
+ *
+ * The order of precedence is DecodeHints::executor(), DefaultExecutor() and a ThreadExecutor if
+ * DecodeHints::threads() != 1.
+ */
+std::shared_ptr<Executor> SelectExecutor(const DecodeHints& hints);
+
+} // ZXing
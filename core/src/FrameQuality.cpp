@@ -0,0 +1,93 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FrameQuality.h"
+
+#include "GlobalHistogramBinarizer.h"
+#include "ImageView.h"
+#include "TraceScope.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace ZXing {
+
+namespace {
+
+struct EdgeStats
+{
+	double sharpness = 0; // sum of the sharpness of all edges
+	int count = 0;        // number of edges
+	int pixels = 0;       // number of pixels looked at
+
+	double density() const { return pixels ? double(count) / pixels : 0; }
+};
+
+// An edge is a run of steps of the same sign with a total rise of at least contrast / 4, smaller steps than contrast / 32
+// (the noise) do not continue or start one. Its sharpness is the sum of its squared steps relative to the squared
+// contrast, i.e. 1 / n for the full contrast spread evenly over n steps. Blur wider than the modules of a symbol lowers
+// the rise of the edges in addition to spreading it.
+void AddEdges(const uint8_t* p, int stride, int length, int contrast, EdgeStats& stats)
+{
+	const int noise = std::max(4, contrast / 32);
+	int rise = 0, energy = 0;
+	auto endEdge = [&] {
+		if (4 * std::abs(rise) >= contrast) {
+			stats.sharpness += std::min(1.0, double(energy) / (contrast * contrast));
+			++stats.count;
+		}
+		rise = energy = 0;
+	};
+	for (int i = 0; i < length - 1; ++i, p += stride) {
+		int step = p[stride] - p[0];
+		if (std::abs(step) < noise) {
+			if (rise)
+				endEdge();
+			continue;
+		}
+		if (rise && (step > 0) != (rise > 0))
+			endEdge();
+		rise += step;
+		energy += step * step;
+	}
+	endEdge();
+	stats.pixels += length;
+}
+
+} // namespace
+
+FrameQuality EstimateFrameQuality(const ImageView& iv)
+{
+	ZX_TRACE_SCOPE("EstimateFrameQuality");
+	FrameQuality res;
+	if (iv.width() < 2 || iv.height() < 2)
+		return res;
+	res.contrast = EstimateContrast(iv);
+	if (res.contrast == 0)
+		return res;
+
+	// about 8K pixels each of rows and of columns evenly spread over the image
+	const int rows = std::clamp(0x2000 / iv.width(), 1, iv.height());
+	const int cols = std::clamp(0x2000 / iv.height(), 1, iv.width());
+	EdgeStats horizontal, vertical;
+	for (int i = 0; i < rows; ++i)
+		AddEdges(iv.data(0, (2 * i + 1) * iv.height() / (2 * rows)), iv.pixStride(), iv.width(), res.contrast, horizontal);
+	for (int i = 0; i < cols; ++i)
+		AddEdges(iv.data((2 * i + 1) * iv.width() / (2 * cols), 0), iv.rowStride(), iv.height(), res.contrast, vertical);
+
+	// Motion blurs the edges across the direction of the motion only, so the less sharp direction counts. Unless it
+	// has only a few edges (e.g. the rows of a linear symbol seen in the columns), which are no evidence either way.
+	const double maxDensity = std::max(horizontal.density(), vertical.density());
+	if (maxDensity == 0)
+		return res;
+	res.sharpness = 100;
+	for (const auto* dir : {&horizontal, &vertical})
+		if (dir->count && dir->density() >= maxDensity / 4)
+			res.sharpness = std::min(res.sharpness, static_cast<int>(100 * dir->sharpness / dir->count));
+	return res;
+}
+
+} // ZXing
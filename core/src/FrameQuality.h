@@ -0,0 +1,29 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+namespace ZXing {
+
+class ImageView;
+
+struct FrameQuality
+{
+	int contrast = 0;  ///< luminance difference of the dark and the light peak of the histogram (0..255)
+	int sharpness = 0; ///< average sharpness of the edges in percent, 0 without contrast
+};
+
+/**
+ * A fast estimate of whether a (camera) frame is worth reading, see DecodeHints::minFrameSharpness(). The contrast is
+ * the one the GlobalHistogramBinarizer would find (see EstimateContrast()). For the sharpness, the edges (runs of
+ * luminance steps of the same sign that rise by at least a quarter of the contrast) are found in about 8K pixels each
+ * of rows and of columns evenly spread over the image, so the cost does not depend on the image size. An edge that
+ * makes the full contrast in one step is perfectly sharp, one spread evenly over n pixels has a sharpness of 1/n.
+ * Motion blur only spreads the edges across the direction of the motion, hence the less sharp of the horizontal and
+ * the vertical direction counts.
+ */
+FrameQuality EstimateFrameQuality(const ImageView& iv);
+
+} // ZXing
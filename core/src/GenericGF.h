@@ -9,11 +9,48 @@
 #include "GenericGFPoly.h"
 #include "ZXConfig.h"
 
+#include <array>
 #include <stdexcept>
-#include <vector>
 
 namespace ZXing {
 
+/**
+* The exp and log tables of GF(SIZE) with the given primitive polynomial. They are generated at compile time, so
+* there is no static initialization (and no thread-safe initialization check) involved at runtime.
+*/
+template <int PRIMITIVE, int SIZE>
+struct GFTables
+{
+#ifdef ZX_REED_SOLOMON_USE_MORE_MEMORY_FOR_SPEED
+	static constexpr int EXP_SIZE = 2 * SIZE;
+#else
+	static constexpr int EXP_SIZE = SIZE;
+#endif
+
+	std::array<short, EXP_SIZE> exp = {};
+	std::array<short, SIZE> log = {}; // log[0] == 0 but this should never be used
+
+	constexpr GFTables()
+	{
+		int x = 1;
+		for (int i = 0; i < SIZE; ++i) {
+			exp[i] = static_cast<short>(x);
+			x *= 2; // we're assuming the generator alpha is 2
+			if (x >= SIZE) {
+				x ^= PRIMITIVE;
+				x &= SIZE - 1;
+			}
+		}
+		for (int i = SIZE; i < EXP_SIZE; ++i)
+			exp[i] = exp[i - (SIZE - 1)];
+		for (int i = 0; i < SIZE - 1; ++i)
+			log[exp[i]] = static_cast<short>(i);
+	}
+};
+
+template <int PRIMITIVE, int SIZE>
+inline constexpr GFTables<PRIMITIVE, SIZE> GF_TABLES = {};
+
 /**
 * <p>This class contains utility methods for performing mathematical operations over
 * the Galois Fields. Operations use a given primitive polynomial in calculations.</p>
@@ -27,25 +64,26 @@ namespace ZXing {
 */
 class GenericGF
 {
-	const int _size;
+	int _size;
 	int _generatorBase;
-	std::vector<short> _expTable;
-	std::vector<short> _logTable;
+	int _expSize;
+	const short* _expTable;
+	const short* _logTable;
 
+public:
 	/**
-	* Create a representation of GF(size) using the given primitive polynomial.
+	* Create a representation of GF(SIZE) using the given primitive polynomial.
 	*
-	* @param primitive irreducible polynomial whose coefficients are represented by
-	*  the bits of an int, where the least-significant bit represents the constant
-	*  coefficient
-	* @param size the size of the field (m = log2(size) is called the word size of the encoding)
+	* @param tables the exp/log tables of the field, see GFTables
 	* @param b the factor b in the generator polynomial can be 0- or 1-based
 	*  (g(x) = (x+a^b)(x+a^(b+1))...(x+a^(b+2t-1))).
 	*  In most cases it should be 1, but for QR code it is 0.
 	*/
-	GenericGF(int primitive, int size, int b);
+	template <int PRIMITIVE, int SIZE>
+	constexpr GenericGF(const GFTables<PRIMITIVE, SIZE>& tables, int b)
+		: _size(SIZE), _generatorBase(b), _expSize(tables.EXP_SIZE), _expTable(tables.exp.data()), _logTable(tables.log.data())
+	{}
 
-public:
 	static const GenericGF& AztecData12();
 	static const GenericGF& AztecData10();
 	static const GenericGF& AztecData6();
@@ -63,7 +101,9 @@ public:
 	* @return 2 to the power of a in GF(size)
 	*/
 	int exp(int a) const {
-		return _expTable.at(a);
+		if (a < 0 || a >= _expSize)
+			throw std::out_of_range("a out of range");
+		return _expTable[a];
 	}
 
 	/**
@@ -73,7 +113,9 @@ public:
 		if (a == 0) {
 			throw std::invalid_argument("a == 0");
 		}
-		return _logTable.at(a);
+		if (a < 0 || a >= _size)
+			throw std::out_of_range("a out of range");
+		return _logTable[a];
 	}
 
 	/**
@@ -111,4 +153,54 @@ public:
 	}
 };
 
+// The fields are constant-initialized, the accessors compile down to the address of the respective object.
+
+inline const GenericGF& GenericGF::AztecData12()
+{
+	static constexpr GenericGF inst(GF_TABLES<0x1069, 4096>, 1); // x^12 + x^6 + x^5 + x^3 + 1
+	return inst;
+}
+
+inline const GenericGF& GenericGF::AztecData10()
+{
+	static constexpr GenericGF inst(GF_TABLES<0x409, 1024>, 1); // x^10 + x^3 + 1
+	return inst;
+}
+
+inline const GenericGF& GenericGF::AztecData6()
+{
+	static constexpr GenericGF inst(GF_TABLES<0x43, 64>, 1); // x^6 + x + 1
+	return inst;
+}
+
+inline const GenericGF& GenericGF::AztecParam()
+{
+	static constexpr GenericGF inst(GF_TABLES<0x13, 16>, 1); // x^4 + x + 1
+	return inst;
+}
+
+inline const GenericGF& GenericGF::QRCodeField256()
+{
+	static constexpr GenericGF inst(GF_TABLES<0x011D, 256>, 0); // x^8 + x^4 + x^3 + x^2 + 1
+	return inst;
+}
+
+inline const GenericGF& GenericGF::DataMatrixField256()
+{
+	static constexpr GenericGF inst(GF_TABLES<0x012D, 256>, 1); // x^8 + x^5 + x^3 + x^2 + 1
+	return inst;
+}
+
+inline const GenericGF& GenericGF::AztecData8()
+{
+	static constexpr GenericGF inst(GF_TABLES<0x012D, 256>, 1); // = DATA_MATRIX_FIELD_256;
+	return inst;
+}
+
+inline const GenericGF& GenericGF::MaxiCodeField64()
+{
+	static constexpr GenericGF inst(GF_TABLES<0x43, 64>, 1); // = AZTEC_DATA_6;
+	return inst;
+}
+
 } // namespace ZXing
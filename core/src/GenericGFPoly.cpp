@@ -28,7 +28,7 @@ GenericGFPoly::evaluateAt(int a) const
 		return Reduce(_coefficients, 0, [](auto a, auto b) { return a ^ b; });
 
 	int result = _coefficients[0];
-	for (size_t i = 1; i < _coefficients.size(); ++i)
+	for (int i = 1; i < _coefficients.size(); ++i)
 		result = _field->multiply(a, result) ^ _coefficients[i];
 	return result;
 }
@@ -48,12 +48,12 @@ GenericGFPoly& GenericGFPoly::addOrSubtract(GenericGFPoly& other)
 	auto& smallerCoefs = other._coefficients;
 	auto& largerCoefs = _coefficients;
 	if (smallerCoefs.size() > largerCoefs.size())
-		std::swap(smallerCoefs, largerCoefs);
+		swap(smallerCoefs, largerCoefs);
 
-	size_t lengthDiff = largerCoefs.size() - smallerCoefs.size();
+	int lengthDiff = largerCoefs.size() - smallerCoefs.size();
 
 	// high-order terms only found in higher-degree polynomial's coefficients stay untouched
-	for (size_t i = lengthDiff; i < largerCoefs.size(); ++i)
+	for (int i = lengthDiff; i < largerCoefs.size(); ++i)
 		largerCoefs[i] ^= smallerCoefs[i - lengthDiff];
 
 	normalize();
@@ -71,15 +71,13 @@ GenericGFPoly::multiply(const GenericGFPoly& other)
 	auto& a = _coefficients;
 	auto& b = other._coefficients;
 
-	// To disable the use of the malloc cache, simply uncomment:
-	// Coefficients _cache;
-	_cache.resize(a.size() + b.size() - 1);
-	std::fill(_cache.begin(), _cache.end(), 0);
-	for (size_t i = 0; i < a.size(); ++i)
-		for (size_t j = 0; j < b.size(); ++j)
-			_cache[i + j] ^= _field->multiply(a[i], b[j]);
+	Coefficients product;
+	product.resize(a.size() + b.size() - 1, 0);
+	for (int i = 0; i < a.size(); ++i)
+		for (int j = 0; j < b.size(); ++j)
+			product[i + j] ^= _field->multiply(a[i], b[j]);
 
-	_coefficients.swap(_cache);
+	swap(_coefficients, product);
 
 	normalize();
 	return *this;
@@ -93,8 +91,8 @@ GenericGFPoly::multiplyByMonomial(int coefficient, int degree)
 	if (coefficient == 0)
 		return setMonomial(0);
 
-	for (int& c : _coefficients)
-		c = _field->multiply(c, coefficient);
+	for (auto& c : _coefficients)
+		c = narrow_cast<uint16_t>(_field->multiply(c, coefficient));
 
 	_coefficients.resize(_coefficients.size() + degree, 0);
 
@@ -120,7 +118,7 @@ GenericGFPoly::divide(const GenericGFPoly& other, GenericGFPoly& quotient)
 	// use Expanded Synthetic Division (see https://en.wikiversity.org/wiki/Reed%E2%80%93Solomon_codes_for_coders):
 	// we use the memory from this (the dividend) and swap it with quotient, which will then accumulate the result as
 	// [quotient : remainder]. we later copy back the remainder into this and shorten the quotient.
-	std::swap(*this, quotient);
+	swap(*this, quotient);
 	auto& divisor = other._coefficients;
 	auto& result = quotient._coefficients;
 	auto normalizer = _field->inverse(divisor[0]);
@@ -129,7 +127,7 @@ GenericGFPoly::divide(const GenericGFPoly& other, GenericGFPoly& quotient)
 		if (ci == 0)
 			continue;
 
-		ci = _field->multiply(ci, normalizer);
+		ci = narrow_cast<uint16_t>(_field->multiply(ci, normalizer));
 
 		// we always skip the first coefficient of the divisor, because it's only used to normalize the dividend coefficient
 		for (int j = 1; j < Size(divisor); ++j)
@@ -137,15 +135,15 @@ GenericGFPoly::divide(const GenericGFPoly& other, GenericGFPoly& quotient)
 	}
 
 	// extract the normalized remainder from result
-	auto firstNonZero = std::find_if(result.end() - other.degree(), result.end(), [](int c){ return c != 0; });
+	auto firstNonZero = std::find_if(result.end() - other.degree(), result.end(), [](int c) { return c != 0; });
 	if (firstNonZero == result.end()) {
 		setMonomial(0);
 	} else {
-		_coefficients.resize(result.end() - firstNonZero);
+		_coefficients.resize(narrow_cast<int>(result.end() - firstNonZero));
 		std::copy(firstNonZero, result.end(), _coefficients.begin());
 	}
 	// cut off the tail with the remainder to leave the quotient
-	result.resize(result.size() - other.degree());
+	result.resize(Size(result) - other.degree());
 
 	return *this;
 }
@@ -159,7 +157,7 @@ void GenericGFPoly::normalize()
 			_coefficients.resize(1, 0);
 		} else {
 			std::copy(firstNonZero, _coefficients.end(), _coefficients.begin());
-			_coefficients.resize(_coefficients.end() - firstNonZero);
+			_coefficients.resize(narrow_cast<int>(_coefficients.end() - firstNonZero));
 		}
 	}
 }
@@ -9,8 +9,11 @@
 #include "ZXAlgorithms.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <vector>
 
 namespace ZXing {
@@ -28,24 +31,67 @@ class GenericGF;
 */
 class GenericGFPoly
 {
-	struct Coefficients : public std::vector<int>
+	/**
+	 * Coefficient storage with a fixed inline capacity of INLINE_SIZE, which covers every polynomial over GF(256) and the
+	 * smaller fields. Only polynomials over the GF(1024) and GF(4096) of the large Aztec symbols may spill to the heap.
+	 */
+	class Coefficients
 	{
-		void reserve(size_t s)
+		static constexpr int INLINE_SIZE = 256;
+
+		int _size = 0;
+		std::array<uint16_t, INLINE_SIZE> _inline;
+		std::vector<uint16_t> _heap; // non-empty once the size exceeded INLINE_SIZE
+
+	public:
+		Coefficients() = default;
+		Coefficients(const Coefficients& other) { *this = other; }
+
+		// only copy the used part of the coefficients
+		Coefficients& operator=(const Coefficients& other)
 		{
-			if (capacity() < s)
-				std::vector<int>::reserve(std::max(size_t(32), s));
+			resize(other._size);
+			std::copy_n(other.data(), _size, data());
+			return *this;
 		}
 
-		void resize(size_t s)
+		uint16_t* data() noexcept { return _heap.empty() ? _inline.data() : _heap.data(); }
+		const uint16_t* data() const noexcept { return _heap.empty() ? _inline.data() : _heap.data(); }
+		uint16_t* begin() noexcept { return data(); }
+		uint16_t* end() noexcept { return data() + _size; }
+		const uint16_t* begin() const noexcept { return data(); }
+		const uint16_t* end() const noexcept { return data() + _size; }
+		uint16_t& operator[](int i) noexcept { return data()[i]; }
+		uint16_t operator[](int i) const noexcept { return data()[i]; }
+		uint16_t& front() noexcept { return data()[0]; }
+		uint16_t front() const noexcept { return data()[0]; }
+		uint16_t back() const noexcept { return data()[_size - 1]; }
+		int size() const noexcept { return _size; }
+
+		// new coefficients are set to value
+		void resize(int s, int value = 0)
 		{
-			reserve(s);
-			std::vector<int>::resize(s);
+			if (s > INLINE_SIZE && s > Size(_heap)) {
+				std::vector<uint16_t> heap(std::max(s, 2 * INLINE_SIZE));
+				std::copy_n(data(), _size, heap.data());
+				_heap.swap(heap);
+			}
+			if (s > _size)
+				std::fill(data() + _size, data() + s, narrow_cast<uint16_t>(value));
+			_size = s;
 		}
 
-		void resize(size_t s, int i)
+		friend void swap(Coefficients& a, Coefficients& b) noexcept
 		{
-			reserve(s);
-			std::vector<int>::resize(s, i);
+			if (a._heap.empty() && b._heap.empty())
+				std::swap_ranges(a._inline.begin(), a._inline.begin() + std::max(a._size, b._size), b._inline.begin());
+			else if (a._heap.empty() || b._heap.empty()) {
+				// the inline coefficients move over, the heap buffer changes owner below
+				auto& inlined = a._heap.empty() ? a : b;
+				std::copy_n(inlined._inline.begin(), inlined._size, (a._heap.empty() ? b : a)._inline.begin());
+			}
+			a._heap.swap(b._heap);
+			std::swap(a._size, b._size);
 		}
 	};
 
@@ -60,28 +106,22 @@ public:
 	* @param coefficients coefficients as ints representing elements of GF(size), arranged
 	* from most significant (highest-power term) coefficient to least significant
 	*/
-	GenericGFPoly(const GenericGF& field, std::vector<int>&& coefficients) : _field(&field)
+	GenericGFPoly(const GenericGF& field, const int* coefficients, int size) : _field(&field)
 	{
-		assert(!coefficients.empty());
-		_coefficients.swap(coefficients); // _coefficients = coefficients
+		assert(size > 0);
+		_coefficients.resize(size);
+		std::copy_n(coefficients, size, _coefficients.begin());
 		normalize();
 	}
-	GenericGFPoly(const GenericGF& field, const std::vector<int>& coefficients) : GenericGFPoly(field, std::vector<int>(coefficients)) {}
+	GenericGFPoly(const GenericGF& field, std::initializer_list<int> coefficients)
+		: GenericGFPoly(field, coefficients.begin(), Size(coefficients))
+	{}
+	GenericGFPoly(const GenericGF& field, const std::vector<int>& coefficients)
+		: GenericGFPoly(field, coefficients.data(), Size(coefficients))
+	{}
 
-	GenericGFPoly& operator=(GenericGFPoly&& other) noexcept = default;
-	GenericGFPoly(GenericGFPoly&& other) noexcept = default;
-
-	GenericGFPoly& operator=(const GenericGFPoly& other) {
-		assert(_field == other._field);
-		_coefficients.reserve(other._coefficients.size());
-		_coefficients = other._coefficients;
-		return *this;
-	}
-
-	GenericGFPoly(const GenericGFPoly& other) {
-		_field = other._field;
-		*this = other;
-	}
+	GenericGFPoly(const GenericGFPoly& other) = default;
+	GenericGFPoly& operator=(const GenericGFPoly& other) = default;
 
 	GenericGFPoly& setField(const GenericGF& field)
 	{
@@ -120,9 +160,9 @@ public:
 	{
 		assert(degree >= 0 && (coefficient != 0 || degree == 0));
 
-		_coefficients.resize(degree + 1);
-		std::fill(_coefficients.begin(), _coefficients.end(), 0);
-		_coefficients.front() = coefficient;
+		_coefficients.resize(0);
+		_coefficients.resize(degree + 1, 0);
+		_coefficients.front() = narrow_cast<uint16_t>(coefficient);
 
 		return *this;
 	}
@@ -140,14 +180,14 @@ public:
 	friend void swap(GenericGFPoly& a, GenericGFPoly& b)
 	{
 		std::swap(a._field, b._field);
-		std::swap(a._coefficients, b._coefficients);
+		swap(a._coefficients, b._coefficients);
 	}
 
 private:
 	void normalize();
 
 	const GenericGF* _field = nullptr;
-	Coefficients _coefficients, _cache; // _cache is used for malloc caching
+	Coefficients _coefficients;
 };
 
 } // ZXing
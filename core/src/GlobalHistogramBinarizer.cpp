@@ -8,13 +8,23 @@
 
 #include "BitMatrix.h"
 #include "Pattern.h"
+#include "TraceScope.h"
+#include "ZXConfig.h"
 
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <functional>
+#include <type_traits>
 #include <utility>
 
+#if defined(ZX_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(ZX_USE_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace ZXing {
 
 static constexpr int LUMINANCE_BITS = 5;
@@ -23,7 +33,14 @@ static constexpr int LUMINANCE_BUCKETS = 1 << LUMINANCE_BITS;
 
 using Histogram = std::array<uint16_t, LUMINANCE_BUCKETS>;
 
-GlobalHistogramBinarizer::GlobalHistogramBinarizer(const ImageView& buffer) : BinaryBitmap(buffer) {}
+// fixed point scale of the sub-pixel widths, the longest possible row still has to fit into the uint16_t of a PatternRow
+static constexpr int SUB_PIXEL_SCALE = 4;
+
+GlobalHistogramBinarizer::GlobalHistogramBinarizer(const ImageView& buffer, bool subPixelEdges) : BinaryBitmap(buffer)
+{
+	if (subPixelEdges && std::max(width(), height()) * SUB_PIXEL_SCALE <= 0xffff)
+		_patternRowScale = SUB_PIXEL_SCALE;
+}
 
 GlobalHistogramBinarizer::~GlobalHistogramBinarizer() = default;
 
@@ -34,34 +51,142 @@ inline ImageLineView RowView(const ImageView& iv, int row)
 	return {{iv.data(0, row), iv.pixStride()}, {iv.data(iv.width(), row), iv.pixStride()}};
 }
 
-static void ThresholdSharpened(const ImageLineView in, int threshold, std::vector<uint8_t>& out)
+/**
+* Writes (sharpened(x) <= threshold) * SET_V for the x in [1, n - 1) of a densely packed row with SIMD instructions, with
+* sharpened(x) = (-p[x - 1] + 4 * p[x] - p[x + 1]) / 2. Returns the first x not processed.
+*/
+static int ThresholdSharpenedSIMD([[maybe_unused]] const uint8_t* p, [[maybe_unused]] int n, [[maybe_unused]] int threshold,
+								  [[maybe_unused]] uint8_t* out)
+{
+	static_assert(BitMatrix::SET_V == 0xff, "the SIMD code below relies on SET_V being an all-ones byte");
+	int x = 1;
+	// As threshold >= 0, the truncating division by 2 can be folded into the comparison:
+	// v / 2 <= threshold <=> v <= 2 * threshold + 1 for all (also negative) v. The range of v fits into an int16_t.
+	[[maybe_unused]] const int limit = 2 * threshold + 1;
+#if defined(ZX_USE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i vlimit = _mm_set1_epi16(narrow_cast<int16_t>(limit));
+	auto sharpenedAbove = [&](__m128i l, __m128i c, __m128i r) {
+		return _mm_cmpgt_epi16(_mm_sub_epi16(_mm_slli_epi16(c, 2), _mm_add_epi16(l, r)), vlimit);
+	};
+	for (; x + 16 < n; x += 16) {
+		__m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + x - 1));
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + x));
+		__m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + x + 1));
+		__m128i lo = sharpenedAbove(_mm_unpacklo_epi8(l, zero), _mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(r, zero));
+		__m128i hi = sharpenedAbove(_mm_unpackhi_epi8(l, zero), _mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(r, zero));
+		// the comparison results are 0 or -1, which pack to 0x00 or 0xff, inverted that is (v <= limit) * SET_V
+		__m128i above = _mm_packs_epi16(lo, hi);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_xor_si128(above, _mm_set1_epi8(-1)));
+	}
+#elif defined(ZX_USE_NEON)
+	const int16x8_t vlimit = vdupq_n_s16(narrow_cast<int16_t>(limit));
+	auto sharpenedAtMost = [&](uint8x8_t l, uint8x8_t c, uint8x8_t r) {
+		int16x8_t v = vreinterpretq_s16_u16(vsubq_u16(vshll_n_u8(c, 2), vaddl_u8(l, r)));
+		return vmovn_u16(vcleq_s16(v, vlimit));
+	};
+	for (; x + 16 < n; x += 16) {
+		uint8x16_t l = vld1q_u8(p + x - 1), c = vld1q_u8(p + x), r = vld1q_u8(p + x + 1);
+		vst1q_u8(out + x, vcombine_u8(sharpenedAtMost(vget_low_u8(l), vget_low_u8(c), vget_low_u8(r)),
+									  sharpenedAtMost(vget_high_u8(l), vget_high_u8(c), vget_high_u8(r))));
+	}
+#endif
+	return x;
+}
+
+template <typename Iterator>
+static void ThresholdSharpened(const Range<Iterator> in, int threshold, std::vector<uint8_t>& out)
 {
 	out.resize(in.size());
 	auto i = in.begin();
 	auto o = out.begin();
 
 	*o++ = (*i++ <= threshold) * BitMatrix::SET_V;
+	if constexpr (std::is_pointer_v<Iterator>) {
+		int done = ThresholdSharpenedSIMD(in.begin(), Size(in), threshold, out.data()) - 1;
+		i += done, o += done;
+	}
 	for (auto end = in.end() - 1; i != end; ++i)
 		*o++ = ((-i[-1] + (int(i[0]) * 4) - i[1]) / 2 <= threshold) * BitMatrix::SET_V;
 	*o++ = (*i++ <= threshold) * BitMatrix::SET_V;
 }
 
+// Same classification as ThresholdSharpened but the edges between bars and spaces are placed at the linearly
+// interpolated crossing of the threshold between two neighboring pixel centers. The resulting widths are in units of
+// 1/SUB_PIXEL_SCALE pixels and are much closer to the real ratios if a module is only one or two pixels wide.
+static void SubPixelPatternRow(const ImageLineView in, int threshold, PatternRow& res)
+{
+	thread_local std::vector<int> sharpened;
+	const int n = Size(in);
+	auto i = in.begin();
+	sharpened.resize(n);
+	sharpened[0] = i[0];
+	for (int x = 1; x < n - 1; ++x)
+		sharpened[x] = (-i[x - 1] + (int(i[x]) * 4) - i[x + 1]) / 2;
+	sharpened[n - 1] = i[n - 1];
+
+	res.clear();
+	bool black = sharpened[0] <= threshold;
+	if (black)
+		res.push_back(0); // first value is number of white pixels, here 0
+
+	const float crossing = threshold + 0.5f;
+	int lastEdge = 0;
+	for (int x = 1; x < n; ++x) {
+		if ((sharpened[x] <= threshold) == black)
+			continue;
+		float frac = (crossing - sharpened[x - 1]) / (sharpened[x] - sharpened[x - 1]);
+		// make sure no element collapses to a width of 0, which would break the bar/space alternation
+		int edge = std::max(lastEdge + 1, int(std::lround((x - 0.5f + frac) * SUB_PIXEL_SCALE)));
+		res.push_back(narrow_cast<uint16_t>(edge - lastEdge));
+		lastEdge = edge;
+		black = !black;
+	}
+	res.push_back(narrow_cast<uint16_t>(std::max(1, n * SUB_PIXEL_SCALE - lastEdge)));
+
+	if (black)
+		res.push_back(0); // last value is number of white pixels, here 0
+}
+
+/**
+* Adds the pixels in [begin, end) to the histogram. Consecutive pixels often fall into the same bucket, incrementing a
+* single histogram would serialize those on the store-to-load dependency, so they are counted in 4 interleaved
+* sub-histograms that are summed up at the end.
+*/
+template <typename Iterator>
+static void AddToHistogram(Iterator begin, Iterator end, Histogram& res)
+{
+	std::array<Histogram, 4> sub = {};
+	auto i = begin;
+	for (; end - i >= 4; i = i + 4) {
+		sub[0][i[0] >> LUMINANCE_SHIFT]++;
+		sub[1][i[1] >> LUMINANCE_SHIFT]++;
+		sub[2][i[2] >> LUMINANCE_SHIFT]++;
+		sub[3][i[3] >> LUMINANCE_SHIFT]++;
+	}
+	for (; i != end; ++i)
+		sub[0][*i >> LUMINANCE_SHIFT]++;
+	for (int b = 0; b < LUMINANCE_BUCKETS; ++b)
+		res[b] += sub[0][b] + sub[1][b] + sub[2][b] + sub[3][b];
+}
+
 static auto GenHistogram(const ImageLineView line)
 {
 	Histogram res = {};
-	for (auto pix : line)
-		res[pix >> LUMINANCE_SHIFT]++;
+	// a plain pointer lets the compiler specialize for the common densely packed (non-rotated) rows
+	if (line.begin().stride == 1)
+		AddToHistogram(line.begin().pos, line.end().pos, res);
+	else
+		AddToHistogram(line.begin(), line.end(), res);
 	return res;
 }
 
-// Return -1 on error
-static int EstimateBlackPoint(const Histogram& buckets)
+// The tallest peak of the histogram and the second-tallest one that is somewhat far from it, the darker one first
+static std::pair<int, int> FindPeaks(const Histogram& buckets)
 {
 	// Find the tallest peak in the histogram.
 	auto firstPeakPos = std::max_element(buckets.begin(), buckets.end());
 	int firstPeak = narrow_cast<int>(firstPeakPos - buckets.begin());
-	int firstPeakSize = *firstPeakPos;
-	int maxBucketCount = firstPeakSize;
 
 	// Find the second-tallest peak which is somewhat far from the tallest peak.
 	int secondPeak = 0;
@@ -77,9 +202,14 @@ static int EstimateBlackPoint(const Histogram& buckets)
 	}
 
 	// Make sure firstPeak corresponds to the black peak.
-	if (firstPeak > secondPeak) {
-		std::swap(firstPeak, secondPeak);
-	}
+	return {std::min(firstPeak, secondPeak), std::max(firstPeak, secondPeak)};
+}
+
+// Return -1 on error
+static int EstimateBlackPoint(const Histogram& buckets)
+{
+	auto [firstPeak, secondPeak] = FindPeaks(buckets);
+	int maxBucketCount = *std::max_element(buckets.begin(), buckets.end());
 
 	// If there is too little contrast in the image to pick a meaningful black point, throw rather
 	// than waste time trying to decode the image, and risk false positives.
@@ -102,35 +232,78 @@ static int EstimateBlackPoint(const Histogram& buckets)
 	return bestValley << LUMINANCE_SHIFT;
 }
 
+int EstimateContrast(const ImageView& iv)
+{
+	if (iv.width() == 0 || iv.height() == 0)
+		return 0;
+	// about 8K pixels of rows evenly spread over the image
+	const int rows = std::clamp(0x2000 / iv.width(), 1, iv.height());
+	Histogram buckets = {};
+	for (int i = 0; i < rows; ++i) {
+		auto row = RowView(iv, (2 * i + 1) * iv.height() / (2 * rows));
+		AddToHistogram(row.begin(), row.end(), buckets);
+	}
+
+	auto [firstPeak, secondPeak] = FindPeaks(buckets);
+	// the same minimum distance as EstimateBlackPoint() requires, and two peaks to begin with
+	if (secondPeak - firstPeak <= LUMINANCE_BUCKETS / 16 || !buckets[firstPeak] || !buckets[secondPeak])
+		return 0;
+	return (secondPeak - firstPeak) << LUMINANCE_SHIFT;
+}
+
+ImageView GlobalHistogramBinarizer::rotatedView(int rotation) const
+{
+	rotation = (rotation + 360) % 360;
+	if (rotation != 90 && rotation != 270)
+		return _buffer.rotated(rotation);
+
+	// If we are extracting a column (instead of a row), we run into cache misses on every pixel access both
+	// during the histogram calculation and during the sharpen+threshold operation. Instead, transpose the whole
+	// image once in cache sized tiles, so that all columns can be read from contiguous memory.
+	std::call_once(_transposedOnce, [this] {
+		constexpr int TILE = 32;
+		const int w = width(), h = height();
+		_transposed.resize(size_t(w) * h);
+		for (int y0 = 0; y0 < h; y0 += TILE)
+			for (int x0 = 0; x0 < w; x0 += TILE)
+				for (int x = x0; x < std::min(x0 + TILE, w); ++x) {
+					const uint8_t* src = _buffer.data(x, 0);
+					uint8_t* dst = _transposed.data() + size_t(x) * h;
+					for (int y = y0; y < std::min(y0 + TILE, h); ++y)
+						dst[y] = src[y * _buffer.rowStride()];
+				}
+	});
+
+	// row r of the transposed data is column r of the image from top to bottom, see ImageView::rotated()
+	const uint8_t* data = _transposed.data();
+	const int w = width(), h = height();
+	if (rotation == 90)
+		return {data + h - 1, h, w, ImageFormat::Lum, h, -1};
+	else
+		return {data + size_t(w - 1) * h, h, w, ImageFormat::Lum, -h, 1};
+}
+
 bool GlobalHistogramBinarizer::getPatternRow(int row, int rotation, PatternRow& res) const
 {
-	auto buffer = _buffer.rotated(rotation);
+	auto buffer = rotatedView(rotation);
 	auto lineView = RowView(buffer, row);
 
 	if (buffer.width() < 3)
 		return false; // special casing the code below for a width < 3 makes no sense
 
-#ifdef __AVX__
-	// If we are extracting a column (instead of a row), we run into cache misses on every pixel access both
-	// during the histogram caluculation and during the sharpen+threshold operation. Additionally, if we
-	// perform the ThresholdSharpened function on pixStride==1 data, the auto-vectorizer makes that part
-	// 8x faster on an AVX2 cpu which easily recovers the extra cost that we pay for the copying.
-	thread_local std::vector<uint8_t> line;
-	if (std::abs(buffer.pixStride()) > 4) {
-		line.resize(lineView.size());
-		std::copy(lineView.begin(), lineView.end(), line.begin());
-		lineView = {{line.data(), 1}, {line.data() + line.size(), 1}};
-	}
-#endif
-
 	auto threshold = EstimateBlackPoint(GenHistogram(lineView)) - 1;
 	if (threshold <= 0)
 		return false;
 
+	if (_patternRowScale != 1) {
+		SubPixelPatternRow(lineView, threshold, res);
+		return true;
+	}
+
 	thread_local std::vector<uint8_t> binarized;
-	// the optimizer can generate a specialized version for pixStride==1 (non-rotated input) that is about 8x faster on AVX2 hardware
+	// a plain pointer range selects the SIMD version for pixStride==1 (non-rotated or transposed input)
 	if (lineView.begin().stride == 1)
-		ThresholdSharpened(lineView, threshold, binarized);
+		ThresholdSharpened(Range(lineView.begin().pos, lineView.end().pos), threshold, binarized);
 	else
 		ThresholdSharpened(lineView, threshold, binarized);
 	GetPatternRow(Range(binarized), res);
@@ -142,25 +315,19 @@ bool GlobalHistogramBinarizer::getPatternRow(int row, int rotation, PatternRow&
 std::shared_ptr<const BitMatrix>
 GlobalHistogramBinarizer::getBlackMatrix() const
 {
+	ZX_TRACE_SCOPE("GlobalHistogramBinarizer::getBlackMatrix");
 	// Quickly calculates the histogram by sampling four rows from the image. This proved to be
 	// more robust on the blackbox tests than sampling a diagonal as we used to do.
 	Histogram localBuckets = {};
-	{
-		for (int y = 1; y < 5; y++) {
-			int row = height() * y / 5;
-			const uint8_t* luminances = _buffer.data(0, row);
-			int right = (width() * 4) / 5;
-			for (int x = width() / 5; x < right; x++)
-				localBuckets[luminances[x] >> LUMINANCE_SHIFT]++;
-		}
+	for (int y = 1; y < 5; y++) {
+		auto row = RowView(_buffer, height() * y / 5);
+		AddToHistogram(row.begin() + width() / 5, row.begin() + (width() * 4) / 5, localBuckets);
 	}
 
 	int blackPoint = EstimateBlackPoint(localBuckets);
 	if (blackPoint <= 0)
 		return {};
 
-
-
 	return std::make_shared<const BitMatrix>(binarize(blackPoint));
 }
 
@@ -8,6 +8,10 @@
 
 #include "BinaryBitmap.h"
 
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
 namespace ZXing {
 
 /**
@@ -23,12 +27,25 @@ namespace ZXing {
 */
 class GlobalHistogramBinarizer : public BinaryBitmap
 {
+	// transposed copy of the luminance data, computed once on the first rotated getPatternRow call
+	mutable std::once_flag _transposedOnce;
+	mutable std::vector<uint8_t> _transposed;
+	int _patternRowScale = 1;
+
+	ImageView rotatedView(int rotation) const;
+
 public:
-	explicit GlobalHistogramBinarizer(const ImageView& buffer);
+	/// @param subPixelEdges  return the widths of getPatternRow in fixed point units, see DecodeHints::subPixelEdges
+	explicit GlobalHistogramBinarizer(const ImageView& buffer, bool subPixelEdges = false);
 	~GlobalHistogramBinarizer() override;
 
 	bool getPatternRow(int row, int rotation, PatternRow &res) const override;
+	int patternRowScale() const override { return _patternRowScale; }
 	std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
 };
 
+/// The luminance difference of the dark and the light peak in the histogram of (a sample of the rows of) iv, as the
+/// black point estimation of the GlobalHistogramBinarizer finds them. 0 if there is too little contrast to binarize.
+int EstimateContrast(const ImageView& iv);
+
 } // ZXing
@@ -7,6 +7,11 @@
 
 #include "GridSampler.h"
 
+#include "Matrix.h"
+#include "StatsScope.h"
+
+#include <algorithm>
+
 #ifdef PRINT_DEBUG
 #include "LogMatrix.h"
 #include "BitMatrixIO.h"
@@ -18,6 +23,55 @@ namespace ZXing {
 LogMatrix log;
 #endif
 
+// Check that all grid points of the rois get projected inside an image of size imgWidth x imgHeight.
+static bool IsGridInside(int imgWidth, int imgHeight, const ROIs& rois)
+{
+	for (auto&& [x0, x1, y0, y1, mod2Pix] : rois) {
+		// If all corners of the grid get projected inside the image and the grid does not cross the line that gets
+		// projected to infinity, the projected grid is a convex quadrilateral, so every grid point is inside the image as
+		// well. The latter is not the case for every mod2Pix (#563), which is why this used to be checked point by point.
+		// The corners have to be a tiny bit away from the right/bottom border, so rounding errors in the projection of
+		// the inner points can not make them end up in the column/row past the image.
+		auto isInside = [&mod2Pix = mod2Pix, imgWidth, imgHeight](int x, int y) {
+			auto p = mod2Pix(centered(PointI(x, y)));
+			return 0 <= p.x && p.x < imgWidth - 1e-3 && 0 <= p.y && p.y < imgHeight - 1e-3;
+		};
+		if (!mod2Pix.isValid() || !mod2Pix.isConvexOn(Rectangle(x0, x1 - 1, y0, y1 - 1)) || !isInside(x0, y0)
+			|| !isInside(x1 - 1, y0) || !isInside(x1 - 1, y1 - 1) || !isInside(x0, y1 - 1))
+			return false;
+	}
+	return true;
+}
+
+// Call f(x, y, n, xs, ys) for runs of n grid points (x + i, y) of the rois with their projections (xs[i], ys[i]), which
+// are computed in single precision, see PerspectiveTransform::projectRow().
+template <typename FUNC>
+static void ForEachGridRun(const ROIs& rois, FUNC f)
+{
+	constexpr int N = 64;
+	float xs[N], ys[N];
+	for (auto&& [x0, x1, y0, y1, mod2Pix] : rois)
+		for (int y = y0; y < y1; ++y)
+			for (int x = x0; x < x1; x += N) {
+				int n = std::min(N, x1 - x);
+				mod2Pix.projectRow(centered(PointI{x, y}), n, xs, ys);
+				f(x, y, n, xs, ys);
+			}
+}
+
+static QuadrilateralI ProjectCorners(int width, int height, const ROIs& rois)
+{
+	auto projectCorner = [&](PointI p) {
+		for (auto&& [x0, x1, y0, y1, mod2Pix] : rois)
+			if (x0 <= p.x && p.x <= x1 && y0 <= p.y && p.y <= y1)
+				return PointI(mod2Pix(PointF(p)) + PointF(0.5, 0.5));
+
+		return PointI();
+	};
+
+	return {projectCorner({0, 0}), projectCorner({width, 0}), projectCorner({width, height}), projectCorner({0, height})};
+}
+
 DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& mod2Pix)
 {
 	return SampleGrid(image, width, height, {ROI{0, width, 0, height, mod2Pix}});
@@ -33,49 +87,77 @@ DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const R
 	if (width <= 0 || height <= 0)
 		return {};
 
-	for (auto&& [x0, x1, y0, y1, mod2Pix] : rois) {
-		// Precheck the corners of every roi to bail out early if the grid is "obviously" not completely inside the image
-		auto isInside = [&mod2Pix = mod2Pix, &image](int x, int y) { return image.isIn(mod2Pix(centered(PointI(x, y)))); };
-		if (!mod2Pix.isValid() || !isInside(x0, y0) || !isInside(x1 - 1, y0) || !isInside(x1 - 1, y1 - 1) || !isInside(x0, y1 - 1))
-			return {};
-	}
+	StatsScope scope(DecodeStats::Stage::Sample);
+	if (!IsGridInside(image.width(), image.height(), rois))
+		return {};
 
 	BitMatrix res(width, height);
-	for (auto&& [x0, x1, y0, y1, mod2Pix] : rois) {
-		for (int y = y0; y < y1; ++y)
-			for (int x = x0; x < x1; ++x) {
-				auto p = mod2Pix(centered(PointI{x, y}));
-				// Due to a "numerical instability" in the PerspectiveTransform generation/application it has been observed
-				// that even though all boundary grid points get projected inside the image, it can still happen that an
-				// inner grid points is not. See #563. A true perspective transformation cannot have this property.
-				// The following check takes 100% care of the issue and turned out to be less of a performance impact than feared.
-				// TODO: Check some mathematical/numercial property of mod2Pix to determine if it is a perspective transforation.
-				if (!image.isIn(p))
-					return {};
-
+	// the single precision projection of a point right at the border may end up past it (a negative value truncates to 0)
+	const int maxX = image.width() - 1, maxY = image.height() - 1;
+	ForEachGridRun(rois, [&](int x, int y, int n, const auto* xs, const auto* ys) {
+		for (int i = 0; i < n; ++i) {
 #ifdef PRINT_DEBUG
-				log(p, 3);
+			log(PointF(xs[i], ys[i]), 3);
 #endif
-				if (image.get(p))
-					res.set(x, y);
-			}
-	}
+			if (image.getUnchecked(PointI(std::min(static_cast<int>(xs[i]), maxX), std::min(static_cast<int>(ys[i]), maxY))))
+				res.set(x + i, y);
+		}
+	});
 
 #ifdef PRINT_DEBUG
 	printf("width: %d, height: %d\n", width, height);
 //	printf("%s", ToString(res).c_str());
 #endif
 
-	auto projectCorner = [&](PointI p) {
-		for (auto&& [x0, x1, y0, y1, mod2Pix] : rois)
-			if (x0 <= p.x && p.x <= x1 && y0 <= p.y && p.y <= y1)
-				return PointI(mod2Pix(PointF(p)) + PointF(0.5, 0.5));
+	return {std::move(res), ProjectCorners(width, height, rois)};
+}
 
-		return PointI();
+DetectorResult SampleGrid(const LumSource& lum, int width, int height, const ROIs& rois)
+{
+	const auto& img = lum.image;
+	if (width <= 0 || height <= 0 || img.format() != ImageFormat::Lum || img.width() < 2 || img.height() < 2)
+		return {};
+
+	StatsScope scope(DecodeStats::Stage::Sample);
+	if (!IsGridInside(img.width(), img.height(), rois))
+		return {};
+
+	// bilinear interpolation of the pixel values, pixel (x, y) covers the area [x, x + 1) x [y, y + 1)
+	auto interpolate = [&img](double px, double py) {
+		double x = std::clamp(px - 0.5, 0.0, img.width() - 1.0), y = std::clamp(py - 0.5, 0.0, img.height() - 1.0);
+		int ix = std::min(static_cast<int>(x), img.width() - 2), iy = std::min(static_cast<int>(y), img.height() - 2);
+		float fx = static_cast<float>(x - ix), fy = static_cast<float>(y - iy);
+		const uint8_t* p0 = img.data(ix, iy);
+		const uint8_t* p1 = p0 + img.rowStride();
+		float top = p0[0] + fx * (p0[img.pixStride()] - p0[0]);
+		float bottom = p1[0] + fx * (p1[img.pixStride()] - p1[0]);
+		return top + fy * (bottom - top);
 	};
 
-	return {std::move(res),
-			{projectCorner({0, 0}), projectCorner({width, 0}), projectCorner({width, height}), projectCorner({0, height})}};
-	}
+	Matrix<float> values(width, height);
+	ForEachGridRun(rois, [&](int x, int y, int n, const auto* xs, const auto* ys) {
+		for (int i = 0; i < n; ++i)
+			values.set(x + i, y, interpolate(xs[i], ys[i]));
+	});
+
+	auto [minV, maxV] = std::minmax_element(values.begin(), values.end());
+	const float globalThreshold = (*minV + *maxV) / 2, minContrast = (*maxV - *minV) / 4;
+
+	BitMatrix res(width, height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x) {
+			float lMin = 255, lMax = 0;
+			for (int wy = std::max(0, y - 2); wy <= std::min(height - 1, y + 2); ++wy)
+				for (int wx = std::max(0, x - 2); wx <= std::min(width - 1, x + 2); ++wx) {
+					lMin = std::min(lMin, values(wx, wy));
+					lMax = std::max(lMax, values(wx, wy));
+				}
+			float threshold = lMax - lMin > minContrast ? (lMin + lMax) / 2 : globalThreshold;
+			if ((values(x, y) < threshold) != lum.inverted)
+				res.set(x, y);
+		}
+
+	return {std::move(res), ProjectCorners(width, height, rois)};
+}
 
 } // ZXing
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "DetectorResult.h"
+#include "ImageView.h"
 #include "PerspectiveTransform.h"
 
 namespace ZXing {
@@ -55,4 +56,19 @@ using ROIs = std::vector<ROI>;
 
 DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const ROIs& rois);
 
+/// The luminance image a BitMatrix was binarized from (see BinaryBitmap::buffer() and inverted())
+struct LumSource
+{
+	ImageView image;
+	bool inverted = false;
+};
+
+/**
+ * Same as the BitMatrix version but samples the luminance image the BitMatrix was binarized from: the value at every
+ * projected module center is interpolated bilinearly and compared with a local threshold, the mid-range of the values
+ * of the surrounding 5x5 modules (or of all modules, if there is too little contrast in that neighborhood). This is
+ * more robust on blurry images than looking at a single binarized pixel. Only ImageFormat::Lum is supported.
+ */
+DetectorResult SampleGrid(const LumSource& lum, int width, int height, const ROIs& rois);
+
 } // ZXing
@@ -9,7 +9,11 @@
 
 #include "ZXAlgorithms.h"
 
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <iterator>
 #include <sstream>
 
 namespace ZXing {
@@ -19,19 +23,20 @@ struct AiInfo
 	std::string_view aiPrefix;
 	int _fieldSize;	// if negative, the length is variable and abs(length) give the max size
 
-	bool isVariableLength() const noexcept { return _fieldSize < 0; }
-	int fieldSize() const noexcept { return std::abs(_fieldSize); }
-	int aiSize() const
+	constexpr bool isVariableLength() const noexcept { return _fieldSize < 0; }
+	constexpr int fieldSize() const noexcept { return _fieldSize < 0 ? -_fieldSize : _fieldSize; }
+	constexpr int aiSize() const
 	{
-		if ((aiPrefix[0] == '3' && Contains("1234569", aiPrefix[1])) || aiPrefix == "703" || aiPrefix == "723")
+		if ((aiPrefix[0] == '3' && std::string_view("1234569").find(aiPrefix[1]) != std::string_view::npos) || aiPrefix == "703"
+			|| aiPrefix == "723")
 			return 4;
 		else
-			return Size(aiPrefix);
+			return static_cast<int>(aiPrefix.size());
 	}
 };
 
 // https://github.com/gs1/gs1-syntax-dictionary 2023-09-22
-static const AiInfo aiInfos[] = {
+static constexpr AiInfo aiInfos[] = {
 //TWO_DIGIT_DATA_LENGTH
 	{ "00", 18 },
 	{ "01", 14 },
@@ -244,27 +249,52 @@ static const AiInfo aiInfos[] = {
 	{ "8200", -70 },
 };
 
-std::string HRIFromGS1(std::string_view gs1)
+// For every 2 digit prefix the range of entries in aiInfos starting with it, so a lookup only checks a handful of entries
+struct AiRange
+{
+	uint16_t begin = 0, end = 0;
+};
+
+static constexpr auto aiIndex = [] {
+	std::array<AiRange, 100> res = {};
+	for (int i = 0; i < static_cast<int>(std::size(aiInfos)); ++i) {
+		auto& r = res[(aiInfos[i].aiPrefix[0] - '0') * 10 + aiInfos[i].aiPrefix[1] - '0'];
+		if (r.begin == r.end)
+			r.begin = static_cast<uint16_t>(i);
+		r.end = static_cast<uint16_t>(i + 1);
+	}
+	return res;
+}();
+
+static const AiInfo* FindAiInfo(std::string_view str)
+{
+	if (str.size() < 2 || !std::isdigit(str[0]) || !std::isdigit(str[1]))
+		return nullptr;
+
+	auto [begin, end] = aiIndex[(str[0] - '0') * 10 + str[1] - '0'];
+	for (auto i = begin; i < end; ++i)
+		if (str.substr(0, aiInfos[i].aiPrefix.size()) == aiInfos[i].aiPrefix)
+			return &aiInfos[i];
+	return nullptr;
+}
+
+std::vector<GS1Element> ParseGS1(std::string_view gs1)
 {
-	//TODO: c++20
-	auto starts_with = [](std::string_view str, std::string_view pre) { return str.substr(0, pre.size()) == pre; };
 	constexpr char GS = 29; // GS character (29 / 0x1D)
 
 	std::string_view rem = gs1;
-	std::string res;
+	std::vector<GS1Element> res;
 
 	while (rem.size()) {
-		const AiInfo* i = FindIf(aiInfos, [&](const AiInfo& i) { return starts_with(rem, i.aiPrefix); });
-		if (i == std::end(aiInfos))
+		const AiInfo* i = FindAiInfo(rem);
+		if (!i)
 			return {};
 
 		int aiSize = i->aiSize();
 		if (Size(rem) < aiSize)
 			return {};
 
-		res += '(';
-		res += rem.substr(0, aiSize);
-		res += ')';
+		auto ai = rem.substr(0, aiSize);
 		rem.remove_prefix(aiSize);
 
 		int fieldSize = i->fieldSize();
@@ -280,7 +310,7 @@ std::string HRIFromGS1(std::string_view gs1)
 		if (fieldSize == 0 || Size(rem) < fieldSize)
 			return {};
 
-		res += rem.substr(0, fieldSize);
+		res.push_back({ai, rem.substr(0, fieldSize)});
 		rem.remove_prefix(fieldSize);
 
 		// See General Specification v22.0 Section 7.8.6.3: "...the processing routine SHALL tolerate a single separator character
@@ -292,6 +322,18 @@ std::string HRIFromGS1(std::string_view gs1)
 	return res;
 }
 
+std::string HRIFromGS1(std::string_view gs1)
+{
+	std::string res;
+	for (auto [ai, value] : ParseGS1(gs1)) {
+		res += '(';
+		res += ai;
+		res += ')';
+		res += value;
+	}
+	return res;
+}
+
 #if __cplusplus > 201703L
 std::ostream& operator<<(std::ostream& os, const char8_t* str)
 {
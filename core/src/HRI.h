@@ -7,9 +7,25 @@
 
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace ZXing {
 
+/**
+ * @brief GS1Element is one element string of a GS1 message: the application identifier and its data field
+ */
+struct GS1Element
+{
+	std::string_view ai;
+	std::string_view value;
+};
+
+/**
+ * @brief ParseGS1 splits a sequence of GS1 element strings (with GS as separator after variable length fields) in a
+ * single pass. The returned views point into gs1. The result is empty if gs1 is not a valid sequence.
+ */
+std::vector<GS1Element> ParseGS1(std::string_view gs1);
+
 std::string HRIFromGS1(std::string_view gs1);
 std::string HRIFromISO15434(std::string_view str);
 
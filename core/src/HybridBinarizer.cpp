@@ -7,22 +7,37 @@
 #include "HybridBinarizer.h"
 
 #include "BitMatrix.h"
+#include "Executor.h"
 #include "Matrix.h"
+#include "TraceScope.h"
+#include "ZXConfig.h"
 
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 
+#if defined(ZX_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace ZXing {
 
 // This class uses 5x5 blocks to compute local luminance, where each block is 8x8 pixels.
 // So this is the smallest dimension in each axis we can accept.
-static constexpr int BLOCK_SIZE = 8;
+static constexpr int BLOCK_SIZE = HybridBinarizer::BlockSize;
 static constexpr int MINIMUM_DIMENSION = BLOCK_SIZE * 5;
 static constexpr int MIN_DYNAMIC_RANGE = 24;
 
-HybridBinarizer::HybridBinarizer(const ImageView& iv) : GlobalHistogramBinarizer(iv) {}
+HybridBinarizer::HybridBinarizer(const ImageView& iv, Executor* executor, bool subPixelEdges, const Matrix<int>* blackPoints)
+	: GlobalHistogramBinarizer(iv, subPixelEdges), _blackPoints(blackPoints)
+{
+	setExecutor(executor);
+}
 
 HybridBinarizer::~HybridBinarizer() = default;
 
@@ -43,87 +58,191 @@ bool HybridBinarizer::getPatternRow(int row, int rotation, PatternRow& res) cons
 #endif
 }
 
+using DensePixStride = std::integral_constant<int, 1>;
+
+/**
+* Computes sum, min and max of a BLOCK_SIZE x BLOCK_SIZE block of densely packed pixels with SIMD instructions.
+* Returns false if no SIMD implementation is available for the given pixStride.
+*/
+template<typename PixStride>
+static bool BlockStatisticsSIMD([[maybe_unused]] const uint8_t* __restrict p, [[maybe_unused]] int rowStride, PixStride,
+								[[maybe_unused]] int& sum, [[maybe_unused]] uint8_t& min, [[maybe_unused]] uint8_t& max)
+{
+	static_assert(BLOCK_SIZE == 8, "the SIMD code below assumes 8 pixel wide blocks");
+#if defined(ZX_USE_SSE2)
+	if constexpr (std::is_same_v<PixStride, DensePixStride>) {
+		const __m128i zero = _mm_setzero_si128();
+		__m128i vmin = _mm_set1_epi8(-1), vmax = zero, vsum = zero;
+		for (int y = 0; y < BLOCK_SIZE; y += 2, p += 2 * rowStride) {
+			__m128i v = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)),
+										   _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + rowStride)));
+			vmin = _mm_min_epu8(vmin, v);
+			vmax = _mm_max_epu8(vmax, v);
+			vsum = _mm_add_epi64(vsum, _mm_sad_epu8(v, zero));
+		}
+		// horizontal reduction of the 16 lanes
+		vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 8)), vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 8));
+		vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 4)), vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+		vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 2)), vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+		vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 1)), vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+		sum = _mm_cvtsi128_si32(vsum) + _mm_cvtsi128_si32(_mm_srli_si128(vsum, 8));
+		min = static_cast<uint8_t>(_mm_cvtsi128_si32(vmin));
+		max = static_cast<uint8_t>(_mm_cvtsi128_si32(vmax));
+		return true;
+	}
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+	if constexpr (std::is_same_v<PixStride, DensePixStride>) {
+		uint8x8_t vmin = vdup_n_u8(0xff), vmax = vdup_n_u8(0);
+		uint16x8_t vsum = vdupq_n_u16(0);
+		for (int y = 0; y < BLOCK_SIZE; ++y, p += rowStride) {
+			uint8x8_t v = vld1_u8(p);
+			vmin = vmin_u8(vmin, v);
+			vmax = vmax_u8(vmax, v);
+			vsum = vaddw_u8(vsum, v);
+		}
+		sum = vaddvq_u16(vsum);
+		min = vminv_u8(vmin);
+		max = vmaxv_u8(vmax);
+		return true;
+	}
+#endif
+	return false;
+}
+
+/**
+* Computes sum, min and max of the BLOCK_SIZE x BLOCK_SIZE block of pixels at (xoffset, yoffset). The min/max tests are
+* short-circuited once the dynamic range is met, so min and max are only exact if they differ by no more than that.
+*/
+template<typename PixStride>
+static HybridBinarizer::BlockStatistics CalculateBlock(const uint8_t* __restrict luminances, int xoffset, int yoffset,
+													   int rowStride, PixStride pixStride)
+{
+	HybridBinarizer::BlockStatistics res;
+	res.min = res.max = luminances[yoffset * rowStride + xoffset * pixStride];
+	// Note: the SIMD code always computes min/max of the whole block. This is bit-identical to the
+	// short-circuit logic below as min/max only matter if the dynamic range is never exceeded.
+	if (BlockStatisticsSIMD(luminances + yoffset * rowStride + xoffset * pixStride, rowStride, pixStride, res.sum, res.min, res.max))
+		return res;
+
+	int sum = 0;
+	uint8_t min = res.min, max = res.max;
+	for (int yy = 0, offset = yoffset * rowStride + xoffset * pixStride; yy < BLOCK_SIZE; yy++, offset += rowStride) {
+		for (int xx = 0; xx < BLOCK_SIZE; xx++) {
+			auto pixel = luminances[offset + xx * pixStride];
+			sum += pixel;
+			if (pixel < min)
+				min = pixel;
+			if (pixel > max)
+				max = pixel;
+		}
+		// short-circuit min/max tests once dynamic range is met
+		if (max - min > MIN_DYNAMIC_RANGE) {
+			// finish the rest of the rows quickly
+			for (yy++, offset += rowStride; yy < BLOCK_SIZE; yy++, offset += rowStride) {
+				for (int xx = 0; xx < BLOCK_SIZE; xx++) {
+					sum += luminances[offset + xx * pixStride];
+				}
+			}
+		}
+	}
+	return {sum, min, max};
+}
+
+/**
+* The black point of a block, see CalculateBlackPoints. Low contrast blocks are marked with the negative value -1 - min.
+*/
+static int BlackPoint(const HybridBinarizer::BlockStatistics& stats)
+{
+	// The default estimate is the average of the values in the block.
+	if (stats.max - stats.min > MIN_DYNAMIC_RANGE)
+		return stats.sum / (BLOCK_SIZE * BLOCK_SIZE);
+	else
+		return -1 - stats.min;
+}
+
 /**
-* Calculates a single black point for each block of pixels and saves it away.
+* Calculates a single black point for each block of pixels in the block rows [yBegin, yEnd) and saves it away.
 * See the following thread for a discussion of this algorithm:
 *  http://groups.google.com/group/zxing/browse_thread/thread/d06efa2c35a7ddc0
+*
+* Low contrast blocks depend on the final black points of their neighbors, they are marked with the negative
+* value -1 - min and resolved afterwards in a sequential pass (see ResolveLowContrastBlocks). This makes the
+* expensive part of the computation independent for each block row.
 */
-static Matrix<int> CalculateBlackPoints(const uint8_t* __restrict luminances, int subWidth, int subHeight, int width, int height,
-										int rowStride)
+template<typename PixStride>
+static void CalculateBlackPoints(const uint8_t* __restrict luminances, int subWidth, int yBegin, int yEnd, int width, int height,
+								 int rowStride, PixStride pixStride, Matrix<int>& blackPoints)
 {
-	Matrix<int>	blackPoints(subWidth, subHeight);
-
-	for (int y = 0; y < subHeight; y++) {
+	for (int y = yBegin; y < yEnd; y++) {
 		int yoffset = std::min(y * BLOCK_SIZE, height - BLOCK_SIZE);
 		for (int x = 0; x < subWidth; x++) {
 			int xoffset = std::min(x * BLOCK_SIZE, width - BLOCK_SIZE);
-			int sum = 0;
-			uint8_t min = luminances[yoffset * rowStride + xoffset];
-			uint8_t max = min;
-			for (int yy = 0, offset = yoffset * rowStride + xoffset; yy < BLOCK_SIZE; yy++, offset += rowStride) {
-				for (int xx = 0; xx < BLOCK_SIZE; xx++) {
-					auto pixel = luminances[offset + xx];
-					sum += pixel;
-					if (pixel < min)
-						min = pixel;
-					if (pixel > max)
-						max = pixel;
-				}
-				// short-circuit min/max tests once dynamic range is met
-				if (max - min > MIN_DYNAMIC_RANGE) {
-					// finish the rest of the rows quickly
-					for (yy++, offset += rowStride; yy < BLOCK_SIZE; yy++, offset += rowStride) {
-						for (int xx = 0; xx < BLOCK_SIZE; xx++) {
-							sum += luminances[offset + xx];
-						}
-					}
-				}
-			}
+			blackPoints(x, y) = BlackPoint(CalculateBlock(luminances, xoffset, yoffset, rowStride, pixStride));
+		}
+	}
+}
 
-			// The default estimate is the average of the values in the block.
-			int average = sum / (BLOCK_SIZE * BLOCK_SIZE);
-			if (max - min <= MIN_DYNAMIC_RANGE) {
-				// If variation within the block is low, assume this is a block with only light or only
-				// dark pixels. In that case we do not want to use the average, as it would divide this
-				// low contrast area into black and white pixels, essentially creating data out of noise.
-				//
-				// The default assumption is that the block is light/background. Since no estimate for
-				// the level of dark pixels exists locally, use half the min for the block.
-				average = min / 2;
-
-				if (y > 0 && x > 0) {
-					// Correct the "white background" assumption for blocks that have neighbors by comparing
-					// the pixels in this block to the previously calculated black points. This is based on
-					// the fact that dark barcode symbology is always surrounded by some amount of light
-					// background for which reasonable black point estimates were made. The bp estimated at
-					// the boundaries is used for the interior.
-
-					// The (min < bp) is arbitrary but works better than other heuristics that were tried.
-					int averageNeighborBlackPoint =
-						(blackPoints(x, y - 1) + (2 * blackPoints(x - 1, y)) + blackPoints(x - 1, y - 1)) / 4;
-					if (min < averageNeighborBlackPoint) {
-						average = averageNeighborBlackPoint;
-					}
+static void ResolveLowContrastBlocks(Matrix<int>& blackPoints)
+{
+	for (int y = 0; y < blackPoints.height(); y++) {
+		for (int x = 0; x < blackPoints.width(); x++) {
+			if (blackPoints(x, y) >= 0)
+				continue;
+
+			int min = -1 - blackPoints(x, y);
+			// If variation within the block is low, assume this is a block with only light or only
+			// dark pixels. In that case we do not want to use the average, as it would divide this
+			// low contrast area into black and white pixels, essentially creating data out of noise.
+			//
+			// The default assumption is that the block is light/background. Since no estimate for
+			// the level of dark pixels exists locally, use half the min for the block.
+			int average = min / 2;
+
+			if (y > 0 && x > 0) {
+				// Correct the "white background" assumption for blocks that have neighbors by comparing
+				// the pixels in this block to the previously calculated black points. This is based on
+				// the fact that dark barcode symbology is always surrounded by some amount of light
+				// background for which reasonable black point estimates were made. The bp estimated at
+				// the boundaries is used for the interior.
+
+				// The (min < bp) is arbitrary but works better than other heuristics that were tried.
+				int averageNeighborBlackPoint =
+					(blackPoints(x, y - 1) + (2 * blackPoints(x - 1, y)) + blackPoints(x - 1, y - 1)) / 4;
+				if (min < averageNeighborBlackPoint) {
+					average = averageNeighborBlackPoint;
 				}
 			}
 			blackPoints(x, y) = average;
 		}
 	}
-	return blackPoints;
 }
 
-
 /**
 * Applies a single threshold to a block of pixels.
 */
+template<typename PixStride>
 static void ThresholdBlock(const uint8_t* __restrict luminances, int xoffset, int yoffset, int threshold, int rowStride,
-						   BitMatrix& matrix)
+						   PixStride pixStride, BitMatrix& matrix)
 {
+	static_assert(BitMatrix::SET_V == 0xff, "the SIMD code below relies on SET_V being an all-ones byte");
 	for (int y = yoffset; y < yoffset + BLOCK_SIZE; ++y) {
-		auto* src = luminances + y * rowStride + xoffset;
+		auto* src = luminances + y * rowStride + xoffset * pixStride;
 		auto* const dstBegin = matrix.row(y).begin() + xoffset;
-		// TODO: fix pixelStride > 1 case
-		for (auto* dst = dstBegin; dst < dstBegin + BLOCK_SIZE; ++dst, ++src)
+#if defined(ZX_USE_SSE2)
+		if constexpr (std::is_same_v<PixStride, DensePixStride>) {
+			// src <= threshold <=> min(src, threshold) == src
+			__m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+			__m128i bits = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(static_cast<char>(threshold))), v);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dstBegin), bits);
+			continue;
+		}
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+		if constexpr (std::is_same_v<PixStride, DensePixStride>) {
+			vst1_u8(dstBegin, vcle_u8(vld1_u8(src), vdup_n_u8(threshold)));
+			continue;
+		}
+#endif
+		for (auto* dst = dstBegin; dst < dstBegin + BLOCK_SIZE; ++dst, src += pixStride)
 			*dst = (*src <= threshold) * BitMatrix::SET_V;
 	}
 }
@@ -133,12 +252,12 @@ static void ThresholdBlock(const uint8_t* __restrict luminances, int xoffset, in
 * of the blocks around it. Also handles the corner cases (fractional blocks are computed based
 * on the last pixels in the row/column which are also used in the previous block).
 */
-static std::shared_ptr<BitMatrix> CalculateMatrix(const uint8_t* __restrict luminances, int subWidth, int subHeight, int width,
-												  int height, int rowStride, const Matrix<int>& blackPoints)
+template<typename PixStride>
+static void CalculateMatrix(const uint8_t* __restrict luminances, int subWidth, int subHeight, int yBegin, int yEnd,
+							int width, int height, int rowStride, PixStride pixStride, const Matrix<int>& blackPoints,
+							BitMatrix& matrix)
 {
-	auto matrix = std::make_shared<BitMatrix>(width, height);
-
-	for (int y = 0; y < subHeight; y++) {
+	for (int y = yBegin; y < yEnd; y++) {
 		int yoffset = std::min(y * BLOCK_SIZE, height - BLOCK_SIZE);
 		for (int x = 0; x < subWidth; x++) {
 			int xoffset = std::min(x * BLOCK_SIZE, width - BLOCK_SIZE);
@@ -151,23 +270,133 @@ static std::shared_ptr<BitMatrix> CalculateMatrix(const uint8_t* __restrict lumi
 				}
 			}
 			int average = sum / 25;
-			ThresholdBlock(luminances, xoffset, yoffset, average, rowStride, *matrix);
+			ThresholdBlock(luminances, xoffset, yoffset, average, rowStride, pixStride, matrix);
 		}
 	}
+}
+
+/**
+* Calls func(begin, end) for consecutive bands of the rows [0, rows), in parallel if an executor is available and the
+* number of rows is large enough to make it worthwhile.
+*/
+template<typename F>
+static void ForEachBand(Executor* executor, int rows, F func)
+{
+	// The last block row overlaps the previous one (see yoffset above), with this minimum band size both are always
+	// part of the same band, so that no two concurrent calls write the same pixels.
+	constexpr int MIN_BAND_ROWS = 32;
+	int bands = executor ? std::min(executor->concurrency(), rows / MIN_BAND_ROWS) : 1;
+	if (bands < 2)
+		return func(0, rows);
+	executor->parallelFor(bands, [&](int i) { func(rows * i / bands, rows * (i + 1) / bands); });
+}
 
-	return matrix;
+/**
+* Calls func(pixStride) with a compile time pixStride of 1 for densely packed pixels, like the downscaled layers.
+*/
+template<typename F>
+static void WithPixStride(const ImageView& iv, F func)
+{
+	if (iv.pixStride() == 1)
+		func(DensePixStride());
+	else
+		func(iv.pixStride());
+}
+
+void HybridBinarizer::CalculateBlockStatistics(const ImageView& iv, int yBegin, int yEnd, Matrix<BlockStatistics>& stats)
+{
+	WithPixStride(iv, [&](auto pixStride) {
+		for (int y = yBegin; y < yEnd; y++) {
+			int yoffset = std::min(y * BLOCK_SIZE, iv.height() - BLOCK_SIZE);
+			for (int x = 0; x < stats.width(); x++) {
+				int xoffset = std::min(x * BLOCK_SIZE, iv.width() - BLOCK_SIZE);
+				stats(x, y) = CalculateBlock(iv.data(0, 0), xoffset, yoffset, iv.rowStride(), pixStride);
+			}
+		}
+	});
+}
+
+void HybridBinarizer::DeriveBlockStatistics(const ImageView& iv, const Matrix<BlockStatistics>& parent, int parentWidth,
+											int parentHeight, int factor, Matrix<BlockStatistics>& stats)
+{
+	if (iv.width() > parentWidth / factor || iv.height() > parentHeight / factor)
+		throw std::invalid_argument("image is not downscaled from the parent");
+
+	const int n2 = factor * factor;
+	WithPixStride(iv, [&](auto pixStride) {
+		for (int y = 0; y < stats.height(); y++) {
+			int yoffset = std::min(y * BLOCK_SIZE, iv.height() - BLOCK_SIZE);
+			for (int x = 0; x < stats.width(); x++) {
+				int xoffset = std::min(x * BLOCK_SIZE, iv.width() - BLOCK_SIZE);
+				if (xoffset % BLOCK_SIZE || yoffset % BLOCK_SIZE) {
+					stats(x, y) = CalculateBlock(iv.data(0, 0), xoffset, yoffset, iv.rowStride(), pixStride);
+					continue;
+				}
+				// the parent blocks covering this one are all regular (non-overlapping) ones, as the downscaled image
+				// only covers the first (size / factor) * factor pixels of the parent
+				BlockStatistics res = parent(x * factor, y * factor);
+				int sum = 0;
+				for (int py = y * factor; py < (y + 1) * factor; ++py) {
+					for (int px = x * factor; px < (x + 1) * factor; ++px) {
+						const auto& p = parent(px, py);
+						sum += p.sum;
+						res.min = std::min(res.min, p.min);
+						res.max = std::max(res.max, p.max);
+					}
+				}
+				res.sum = (sum + n2 / 2) / n2;
+				stats(x, y) = res;
+			}
+		}
+	});
+}
+
+Matrix<int> HybridBinarizer::BlackPoints(const Matrix<BlockStatistics>& stats)
+{
+	Matrix<int> blackPoints(stats.width(), stats.height());
+	for (int y = 0; y < stats.height(); y++)
+		for (int x = 0; x < stats.width(); x++)
+			blackPoints(x, y) = BlackPoint(stats(x, y));
+	ResolveLowContrastBlocks(blackPoints);
+	return blackPoints;
 }
 
 std::shared_ptr<const BitMatrix> HybridBinarizer::getBlackMatrix() const
 {
+	ZX_TRACE_SCOPE("HybridBinarizer::getBlackMatrix");
 	if (width() >= MINIMUM_DIMENSION && height() >= MINIMUM_DIMENSION) {
 		const uint8_t* luminances = _buffer.data(0, 0);
 		int subWidth = (width() + BLOCK_SIZE - 1) / BLOCK_SIZE; // ceil(width/BS)
 		int subHeight = (height() + BLOCK_SIZE - 1) / BLOCK_SIZE; // ceil(height/BS)
-		auto blackPoints =
-			CalculateBlackPoints(luminances, subWidth, subHeight, width(), height(), _buffer.rowStride());
+		int rowStride = _buffer.rowStride();
+		auto binarize = [&](auto pixStride) {
+			Matrix<int> computed;
+			if (!_blackPoints) {
+				computed = Matrix<int>(subWidth, subHeight);
+				ForEachBand(executor(), subHeight, [&](int yBegin, int yEnd) {
+					CalculateBlackPoints(luminances, subWidth, yBegin, yEnd, width(), height(), rowStride, pixStride, computed);
+				});
+				ResolveLowContrastBlocks(computed);
+			}
+			const auto& blackPoints = _blackPoints ? *_blackPoints : computed;
 
-		return CalculateMatrix(luminances, subWidth, subHeight, width(), height(), _buffer.rowStride(), blackPoints);
+			auto matrix = std::make_shared<BitMatrix>(width(), height(), BitMatrix::ROW_ALIGNMENT);
+			ForEachBand(executor(), subHeight, [&](int yBegin, int yEnd) {
+				CalculateMatrix(luminances, subWidth, subHeight, yBegin, yEnd, width(), height(), rowStride, pixStride,
+								blackPoints, *matrix);
+			});
+			return matrix;
+		};
+
+		// a compile time pixStride lets the compiler generate dedicated (vectorized) code for the common interleaved
+		// layouts, e.g. the Y channel of YUYV (2) or of packed YUV/RGB-like buffers (3, 4)
+		switch (_buffer.pixStride()) {
+		case 1: return binarize(std::integral_constant<int, 1>());
+		case 2: return binarize(std::integral_constant<int, 2>());
+		case 3: return binarize(std::integral_constant<int, 3>());
+		case 4: return binarize(std::integral_constant<int, 4>());
+		default: return binarize(_buffer.pixStride());
+		}
 	} else {
 		// If the image is too small, fall back to the global histogram approach.
 		return GlobalHistogramBinarizer::getBlackMatrix();
@@ -10,6 +10,9 @@
 
 namespace ZXing {
 
+class Executor;
+template <typename T> class Matrix;
+
 /**
 * This class implements a local thresholding algorithm, which while slower than the
 * GlobalHistogramBinarizer, is fairly efficient for what it does. It is designed for
@@ -29,10 +32,50 @@ namespace ZXing {
 */
 class HybridBinarizer : public GlobalHistogramBinarizer
 {
+	const Matrix<int>* _blackPoints = nullptr;
+
 public:
-	explicit HybridBinarizer(const ImageView& iv);
+	/// The size of the square blocks a threshold is computed for, images smaller than 5 blocks fall back to the
+	/// GlobalHistogramBinarizer
+	static constexpr int BlockSize = 8;
+
+	/// Sum, minimum and maximum of the pixels of a block
+	struct BlockStatistics
+	{
+		int sum = 0;
+		uint8_t min = 0, max = 0;
+	};
+
+	/// @param executor  optional Executor used to binarize large images in parallel horizontal bands (not owned)
+	/// @param subPixelEdges  see GlobalHistogramBinarizer
+	/// @param blackPoints  optional black points of the blocks, see BlackPoints() (not owned)
+	explicit HybridBinarizer(const ImageView& iv, Executor* executor = nullptr, bool subPixelEdges = false,
+							 const Matrix<int>* blackPoints = nullptr);
 	~HybridBinarizer() override;
 
+	/**
+	 * Compute the statistics of the block rows [yBegin, yEnd) of iv into stats (sized ceil(width / BlockSize) x
+	 * ceil(height / BlockSize)). The last block row (column) overlaps the previous one if the height (width) is not a
+	 * multiple of BlockSize, i.e. it ends with the last pixel row (column). This allows computing them while the image
+	 * is produced (e.g. by downscaling), when its rows are still in the cache. Note: min and max are only guaranteed to
+	 * be exact if they differ by no more than the minimal dynamic range, which is all BlackPoints() needs.
+	 */
+	static void CalculateBlockStatistics(const ImageView& iv, int yBegin, int yEnd, Matrix<BlockStatistics>& stats);
+
+	/**
+	 * Derive the block statistics of iv, the image downscaled by factor from one with the given size and block
+	 * statistics, from the factor x factor blocks of the parent covering each block, instead of from the pixels. Only
+	 * the last block row and column, which are not aligned with the parent blocks if the size of iv is not a multiple
+	 * of BlockSize, are computed from the pixels. The result is an approximation: the sums ignore the rounding of the
+	 * downscaled pixels (the black points differ by at most 1) and min/max are those of the parent pixels, i.e. the
+	 * dynamic range of the averaged pixels is overestimated.
+	 */
+	static void DeriveBlockStatistics(const ImageView& iv, const Matrix<BlockStatistics>& parent, int parentWidth,
+									  int parentHeight, int factor, Matrix<BlockStatistics>& stats);
+
+	/// The black points of the blocks with the given statistics, as used by getBlackMatrix()
+	static Matrix<int> BlackPoints(const Matrix<BlockStatistics>& stats);
+
 	bool getPatternRow(int row, int rotation, PatternRow &res) const override;
 	std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
 };
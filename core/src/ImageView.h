@@ -6,6 +6,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 
 namespace ZXing {
@@ -20,9 +21,18 @@ enum class ImageFormat : uint32_t
 	XRGB = 0x04010203,
 	BGRX = 0x04020100,
 	XBGR = 0x04030201,
+
+	// YUV formats: only the luminance (Y) samples are used, an ImageView constructed with one of these formats
+	// references the Y samples in place and reports ImageFormat::Lum (see IsYUV(), all 3 color indices point to Y)
+	NV12 = 0x41000000, ///< planar Y followed by interleaved UV, data points to the Y plane
+	NV21 = 0x51000000, ///< planar Y followed by interleaved VU, data points to the Y plane
+	I420 = 0x61000000, ///< planar Y, U and V, data points to the Y plane
+	YUYV = 0x42000000, ///< packed Y0 U Y1 V (aka YUY2)
+	UYVY = 0x42010101, ///< packed U Y0 V Y1
 };
 
-constexpr inline int PixStride(ImageFormat format) { return (static_cast<uint32_t>(format) >> 3*8) & 0xFF; }
+constexpr inline bool IsYUV(ImageFormat format) { return static_cast<uint32_t>(format) & 0x40000000; }
+constexpr inline int PixStride(ImageFormat format) { return (static_cast<uint32_t>(format) >> 3*8) & 0x0F; }
 constexpr inline int RedIndex(ImageFormat format) { return (static_cast<uint32_t>(format) >> 2*8) & 0xFF; }
 constexpr inline int GreenIndex(ImageFormat format) { return (static_cast<uint32_t>(format) >> 1*8) & 0xFF; }
 constexpr inline int BlueIndex(ImageFormat format) { return (static_cast<uint32_t>(format) >> 0*8) & 0xFF; }
@@ -35,6 +45,14 @@ constexpr inline uint8_t RGBToLum(unsigned r, unsigned g, unsigned b)
 	return static_cast<uint8_t>((306 * r + 601 * g + 117 * b + 0x200) >> 10);
 }
 
+/**
+ * Simple axis aligned rectangle in pixel coordinates, e.g. to specify a region of interest inside an image.
+ */
+struct Rect
+{
+	int left = 0, top = 0, width = 0, height = 0;
+};
+
 /**
  * Simple class that stores a non-owning const pointer to image data plus layout and format information.
  */
@@ -52,13 +70,13 @@ public:
 	 * @param data  pointer to image buffer
 	 * @param width  image width in pixels
 	 * @param height  image height in pixels
-	 * @param format  image/pixel format
+	 * @param format  image/pixel format, YUV formats result in a Lum view of the Y samples (no copy)
 	 * @param rowStride  optional row stride in bytes, default is width * pixStride
 	 * @param pixStride  optional pixel stride in bytes, default is calculated from format
 	 */
 	ImageView(const uint8_t* data, int width, int height, ImageFormat format, int rowStride = 0, int pixStride = 0)
-		: _data(data),
-		  _format(format),
+		: _data(data && IsYUV(format) ? data + BlueIndex(format) : data),
+		  _format(IsYUV(format) ? ImageFormat::Lum : format),
 		  _width(width),
 		  _height(height),
 		  _pixStride(pixStride ? pixStride : PixStride(format)),
@@ -71,7 +89,8 @@ public:
 	int rowStride() const { return _rowStride; }
 	ImageFormat format() const { return _format; }
 
-	const uint8_t* data(int x, int y) const { return _data + y * _rowStride + x * _pixStride; }
+	// the offset is computed in std::ptrdiff_t, the image may be larger than 2 GB
+	const uint8_t* data(int x, int y) const { return _data + std::ptrdiff_t(y) * _rowStride + std::ptrdiff_t(x) * _pixStride; }
 
 	ImageView cropped(int left, int top, int width, int height) const
 	{
@@ -82,6 +101,8 @@ public:
 		return {data(left, top), width, height, _format, _rowStride, _pixStride};
 	}
 
+	ImageView cropped(const Rect& r) const { return cropped(r.left, r.top, r.width, r.height); }
+
 	ImageView rotated(int degree) const
 	{
 		switch ((degree + 360) % 360) {
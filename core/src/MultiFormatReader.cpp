@@ -9,63 +9,247 @@
 #include "BarcodeFormat.h"
 #include "BinaryBitmap.h"
 #include "DecodeHints.h"
+#include "Reader.h"
+#include "StatsScope.h"
+#include "TraceScope.h"
+#ifdef ZXING_READER_AZTEC
 #include "aztec/AZReader.h"
+#endif
+#ifdef ZXING_READER_DATAMATRIX
 #include "datamatrix/DMReader.h"
+#endif
+#ifdef ZXING_READER_MAXICODE
 #include "maxicode/MCReader.h"
+#endif
+#ifdef ZXING_READER_ONED
 #include "oned/ODReader.h"
+#endif
+#ifdef ZXING_READER_PDF417
 #include "pdf417/PDFReader.h"
+#endif
+#ifdef ZXING_READER_QRCODE
 #include "qrcode/QRReader.h"
+#endif
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <memory>
+#include <numeric>
 
 namespace ZXing {
 
+// The reader of a BarcodeReader session is shared by the tasks of readParallel(), hence the atomics. The updates of
+// the three values are not synchronized with each other, which at worst skews one estimate a little.
+struct MultiFormatReader::ReaderStats
+{
+	std::atomic<int64_t> calls = 0;
+	std::atomic<int64_t> hits = 0;
+	std::atomic<int64_t> nanoseconds = 0;
+};
+
 MultiFormatReader::MultiFormatReader(const DecodeHints& hints) : _hints(hints)
 {
 	auto formats = hints.formats().empty() ? BarcodeFormat::Any : hints.formats();
 
+	// the hints of the reader of the given formats, a copy with the format overrides applied if there are any
+	auto hintsFor = [&](BarcodeFormats readerFormats) -> const DecodeHints& {
+		if (hints.formatOverrides().empty())
+			return hints;
+		return *_readerHints.emplace_back(std::make_unique<DecodeHints>(hints.forFormats(formats & readerFormats)));
+	};
+
+	// the tile classes (see ClassifyTiles) a symbol of the reader shows. A rotated linear symbol can come out Stacked,
+	// the rows of a PDF417 symbol mostly Linear or Stacked. Matrix symbols have edges in all directions.
+	[[maybe_unused]] constexpr int bars = 1 << int(TileClass::Linear) | 1 << int(TileClass::Stacked);
+	[[maybe_unused]] constexpr int modules = 1 << int(TileClass::Matrix);
+	auto add = [&](Reader* reader, int tileClassMask) {
+		_readers.emplace_back(reader);
+		_tileClassMasks.push_back(tileClassMask);
+	};
+
+	// the readers not built (see ZXING_READERS in core/CMakeLists.txt) are left out
+#ifdef ZXING_READER_ONED
 	// Put linear readers upfront in "normal" mode
-	if (formats.testFlags(BarcodeFormat::LinearCodes) && !hints.tryHarder())
-		_readers.emplace_back(new OneD::Reader(hints));
+	const auto& linearHints = hintsFor(BarcodeFormat::LinearCodes);
+	if (formats.testFlags(BarcodeFormat::LinearCodes) && !linearHints.tryHarder())
+		add(new OneD::Reader(linearHints), bars);
+#endif
 
+#ifdef ZXING_READER_QRCODE
 	if (formats.testFlags(BarcodeFormat::QRCode | BarcodeFormat::MicroQRCode))
-		_readers.emplace_back(new QRCode::Reader(hints, true));
+		add(new QRCode::Reader(hintsFor(BarcodeFormat::QRCode | BarcodeFormat::MicroQRCode), true), modules);
+#endif
+#ifdef ZXING_READER_DATAMATRIX
 	if (formats.testFlag(BarcodeFormat::DataMatrix))
-		_readers.emplace_back(new DataMatrix::Reader(hints, true));
+		add(new DataMatrix::Reader(hintsFor(BarcodeFormat::DataMatrix), true), modules);
+#endif
+#ifdef ZXING_READER_AZTEC
 	if (formats.testFlag(BarcodeFormat::Aztec))
-		_readers.emplace_back(new Aztec::Reader(hints, true));
+		add(new Aztec::Reader(hintsFor(BarcodeFormat::Aztec), true), modules);
+#endif
+#ifdef ZXING_READER_PDF417
 	if (formats.testFlag(BarcodeFormat::PDF417))
-		_readers.emplace_back(new Pdf417::Reader(hints));
+		add(new Pdf417::Reader(hintsFor(BarcodeFormat::PDF417)), bars);
+#endif
+#ifdef ZXING_READER_MAXICODE
 	if (formats.testFlag(BarcodeFormat::MaxiCode))
-		_readers.emplace_back(new MaxiCode::Reader(hints));
+		add(new MaxiCode::Reader(hintsFor(BarcodeFormat::MaxiCode)), modules);
+#endif
 
+#ifdef ZXING_READER_ONED
 	// At end in "try harder" mode
-	if (formats.testFlags(BarcodeFormat::LinearCodes) && hints.tryHarder())
-		_readers.emplace_back(new OneD::Reader(hints));
+	if (formats.testFlags(BarcodeFormat::LinearCodes) && linearHints.tryHarder())
+		add(new OneD::Reader(linearHints), bars);
+#endif
+
+	assert(Size(_readers) <= MaxReaders);
+	if (hints.adaptiveReaderOrder())
+		_stats = std::make_unique<ReaderStats[]>(_readers.size());
 }
 
 MultiFormatReader::~MultiFormatReader() = default;
 
+MultiFormatReader::Order MultiFormatReader::order() const
+{
+	Order res;
+	const int n = Size(_readers);
+	std::iota(res.begin(), res.begin() + n, 0);
+	if (!_stats)
+		return res;
+
+	// A reader is run until it has been called MIN_CALLS times in its original position, from then on the readers
+	// are sorted by their expected cost per hit, i.e. the average cost of a call divided by the estimated hit rate
+	// (with one hit and one miss assumed upfront, so a reader that has not hit so far is not ruled out forever).
+	constexpr int MIN_CALLS = 4;
+	double expectedCost[MaxReaders];
+	for (int i = 0; i < n; ++i) {
+		double calls = static_cast<double>(_stats[i].calls.load(std::memory_order_relaxed));
+		double hits = static_cast<double>(_stats[i].hits.load(std::memory_order_relaxed));
+		double ns = static_cast<double>(_stats[i].nanoseconds.load(std::memory_order_relaxed));
+		expectedCost[i] = calls < MIN_CALLS ? -1 : ns / calls * (calls + 2) / (hits + 1);
+	}
+	std::stable_sort(res.begin(), res.begin() + n, [&](int a, int b) { return expectedCost[a] < expectedCost[b]; });
+	return res;
+}
+
+void MultiFormatReader::account(int i, std::chrono::steady_clock::duration cost, bool hit) const
+{
+	// halving the values every DECAY_CALLS calls lets the order follow a change of the input
+	constexpr int DECAY_CALLS = 256;
+	auto& stats = _stats[i];
+	stats.hits.fetch_add(hit, std::memory_order_relaxed);
+	stats.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(cost).count(), std::memory_order_relaxed);
+	if (stats.calls.fetch_add(1, std::memory_order_relaxed) + 1 >= DECAY_CALLS)
+		for (auto* v : {&stats.calls, &stats.hits, &stats.nanoseconds})
+			v->store(v->load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+}
+
+std::vector<int> MultiFormatReader::readerOrder() const
+{
+	auto res = order();
+	return {res.begin(), res.begin() + Size(_readers)};
+}
+
+bool MultiFormatReader::skip(int i, const BinaryBitmap& image) const
+{
+	// pure images are not worth the classification and the cached tile classes make it a one time cost per image
+	if (!_hints.preClassify() || _hints.isPure() || !image.getBitMatrix())
+		return false;
+	return !(TileClassMask(image.tileClasses()) & _tileClassMasks[i]);
+}
+
 Result
 MultiFormatReader::read(const BinaryBitmap& image) const
 {
+	ZX_TRACE_SCOPE("MultiFormatReader::read");
 	Result r;
-	for (const auto& reader : _readers) {
-		r = reader->decode(image);
+	auto order = this->order();
+	for (int n = 0; n < Size(_readers); ++n) {
+		const int i = order[n];
+		StatsScope scope(DecodeStats::Stage::Detect);
+		if (skip(i, image))
+			continue;
+		auto start = _stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+		r = _readers[i]->decode(image);
+		if (_stats)
+			account(i, std::chrono::steady_clock::now() - start, r.isValid());
   		if (r.isValid())
 			return r;
 	}
 	return _hints.returnErrors() ? r : Result();
 }
 
+Results MultiFormatReader::readInterleaved(const BinaryBitmap& image, const Order& readers, int count) const
+{
+	// The candidates of the readers are evaluated round-robin (see Reader::candidates()), so the symbol a reader finds
+	// early is not delayed by the exhaustive search of the readers before it in the order. For the adaptive order, a
+	// reader that got interrupted by the hit of another one counts as a miss with the cost of the steps it did.
+	std::array<std::unique_ptr<CandidateStream>, MaxReaders> streams;
+	std::array<std::chrono::steady_clock::duration, MaxReaders> costs = {};
+	std::array<bool, MaxReaders> stepped = {};
+	for (int n = 0; n < count; ++n)
+		streams[n] = _readers[readers[n]]->candidates(image, 1);
+
+	Results res;
+	for (int running = count; running && res.empty();) {
+		for (int n = 0; n < count && res.empty(); ++n) {
+			if (!streams[n])
+				continue;
+			StatsScope scope(DecodeStats::Stage::Detect);
+			auto start = _stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+			bool more = streams[n]->next(res);
+			stepped[n] = true;
+			if (_stats)
+				costs[n] += std::chrono::steady_clock::now() - start;
+			if (more && res.empty())
+				continue;
+			if (_stats)
+				account(readers[n], costs[n], std::any_of(res.begin(), res.end(), [](const Result& r) { return r.isValid(); }));
+			streams[n].reset();
+			--running;
+		}
+	}
+	if (_stats)
+		for (int n = 0; n < count; ++n)
+			if (streams[n] && stepped[n])
+				account(readers[n], costs[n], false);
+	if (Size(res) > 1) // with an executor, a reader may evaluate a few candidates per step
+		res.erase(res.begin() + 1, res.end());
+	return res;
+}
+
 Results MultiFormatReader::readMultiple(const BinaryBitmap& image, int maxSymbols) const
 {
+	ZX_TRACE_SCOPE("MultiFormatReader::readMultiple");
 	std::vector<Result> res;
 
-	for (const auto& reader : _readers) {
-		if (image.inverted() && !reader->supportsInversion)
+	auto order = this->order();
+	Order readers;
+	int count = 0;
+	for (int n = 0; n < Size(_readers); ++n) {
+		const int i = order[n];
+		if (image.inverted() && !(_readers[i]->supportsInversion && _readers[i]->hints().tryInvert()))
 			continue;
-		auto r = reader->decode(image, maxSymbols);
+		StatsScope scope(DecodeStats::Stage::Detect);
+		if (!skip(i, image))
+			readers[count++] = i;
+	}
+
+	if (maxSymbols == 1 && count > 1)
+		return readInterleaved(image, readers, count);
+
+	for (int n = 0; n < count; ++n) {
+		const int i = readers[n];
+		Results r;
+		{
+			StatsScope scope(DecodeStats::Stage::Detect);
+			auto start = _stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+			r = _readers[i]->decode(image, maxSymbols);
+			if (_stats)
+				account(i, std::chrono::steady_clock::now() - start,
+						std::any_of(r.begin(), r.end(), [](const Result& r) { return r.isValid(); }));
+		}
 		if (!_hints.returnErrors()) {
 			//TODO: C++20 res.erase_if()
 			auto it = std::remove_if(res.begin(), res.end(), [](auto&& r) { return !r.isValid(); });
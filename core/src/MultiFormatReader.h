@@ -8,8 +8,10 @@
 
 #include "Result.h"
 
-#include <vector>
+#include <array>
+#include <chrono>
 #include <memory>
+#include <vector>
 
 namespace ZXing {
 
@@ -38,8 +40,25 @@ public:
 	// WARNING: this API is experimental and may change/disappear
 	Results readMultiple(const BinaryBitmap& image, int maxSymbols = 0xFF) const;
 
+	// WARNING: this API is experimental and may change/disappear
+	/// The indices (in order of construction) of the readers in the order the next read() runs them, see
+	/// DecodeHints::adaptiveReaderOrder()
+	std::vector<int> readerOrder() const;
+
 private:
+	static constexpr int MaxReaders = 8;
+	using Order = std::array<int, MaxReaders>;
+	struct ReaderStats;
+
+	Order order() const;
+	void account(int i, std::chrono::steady_clock::duration cost, bool hit) const;
+	bool skip(int i, const BinaryBitmap& image) const;
+	Results readInterleaved(const BinaryBitmap& image, const Order& readers, int count) const;
+
+	std::vector<std::unique_ptr<DecodeHints>> _readerHints; // see DecodeHints::formatOverrides(), outlives the readers
 	std::vector<std::unique_ptr<Reader>> _readers;
+	std::unique_ptr<ReaderStats[]> _stats; // per reader, only with DecodeHints::adaptiveReaderOrder()
+	std::vector<int> _tileClassMasks; // TileClassMask() of the images the reader with the same index can succeed on
 	const DecodeHints& _hints;
 };
 
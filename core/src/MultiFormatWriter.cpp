@@ -6,6 +6,7 @@
 #include "MultiFormatWriter.h"
 
 #include "BitMatrix.h"
+#include "Executor.h"
 #include "aztec/AZWriter.h"
 #include "datamatrix/DMWriter.h"
 #include "oned/ODCodabarWriter.h"
@@ -20,19 +21,24 @@
 #include "pdf417/PDFWriter.h"
 #include "qrcode/QRErrorCorrectionLevel.h"
 #include "qrcode/QRWriter.h"
-#include "Utf.h"
+#include "ZXAlgorithms.h"
 
+#include <algorithm>
+#include <exception>
+#include <mutex>
 #include <stdexcept>
+#include <utility>
 
 namespace ZXing {
 
-BitMatrix
-MultiFormatWriter::encode(const std::wstring& contents, int width, int height) const
+// Calls func with the writer for _format, configured according to the settings of this object
+template <typename FUNC>
+auto MultiFormatWriter::visitWriter(FUNC func) const
 {
 	auto exec0 = [&](auto&& writer) {
 		if (_margin >=0)
 			writer.setMargin(_margin);
-		return writer.encode(contents, width, height);
+		return func(std::as_const(writer));
 	};
 
 	auto AztecEccLevel = [&](Aztec::Writer& writer, int eccLevel) { writer.setEccPercent(eccLevel * 100 / 8); };
@@ -73,9 +79,124 @@ MultiFormatWriter::encode(const std::wstring& contents, int width, int height) c
 	}
 }
 
+BitMatrix
+MultiFormatWriter::encode(const std::wstring& contents, int width, int height) const
+{
+	return visitWriter([&](const auto& writer) { return writer.encode(contents, width, height); });
+}
+
 BitMatrix MultiFormatWriter::encode(const std::string& contents, int width, int height) const
 {
-	return encode(FromUtf8(contents), width, height);
+	// the utf8 string is passed on as is, the 2D writers encode it without a conversion to a wide string
+	return visitWriter([&](const auto& writer) { return writer.encode(contents, width, height); });
+}
+
+static int DefaultQuietZone(BarcodeFormat format)
+{
+	switch (format) {
+	case BarcodeFormat::Aztec: return 0;
+	case BarcodeFormat::DataMatrix: return 1;
+	case BarcodeFormat::PDF417: return 2;
+	case BarcodeFormat::QRCode: return 4;
+	default: return 10; // linear symbologies
+	}
+}
+
+ModuleMatrix MultiFormatWriter::encodeModules(const std::wstring& contents) const
+{
+	// without margin and with a requested size of 0 the writers return one pixel per module
+	return {MultiFormatWriter(*this).setMargin(0).encode(contents, 0, 0), _margin >= 0 ? _margin : DefaultQuietZone(_format)};
+}
+
+ModuleMatrix MultiFormatWriter::encodeModules(const std::string& contents) const
+{
+	return {MultiFormatWriter(*this).setMargin(0).encode(contents, 0, 0), _margin >= 0 ? _margin : DefaultQuietZone(_format)};
+}
+
+template <typename STR>
+static BitArray EncodeRow(const MultiFormatWriter& writer, BarcodeFormat format, const STR& contents)
+{
+	if (!BarcodeFormats(BarcodeFormat::LinearCodes).testFlag(format))
+		throw std::invalid_argument(std::string("Not a linear format: ") + ToString(format));
+
+	// the linear writers render a single row of one pixel per module if no height is requested
+	auto modules = writer.encodeModules(contents).modules;
+	BitArray res(modules.width());
+	for (int x = 0; x < modules.width(); ++x)
+		if (modules.get(x, 0))
+			res.set(x, true);
+	return res;
+}
+
+static std::vector<int> ToBars(const BitArray& row)
+{
+	std::vector<int> res;
+	int x = 0;
+	while (x < row.size() && !row.get(x)) // the writers do not add a margin, this is just to be safe
+		++x;
+	while (x < row.size()) {
+		bool color = row.get(x);
+		int start = x;
+		while (x < row.size() && row.get(x) == color)
+			++x;
+		if (x < row.size() || color)
+			res.push_back(x - start);
+	}
+	return res;
+}
+
+BitArray MultiFormatWriter::encodeRow(const std::wstring& contents) const
+{
+	return EncodeRow(*this, _format, contents);
+}
+
+BitArray MultiFormatWriter::encodeRow(const std::string& contents) const
+{
+	return EncodeRow(*this, _format, contents);
+}
+
+std::vector<int> MultiFormatWriter::encodeBars(const std::wstring& contents) const
+{
+	return ToBars(encodeRow(contents));
+}
+
+std::vector<int> MultiFormatWriter::encodeBars(const std::string& contents) const
+{
+	return ToBars(encodeRow(contents));
+}
+
+void MultiFormatWriter::encodeBatch(const std::vector<std::string>& contents, int width, int height,
+									std::vector<BitMatrix>& res, Executor* executor) const
+{
+	res.resize(contents.size());
+
+	// the writers are stateless during encode(), so a single one can be shared by all tasks
+	visitWriter([&](const auto& writer) {
+		if (!executor || executor->concurrency() < 2 || Size(contents) < 2) {
+			for (size_t i = 0; i < contents.size(); ++i)
+				res[i] = writer.encode(contents[i], width, height);
+			return;
+		}
+
+		// hand out chunks of consecutive symbols to amortize the task overhead of large batches
+		const int numChunks = std::min(Size(contents), 4 * executor->concurrency());
+		std::mutex mutex;
+		std::exception_ptr exception;
+
+		executor->parallelFor(numChunks, [&](int chunk) {
+			try {
+				for (int i = Size(contents) * chunk / numChunks; i < Size(contents) * (chunk + 1) / numChunks; ++i)
+					res[i] = writer.encode(contents[i], width, height);
+			} catch (...) {
+				std::lock_guard lock(mutex);
+				if (!exception)
+					exception = std::current_exception();
+			}
+		});
+
+		if (exception)
+			std::rethrow_exception(exception);
+	});
 }
 
 } // ZXing
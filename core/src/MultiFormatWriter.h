@@ -6,13 +6,25 @@
 #pragma once
 
 #include "BarcodeFormat.h"
+#include "BitArray.h"
+#include "BitMatrix.h"
 #include "CharacterSet.h"
 
 #include <string>
+#include <vector>
 
 namespace ZXing {
 
-class BitMatrix;
+class Executor;
+
+/**
+* The symbol of a barcode with one bit per module, see MultiFormatWriter::encodeModules()
+*/
+struct ModuleMatrix
+{
+	BitMatrix modules; // without quiet zone, linear barcodes have a single row
+	int quietZone = 0; // the minimum quiet zone in modules required on each side (only left and right for linear ones)
+};
 
 /**
 * This class is here just for convenience as it offers single-point service
@@ -52,7 +64,43 @@ public:
 	BitMatrix encode(const std::wstring& contents, int width, int height) const;
 	BitMatrix encode(const std::string& contents, int width, int height) const;
 
+	/**
+	* Encodes the contents without scaling it to pixels. The result can be rendered at any resolution, e.g. scanline by
+	* scanline with a ScanlineRasterizer, without allocating the full resolution image. The quiet zone is the one set
+	* with setMargin() or else the recommended one of the symbology. PDF417 rows are 4 modules high.
+	*/
+	ModuleMatrix encodeModules(const std::wstring& contents) const;
+	ModuleMatrix encodeModules(const std::string& contents) const;
+
+	/**
+	* Encodes a linear barcode into a single row of modules without quiet zone, e.g. to feed a thermal printer line by
+	* line. The memory needed is proportional to the width of the symbol only. Throws for matrix formats.
+	*/
+	BitArray encodeRow(const std::wstring& contents) const;
+	BitArray encodeRow(const std::string& contents) const;
+
+	/**
+	* Encodes a linear barcode into the widths (in modules) of its alternating bars and spaces, starting and ending
+	* with a bar, as expected by printer languages with native barcode commands. Throws for matrix formats.
+	*/
+	std::vector<int> encodeBars(const std::wstring& contents) const;
+	std::vector<int> encodeBars(const std::string& contents) const;
+
+	/**
+	* Encodes each of the contents with the same settings, res[i] being the symbol for contents[i].
+	*
+	* The format writer is set up once for the whole batch and the encoders keep their generator tables and scratch
+	* buffers per thread, so the per symbol overhead is only the encoding itself. res is resized to contents.size(),
+	* which lets a caller reuse the same vector for consecutive batches. If an executor is passed, the symbols are
+	* encoded concurrently. If any content can not be encoded, the first exception is rethrown after all tasks finished.
+	*/
+	void encodeBatch(const std::vector<std::string>& contents, int width, int height, std::vector<BitMatrix>& res,
+					 Executor* executor = nullptr) const;
+
 private:
+	template <typename FUNC>
+	auto visitWriter(FUNC func) const;
+
 	BarcodeFormat _format;
 	CharacterSet _encoding = CharacterSet::Unknown;
 	int _margin = -1;
@@ -8,6 +8,7 @@
 #include "BitHacks.h"
 #include "Range.h"
 #include "ZXAlgorithms.h"
+#include "ZXConfig.h"
 
 #include <algorithm>
 #include <array>
@@ -18,6 +19,12 @@
 #include <numeric>
 #include <vector>
 
+#if defined(ZX_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace ZXing {
 
 using PatternType = uint16_t;
@@ -323,8 +330,76 @@ std::array<int, LEN> NormalizedPattern(const PatternView& view)
 	return is;
 }
 
-template<typename I>
-void GetPatternRow(Range<I> b_row, PatternRow& p_row)
+/**
+ * @brief ThresholdPatternRow run-length encodes the n pixels p[0], p[stride] ... p[(n - 1) * stride] into p_row, a pixel
+ * being black if (value <= threshold) != invert. See GetPatternRow for the format of p_row, which can be any vector-like
+ * container of PatternType (e.g. a std::pmr::vector).
+ *
+ * For stride 1 the pixels are classified 16 at a time, the transitions between adjacent pixels are collected in a bit mask
+ * and each run is written with one count trailing zeros, i.e. the cost is per run and per 16 pixels, not per pixel. If
+ * the padding bytes p[n], p[n + 1] ... p[n + padding - 1] may be read and are white (like the row padding of a BitMatrix),
+ * the last partial 16 pixels are classified the same way instead of one by one.
+ */
+template <typename ROW>
+void ThresholdPatternRow(const uint8_t* p, int n, int stride, uint8_t threshold, bool invert, ROW& p_row, int padding = 0)
+{
+	p_row.resize(n + 2);
+	PatternType* out = p_row.data();
+	int runStart = 0;
+	int black = 0; // color of the current run, the first one is white (potentially of length 0)
+	auto endRun = [&](int i) {
+		*out++ = static_cast<PatternType>(i - runStart);
+		runStart = i;
+	};
+
+	int i = 0;
+	// a trailing white run of the padding does not add a transition behind p[n - 1]
+	[[maybe_unused]] const int simdEnd = n + padding >= ((n + 15) & ~15) ? (n + 15) & ~15 : n;
+#if defined(ZX_USE_SSE2)
+	if (stride == 1) {
+		const __m128i thr = _mm_set1_epi8(static_cast<char>(threshold));
+		const int flip = invert ? 0xFFFF : 0;
+		for (; i + 16 <= simdEnd; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+			// bit j is set if pixel i + j is black, min(v, thr) == v <=> v <= thr
+			const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, thr), v)) ^ flip;
+			// bit j is set if pixel i + j has a different color than its predecessor
+			for (int diff = (mask ^ ((mask << 1) | black)) & 0xFFFF; diff; diff &= diff - 1)
+				endRun(i + BitHacks::NumberOfTrailingZeros(diff));
+			black = mask >> 15;
+		}
+	}
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+	if (stride == 1) {
+		const uint8x16_t thr = vdupq_n_u8(threshold);
+		const uint64_t flip = invert ? ~uint64_t(0) : 0;
+		for (; i + 16 <= simdEnd; i += 16) {
+			// there is no movemask on NEON, narrowing the comparison result gives a nibble per pixel, keep its top bit
+			const uint8x16_t le = vcleq_u8(vld1q_u8(p + i), thr);
+			const uint64_t mask = (vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(le), 4)), 0) ^ flip)
+								  & 0x8888888888888888ull;
+			for (uint64_t diff = mask ^ ((mask << 4) | (black << 3)); diff; diff &= diff - 1)
+				endRun(i + BitHacks::NumberOfTrailingZeros(diff) / 4);
+			black = static_cast<int>(mask >> 63);
+		}
+	}
+#endif
+	for (const uint8_t* q = p + i * stride; i < n; ++i, q += stride)
+		if (((*q <= threshold) != invert) != bool(black)) {
+			endRun(i);
+			black = !black;
+		}
+	endRun(n);
+
+	if (black)
+		*out++ = 0; // last value is number of white pixels, here 0
+
+	p_row.resize(out - p_row.data());
+}
+
+// padding: number of readable unset bytes behind b_row (e.g. BitMatrix::rowPitch() - width()), see ThresholdPatternRow
+template<typename I, typename ROW>
+void GetPatternRow(Range<I> b_row, ROW& p_row, [[maybe_unused]] int padding = 0)
 {
 	// TODO: if reactivating the bit-packed array (!ZX_FAST_BIT_STORAGE) should be of interest then the following code could be
 	// considerably speed up by using a specialized variant along the lines of the old BitArray::getNextSetTo() function that
@@ -347,6 +422,12 @@ void GetPatternRow(Range<I> b_row, PatternRow& p_row)
 	if (*lastPos)
 		p_row.push_back(0); // last value is number of white pixels, here 0
 #else
+	if constexpr (std::is_pointer_v<I> && sizeof(std::remove_pointer_t<I>) == 1) {
+		// a pixel is black if it is not 0
+		ThresholdPatternRow(reinterpret_cast<const uint8_t*>(b_row.begin()), Size(b_row), 1, 0, true, p_row, padding);
+		return;
+	}
+
 	p_row.resize(b_row.size() + 2);
 	std::fill(p_row.begin(), p_row.end(), 0);
 
@@ -357,29 +438,6 @@ void GetPatternRow(Range<I> b_row, PatternRow& p_row)
 	if (*bitPos)
 		intPos++; // first value is number of white pixels, here 0
 
-	// The following code as been observed to cause a speedup of up to 30% on large images on an AVX cpu
-	// and on an a Google Pixel 3 Android phone. Your mileage may vary.
-	if constexpr (std::is_pointer_v<I> && sizeof(I) == 8 && sizeof(std::remove_pointer_t<I>) == 1) {
-		using simd_t = uint64_t;
-		while (bitPos < bitPosEnd - sizeof(simd_t)) {
-			auto asSimd0 = BitHacks::LoadU<simd_t>(bitPos);
-			auto asSimd1 = BitHacks::LoadU<simd_t>(bitPos + 1);
-			auto z = asSimd0 ^ asSimd1;
-			if (z) {
-#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-				int step = BitHacks::NumberOfTrailingZeros(z) / 8 + 1;
-#else
-				int step = BitHacks::NumberOfLeadingZeros(z) / 8 + 1;
-#endif
-				(*intPos++) += step;
-				bitPos += step;
-			} else {
-				(*intPos) += sizeof(simd_t);
-				bitPos += sizeof(simd_t);
-			}
-		}
-	}
-
 	while (++bitPos != bitPosEnd) {
 		++(*intPos);
 		intPos += bitPos[0] != bitPos[-1];
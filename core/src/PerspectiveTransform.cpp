@@ -72,10 +72,4 @@ PerspectiveTransform::PerspectiveTransform(const QuadrilateralF& src, const Quad
 	*this = UnitSquareTo(dst).times(UnitSquareTo(src).inverse());
 }
 
-PointF PerspectiveTransform::operator()(PointF p) const
-{
-	auto denominator = a13 * p.x + a23 * p.y + a33;
-	return {(a11 * p.x + a21 * p.y + a31) / denominator, (a12 * p.x + a22 * p.y + a32) / denominator};
-}
-
 } // ZXing
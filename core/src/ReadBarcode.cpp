@@ -5,187 +5,1691 @@
 
 #include "ReadBarcode.h"
 
+#include "AdaptiveBinarizer.h"
+#include "ArenaResource.h"
+#include "BinarizerBackend.h"
+#include "BitMatrix.h"
 #include "DecodeHints.h"
+#include "DecoderResult.h"
+#include "Executor.h"
+#include "FrameQuality.h"
 #include "GlobalHistogramBinarizer.h"
 #include "HybridBinarizer.h"
 #include "MultiFormatReader.h"
 #include "Pattern.h"
+#include "ResultIndex.h"
+#include "Scope.h"
+#include "StatsScope.h"
 #include "ThresholdBinarizer.h"
+#include "TraceScope.h"
+#include "ZXAlgorithms.h"
+#include "ZXConfig.h"
+#ifdef ZXING_READER_AZTEC
+#include "aztec/AZDecoder.h"
+#include "aztec/AZDetector.h"
+#include "aztec/AZDetectorResult.h"
+#endif
+#ifdef ZXING_READER_DATAMATRIX
+#include "datamatrix/DMDecoder.h"
+#endif
+#ifdef ZXING_READER_CODABAR
+#include "oned/ODCodabarReader.h"
+#endif
+#ifdef ZXING_READER_CODE128
+#include "oned/ODCode128Reader.h"
+#endif
+#ifdef ZXING_READER_CODE39
+#include "oned/ODCode39Reader.h"
+#endif
+#ifdef ZXING_READER_CODE93
+#include "oned/ODCode93Reader.h"
+#endif
+#ifdef ZXING_READER_ITF
+#include "oned/ODITFReader.h"
+#endif
+#ifdef ZXING_READER_UPCEAN
+#include "oned/ODMultiUPCEANReader.h"
+#endif
+#ifdef ZXING_READER_ONED
+#include "oned/ODRowReader.h"
+#endif
+#ifdef ZXING_READER_PDF417
+#include "pdf417/PDFScanningDecoder.h"
+#endif
+#ifdef ZXING_READER_QRCODE
+#include "qrcode/QRDecoder.h"
+#include "qrcode/QRReader.h"
+#endif
 
+#include <algorithm>
+#include <atomic>
 #include <climits>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(ZX_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(ZX_USE_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace ZXing {
 
 class LumImage : public ImageView
 {
-	std::unique_ptr<uint8_t[]> _memory;
-	LumImage(std::unique_ptr<uint8_t[]>&& data, int w, int h)
-		: ImageView(data.get(), w, h, ImageFormat::Lum), _memory(std::move(data))
-	{}
+	std::vector<uint8_t> _memory;
 
 public:
 	LumImage() : ImageView(nullptr, 0, 0, ImageFormat::Lum) {}
-	LumImage(int w, int h) : LumImage(std::make_unique<uint8_t[]>(w * h), w, h) {}
+	LumImage(int w, int h) : LumImage() { resize(w, h); }
+
+	LumImage(LumImage&&) noexcept = default;
+	LumImage& operator=(LumImage&&) noexcept = default;
 
-	uint8_t* data() { return _memory.get(); }
+	// (re)use the existing memory if it is large enough, otherwise grow it
+	void resize(int w, int h)
+	{
+		_memory.resize(w * h);
+		static_cast<ImageView&>(*this) = ImageView(_memory.data(), w, h, ImageFormat::Lum);
+	}
+
+	uint8_t* data() { return _memory.data(); }
 };
 
 template<typename P>
-static LumImage ExtractLum(const ImageView& iv, P projection)
+static void ExtractLum(const ImageView& iv, LumImage& res, P projection)
 {
-	LumImage res(iv.width(), iv.height());
+	res.resize(iv.width(), iv.height());
 
 	auto* dst = res.data();
 	for(int y = 0; y < iv.height(); ++y)
 		for(int x = 0, w = iv.width(); x < w; ++x)
 			*dst++ = projection(iv.data(x, y));
+}
 
-	return res;
+/**
+ * Converts one row of RGB pixels of the format F (densely packed) into luminance values using RGBToLum().
+ * Returns the number of pixels converted, the remaining ones (up to width) are left to the caller.
+ */
+template<ImageFormat F>
+static int RGBRowToLumSIMD([[maybe_unused]] const uint8_t* src, [[maybe_unused]] uint8_t* dst, [[maybe_unused]] int width)
+{
+	constexpr int R = RedIndex(F), G = GreenIndex(F), B = BlueIndex(F);
+	int x = 0;
+#if defined(ZX_USE_SSE2)
+	if constexpr (PixStride(F) == 4) {
+		// split each pixel into the 16bit lanes (c0, c2) and (c1, c3) and let madd compute the weighted sum
+		constexpr auto W = [](int i) { return i == R ? 306 : i == G ? 601 : i == B ? 117 : 0; };
+		const __m128i lo = _mm_set1_epi16(0x00ff);
+		const __m128i w02 = _mm_set1_epi32((W(2) << 16) | W(0));
+		const __m128i w13 = _mm_set1_epi32((W(3) << 16) | W(1));
+		const __m128i round = _mm_set1_epi32(0x200);
+		auto Lum4 = [&](const uint8_t* p) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			__m128i sum = _mm_add_epi32(_mm_madd_epi16(_mm_and_si128(v, lo), w02), _mm_madd_epi16(_mm_srli_epi16(v, 8), w13));
+			return _mm_srli_epi32(_mm_add_epi32(sum, round), 10);
+		};
+		for (; x + 16 <= width; x += 16) {
+			const uint8_t* p = src + 4 * x;
+			__m128i a = _mm_packs_epi32(Lum4(p), Lum4(p + 16));
+			__m128i b = _mm_packs_epi32(Lum4(p + 32), Lum4(p + 48));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a, b));
+		}
+	}
+	// 3 byte formats: there is no cheap way to de-interleave triplets with SSE2, the scalar code is used
+#elif defined(ZX_USE_NEON)
+	for (; x + 8 <= width; x += 8) {
+		uint16x8_t r, g, b;
+		if constexpr (PixStride(F) == 3) {
+			uint8x8x3_t v = vld3_u8(src + 3 * x);
+			r = vmovl_u8(v.val[R]), g = vmovl_u8(v.val[G]), b = vmovl_u8(v.val[B]);
+		} else {
+			uint8x8x4_t v = vld4_u8(src + 4 * x);
+			r = vmovl_u8(v.val[R]), g = vmovl_u8(v.val[G]), b = vmovl_u8(v.val[B]);
+		}
+		auto Lum4 = [](uint16x4_t r, uint16x4_t g, uint16x4_t b) {
+			uint32x4_t sum = vmlal_n_u16(vmlal_n_u16(vmull_n_u16(r, 306), g, 601), b, 117);
+			return vrshrn_n_u32(sum, 10); // adds the 0x200 rounding term of RGBToLum
+		};
+		uint16x4_t l = Lum4(vget_low_u16(r), vget_low_u16(g), vget_low_u16(b));
+		uint16x4_t h = Lum4(vget_high_u16(r), vget_high_u16(g), vget_high_u16(b));
+		vst1_u8(dst + x, vmovn_u16(vcombine_u16(l, h)));
+	}
+#endif
+	return x;
 }
 
+template<ImageFormat F>
+static void ExtractLumRGB(const ImageView& iv, LumImage& res)
+{
+	constexpr int R = RedIndex(F), G = GreenIndex(F), B = BlueIndex(F), PS = PixStride(F);
+
+	if (iv.pixStride() != PS)
+		return ExtractLum(iv, res, [](const uint8_t* src) { return RGBToLum(src[R], src[G], src[B]); });
+
+	res.resize(iv.width(), iv.height());
+	auto* dst = res.data();
+	for (int y = 0, w = iv.width(); y < iv.height(); ++y, dst += w) {
+		const uint8_t* src = iv.data(0, y);
+		for (int x = RGBRowToLumSIMD<F>(src, dst, w); x < w; ++x)
+			dst[x] = RGBToLum(src[x * PS + R], src[x * PS + G], src[x * PS + B]);
+	}
+}
+
+static void ExtractLumRGB(const ImageView& iv, LumImage& res)
+{
+	// dispatch to a specialization with compile time channel indices and pixel stride
+	switch (iv.format()) {
+	case ImageFormat::RGB: return ExtractLumRGB<ImageFormat::RGB>(iv, res);
+	case ImageFormat::BGR: return ExtractLumRGB<ImageFormat::BGR>(iv, res);
+	case ImageFormat::RGBX: return ExtractLumRGB<ImageFormat::RGBX>(iv, res);
+	case ImageFormat::XRGB: return ExtractLumRGB<ImageFormat::XRGB>(iv, res);
+	case ImageFormat::BGRX: return ExtractLumRGB<ImageFormat::BGRX>(iv, res);
+	case ImageFormat::XBGR: return ExtractLumRGB<ImageFormat::XBGR>(iv, res);
+	default:
+		ExtractLum(iv, res, [r = RedIndex(iv.format()), g = GreenIndex(iv.format()), b = BlueIndex(iv.format())](
+								const uint8_t* src) { return RGBToLum(src[r], src[g], src[b]); });
+	}
+}
+
+/**
+ * Computes one row of the N x N box filtered (rounded average) image from the N source rows.
+ * Returns the number of pixels written to dst, the remaining ones (up to width) are left to the caller.
+ */
+template<int N>
+static int DownscaleRowSIMD([[maybe_unused]] const uint8_t* const* src, [[maybe_unused]] uint8_t* dst, [[maybe_unused]] int width)
+{
+	int x = 0;
+#if defined(ZX_USE_SSE2)
+	if constexpr (N == 2) {
+		// 16 source bytes per row -> 8 pairwise sums in 16bit lanes
+		const __m128i lo = _mm_set1_epi16(0x00ff);
+		auto PairSums = [&](const uint8_t* p) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			return _mm_add_epi16(_mm_and_si128(v, lo), _mm_srli_epi16(v, 8));
+		};
+		const __m128i round = _mm_set1_epi16(2);
+		for (; x + 16 <= width; x += 16) {
+			__m128i a = _mm_add_epi16(_mm_add_epi16(PairSums(src[0] + 2 * x), PairSums(src[1] + 2 * x)), round);
+			__m128i b = _mm_add_epi16(_mm_add_epi16(PairSums(src[0] + 2 * x + 16), PairSums(src[1] + 2 * x + 16)), round);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(_mm_srli_epi16(a, 2), _mm_srli_epi16(b, 2)));
+		}
+	} else if constexpr (N == 4) {
+		// 16 source bytes per row -> 4 sums of 4 adjacent pixels in 32bit lanes
+		const __m128i lo = _mm_set1_epi16(0x00ff);
+		const __m128i ones = _mm_set1_epi16(1);
+		auto QuadSums = [&](const uint8_t* p) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			return _mm_madd_epi16(_mm_add_epi16(_mm_and_si128(v, lo), _mm_srli_epi16(v, 8)), ones);
+		};
+		const __m128i round = _mm_set1_epi32(8);
+		for (; x + 8 <= width; x += 8) {
+			__m128i s[2];
+			for (int i = 0; i < 2; ++i) {
+				s[i] = round;
+				for (int r = 0; r < 4; ++r)
+					s[i] = _mm_add_epi32(s[i], QuadSums(src[r] + 4 * x + 16 * i));
+				s[i] = _mm_srli_epi32(s[i], 4);
+			}
+			__m128i res = _mm_packs_epi32(s[0], s[1]);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(res, res));
+		}
+	}
+	// N == 3: there is no cheap way to de-interleave triplets with SSE2, the scalar code below is used
+#elif defined(ZX_USE_NEON)
+	for (; x + 8 <= width; x += 8) {
+		uint16x8_t sum = vdupq_n_u16((N * N) / 2);
+		for (int r = 0; r < N; ++r) {
+			if constexpr (N == 2) {
+				uint8x8x2_t v = vld2_u8(src[r] + N * x);
+				sum = vaddq_u16(sum, vaddl_u8(v.val[0], v.val[1]));
+			} else if constexpr (N == 3) {
+				uint8x8x3_t v = vld3_u8(src[r] + N * x);
+				sum = vaddw_u8(vaddq_u16(sum, vaddl_u8(v.val[0], v.val[1])), v.val[2]);
+			} else {
+				uint8x8x4_t v = vld4_u8(src[r] + N * x);
+				sum = vaddq_u16(sum, vaddq_u16(vaddl_u8(v.val[0], v.val[1]), vaddl_u8(v.val[2], v.val[3])));
+			}
+		}
+		if constexpr (N == 3) {
+			// sum / 9 == (sum * 7282) >> 16 for all sum <= 9 * 255 + 4
+			uint32x4_t l = vmull_n_u16(vget_low_u16(sum), 7282);
+			uint32x4_t h = vmull_n_u16(vget_high_u16(sum), 7282);
+			vst1_u8(dst + x, vmovn_u16(vcombine_u16(vshrn_n_u32(l, 16), vshrn_n_u32(h, 16))));
+		} else {
+			vst1_u8(dst + x, vmovn_u16(vshrq_n_u16(sum, N == 2 ? 2 : 4)));
+		}
+	}
+#endif
+	return x;
+}
+
+/**
+ * The layers of the pyramid are computed lazily, i.e. only once they are accessed for the first time. In the common
+ * case where the first (full resolution) layer already contains all the symbols we are looking for, the lower
+ * resolution layers are never computed. The layer() accessor is thread-safe. Alternatively, the downscaled layers can be
+ * provided by the caller (e.g. from the hardware scaler of a camera), then nothing is computed and the scale factors
+ * are the size ratios of the layers, which need not be integral. Given the expected module size, a single downscaled
+ * layer of a non-integral factor can be built instead of a chain of layers (see initScaled()).
+ */
 class LumImagePyramid
 {
 	std::vector<LumImage> buffers;
+	std::vector<ImageView> layers; // sized in init(), the views of unbuilt layers are placeholders
+	// the HybridBinarizer block statistics and black points of the downscaled layers (empty if not computed), see
+	// layerBlackPoints()
+	std::vector<Matrix<HybridBinarizer::BlockStatistics>> blockStats;
+	std::vector<Matrix<int>> blackPoints;
+	std::vector<int> columnSums; // the buffer of buildScaledLayer()
+	int builtLayers = 0;
+	int factor = 0; // 0 for the single layer of initScaled()
+	bool provided = false;
+	bool withBlackPoints = false;
+	bool deriveBlackPoints = false;
+	std::mutex mutex;
 
 	template<int N>
-	void addLayer()
+	void buildLayer(int i)
 	{
-		auto siv = layers.back();
-		buffers.emplace_back(siv.width() / N, siv.height() / N);
-		layers.push_back(buffers.back());
-		auto& div = buffers.back();
+		auto siv = layers[i - 1];
+		auto& div = buffers[i - 1];
+		div.resize(siv.width() / N, siv.height() / N);
+		layers[i] = div;
 		auto* d   = div.data();
 
-		for (int dy = 0; dy < div.height(); ++dy)
-			for (int dx = 0; dx < div.width(); ++dx) {
+		// The block statistics of a block row are computed as soon as its last pixel row is written, i.e. while the rows
+		// are still in the cache. This saves the HybridBinarizer from reading the whole layer once more. With
+		// deriveBlackPoints, they are derived from the statistics of the previous downscaled layer (if any) instead.
+		constexpr int BS = HybridBinarizer::BlockSize;
+		const bool withBP = withBlackPoints && div.width() >= 5 * BS && div.height() >= 5 * BS;
+		const auto* parentStats = i > 1 && deriveBlackPoints && blockStats[i - 2].size() ? &blockStats[i - 2] : nullptr;
+		auto& stats = blockStats[i - 1];
+		stats = withBP ? Matrix<HybridBinarizer::BlockStatistics>((div.width() + BS - 1) / BS, (div.height() + BS - 1) / BS)
+					   : Matrix<HybridBinarizer::BlockStatistics>();
+		int nextBlockRow = parentStats ? stats.height() : 0;
+
+		// working on plain row pointers lets the compiler (and the SIMD code) specialize for a pixStride of 1
+		const int ps = siv.pixStride();
+		for (int dy = 0; dy < div.height(); ++dy, d += div.width()) {
+			const uint8_t* src[N];
+			for (int ty = 0; ty < N; ++ty)
+				src[ty] = siv.data(0, dy * N + ty);
+			for (int dx = ps == 1 ? DownscaleRowSIMD<N>(src, d, div.width()) : 0; dx < div.width(); ++dx) {
 				int sum = (N * N) / 2;
 				for (int ty = 0; ty < N; ++ty)
 					for (int tx = 0; tx < N; ++tx)
-						sum += *siv.data(dx * N + tx, dy * N + ty);
-				*d++ = sum / (N * N);
+						sum += src[ty][(dx * N + tx) * ps];
+				d[dx] = sum / (N * N);
+			}
+			for (; withBP && nextBlockRow < stats.height() && std::min(nextBlockRow * BS, div.height() - BS) + BS == dy + 1; ++nextBlockRow)
+				HybridBinarizer::CalculateBlockStatistics(div, nextBlockRow, nextBlockRow + 1, stats);
+		}
+		if (withBP && parentStats)
+			HybridBinarizer::DeriveBlockStatistics(div, *parentStats, siv.width(), siv.height(), N, stats);
+		blackPoints[i - 1] = withBP ? HybridBinarizer::BlackPoints(stats) : Matrix<int>();
+	}
+
+	// Each destination pixel is the average of the source pixels of the (integral) column and row ranges it covers, for
+	// scale factors of at least MIN_FRACTIONAL_SCALE, these ranges are never empty.
+	void buildScaledLayer(int i)
+	{
+		auto siv = layers[i - 1];
+		auto& div = buffers[i - 1];
+		div.resize(layers[i].width(), layers[i].height());
+		layers[i] = div;
+
+		const int sw = siv.width(), sh = siv.height(), dw = div.width(), dh = div.height(), ps = siv.pixStride();
+		auto start = [](int i, int src, int dst) { return static_cast<int>(int64_t(i) * src / dst); };
+		columnSums.resize(sw);
+		auto* d = div.data();
+		for (int dy = 0; dy < dh; ++dy, d += dw) {
+			const int y0 = start(dy, sh, dh), y1 = start(dy + 1, sh, dh);
+			std::fill(columnSums.begin(), columnSums.end(), 0);
+			for (int y = y0; y < y1; ++y) {
+				const uint8_t* src = siv.data(0, y);
+				for (int x = 0; x < sw; ++x)
+					columnSums[x] += src[x * ps];
+			}
+			for (int dx = 0, x0 = 0; dx < dw; ++dx) {
+				const int x1 = start(dx + 1, sw, dw);
+				const int n = (x1 - x0) * (y1 - y0);
+				int sum = n / 2;
+				for (; x0 < x1; ++x0)
+					sum += columnSums[x0];
+				d[dx] = sum / n;
 			}
+		}
 	}
 
-	void addLayer(int factor)
+	void buildLayer(int i)
 	{
+		ZX_TRACE_SCOPE("LumImagePyramid::buildLayer");
+		StatsScope scope(DecodeStats::Stage::Preprocess);
 		// help the compiler's auto-vectorizer by hard-coding the scale factor
 		switch (factor) {
-		case 2: addLayer<2>(); break;
-		case 3: addLayer<3>(); break;
-		case 4: addLayer<4>(); break;
-		default: throw std::invalid_argument("Invalid DecodeHints::downscaleFactor"); break;
+		case 0: buildScaledLayer(i); break;
+		case 2: buildLayer<2>(i); break;
+		case 3: buildLayer<3>(i); break;
+		case 4: buildLayer<4>(i); break;
 		}
 	}
 
 public:
-	std::vector<ImageView> layers;
+	// a downscaled layer of a smaller factor than this is not worth the time to build and process it
+	static constexpr float MIN_FRACTIONAL_SCALE = 1.5f;
 
-	LumImagePyramid(const ImageView& iv, int threshold, int factor)
+	LumImagePyramid() = default;
+	LumImagePyramid(const ImageView& iv, int threshold, int factor) { init(iv, threshold, factor); }
+
+	// (re)initialize the pyramid for the given image, recycling the layer buffers of the previous call. With
+	// withBlackPoints, the black points of the HybridBinarizer are computed along with the downscaled layers, with
+	// deriveBlackPoints, those of the second and following downscaled layers are approximated from the block statistics
+	// of the previous one (see HybridBinarizer::DeriveBlockStatistics).
+	void init(const ImageView& iv, int threshold, int factor, bool withBlackPoints = false, bool deriveBlackPoints = false)
 	{
+		std::lock_guard lock(mutex);
+		this->factor = factor;
+		this->withBlackPoints = withBlackPoints;
+		this->deriveBlackPoints = deriveBlackPoints;
+		provided = false;
+		layers.clear();
 		layers.push_back(iv);
+		builtLayers = 1;
 		// TODO: if only matrix codes were considered, then using std::min would be sufficient (see #425)
-		while (threshold > 0 && std::max(layers.back().width(), layers.back().height()) > threshold &&
-			   std::min(layers.back().width(), layers.back().height()) >= factor)
-			addLayer(factor);
-#if 0
-		// Reversing the layers means we'd start with the smallest. that can make sense if we are only looking for a
-		// single symbol. If we start with the higher resolution, we get better (high res) position information.
-		// TODO: see if masking out higher res layers based on found symbols in lower res helps overall performance.
-		std::reverse(layers.begin(), layers.end());
-#endif
+		for (int w = iv.width(), h = iv.height(); threshold > 0 && std::max(w, h) > threshold && std::min(w, h) >= factor;
+			 w /= factor, h /= factor) {
+			if (factor < 2 || factor > 4)
+				throw std::invalid_argument("Invalid DecodeHints::downscaleFactor");
+			layers.emplace_back(nullptr, w / factor, h / factor, ImageFormat::Lum);
+		}
+		if (Size(buffers) < Size(layers) - 1) {
+			buffers.resize(layers.size() - 1);
+			blockStats.resize(layers.size() - 1);
+			blackPoints.resize(layers.size() - 1);
+		}
+	}
+
+	// (re)initialize the pyramid for the given image with a single downscaled layer of (about) the given scale factor, which
+	// need not be integral, if it is at least MIN_FRACTIONAL_SCALE. The actual factor (see scale()) is never larger.
+	void initScaled(const ImageView& iv, float scale)
+	{
+		std::lock_guard lock(mutex);
+		factor = 0;
+		withBlackPoints = deriveBlackPoints = provided = false;
+		layers.clear();
+		layers.push_back(iv);
+		builtLayers = 1;
+		if (scale >= MIN_FRACTIONAL_SCALE)
+			layers.emplace_back(nullptr, static_cast<int>(std::ceil(iv.width() / scale)), static_cast<int>(std::ceil(iv.height() / scale)),
+								ImageFormat::Lum);
+		if (Size(buffers) < Size(layers) - 1) {
+			buffers.resize(layers.size() - 1);
+			blockStats.resize(layers.size() - 1);
+			blackPoints.resize(layers.size() - 1);
+		}
+	}
+
+	// initialize the pyramid with the given layers, the first one being the full resolution image
+	void init(std::vector<ImageView> layers)
+	{
+		std::lock_guard lock(mutex);
+		this->layers = std::move(layers);
+		builtLayers = Size(this->layers);
+		provided = true;
+	}
+
+	int size() const { return Size(layers); }
+
+	// the factors to scale coordinates in layer i by to get the ones in the full resolution image
+	PointF scale(int i) const
+	{
+		if (provided || !factor)
+			return {double(layers[0].width()) / layers[i].width(), double(layers[0].height()) / layers[i].height()};
+		int s = 1;
+		while (i--)
+			s *= factor;
+		return {double(s), double(s)};
+	}
+
+	ImageView layer(int i)
+	{
+		std::lock_guard lock(mutex);
+		for (; builtLayers <= i; ++builtLayers)
+			buildLayer(builtLayers);
+		return layers[i];
+	}
+
+	// the black points of the built layer i for the HybridBinarizer, if they were computed along with it
+	const Matrix<int>* layerBlackPoints(int i) const
+	{
+		return i > 0 && !provided && withBlackPoints && blackPoints[i - 1].size() ? &blackPoints[i - 1] : nullptr;
 	}
 };
 
+#ifdef ZXING_BUILD_FOR_TEST
+// Entry points into the otherwise internal preprocessing stages for the benchmarks (see test/benchmark). Both reuse
+// their buffers like the real pipeline does and return a value depending on the result, so the work can't be
+// optimized away.
+
+int BenchmarkExtractLum(const ImageView& iv)
+{
+	thread_local LumImage lum;
+	ExtractLumRGB(iv, lum);
+	return lum.data()[lum.width() * lum.height() / 2];
+}
+
+int BenchmarkLumImagePyramid(const ImageView& iv, int threshold, int factor)
+{
+	thread_local LumImagePyramid pyramid;
+	pyramid.init(iv, threshold, factor);
+	int res = 0;
+	for (int i = 1; i < pyramid.size(); ++i)
+		res += *pyramid.layer(i).data(0, 0);
+	return res;
+}
+
+// The downscaled layers binarized with the HybridBinarizer, with the black points computed along with the layers (fused),
+// derived from the previous layer (derived) or by the binarizer
+int BenchmarkBinarizedLumImagePyramid(const ImageView& iv, int threshold, int factor, bool fused, bool derived)
+{
+	thread_local LumImagePyramid pyramid;
+	pyramid.init(iv, threshold, factor, fused || derived, derived);
+	int res = 0;
+	for (int i = 1; i < pyramid.size(); ++i)
+		res += HybridBinarizer(pyramid.layer(i), nullptr, false, pyramid.layerBlackPoints(i)).getBlackMatrix()->get(0, 0);
+	return res;
+}
+#endif // ZXING_BUILD_FOR_TEST
+
 ImageView SetupLumImageView(ImageView iv, LumImage& lum, const DecodeHints& hints)
 {
 	if (iv.format() == ImageFormat::None)
 		throw std::invalid_argument("Invalid image format");
 
-	if (hints.binarizer() == Binarizer::GlobalHistogram || hints.binarizer() == Binarizer::LocalAverage) {
-		if (iv.format() != ImageFormat::Lum) {
-			lum = ExtractLum(iv, [r = RedIndex(iv.format()), g = GreenIndex(iv.format()), b = BlueIndex(iv.format())](
-									 const uint8_t* src) { return RGBToLum(src[r], src[g], src[b]); });
-		} else if (iv.pixStride() != 1) {
-			// GlobalHistogram and LocalAverage need dense line memory layout
-			lum = ExtractLum(iv, [](const uint8_t* src) { return *src; });
-		}
-		if (lum.data())
-			return lum;
+	// GlobalHistogram, LocalAverage and Adaptive need luminance data but can work on strided Lum data (e.g. YUYV) directly
+	if ((hints.binarizer() == Binarizer::GlobalHistogram || hints.binarizer() == Binarizer::LocalAverage
+		 || hints.binarizer() == Binarizer::Adaptive)
+		&& iv.format() != ImageFormat::Lum) {
+		ZX_TRACE_SCOPE("ExtractLum");
+		StatsScope scope(DecodeStats::Stage::Preprocess);
+		ExtractLumRGB(iv, lum);
+		return lum;
 	}
 	return iv;
 }
 
-std::unique_ptr<BinaryBitmap> CreateBitmap(ZXing::Binarizer binarizer, const ImageView& iv)
+// A HybridBinarizer that leaves the computation of the BitMatrix to a BinarizerBackend (if it does not decline)
+class BackendBinarizer : public HybridBinarizer
+{
+	BinarizerBackend& _backend;
+
+public:
+	BackendBinarizer(const ImageView& iv, BinarizerBackend& backend, bool subPixelEdges)
+		: HybridBinarizer(iv, nullptr, subPixelEdges), _backend(backend)
+	{}
+
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override
+	{
+		ZX_TRACE_SCOPE("BackendBinarizer::getBlackMatrix");
+		auto matrix = std::make_shared<BitMatrix>(width(), height()); // unpadded, see BinarizerBackend::binarize()
+		if (!_backend.binarize(_buffer, matrix->row(0).begin()))
+			return HybridBinarizer::getBlackMatrix();
+		return matrix;
+	}
+};
+
+// scale: the factors of the layer iv is taken from, see LumImagePyramid::scale()
+std::unique_ptr<BinaryBitmap> CreateBitmap(const DecodeHints& hints, const ImageView& iv, Executor* executor = nullptr,
+										   const Matrix<int>* blackPoints = nullptr, PointF scale = {1, 1})
 {
-	switch (binarizer) {
-	case Binarizer::BoolCast: return std::make_unique<ThresholdBinarizer>(iv, 0);
-	case Binarizer::FixedThreshold: return std::make_unique<ThresholdBinarizer>(iv, 127);
-	case Binarizer::GlobalHistogram: return std::make_unique<GlobalHistogramBinarizer>(iv);
-	case Binarizer::LocalAverage: return std::make_unique<HybridBinarizer>(iv);
+	std::unique_ptr<BinaryBitmap> res;
+	switch (hints.binarizer()) {
+	case Binarizer::BoolCast: res = std::make_unique<ThresholdBinarizer>(iv, 0); break;
+	case Binarizer::FixedThreshold: res = std::make_unique<ThresholdBinarizer>(iv, 127); break;
+	case Binarizer::GlobalHistogram: res = std::make_unique<GlobalHistogramBinarizer>(iv, hints.subPixelEdges()); break;
+	case Binarizer::LocalAverage:
+		if (auto backend = hints.binarizerBackend())
+			res = std::make_unique<BackendBinarizer>(iv, *backend, hints.subPixelEdges());
+		else
+			res = std::make_unique<HybridBinarizer>(iv, nullptr, hints.subPixelEdges(), blackPoints);
+		break;
+	case Binarizer::Adaptive: res = std::make_unique<AdaptiveBinarizer>(iv); break;
 	}
-	return {}; // silence gcc warning
+	if (res) {
+		res->setExecutor(executor);
+		res->setModuleSizeRange(hints.minModuleSize() / std::max(scale.x, scale.y), hints.maxModuleSize() / std::min(scale.x, scale.y));
+	}
+	return res;
 }
 
-Result ReadBarcode(const ImageView& _iv, const DecodeHints& hints)
+// The position of a symbol found in a layer of the image pyramid in full resolution coordinates, see LumImagePyramid::scale()
+static QuadrilateralI ScalePosition(const QuadrilateralI& q, PointF scale)
 {
-	return FirstOrDefault(ReadBarcodes(_iv, DecodeHints(hints).setMaxNumberOfSymbols(1)));
+	if (scale.x == scale.y && scale.x == std::floor(scale.x))
+		return Scale(q, static_cast<int>(scale.x));
+	QuadrilateralI res;
+	for (int i = 0; i < 4; ++i)
+		res[i] = {static_cast<int>(std::lround(q[i].x * scale.x)), static_cast<int>(std::lround(q[i].y * scale.y))};
+	return res;
 }
 
-Results ReadBarcodes(const ImageView& _iv, const DecodeHints& hints)
+// The smallest module size (in pixels) a downscaled layer needs to resolve the symbols reliably, see IsUsefulLayer(). The
+// QR Code detector gets by with less, the DataMatrix one misses symbols with 4 pixels per module (in a box filtered image).
+static constexpr float MIN_LAYER_MODULE_SIZE = 5;
+
+// Whether layer i of the pyramid can contribute symbols of the expected module size (see DecodeHints::setModuleSizeRange()):
+// a downscaled layer in which even the largest modules are smaller than a pixel can't resolve them, a layer is redundant if
+// the next smaller one (which is not skipped then) still has at least MIN_LAYER_MODULE_SIZE pixels per module.
+static bool IsUsefulLayer(const DecodeHints& hints, const LumImagePyramid& pyramid, int i)
 {
-	if (sizeof(PatternType) < 4 && hints.hasFormat(BarcodeFormat::LinearCodes) && (_iv.width() > 0xffff || _iv.height() > 0xffff))
-		throw std::invalid_argument("maximum image width/height is 65535");
+	auto maxScale = [&](int i) { auto s = pyramid.scale(i); return std::max(s.x, s.y); };
+	if (i > 0 && hints.maxModuleSize() > 0 && hints.maxModuleSize() / maxScale(i) < 1)
+		return false;
+	// the tolerance covers the rounding of the layer size of LumImagePyramid::initScaled()
+	return !(i + 1 < pyramid.size() && hints.minModuleSize() / maxScale(i + 1) >= MIN_LAYER_MODULE_SIZE * 0.999f);
+}
 
-	LumImage lum;
-	ImageView iv = SetupLumImageView(_iv, lum, hints);
-	MultiFormatReader reader(hints);
+// Whether the results contain one that makes the remaining passes unnecessary, see DecodeHints::minConfidence()
+static bool IsConfidentEnough(const Results& results, const DecodeHints& hints)
+{
+	return hints.minConfidence() > 0
+		   && std::any_of(results.begin(), results.end(), [&](const Result& r) { return r.confidence() >= hints.minConfidence(); });
+}
 
-	if (hints.isPure())
-		return {reader.read(*CreateBitmap(hints.binarizer(), iv))};
+// The mean luminance of the blocks of a grid of (at most) 32 x 32 over an image, each from a lattice of (at most) 8 x 8
+// of its pixels, see DecodeHints::frameChangeThreshold()
+struct FrameSignature
+{
+	static constexpr int Grid = 32, Samples = 8;
+
+	int width = 0, height = 0;
+	std::vector<uint8_t> means;
 
+	void compute(const ImageView& iv)
+	{
+		width = iv.width();
+		height = iv.height();
+		const int gw = std::min(Grid, width), gh = std::min(Grid, height);
+		means.resize(gw * gh);
+		const int r = RedIndex(iv.format()), g = GreenIndex(iv.format()), b = BlueIndex(iv.format());
+		auto lum = [&](const uint8_t* p) { return iv.format() == ImageFormat::Lum ? *p : RGBToLum(p[r], p[g], p[b]); };
+		for (int by = 0; by < gh; ++by)
+			for (int bx = 0; bx < gw; ++bx) {
+				const int x0 = bx * width / gw, x1 = (bx + 1) * width / gw, y0 = by * height / gh, y1 = (by + 1) * height / gh;
+				const int sx = std::max(1, (x1 - x0) / Samples), sy = std::max(1, (y1 - y0) / Samples);
+				int sum = 0, n = 0;
+				for (int y = y0 + sy / 2; y < y1; y += sy)
+					for (int x = x0 + sx / 2; x < x1; x += sx, ++n)
+						sum += lum(iv.data(x, y));
+				means[by * gw + bx] = narrow_cast<uint8_t>(sum / n);
+			}
+	}
+
+	// true if no block mean of other differs by threshold or more from the one of this
+	bool matches(const FrameSignature& other, int threshold) const
+	{
+		if (means.empty() || other.width != width || other.height != height)
+			return false;
+		for (int i = 0; i < Size(means); ++i)
+			if (std::abs(other.means[i] - means[i]) >= threshold)
+				return false;
+		return true;
+	}
+};
+
+struct BarcodeReader::State
+{
+	// the readers keep a reference to the hints, so this object must not be moved after construction
+	const DecodeHints hints;
+	MultiFormatReader reader;
+#ifdef ZXING_BUILD_EXPERIMENTAL_API
+	DecodeHints closedHints;
+#endif
 	std::unique_ptr<MultiFormatReader> closedReader;
+	// the reader of the fast pass of DecodeHints::escalate(), if it differs from the regular one
+	DecodeHints fastHints;
+	std::unique_ptr<MultiFormatReader> fastReader;
+	// the passes of DecodeHints::fallbackBinarizers(), the hints only differ in the binarizer and (maybe) the formats
+	struct Fallback
+	{
+		DecodeHints hints;
+		MultiFormatReader reader;
+		explicit Fallback(const DecodeHints& hints) : hints(hints), reader(this->hints) {}
+	};
+	std::vector<std::unique_ptr<Fallback>> fallbacks;
+#ifdef ZXING_READER_QRCODE
+	QRCode::Reader qrTracker{hints, true};
+#endif
+	Results tracked; // the results of the last read() call, see DecodeHints::trackSymbols()
+	// the signature and the results of the last image decoded (to completion), see DecodeHints::frameChangeThreshold()
+	FrameSignature decodedSignature, signature;
+	Results decoded;
+	// the downscaled layers passed to the current read() call (if any) and the buffers of their luminance copies
+	const std::vector<ImageView>* downscaled = nullptr;
+	std::vector<LumImage> downscaledLum;
+	// the callback passed to the current read() call (if any), the number of results passed to it and if it asked to stop
+	const ResultCallback* onResult = nullptr;
+	int reported = 0;
+	bool stopped = false;
+
+	struct Track
+	{
+		int id;
+		Result last;
+		int missed; // number of consecutive read() calls without this symbol
+	};
+	std::vector<Track> tracks;
+	std::vector<TrackEvent> trackEvents;
+	int nextTrackId = 1;
+	LumImage lum;
+	LumImagePyramid pyramid;
+	bool deadlineExceeded = false;
+#ifdef ZX_HAVE_PMR
+	// the transient allocations of one read() call (the pattern row caches of the bitmaps), released at its end
+	ArenaResource arena{hints.memoryResource()};
+#endif
+
+	explicit State(const DecodeHints& hints) : hints(hints), reader(this->hints)
+	{
 #ifdef ZXING_BUILD_EXPERIMENTAL_API
-	auto formatsBenefittingFromClosing = BarcodeFormat::Aztec | BarcodeFormat::DataMatrix | BarcodeFormat::QRCode | BarcodeFormat::MicroQRCode;
-	DecodeHints closedHints = hints;
-	if (hints.tryDenoise() && hints.hasFormat(formatsBenefittingFromClosing)) {
-		closedHints.setFormats((hints.formats().empty() ? BarcodeFormat::Any : hints.formats()) & formatsBenefittingFromClosing);
-		closedReader = std::make_unique<MultiFormatReader>(closedHints);
+		auto formatsBenefittingFromClosing = BarcodeFormat::Aztec | BarcodeFormat::DataMatrix | BarcodeFormat::QRCode | BarcodeFormat::MicroQRCode;
+		closedHints = hints;
+		if (hints.tryDenoise() && hints.hasFormat(formatsBenefittingFromClosing)) {
+			closedHints.setFormats((hints.formats().empty() ? BarcodeFormat::Any : hints.formats()) & formatsBenefittingFromClosing);
+			closedReader = std::make_unique<MultiFormatReader>(closedHints);
+		}
+#endif
+		if (hints.escalate()) {
+			auto overrides = hints.formatOverrides();
+			bool thorough = hints.tryHarder() || hints.tryRotate();
+			for (auto& o : overrides) {
+				thorough |= o.tryHarder.value_or(false) || o.tryRotate.value_or(false);
+				o.tryHarder = o.tryRotate = std::nullopt;
+			}
+			if (thorough) {
+				fastHints = DecodeHints(hints).setTryHarder(false).setTryRotate(false).setFormatOverrides(std::move(overrides));
+				fastReader = std::make_unique<MultiFormatReader>(fastHints);
+			}
+		}
+		auto sharesRows = [](Binarizer b) { return b == Binarizer::LocalAverage || b == Binarizer::GlobalHistogram; };
+		std::vector<Binarizer> tried = {hints.binarizer()};
+		for (auto binarizer : hints.fallbackBinarizers()) {
+			if (Contains(tried, binarizer))
+				continue;
+			auto formats = hints.formats().empty() ? BarcodeFormats(BarcodeFormat::Any) : hints.formats();
+			// the rows the linear readers scan are the same as with the primary binarizer
+			if (sharesRows(binarizer) && sharesRows(hints.binarizer()))
+				formats &= BarcodeFormat::MatrixCodes;
+			tried.push_back(binarizer);
+			if (formats.empty())
+				continue;
+			fallbacks.push_back(std::make_unique<Fallback>(
+				DecodeHints(hints).setBinarizer(binarizer).setFormats(formats).setFallbackBinarizers({})));
+		}
+	}
+
+	std::unique_ptr<BinaryBitmap> createBitmap(const ImageView& iv, Executor* executor = nullptr,
+											   const Matrix<int>* blackPoints = nullptr, PointF scale = {1, 1})
+	{
+		return createBitmap(hints, iv, executor, blackPoints, scale);
 	}
+
+	std::unique_ptr<BinaryBitmap> createBitmap(const DecodeHints& hints, const ImageView& iv, Executor* executor,
+											   const Matrix<int>* blackPoints, PointF scale = {1, 1})
+	{
+		auto res = CreateBitmap(hints, iv, executor, blackPoints, scale);
+#ifdef ZX_HAVE_PMR
+		if (res)
+			res->setMemoryResource(&arena);
 #endif
-	LumImagePyramid pyramid(iv, hints.downscaleThreshold() * hints.tryDownscale(), hints.downscaleFactor());
+		return res;
+	}
+
+	// Pass a result just added to the list of all results to onResult, if it asks to stop, no further results are added
+	void report(const Result& r, int& maxSymbols)
+	{
+		if (!onResult || stopped)
+			return;
+		++reported;
+		if (!(*onResult)(r)) {
+			stopped = true;
+			maxSymbols = 0;
+		}
+	}
+
+	// Add the new (not yet contained) results of one pass over a (downscaled) layer to the list of all results
+	void mergeResults(Results& results, ResultIndex& index, Results&& rs, PointF scale, bool inverted, const DecodeHints& hints,
+					  int& maxSymbols)
+	{
+		for (auto& r : rs) {
+			if (stopped)
+				break;
+			if (scale != PointF(1, 1))
+				r.setPosition(ScalePosition(r.position(), scale));
+			if (index.find(results, r) == -1) {
+				r.setDecodeHints(hints);
+				r.setIsInverted(inverted);
+				index.add(r);
+				results.push_back(std::move(r));
+				--maxSymbols;
+				report(results.back(), maxSymbols);
+			}
+		}
+	}
+};
+
+BarcodeReader::BarcodeReader(const DecodeHints& hints) : _state(std::make_unique<State>(hints)) {}
+
+BarcodeReader::~BarcodeReader() = default;
+
+BarcodeReader::BarcodeReader(BarcodeReader&&) noexcept = default;
+BarcodeReader& BarcodeReader::operator=(BarcodeReader&&) noexcept = default;
+
+const DecodeHints& BarcodeReader::hints() const
+{
+	return _state->hints;
+}
+
+bool BarcodeReader::deadlineExceeded() const
+{
+	return _state->deadlineExceeded;
+}
+
+Results BarcodeReader::read(const ImageView& iv)
+{
+	ZX_TRACE_SCOPE("BarcodeReader::read");
+	const auto& hints = _state->hints;
+	StatsContext context(hints.stats());
+	CountStat(DecodeStats::Counter::Reads);
+#ifdef ZX_HAVE_PMR
+	// runs when read() returns or throws, i.e. after all bitmaps of this call are gone
+	SCOPE_EXIT([this] { _state->arena.release(); });
+#endif
+
+	// an image that did not change since the last one decoded is not decoded again, see DecodeHints::frameChangeThreshold()
+	auto& state = *_state;
+	if (hints.frameChangeThreshold()) {
+		StatsScope scope(DecodeStats::Stage::Preprocess);
+		state.signature.compute(iv);
+	}
+
+	// the results not passed to onResult while they were found (e.g. the tracked or unchanged ones) are passed now
+	state.reported = 0;
+	state.stopped = false;
+	auto reportRest = [&state](Results& results) {
+		if (!state.onResult)
+			return;
+		int maxSymbols = 1;
+		for (int i = state.reported; i < Size(results) && !state.stopped; ++i)
+			state.report(results[i], maxSymbols);
+		results.resize(state.reported);
+	};
+
+	Results results;
+	if (hints.frameChangeThreshold() && state.decodedSignature.matches(state.signature, hints.frameChangeThreshold())) {
+		CountStat(DecodeStats::Counter::UnchangedFrames);
+		results = state.decoded;
+		reportRest(results);
+		state.deadlineExceeded = false;
+	} else {
+		results = readTracked(iv);
+		if (results.empty())
+			results = _state->downscaled ? readImage(iv) : readRegions(iv);
+		reportRest(results);
+		state.deadlineExceeded = IsExpired(hints.deadline());
+		if (hints.frameChangeThreshold()) {
+			std::swap(state.decodedSignature, state.signature);
+			if (state.deadlineExceeded || state.stopped) // incomplete results are not worth repeating
+				state.decodedSignature.means.clear();
+			state.decoded = results;
+		}
+	}
+
+	if (hints.trackSymbols()) {
+		updateTracks(results);
+		_state->tracked = results;
+	}
+	return results;
+}
+
+Results BarcodeReader::read(const ImageView& iv, const std::vector<ImageView>& downscaled)
+{
+	_state->downscaled = &downscaled;
+	SCOPE_EXIT([this] { _state->downscaled = nullptr; });
+	return read(iv);
+}
+
+Results BarcodeReader::read(const ImageView& iv, const ResultCallback& onResult)
+{
+	_state->onResult = &onResult;
+	SCOPE_EXIT([this] { _state->onResult = nullptr; });
+	return read(iv);
+}
+
+Results BarcodeReader::read(ImageRowSource& source)
+{
+	ZX_TRACE_SCOPE("BarcodeReader::read");
+	const auto& hints = _state->hints;
+	StatsContext context(hints.stats());
+	CountStat(DecodeStats::Counter::Reads);
+#ifdef ZX_HAVE_PMR
+	SCOPE_EXIT([this] { _state->arena.release(); });
+#endif
+
+	const int width = source.width();
+	const int pixStride = PixStride(source.format());
+	const int bandHeight = hints.tileSize() ? hints.tileSize() : 2048;
+	const int overlap = std::clamp<int>(hints.tileOverlap() ? hints.tileOverlap() : bandHeight / 4, 0, bandHeight - 1);
+	const int rowStride = width * pixStride;
+	std::vector<uint8_t> band(size_t(rowStride) * bandHeight);
 
 	Results results;
+	ResultIndex index;
 	int maxSymbols = hints.maxNumberOfSymbols() ? hints.maxNumberOfSymbols() : INT_MAX;
-	for (auto&& iv : pyramid.layers) {
-		auto bitmap = CreateBitmap(hints.binarizer(), iv);
-		for (int close = 0; close <= (closedReader ? 1 : 0); ++close) {
-			if (close)
-				bitmap->close();
+	int bandTop = 0, rows = 0;
+	while (maxSymbols > 0 && !IsExpired(hints.deadline())) {
+		// keep the last overlap rows of the previous band and append the new ones
+		const int kept = std::min(rows, overlap);
+		if (kept)
+			std::memmove(band.data(), band.data() + size_t(rows - kept) * rowStride, size_t(kept) * rowStride);
+		bandTop += rows - kept;
+		rows = kept;
+		for (int n = 1; rows < bandHeight && n > 0; rows += n)
+			n = std::max(0, source.readRows(band.data() + size_t(rows) * rowStride, rowStride, bandHeight - rows));
+		if (rows == kept)
+			break;
 
-			// TODO: check if closing after invert would be beneficial
-			for (int invert = 0; invert <= static_cast<int>(hints.tryInvert() && !close); ++invert) {
-				if (invert)
-					bitmap->invert();
-				auto rs = (close ? *closedReader : reader).readMultiple(*bitmap, maxSymbols);
-				for (auto& r : rs) {
-					if (iv.width() != _iv.width())
-						r.setPosition(Scale(r.position(), _iv.width() / iv.width()));
-					if (!Contains(results, r)) {
-						r.setDecodeHints(hints);
-						r.setIsInverted(bitmap->inverted());
-						results.push_back(std::move(r));
-						--maxSymbols;
-					}
-				}
+		for (auto& r : readTiles(ImageView(band.data(), width, rows, source.format(), rowStride))) {
+			r.setPosition(Translate(r.position(), PointI(0, bandTop)));
+			if (index.find(results, r) == -1) {
+				index.add(r);
+				results.push_back(std::move(r));
+				if (--maxSymbols <= 0)
+					break;
+			}
+		}
+#ifdef ZX_HAVE_PMR
+		_state->arena.release();
+#endif
+		if (rows < bandHeight)
+			break;
+	}
+
+	_state->deadlineExceeded = IsExpired(hints.deadline());
+	return results;
+}
+
+void BarcodeReader::updateTracks(Results& results)
+{
+	auto& tracks = _state->tracks;
+	auto& events = _state->trackEvents;
+	events.clear();
+
+	std::vector<bool> found(tracks.size(), false);
+	for (auto& r : results) {
+		auto isSameSymbol = [&r](const Result& o) {
+			return o.format() == r.format() && o.bytes() == r.bytes() && HaveIntersectingBoundingBoxes(o.position(), r.position());
+		};
+		int i = 0;
+		while (i < Size(tracks) && (found[i] || !isSameSymbol(tracks[i].last)))
+			++i;
+		if (i < Size(tracks)) {
+			found[i] = true;
+			r._trackId = tracks[i].id;
+			tracks[i].last = r;
+			tracks[i].missed = 0;
+		} else {
+			r._trackId = _state->nextTrackId++;
+			tracks.push_back({r._trackId, r, 0});
+			found.push_back(true);
+			events.push_back({TrackEvent::Type::Enter, r});
+		}
+	}
+
+	// an incomplete search is no evidence that a symbol is gone
+	if (_state->deadlineExceeded)
+		return;
+
+	for (int i = 0; i < Size(tracks); ++i)
+		if (!found[i] && ++tracks[i].missed >= TrackTimeout)
+			events.push_back({TrackEvent::Type::Leave, std::move(tracks[i].last)});
+	tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [](const State::Track& t) { return t.missed >= TrackTimeout; }),
+				 tracks.end());
+}
+
+const std::vector<BarcodeReader::TrackEvent>& BarcodeReader::trackEvents() const
+{
+	return _state->trackEvents;
+}
+
+Results BarcodeReader::readTracked(const ImageView& _iv)
+{
+	ZX_TRACE_SCOPE("BarcodeReader::readTracked");
+	const auto& hints = _state->hints;
+	const auto& tracked = _state->tracked;
+	// only worth it if all symbols we are looking for have been found in the last image
+	if (!hints.trackSymbols() || !hints.regionsOfInterest().empty() || tracked.empty() || hints.maxNumberOfSymbols() == 0
+		|| hints.maxNumberOfSymbols() > Size(tracked)
+		|| !std::all_of(tracked.begin(), tracked.end(), [](const Result& r) { return r.format() == BarcodeFormat::QRCode; }))
+		return {};
+
+#ifdef ZXING_READER_QRCODE
+	ImageView iv = SetupLumImageView(_iv, _state->lum, hints);
+	auto bitmap = _state->createBitmap(iv);
+
+	Results results;
+	ResultIndex index;
+	for (const auto& prev : tracked) {
+		if (prev.isInverted() != bitmap->inverted())
+			bitmap->invert();
+		Result r;
+		{
+			StatsScope scope(DecodeStats::Stage::Detect);
+			r = _state->qrTracker.decodeTracked(*bitmap, prev);
+		}
+		// if a single symbol got lost, fall back to a full scan of the image
+		if (!r.isValid() || index.find(results, r) != -1)
+			return {};
+		r.setDecodeHints(hints);
+		r.setIsInverted(bitmap->inverted());
+		index.add(r);
+		results.push_back(std::move(r));
+	}
+
+	return results;
+#else
+	(void)_iv;
+	return {}; // there are no QR Code results to track
+#endif
+}
+
+Results BarcodeReader::readRegions(const ImageView& iv)
+{
+	const auto& hints = _state->hints;
+	if (hints.regionsOfInterest().empty())
+		return readTiles(iv);
+
+	// the results of a region are passed to the callback of read() once its position is known here
+	const auto* onResult = std::exchange(_state->onResult, nullptr);
+	SCOPE_EXIT([this, onResult] { _state->onResult = onResult; });
+
+	Results results;
+	ResultIndex index;
+	int maxSymbols = hints.maxNumberOfSymbols() ? hints.maxNumberOfSymbols() : INT_MAX;
+	for (const auto& roi : hints.regionsOfInterest()) {
+		if (IsExpired(hints.deadline()))
+			break;
+		if (roi.left >= iv.width() || roi.top >= iv.height() || roi.left + roi.width <= 0 || roi.top + roi.height <= 0)
+			continue;
+		auto offset = PointI(std::max(0, roi.left), std::max(0, roi.top));
+		auto rs = readTiles(iv.cropped(roi));
+		_state->onResult = onResult;
+		for (auto& r : rs) {
+			r.setPosition(Translate(r.position(), offset));
+			if (index.find(results, r) == -1) {
+				index.add(r);
+				results.push_back(std::move(r));
+				--maxSymbols;
+				_state->report(results.back(), maxSymbols);
 				if (maxSymbols <= 0)
 					return results;
 			}
 		}
+		_state->onResult = nullptr;
+	}
+
+	return results;
+}
+
+namespace {
+
+// Executor used to make sure a BarcodeReader does not try to spawn nested parallel work, see readTiles() and ReadBarcodes()
+class SequentialExecutor : public Executor
+{
+public:
+	void parallelFor(int n, const std::function<void(int)>& func) override
+	{
+		for (int i = 0; i < n; ++i)
+			func(i);
+	}
+	int concurrency() const override { return 1; }
+};
+
+} // namespace
+
+// The tiles of DecodeHints::tileSize(), evenly distributed over [0, size) with an overlap of at least overlap pixels
+static std::vector<int> TileStarts(int size, int tileSize, int overlap)
+{
+	const int n = size <= tileSize ? 1 : 1 + (size - overlap - 1) / (tileSize - overlap);
+	std::vector<int> starts(n);
+	for (int i = 1; i < n; ++i)
+		starts[i] = static_cast<int>(int64_t(size - tileSize) * i / (n - 1));
+	return starts;
+}
+
+/**
+ * Process the image as overlapping tiles, see DecodeHints::tileSize(). Each tile is read like a complete image (with its
+ * own pyramid, so the memory needed depends on the tile size only). With an Executor, the tiles are distributed over
+ * its threads, each one with its own BarcodeReader. The results are merged in the order of the tiles (row major) in
+ * either case, a symbol in the overlap of two tiles is reported with the position found in the first one.
+ */
+Results BarcodeReader::readTiles(const ImageView& iv)
+{
+	const auto& hints = _state->hints;
+	const int tileSize = hints.tileSize();
+	if (!tileSize || (iv.width() <= tileSize && iv.height() <= tileSize))
+		return readImage(iv);
+
+	ZX_TRACE_SCOPE("BarcodeReader::readTiles");
+	const int overlap = std::clamp<int>(hints.tileOverlap() ? hints.tileOverlap() : tileSize / 4, 0, tileSize - 1);
+	std::vector<Rect> tiles;
+	for (int top : TileStarts(iv.height(), tileSize, overlap))
+		for (int left : TileStarts(iv.width(), tileSize, overlap))
+			tiles.push_back({left, top, tileSize, tileSize});
+
+	Results results;
+	ResultIndex index;
+	int maxSymbols = hints.maxNumberOfSymbols() ? hints.maxNumberOfSymbols() : INT_MAX;
+	// the results of a tile are passed to the callback of read() once their position is known here
+	const auto* onResult = std::exchange(_state->onResult, nullptr);
+	SCOPE_EXIT([this, onResult] { _state->onResult = onResult; });
+	auto merge = [&](Results&& rs, const Rect& tile) {
+		std::swap(_state->onResult, onResult);
+		for (auto& r : rs) {
+			r.setPosition(Translate(r.position(), PointI(tile.left, tile.top)));
+			if (maxSymbols > 0 && index.find(results, r) == -1) {
+				index.add(r);
+				results.push_back(std::move(r));
+				--maxSymbols;
+				_state->report(results.back(), maxSymbols);
+			}
+		}
+		std::swap(_state->onResult, onResult);
+	};
+
+	// read() releases the arena only when it returns, a tile does not need what the previous one allocated
+	auto readTile = [&iv](BarcodeReader& reader, const Rect& tile) {
+		auto rs = reader.readImage(iv.cropped(tile));
+#ifdef ZX_HAVE_PMR
+		reader._state->arena.release();
+#endif
+		return rs;
+	};
+
+	auto executor = SelectExecutor(hints);
+	if (!executor || executor->concurrency() < 2) {
+		for (const auto& tile : tiles) {
+			if (maxSymbols <= 0 || IsExpired(hints.deadline()))
+				break;
+			merge(readTile(*this, tile), tile);
+		}
+		return results;
 	}
 
+	// the tile readers run sequentially and look at the whole tile (no tiles, regions, tracking or change detection)
+	static SequentialExecutor sequential;
+	const auto tileHints = DecodeHints(hints)
+							   .setExecutor(&sequential)
+							   .setTileSize(0)
+							   .setRegionsOfInterest({})
+							   .setTrackSymbols(false)
+							   .setFrameChangeThreshold(0);
+
+	std::vector<Results> tileResults(tiles.size());
+	std::vector<bool> done(tiles.size(), false);
+	std::vector<std::unique_ptr<BarcodeReader>> readers; // pool, at most executor->concurrency() readers are alive
+	int nextToMerge = 0;
+	std::mutex mutex;
+	std::atomic<bool> cancelled = false;
+	std::exception_ptr exception;
+
+	executor->parallelFor(Size(tiles), [&, stats = CurrentStats()](int i) {
+		StatsContext context(stats);
+		std::unique_ptr<BarcodeReader> reader;
+		{
+			std::lock_guard lock(mutex);
+			if (cancelled)
+				return;
+			if (!readers.empty()) {
+				reader = std::move(readers.back());
+				readers.pop_back();
+			}
+		}
+		Results rs;
+		try {
+			if (!reader)
+				reader = std::make_unique<BarcodeReader>(tileHints);
+			if (!IsExpired(hints.deadline()))
+				rs = readTile(*reader, tiles[i]);
+		} catch (...) {
+			std::lock_guard lock(mutex);
+			if (!exception)
+				exception = std::current_exception();
+			cancelled = true;
+		}
+		std::lock_guard lock(mutex);
+		if (reader)
+			readers.push_back(std::move(reader));
+		tileResults[i] = std::move(rs);
+		done[i] = true;
+		for (; nextToMerge < Size(tiles) && done[nextToMerge] && maxSymbols > 0; ++nextToMerge)
+			merge(std::move(tileResults[nextToMerge]), tiles[nextToMerge]);
+		if (maxSymbols <= 0)
+			cancelled = true;
+	});
+
+	if (exception)
+		std::rethrow_exception(exception);
+
 	return results;
 }
 
+Results BarcodeReader::readImage(const ImageView& _iv)
+{
+	ZX_TRACE_SCOPE("BarcodeReader::readImage");
+	const auto& hints = _state->hints;
+
+	if (sizeof(PatternType) < 4 && hints.hasFormat(BarcodeFormat::LinearCodes) && (_iv.width() > 0xffff || _iv.height() > 0xffff))
+		throw std::invalid_argument("maximum image width/height is 65535");
+
+	ImageView iv = SetupLumImageView(_iv, _state->lum, hints);
+	const MultiFormatReader& reader = _state->reader;
+
+	if (hints.isPure()) {
+		auto res = reader.read(*_state->createBitmap(iv));
+		for (const auto& fallback : _state->fallbacks) {
+			if (res.format() != BarcodeFormat::None)
+				break;
+			CountStat(DecodeStats::Counter::FallbackPasses);
+			res = fallback->reader.read(*_state->createBitmap(fallback->hints, iv, nullptr, nullptr));
+		}
+		return {res};
+	}
+
+	const auto& closedReader = _state->closedReader;
+	auto& pyramid = _state->pyramid;
+	if (const auto* downscaled = _state->downscaled) {
+		auto& lums = _state->downscaledLum;
+		if (lums.size() < downscaled->size())
+			lums.resize(downscaled->size());
+		std::vector<ImageView> layers = {iv};
+		for (int i = 0; i < Size(*downscaled); ++i) {
+			const auto& layer = (*downscaled)[i];
+			if (layer.width() <= 0 || layer.height() <= 0 || layer.width() > layers.back().width() || layer.height() > layers.back().height())
+				throw std::invalid_argument("downscaled images must be ordered by decreasing size");
+			layers.push_back(SetupLumImageView(layer, lums[i], hints));
+		}
+		pyramid.init(std::move(layers));
+	} else if (hints.minModuleSize() > 0 && hints.tryDownscale()) {
+		// one layer in which the smallest expected modules are just large enough replaces the chain of layers
+		pyramid.initScaled(iv, hints.minModuleSize() / MIN_LAYER_MODULE_SIZE);
+	} else {
+		pyramid.init(iv, hints.downscaleThreshold() * hints.tryDownscale(), hints.downscaleFactor(),
+					 hints.binarizer() == Binarizer::LocalAverage && !hints.binarizerBackend(), hints.deriveLayerBlackPoints());
+	}
+
+	// the first downscaled layer (if any) is needed anyway and makes the estimate less dependent on the resolution
+	if (hints.minFrameSharpness()) {
+		FrameQuality quality;
+		{
+			StatsScope scope(DecodeStats::Stage::Preprocess);
+			quality = EstimateFrameQuality(pyramid.layer(std::min(1, pyramid.size() - 1)));
+		}
+		if (quality.sharpness < hints.minFrameSharpness()) {
+			CountStat(DecodeStats::Counter::SkippedFrames);
+			return {};
+		}
+	}
+
+	auto executor = SelectExecutor(hints);
+	if (executor && executor->concurrency() < 2)
+		executor.reset();
+
+	// parallelize over the layers/passes if there are multiple, otherwise let the binarizer and the readers use the executor
+	const bool parallel = executor && !hints.coarseToFine() && !hints.escalate() && (pyramid.size() > 1 || hints.tryInvertAny());
+
+	Results results;
+	ResultIndex index;
+	int maxSymbols = hints.maxNumberOfSymbols() ? hints.maxNumberOfSymbols() : INT_MAX;
+
+	// the passes over all layers with the binarizer of the given hints, returns true if no further passes are needed
+	auto readLayers = [&](const DecodeHints& hints, const MultiFormatReader& reader, const MultiFormatReader* closedReader,
+						  std::unique_ptr<BinaryBitmap> fullResBitmap) {
+		std::vector<Rect> masked;
+		for (int l = 0; l < pyramid.size(); ++l) {
+			// In coarseToFine mode, starting with the smallest layer is faster for a single symbol, the better (high res)
+			// position information we lose that way can be improved later (TODO). In the multi-symbol case, the areas of
+			// the symbols found in the lower res layers are masked out in the higher res ones.
+			const int layer = hints.coarseToFine() ? pyramid.size() - 1 - l : l;
+			if (!IsUsefulLayer(hints, pyramid, layer))
+				continue;
+			auto iv = pyramid.layer(layer);
+			// let the backend work on the next layer while this one is processed
+			if (auto backend = hints.binarizerBackend(); backend && hints.binarizer() == Binarizer::LocalAverage) {
+				if (l == 0 && !fullResBitmap)
+					backend->prepare(iv);
+				if (l + 1 < pyramid.size())
+					backend->prepare(pyramid.layer(hints.coarseToFine() ? layer - 1 : layer + 1));
+			}
+			auto bitmap = layer == 0 && fullResBitmap
+							  ? std::move(fullResBitmap)
+							  : _state->createBitmap(hints, iv, executor.get(), pyramid.layerBlackPoints(layer), pyramid.scale(layer));
+			CountStat(DecodeStats::Counter::Layers);
+			if (hints.coarseToFine()) {
+				masked.clear();
+				const auto scale = pyramid.scale(layer);
+				for (const auto& r : results) {
+					auto bb = BoundingBox(r.position());
+					masked.push_back({int(bb[0].x / scale.x), int(bb[0].y / scale.y), int((bb[2].x - bb[0].x) / scale.x) + 1,
+									  int((bb[2].y - bb[0].y) / scale.y) + 1});
+				}
+			}
+			for (int close = 0; close <= (closedReader ? 1 : 0); ++close) {
+				if (close) {
+					bitmap->close();
+					CountStat(DecodeStats::Counter::ClosePasses);
+				}
+
+				// TODO: check if closing after invert would be beneficial
+				for (int invert = 0; invert <= static_cast<int>(hints.tryInvertAny() && !close); ++invert) {
+					if (IsExpired(hints.deadline()))
+						return true;
+					if (invert) {
+						bitmap->invert();
+						CountStat(DecodeStats::Counter::InvertPasses);
+					}
+					if (!masked.empty())
+						bitmap->mask(masked);
+					auto rs = (close ? *closedReader : reader).readMultiple(*bitmap, maxSymbols);
+					_state->mergeResults(results, index, std::move(rs), pyramid.scale(layer), bitmap->inverted(), hints, maxSymbols);
+					if (maxSymbols <= 0 || (hints.escalate() && !results.empty()) || IsConfidentEnough(results, hints))
+						return true;
+				}
+			}
+		}
+		return false;
+	};
+
+	auto readFallbacks = [&]() {
+		for (const auto& fallback : _state->fallbacks) {
+			if (!results.empty())
+				break;
+			CountStat(DecodeStats::Counter::FallbackPasses);
+			if (readLayers(fallback->hints, fallback->reader, nullptr, nullptr))
+				break;
+		}
+		return std::move(results);
+	};
+
+	if (parallel) {
+		results = readParallel(*executor);
+		if (!results.empty() || _state->fallbacks.empty())
+			return results;
+		// the fallbacks are processed sequentially, the binarizers and the readers may still use the executor
+		return readFallbacks();
+	}
+
+	// the fast pass of the escalation policy, its bitmap is reused by the regular passes over the full resolution layer
+	std::unique_ptr<BinaryBitmap> fullResBitmap;
+	if (const auto& fastReader = _state->fastReader) {
+		fullResBitmap = _state->createBitmap(iv, executor.get());
+		auto rs = fastReader->readMultiple(*fullResBitmap, maxSymbols);
+		_state->mergeResults(results, index, std::move(rs), {1, 1}, false, hints, maxSymbols);
+		if (!results.empty())
+			return results;
+		CountStat(DecodeStats::Counter::Escalations);
+	}
+
+	if (readLayers(hints, reader, closedReader.get(), std::move(fullResBitmap)))
+		return results;
+	return readFallbacks();
+}
+
+/**
+ * Process every (layer, inverted) combination as an independent task. Each task gets its own BinaryBitmap, the
+ * closed pass (if any) is run as part of the non-inverted task. The results are merged strictly in the order
+ * of the serial code path, so the outcome does not depend on the scheduling. As soon as the merged prefix
+ * contains maxSymbols results (or one of DecodeHints::minConfidence()), the remaining tasks are skipped.
+ */
+Results BarcodeReader::readParallel(Executor& executor)
+{
+	ZX_TRACE_SCOPE("BarcodeReader::readParallel");
+	const auto& hints = _state->hints;
+	auto& pyramid = _state->pyramid;
+	const int passesPerLayer = 1 + hints.tryInvertAny();
+	const int numTasks = pyramid.size() * passesPerLayer;
+
+	struct TaskResult
+	{
+		Results normal, closed;
+		PointF scale = {1, 1};
+		bool done = false;
+	};
+	std::vector<TaskResult> taskResults(numTasks);
+
+	Results results;
+	ResultIndex index;
+	int maxSymbols = hints.maxNumberOfSymbols() ? hints.maxNumberOfSymbols() : INT_MAX;
+	const int maxSymbolsPerPass = maxSymbols;
+	int nextToMerge = 0;
+	std::mutex mutex;
+	std::atomic<bool> cancelled = false;
+	std::exception_ptr exception;
+
+	auto runTask = [&, stats = CurrentStats()](int i) {
+		if (cancelled)
+			return;
+
+		ZX_TRACE_SCOPE("BarcodeReader::readParallel task");
+		StatsContext context(stats);
+
+		TaskResult res;
+		// a task skipped because of the deadline is still merged (as empty) to not block the later ones
+		if (!IsExpired(hints.deadline()) && IsUsefulLayer(hints, pyramid, i / passesPerLayer)) {
+			const auto layer = pyramid.layer(i / passesPerLayer);
+			res.scale = pyramid.scale(i / passesPerLayer);
+			const bool invert = i % passesPerLayer;
+			auto bitmap = _state->createBitmap(layer, nullptr, pyramid.layerBlackPoints(i / passesPerLayer), res.scale);
+			if (invert) {
+				bitmap->invert();
+				CountStat(DecodeStats::Counter::InvertPasses);
+			} else {
+				CountStat(DecodeStats::Counter::Layers);
+			}
+
+			res.normal = _state->reader.readMultiple(*bitmap, maxSymbolsPerPass);
+			if (!invert && _state->closedReader && !cancelled) {
+				bitmap->close();
+				CountStat(DecodeStats::Counter::ClosePasses);
+				res.closed = _state->closedReader->readMultiple(*bitmap, maxSymbolsPerPass);
+			}
+		}
+
+		std::lock_guard lock(mutex);
+		taskResults[i] = std::move(res);
+		taskResults[i].done = true;
+		auto isDone = [&] { return maxSymbols <= 0 || IsConfidentEnough(results, hints); };
+		for (; nextToMerge < numTasks && taskResults[nextToMerge].done && !isDone(); ++nextToMerge) {
+			auto& tr = taskResults[nextToMerge];
+			const bool trInverted = nextToMerge % passesPerLayer;
+			_state->mergeResults(results, index, std::move(tr.normal), tr.scale, trInverted, hints, maxSymbols);
+			_state->mergeResults(results, index, std::move(tr.closed), tr.scale, trInverted, hints, maxSymbols);
+		}
+		if (isDone())
+			cancelled = true;
+	};
+
+	executor.parallelFor(numTasks, [&](int i) {
+		try {
+			runTask(i);
+		} catch (...) {
+			std::lock_guard lock(mutex);
+			if (!exception)
+				exception = std::current_exception();
+			cancelled = true;
+		}
+	});
+
+	if (exception)
+		std::rethrow_exception(exception);
+
+	return results;
+}
+
+Result ReadBarcode(const ImageView& _iv, const DecodeHints& hints)
+{
+	return FirstOrDefault(ReadBarcodes(_iv, DecodeHints(hints).setMaxNumberOfSymbols(1)));
+}
+
+Results ReadBarcodes(const ImageView& _iv, const DecodeHints& hints)
+{
+	return BarcodeReader(hints).read(_iv);
+}
+
+Results ReadBarcodes(const ImageView& iv, const DecodeHints& hints, const ResultCallback& onResult)
+{
+	return BarcodeReader(hints).read(iv, onResult);
+}
+
+Results ReadBarcodes(const ImageView& iv, const std::vector<ImageView>& downscaled, const DecodeHints& hints)
+{
+	return BarcodeReader(hints).read(iv, downscaled);
+}
+
+Results ReadBarcodes(ImageRowSource& source, const DecodeHints& hints)
+{
+	return BarcodeReader(hints).read(source);
+}
+
+std::vector<Results> ReadBarcodes(const std::vector<ImageView>& ivs, const DecodeHints& hints)
+{
+	std::vector<Results> res(ivs.size());
+
+	auto executor = SelectExecutor(hints);
+	if (!executor || executor->concurrency() < 2 || Size(ivs) < 2) {
+		BarcodeReader reader(hints);
+		for (size_t i = 0; i < ivs.size(); ++i)
+			res[i] = reader.read(ivs[i]);
+		return res;
+	}
+
+	static SequentialExecutor sequential;
+	const auto seqHints = DecodeHints(hints).setExecutor(&sequential);
+
+	// pool of readers: each task borrows one, so there are at most executor->concurrency() readers alive
+	std::mutex mutex;
+	std::vector<std::unique_ptr<BarcodeReader>> readers;
+	std::exception_ptr exception;
+
+	executor->parallelFor(Size(ivs), [&](int i) {
+		std::unique_ptr<BarcodeReader> reader;
+		{
+			std::lock_guard lock(mutex);
+			if (exception)
+				return;
+			if (!readers.empty()) {
+				reader = std::move(readers.back());
+				readers.pop_back();
+			}
+		}
+		try {
+			if (!reader)
+				reader = std::make_unique<BarcodeReader>(seqHints);
+			res[i] = reader->read(ivs[i]);
+		} catch (...) {
+			std::lock_guard lock(mutex);
+			if (!exception)
+				exception = std::current_exception();
+		}
+		std::lock_guard lock(mutex);
+		if (reader)
+			readers.push_back(std::move(reader));
+	});
+
+	if (exception)
+		std::rethrow_exception(exception);
+
+	return res;
+}
+
+Result DecodeModules(const BitMatrix& modules, BarcodeFormat format)
+{
+#ifdef ZXING_READER_ONED
+	[[maybe_unused]] auto decodeRow = [&](const OneD::RowReader& reader) {
+		if (modules.height() != 1)
+			return Result();
+		// the row readers expect a quiet zone on both sides
+		constexpr int QUIET_ZONE = 10;
+		std::vector<uint8_t> row(modules.width() + 2 * QUIET_ZONE, 0);
+		for (int x = 0; x < modules.width(); ++x)
+			row[x + QUIET_ZONE] = modules.get(x, 0);
+		auto res = OneD::DecodeSingleRow(reader, Range(row));
+		return res.format() == format ? res : Result();
+	};
+
+	// keep the Codabar start/stop characters, they are part of the content passed to the writer
+	auto hints = DecodeHints().setFormats(format).setReturnCodabarStartEnd(true);
+#endif
+	[[maybe_unused]] auto position = Rectangle<PointI>(modules.width(), modules.height(), 0);
+
+	// the formats whose reader is not built (see ZXING_READERS in core/CMakeLists.txt) are unsupported
+	switch (format) {
+#ifdef ZXING_READER_AZTEC
+	case BarcodeFormat::Aztec: {
+		auto detectorResult = Aztec::ReadModules(modules);
+		if (!detectorResult.isValid())
+			return Result(DecoderResult(FormatError("Invalid Aztec mode message")), std::move(position), format);
+		return Result(Aztec::Decode(detectorResult), std::move(position), format);
+	}
+#endif
+#ifdef ZXING_READER_DATAMATRIX
+	case BarcodeFormat::DataMatrix: return Result(DataMatrix::Decode(modules), std::move(position), format);
+#endif
+#ifdef ZXING_READER_PDF417
+	case BarcodeFormat::PDF417: return Result(Pdf417::DecodeModules(modules), std::move(position), format);
+#endif
+#ifdef ZXING_READER_QRCODE
+	case BarcodeFormat::MicroQRCode:
+	case BarcodeFormat::QRCode: return Result(QRCode::Decode(modules), std::move(position), format);
+#endif
+#ifdef ZXING_READER_CODABAR
+	case BarcodeFormat::Codabar: return decodeRow(OneD::CodabarReader(hints));
+#endif
+#ifdef ZXING_READER_CODE39
+	case BarcodeFormat::Code39: return decodeRow(OneD::Code39Reader(hints));
+#endif
+#ifdef ZXING_READER_CODE93
+	case BarcodeFormat::Code93: return decodeRow(OneD::Code93Reader(hints));
+#endif
+#ifdef ZXING_READER_CODE128
+	case BarcodeFormat::Code128: return decodeRow(OneD::Code128Reader(hints));
+#endif
+#ifdef ZXING_READER_ITF
+	case BarcodeFormat::ITF: return decodeRow(OneD::ITFReader(hints));
+#endif
+#ifdef ZXING_READER_UPCEAN
+	case BarcodeFormat::EAN8:
+	case BarcodeFormat::EAN13:
+	case BarcodeFormat::UPCA:
+	case BarcodeFormat::UPCE: return decodeRow(OneD::MultiUPCEANReader(hints));
+#endif
+	default: throw std::invalid_argument(std::string("Unsupported format: ") + ToString(format));
+	}
+}
+
+bool VerifyModules(const BitMatrix& modules, BarcodeFormat format, std::string_view expected)
+{
+	auto res = DecodeModules(modules, format);
+	return res.isValid() && res.text(TextMode::Plain) == expected;
+}
+
+// The layout of SerializeModules(): magic "ZXM", version, then LEB128 varints for the format, the flags, the module grid
+// width and height and the zig-zag encoded corner coordinates, followed by the modules row by row, 8 per byte (MSB first)
+static constexpr uint8_t MODULES_VERSION = 1;
+static constexpr int MODULES_MAX_SIZE = 1024; // larger than any supported symbol, limits the allocation of malformed data
+
+static constexpr uint32_t MODULES_INVERTED = 1 << 0;
+static constexpr uint32_t MODULES_MIRRORED = 1 << 1;
+
+static void PutVarint(ByteArray& out, uint32_t v)
+{
+	for (; v >= 0x80; v >>= 7)
+		out.push_back(static_cast<uint8_t>(v | 0x80));
+	out.push_back(static_cast<uint8_t>(v));
+}
+
+static uint32_t GetVarint(const ByteArray& in, size_t& pos)
+{
+	uint32_t v = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (pos >= in.size())
+			throw std::invalid_argument("Truncated module data");
+		v |= uint32_t(in[pos] & 0x7f) << shift;
+		if (!(in[pos++] & 0x80))
+			return v;
+	}
+	throw std::invalid_argument("Invalid varint in module data");
+}
+
+ByteArray SerializeModules(const Result& detected)
+{
+	const auto* modules = detected.modules();
+	if (!modules)
+		throw std::invalid_argument("Result has no modules");
+
+	ByteArray res = {'Z', 'X', 'M', MODULES_VERSION};
+	PutVarint(res, static_cast<uint32_t>(detected.format()));
+	PutVarint(res, (detected.isInverted() ? MODULES_INVERTED : 0) | (detected.isMirrored() ? MODULES_MIRRORED : 0));
+	PutVarint(res, modules->width());
+	PutVarint(res, modules->height());
+	for (auto p : detected.position())
+		for (int v : {p.x, p.y})
+			PutVarint(res, (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31));
+
+	size_t bits = res.size() * 8;
+	res.resize(res.size() + (modules->width() * modules->height() + 7) / 8);
+	for (int y = 0; y < modules->height(); ++y)
+		for (int x = 0; x < modules->width(); ++x, ++bits)
+			if (modules->get(x, y))
+				res[bits / 8] |= 0x80 >> (bits % 8);
+	return res;
+}
+
+Result DeserializeModules(const ByteArray& data)
+{
+	if (data.size() < 4 || data.asString(0, 3) != "ZXM")
+		throw std::invalid_argument("Not a module data record");
+	if (data[3] != MODULES_VERSION)
+		throw std::invalid_argument("Unsupported module data version " + std::to_string(data[3]));
+
+	size_t pos = 4;
+	uint32_t formatBits = GetVarint(data, pos);
+	auto format = static_cast<BarcodeFormat>(formatBits);
+	if (!formatBits || (formatBits & (formatBits - 1)) || !BarcodeFormats(BarcodeFormat::Any).testFlag(format))
+		throw std::invalid_argument("Invalid format in module data");
+	uint32_t flags = GetVarint(data, pos);
+	uint32_t width = GetVarint(data, pos), height = GetVarint(data, pos);
+	if (width == 0 || height == 0 || width > MODULES_MAX_SIZE || height > MODULES_MAX_SIZE)
+		throw std::invalid_argument("Invalid module grid size");
+	Position position;
+	for (auto& p : position)
+		for (int* v : {&p.x, &p.y}) {
+			uint32_t z = GetVarint(data, pos);
+			*v = static_cast<int>(z >> 1) ^ -static_cast<int>(z & 1);
+		}
+	if (data.size() - pos != (width * height + 7) / 8)
+		throw std::invalid_argument("Truncated module data");
+
+	auto modules = std::make_shared<BitMatrix>(width, height);
+	size_t bits = pos * 8;
+	for (int y = 0; y < modules->height(); ++y)
+		for (int x = 0; x < modules->width(); ++x, ++bits)
+			if (data[bits / 8] & (0x80 >> (bits % 8)))
+				modules->set(x, y);
+
+	Result res(std::move(position), format, std::move(modules));
+	res._isInverted = flags & MODULES_INVERTED;
+	res._isMirrored = flags & MODULES_MIRRORED;
+	return res;
+}
+
+Result DecodeModules(const Result& detected)
+{
+	if (!detected.modules())
+		throw std::invalid_argument("Result has no modules");
+
+	auto res = DecodeModules(*detected.modules(), detected.format());
+	res._position = detected.position();
+	res._isInverted = detected.isInverted();
+	res._isMirrored = res.isMirrored() || detected.isMirrored();
+	return res;
+}
+
 } // ZXing
@@ -9,8 +9,41 @@
 #include "ImageView.h"
 #include "Result.h"
 
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
 namespace ZXing {
 
+class BitMatrix;
+class Executor;
+
+/**
+ * Source of the rows of an image that is too large to be kept in memory as a whole, e.g. the strips of a scanned
+ * document as they come from a TIFF decoder or the scanner itself, see ReadBarcodes(ImageRowSource&, ...).
+ *
+ * The rows are pulled strictly top to bottom, every row exactly once.
+ */
+class ImageRowSource
+{
+public:
+	virtual ~ImageRowSource() = default;
+
+	virtual int width() const = 0;
+	virtual ImageFormat format() const = 0;
+
+	/**
+	 * Copy the next rows of the image to dst
+	 *
+	 * @param dst  destination of the first row, the pixels are laid out as described by format()
+	 * @param rowStride  distance of the rows in dst in bytes
+	 * @param maxRows  maximum number of rows to copy
+	 * @return number of rows copied, 0 if the end of the image is reached
+	 */
+	virtual int readRows(uint8_t* dst, int rowStride, int maxRows) = 0;
+};
+
 /**
  * Read barcode from an ImageView
  *
@@ -29,5 +62,222 @@ Result ReadBarcode(const ImageView& buffer, const DecodeHints& hints = {});
  */
 Results ReadBarcodes(const ImageView& buffer, const DecodeHints& hints = {});
 
+/**
+ * Called for each Result as soon as it is found, see ReadBarcodes(const ImageView&, const DecodeHints&, const ResultCallback&).
+ * Returning false stops the search.
+ */
+using ResultCallback = std::function<bool(const Result&)>;
+
+/**
+ * Read barcodes from an ImageView and pass each one to a callback as soon as it is found, see
+ * BarcodeReader::read(const ImageView&, const ResultCallback&)
+ *
+ * @param buffer  view of the image data including layout and format
+ * @param hints  DecodeHints to parameterize / speed up decoding
+ * @param onResult  called for each new Result, returns false to stop the search
+ * @return #Results list of the results passed to onResult
+ */
+// WARNING: this API is experimental and may change/disappear
+Results ReadBarcodes(const ImageView& buffer, const DecodeHints& hints, const ResultCallback& onResult);
+
+/**
+ * Read barcodes from a list of ImageViews
+ *
+ * This amortizes the setup cost of the reader graph and the scratch buffers over all images, which dominates for
+ * small images. If an Executor is available (see DecodeHints::threads() and DecodeHints::executor()) the images
+ * are distributed over the available threads, each image itself is then processed sequentially.
+ *
+ * @param buffers  list of views of the image data including layout and format
+ * @param hints  optional DecodeHints to parameterize / speed up decoding
+ * @return list of #Results, one for each input image (in the same order)
+ */
+std::vector<Results> ReadBarcodes(const std::vector<ImageView>& buffers, const DecodeHints& hints = {});
+
+/**
+ * Read barcodes from an ImageView and its downscaled versions, see BarcodeReader::read(const ImageView&, const std::vector<ImageView>&)
+ *
+ * @param buffer  view of the full resolution image data including layout and format
+ * @param downscaled  views of the same image at lower resolutions, ordered by decreasing size
+ * @param hints  optional DecodeHints to parameterize / speed up decoding
+ * @return #Results list of results found, may be empty
+ */
+Results ReadBarcodes(const ImageView& buffer, const std::vector<ImageView>& downscaled, const DecodeHints& hints = {});
+
+/**
+ * Read barcodes from an image provided row by row, see BarcodeReader::read(ImageRowSource&)
+ *
+ * @param source  the rows of the image
+ * @param hints  optional DecodeHints to parameterize / speed up decoding
+ * @return #Results list of results found, may be empty
+ */
+Results ReadBarcodes(ImageRowSource& source, const DecodeHints& hints = {});
+
+/**
+ * Decode a symbol from its module matrix, e.g. as returned by MultiFormatWriter::encodeModules()
+ *
+ * The modules are decoded directly, without binarization and detection, which makes this a cheap way to check the
+ * output of a writer before it gets printed. The symbol has to be upright and without quiet zone. Linear symbols
+ * consist of a single row, the rows of a PDF417 symbol may be any number of modules high.
+ *
+ * @param modules  one bit per module, set for the dark ones
+ * @param format  the format of the symbol, all formats that can be written are supported
+ * @return #Result structure, invalid if the modules could not be decoded
+ */
+Result DecodeModules(const BitMatrix& modules, BarcodeFormat format);
+
+/**
+ * Check that a module matrix decodes to the expected text, see DecodeModules()
+ *
+ * @param expected  the content as passed to the writer, compared with the text rendered with TextMode::Plain
+ */
+bool VerifyModules(const BitMatrix& modules, BarcodeFormat format, std::string_view expected);
+
+/**
+ * Serialize a located but not decoded symbol (see DecodeHints::detectOnly() and Result::modules()) into a compact,
+ * versioned binary representation, e.g. to detect the symbols on an edge device and decode them elsewhere with
+ * DecodeModules(DeserializeModules(data)). Contains the format, the position, the inverted and mirrored flags and
+ * the module grid with one bit per module, i.e. a few hundred bytes for typical symbols.
+ *
+ * @throw std::invalid_argument if the result has no modules
+ */
+ByteArray SerializeModules(const Result& detected);
+
+/**
+ * Restore a Result serialized with SerializeModules()
+ *
+ * @throw std::invalid_argument if the data is malformed or of an unsupported version
+ */
+Result DeserializeModules(const ByteArray& data);
+
+/**
+ * Decode a located but not decoded symbol from its modules, see Result::modules(). Unlike DecodeModules(const
+ * BitMatrix&, BarcodeFormat), the result keeps the position and the inverted flag of the detected one.
+ *
+ * @throw std::invalid_argument if the result has no modules
+ */
+Result DecodeModules(const Result& detected);
+
+/**
+ * Stateful barcode reader meant to be used repeatedly, e.g. on the frames of a video stream.
+ *
+ * In contrast to the free ReadBarcodes() function, the reader graph (MultiFormatReader and all the
+ * per-format readers) is constructed only once and the internal luminance and pyramid buffers are
+ * recycled between calls. Processing a sequence of equally sized images therefore does not need to
+ * reallocate those buffers. With DecodeHints::trackSymbols() set, the symbols found in the last image are looked for
+ * at their previous position first and every Result gets a trackId() that stays the same for a symbol across
+ * consecutive images (see trackEvents()).
+ *
+ * A BarcodeReader instance is not thread-safe, use one instance per thread. See DecodeHints::threads() and
+ * DecodeHints::executor() for letting a single read() call use multiple threads internally.
+ */
+class BarcodeReader
+{
+	struct State;
+	std::unique_ptr<State> _state;
+
+	Results readTracked(const ImageView& buffer);
+	Results readRegions(const ImageView& buffer);
+	Results readTiles(const ImageView& buffer);
+	Results readImage(const ImageView& buffer);
+	Results readParallel(Executor& executor);
+	void updateTracks(Results& results);
+
+public:
+	/// Number of consecutive read() calls a tracked symbol may be missing before it is considered gone
+	static constexpr int TrackTimeout = 3;
+
+	struct TrackEvent
+	{
+		enum class Type { Enter, Leave };
+
+		Type type;
+		Result result; ///< the Result of the read() that found the symbol first / last
+	};
+
+	/**
+	 * @param hints  DecodeHints used for all subsequent read() calls (the object keeps a copy)
+	 */
+	explicit BarcodeReader(const DecodeHints& hints = {});
+	~BarcodeReader();
+
+	BarcodeReader(BarcodeReader&&) noexcept;
+	BarcodeReader& operator=(BarcodeReader&&) noexcept;
+
+	const DecodeHints& hints() const;
+
+	/**
+	 * Read barcodes from an ImageView
+	 *
+	 * @param buffer  view of the image data including layout and format
+	 * @return #Results list of results found, may be empty
+	 */
+	Results read(const ImageView& buffer);
+
+	/**
+	 * Read barcodes from an ImageView and pass each one to a callback as soon as it is found
+	 *
+	 * A symbol found in an early pass (e.g. a downscaled layer) is delivered while the remaining passes are still
+	 * running, which lets an application react to the first symbol without waiting for the whole search. Each Result
+	 * is passed exactly once and in the order of the returned list. With DecodeHints::regionsOfInterest() or tileSize(),
+	 * the results of a region / tile are passed when it is done. The trackId() is not yet set.
+	 *
+	 * The callback may be called from a thread of the Executor (see DecodeHints::threads()), but never concurrently.
+	 * Returning false stops the search like reaching DecodeHints::maxNumberOfSymbols() does.
+	 *
+	 * @param buffer  view of the image data including layout and format
+	 * @param onResult  called for each new Result, returns false to stop the search
+	 * @return #Results list of the results passed to onResult
+	 */
+	// WARNING: this API is experimental and may change/disappear
+	Results read(const ImageView& buffer, const ResultCallback& onResult);
+
+	/**
+	 * Read barcodes from an ImageView and its downscaled versions
+	 *
+	 * The downscaled images are used as the layers of the image pyramid instead of computing them, e.g. the lower
+	 * resolution streams of the hardware scaler of a camera. The scale factor of a layer is given by its size relative
+	 * to the full resolution image and need not be integral (e.g. 1920x1080 and 1280x720), the positions of the results
+	 * are always in full resolution coordinates. DecodeHints::tryDownscale(), downscaleThreshold() and
+	 * downscaleFactor() do not apply, neither do regionsOfInterest() and tileSize().
+	 *
+	 * @param buffer  view of the full resolution image data including layout and format
+	 * @param downscaled  views of the same image at lower resolutions, ordered by decreasing size
+	 * @return #Results list of results found, may be empty
+	 */
+	// WARNING: this API is experimental and may change/disappear
+	Results read(const ImageView& buffer, const std::vector<ImageView>& downscaled);
+
+	/**
+	 * Read barcodes from an image provided row by row
+	 *
+	 * Only a band of DecodeHints::tileSize() rows (2048 if not set) is kept in memory, consecutive bands overlap by
+	 * DecodeHints::tileOverlap() rows. Each band is read like an image with the same DecodeHints, so with a tileSize()
+	 * the memory needed depends on the width of the image and the tile size only, not on its height. A symbol is found
+	 * if it fits into one band (and tile). The regionsOfInterest(), trackSymbols() and frameChangeThreshold() are
+	 * ignored.
+	 *
+	 * @param source  the rows of the image
+	 * @return #Results list of results found, may be empty
+	 */
+	// WARNING: this API is experimental and may change/disappear
+	Results read(ImageRowSource& source);
+
+	/**
+	 * @brief deadlineExceeded is true if DecodeHints::deadline() had passed when the last read() returned, meaning
+	 * the search may have been stopped prematurely and the results may be incomplete.
+	 */
+	bool deadlineExceeded() const;
+
+	/**
+	 * @brief trackEvents lists the symbols that entered or left the stream with the last read() call, if
+	 * DecodeHints::trackSymbols() is set.
+	 *
+	 * A symbol is matched with the ones of the previous read() calls by its format, its content and overlapping bounding
+	 * boxes, so the application can react to each symbol only once instead of to every Result. A symbol leaves after it
+	 * was not found in TrackTimeout consecutive read() calls (calls that exceeded the deadline are not counted).
+	 */
+	const std::vector<TrackEvent>& trackEvents() const;
+};
+
 } // ZXing
 
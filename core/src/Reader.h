@@ -9,11 +9,28 @@
 #include "DecodeHints.h"
 #include "Result.h"
 
+#include <memory>
+#include <utility>
+
 namespace ZXing {
 
 class BinaryBitmap;
 class DecodeHints;
 
+/**
+ * The symbols a Reader finds in one image, evaluated lazily, see Reader::candidates(). Each call of next() does a
+ * bounded amount of work, typically the sampling and decoding of one detector candidate (or one chunk of them, if the
+ * image has an Executor). This lets MultiFormatReader interleave the readers and stop at the first symbol found.
+ */
+class CandidateStream
+{
+public:
+	virtual ~CandidateStream() = default;
+
+	/// Evaluate the next candidate(s) and append the symbols found to results, returns false if there are none left
+	virtual bool next(Results& results) = 0;
+};
+
 class Reader
 {
 protected:
@@ -26,6 +43,8 @@ public:
 	explicit Reader(DecodeHints&& hints) = delete;
 	virtual ~Reader() = default;
 
+	const DecodeHints& hints() const { return _hints; }
+
 	virtual Result decode(const BinaryBitmap& image) const = 0;
 
 	// WARNING: this API is experimental and may change/disappear
@@ -33,6 +52,33 @@ public:
 		auto res = decode(image);
 		return res.isValid() || (_hints.returnErrors() && res.format() != BarcodeFormat::None) ? Results{std::move(res)} : Results{};
 	}
+
+	// WARNING: this API is experimental and may change/disappear
+	/// The image has to outlive the stream. The default evaluates decode(image, maxSymbols) in a single step.
+	virtual std::unique_ptr<CandidateStream> candidates(const BinaryBitmap& image, int maxSymbols) const
+	{
+		struct SingleStep : CandidateStream
+		{
+			const Reader& reader;
+			const BinaryBitmap& image;
+			int maxSymbols;
+			bool done = false;
+
+			SingleStep(const Reader& reader, const BinaryBitmap& image, int maxSymbols)
+				: reader(reader), image(image), maxSymbols(maxSymbols)
+			{}
+
+			bool next(Results& results) override
+			{
+				if (std::exchange(done, true))
+					return false;
+				for (auto& res : reader.decode(image, maxSymbols))
+					results.push_back(std::move(res));
+				return true;
+			}
+		};
+		return std::make_unique<SingleStep>(*this, image, maxSymbols);
+	}
 };
 
 } // ZXing
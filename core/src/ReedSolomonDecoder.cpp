@@ -7,91 +7,225 @@
 
 #include "ReedSolomonDecoder.h"
 
+#include "CpuFeatures.h"
 #include "GenericGF.h"
+#include "StatsScope.h"
+#include "TraceScope.h"
+#include "ZXAlgorithms.h"
 #include "ZXConfig.h"
 
 #include <algorithm>
-#include <stdexcept>
+#include <cstdint>
 #include <utility>
 
+#if defined(ZX_USE_SSE2)
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace ZXing {
 
-static bool
-RunEuclideanAlgorithm(const GenericGF& field, std::vector<int>&& rCoefs, GenericGFPoly& sigma, GenericGFPoly& omega)
+#if defined(ZX_USE_SSE2) || (defined(ZX_USE_NEON) && defined(__aarch64__))
+#define ZX_REED_SOLOMON_SIMD_SYNDROMES
+
+// Evaluates the 16 interleaved polynomials a_r(y) = sum_k bytes[16 * k + r] * y^(n - 1 - k) at y = c with Horner's
+// scheme, i.e. acc = acc * c + chunk for each 16 byte chunk. The constant multiplication uses the split table approach
+// (as in ISA-L): the products of c with all low and all high nibbles are looked up with a byte shuffle. Without SSSE3
+// the multiplication is done bit by bit: acc * c = sum_b bit_b(acc) * (2^b * c). The variant is selected at runtime.
+using HornerLanesFn = void (*)(const GenericGF& field, const uint8_t* bytes, int numChunks, int c, uint8_t* res);
+
+#if defined(ZX_USE_SSE2)
+ZX_TARGET("ssse3")
+static void HornerLanesSSSE3(const GenericGF& field, const uint8_t* bytes, int numChunks, int c, uint8_t* res)
+{
+	alignas(16) uint8_t lo[16], hi[16];
+	for (int v = 0; v < 16; ++v) {
+		lo[v] = narrow_cast<uint8_t>(field.multiply(v, c));
+		hi[v] = narrow_cast<uint8_t>(field.multiply(v << 4, c));
+	}
+	const __m128i tlo = _mm_load_si128(reinterpret_cast<const __m128i*>(lo));
+	const __m128i thi = _mm_load_si128(reinterpret_cast<const __m128i*>(hi));
+	const __m128i mask = _mm_set1_epi8(0x0f);
+	__m128i acc = _mm_setzero_si128();
+	for (int k = 0; k < numChunks; ++k) {
+		__m128i l = _mm_shuffle_epi8(tlo, _mm_and_si128(acc, mask));
+		__m128i h = _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi16(acc, 4), mask));
+		acc = _mm_xor_si128(_mm_xor_si128(l, h), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 16 * k)));
+	}
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(res), acc);
+}
+
+static void HornerLanesSSE2(const GenericGF& field, const uint8_t* bytes, int numChunks, int c, uint8_t* res)
+{
+	__m128i bits[8], prods[8];
+	for (int b = 0; b < 8; ++b) {
+		bits[b] = _mm_set1_epi8(narrow_cast<char>(1 << b));
+		prods[b] = _mm_set1_epi8(narrow_cast<char>(field.multiply(1 << b, c)));
+	}
+	__m128i acc = _mm_setzero_si128();
+	for (int k = 0; k < numChunks; ++k) {
+		__m128i prod = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 16 * k));
+		for (int b = 0; b < 8; ++b) {
+			__m128i set = _mm_cmpeq_epi8(_mm_and_si128(acc, bits[b]), bits[b]);
+			prod = _mm_xor_si128(prod, _mm_and_si128(set, prods[b]));
+		}
+		acc = prod;
+	}
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(res), acc);
+}
+
+static const Kernel<HornerLanesFn> HornerLanesKernels[] = {{SSSE3, HornerLanesSSSE3}, {0, HornerLanesSSE2}};
+#else
+static void HornerLanesNEON(const GenericGF& field, const uint8_t* bytes, int numChunks, int c, uint8_t* res)
 {
-	int R = Size(rCoefs); // == numECCodeWords
-	GenericGFPoly r(field, std::move(rCoefs));
-	GenericGFPoly& tLast = omega.setField(field);
-	GenericGFPoly& t = sigma.setField(field);
-	ZX_THREAD_LOCAL GenericGFPoly q, rLast;
+	alignas(16) uint8_t lo[16], hi[16];
+	for (int v = 0; v < 16; ++v) {
+		lo[v] = narrow_cast<uint8_t>(field.multiply(v, c));
+		hi[v] = narrow_cast<uint8_t>(field.multiply(v << 4, c));
+	}
+	const uint8x16_t tlo = vld1q_u8(lo), thi = vld1q_u8(hi), mask = vdupq_n_u8(0x0f);
+	uint8x16_t acc = vdupq_n_u8(0);
+	for (int k = 0; k < numChunks; ++k) {
+		uint8x16_t prod = veorq_u8(vqtbl1q_u8(tlo, vandq_u8(acc, mask)), vqtbl1q_u8(thi, vshrq_n_u8(acc, 4)));
+		acc = veorq_u8(prod, vld1q_u8(bytes + 16 * k));
+	}
+	vst1q_u8(res, acc);
+}
 
-	rLast.setField(field);
-	q.setField(field);
+static const Kernel<HornerLanesFn> HornerLanesKernels[] = {{0, HornerLanesNEON}};
+#endif
 
-	rLast.setMonomial(1, R);
-	tLast.setMonomial(0);
-	t.setMonomial(1);
+// Computes the syndromes of a message over a GF(256) field 16 codewords at a time. With x = alpha^(i + b), the message
+// polynomial splits into message(x) = sum_r a_r(x^16) * x^(15 - r), where a_r holds every 16th codeword (see above).
+static bool ComputeSyndromes256(const GenericGF& field, const std::vector<int>& message, std::vector<int>& syndromes)
+{
+	int numECCodeWords = Size(syndromes);
+	int pad = (16 - Size(message) % 16) % 16;
+
+	// leading zeros do not change the value of the polynomial
+	thread_local std::vector<uint8_t> bytes;
+	bytes.assign(pad, 0);
+	for (int v : message) {
+		if (v < 0 || v > 255)
+			return false;
+		bytes.push_back(narrow_cast<uint8_t>(v));
+	}
 
-	// Assume r's degree is < rLast's
-	if (r.degree() >= rLast.degree())
-		swap(r, rLast);
+	const auto hornerLanes = SelectKernel(HornerLanesKernels);
+	for (int i = 0; i < numECCodeWords; i++) {
+		int e = i + field.generatorBase(); // x = alpha^e
+		uint8_t lanes[16];
+		hornerLanes(field, bytes.data(), Size(bytes) / 16, field.exp(16 * e % 255), lanes);
+		int s = 0;
+		for (int r = 0; r < 16; ++r)
+			s ^= field.multiply(lanes[r], field.exp((15 - r) * e % 255));
+		syndromes[numECCodeWords - 1 - i] = s;
+	}
+	return true;
+}
+#endif
 
-	// Run Euclidean algorithm until r's degree is less than R/2
-	while (r.degree() >= R / 2) {
-		swap(tLast, t);
-		swap(rLast, r);
+// Runs the Berlekamp-Massey algorithm on the syndromes S_0..S_R-1 (stored highest index first) and returns the error
+// locator sigma (with sigma(0) = 1) and the error evaluator omega = S * sigma mod x^R.
+static bool
+RunBerlekampMassey(const GenericGF& field, const std::vector<int>& syndromes, GenericGFPoly& sigma, GenericGFPoly& omega)
+{
+	int R = Size(syndromes); // == numECCodeWords
+	auto S = [&](int i) { return syndromes[R - 1 - i]; };
 
-		// Divide rLastLast by rLast, with quotient in q and remainder in r
-		if (rLast.isZero())
-			return false; // Oops, Euclidean algorithm already terminated?
+	// the coefficients of the current (c) and the previous (b) connection polynomial, lowest degree first
+	thread_local std::vector<int> c, b, t;
+	c.assign(R + 1, 0);
+	b.assign(R + 1, 0);
+	c[0] = b[0] = 1;
+	int L = 0, m = 1, lastDiscrepancy = 1;
 
-		r.divide(rLast, q);
+	for (int n = 0; n < R; ++n) {
+		int d = S(n);
+		for (int i = 1; i <= L; ++i)
+			d ^= field.multiply(c[i], S(n - i));
 
-		q.multiply(tLast);
-		q.addOrSubtract(t);
-		swap(t, q); // t = q
+		if (d == 0) {
+			++m;
+			continue;
+		}
 
-		if (r.degree() >= rLast.degree())
-			throw std::runtime_error("Division algorithm failed to reduce polynomial?");
+		int scale = field.multiply(d, field.inverse(lastDiscrepancy));
+		bool lengthChange = 2 * L <= n;
+		if (lengthChange)
+			t = c;
+		for (int i = 0; i + m <= R; ++i)
+			c[i + m] ^= field.multiply(scale, b[i]);
+		if (lengthChange) {
+			L = n + 1 - L;
+			std::swap(b, t);
+			lastDiscrepancy = d;
+			m = 1;
+		} else {
+			++m;
+		}
 	}
 
-	int sigmaTildeAtZero = t.constant();
-	if (sigmaTildeAtZero == 0)
+	// more errors than the code is able to correct
+	if (L == 0 || 2 * L > R)
 		return false;
 
-	int inverse = field.inverse(sigmaTildeAtZero);
-	t.multiplyByMonomial(inverse);
-	r.multiplyByMonomial(inverse);
+	// omega has a degree < L, its coefficients are the convolution of S and sigma
+	t.assign(L, 0);
+	for (int k = 0; k < L; ++k)
+		for (int i = 0; i <= k; ++i)
+			t[k] ^= field.multiply(c[i], S(k - i));
 
-	// sigma is t
-	omega = std::move(r);
+	// GenericGFPoly stores the highest degree first
+	std::reverse(c.begin(), c.begin() + L + 1);
+	sigma = GenericGFPoly(field, c.data(), L + 1);
+	std::reverse(t.begin(), t.end());
+	omega = GenericGFPoly(field, t);
 	return true;
 }
 
-static std::vector<int>
-FindErrorLocations(const GenericGF& field, const GenericGFPoly& errorLocator)
+// Chien search: the roots of sigma are the inverses of the error locations alpha^p, p being the position counted from
+// the end of the message. Only the positions inside the message need to be checked. The terms sigma_j * alpha^(-p*j)
+// are updated with one table lookup each, instead of evaluating the whole polynomial for every p.
+static bool
+FindErrorLocations(const GenericGF& field, const GenericGFPoly& errorLocator, int msgLen, std::vector<int>& res)
 {
-	// This is a direct application of Chien's search
 	int numErrors = errorLocator.degree();
-	std::vector<int> res;
-	res.reserve(numErrors);
+	const auto& coefs = errorLocator.coefficients(); // coefs[numErrors - j] is sigma_j
+	const int order = field.size() - 1;
 
-	for (int i = 1; i < field.size() && Size(res) < numErrors; i++)
-		if (errorLocator.evaluateAt(i) == 0)
-			res.push_back(field.inverse(i));
+	// the terms in the log domain (-1 for a zero coefficient)
+	thread_local std::vector<int> logTerms;
+	logTerms.resize(numErrors + 1);
+	for (int j = 0; j <= numErrors; ++j)
+		logTerms[j] = coefs[numErrors - j] ? field.log(coefs[numErrors - j]) : -1;
 
-	if (Size(res) != numErrors)
-		return {}; // Error locator degree does not match number of roots
+	res.clear();
+	for (int p = 0; p < std::min(msgLen, order) && Size(res) < numErrors; ++p) {
+		int sum = 0;
+		for (int j = 0; j <= numErrors; ++j)
+			if (logTerms[j] >= 0) {
+				sum ^= field.exp(logTerms[j]);
+				// move on to alpha^-(p+1), i.e. multiply by alpha^-j
+				logTerms[j] = (logTerms[j] + order - j % order) % order;
+			}
+		if (sum == 0)
+			res.push_back(field.exp(p));
+	}
 
-	return res;
+	// Error locator degree must match number of roots
+	return numErrors > 0 && Size(res) == numErrors;
 }
 
-static std::vector<int>
-FindErrorMagnitudes(const GenericGF& field, const GenericGFPoly& errorEvaluator, const std::vector<int>& errorLocations)
+static void
+FindErrorMagnitudes(const GenericGF& field, const GenericGFPoly& errorEvaluator, const std::vector<int>& errorLocations,
+					std::vector<int>& res)
 {
 	// This is directly applying Forney's Formula
 	int s = Size(errorLocations);
-	std::vector<int> res(s);
+	res.resize(s);
 	for (int i = 0; i < s; ++i) {
 		int xiInverse = field.inverse(errorLocations[i]);
 		int denom = 1;
@@ -102,42 +236,66 @@ FindErrorMagnitudes(const GenericGF& field, const GenericGFPoly& errorEvaluator,
 		if (field.generatorBase() != 0)
 			res[i] = field.multiply(res[i], xiInverse);
 	}
-	return res;
 }
 
-bool
-ReedSolomonDecode(const GenericGF& field, std::vector<int>& message, int numECCodeWords)
+// returns the number of corrected code words or -1 if the message could not be corrected
+static int CorrectErrors(const GenericGF& field, std::vector<int>& message, int numECCodeWords)
 {
-	GenericGFPoly poly(field, message);
+	// the scratch buffers are reused, so a decode does not touch the heap (see also GenericGFPoly::Coefficients)
+	thread_local std::vector<int> syndromes, errorLocations, errorMagnitudes;
 
-	std::vector<int> syndromes(numECCodeWords);
-	for (int i = 0; i < numECCodeWords; i++)
-		syndromes[numECCodeWords - 1 - i] = poly.evaluateAt(field.exp(i + field.generatorBase()));
+	syndromes.resize(numECCodeWords);
+#ifdef ZX_REED_SOLOMON_SIMD_SYNDROMES
+	if (field.size() != 256 || !ComputeSyndromes256(field, message, syndromes))
+#endif
+	{
+		for (int i = 0; i < numECCodeWords; i++) {
+			// evaluate the message polynomial at alpha^(i + b) with Horner's scheme
+			int x = field.exp(i + field.generatorBase()), s = 0;
+			for (int c : message)
+				s = field.multiply(x, s) ^ c;
+			syndromes[numECCodeWords - 1 - i] = s;
+		}
+	}
 
 	// if all syndromes are 0 there is no error to correct
 	if (std::all_of(syndromes.begin(), syndromes.end(), [](int c) { return c == 0; }))
-		return true;
+		return 0;
 
 	ZX_THREAD_LOCAL GenericGFPoly sigma, omega;
 
-	if (!RunEuclideanAlgorithm(field, std::move(syndromes), sigma, omega))
-		return false;
+	if (!RunBerlekampMassey(field, syndromes, sigma, omega))
+		return -1;
 
-	auto errorLocations = FindErrorLocations(field, sigma);
-	if (errorLocations.empty())
-		return false;
+	int msgLen = Size(message);
+	if (!FindErrorLocations(field, sigma, msgLen, errorLocations))
+		return -1;
 
-	auto errorMagnitudes = FindErrorMagnitudes(field, omega, errorLocations);
+	FindErrorMagnitudes(field, omega, errorLocations, errorMagnitudes);
 
-	int msgLen = Size(message);
 	for (int i = 0; i < Size(errorLocations); ++i) {
 		int position = msgLen - 1 - field.log(errorLocations[i]);
 		if (position < 0)
-			return false;
+			return -1;
 
 		message[position] ^= errorMagnitudes[i];
 	}
-	return true;
+	return Size(errorLocations);
+}
+
+bool
+ReedSolomonDecode(const GenericGF& field, std::vector<int>& message, int numECCodeWords, int* numCorrections)
+{
+	ZX_TRACE_SCOPE("ReedSolomonDecode");
+	StatsScope scope(DecodeStats::Stage::ECC);
+	int corrections = CorrectErrors(field, message, numECCodeWords);
+	if (corrections < 0)
+		CountStat(DecodeStats::Counter::ECFailures);
+	else
+		CountStat(DecodeStats::Counter::ECCorrections, corrections);
+	if (numCorrections && corrections >= 0)
+		*numCorrections = corrections;
+	return corrections >= 0;
 }
 
 } // namespace ZXing
@@ -40,8 +40,9 @@ class GenericGF;
  *
  * @param message data and error-correction/parity codewords
  * @param numECCodeWords number of error-correction code words
+ * @param numCorrections if not null, set to the number of corrected codewords on success
  * @return true iff message errors could successfully be fixed (or there have not been any)
  */
-bool ReedSolomonDecode(const GenericGF& field, std::vector<int>& message, int numECCodeWords);
+bool ReedSolomonDecode(const GenericGF& field, std::vector<int>& message, int numECCodeWords, int* numCorrections = nullptr);
 
 } // ZXing
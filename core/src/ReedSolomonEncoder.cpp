@@ -7,32 +7,58 @@
 #include "ReedSolomonEncoder.h"
 
 #include "GenericGF.h"
+#include "ZXAlgorithms.h"
 
 #include <algorithm>
-#include <iterator>
+#include <cstdint>
+#include <map>
 #include <stdexcept>
+#include <utility>
 
 namespace ZXing {
 
-ReedSolomonEncoder::ReedSolomonEncoder(const GenericGF& field)
-: _field(&field)
+// The coefficients g_1..g_n of the monic generator polynomial x^n + g_1 x^(n-1) + ... + g_n of degree n and, for
+// fields with up to 256 elements, the products of these coefficients with every field element.
+struct ReedSolomonEncoder::Generator
 {
-	_cachedGenerators.push_back(GenericGFPoly(field, { 1 }));
+	std::vector<int> coefficients;
+	std::vector<uint8_t> products; // products[v * n + j] == v * g_(j+1)
+};
+
+// g(x) = (x + a^b)(x + a^(b+1))...(x + a^(b+n-1))
+static std::vector<int> GeneratorCoefficients(const GenericGF& field, int degree)
+{
+	std::vector<int> res(degree + 1, 0); // highest degree first
+	res[0] = 1;
+	for (int d = 0; d < degree; ++d) {
+		int root = field.exp(d + field.generatorBase());
+		for (int j = d + 1; j > 0; --j)
+			res[j] ^= field.multiply(res[j - 1], root);
+	}
+	res.erase(res.begin());
+	return res;
 }
 
-const GenericGFPoly&
-ReedSolomonEncoder::buildGenerator(int degree)
+ReedSolomonEncoder::ReedSolomonEncoder(const GenericGF& field) : _field(&field) {}
+
+const ReedSolomonEncoder::Generator& ReedSolomonEncoder::generator(int degree)
 {
-	int cachedGenSize = Size(_cachedGenerators);
-	if (degree >= cachedGenSize) {
-		GenericGFPoly lastGenerator = _cachedGenerators.back();
-		for (int d = cachedGenSize; d <= degree; d++) {
-			lastGenerator.multiply(GenericGFPoly(*_field, { 1, _field->exp(d - 1 + _field->generatorBase()) }));
-			_cachedGenerators.push_back(lastGenerator);
+	// The generators are shared by all encoders of a thread, so the tables are computed only once per (field, degree)
+	// no matter how many symbols get encoded.
+	thread_local std::map<std::pair<const GenericGF*, int>, Generator> cache;
+
+	auto [i, inserted] = cache.try_emplace({_field, degree});
+	auto& gen = i->second;
+	if (inserted) {
+		gen.coefficients = GeneratorCoefficients(*_field, degree);
+		if (_field->size() <= 256) {
+			gen.products.resize(_field->size() * degree);
+			for (int v = 0; v < _field->size(); ++v)
+				for (int j = 0; j < degree; ++j)
+					gen.products[v * degree + j] = narrow_cast<uint8_t>(_field->multiply(v, gen.coefficients[j]));
 		}
 	}
-
-	return *std::next(_cachedGenerators.begin(), degree);
+	return gen;
 }
 
 void
@@ -41,14 +67,39 @@ ReedSolomonEncoder::encode(std::vector<int>& message, const int numECCodeWords)
 	if (numECCodeWords == 0 || numECCodeWords >= Size(message))
 		throw std::invalid_argument("Invalid number of error correction code words");
 
-	GenericGFPoly info = GenericGFPoly(*_field, std::vector<int>(message.begin(), message.end() - numECCodeWords));
-	info.multiplyByMonomial(1, numECCodeWords);
-	GenericGFPoly _;
-	info.divide(buildGenerator(numECCodeWords), _);
-	auto& coefficients = info.coefficients();
-	int numZeroCoefficients = numECCodeWords - Size(coefficients);
-	std::fill_n(message.end() - numECCodeWords, numZeroCoefficients, 0);
-	std::copy(coefficients.begin(), coefficients.end(), message.end() - numECCodeWords + numZeroCoefficients);
+	const int n = numECCodeWords;
+	const int numDataCodeWords = Size(message) - n;
+	const auto& gen = generator(n);
+
+	// Divide the message by the generator with a linear feedback shift register: for every data code word the
+	// remainder is shifted by one position and the product of the feedback with the generator is added.
+	if (!gen.products.empty()) {
+		// The products of the feedback with all generator coefficients are a row of the precomputed table, so each step
+		// is a plain byte vector xor (which the compiler vectorizes).
+		thread_local std::vector<uint8_t> buffer;
+		buffer.assign(2 * (n + 1), 0);
+		uint8_t* cur = buffer.data();
+		uint8_t* next = cur + n + 1;
+		for (int i = 0; i < numDataCodeWords; ++i) {
+			int feedback = message[i] ^ cur[0];
+			if (feedback < 0 || feedback >= _field->size())
+				throw std::invalid_argument("Invalid code word");
+			const uint8_t* row = gen.products.data() + feedback * n;
+			for (int j = 0; j < n; ++j)
+				next[j] = cur[j + 1] ^ row[j];
+			std::swap(cur, next);
+		}
+		std::copy_n(cur, n, message.end() - n);
+	} else {
+		thread_local std::vector<int> rem;
+		rem.assign(n + 1, 0);
+		for (int i = 0; i < numDataCodeWords; ++i) {
+			int feedback = message[i] ^ rem[0];
+			for (int j = 0; j < n; ++j)
+				rem[j] = rem[j + 1] ^ _field->multiply(feedback, gen.coefficients[j]);
+		}
+		std::copy_n(rem.begin(), n, message.end() - n);
+	}
 }
 
 } // ZXing
@@ -6,13 +6,12 @@
 
 #pragma once
 
-#include "GenericGFPoly.h"
-
-#include <list>
 #include <vector>
 
 namespace ZXing {
 
+class GenericGF;
+
 // public only for testing purposes
 class ReedSolomonEncoder
 {
@@ -22,10 +21,11 @@ public:
 	void encode(std::vector<int>& message, int numECCodeWords);
 
 private:
+	struct Generator;
+
 	const GenericGF* _field;
-	std::list<GenericGFPoly> _cachedGenerators;
 
-	const GenericGFPoly& buildGenerator(int degree);
+	const Generator& generator(int degree);
 };
 
 /**
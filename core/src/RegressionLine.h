@@ -22,22 +22,46 @@ namespace ZXing {
 class RegressionLine
 {
 protected:
+	/**
+	 * The moments (count, sums of x, y, x², xy and y²) of a set of points. They are accumulated relative to an origin
+	 * close to the points (the first one added), to keep the squares small and the variances numerically stable.
+	 */
+	struct Moments
+	{
+		PointF origin;
+		int n = 0;
+		PointF::value_t x = 0, y = 0, xx = 0, xy = 0, yy = 0;
+
+		void add(PointF p, int sign = 1)
+		{
+			if (n == 0 && sign > 0)
+				origin = p;
+			auto d = p - origin;
+			n += sign;
+			x += sign * d.x;
+			y += sign * d.y;
+			xx += sign * d.x * d.x;
+			xy += sign * d.x * d.y;
+			yy += sign * d.y * d.y;
+		}
+		void sub(PointF p) { add(p, -1); }
+		PointF mean() const { return origin + PointF(x, y) / n; }
+	};
+
 	std::vector<PointF> _points;
+	Moments _moments; // of _points, updated incrementally
+	std::vector<bool> _outlier; // scratch buffer of evaluate(maxSignedDist), kept to not allocate on every call
 	PointF _directionInward;
 	PointF::value_t a = NAN, b = NAN, c = NAN;
 
 	friend PointF intersect(const RegressionLine& l1, const RegressionLine& l2);
 
-	template<typename T> bool evaluate(const PointT<T>* begin, const PointT<T>* end)
+	bool evaluate(const Moments& m)
 	{
-		auto mean = std::accumulate(begin, end, PointF()) / std::distance(begin, end);
-		PointF::value_t sumXX = 0, sumYY = 0, sumXY = 0;
-		for (auto p = begin; p != end; ++p) {
-			auto d = *p - mean;
-			sumXX += d.x * d.x;
-			sumYY += d.y * d.y;
-			sumXY += d.x * d.y;
-		}
+		// the (co)variances of the points around their mean
+		auto sumXX = m.xx - m.x * m.x / m.n;
+		auto sumYY = m.yy - m.y * m.y / m.n;
+		auto sumXY = m.xy - m.x * m.y / m.n;
 		if (sumYY >= sumXX) {
 			auto l = std::sqrt(sumYY * sumYY + sumXY * sumXY);
 			a = +sumYY / l;
@@ -51,11 +75,17 @@ protected:
 			a = -a;
 			b = -b;
 		}
-		c = dot(normal(), mean); // (a*mean.x + b*mean.y);
+		c = dot(normal(), m.mean()); // (a*mean.x + b*mean.y);
 		return dot(_directionInward, normal()) > 0.5f; // angle between original and new direction is at most 60 degree
 	}
 
-	template <typename T> bool evaluate(const std::vector<PointT<T>>& points) { return evaluate(&points.front(), &points.back() + 1); }
+	template<typename T> bool evaluate(const PointT<T>* begin, const PointT<T>* end)
+	{
+		Moments m;
+		for (auto p = begin; p != end; ++p)
+			m.add(PointF(*p));
+		return evaluate(m);
+	}
 
 	template <typename T> static auto distance(PointT<T> a, PointT<T> b) { return ZXing::distance(a, b); }
 
@@ -64,7 +94,8 @@ public:
 
 	template<typename T> RegressionLine(PointT<T> a, PointT<T> b)
 	{
-		evaluate(std::vector{a, b});
+		const PointT<T> points[] = {a, b};
+		evaluate(std::begin(points), std::end(points));
 	}
 
 	template<typename T> RegressionLine(const PointT<T>* b, const PointT<T>* e)
@@ -79,11 +110,12 @@ public:
 	auto signedDistance(PointF p) const { return dot(normal(), p) - c; }
 	template <typename T> auto distance(PointT<T> p) const { return std::abs(signedDistance(PointF(p))); }
 	PointF project(PointF p) const { return p - signedDistance(p) * normal(); }
-	PointF centroid() const { return std::accumulate(_points.begin(), _points.end(), PointF()) / _points.size(); }
+	PointF centroid() const { return _moments.mean(); }
 
 	void reset()
 	{
 		_points.clear();
+		_moments = {};
 		_directionInward = {};
 		a = b = c = NAN;
 	}
@@ -91,13 +123,19 @@ public:
 	void add(PointF p) {
 		assert(_directionInward != PointF());
 		_points.push_back(p);
+		_moments.add(p);
 		if (_points.size() == 1)
 			c = dot(normal(), p);
 	}
 
-	void pop_back() { _points.pop_back(); }
+	void pop_back()
+	{
+		_moments.sub(_points.back());
+		_points.pop_back();
+	}
 	void pop_front()
 	{
+		_moments.sub(_points.front());
 		std::rotate(_points.begin(), _points.begin() + 1, _points.end());
 		_points.pop_back();
 	}
@@ -106,30 +144,42 @@ public:
 
 	bool evaluate(double maxSignedDist = -1, bool updatePoints = false)
 	{
-		bool ret = evaluate(_points);
+		bool ret = evaluate(_moments);
 		if (maxSignedDist > 0) {
-			auto points = _points;
+			// instead of copying the points, the outliers are flagged and subtracted from a copy of the moments
+			auto m = _moments;
+			_outlier.assign(_points.size(), false);
 			while (true) {
-				auto old_points_size = points.size();
+				auto old_n = m.n;
 				// remove points that are further 'inside' than maxSignedDist or further 'outside' than 2 x maxSignedDist
-				auto end = std::remove_if(points.begin(), points.end(), [this, maxSignedDist](auto p) {
-					auto sd = this->signedDistance(p);
-					return sd > maxSignedDist || sd < -2 * maxSignedDist;
-				});
-				points.erase(end, points.end());
+				for (size_t i = 0; i < _points.size(); ++i) {
+					if (_outlier[i])
+						continue;
+					auto sd = signedDistance(_points[i]);
+					if (sd > maxSignedDist || sd < -2 * maxSignedDist) {
+						_outlier[i] = true;
+						m.sub(_points[i]);
+					}
+				}
 				// if we threw away too many points, something is off with the line to begin with
-				if (points.size() < old_points_size / 2 || points.size() < 2)
+				if (m.n < old_n / 2 || m.n < 2)
 					return false;
-				if (old_points_size == points.size())
+				if (old_n == m.n)
 					break;
 #ifdef PRINT_DEBUG
-				printf("removed %zu points -> %zu remaining\n", old_points_size - points.size(), points.size());
+				printf("removed %d points -> %d remaining\n", old_n - m.n, m.n);
 #endif
-				ret = evaluate(points);
+				ret = evaluate(m);
 			}
 
-			if (updatePoints)
-				_points = std::move(points);
+			if (updatePoints && m.n != Size(_points)) {
+				size_t j = 0;
+				for (size_t i = 0; i < _points.size(); ++i)
+					if (!_outlier[i])
+						_points[j++] = _points[i];
+				_points.resize(j);
+				_moments = m;
+			}
 		}
 		return ret;
 	}
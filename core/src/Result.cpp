@@ -10,13 +10,17 @@
 #include "TextDecoder.h"
 #include "ZXAlgorithms.h"
 
+#include <algorithm>
 #include <cmath>
-#include <list>
 #include <map>
+#include <type_traits>
 #include <utility>
 
 namespace ZXing {
 
+// otherwise a growing std::vector<Result> (e.g. while merging the results of multiple readers) copies instead of moves
+static_assert(std::is_nothrow_move_constructible_v<Result>);
+
 Result::Result(const std::string& text, int y, int xStart, int xStop, BarcodeFormat format, SymbologyIdentifier si, Error error, bool readerInit)
 	: _content({ByteArray(text)}, si),
 	  _error(error),
@@ -32,6 +36,7 @@ Result::Result(DecoderResult&& decodeResult, Position&& position, BarcodeFormat
 	  _sai(decodeResult.structuredAppend()),
 	  _format(format),
 	  _lineCount(decodeResult.lineCount()),
+	  _ecUsage(decodeResult.ecUsage()),
 	  _isMirrored(decodeResult.isMirrored()),
 	  _readerInit(decodeResult.readerInit())
 {
@@ -42,9 +47,23 @@ Result::Result(DecoderResult&& decodeResult, Position&& position, BarcodeFormat
 	// TODO: add type opaque and code specific 'extra data'? (see DecoderResult::extra())
 }
 
+Result::Result(Position&& position, BarcodeFormat format, std::shared_ptr<const BitMatrix> modules)
+	: _position(std::move(position)), _modules(std::move(modules)), _format(format), _isDetectOnly(true)
+{}
+
 bool Result::isValid() const
 {
-	return format() != BarcodeFormat::None && _content.symbology.code != 0 && !error();
+	return format() != BarcodeFormat::None && (_content.symbology.code != 0 || _isDetectOnly) && !error();
+}
+
+float Result::confidence() const
+{
+	if (!isValid() || _isDetectOnly)
+		return 0;
+	if (_ecUsage >= 0)
+		return 1 - _ecUsage / 2;
+	float lines = std::max(1, _lineCount);
+	return lines / (lines + 1);
 }
 
 const ByteArray& Result::bytes() const
@@ -59,12 +78,18 @@ ByteArray Result::bytesECI() const
 
 std::string Result::text(TextMode mode) const
 {
+	if (_hasText && mode == _textMode)
+		return _text;
 	return _content.text(mode);
 }
 
-std::string Result::text() const
+const std::string& Result::text() const
 {
-	return text(_decodeHints.textMode());
+	if (!_hasText) {
+		_text = _content.text(_textMode);
+		_hasText = true;
+	}
+	return _text;
 }
 
 std::string Result::ecLevel() const
@@ -77,6 +102,13 @@ ContentType Result::contentType() const
 	return _content.type();
 }
 
+std::vector<GS1Element> Result::gs1Elements() const
+{
+	if (contentType() != ContentType::GS1)
+		return {};
+	return ParseGS1({reinterpret_cast<const char*>(bytes().data()), bytes().size()});
+}
+
 bool Result::hasECI() const
 {
 	return _content.hasECI;
@@ -113,11 +145,12 @@ std::string Result::version() const
 	return _version;
 }
 
-Result& Result::setDecodeHints(DecodeHints hints)
+Result& Result::setDecodeHints(const DecodeHints& hints)
 {
 	if (hints.characterSet() != CharacterSet::Unknown)
 		_content.defaultCharset = hints.characterSet();
-	_decodeHints = hints;
+	_textMode = hints.textMode();
+	_hasText = false;
 	return *this;
 }
 
@@ -155,40 +188,53 @@ bool Result::operator==(const Result& o) const
 	return std::min(dTop, dBot) < length / 2 && dLength < length / 5;
 }
 
-Result MergeStructuredAppendSequence(const Results& results)
+// only the first symbol of the sequence gets copied, the content of the others is appended to it
+Result Result::MergeSequence(std::vector<const Result*>&& sequence)
 {
-	if (results.empty())
+	if (sequence.empty())
 		return {};
 
-	std::list<Result> allResults(results.begin(), results.end());
-	allResults.sort([](const Result& r1, const Result& r2) { return r1.sequenceIndex() < r2.sequenceIndex(); });
+	std::stable_sort(sequence.begin(), sequence.end(),
+					 [](const Result* r1, const Result* r2) { return r1->sequenceIndex() < r2->sequenceIndex(); });
 
-	Result res = allResults.front();
-	for (auto i = std::next(allResults.begin()); i != allResults.end(); ++i)
-		res._content.append(i->_content);
+	Result res = *sequence.front();
+	for (auto i = std::next(sequence.begin()); i != sequence.end(); ++i) {
+		res._content.append((*i)->_content);
+		res._ecUsage = std::max(res._ecUsage, (*i)->_ecUsage);
+	}
+	res._hasText = false;
 
 	res._position = {};
 	res._sai.index = -1;
 
-	if (allResults.back().sequenceSize() != Size(allResults) ||
-		!std::all_of(allResults.begin(), allResults.end(),
-					 [&](Result& it) { return it.sequenceId() == allResults.front().sequenceId(); }))
+	if (sequence.back()->sequenceSize() != Size(sequence) ||
+		!std::all_of(sequence.begin(), sequence.end(),
+					 [&](const Result* it) { return it->sequenceId() == sequence.front()->sequenceId(); }))
 		res._error = FormatError("sequenceIDs not matching during structured append sequence merging");
 
 	return res;
 }
 
+Result MergeStructuredAppendSequence(const Results& results)
+{
+	std::vector<const Result*> sequence;
+	sequence.reserve(results.size());
+	for (auto& res : results)
+		sequence.push_back(&res);
+	return Result::MergeSequence(std::move(sequence));
+}
+
 Results MergeStructuredAppendSequences(const Results& results)
 {
-	std::map<std::string, Results> sas;
+	std::map<std::string, std::vector<const Result*>> sas;
 	for (auto& res : results) {
 		if (res.isPartOfSequence())
-			sas[res.sequenceId()].push_back(res);
+			sas[res.sequenceId()].push_back(&res);
 	}
 
 	Results saiResults;
 	for (auto& [id, seq] : sas) {
-		auto res = MergeStructuredAppendSequence(seq);
+		auto res = Result::MergeSequence(std::move(seq));
 		if (res.isValid())
 			saiResults.push_back(std::move(res));
 	}
@@ -12,14 +12,17 @@
 #include "Content.h"
 #include "DecodeHints.h"
 #include "Error.h"
+#include "HRI.h"
 #include "Quadrilateral.h"
 #include "StructuredAppend.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace ZXing {
 
+class BitMatrix;
 class DecoderResult;
 class ImageView;
 
@@ -31,11 +34,16 @@ using Position = QuadrilateralI;
 class Result
 {
 	void setIsInverted(bool v) { _isInverted = v; }
-	Result& setDecodeHints(DecodeHints hints);
+	Result& setDecodeHints(const DecodeHints& hints);
+	static Result MergeSequence(std::vector<const Result*>&& sequence);
 
 	friend Result MergeStructuredAppendSequence(const std::vector<Result>& results);
-	friend std::vector<Result> ReadBarcodes(const ImageView&, const DecodeHints&);
-	friend void IncrementLineCount(Result&);
+	friend std::vector<Result> MergeStructuredAppendSequences(const std::vector<Result>& results);
+	friend class BarcodeReader;
+	friend class StructuredAppendAssembler;
+	friend void IncrementLineCount(Result&, int);
+	friend Result DeserializeModules(const ByteArray& data);
+	friend Result DecodeModules(const Result& detected);
 
 public:
 	Result() = default;
@@ -46,6 +54,9 @@ public:
 
 	Result(DecoderResult&& decodeResult, Position&& position, BarcodeFormat format);
 
+	// located but not decoded symbol, see DecodeHints::detectOnly()
+	Result(Position&& position, BarcodeFormat format, std::shared_ptr<const BitMatrix> modules = nullptr);
+
 	bool isValid() const;
 
 	const Error& error() const { return _error; }
@@ -69,8 +80,11 @@ public:
 
 	/**
 	 * @brief text returns the bytes() content rendered to unicode/utf8 text accoring to the TextMode set in the DecodingHints
+	 *
+	 * The text is rendered on first access and cached, so repeated calls neither allocate nor convert again. Note: the
+	 * first call modifies the cache, so it must not happen concurrently on the same Result object.
 	 */
-	std::string text() const;
+	const std::string& text() const;
 
 	/**
 	 * @brief ecLevel returns the error correction level of the symbol (empty string if not applicable)
@@ -82,6 +96,14 @@ public:
 	 */
 	ContentType contentType() const;
 
+	/**
+	 * @brief gs1Elements splits GS1 content into its (AI, value) element strings, see ParseGS1()
+	 *
+	 * The views point into bytes(), i.e. they are only valid as long as this Result object. The list is empty if the
+	 * contentType() is not GS1 or the content is not a valid GS1 message.
+	 */
+	std::vector<GS1Element> gs1Elements() const;
+
 	/**
 	 * @brief hasECI specifies wheter or not an ECI tag was found
 	 */
@@ -146,26 +168,60 @@ public:
 	 */
 	int lineCount() const { return _lineCount; }
 
+	/**
+	 * @brief confidence a heuristic estimate (0..1) of how likely the content is read correctly, e.g. to rank results
+	 *
+	 * For symbologies with error correction it is 1 if no codeword needed correcting and 0.5 if the whole correction
+	 * capacity of a block was used up, for the linear ones it grows with the lineCount() (1 line: 0.5, 3 lines: 0.75).
+	 * It is 0 for invalid and detect only results. See also DecodeHints::minConfidence().
+	 */
+	float confidence() const;
+
 	/**
 	 * @brief version QRCode / DataMatrix / Aztec version or size.
 	 */
 	std::string version() const;
 
+	/**
+	 * @brief trackId stable id of the symbol across the read() calls of a BarcodeReader, see DecodeHints::trackSymbols()
+	 *
+	 * The ids start at 1 for each BarcodeReader, 0 means the symbol is not tracked.
+	 */
+	int trackId() const { return _trackId; }
+
+	/**
+	 * @brief isDetectOnly is set if the symbol was only located, i.e. there is no content (see DecodeHints::detectOnly)
+	 */
+	bool isDetectOnly() const { return _isDetectOnly; }
+
+	/**
+	 * @brief modules the module grid sampled from the image for a located but not decoded symbol (upright, set bits
+	 * are the dark modules), nullptr if not available. Currently provided by the Aztec, DataMatrix, QRCode and
+	 * MicroQRCode readers, see SerializeModules() and DecodeModules().
+	 */
+	const BitMatrix* modules() const { return _modules.get(); }
+
 	bool operator==(const Result& o) const;
 
 private:
 	Content _content;
 	Error _error;
 	Position _position;
-	DecodeHints _decodeHints;
 	StructuredAppendInfo _sai;
+	std::shared_ptr<const BitMatrix> _modules; // only for detect only results, see modules()
+	mutable std::string _text; // cached text(), rendered with _textMode
 	BarcodeFormat _format = BarcodeFormat::None;
+	int _lineCount = 0;
+	int _trackId = 0;
+	float _ecUsage = -1; // see DecoderResult::ecUsage()
 	char _ecLevel[4] = {};
 	char _version[4] = {};
-	int _lineCount = 0;
+	TextMode _textMode = TextMode::HRI; // the only part of the DecodeHints a Result depends on (see setDecodeHints)
+	mutable bool _hasText = false;
 	bool _isMirrored = false;
 	bool _isInverted = false;
 	bool _readerInit = false;
+	bool _isDetectOnly = false;
 };
 
 using Results = std::vector<Result>;
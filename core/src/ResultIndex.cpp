@@ -0,0 +1,74 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ResultIndex.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace ZXing {
+
+std::size_t ResultIndex::Hash(const Result& r)
+{
+	const auto& bytes = r.bytes();
+	auto h = std::hash<std::string_view>()({reinterpret_cast<const char*>(bytes.data()), bytes.size()});
+	return h ^ (static_cast<std::size_t>(r.format()) * 0x9e3779b9u);
+}
+
+bool ResultIndex::IsWildcard(const Result& r)
+{
+	// see Result::operator==, matrix codes are equal to an invalid one of the same format regardless of their bytes
+	return !BarcodeFormats(BarcodeFormat::LinearCodes).testFlag(r.format()) && !r.isValid();
+}
+
+void ResultIndex::add(const Result& r)
+{
+	(IsWildcard(r) ? _wildcards : _buckets[Hash(r)]).push_back(_size++);
+}
+
+std::vector<std::pair<int, int>> IntersectingBoundingBoxes(const Results& results)
+{
+	const int n = Size(results);
+	std::vector<std::pair<int, int>> res;
+	if (n < 2)
+		return res;
+
+	std::vector<Position> boxes;
+	boxes.reserve(n);
+	PointI min(INT_MAX, INT_MAX);
+	int64_t extent = 0;
+	for (const auto& r : results) {
+		auto bb = BoundingBox(r.position());
+		min = {std::min(min.x, bb.topLeft().x), std::min(min.y, bb.topLeft().y)};
+		extent += std::max(bb.bottomRight().x - bb.topLeft().x, bb.bottomRight().y - bb.topLeft().y);
+		boxes.push_back(bb);
+	}
+
+	// the bounding box test is inclusive, so are the cell ranges: boxes that touch share at least one cell
+	const int cellSize = static_cast<int>(std::max<int64_t>(16, extent / n));
+	auto cell = [&](PointI p) { return PointI((p.x - min.x) / cellSize, (p.y - min.y) / cellSize); };
+
+	std::unordered_map<uint64_t, std::vector<int>> grid;
+	std::vector<int> lastTested(n, -1); // lastTested[i] == j: box i has been compared with box j already
+	for (int j = 0; j < n; ++j) {
+		auto c0 = cell(boxes[j].topLeft()), c1 = cell(boxes[j].bottomRight());
+		for (int y = c0.y; y <= c1.y; ++y)
+			for (int x = c0.x; x <= c1.x; ++x) {
+				auto& cellBoxes = grid[(uint64_t(uint32_t(y)) << 32) | uint32_t(x)];
+				for (int i : cellBoxes)
+					if (std::exchange(lastTested[i], j) != j && HaveIntersectingBoundingBoxes(boxes[i], boxes[j]))
+						res.emplace_back(i, j);
+				cellBoxes.push_back(j);
+			}
+	}
+
+	std::sort(res.begin(), res.end());
+	return res;
+}
+
+} // ZXing
@@ -0,0 +1,84 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Result.h"
+#include "ZXAlgorithms.h"
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ZXing {
+
+/**
+ * Index over a growing list of Results to find the first one that equals a new Result (see Result::operator==) without
+ * comparing against all of them. Two Results can only be equal if they have the same format and bytes, except for matrix
+ * codes that are not valid (see DecodeHints::returnErrors), so the elements are bucketed by a hash of those. The indexed
+ * elements may change (e.g. their position) as long as their format, bytes and validity stay the same.
+ */
+class ResultIndex
+{
+	std::unordered_map<std::size_t, std::vector<int>> _buckets; // ascending indices of the Results with the same hash
+	std::vector<int> _wildcards; // ascending indices of the invalid matrix code Results
+	int _size = 0;
+
+	static std::size_t Hash(const Result& r);
+	static bool IsWildcard(const Result& r);
+
+public:
+	ResultIndex() = default;
+	explicit ResultIndex(const Results& results)
+	{
+		for (const auto& r : results)
+			add(r);
+	}
+
+	/// Index the Result that just got appended to the list
+	void add(const Result& r);
+
+	/**
+	 * Returns the smallest index i for which pred(results[i]) is true, only looking at the candidates that can be equal
+	 * to r, -1 if there is none. pred must imply results[i] == r (in either order).
+	 */
+	template <typename PRED>
+	int findIf(const Results& results, const Result& r, PRED pred) const
+	{
+		if (IsWildcard(r)) {
+			for (int i = 0; i < _size; ++i)
+				if (pred(results[i]))
+					return i;
+			return -1;
+		}
+
+		static const std::vector<int> none;
+		auto b = _buckets.find(Hash(r));
+		const auto& bucket = b != _buckets.end() ? b->second : none;
+		// merge the two ascending candidate lists
+		for (auto i = bucket.begin(), w = _wildcards.begin(); i != bucket.end() || w != _wildcards.end();) {
+			int j = w == _wildcards.end() || (i != bucket.end() && *i < *w) ? *i++ : *w++;
+			if (pred(results[j]))
+				return j;
+		}
+		return -1;
+	}
+
+	/// Returns the smallest index i with results[i] == r, -1 if there is none (the linear equivalent is Find(results, r))
+	int find(const Results& results, const Result& r) const
+	{
+		return findIf(results, r, [&r](const Result& o) { return o == r; });
+	}
+};
+
+/**
+ * Returns all pairs (i, j) with i < j of Results whose positions have intersecting bounding boxes (see
+ * HaveIntersectingBoundingBoxes), ordered by i, then j. The bounding boxes are sorted into a uniform grid of about the
+ * average box size, so only the boxes sharing a grid cell get compared.
+ */
+std::vector<std::pair<int, int>> IntersectingBoundingBoxes(const Results& results);
+
+} // ZXing
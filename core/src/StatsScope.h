@@ -0,0 +1,101 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "DecodeStats.h"
+
+#include <chrono>
+#include <utility>
+
+namespace ZXing {
+
+// Internal helpers to fill the DecodeStats of the current read (see DecodeHints::setStats). The stats object is passed
+// down the call stack via a thread_local to not have to thread it through all the readers and decoders.
+
+class StatsScope;
+
+namespace Detail {
+inline thread_local DecodeStats* CurrentStats = nullptr;
+inline thread_local StatsScope* CurrentScope = nullptr;
+} // namespace Detail
+
+inline DecodeStats* CurrentStats()
+{
+	return Detail::CurrentStats;
+}
+
+inline void CountStat(DecodeStats::Counter counter, int64_t n = 1)
+{
+	if (auto stats = Detail::CurrentStats)
+		stats->add(counter, n);
+}
+
+/**
+ * Makes stats the current stats object of this thread for the lifetime of the context. Used at the top of a read and
+ * inside of tasks running on an Executor (capture CurrentStats() before calling parallelFor). If stats is already the
+ * current object (e.g. a task running on the calling thread), the context is a no-op, so the open StatsScope keeps
+ * getting its nested time subtracted.
+ */
+class StatsContext
+{
+	DecodeStats* _prevStats;
+	StatsScope* _prevScope;
+	bool _active;
+
+public:
+	explicit StatsContext(DecodeStats* stats)
+		: _prevStats(Detail::CurrentStats), _prevScope(Detail::CurrentScope), _active(stats != _prevStats)
+	{
+		if (_active) {
+			Detail::CurrentStats = stats;
+			Detail::CurrentScope = nullptr;
+		}
+	}
+	~StatsContext()
+	{
+		if (_active) {
+			Detail::CurrentStats = _prevStats;
+			Detail::CurrentScope = _prevScope;
+		}
+	}
+	StatsContext(const StatsContext&) = delete;
+	StatsContext& operator=(const StatsContext&) = delete;
+};
+
+/// Accounts the time of its lifetime minus the time of nested scopes to the given stage of the current stats object.
+class StatsScope
+{
+	using Clock = std::chrono::steady_clock;
+
+	DecodeStats* _stats;
+	StatsScope* _parent = nullptr;
+	DecodeStats::Stage _stage;
+	Clock::time_point _start;
+	Clock::duration _nested = {};
+
+public:
+	explicit StatsScope(DecodeStats::Stage stage) : _stats(Detail::CurrentStats), _stage(stage)
+	{
+		if (!_stats)
+			return;
+		_parent = std::exchange(Detail::CurrentScope, this);
+		_start = Clock::now();
+	}
+	~StatsScope()
+	{
+		if (!_stats)
+			return;
+		auto elapsed = Clock::now() - _start;
+		_stats->add(_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed - _nested));
+		if (_parent)
+			_parent->_nested += elapsed;
+		Detail::CurrentScope = _parent;
+	}
+	StatsScope(const StatsScope&) = delete;
+	StatsScope& operator=(const StatsScope&) = delete;
+};
+
+} // ZXing
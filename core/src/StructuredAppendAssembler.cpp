@@ -0,0 +1,95 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "StructuredAppendAssembler.h"
+
+#include "ZXAlgorithms.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ZXing {
+
+static std::size_t MemoryUsage(const Content& content)
+{
+	return sizeof(Content) + content.bytes.size() + content.encodings.size() * sizeof(Content::Encoding);
+}
+
+Result StructuredAppendAssembler::add(const Result& result)
+{
+	if (!result.isValid() || !result.isPartOfSequence() || result.sequenceIndex() >= result.sequenceSize())
+		return {};
+
+	Key key{result.format(), result.sequenceSize(), result.sequenceId()};
+	auto [it, isNew] = _sequences.try_emplace(key);
+	auto& seq = it->second;
+	if (!isNew && seq.segments.count(result.sequenceIndex()))
+		return {}; // the same symbol seen again (e.g. in the next frame)
+
+	if (isNew || result.sequenceIndex() < seq.header.sequenceIndex()) {
+		// the remaining properties of the merged Result are the ones of the first symbol, like with MergeSequence()
+		seq.header = result;
+		seq.header._content = {};
+		seq.header._text.clear();
+		seq.header._hasText = false;
+	}
+	if (isNew) {
+		seq.memoryUsage = sizeof(Sequence) + sizeof(Key) + 2 * result.sequenceId().size();
+		_memoryUsage += seq.memoryUsage;
+	}
+
+	// copying the content (instead of moving it) drops the extra capacity the decoders reserve
+	const auto& content = seq.segments.emplace(result.sequenceIndex(), result._content).first->second;
+	seq.memoryUsage += MemoryUsage(content);
+	_memoryUsage += MemoryUsage(content);
+	seq.lastUpdate = ++_updates;
+	seq.ecUsage = std::max(seq.ecUsage, result._ecUsage);
+
+	if (Size(seq.segments) < result.sequenceSize()) {
+		evict();
+		return {};
+	}
+
+	Result res = std::move(seq.header);
+	res._content = std::move(seq.segments.begin()->second);
+	for (auto i = std::next(seq.segments.begin()); i != seq.segments.end(); ++i)
+		res._content.append(i->second);
+	res._position = {};
+	res._sai.index = -1;
+	res._ecUsage = seq.ecUsage;
+
+	_memoryUsage -= seq.memoryUsage;
+	_sequences.erase(it);
+	return res;
+}
+
+Results StructuredAppendAssembler::add(const Results& results)
+{
+	Results merged;
+	for (const auto& r : results)
+		if (auto res = add(r); res.isValid())
+			merged.push_back(std::move(res));
+	return merged;
+}
+
+void StructuredAppendAssembler::evict()
+{
+	// drop the sequences that were updated the longest time ago, the one just updated (if at all) last
+	while (_memoryUsage > _memoryBudget && !_sequences.empty()) {
+		auto oldest = std::min_element(_sequences.begin(), _sequences.end(),
+									   [](const auto& a, const auto& b) { return a.second.lastUpdate < b.second.lastUpdate; });
+		_memoryUsage -= oldest->second.memoryUsage;
+		_sequences.erase(oldest);
+		++_evicted;
+	}
+}
+
+void StructuredAppendAssembler::clear()
+{
+	_sequences.clear();
+	_memoryUsage = 0;
+}
+
+} // ZXing
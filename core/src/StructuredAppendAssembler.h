@@ -0,0 +1,79 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "BarcodeFormat.h"
+#include "Content.h"
+#include "Result.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace ZXing {
+
+/**
+ * Assembles Structured Append sequences (QR Code, DataMatrix, PDF417 Macro, ...) from symbols that arrive one by one,
+ * e.g. from the consecutive images of a batch or the frames of a video stream. Unlike MergeStructuredAppendSequences(),
+ * which needs all results at once, the symbols are fed to add() as they are found and the merged Result is returned
+ * as soon as the last missing symbol of its sequence arrived.
+ *
+ * Of each symbol only its content is kept (and of the first one the remaining Result properties), repeated symbols are
+ * ignored. Sequences are told apart by format, size and sequenceId(). If the buffered contents exceed the memory budget,
+ * the incomplete sequences that have not seen a new symbol for the longest time are dropped.
+ *
+ * The class is not thread-safe.
+ */
+class StructuredAppendAssembler
+{
+	using Key = std::tuple<BarcodeFormat, int, std::string>; // format, sequence size, sequence id
+
+	struct Sequence
+	{
+		Result header; // the symbol with the lowest index seen so far, without content
+		std::map<int, Content> segments; // by sequence index
+		std::size_t memoryUsage = 0;
+		uint64_t lastUpdate = 0;
+		float ecUsage = -1; // the maximum of all symbols, see Result::confidence()
+	};
+
+	std::map<Key, Sequence> _sequences;
+	std::size_t _memoryBudget;
+	std::size_t _memoryUsage = 0;
+	uint64_t _updates = 0;
+	int _evicted = 0;
+
+	void evict();
+
+public:
+	/// @param memoryBudget  upper bound of the (estimated) memory used by the buffered symbols in bytes
+	explicit StructuredAppendAssembler(std::size_t memoryBudget = 1 << 20) : _memoryBudget(memoryBudget) {}
+
+	/**
+	 * Add a symbol, returns the merged Result of its sequence if that is complete now, an invalid Result otherwise.
+	 * Results that are not valid or not part of a sequence are ignored.
+	 */
+	Result add(const Result& result);
+
+	/// Add all symbols of results, returns the merged Results of the sequences completed by them in order of completion
+	Results add(const Results& results);
+
+	/// Drop all incomplete sequences
+	void clear();
+
+	/// Number of incomplete sequences currently buffered
+	int pendingSequences() const { return static_cast<int>(_sequences.size()); }
+
+	/// Estimated memory used by the buffered symbols in bytes
+	std::size_t memoryUsage() const { return _memoryUsage; }
+
+	/// Number of incomplete sequences dropped to stay within the memory budget so far
+	int evictedSequences() const { return _evicted; }
+};
+
+} // ZXing
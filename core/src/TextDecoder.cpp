@@ -10,17 +10,119 @@
 #include "ECI.h"
 #include "Utf.h"
 #include "ZXAlgorithms.h"
+#include "ZXConfig.h"
 #include "libzueci/zueci.h"
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
+#include <vector>
+
+#if defined(ZX_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 namespace ZXing {
 
+// Returns the length of the leading run of ASCII (< 0x80) bytes
+static size_t AsciiPrefixLength(const uint8_t* bytes, size_t length)
+{
+	size_t i = 0;
+#if defined(ZX_USE_SSE2)
+	for (; i + 16 <= length; i += 16)
+		if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i))))
+			break;
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+	for (; i + 16 <= length; i += 16)
+		if (vmaxvq_u8(vld1q_u8(bytes + i)) >= 0x80)
+			break;
+#endif
+	while (i < length && bytes[i] < 0x80)
+		++i;
+	return i;
+}
+
+// Returns the length of the leading run of printable ASCII bytes (0x20 - 0x7F), CR and LF, which none of the
+// state machines of GuessEncoding() distinguishes
+static size_t PrintableAsciiPrefixLength(const uint8_t* bytes, size_t length)
+{
+	size_t i = 0;
+#if defined(ZX_USE_SSE2)
+	const __m128i space = _mm_set1_epi8(0x1F), lf = _mm_set1_epi8(0x0A), cr = _mm_set1_epi8(0x0D);
+	for (; i + 16 <= length; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+		// the signed comparison excludes 0x80 - 0xFF
+		__m128i ok = _mm_or_si128(_mm_cmpgt_epi8(v, space), _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+		if (_mm_movemask_epi8(ok) != 0xFFFF)
+			break;
+	}
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+	for (; i + 16 <= length; i += 16) {
+		uint8x16_t v = vld1q_u8(bytes + i);
+		uint8x16_t ok = vorrq_u8(vcgtq_s8(vreinterpretq_s8_u8(v), vdupq_n_s8(0x1F)),
+								 vorrq_u8(vceqq_u8(v, vdupq_n_u8(0x0A)), vceqq_u8(v, vdupq_n_u8(0x0D))));
+		if (vminvq_u8(ok) != 0xFF)
+			break;
+	}
+#endif
+	while (i < length && ((bytes[i] >= 0x20 && bytes[i] < 0x80) || bytes[i] == 0x0A || bytes[i] == 0x0D))
+		++i;
+	return i;
+}
+
+// Checks for well-formed UTF-8 (no overlong forms, surrogates or code points beyond U+10FFFF), see RFC 3629
+static bool IsValidUtf8(const uint8_t* bytes, size_t length)
+{
+	auto isCont = [&](size_t i) { return i < length && (bytes[i] & 0xC0) == 0x80; };
+
+	for (size_t i = AsciiPrefixLength(bytes, length); i < length; i += AsciiPrefixLength(bytes + i, length - i)) {
+		uint8_t c = bytes[i];
+		int n; // number of continuation bytes
+		uint8_t lo = 0x80, hi = 0xBF; // valid range of the first continuation byte
+		if (c >= 0xC2 && c <= 0xDF)
+			n = 1;
+		else if (c >= 0xE0 && c <= 0xEF)
+			n = 2, lo = c == 0xE0 ? 0xA0 : 0x80, hi = c == 0xED ? 0x9F : 0xBF;
+		else if (c >= 0xF0 && c <= 0xF4)
+			n = 3, lo = c == 0xF0 ? 0x90 : 0x80, hi = c == 0xF4 ? 0x8F : 0xBF;
+		else
+			return false;
+
+		if (i + 1 >= length || bytes[i + 1] < lo || bytes[i + 1] > hi)
+			return false;
+		for (int k = 2; k <= n; ++k)
+			if (!isCont(i + k))
+				return false;
+		i += n + 1;
+	}
+	return true;
+}
+
+// Whether the conversion maps every ASCII byte to itself (verified against zueci in TextDecoderTest)
+static bool IsAsciiTransparent(CharacterSet charset, bool sjisASCII)
+{
+	switch (charset) {
+	case CharacterSet::Shift_JIS: return sjisASCII; // maps backslash and tilde to yen sign and overline
+	case CharacterSet::UTF16BE:
+	case CharacterSet::UTF16LE:
+	case CharacterSet::UTF32BE:
+	case CharacterSet::UTF32LE: return false;
+	default: return true;
+	}
+}
+
 void TextDecoder::Append(std::string& str, const uint8_t* bytes, size_t length, CharacterSet charset, bool sjisASCII)
 {
+	// Most content is plain ASCII (or UTF-8), which is copied straight through without the zueci conversion
+	if (IsAsciiTransparent(charset, sjisASCII)
+		&& (AsciiPrefixLength(bytes, length) == length || (charset == CharacterSet::UTF8 && IsValidUtf8(bytes, length)))) {
+		str.append(reinterpret_cast<const char*>(bytes), length);
+		return;
+	}
+
 	int eci = ToInt(ToECI(charset));
-	const size_t str_len = str.length();
 	const int bytes_len = narrow_cast<int>(length);
 	constexpr unsigned int replacement = 0xFFFD;
 	const unsigned int flags = ZUECI_FLAG_SB_STRAIGHT_THRU | (sjisASCII ? ZUECI_FLAG_SJIS_STRAIGHT_THRU : 0);
@@ -29,19 +131,17 @@ void TextDecoder::Append(std::string& str, const uint8_t* bytes, size_t length,
 	if (eci == -1)
 		eci = 899; // Binary
 
-	int error_number = zueci_dest_len_utf8(eci, bytes, bytes_len, replacement, flags, &utf8_len);
-	if (error_number >= ZUECI_ERROR)
-		throw std::runtime_error("zueci_dest_len_utf8 failed");
-
-	str.resize(str_len + utf8_len); // Precise length
-	unsigned char *utf8_buf = reinterpret_cast<unsigned char *>(str.data()) + str_len;
+	// Convert in a single pass into a buffer of the documented worst case size (4 times the input) instead of running
+	// the whole conversion twice with zueci_dest_len_utf8() first. The result is then appended with its precise length.
+	thread_local std::vector<unsigned char> utf8_buf;
+	utf8_buf.resize(std::max<size_t>(4 * length, 1));
 
-	error_number = zueci_eci_to_utf8(eci, bytes, bytes_len, replacement, flags, utf8_buf, &utf8_len);
-	if (error_number >= ZUECI_ERROR) {
-		str.resize(str_len);
+	int error_number = zueci_eci_to_utf8(eci, bytes, bytes_len, replacement, flags, utf8_buf.data(), &utf8_len);
+	if (error_number >= ZUECI_ERROR)
 		throw std::runtime_error("zueci_eci_to_utf8 failed");
-	}
-	assert(str.length() == str_len + utf8_len);
+	assert(utf8_len <= Size(utf8_buf));
+
+	str.append(reinterpret_cast<const char*>(utf8_buf.data()), utf8_len);
 }
 
 void TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, CharacterSet charset)
@@ -87,6 +187,16 @@ TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fal
 
 	for (size_t i = 0; i < length && (canBeISO88591 || canBeShiftJIS || canBeUTF8); ++i)
 	{
+		// skip runs of printable ASCII outside of multi-byte sequences, they only end the current Shift_JIS words
+		if ((!canBeUTF8 || utf8BytesLeft == 0) && (!canBeShiftJIS || sjisBytesLeft == 0)) {
+			if (size_t n = PrintableAsciiPrefixLength(bytes + i, length - i)) {
+				sjisCurKatakanaWordLength = 0;
+				sjisCurDoubleBytesWordLength = 0;
+				if ((i += n) == length)
+					break;
+			}
+		}
+
 		int value = bytes[i];
 
 		// UTF-8 stuff
@@ -15,7 +15,7 @@
 
 namespace ZXing {
 
-void TextEncoder::GetBytes(const std::string& str, CharacterSet charset, std::string& bytes)
+void TextEncoder::GetBytes(std::string_view str, CharacterSet charset, std::string& bytes)
 {
 	int eci = ToInt(ToECI(charset));
 	const int str_len = narrow_cast<int>(str.length());
@@ -42,7 +42,7 @@ void TextEncoder::GetBytes(const std::string& str, CharacterSet charset, std::st
 	bytes.resize(eci_len); // Actual length
 }
 
-void TextEncoder::GetBytes(const std::wstring& str, CharacterSet charset, std::string& bytes)
+void TextEncoder::GetBytes(std::wstring_view str, CharacterSet charset, std::string& bytes)
 {
 	GetBytes(ToUtf8(str), charset, bytes);
 }
@@ -8,20 +8,22 @@
 #include "CharacterSet.h"
 
 #include <string>
+#include <string_view>
 
 namespace ZXing {
 
 class TextEncoder
 {
-	static void GetBytes(const std::string& str, CharacterSet charset, std::string& bytes);
-	static void GetBytes(const std::wstring& str, CharacterSet charset, std::string& bytes);
+	static void GetBytes(std::string_view str, CharacterSet charset, std::string& bytes);
+	static void GetBytes(std::wstring_view str, CharacterSet charset, std::string& bytes);
 public:
-	static std::string FromUnicode(const std::string& str, CharacterSet charset) {
+	// str is utf8 encoded
+	static std::string FromUnicode(std::string_view str, CharacterSet charset) {
 		std::string r;
 		GetBytes(str, charset, r);
 		return r;
 	}
-	static std::string FromUnicode(const std::wstring& str, CharacterSet charset) {
+	static std::string FromUnicode(std::wstring_view str, CharacterSet charset) {
 		std::string r;
 		GetBytes(str, charset, r);
 		return r;
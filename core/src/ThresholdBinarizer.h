@@ -7,6 +7,7 @@
 
 #include "BinaryBitmap.h"
 #include "BitMatrix.h"
+#include "Pattern.h"
 
 #include <cstdint>
 
@@ -23,28 +24,8 @@ public:
 	{
 		auto buffer = _buffer.rotated(rotation);
 
-		const int stride = buffer.pixStride();
-		const uint8_t* begin = buffer.data(0, row) + GreenIndex(buffer.format());
-		const uint8_t* end = begin + buffer.width() * stride;
-
-		auto* lastPos = begin;
-		bool lastVal = false;
-
-		res.clear();
-
-		for (const uint8_t* p = begin; p != end; p += stride) {
-			bool val = *p <= _threshold;
-			if (val != lastVal) {
-				res.push_back(narrow_cast<PatternRow::value_type>((p - lastPos) / stride));
-				lastVal = val;
-				lastPos = p;
-			}
-		}
-
-		res.push_back(narrow_cast<PatternRow::value_type>((end - lastPos) / stride));
-
-		if (*(end - stride) <= _threshold)
-			res.push_back(0); // last value is number of white pixels, here 0
+		ThresholdPatternRow(buffer.data(0, row) + GreenIndex(buffer.format()), buffer.width(), buffer.pixStride(), _threshold,
+							false, res);
 
 		return true;
 	}
@@ -0,0 +1,94 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TileClassifier.h"
+
+#include "BitMatrix.h"
+#include "TraceScope.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace ZXing {
+
+namespace {
+
+struct Direction
+{
+	int dx, dy;
+	int len2; // squared length of (dx, dy)
+};
+
+// 8 directions between 0 and 180 degrees, about 22.5 degrees apart, dx is always >= 0
+constexpr std::array<Direction, 8> Directions = {{{1, 0, 1}, {2, 1, 5}, {1, 1, 2}, {1, 2, 5}, {0, 1, 1}, {1, -2, 5}, {1, -1, 2}, {2, -1, 5}}};
+
+TileClass Classify(const std::array<int, Directions.size()>& counts, int tileSize)
+{
+	// fewer than one edge per 4 rows/columns
+	if (*std::max_element(counts.begin(), counts.end()) < tileSize / 4)
+		return TileClass::Empty;
+
+	// compare the squared rates count / len to stay in integer arithmetic, the rates in the perpendicular direction of
+	// parallel bars are at most sin(11.25) ~ 0.2 of the maximum, the ones of a grid of modules at least 0.5
+	int64_t minR2 = INT64_MAX, maxR2 = 0;
+	for (int i = 0; i < Size(Directions); ++i) {
+		// count^2 / len2 scaled by 5 * 2 (the lcm of all len2) to not lose precision
+		int64_t r2 = int64_t(counts[i]) * counts[i] * (10 / Directions[i].len2);
+		minR2 = std::min(minR2, r2);
+		maxR2 = std::max(maxR2, r2);
+	}
+	if (minR2 * 16 < maxR2) // rate ratio below 1/4
+		return TileClass::Linear;
+	if (minR2 * 6 < maxR2) // rate ratio below about 0.4
+		return TileClass::Stacked;
+	return TileClass::Matrix;
+}
+
+} // namespace
+
+Matrix<TileClass> ClassifyTiles(const BitMatrix& image, int tileSize)
+{
+	ZX_TRACE_SCOPE("ClassifyTiles");
+	constexpr int margin = 2; // the maximum |dx| and |dy| of the directions
+	const int width = image.width(), height = image.height();
+	const int tilesX = (width + tileSize - 1) / tileSize, tilesY = (height + tileSize - 1) / tileSize;
+	Matrix<TileClass> res(tilesX, tilesY, TileClass::Empty);
+	if (width <= 2 * margin || height <= 2 * margin)
+		return res;
+
+	std::vector<std::array<int, Directions.size()>> counts(tilesX);
+	for (int ty = 0; ty < tilesY; ++ty) {
+		std::fill(counts.begin(), counts.end(), std::array<int, Directions.size()>{});
+		const int yEnd = std::min((ty + 1) * tileSize, height - margin);
+		for (int y = std::max(ty * tileSize, margin); y < yEnd; ++y) {
+			for (int d = 0; d < Size(Directions); ++d) {
+				const uint8_t* a = image.row(y).begin();
+				const uint8_t* b = image.row(y + Directions[d].dy).begin() + Directions[d].dx;
+				for (int tx = 0; tx < tilesX; ++tx) {
+					const int x0 = tx * tileSize, x1 = std::min(x0 + tileSize, width - margin);
+					int n = 0;
+					for (int x = x0; x < x1; ++x)
+						n += (a[x] ^ b[x]) & 1;
+					counts[tx][d] += n;
+				}
+			}
+		}
+		for (int tx = 0; tx < tilesX; ++tx)
+			res.set(tx, ty, Classify(counts[tx], tileSize));
+	}
+
+	return res;
+}
+
+int TileClassMask(const Matrix<TileClass>& tiles)
+{
+	int res = 0;
+	for (auto c : tiles)
+		res |= 1 << int(c);
+	return res;
+}
+
+} // ZXing
@@ -0,0 +1,39 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Matrix.h"
+
+#include <cstdint>
+
+namespace ZXing {
+
+class BitMatrix;
+
+enum class TileClass : uint8_t
+{
+	Empty,   ///< (almost) no edges
+	Linear,  ///< parallel edges in one direction only, i.e. the bars of a linear symbol
+	Stacked, ///< mostly parallel edges, interrupted at regular intervals (e.g. the rows of a PDF417 symbol)
+	Matrix,  ///< edges in all directions (matrix symbols, but also text, noise, ...)
+};
+
+/**
+ * Classifies the tiles (tileSize x tileSize pixels) of a binarized image by the directions of their edges. For every
+ * tile, the number of color changes between pixel pairs in 8 directions (0, 26.6, 45, ... 153.4 degrees) is counted
+ * and normalized by the distance of the pixels of a pair. Bars at any angle run at most 11.25 degrees off one of the
+ * directions, so a linear symbol shows a pronounced minimum, while the modules of a matrix symbol change color in all
+ * directions at similar rates.
+ *
+ * The whole pass costs 8 byte comparisons per pixel (the inner loops get auto-vectorized). Sampling only every other
+ * row would not do: with an even module size, the horizontal module edges of an axis aligned symbol would all be missed.
+ */
+Matrix<TileClass> ClassifyTiles(const BitMatrix& image, int tileSize = 32);
+
+/// Bit mask with bit (1 << int(c)) set for every TileClass c found in tiles
+int TileClassMask(const Matrix<TileClass>& tiles);
+
+} // ZXing
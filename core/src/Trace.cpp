@@ -0,0 +1,24 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Trace.h"
+
+#include <atomic>
+
+namespace ZXing {
+
+static std::atomic<TraceSink*> s_traceSink = nullptr;
+
+void SetTraceSink(TraceSink* sink)
+{
+	s_traceSink.store(sink, std::memory_order_release);
+}
+
+TraceSink* GetTraceSink()
+{
+	return s_traceSink.load(std::memory_order_acquire);
+}
+
+} // ZXing
@@ -0,0 +1,33 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+namespace ZXing {
+
+/**
+ * @brief Receiver of the begin/end events of the traced decode stages.
+ *
+ * The library is only instrumented if it is built with BUILD_TRACING (ZXING_BUILD_TRACING), otherwise the sink is never
+ * called. The scopes cover ReadBarcodes(), the image pyramid, the binarizers, the MultiFormatReader and the individual
+ * readers, and the error correction. Events are properly nested per thread and begin() and end() of a scope are called
+ * on the same thread, which maps directly onto e.g. Perfetto's TRACE_EVENT_BEGIN/TRACE_EVENT_END or ITT's
+ * __itt_task_begin/__itt_task_end. The sink is called from the threads of an Executor as well, so it must be thread-safe.
+ */
+class TraceSink
+{
+public:
+	virtual ~TraceSink() = default;
+
+	/// name is a string literal, i.e. its address is stable and can be used as a key (e.g. for __itt_string_handle)
+	virtual void begin(const char* name) = 0;
+	virtual void end(const char* name) = 0;
+};
+
+/// Install the (not owned) sink for all following traced scopes, nullptr disables tracing (default).
+void SetTraceSink(TraceSink* sink);
+TraceSink* GetTraceSink();
+
+} // ZXing
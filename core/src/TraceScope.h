@@ -0,0 +1,47 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Trace.h"
+
+// ZX_TRACE_SCOPE("name") reports the lifetime of the enclosing block to the TraceSink (see Trace.h). Without
+// ZXING_BUILD_TRACING the macro expands to nothing, so the instrumentation is free in regular builds.
+
+#ifdef ZXING_BUILD_TRACING
+
+namespace ZXing {
+
+class TraceScope
+{
+	const char* _name;
+	TraceSink* _sink;
+
+public:
+	explicit TraceScope(const char* name) : _name(name), _sink(GetTraceSink())
+	{
+		if (_sink)
+			_sink->begin(_name);
+	}
+	~TraceScope()
+	{
+		if (_sink)
+			_sink->end(_name);
+	}
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+};
+
+} // ZXing
+
+#define ZX_TRACE_CONCAT_IMPL(a, b) a##b
+#define ZX_TRACE_CONCAT(a, b) ZX_TRACE_CONCAT_IMPL(a, b)
+#define ZX_TRACE_SCOPE(name) ZXing::TraceScope ZX_TRACE_CONCAT(zxTraceScope, __LINE__)(name)
+
+#else
+
+#define ZX_TRACE_SCOPE(name) (void)0
+
+#endif
@@ -9,10 +9,18 @@
 
 #include "ZXTestSupport.h"
 #include "ZXAlgorithms.h"
+#include "ZXConfig.h"
 
 #include <iomanip>
 #include <cstdint>
 #include <sstream>
+#include <type_traits>
+
+#if defined(ZX_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 namespace ZXing {
 
@@ -69,50 +77,143 @@ inline char32_t Utf32FromUtf16Surrogates(std::wstring_view str)
 	return (static_cast<char32_t>(str[0]) << 10) + str[1] - 0x35fdc00;
 }
 
-static size_t Utf8CountCodePoints(utf8_t utf8)
+// Copies the leading run of ASCII bytes of src to dst (zero extended) and returns its length
+static size_t WidenAsciiPrefix(const char8_t* src, size_t n, wchar_t* dst)
 {
-	size_t count = 0;
+	size_t i = 0;
+#if defined(ZX_USE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		if (_mm_movemask_epi8(v))
+			break;
+		__m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+		auto out = reinterpret_cast<__m128i*>(dst + i);
+		if constexpr (sizeof(wchar_t) == 2) {
+			_mm_storeu_si128(out, lo);
+			_mm_storeu_si128(out + 1, hi);
+		} else {
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+		}
+	}
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+	for (; i + 16 <= n; i += 16) {
+		uint8x16_t v = vld1q_u8(src + i);
+		if (vmaxvq_u8(v) >= 0x80)
+			break;
+		uint16x8_t lo = vmovl_u8(vget_low_u8(v)), hi = vmovl_high_u8(v);
+		if constexpr (sizeof(wchar_t) == 2) {
+			auto out = reinterpret_cast<uint16_t*>(dst + i);
+			vst1q_u16(out, lo);
+			vst1q_u16(out + 8, hi);
+		} else {
+			auto out = reinterpret_cast<uint32_t*>(dst + i);
+			vst1q_u32(out, vmovl_u16(vget_low_u16(lo)));
+			vst1q_u32(out + 4, vmovl_high_u16(lo));
+			vst1q_u32(out + 8, vmovl_u16(vget_low_u16(hi)));
+			vst1q_u32(out + 12, vmovl_high_u16(hi));
+		}
+	}
+#endif
+	for (; i < n && src[i] < 0x80; ++i)
+		dst[i] = src[i];
+	return i;
+}
 
-	for (size_t i = 0; i < utf8.size();) {
-		if (utf8[i] < 128) {
-			++i;
+// Copies the leading run of ASCII characters of src to dst and returns its length
+static size_t NarrowAsciiPrefix(const wchar_t* src, size_t n, char* dst)
+{
+	size_t i = 0;
+#if defined(ZX_USE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16) {
+		auto in = reinterpret_cast<const __m128i*>(src + i);
+		__m128i packed;
+		if constexpr (sizeof(wchar_t) == 2) {
+			__m128i a = _mm_loadu_si128(in), b = _mm_loadu_si128(in + 1);
+			__m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<int16_t>(0xff80)));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xffff)
+				break;
+			packed = _mm_packus_epi16(a, b);
+		} else {
+			__m128i a = _mm_loadu_si128(in), b = _mm_loadu_si128(in + 1), c = _mm_loadu_si128(in + 2), d = _mm_loadu_si128(in + 3);
+			__m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(~0x7f));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xffff)
+				break;
+			packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+	}
+#elif defined(ZX_USE_NEON) && defined(__aarch64__)
+	for (; i + 16 <= n; i += 16) {
+		uint8x16_t packed;
+		if constexpr (sizeof(wchar_t) == 2) {
+			auto in = reinterpret_cast<const uint16_t*>(src + i);
+			uint16x8_t a = vld1q_u16(in), b = vld1q_u16(in + 8);
+			if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80)
+				break;
+			packed = vcombine_u8(vmovn_u16(a), vmovn_u16(b));
 		} else {
-			switch (utf8[i] & 0xf0) {
-			case 0xc0: [[fallthrough]];
-			case 0xd0: i += 2; break;
-			case 0xe0: i += 3; break;
-			case 0xf0: i += 4; break;
-			default: // we are in middle of a sequence
-				++i;
-				while (i < utf8.size() && (utf8[i] & 0xc0) == 0x80)
-					++i;
+			auto in = reinterpret_cast<const uint32_t*>(src + i);
+			uint32x4_t a = vld1q_u32(in), b = vld1q_u32(in + 4), c = vld1q_u32(in + 8), d = vld1q_u32(in + 12);
+			if (vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d))) >= 0x80)
 				break;
-			}
+			packed = vcombine_u8(vmovn_u16(vcombine_u16(vmovn_u32(a), vmovn_u32(b))),
+								 vmovn_u16(vcombine_u16(vmovn_u32(c), vmovn_u32(d))));
 		}
-		++count;
+		vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), packed);
 	}
+#endif
+	for (; i < n && static_cast<std::make_unsigned_t<wchar_t>>(src[i]) < 0x80; ++i)
+		dst[i] = static_cast<char>(src[i]);
+	return i;
+}
 
+// Upper bound of the number of wchar_t AppendFromUtf8() produces: one per lead (non-continuation) byte plus the second
+// half of the surrogate pair for 4 byte sequences if wchar_t is 2 bytes wide. Exact for valid UTF-8. Written branch
+// free to let the compiler vectorize it.
+static size_t Utf16Or32CountUnits(utf8_t utf8)
+{
+	size_t count = 0;
+	for (auto b : utf8)
+		count += ((b & 0xc0) != 0x80) + (sizeof(wchar_t) == 2 && b >= 0xf0);
 	return count;
 }
 
 static void AppendFromUtf8(utf8_t utf8, std::wstring& buffer)
 {
-	buffer.reserve(buffer.size() + Utf8CountCodePoints(utf8));
+	const size_t start = buffer.size();
+	buffer.resize(start + Utf16Or32CountUnits(utf8));
+	wchar_t* out = buffer.data() + start;
 
 	char32_t codePoint = 0;
 	state_t state = kAccepted;
 
-	for (auto b : utf8) {
-		if (Utf8Decode(b, state, codePoint) != kAccepted)
+	for (size_t i = 0; i < utf8.size();) {
+		if (state == kAccepted && utf8[i] < 0x80) {
+			size_t n = WidenAsciiPrefix(utf8.data() + i, utf8.size() - i, out);
+			out += n, i += n;
+			continue;
+		}
+
+		if (Utf8Decode(utf8[i++], state, codePoint) != kAccepted) {
+			if (state == kRejected) // the automaton never leaves this state
+				break;
 			continue;
+		}
 
 		if (sizeof(wchar_t) == 2 && codePoint > 0xffff) { // surrogate pair
-			buffer.push_back(narrow_cast<wchar_t>(0xd7c0 + (codePoint >> 10)));
-			buffer.push_back(narrow_cast<wchar_t>(0xdc00 + (codePoint & 0x3ff)));
+			*out++ = narrow_cast<wchar_t>(0xd7c0 + (codePoint >> 10));
+			*out++ = narrow_cast<wchar_t>(0xdc00 + (codePoint & 0x3ff));
 		} else {
-			buffer.push_back(narrow_cast<wchar_t>(codePoint));
+			*out++ = narrow_cast<wchar_t>(codePoint);
 		}
 	}
+
+	buffer.resize(out - buffer.data()); // shrink if the input was not valid UTF-8
 }
 
 std::wstring FromUtf8(std::string_view utf8)
@@ -122,6 +223,21 @@ std::wstring FromUtf8(std::string_view utf8)
 	return str;
 }
 
+int Utf8NextCodePoint(std::string_view utf8, int& pos)
+{
+	int start = pos;
+	char32_t codePoint = 0;
+	state_t state = kAccepted;
+	while (pos < Size(utf8)) {
+		if (Utf8Decode(static_cast<char8_t>(utf8[pos++]), state, codePoint) == kAccepted)
+			return narrow_cast<int>(codePoint);
+		if (state == kRejected)
+			break;
+	}
+	pos = start + 1;
+	return -1;
+}
+
 #if __cplusplus > 201703L
 std::wstring FromUtf8(std::u8string_view utf8)
 {
@@ -131,26 +247,24 @@ std::wstring FromUtf8(std::u8string_view utf8)
 }
 #endif
 
-// Count the number of bytes required to store given code points in UTF-8.
+// Count the number of bytes required to store given code points in UTF-8. Written branch free to let the compiler
+// vectorize it: with a 2 byte wchar_t, each half of a surrogate pair counts 3 and a low surrogate that follows a high one
+// subtracts 2 again (an unpaired surrogate is encoded on its own as 3 bytes, see AppendToUtf8()).
 static size_t Utf8CountBytes(std::wstring_view str)
 {
-	int result = 0;
-	for (; str.size(); str.remove_prefix(1)) {
-		if (str.front() < 0x80)
-			result += 1;
-		else if (str.front() < 0x800)
-			result += 2;
-		else if (sizeof(wchar_t) == 4) {
-			if (str.front() < 0x10000)
-				result += 3;
-			else
-				result += 4;
-		} else {
-			if (IsUtf16SurrogatePair(str)) {
-				result += 4;
-				str.remove_prefix(1);
-			} else
-				result += 3;
+	size_t result = 0;
+	if constexpr (sizeof(wchar_t) == 4) {
+		for (auto c : str) {
+			auto u = static_cast<uint32_t>(c);
+			result += 1 + (u >= 0x80) + (u >= 0x800) + (u >= 0x10000);
+		}
+	} else {
+		uint32_t prevHigh = 0;
+		for (auto c : str) {
+			auto u = static_cast<uint32_t>(c);
+			uint32_t isLow = (u & 0xfc00) == 0xdc00;
+			result += 1 + (u >= 0x80) + (u >= 0x800) - 2 * (prevHigh & isLow);
+			prevHigh = (u & 0xfc00) == 0xd800;
 		}
 	}
 	return result;
@@ -184,11 +298,18 @@ int Utf32ToUtf8(char32_t utf32, char* out)
 
 static void AppendToUtf8(std::wstring_view str, std::string& utf8)
 {
-	utf8.reserve(utf8.size() + Utf8CountBytes(str));
+	const size_t start = utf8.size();
+	utf8.resize(start + Utf8CountBytes(str));
+	char* out = utf8.data() + start;
+
+	while (str.size()) {
+		if (static_cast<std::make_unsigned_t<wchar_t>>(str.front()) < 0x80) {
+			size_t n = NarrowAsciiPrefix(str.data(), str.size(), out);
+			out += n;
+			str.remove_prefix(n);
+			continue;
+		}
 
-	char buffer[4];
-	for (; str.size(); str.remove_prefix(1))
-	{
 		uint32_t cp;
 		if (IsUtf16SurrogatePair(str)) {
 			cp = Utf32FromUtf16Surrogates(str);
@@ -196,8 +317,8 @@ static void AppendToUtf8(std::wstring_view str, std::string& utf8)
 		} else
 			cp = str.front();
 
-		auto bufLength = Utf32ToUtf8(cp, buffer);
-		utf8.append(buffer, bufLength);
+		out += Utf32ToUtf8(cp, out);
+		str.remove_prefix(1);
 	}
 }
 
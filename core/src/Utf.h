@@ -16,6 +16,12 @@ std::wstring FromUtf8(std::string_view utf8);
 std::wstring FromUtf8(std::u8string_view utf8);
 #endif
 
+/**
+ * Decodes the code point starting at utf8[pos] and advances pos to the next one, without any allocation. Returns -1 for
+ * an invalid or truncated sequence, in which case pos is advanced by one byte.
+ */
+int Utf8NextCodePoint(std::string_view utf8, int& pos);
+
 std::wstring EscapeNonGraphical(std::wstring_view str);
 std::string EscapeNonGraphical(std::string_view utf8);
 
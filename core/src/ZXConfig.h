@@ -14,3 +14,35 @@
 // The Galoir Field abstractions used in Reed-Solomon error correction code can use more memory to eliminate a modulo
 // operation. This improves performance but might not be the best option if RAM is scarce. The effect is a few kB big.
 #define ZX_REED_SOLOMON_USE_MORE_MEMORY_FOR_SPEED
+
+// BitMatrix::get() performs a bounds check (throwing std::out_of_range) to turn detector bugs into exceptions instead
+// of out of bounds memory reads. The hot loops that already validate their positions with isIn() use the unchecked
+// BitMatrix::getUnchecked() instead. Define ZX_BITMATRIX_BOUNDS_CHECK to 0 to skip the check everywhere.
+#ifndef ZX_BITMATRIX_BOUNDS_CHECK
+#define ZX_BITMATRIX_BOUNDS_CHECK 1
+#endif
+
+// Some hot loops (image downscaling, luminance conversion, binarization) come with hand written SIMD code for SSE2
+// (x86) and NEON (ARM). Both are part of the baseline of the respective 64-bit architectures, so the selection happens
+// at compile time. Kernels that profit from later extensions (e.g. SSSE3) come in several variants, the best one the CPU
+// supports is selected at runtime (see CpuFeatures.h). Setting ZX_NO_SIMD falls back to the plain C++ code (which is
+// bit-identical). WebAssembly builds with `-msimd128 -msse2` take the SSE2 path, emscripten maps those intrinsics onto
+// SIMD128 instructions.
+#ifndef ZX_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64)
+#define ZX_USE_SSE2
+#elif defined(__ARM_NEON)
+#define ZX_USE_NEON
+#endif
+#endif
+
+// A BarcodeReader can serve the transient per read allocations (e.g. the pattern row cache of a BinaryBitmap) from an
+// internal arena on top of a user supplied std::pmr::memory_resource (see DecodeHints::setMemoryResource()). The
+// <memory_resource> header is not available with the oldest supported compilers (gcc 7, clang 5) and before macOS 14,
+// in which case everything is allocated with operator new as before.
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_memory_resource) && !defined(ZX_NO_PMR)
+#define ZX_HAVE_PMR
+#endif
@@ -0,0 +1,78 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AZBitLayout.h"
+
+#include "ZXAlgorithms.h"
+
+#include <array>
+#include <mutex>
+#include <numeric>
+
+namespace ZXing::Aztec {
+
+static std::vector<ModulePos> ComputeBitLayout(bool compact, int layers)
+{
+	int baseMatrixSize = (compact ? 11 : 14) + layers * 4; // not including alignment lines
+	std::vector<int> map(baseMatrixSize, 0);
+
+	if (compact) {
+		// no alignment lines in compact mode, map is a no-op
+		std::iota(map.begin(), map.end(), 0);
+	} else {
+		int matrixSize = baseMatrixSize + 1 + 2 * ((baseMatrixSize / 2 - 1) / 15);
+		int origCenter = baseMatrixSize / 2;
+		int center = matrixSize / 2;
+		for (int i = 0; i < origCenter; i++) {
+			int newOffset = i + i / 15;
+			map[origCenter - i - 1] = center - newOffset - 1;
+			map[origCenter + i] = center + newOffset + 1;
+		}
+	}
+
+	auto pos = [&map](int x, int y) { return ModulePos{narrow_cast<uint8_t>(map[x]), narrow_cast<uint8_t>(map[y])}; };
+
+	std::vector<ModulePos> res(TotalBitsInLayer(layers, compact));
+	for (int i = 0, rowOffset = 0; i < layers; i++) {
+		int rowSize = (layers - i) * 4 + (compact ? 9 : 12);
+		// The top-left most point of this layer is <low, low> (not including alignment lines)
+		int low = i * 2;
+		// The bottom-right most point of this layer is <high, high> (not including alignment lines)
+		int high = baseMatrixSize - 1 - low;
+		// The bits are placed in the two 2 x rowSize columns and two rowSize x 2 rows
+		for (int j = 0; j < rowSize; j++) {
+			int colOffset = j * 2;
+			for (int k = 0; k < 2; k++) {
+				// left column
+				res[rowOffset + 0 * rowSize + colOffset + k] = pos(low + k, low + j);
+				// bottom row
+				res[rowOffset + 2 * rowSize + colOffset + k] = pos(low + j, high - k);
+				// right column
+				res[rowOffset + 4 * rowSize + colOffset + k] = pos(high - k, high - j);
+				// top row
+				res[rowOffset + 6 * rowSize + colOffset + k] = pos(high - j, low + k);
+			}
+		}
+		rowOffset += rowSize * 8;
+	}
+	return res;
+}
+
+const std::vector<ModulePos>& BitLayout(bool compact, int layers)
+{
+	constexpr int MAX_LAYERS_COMPACT = 4, MAX_LAYERS = 32;
+	static std::array<std::once_flag, MAX_LAYERS_COMPACT + MAX_LAYERS> once;
+	static std::array<std::vector<ModulePos>, MAX_LAYERS_COMPACT + MAX_LAYERS> layouts;
+	static const std::vector<ModulePos> invalid;
+
+	if (layers < 1 || layers > (compact ? MAX_LAYERS_COMPACT : MAX_LAYERS))
+		return invalid;
+
+	int i = compact ? layers - 1 : MAX_LAYERS_COMPACT + layers - 1;
+	std::call_once(once[i], [&] { layouts[i] = ComputeBitLayout(compact, layers); });
+	return layouts[i];
+}
+
+} // namespace ZXing::Aztec
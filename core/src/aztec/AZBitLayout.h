@@ -0,0 +1,30 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ZXing::Aztec {
+
+struct ModulePos
+{
+	uint8_t x, y; // the largest symbol (32 layers) has 151 x 151 modules
+};
+
+inline int TotalBitsInLayer(int layers, bool compact)
+{
+	return ((compact ? 88 : 112) + 16 * layers) * layers;
+}
+
+/**
+ * The module positions of all data bits of a symbol (including the alignment lines) in the order of the bit stream,
+ * starting with the innermost layer. Computed on first use for each of the 4 compact and 32 full range sizes.
+ * Returns an empty vector for an invalid number of layers.
+ */
+const std::vector<ModulePos>& BitLayout(bool compact, int layers);
+
+} // namespace ZXing::Aztec
@@ -7,18 +7,22 @@
 
 #include "AZDecoder.h"
 
+#include "AZBitLayout.h"
 #include "AZDetectorResult.h"
 #include "BitArray.h"
 #include "BitMatrix.h"
+#include "BitSource.h"
+#include "ByteArray.h"
 #include "CharacterSet.h"
 #include "DecoderResult.h"
 #include "GenericGF.h"
 #include "ReedSolomonDecoder.h"
+#include "StatsScope.h"
 #include "ZXTestSupport.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cstring>
-#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -60,66 +64,26 @@ static const char* DIGIT_TABLE[] = {
 	"CTRL_PS", " ", "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", ",", ".", "CTRL_UL", "CTRL_US"
 };
 
-static int TotalBitsInLayer(int layers, bool compact)
-{
-	return ((compact ? 88 : 112) + 16 * layers) * layers;
-}
-
 /**
-* Gets the array of bits from an Aztec Code matrix
-*
-* @return the array of bits
+* Reads the code words from an Aztec Code matrix along the bit layout. The first Size(layout) % codewordSize bits are
+* not part of any code word.
 */
-static BitArray ExtractBits(const DetectorResult& ddata)
+static void ExtractCodewords(const DetectorResult& ddata, int codewordSize, std::vector<int>& res)
 {
-	bool compact = ddata.isCompact();
-	int layers = ddata.nbLayers();
-	int baseMatrixSize = (compact ? 11 : 14) + layers * 4; // not including alignment lines
-	std::vector<int> map(baseMatrixSize, 0);
-
-	if (compact) {
-		std::iota(map.begin(), map.end(), 0);
-	} else {
-		int matrixSize = baseMatrixSize + 1 + 2 * ((baseMatrixSize / 2 - 1) / 15);
-		int origCenter = baseMatrixSize / 2;
-		int center = matrixSize / 2;
-		for (int i = 0; i < origCenter; i++) {
-			int newOffset = i + i / 15;
-			map[origCenter - i - 1] = center - newOffset - 1;
-			map[origCenter + i] = center + newOffset + 1;
-		}
-	}
+	const auto& layout = BitLayout(ddata.isCompact(), ddata.nbLayers());
 	auto& matrix = ddata.bits();
-	BitArray rawbits(TotalBitsInLayer(layers, compact));
-	for (int i = 0, rowOffset = 0; i < layers; i++) {
-		int rowSize = (layers - i) * 4 + (compact ? 9 : 12);
-		// The top-left most point of this layer is <low, low> (not including alignment lines)
-		int low = i * 2;
-		// The bottom-right most point of this layer is <high, high> (not including alignment lines)
-		int high = baseMatrixSize - 1 - low;
-		// We pull bits from the two 2 x rowSize columns and two rowSize x 2 rows
-		for (int j = 0; j < rowSize; j++) {
-			int colOffset = j * 2;
-			for (int k = 0; k < 2; k++) {
-				// left column
-				rawbits.set(rowOffset + 0 * rowSize + colOffset + k, matrix.get(map[low + k], map[low + j]));
-				// bottom row
-				rawbits.set(rowOffset + 2 * rowSize + colOffset + k, matrix.get(map[low + j], map[high - k]));
-				// right column
-				rawbits.set(rowOffset + 4 * rowSize + colOffset + k, matrix.get(map[high - k], map[high - j]));
-				// top row
-				rawbits.set(rowOffset + 6 * rowSize + colOffset + k, matrix.get(map[high - j], map[low + k]));
-			}
-		}
-		rowOffset += rowSize * 8;
-	}
-	return rawbits;
+	int offset = Size(layout) % codewordSize;
+	res.assign(Size(layout) / codewordSize, 0);
+	for (int i = offset; i < Size(layout); ++i)
+		AppendBit(res[(i - offset) / codewordSize], matrix.get(layout[i].x, layout[i].y));
 }
 
 /**
-* @brief Performs RS error correction on an array of bits.
+* @brief Performs RS error correction on the code words and packs the unstuffed data bits into bytes.
+* @param ecUsage set to the used fraction of the error correction capacity
+* @return the number of valid bits in bytes
 */
-static BitArray CorrectBits(const DetectorResult& ddata, const BitArray& rawbits)
+static int CorrectBits(const DetectorResult& ddata, ByteArray& bytes, float& ecUsage)
 {
 	const GenericGF* gf = nullptr;
 	int codewordSize;
@@ -138,36 +102,45 @@ static BitArray CorrectBits(const DetectorResult& ddata, const BitArray& rawbits
 		gf = &GenericGF::AztecData12();
 	}
 
-	int numCodewords = Size(rawbits) / codewordSize;
+	thread_local std::vector<int> dataWords;
+	ExtractCodewords(ddata, codewordSize, dataWords);
+
+	int numCodewords = Size(dataWords);
 	int numDataCodewords = ddata.nbDatablocks();
 	int numECCodewords = numCodewords - numDataCodewords;
 
 	if (numCodewords < numDataCodewords)
 		throw FormatError("Invalid number of code words");
 
-	auto dataWords = ToInts<int>(rawbits, codewordSize, numCodewords, Size(rawbits) % codewordSize);
-
-	if (!ReedSolomonDecode(*gf, dataWords, numECCodewords))
+	int numCorrections = 0;
+	if (!ReedSolomonDecode(*gf, dataWords, numECCodewords, &numCorrections))
 		throw ChecksumError();
-
-	// drop the ECCodewords from the dataWords array
-	dataWords.resize(numDataCodewords);
-
-	// Now perform the unstuffing operation.
-	BitArray correctedBits;
-	// correctedBits.reserve(numDataCodewords * codewordSize - stuffedBits);
-	for (int dataWord : dataWords) {
+	ecUsage = numECCodewords ? std::min(1.f, 2.f * numCorrections / numECCodewords) : 0;
+
+	// Now perform the unstuffing operation, the bits are collected in an accumulator and written out byte by byte.
+	bytes.clear();
+	bytes.reserve((numDataCodewords * codewordSize + 7) / 8);
+	uint32_t acc = 0;
+	int accBits = 0;
+	for (int i = 0; i < numDataCodewords; ++i) {
+		int dataWord = dataWords[i];
 		if (dataWord == 0 || dataWord == (1 << codewordSize) - 1)
-			return {};
+			return 0;
 		else if (dataWord == 1) // next codewordSize-1 bits are all zeros or all ones
-			correctedBits.appendBits(0, codewordSize - 1);
+			acc <<= codewordSize - 1, accBits += codewordSize - 1;
 		else if (dataWord == (1 << codewordSize) - 2)
-			correctedBits.appendBits(0xffffffff, codewordSize - 1);
+			acc = (acc << (codewordSize - 1)) | ((1 << (codewordSize - 1)) - 1), accBits += codewordSize - 1;
 		else
-			correctedBits.appendBits(dataWord, codewordSize);
+			acc = (acc << codewordSize) | dataWord, accBits += codewordSize;
+
+		for (; accBits >= 8; accBits -= 8)
+			bytes.push_back(narrow_cast<uint8_t>((acc >> (accBits - 8)) & 0xff));
 	}
+	int numBits = 8 * Size(bytes) + accBits;
+	if (accBits)
+		bytes.push_back(narrow_cast<uint8_t>((acc << (8 - accBits)) & 0xff));
 
-	return correctedBits;
+	return numBits;
 }
 
 /**
@@ -209,7 +182,7 @@ static const char* GetCharacter(Table table, int code)
 /**
 * See ISO/IEC 24778:2008 Section 10.1
 */
-static ECI ParseECIValue(BitArrayView& bits, const int flg)
+static ECI ParseECIValue(BitSource& bits, const int flg)
 {
 	int eci = 0;
 	for (int i = 0; i < flg; i++)
@@ -249,14 +222,16 @@ static StructuredAppendInfo ParseStructuredAppend(ByteArray& bytes)
 	return sai;
 }
 
-static void DecodeContent(const BitArray& bits, Content& res)
+static void DecodeContent(const ByteArray& bytes, int numBits, Content& res)
 {
 	Table latchTable = Table::UPPER; // table most recently latched to
 	Table shiftTable = Table::UPPER; // table to use for the next read
 
-	auto remBits = BitArrayView(bits);
+	BitSource remBits(bytes, numBits);
+	// at most 2 characters ("\r\n", ". ", ...) per 5 bit code
+	res.reserve(numBits * 2 / 5 + 1);
 
-	while (remBits.size() >= (shiftTable == Table::DIGIT ? 4 : 5)) { // see ISO/IEC 24778:2008 7.3.1.2 regarding padding bits
+	while (remBits.available() >= (shiftTable == Table::DIGIT ? 4 : 5)) { // see ISO/IEC 24778:2008 7.3.1.2 regarding padding bits
 		if (shiftTable == Table::BINARY) {
 			int length = remBits.readBits(5);
 			if (length == 0)
@@ -298,15 +273,14 @@ static void DecodeContent(const BitArray& bits, Content& res)
 	}
 }
 
-ZXING_EXPORT_TEST_ONLY
-DecoderResult Decode(const BitArray& bits)
+static DecoderResult Decode(const ByteArray& bytes, int numBits)
 {
 	Content res;
 	res.symbology = {'z', '0', 3};
 
 	try {
-		DecodeContent(bits, res);
-	} catch (const std::exception&) { // see BitArrayView::readBits
+		DecodeContent(bytes, numBits, res);
+	} catch (const std::exception&) { // see BitSource::readBits
 		return FormatError();
 	}
 
@@ -314,8 +288,8 @@ DecoderResult Decode(const BitArray& bits)
 		return FormatError("Empty symbol content");
 
 	// Check for Structured Append - need 4 5-bit words, beginning with ML UL, ending with index and count
-	bool haveStructuredAppend = Size(bits) > 20 && ToInt(bits, 0, 5) == 29 // latch to MIXED (from UPPER)
-								&& ToInt(bits, 5, 5) == 29;                // latch back to UPPER (from MIXED)
+	// i.e. latch to MIXED (from UPPER) and latch back to UPPER (from MIXED)
+	bool haveStructuredAppend = numBits > 20 && BitSource(bytes, numBits).peakBits(10) == (29 << 5 | 29);
 
 	StructuredAppendInfo sai = haveStructuredAppend ? ParseStructuredAppend(res.bytes) : StructuredAppendInfo();
 
@@ -345,11 +319,20 @@ DecoderResult Decode(const BitArray& bits)
 	return DecoderResult(std::move(res)).setStructuredAppend(sai);
 }
 
+ZXING_EXPORT_TEST_ONLY
+DecoderResult Decode(const BitArray& bits)
+{
+	return Decode(bits.toBytes(), Size(bits));
+}
+
 DecoderResult Decode(const DetectorResult& detectorResult)
 {
+	StatsScope scope(DecodeStats::Stage::Decode);
 	try {
-		auto bits = CorrectBits(detectorResult, ExtractBits(detectorResult));
-		return Decode(bits);
+		thread_local ByteArray bytes;
+		float ecUsage = 0;
+		int numBits = CorrectBits(detectorResult, bytes, ecUsage);
+		return Decode(bytes, numBits).setEcUsage(ecUsage);
 	} catch (Error e) {
 		return e;
 	}
@@ -8,6 +8,7 @@
 #include "AZDetector.h"
 
 #include "AZDetectorResult.h"
+#include "BinaryBitmap.h"
 #include "BitArray.h"
 #include "BitHacks.h"
 #include "BitMatrix.h"
@@ -20,7 +21,9 @@
 #include "ZXAlgorithms.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <optional>
 #include <vector>
 
@@ -121,7 +124,8 @@ static std::vector<ConcentricPattern> FindPureFinderPattern(const BitMatrix& ima
 		return {};
 }
 
-static std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder)
+static std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder, Deadline deadline,
+														const BinaryBitmap* rowCache)
 {
 	std::vector<ConcentricPattern> res;
 
@@ -178,11 +182,11 @@ static std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image,
 	int skip = tryHarder ? 1 : std::clamp(image.height() / 2 / 100, 1, 5);
 	int margin = tryHarder ? 5 : image.height() / 4;
 
-	PatternRow row;
+	PatternRow buffer;
 
-	for (int y = margin; y < image.height() - margin; y += skip)
+	for (int y = margin; y < image.height() - margin && !IsExpired(deadline); y += skip)
 	{
-		GetPatternRow(image, y, row, false);
+		PatternView row = rowCache ? rowCache->getBitMatrixPatternRow(y) : (GetPatternRow(image, y, buffer, false), PatternView(buffer));
 		PatternView next = row;
 		next.shift(1); // the center pattern we are looking for starts with white and is 7 wide (compact code)
 
@@ -262,6 +266,98 @@ static uint32_t SampleOrientationBits(const BitMatrix& image, const PerspectiveT
 	return bits;
 }
 
+/**
+ * The mode message is a (7,2) (compact) or (10,4) Reed-Solomon code over GF(16), see GenericGF::AztecParam(). As the code
+ * is linear, the check words of a message are the XOR of the check words of its single data words, which are tabulated
+ * at compile time. This makes checking an undamaged mode message (the common case) two to four table lookups.
+ */
+struct ModeMessageCode
+{
+	int numData, numEC;
+	std::array<std::array<uint32_t, 16>, 4> checkWords = {}; // [position][data word], packed into nibbles
+
+	constexpr ModeMessageCode(int numData, int numEC) : numData(numData), numEC(numEC)
+	{
+		const auto& gf = GF_TABLES<0x13, 16>;
+		auto mul = [&gf](int a, int b) { return a && b ? gf.exp[(gf.log[a] + gf.log[b]) % 15] : 0; };
+
+		// generator polynomial (x - a^1)...(x - a^numEC), highest degree first
+		std::array<int, 7> g = {1};
+		for (int i = 1; i <= numEC; ++i)
+			for (int k = i; k > 0; --k)
+				g[k] ^= mul(g[k - 1], gf.exp[i]);
+
+		for (int pos = 0; pos < numData; ++pos)
+			for (int v = 1; v < 16; ++v) {
+				// remainder of the message with the single data word v at pos, computed like by an LFSR encoder
+				std::array<int, 6> ec = {};
+				for (int j = 0; j < numData; ++j) {
+					int feedback = (j == pos ? v : 0) ^ ec[0];
+					for (int k = 0; k < numEC - 1; ++k)
+						ec[k] = ec[k + 1] ^ mul(feedback, g[k + 1]);
+					ec[numEC - 1] = mul(feedback, g[numEC]);
+				}
+				for (int k = 0; k < numEC; ++k)
+					checkWords[pos][v] = (checkWords[pos][v] << 4) | ec[k];
+			}
+	}
+
+	constexpr uint32_t checkWordsOf(uint32_t data) const
+	{
+		uint32_t res = 0;
+		for (int pos = 0; pos < numData; ++pos)
+			res ^= checkWords[pos][(data >> 4 * (numData - 1 - pos)) & 0xF];
+		return res;
+	}
+};
+
+static constexpr ModeMessageCode COMPACT_MODE_MESSAGE(2, 5), FULL_MODE_MESSAGE(4, 6);
+
+// all 256 compact mode messages, data words followed by check words
+static constexpr auto COMPACT_MODE_MESSAGES = [] {
+	std::array<uint32_t, 256> res = {};
+	for (uint32_t data = 0; data < 256; ++data)
+		res[data] = (data << 20) | COMPACT_MODE_MESSAGE.checkWordsOf(data);
+	return res;
+}();
+
+// number of nibbles (GF(16) words) that are not 0
+static int NumNonZeroWords(uint32_t v)
+{
+	return BitHacks::CountBitsSet((v | v >> 1 | v >> 2 | v >> 3) & 0x11111111);
+}
+
+static int DecodeModeMessage(uint64_t bits, bool compact)
+{
+	const auto& code = compact ? COMPACT_MODE_MESSAGE : FULL_MODE_MESSAGE;
+	auto data = narrow_cast<uint32_t>(bits >> (4 * code.numEC));
+	if (code.checkWordsOf(data) == (bits & ((1u << (4 * code.numEC)) - 1)))
+		return data;
+
+	// the compact code has a minimum distance of 6, i.e. a message with at most 2 wrong words is the only one that close
+	if (compact) {
+		for (int i = 0; i < Size(COMPACT_MODE_MESSAGES); ++i)
+			if (NumNonZeroWords(COMPACT_MODE_MESSAGES[i] ^ narrow_cast<uint32_t>(bits)) <= 2)
+				return i;
+		return -1;
+	}
+
+	int numCodewords = code.numData + code.numEC;
+	std::vector<int> words(numCodewords);
+	for (int i = numCodewords - 1; i >= 0; --i) {
+		words[i] = narrow_cast<int>(bits & 0xF);
+		bits >>= 4;
+	}
+	if (!ReedSolomonDecode(GenericGF::AztecParam(), words, code.numEC))
+		return -1;
+
+	int res = 0;
+	for (int i = 0; i < code.numData; i++)
+		res = (res << 4) + words[i];
+
+	return res;
+}
+
 static int ModeMessage(const BitMatrix& image, const PerspectiveTransform& mod2Pix, int radius)
 {
 	const bool compact = radius == 5;
@@ -282,24 +378,7 @@ static int ModeMessage(const BitMatrix& image, const PerspectiveTransform& mod2P
 		}
 	}
 
-	// error correct bits
-	int numCodewords = compact ? 7 : 10;
-	int numDataCodewords = compact ? 2 : 4;
-	int numECCodewords = numCodewords - numDataCodewords;
-
-	std::vector<int> words(numCodewords);
-	for (int i = numCodewords - 1; i >= 0; --i) {
-		words[i] = narrow_cast<int>(bits & 0xF);
-		bits >>= 4;
-	}
-	if (!ReedSolomonDecode(GenericGF::AztecParam(), words, numECCodewords))
-		return -1;
-
-	int res = 0;
-	for (int i = 0; i < numDataCodewords; i++)
-		res = (res << 4) + words[i];
-
-	return res;
+	return DecodeModeMessage(bits, compact);
 }
 
 static void ExtractParameters(int modeMessage, bool compact, int& nbLayers, int& nbDataBlocks, bool& readerInit)
@@ -329,73 +408,152 @@ DetectorResult Detect(const BitMatrix& image, bool isPure, bool tryHarder)
 	return FirstOrDefault(Detect(image, isPure, tryHarder, 1));
 }
 
-DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int maxSymbols)
+std::vector<ConcentricPattern> FindCenterPatterns(const BitMatrix& image, bool isPure, bool tryHarder, Deadline deadline,
+												  const BinaryBitmap* rowCache)
 {
-#ifdef PRINT_DEBUG
-	LogMatrixWriter lmw(log, image, 5, "az-log.pnm");
-#endif
-
-	DetectorResults res;
-	auto fps = isPure ? FindPureFinderPattern(image) : FindFinderPatterns(image, tryHarder);
-	for (const auto& fp : fps) {
-		auto fpQuad = FindConcentricPatternCorners(image, fp, fp.size, 3);
-		if (!fpQuad)
-			continue;
+	return isPure ? FindPureFinderPattern(image) : FindFinderPatterns(image, tryHarder, deadline, rowCache);
+}
 
-		auto srcQuad = CenteredSquare(7);
-		auto mod2Pix = PerspectiveTransform(srcQuad, *fpQuad);
-		if (!mod2Pix.isValid())
-			continue;
+// fpQuad are the centers of the corner modules of the ring 3 modules away from the center. If fp is given, the sample
+// grid of full symbols gets refined by the ring 5 modules away.
+static DetectorResult SampleAztec(const BitMatrix& image, QuadrilateralF fpQuad, const ConcentricPattern* fp)
+{
+	auto srcQuad = CenteredSquare(7);
+	auto mod2Pix = PerspectiveTransform(srcQuad, fpQuad);
+	if (!mod2Pix.isValid())
+		return {};
 
-		int radius; // 5 or 7 (compact vs. full)
-		int mirror; // 0 or 1
-		int rotate; // [0..3]
-		int modeMessage = -1;
-		[&]() {
-			// 24778:2008(E) 14.3.3 reads:
-			// In the outer layer of the Core Symbol, the 12 orientation bits at the corners are bitwise compared against the specified
-			// pattern in each of four possible orientations and their four mirror inverse orientations as well. If in any of the 8
-			// cases checked as many as 9 of the 12 bits correctly match, that is deemed to be the correct orientation, otherwise
-			// decoding fails.
-			// Unfortunately, this seems to be wrong: there are 12-bit patterns in those 8 cases that differ only in 4 bits like
-			// 011'100'000'111 (rot90 && !mirror) and 111'000'001'110 (rot0 && mirror), meaning if two of those are wrong, both cases
-			// have a hamming distance of 2, meaning only 1 bit errors can be relyable recovered from. The following code therefore
-			// incorporates the complete set of mode message bits to help determine the orientation of the symbol. This is still not
-			// sufficient for the ErrorInModeMessageZero test case in AZDecoderTest.cpp but good enough for the author.
-			for (radius = 5; radius <= 7; radius += 2) {
-				uint32_t bits = SampleOrientationBits(image, mod2Pix, radius);
-				if (bits == 0)
+	int radius; // 5 or 7 (compact vs. full)
+	int mirror; // 0 or 1
+	int rotate; // [0..3]
+	int modeMessage = -1;
+	[&]() {
+		// 24778:2008(E) 14.3.3 reads:
+		// In the outer layer of the Core Symbol, the 12 orientation bits at the corners are bitwise compared against the specified
+		// pattern in each of four possible orientations and their four mirror inverse orientations as well. If in any of the 8
+		// cases checked as many as 9 of the 12 bits correctly match, that is deemed to be the correct orientation, otherwise
+		// decoding fails.
+		// Unfortunately, this seems to be wrong: there are 12-bit patterns in those 8 cases that differ only in 4 bits like
+		// 011'100'000'111 (rot90 && !mirror) and 111'000'001'110 (rot0 && mirror), meaning if two of those are wrong, both cases
+		// have a hamming distance of 2, meaning only 1 bit errors can be relyable recovered from. The following code therefore
+		// incorporates the complete set of mode message bits to help determine the orientation of the symbol. This is still not
+		// sufficient for the ErrorInModeMessageZero test case in AZDecoderTest.cpp but good enough for the author.
+		for (radius = 5; radius <= 7; radius += 2) {
+			uint32_t bits = SampleOrientationBits(image, mod2Pix, radius);
+			if (bits == 0)
+				continue;
+			for (mirror = 0; mirror <= 1; ++mirror) {
+				rotate = FindRotation(bits, mirror);
+				if (rotate == -1)
 					continue;
-				for (mirror = 0; mirror <= 1; ++mirror) {
-					rotate = FindRotation(bits, mirror);
-					if (rotate == -1)
-						continue;
-					modeMessage = ModeMessage(image, PerspectiveTransform(srcQuad, RotatedCorners(*fpQuad, rotate, mirror)), radius);
-					if (modeMessage != -1)
-						return;
-				}
+				modeMessage = ModeMessage(image, PerspectiveTransform(srcQuad, RotatedCorners(fpQuad, rotate, mirror)), radius);
+				if (modeMessage != -1)
+					return;
 			}
-		}();
+		}
+	}();
 
-		if (modeMessage == -1)
-			continue;
+	if (modeMessage == -1)
+		return {};
 
 #if 1
-		// improve prescision of sample grid by extrapolating from outer square of white pixels (5 edges away from center)
-		if (radius == 7) {
-			if (auto fpQuad5 = FindConcentricPatternCorners(image, fp, fp.size * 5 / 3, 5)) {
-				if (auto mod2Pix = PerspectiveTransform(CenteredSquare(11), *fpQuad5); mod2Pix.isValid()) {
-					int rotate5 = FindRotation(SampleOrientationBits(image, mod2Pix, radius), mirror);
-					if (rotate5 != -1) {
-						srcQuad = CenteredSquare(11);
-						fpQuad = fpQuad5;
-						rotate = rotate5;
-					}
+	// improve prescision of sample grid by extrapolating from outer square of white pixels (5 edges away from center)
+	if (radius == 7 && fp) {
+		if (auto fpQuad5 = FindConcentricPatternCorners(image, *fp, fp->size * 5 / 3, 5)) {
+			if (auto mod2Pix = PerspectiveTransform(CenteredSquare(11), *fpQuad5); mod2Pix.isValid()) {
+				int rotate5 = FindRotation(SampleOrientationBits(image, mod2Pix, radius), mirror);
+				if (rotate5 != -1) {
+					srcQuad = CenteredSquare(11);
+					fpQuad = *fpQuad5;
+					rotate = rotate5;
 				}
 			}
 		}
+	}
 #endif
-		*fpQuad = RotatedCorners(*fpQuad, rotate, mirror);
+	fpQuad = RotatedCorners(fpQuad, rotate, mirror);
+
+	int nbLayers = 0;
+	int nbDataBlocks = 0;
+	bool readerInit = false;
+	ExtractParameters(modeMessage, radius == 5, nbLayers, nbDataBlocks, readerInit);
+
+	int dim = radius == 5 ? 4 * nbLayers + 11 : 4 * nbLayers + 2 * ((2 * nbLayers + 6) / 15) + 15;
+	double low = dim / 2.0 + srcQuad[0].x;
+	double high = dim / 2.0 + srcQuad[2].x;
+
+	auto bits = SampleGrid(image, dim, dim, PerspectiveTransform{{PointF{low, low}, {high, low}, {high, high}, {low, high}}, fpQuad});
+	if (!bits.isValid())
+		return {};
+
+	return {std::move(bits), radius == 5, nbDataBlocks, nbLayers, readerInit, mirror != 0};
+}
+
+DetectorResult SampleAztec(const BitMatrix& image, const ConcentricPattern& fp)
+{
+	auto fpQuad = FindConcentricPatternCorners(image, fp, fp.size, 3);
+	if (!fpQuad)
+		return {};
+
+	return SampleAztec(image, *fpQuad, &fp);
+}
+
+/**
+ * Fast path for pure symbols: the bounding box is the symbol, so its center is the center of the bullseye and the 4 edges
+ * between the center and the black ring 4 modules away determine the module size. Skips the center pattern search and
+ * the corner fitting of SampleAztec(image, fp). Returns an invalid result if the image does not look like that.
+ */
+static DetectorResult DetectPure(const BitMatrix& image)
+{
+	int left, top, width, height;
+	if (!image.findBoundingBox(left, top, width, height, 11) || std::abs(width - height) > 1)
+		return {};
+
+	PointI center(left + width / 2, top + height / 2);
+	if (!image.get(center))
+		return {};
+
+	// the first pixel of the black ring 4 modules away in direction d, the outer edge of its 3.5 module distance
+	auto ring4 = [&](PointI d) {
+		auto cur = BitMatrixCursorI(image, center, d);
+		return cur.stepToEdge(4, width / 2) ? std::optional(cur.p) : std::nullopt;
+	};
+	auto l = ring4({-1, 0}), r = ring4({1, 0}), t = ring4({0, -1}), b = ring4({0, 1});
+	if (!l || !r || !t || !b)
+		return {};
+
+	// the bullseye is 7 modules wide between those edges
+	PointF ms((r->x - l->x - 1) / 7., (b->y - t->y - 1) / 7.);
+	PointF c((r->x + l->x + 1) / 2., (b->y + t->y + 1) / 2.);
+	if (ms.x < 1 || ms.y < 1 || std::abs(ms.x - ms.y) > 1)
+		return {};
+
+	auto res = SampleAztec(image, {c + PointF(-3 * ms.x, -3 * ms.y), c + PointF(3 * ms.x, -3 * ms.y), c + PointF(3 * ms.x, 3 * ms.y),
+								   c + PointF(-3 * ms.x, 3 * ms.y)},
+						   nullptr);
+	// the symbol has to fill the bounding box, otherwise the bullseye was not where we expected it
+	if (!res.isValid() || std::abs(res.bits().width() * ms.x - width) > ms.x || std::abs(res.bits().height() * ms.y - height) > ms.y)
+		return {};
+
+	return res;
+}
+
+DetectorResult ReadModules(const BitMatrix& modules)
+{
+	if (modules.width() != modules.height() || modules.width() % 2 == 0)
+		return {};
+
+	// map the module coordinates relative to the center onto the centers of the modules
+	auto srcQuad = CenteredSquare<PointF>(7);
+	auto center = PointF(modules.width() / 2 + .5, modules.height() / 2 + .5);
+	auto mod2Pix = PerspectiveTransform(srcQuad, {srcQuad[0] + center, srcQuad[1] + center, srcQuad[2] + center, srcQuad[3] + center});
+
+	for (int radius = 5; radius <= 7; radius += 2) {
+		if (FindRotation(SampleOrientationBits(modules, mod2Pix, radius), false) != 0)
+			continue;
+		int modeMessage = ModeMessage(modules, mod2Pix, radius);
+		if (modeMessage == -1)
+			continue;
 
 		int nbLayers = 0;
 		int nbDataBlocks = 0;
@@ -403,15 +561,42 @@ DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int
 		ExtractParameters(modeMessage, radius == 5, nbLayers, nbDataBlocks, readerInit);
 
 		int dim = radius == 5 ? 4 * nbLayers + 11 : 4 * nbLayers + 2 * ((2 * nbLayers + 6) / 15) + 15;
-		double low = dim / 2.0 + srcQuad[0].x;
-		double high = dim / 2.0 + srcQuad[2].x;
+		if (dim != modules.width())
+			continue;
+
+		return {{modules.copy(), Rectangle<PointI>(dim, dim, 0)}, radius == 5, nbDataBlocks, nbLayers, readerInit, false};
+	}
 
-		auto bits = SampleGrid(image, dim, dim, PerspectiveTransform{{PointF{low, low}, {high, low}, {high, high}, {low, high}}, *fpQuad});
-		if (!bits.isValid())
+	return {};
+}
+
+DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int maxSymbols, Deadline deadline,
+					   const BinaryBitmap* rowCache)
+{
+#ifdef PRINT_DEBUG
+	LogMatrixWriter lmw(log, image, 5, "az-log.pnm");
+#endif
+
+	DetectorResults res;
+	if (isPure) {
+		if (auto r = DetectPure(image); r.isValid()) {
+			res.push_back(std::move(r));
+			return res;
+		}
+	}
+
+	for (const auto& fp : FindCenterPatterns(image, isPure, tryHarder, deadline, rowCache)) {
+		if (IsExpired(deadline))
+			break;
+		// skip center patterns inside an already detected symbol, e.g. when its center got located twice
+		if (std::any_of(res.begin(), res.end(), [&](const auto& r) { return IsInside(PointI(fp), r.position()); }))
 			continue;
 
-		res.emplace_back(std::move(bits), radius == 5, nbDataBlocks, nbLayers, readerInit, mirror != 0);
+		auto r = SampleAztec(image, fp);
+		if (!r.isValid())
+			continue;
 
+		res.push_back(std::move(r));
 		if (Size(res) == maxSymbols)
 			break;
 	}
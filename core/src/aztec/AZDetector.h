@@ -6,16 +6,30 @@
 
 #pragma once
 
+#include "ConcentricFinder.h"
+#include "Deadline.h"
+
 #include <vector>
 
 namespace ZXing {
 
+class BinaryBitmap;
 class BitMatrix;
 
 namespace Aztec {
 
 class DetectorResult;
 
+// rowCache (optional) provides the cached pattern rows of image, see BinaryBitmap::getBitMatrixPatternRow()
+std::vector<ConcentricPattern> FindCenterPatterns(const BitMatrix& image, bool isPure, bool tryHarder,
+												  Deadline deadline = Deadline::max(), const BinaryBitmap* rowCache = nullptr);
+
+/**
+ * Reads the orientation and the mode message around the center pattern fp and samples the symbol. Returns an invalid
+ * result (without sampling anything) if the mode message fails its Reed-Solomon check.
+ */
+DetectorResult SampleAztec(const BitMatrix& image, const ConcentricPattern& fp);
+
 /**
  * Detects an Aztec Code in an image.
  *
@@ -23,8 +37,16 @@ class DetectorResult;
  */
 DetectorResult Detect(const BitMatrix& image, bool isPure, bool tryHarder = true);
 
+/**
+* Reads the mode message of an upright symbol given as its module matrix without quiet zone (e.g. from the Writer). The
+* modules themselves are the sample grid, so there is no detection involved.
+*/
+DetectorResult ReadModules(const BitMatrix& modules);
+
 using DetectorResults = std::vector<DetectorResult>;
-DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int maxSymbols);
+// rowCache (optional) provides the cached pattern rows of image, see BinaryBitmap::getBitMatrixPatternRow()
+DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int maxSymbols, Deadline deadline = Deadline::max(),
+					   const BinaryBitmap* rowCache = nullptr);
 
 } // Aztec
 } // ZXing
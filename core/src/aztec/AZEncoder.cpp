@@ -6,12 +6,14 @@
 
 #include "AZEncoder.h"
 
+#include "AZBitLayout.h"
 #include "AZHighLevelEncoder.h"
 #include "BitArray.h"
 #include "GenericGF.h"
 #include "ReedSolomonEncoder.h"
 #include "ZXTestSupport.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <stdexcept>
 #include <vector>
@@ -121,36 +123,47 @@ static void DrawModeMessage(BitMatrix& matrix, bool compact, int matrixSize, con
 	}
 }
 
-ZXING_EXPORT_TEST_ONLY
-void StuffBits(const BitArray& bits, int wordSize, BitArray& out)
+// Calls func with each word of the bits stuffed according to ISO/IEC 24778:2008 7.3.1.2 (see StuffBits)
+template <typename FUNC>
+static void ForEachStuffedWord(const BitArray& bits, int wordSize, FUNC func)
 {
-	out = BitArray();
+	if (wordSize < 2 || wordSize > 12)
+		throw std::invalid_argument("Unsupported word size " + std::to_string(wordSize));
+
 	int n = bits.size();
 	int mask = (1 << wordSize) - 2;
-	for (int i = 0; i < n; i += wordSize) {
-		int word = 0;
-		for (int j = 0; j < wordSize; j++) {
-			if (i + j >= n || bits.get(i + j)) {
-				word |= 1 << (wordSize - 1 - j);
-			}
-		}
+	for (int i = 0; i < n;) {
+		// the bits past the end are padded with 1s
+		int avail = std::min(wordSize, n - i);
+		int word = (bits.getBits(i, avail) << (wordSize - avail)) | ((1 << (wordSize - avail)) - 1);
+		// a word of all 0s or all 1s gets its last bit replaced by the complement, which is then part of the next word
 		if ((word & mask) == mask) {
-			out.appendBits(word & mask, wordSize);
-			i--;
+			func(word & mask);
+			i += wordSize - 1;
 		}
 		else if ((word & mask) == 0) {
-			out.appendBits(word | 1, wordSize);
-			i--;
+			func(word | 1);
+			i += wordSize - 1;
 		}
 		else {
-			out.appendBits(word, wordSize);
+			func(word);
+			i += wordSize;
 		}
 	}
 }
 
-static int TotalBitsInLayer(int layers, bool compact)
+ZXING_EXPORT_TEST_ONLY
+void StuffBits(const BitArray& bits, int wordSize, BitArray& out)
+{
+	out = BitArray();
+	ForEachStuffedWord(bits, wordSize, [&](int word) { out.appendBits(word, wordSize); });
+}
+
+static int NumStuffedWords(const BitArray& bits, int wordSize)
 {
-	return ((compact ? 88 : 112) + 16 * layers) * layers;
+	int res = 0;
+	ForEachStuffedWord(bits, wordSize, [&](int) { ++res; });
+	return res;
 }
 
 /**
@@ -168,14 +181,19 @@ Encoder::Encode(const std::string& data, int minECCPercent, int userSpecifiedLay
 	// High-level encode
 	BitArray bits = HighLevelEncoder::Encode(data);
 
-	// stuff bits and choose symbol size
+	// choose the symbol size, the stuffed size only depends on the word size, so it is counted once per word size
 	int eccBits = bits.size() * minECCPercent / 100 + 11;
 	int totalSizeBits = bits.size() + eccBits;
+	int numStuffedWords[13] = {}; // indexed by word size
+	auto stuffedBits = [&](int wordSize) {
+		if (!numStuffedWords[wordSize])
+			numStuffedWords[wordSize] = NumStuffedWords(bits, wordSize);
+		return numStuffedWords[wordSize] * wordSize;
+	};
 	bool compact;
 	int layers;
 	int totalBitsInLayer;
 	int wordSize;
-	BitArray stuffedBits;
 	if (userSpecifiedLayers != DEFAULT_AZTEC_LAYERS) {
 		compact = userSpecifiedLayers < 0;
 		layers = std::abs(userSpecifiedLayers);
@@ -185,17 +203,15 @@ Encoder::Encode(const std::string& data, int minECCPercent, int userSpecifiedLay
 		totalBitsInLayer = TotalBitsInLayer(layers, compact);
 		wordSize = WORD_SIZE[layers];
 		int usableBitsInLayers = totalBitsInLayer - (totalBitsInLayer % wordSize);
-		StuffBits(bits, wordSize, stuffedBits);
-		if (stuffedBits.size() + eccBits > usableBitsInLayers) {
+		if (stuffedBits(wordSize) + eccBits > usableBitsInLayers) {
 			throw std::invalid_argument("Data to large for user specified layer");
 		}
-		if (compact && stuffedBits.size() > wordSize * 64) {
+		if (compact && stuffedBits(wordSize) > wordSize * 64) {
 			// Compact format only allows 64 data words, though C4 can hold more words than that
 			throw std::invalid_argument("Data to large for user specified layer");
 		}
 	}
 	else {
-		wordSize = 0;
 		// We look at the possible table sizes in the order Compact1, Compact2, Compact3,
 		// Compact4, Normal4,...  Normal(i) for i < 4 isn't typically used since Compact(i+1)
 		// is the same size, but has more data.
@@ -209,76 +225,44 @@ Encoder::Encode(const std::string& data, int minECCPercent, int userSpecifiedLay
 			if (totalSizeBits > totalBitsInLayer) {
 				continue;
 			}
-			// [Re]stuff the bits if this is the first opportunity, or if the
-			// wordSize has changed
-			if (wordSize != WORD_SIZE[layers]) {
-				wordSize = WORD_SIZE[layers];
-				StuffBits(bits, wordSize, stuffedBits);
-			}
+			wordSize = WORD_SIZE[layers];
 			int usableBitsInLayers = totalBitsInLayer - (totalBitsInLayer % wordSize);
-			if (compact && stuffedBits.size() > wordSize * 64) {
+			if (compact && stuffedBits(wordSize) > wordSize * 64) {
 				// Compact format only allows 64 data words, though C4 can hold more words than that
 				continue;
 			}
-			if (stuffedBits.size() + eccBits <= usableBitsInLayers) {
+			if (stuffedBits(wordSize) + eccBits <= usableBitsInLayers) {
 				break;
 			}
 		}
 	}
-	BitArray messageBits;
-	GenerateCheckWords(stuffedBits, totalBitsInLayer, wordSize, messageBits);
+
+	// stuff the bits once for the chosen word size and append the check words
+	int messageSizeInWords = numStuffedWords[wordSize];
+	std::vector<int> messageWords;
+	messageWords.reserve(totalBitsInLayer / wordSize);
+	ForEachStuffedWord(bits, wordSize, [&](int word) { messageWords.push_back(word); });
+	messageWords.resize(totalBitsInLayer / wordSize);
+	ReedSolomonEncode(GetGFFromWordSize(wordSize), messageWords, Size(messageWords) - messageSizeInWords);
 
 	// generate mode message
-	int messageSizeInWords = stuffedBits.size() / wordSize;
 	BitArray modeMessage;
 	GenerateModeMessage(compact, layers, messageSizeInWords, modeMessage);
 
 	// allocate symbol
 	int baseMatrixSize = (compact ? 11 : 14) + layers * 4; // not including alignment lines
-	std::vector<int> alignmentMap(baseMatrixSize, 0);
-	int matrixSize;
-	if (compact) {
-		// no alignment marks in compact mode, alignmentMap is a no-op
-		matrixSize = baseMatrixSize;
-		std::iota(alignmentMap.begin(), alignmentMap.end(), 0);
-	}
-	else {
-		matrixSize = baseMatrixSize + 1 + 2 * ((baseMatrixSize / 2 - 1) / 15);
-		int origCenter = baseMatrixSize / 2;
-		int center = matrixSize / 2;
-		for (int i = 0; i < origCenter; i++) {
-			int newOffset = i + i / 15;
-			alignmentMap[origCenter - i - 1] = center - newOffset - 1;
-			alignmentMap[origCenter + i] = center + newOffset + 1;
-		}
-	}
+	int matrixSize = compact ? baseMatrixSize : baseMatrixSize + 1 + 2 * ((baseMatrixSize / 2 - 1) / 15);
 
 	EncodeResult output{compact, matrixSize, layers, messageSizeInWords, BitMatrix(matrixSize)};
 
 	BitMatrix& matrix = output.matrix;
 
-	// draw data bits
-	for (int i = 0, rowOffset = 0; i < layers; i++) {
-		int rowSize = (layers - i) * 4 + (compact ? 9 : 12);
-		for (int j = 0; j < rowSize; j++) {
-			int columnOffset = j * 2;
-			for (int k = 0; k < 2; k++) {
-				if (messageBits.get(rowOffset + columnOffset + k)) {
-					matrix.set(alignmentMap[i * 2 + k], alignmentMap[i * 2 + j]);
-				}
-				if (messageBits.get(rowOffset + rowSize * 2 + columnOffset + k)) {
-					matrix.set(alignmentMap[i * 2 + j], alignmentMap[baseMatrixSize - 1 - i * 2 - k]);
-				}
-				if (messageBits.get(rowOffset + rowSize * 4 + columnOffset + k)) {
-					matrix.set(alignmentMap[baseMatrixSize - 1 - i * 2 - k], alignmentMap[baseMatrixSize - 1 - i * 2 - j]);
-				}
-				if (messageBits.get(rowOffset + rowSize * 6 + columnOffset + k)) {
-					matrix.set(alignmentMap[baseMatrixSize - 1 - i * 2 - j], alignmentMap[i * 2 + k]);
-				}
-			}
-		}
-		rowOffset += rowSize * 8;
-	}
+	// draw data bits, the message words are right aligned in the layers, i.e. preceded by totalBitsInLayer % wordSize 0s
+	const auto& layout = BitLayout(compact, layers);
+	for (int i = 0, pos = totalBitsInLayer % wordSize; i < Size(messageWords); ++i)
+		for (int bit = wordSize - 1; bit >= 0; --bit, ++pos)
+			if ((messageWords[i] >> bit) & 1)
+				matrix.set(layout[pos].x, layout[pos].y);
 
 	// draw mode message
 	DrawModeMessage(matrix, compact, matrixSize, modeMessage);
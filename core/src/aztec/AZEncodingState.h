@@ -6,14 +6,8 @@
 
 #pragma once
 
-#include "AZToken.h"
-
-#include <vector>
-
 namespace ZXing::Aztec {
 
-class Token;
-
 /**
 * State represents all information about a sequence necessary to generate the current output.
 * Note that a state is immutable.
@@ -21,9 +15,10 @@ class Token;
 class EncodingState
 {
 public:
-	// The list of tokens that we output.  If we are in Binary Shift mode, this
-	// token list does *not* yet included the token for those bytes
-	std::vector<Token> tokens;
+	// Index of the last token that we output in the encoder's token arena (-1 if
+	// none). The tokens form a chain back to the start. If we are in Binary Shift
+	// mode, this chain does *not* yet include the token for those bytes
+	int lastToken = -1;
 
 	// The current mode of the encoding (or the mode to which we'll return if
 	// we're in Binary Shift mode.
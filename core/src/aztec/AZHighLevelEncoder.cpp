@@ -14,7 +14,6 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <list>
 #include <vector>
 
 namespace ZXing::Aztec {
@@ -66,9 +65,8 @@ static const std::array<std::array<int, 5>, 5> LATCH_TABLE = {
 
 // A reverse mapping from [mode][char] to the encoding for that character
 // in that mode.  An entry of 0 indicates no mapping exists.
-static const std::array<std::array<int8_t, 256>, 5>& InitCharMap()
-{
-	static std::array<std::array<int8_t, 256>, 5> charmap = {};
+static constexpr auto CHAR_MAP = [] {
+	std::array<std::array<int8_t, 256>, 5> charmap = {};
 	charmap[MODE_UPPER][' '] = 1;
 	for (int c = 'A'; c <= 'Z'; c++) {
 		charmap[MODE_UPPER][c] = c - 'A' + 2;
@@ -87,28 +85,25 @@ static const std::array<std::array<int8_t, 256>, 5>& InitCharMap()
 		0x00, 0x20, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c,
 		0x0d, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x40, 0x5c, 0x5e, 0x5f, 0x60, 0x7c, 0x7d, 0x7f,
 	};
-	for (uint8_t i = 0; i < Size(mixedTable); i++) {
+	for (int8_t i = 0; i < Size(mixedTable); i++) {
 		charmap[MODE_MIXED][mixedTable[i]] = i;
 	}
 	const char punctTable[] = {'\0', '\r', '\0', '\0', '\0', '\0', '!', '\'', '#', '$', '%', '&', '\'', '(', ')', '*',
 							   '+',  ',',  '-',  '.',  '/',  ':',  ';', '<',  '=', '>', '?', '[', ']',  '{', '}'};
-	for (uint8_t i = 0; i < Size(punctTable); i++) {
+	for (int8_t i = 0; i < Size(punctTable); i++) {
 		if (punctTable[i] > 0) {
 			charmap[MODE_PUNCT][punctTable[i]] = i;
 		}
 	}
 	return charmap;
-}
-const std::array<std::array<int8_t, 256>, 5>& CHAR_MAP = InitCharMap();
+}();
 
 // A map showing the available shift codes.  (The shifts to BINARY are not shown
-static const std::array<std::array<int8_t, 6>, 6>& InitShiftTable()
-{
-	static std::array<std::array<int8_t, 6>, 6> table;
-
-	for (auto& row : table) {
-		std::fill(row.begin(), row.end(), -1);
-	}
+static constexpr auto SHIFT_TABLE = [] {
+	std::array<std::array<int8_t, 6>, 6> table = {};
+	for (auto& row : table)
+		for (auto& v : row)
+			v = -1;
 	table[MODE_UPPER][MODE_PUNCT] = 0;
 	table[MODE_LOWER][MODE_PUNCT] = 0;
 	table[MODE_LOWER][MODE_UPPER] = 28;
@@ -116,64 +111,78 @@ static const std::array<std::array<int8_t, 6>, 6>& InitShiftTable()
 	table[MODE_DIGIT][MODE_PUNCT] = 0;
 	table[MODE_DIGIT][MODE_UPPER] = 15;
 	return table;
-}
+}();
+
+// All tokens generated during one Encode() call live in a single arena. A token
+// only links back to its predecessor, so states sharing a prefix share its
+// tokens and deriving a new state never copies the chain.
+struct TokenNode
+{
+	Token token;
+	int prev;
+};
 
-const std::array<std::array<int8_t, 6>, 6>& SHIFT_TABLE = InitShiftTable();
+using TokenArena = std::vector<TokenNode>;
+
+static int AddToken(TokenArena& arena, int prev, Token token)
+{
+	arena.push_back({token, prev});
+	return Size(arena) - 1;
+}
 
 // Create a new state representing this state with a latch to a (not
 // necessary different) mode, and then a code.
-static EncodingState LatchAndAppend(const EncodingState& state, int mode, int value)
+static EncodingState LatchAndAppend(TokenArena& arena, const EncodingState& state, int mode, int value)
 {
 	//assert binaryShiftByteCount == 0;
 	int bitCount = state.bitCount;
-	auto tokens = state.tokens;
+	int tokens = state.lastToken;
 	if (mode != state.mode) {
 		int latch = LATCH_TABLE[state.mode][mode];
-		tokens.push_back(Token::CreateSimple(latch & 0xFFFF, latch >> 16));
+		tokens = AddToken(arena, tokens, Token::CreateSimple(latch & 0xFFFF, latch >> 16));
 		bitCount += latch >> 16;
 	}
 	int latchModeBitCount = mode == MODE_DIGIT ? 4 : 5;
-	tokens.push_back(Token::CreateSimple(value, latchModeBitCount));
+	tokens = AddToken(arena, tokens, Token::CreateSimple(value, latchModeBitCount));
 	return EncodingState{ tokens, mode, 0, bitCount + latchModeBitCount };
 }
 
 // Create a new state representing this state, with a temporary shift
 // to a different mode to output a single value.
-static EncodingState ShiftAndAppend(const EncodingState& state, int mode, int value)
+static EncodingState ShiftAndAppend(TokenArena& arena, const EncodingState& state, int mode, int value)
 {
 	//assert binaryShiftByteCount == 0 && this.mode != mode;
 	int thisModeBitCount = state.mode == MODE_DIGIT ? 4 : 5;
 	// Shifts exist only to UPPER and PUNCT, both with tokens size 5.
-	auto tokens = state.tokens;
-	tokens.push_back(Token::CreateSimple(SHIFT_TABLE[state.mode][mode], thisModeBitCount));
-	tokens.push_back(Token::CreateSimple(value, 5));
+	int tokens = AddToken(arena, state.lastToken, Token::CreateSimple(SHIFT_TABLE[state.mode][mode], thisModeBitCount));
+	tokens = AddToken(arena, tokens, Token::CreateSimple(value, 5));
 	return EncodingState{ tokens, state.mode, 0, state.bitCount + thisModeBitCount + 5 };
 }
 
 // Create the state identical to this one, but we are no longer in
 // Binary Shift mode.
-static EncodingState EndBinaryShift(const EncodingState& state, int index)
+static EncodingState EndBinaryShift(TokenArena& arena, const EncodingState& state, int index)
 {
 	if (state.binaryShiftByteCount == 0) {
 		return state;
 	}
-	auto tokens = state.tokens;
-	tokens.push_back(Token::CreateBinaryShift(index - state.binaryShiftByteCount, state.binaryShiftByteCount));
+	int tokens = AddToken(arena, state.lastToken,
+						  Token::CreateBinaryShift(index - state.binaryShiftByteCount, state.binaryShiftByteCount));
 	//assert token.getTotalBitCount() == this.bitCount;
 	return EncodingState{ tokens, state.mode, 0, state.bitCount };
 }
 
 // Create a new state representing this state, but an additional character
 // output in Binary Shift mode.
-static EncodingState AddBinaryShiftChar(const EncodingState& state, int index)
+static EncodingState AddBinaryShiftChar(TokenArena& arena, const EncodingState& state, int index)
 {
-	auto tokens = state.tokens;
+	int tokens = state.lastToken;
 	int mode = state.mode;
 	int bitCount = state.bitCount;
 	if (state.mode == MODE_PUNCT || state.mode == MODE_DIGIT) {
 		//assert binaryShiftByteCount == 0;
 		int latch = LATCH_TABLE[mode][MODE_UPPER];
-		tokens.push_back(Token::CreateSimple(latch & 0xFFFF, latch >> 16));
+		tokens = AddToken(arena, tokens, Token::CreateSimple(latch & 0xFFFF, latch >> 16));
 		bitCount += latch >> 16;
 		mode = MODE_UPPER;
 	}
@@ -181,7 +190,7 @@ static EncodingState AddBinaryShiftChar(const EncodingState& state, int index)
 	EncodingState result{ tokens, mode, state.binaryShiftByteCount + 1, bitCount + deltaBitCount };
 	if (result.binaryShiftByteCount == 2047 + 31) {
 		// The string is as long as it's allowed to be.  We should end it.
-		result = EndBinaryShift(result, index + 1);
+		result = EndBinaryShift(arena, result, index + 1);
 	}
 	return result;
 }
@@ -216,44 +225,52 @@ static bool IsBetterThanOrEqualTo(const EncodingState& state, const EncodingStat
 	return newModeBitCount <= other.bitCount;
 }
 
-static BitArray ToBitArray(const EncodingState& state, const std::string& text)
+static BitArray ToBitArray(TokenArena& arena, const EncodingState& state, const std::string& text)
 {
-	auto endState = EndBinaryShift(state, Size(text));
+	auto endState = EndBinaryShift(arena, state, Size(text));
+	// The chain runs backwards from the last token, collect it first.
+	std::vector<int> chain;
+	for (int i = endState.lastToken; i >= 0; i = arena[i].prev) {
+		chain.push_back(i);
+	}
 	BitArray bits;
 	// Add each token to the result.
-	for (const Token& symbol : endState.tokens) {
-		symbol.appendTo(bits, text);
+	for (auto i = chain.rbegin(); i != chain.rend(); ++i) {
+		arena[*i].token.appendTo(bits, text);
 	}
 	//assert bitArray.getSize() == this.bitCount;
 	return bits;
 }
 
-static void UpdateStateForPair(const EncodingState& state, int index, int pairCode, std::list<EncodingState>& result)
+static void UpdateStateForPair(TokenArena& arena, const EncodingState& state, int index, int pairCode,
+							   std::vector<EncodingState>& result)
 {
-	EncodingState stateNoBinary = EndBinaryShift(state, index);
+	EncodingState stateNoBinary = EndBinaryShift(arena, state, index);
 	// Possibility 1.  Latch to MODE_PUNCT, and then append this code
-	result.push_back(LatchAndAppend(stateNoBinary, MODE_PUNCT, pairCode));
+	result.push_back(LatchAndAppend(arena, stateNoBinary, MODE_PUNCT, pairCode));
 	if (state.mode != MODE_PUNCT) {
 		// Possibility 2.  Shift to MODE_PUNCT, and then append this code.
 		// Every state except MODE_PUNCT (handled above) can shift
-		result.push_back(ShiftAndAppend(stateNoBinary, MODE_PUNCT, pairCode));
+		result.push_back(ShiftAndAppend(arena, stateNoBinary, MODE_PUNCT, pairCode));
 	}
 	if (pairCode == 3 || pairCode == 4) {
 		// both characters are in DIGITS.  Sometimes better to just add two digits
-		auto digitState = LatchAndAppend(stateNoBinary, MODE_DIGIT, 16 - pairCode);	// period or comma in DIGIT
-		result.push_back(LatchAndAppend(digitState, MODE_DIGIT, 1));				// space in DIGIT
+		auto digitState = LatchAndAppend(arena, stateNoBinary, MODE_DIGIT, 16 - pairCode);	// period or comma in DIGIT
+		result.push_back(LatchAndAppend(arena, digitState, MODE_DIGIT, 1));				// space in DIGIT
 	}
 	if (state.binaryShiftByteCount > 0) {
 		// It only makes sense to do the characters as binary if we're already
 		// in binary mode.
-		result.push_back(AddBinaryShiftChar(AddBinaryShiftChar(state, index), index + 1));
+		result.push_back(AddBinaryShiftChar(arena, AddBinaryShiftChar(arena, state, index), index + 1));
 	}
 }
 
-
-static std::list<EncodingState> SimplifyStates(const std::list<EncodingState>& states)
+// Reduce the candidate states to the ones not dominated by another one. The
+// surviving set is bounded by the handful of (mode, binary shift) combinations
+// worth keeping, so the search stays linear in the text length.
+static void SimplifyStates(const std::vector<EncodingState>& states, std::vector<EncodingState>& result)
 {
-	std::list<EncodingState> result;
+	result.clear();
 	for (auto& newState : states) {
 		bool add = true;
 		for (auto iterator = result.begin(); iterator != result.end();) {
@@ -273,24 +290,13 @@ static std::list<EncodingState> SimplifyStates(const std::list<EncodingState>& s
 			result.push_back(newState);
 		}
 	}
-	return result;
 }
 
-static std::list<EncodingState> UpdateStateListForPair(const std::list<EncodingState>& states, int index, int pairCode)
-{
-	std::list<EncodingState> result;
-	for (auto& state : states) {
-		UpdateStateForPair(state, index, pairCode, result);
-	}
-	return SimplifyStates(result);
-}
-
-
-
 // Return a set of states that represent the possible ways of updating this
 // state for the next character.  The resulting set of states are added to
 // the "result" list.
-static void UpdateStateForChar(const EncodingState& state, const std::string& text, int index, std::list<EncodingState>& result)
+static void UpdateStateForChar(TokenArena& arena, const EncodingState& state, const std::string& text, int index,
+							   std::vector<EncodingState>& result)
 {
 	int ch = text[index] & 0xff;
 	bool charInCurrentTable = CHAR_MAP[state.mode][ch] > 0;
@@ -301,7 +307,7 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 		if (charInMode > 0) {
 			if (firstTime) {
 				// Only create stateNoBinary the first time it's required.
-				stateNoBinary = EndBinaryShift(state, index);
+				stateNoBinary = EndBinaryShift(arena, state, index);
 				firstTime = false;
 			}
 			// Try generating the character by latching to its mode
@@ -310,13 +316,13 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 				// any other mode except possibly digit (which uses only 4 bits).  Any
 				// other latch would be equally successful *after* this character, and
 				// so wouldn't save any bits.
-				result.push_back(LatchAndAppend(stateNoBinary, mode, charInMode));
+				result.push_back(LatchAndAppend(arena, stateNoBinary, mode, charInMode));
 			}
 			// Try generating the character by switching to its mode.
 			if (!charInCurrentTable && SHIFT_TABLE[state.mode][mode] >= 0) {
 				// It never makes sense to temporarily shift to another mode if the
 				// character exists in the current mode.  That can never save bits.
-				result.push_back(ShiftAndAppend(stateNoBinary, mode, charInMode));
+				result.push_back(ShiftAndAppend(arena, stateNoBinary, mode, charInMode));
 			}
 		}
 	}
@@ -324,30 +330,27 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 		// It's never worthwhile to go into binary shift mode if you're not already
 		// in binary shift mode, and the character exists in your current mode.
 		// That can never save bits over just outputting the char in the current mode.
-		result.push_back(AddBinaryShiftChar(state, index));
+		result.push_back(AddBinaryShiftChar(arena, state, index));
 	}
 }
 
-// We update a set of states for a new character by updating each state
-// for the new character, merging the results, and then removing the
-// non-optimal states.
-static std::list<EncodingState> UpdateStateListForChar(const std::list<EncodingState>& states, const std::string& text, int index)
-{
-	std::list<EncodingState> result;
-	for (auto& state : states) {
-		UpdateStateForChar(state, text, index, result);
-	}
-	return result.size() > 1 ? SimplifyStates(result) : result;
-}
-
 /**
 * @return text represented by this encoder encoded as a {@link BitArray}
 */
 BitArray
 HighLevelEncoder::Encode(const std::string& text)
 {
-	std::list<EncodingState> states;
-	states.push_back(EncodingState{ std::vector<Token>(), MODE_UPPER, 0, 0 });
+	// Every state produces at most a few tokens per character, reserve enough
+	// up front that the arena rarely has to grow.
+	TokenArena arena;
+	arena.reserve(8 * Size(text) + 16);
+	std::vector<EncodingState> states, candidates;
+	states.reserve(32);
+	candidates.reserve(64);
+	states.push_back(EncodingState{ -1, MODE_UPPER, 0, 0 });
+	// We update the set of states for each new character (or special pair) by
+	// updating each state, collecting the results and then removing the
+	// non-optimal states.
 	for (int index = 0; index < Size(text); index++) {
 		int pairCode;
 		int nextChar = index + 1 < Size(text) ? text[index + 1] : 0;
@@ -361,17 +364,23 @@ HighLevelEncoder::Encode(const std::string& text)
 		if (pairCode > 0) {
 			// We have one of the four special PUNCT pairs.  Treat them specially.
 			// Get a new set of states for the two new characters.
-			states = UpdateStateListForPair(states, index, pairCode);
+			for (auto& state : states) {
+				UpdateStateForPair(arena, state, index, pairCode, candidates);
+			}
 			index++;
 		} else {
 			// Get a new set of states for the new character.
-			states = UpdateStateListForChar(states, text, index);
+			for (auto& state : states) {
+				UpdateStateForChar(arena, state, text, index, candidates);
+			}
 		}
+		SimplifyStates(candidates, states);
+		candidates.clear();
 	}
 	// We are left with a set of states.  Find the shortest one.
 	EncodingState minState = *std::min_element(states.begin(), states.end(), [](const EncodingState& a, const EncodingState& b) { return a.bitCount < b.bitCount; });
 	// Convert it to a bit array, and return.
-	return ToBitArray(minState, text);
+	return ToBitArray(arena, minState, text);
 }
 
 } // namespace ZXing::Aztec
@@ -13,16 +13,23 @@
 #include "BinaryBitmap.h"
 #include "DecodeHints.h"
 #include "DecoderResult.h"
+#include "Executor.h"
+#include "Quadrilateral.h"
 #include "Result.h"
+#include "StatsScope.h"
+#include "TraceScope.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace ZXing::Aztec {
 
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
+	ZX_TRACE_SCOPE("Aztec::Reader::decode");
 	auto binImg = image.getBitMatrix();
 	if (binImg == nullptr)
 		return {};
@@ -30,6 +37,10 @@ Reader::decode(const BinaryBitmap& image) const
 	DetectorResult detectorResult = Detect(*binImg, _hints.isPure(), _hints.tryHarder());
 	if (!detectorResult.isValid())
 		return {};
+	if (_hints.detectOnly()) {
+		auto modules = std::make_shared<const BitMatrix>(std::move(detectorResult).bits());
+		return Result(std::move(detectorResult).position(), BarcodeFormat::Aztec, std::move(modules));
+	}
 
 	auto decodeResult = Decode(detectorResult)
 							.setReaderInit(detectorResult.readerInit())
@@ -39,26 +50,120 @@ Reader::decode(const BinaryBitmap& image) const
 	return Result(std::move(decodeResult), std::move(detectorResult).position(), BarcodeFormat::Aztec);
 }
 
-Results Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+// The center pattern search is done on the first call of next(), then every call evaluates one chunk of candidates.
+class Candidates : public CandidateStream
 {
-	auto binImg = image.getBitMatrix();
-	if (binImg == nullptr)
-		return {};
+	const BinaryBitmap& _image;
+	const DecodeHints& _hints;
+	const BitMatrix* _binImg = nullptr;
+	bool _found = false;
+	std::vector<ConcentricPattern> _fps;
+	std::vector<QuadrilateralI> _used;
+	int _next = 0;
 
-	auto detRess = Detect(*binImg, _hints.isPure(), _hints.tryHarder(), maxSymbols);
+	struct Candidate
+	{
+		DetectorResult detectorResult;
+		DecoderResult decoderResult;
+	};
+	std::vector<int> _todo;
+	std::vector<Candidate> _candidates;
 
-	Results results;
-	for (auto&& detRes : detRess) {
-		auto decRes =
-			Decode(detRes).setReaderInit(detRes.readerInit()).setIsMirrored(detRes.isMirrored()).setVersionNumber(detRes.nbLayers());
-		if (decRes.isValid(_hints.returnErrors())) {
-			results.emplace_back(std::move(decRes), std::move(detRes).position(), BarcodeFormat::Aztec);
-			if (maxSymbols > 0 && Size(results) >= maxSymbols)
-				break;
+	// a center pattern inside an already found symbol is a duplicate (e.g. located twice) or a false positive
+	bool isUsed(const ConcentricPattern& fp) const
+	{
+		return std::any_of(_used.begin(), _used.end(), [p = PointI(fp)](const QuadrilateralI& q) { return IsInside(p, q); });
+	}
+
+	void evaluate(int i)
+	{
+		if (IsExpired(_hints.deadline()))
+			return;
+		// SampleAztec rejects all candidates without a valid mode message before sampling the grid
+		auto detectorResult = SampleAztec(*_binImg, _fps[_todo[i]]);
+		if (!detectorResult.isValid() || _hints.detectOnly())
+			return void(_candidates[i].detectorResult = std::move(detectorResult));
+		auto decoderResult = Decode(detectorResult)
+								 .setReaderInit(detectorResult.readerInit())
+								 .setIsMirrored(detectorResult.isMirrored())
+								 .setVersionNumber(detectorResult.nbLayers());
+		_candidates[i] = {std::move(detectorResult), std::move(decoderResult)};
+	}
+
+	// With an executor, the candidates are sampled and decoded speculatively in chunks of a few per thread and then
+	// accepted in the original order, see QRCode::Reader::decode().
+	void nextChunk(Results& results)
+	{
+		auto executor = _image.executor();
+		const int chunkSize = executor ? 4 * executor->concurrency() : 1;
+
+		_todo.clear();
+		for (int end = std::min(_next + chunkSize, Size(_fps)); _next < end; ++_next)
+			if (!isUsed(_fps[_next]))
+				_todo.push_back(_next);
+
+		_candidates.clear();
+		_candidates.resize(_todo.size());
+		if (executor && Size(_todo) > 1)
+			executor->parallelFor(Size(_todo), [this, stats = CurrentStats()](int i) {
+				StatsContext context(stats); // in case this runs on an executor thread
+				evaluate(i);
+			});
+		else
+			for (int i = 0; i < Size(_todo); ++i)
+				evaluate(i);
+
+		for (int i = 0; i < Size(_todo); ++i) {
+			auto& [detRes, decRes] = _candidates[i];
+			if (!detRes.isValid() || isUsed(_fps[_todo[i]]))
+				continue;
+			if (_hints.detectOnly()) {
+				auto modules = std::make_shared<const BitMatrix>(std::move(detRes).bits());
+				results.emplace_back(std::move(detRes).position(), BarcodeFormat::Aztec, std::move(modules));
+			}
+			else if (decRes.isValid(_hints.returnErrors()))
+				results.emplace_back(std::move(decRes), std::move(detRes).position(), BarcodeFormat::Aztec);
+			else
+				continue;
+			_used.push_back(results.back().position());
+		}
+	}
+
+public:
+	Candidates(const BinaryBitmap& image, const DecodeHints& hints) : _image(image), _hints(hints) {}
+
+	bool next(Results& results) override
+	{
+		if (!_found) {
+			_found = true;
+			_binImg = _image.getBitMatrix();
+			if (_binImg == nullptr)
+				return false;
+			_fps = FindCenterPatterns(*_binImg, _hints.isPure(), _hints.tryHarder(), _hints.deadline(), &_image);
 		}
+		if (_next >= Size(_fps) || IsExpired(_hints.deadline()))
+			return false;
+		nextChunk(results);
+		return true;
 	}
+};
+
+Results Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("Aztec::Reader::decode");
+	Results results;
+	Candidates stream(image, _hints);
+	while (!(maxSymbols > 0 && Size(results) >= maxSymbols) && stream.next(results))
+		;
+	if (maxSymbols > 0 && Size(results) > maxSymbols)
+		results.erase(results.begin() + maxSymbols, results.end());
 
 	return results;
 }
 
+std::unique_ptr<CandidateStream> Reader::candidates(const BinaryBitmap& image, int) const
+{
+	return std::make_unique<Candidates>(image, _hints);
+}
+
 } // namespace ZXing::Aztec
@@ -25,14 +25,14 @@ Writer::Writer() :
 BitMatrix
 Writer::encode(const std::wstring& contents, int width, int height) const
 {
-	std::string bytes = TextEncoder::FromUnicode(contents, _encoding);
-	EncodeResult aztec = Encoder::Encode(bytes, _eccPercent, _layers);
-	return Inflate(std::move(aztec.matrix), width, height, _margin);
+	return encode(ToUtf8(contents), width, height);
 }
 
 BitMatrix Writer::encode(const std::string& contents, int width, int height) const
 {
-	return encode(FromUtf8(contents), width, height);
+	std::string bytes = TextEncoder::FromUnicode(contents, _encoding);
+	EncodeResult aztec = Encoder::Encode(bytes, _eccPercent, _layers);
+	return Inflate(std::move(aztec.matrix), width, height, _margin);
 }
 
 } // namespace ZXing::Aztec
@@ -14,6 +14,11 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace ZXing::DataMatrix {
 
@@ -116,31 +121,73 @@ BitMatrix VisitMatrix(int numRows, int numCols, VisitFunc visit)
 	return visited;
 }
 
+struct ModulePos
+{
+	uint8_t row, col;
+};
+
+/**
+ * The outcome of VisitMatrix for one mapping matrix size: the positions of the 8 bits (MSB first) of every codeword
+ * and whether the lower righthand corner is left untouched, i.e. gets the fixed pattern.
+ */
+struct Placement
+{
+	std::vector<ModulePos> bits;
+	bool fillCorner = false;
+};
+
+static Placement ComputePlacement(int numRows, int numCols)
+{
+	Placement res;
+	auto visited = VisitMatrix(numRows, numCols, [&res](const BitPosArray& bitPos) {
+		for (auto& p : bitPos)
+			res.bits.push_back({narrow_cast<uint8_t>(p.row), narrow_cast<uint8_t>(p.col)});
+	});
+	res.fillCorner = !visited.get(numCols - 1, numRows - 1);
+	return res;
+}
+
+/**
+ * There are only a few dozen different symbol sizes, so the placement of each one is computed on first use and then
+ * reused, which turns the per symbol work of both the reader and the writer into a straight gather/scatter.
+ */
+static const Placement& PlacementFor(int numRows, int numCols)
+{
+	static std::mutex mutex;
+	static std::map<std::pair<int, int>, Placement> cache;
+	static const Placement invalid;
+
+	// no valid symbol is larger than 144 modules, larger ones would not fit into a ModulePos
+	if (numRows <= 0 || numCols <= 0 || numRows > 255 || numCols > 255)
+		return invalid;
+
+	std::lock_guard lock(mutex);
+	auto [i, inserted] = cache.try_emplace({numRows, numCols});
+	if (inserted)
+		i->second = ComputePlacement(numRows, numCols);
+	return i->second;
+}
+
 /**
 * Symbol Character Placement Program. Adapted from Annex M.1 in ISO/IEC 16022:2000(E).
 */
 BitMatrix BitMatrixFromCodewords(const ByteArray& codewords, int width, int height)
 {
-	BitMatrix result(width, height);
-
-	auto codeword = codewords.begin();
+	const auto& placement = PlacementFor(height, width);
+	if (Size(placement.bits) != Size(codewords) * 8)
+		return {};
 
-	auto visited = VisitMatrix(height, width, [&codeword, &result](const BitPosArray& bitPos) {
-		// Places the 8 bits of a corner or the utah-shaped symbol character in the result matrix
-		uint8_t mask = 0x80;
-		for (auto& p : bitPos) {
-			if (*codeword & mask)
-				result.set(p.col, p.row);
-			mask >>= 1;
-		}
-		++codeword;
-	});
+	BitMatrix result(width, height);
 
-	if (codeword != codewords.end())
-		return {};
+	// Places the 8 bits of each corner or utah-shaped symbol character in the result matrix
+	auto p = placement.bits.begin();
+	for (uint8_t codeword : codewords)
+		for (uint8_t mask = 0x80; mask; mask >>= 1, ++p)
+			if (codeword & mask)
+				result.set(p->col, p->row);
 
 	// Lastly, if the lower righthand corner is untouched, fill in fixed pattern
-	if (!visited.get(width - 1, height - 1)) {
+	if (placement.fillCorner) {
 		result.set(width - 1, height - 1);
 		result.set(width - 2, height - 2);
 	}
@@ -148,19 +195,24 @@ BitMatrix BitMatrixFromCodewords(const ByteArray& codewords, int width, int heig
 	return result;
 }
 
-// Extracts the data bits from a BitMatrix that contains alignment patterns.
-static BitMatrix ExtractDataBits(const Version& version, const BitMatrix& bits)
+/**
+ * The placement of the codeword bits in the full symbol (including the alignment patterns / finder pattern) of the
+ * given version, computed on first use like PlacementFor().
+ */
+static const std::vector<ModulePos>& SymbolPlacementFor(const Version& version)
 {
-	BitMatrix res(version.dataWidth(), version.dataHeight());
-
-	for (int y = 0; y < res.height(); ++y)
-		for (int x = 0; x < res.width(); ++x) {
-			int ix = x + 1 + (x / version.dataBlockWidth) * 2;
-			int iy = y + 1 + (y / version.dataBlockHeight) * 2;
-			res.set(x, y, bits.get(ix, iy));
-		}
-
-	return res;
+	static std::mutex mutex;
+	static std::map<int, std::vector<ModulePos>> cache;
+
+	std::lock_guard lock(mutex);
+	auto [i, inserted] = cache.try_emplace(version.versionNumber);
+	if (inserted) {
+		// map the data region coordinates to the symbol ones, see ISO/IEC 16022:2006 5.2.2
+		for (auto [row, col] : PlacementFor(version.dataHeight(), version.dataWidth()).bits)
+			i->second.push_back({narrow_cast<uint8_t>(row + 1 + (row / version.dataBlockHeight) * 2),
+								 narrow_cast<uint8_t>(col + 1 + (col / version.dataBlockWidth) * 2)});
+	}
+	return i->second;
 }
 
 /**
@@ -172,21 +224,17 @@ static BitMatrix ExtractDataBits(const Version& version, const BitMatrix& bits)
 */
 ByteArray CodewordsFromBitMatrix(const BitMatrix& bits, const Version& version)
 {
-	BitMatrix dataBits = ExtractDataBits(version, bits);
+	const auto& placement = SymbolPlacementFor(version);
+	if (Size(placement) != version.totalCodewords() * 8)
+		return {};
 
 	ByteArray result(version.totalCodewords());
-	auto codeword = result.begin();
 
-	VisitMatrix(dataBits.height(), dataBits.width(), [&codeword, &dataBits](const BitPosArray& bitPos) {
-		// Read the 8 bits of one of the special corner/utah symbols into the current codeword
-		*codeword = 0;
-		for (auto& p : bitPos)
-			AppendBit(*codeword, dataBits.get(p.col, p.row));
-		++codeword;
-	});
-
-	if (codeword != result.end())
-		return {};
+	// Read the 8 bits of each of the special corner/utah symbols into the corresponding codeword
+	auto p = placement.begin();
+	for (auto& codeword : result)
+		for (int bit = 0; bit < 8; ++bit, ++p)
+			AppendBit(codeword, bits.get(p->col, p->row));
 
 	return result;
 }
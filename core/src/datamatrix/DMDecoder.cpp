@@ -15,6 +15,7 @@
 #include "DecoderResult.h"
 #include "GenericGF.h"
 #include "ReedSolomonDecoder.h"
+#include "StatsScope.h"
 #include "ZXAlgorithms.h"
 #include "ZXTestSupport.h"
 
@@ -277,6 +278,8 @@ DecoderResult Decode(ByteArray&& bytes, const bool isDMRE)
 	Content result;
 	Error error;
 	result.symbology = {'d', '1', 3}; // ECC 200 (ISO 16022:2006 Annex N Table N.1)
+	// at most 2 characters per code word (2-digit data), apart from the rare ISO 15434 macros
+	result.reserve(2 * Size(bytes));
 	std::string resultTrailer;
 
 	struct StructuredAppendInfo sai;
@@ -366,17 +369,21 @@ DecoderResult Decode(ByteArray&& bytes, const bool isDMRE)
 *
 * @param codewordBytes data and error correction codewords
 * @param numDataCodewords number of codewords that are data bytes
+* @param ecUsage updated to the maximum of its value and the used fraction of the correction capacity of this block
 * @return false if error correction fails
 */
 static bool
-CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
+CorrectErrors(ByteArray& codewordBytes, int numDataCodewords, float& ecUsage)
 {
-	// First read into an array of ints
-	std::vector<int> codewordsInts(codewordBytes.begin(), codewordBytes.end());
+	// First read into an array of ints (reused for all blocks)
+	thread_local std::vector<int> codewordsInts;
+	codewordsInts.assign(codewordBytes.begin(), codewordBytes.end());
 	int numECCodewords = Size(codewordBytes) - numDataCodewords;
 
-	if (!ReedSolomonDecode(GenericGF::DataMatrixField256(), codewordsInts, numECCodewords))
+	int numCorrections = 0;
+	if (!ReedSolomonDecode(GenericGF::DataMatrixField256(), codewordsInts, numECCodewords, &numCorrections))
 		return false;
+	ecUsage = std::max(ecUsage, std::min(1.f, 2.f * numCorrections / numECCodewords));
 
 	// Copy back into array of bytes -- only need to worry about the bytes that were data
 	// We don't care about errors in the error-correction codewords
@@ -409,9 +416,10 @@ retry:
 
 	// Error-correct and copy data blocks together into a stream of bytes
 	const int dataBlocksCount = Size(dataBlocks);
+	float ecUsage = 0;
 	for (int j = 0; j < dataBlocksCount; j++) {
 		auto& [numDataCodewords, codewords] = dataBlocks[j];
-		if (!CorrectErrors(codewords, numDataCodewords)) {
+		if (!CorrectErrors(codewords, numDataCodewords, ecUsage)) {
 			if(version->versionNumber == 24 && !fix259) {
 				fix259 = true;
 				goto retry;
@@ -431,7 +439,8 @@ retry:
 
 	// Decode the contents of that stream of bytes
 	return DecodedBitStreamParser::Decode(std::move(resultBytes), version->isDMRE())
-		.setVersionNumber(version->versionNumber);
+		.setVersionNumber(version->versionNumber)
+		.setEcUsage(ecUsage);
 }
 
 static BitMatrix FlippedL(const BitMatrix& bits)
@@ -445,6 +454,7 @@ static BitMatrix FlippedL(const BitMatrix& bits)
 
 DecoderResult Decode(const BitMatrix& bits)
 {
+	StatsScope scope(DecodeStats::Stage::Decode);
 	auto res = DoDecode(bits);
 	if (res.isValid())
 		return res;
@@ -9,23 +9,27 @@
 
 #include "BitMatrix.h"
 #include "BitMatrixCursor.h"
-#include "ByteMatrix.h"
 #include "DetectorResult.h"
+#include "Executor.h"
 #include "GridSampler.h"
 #include "LogMatrix.h"
 #include "Point.h"
 #include "RegressionLine.h"
 #include "ResultPoint.h"
 #include "Scope.h"
+#include "StatsScope.h"
 #include "WhiteRectDetector.h"
 
 #include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
+#include <memory>
 #include <numeric>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -489,6 +493,101 @@ public:
 	}
 };
 
+/**
+ * A sparse log of the tracer state per pixel. The image is split into tiles that are only allocated when a trace
+ * passes through them. clear() is O(1): it starts a new generation and every tile stamped with an older one counts as
+ * empty until it gets written again. The instances are recycled per thread (see Acquire()), so a reader session
+ * neither allocates nor clears full-image buffers once it is warmed up.
+ */
+class TracerHistory
+{
+	static constexpr int TILE_BITS = 6;
+	static constexpr int TILE_SIZE = 1 << TILE_BITS;
+
+	int _tilesPerRow = 0;
+	uint32_t _generation = 1;
+	std::vector<uint32_t> _stamps;                  // generation each tile was last written in
+	std::vector<std::unique_ptr<uint8_t[]>> _tiles; // TILE_SIZE * TILE_SIZE states each, nullptr if never used
+
+	int tileIndex(PointI p) const { return (p.y >> TILE_BITS) * _tilesPerRow + (p.x >> TILE_BITS); }
+	static int offset(PointI p) { return (p.y & (TILE_SIZE - 1)) * TILE_SIZE + (p.x & (TILE_SIZE - 1)); }
+
+public:
+	void init(int width, int height)
+	{
+		int tilesPerRow = (width + TILE_SIZE - 1) >> TILE_BITS;
+		int numTiles = tilesPerRow * ((height + TILE_SIZE - 1) >> TILE_BITS);
+		if (tilesPerRow != _tilesPerRow || numTiles != Size(_tiles)) {
+			_tilesPerRow = tilesPerRow;
+			_stamps.assign(numTiles, 0);
+			_tiles.clear(); // only keep the tiles if the geometry did not change
+			_tiles.resize(numTiles);
+		}
+		clear();
+	}
+
+	void clear()
+	{
+		if (++_generation == 0) { // wrap around after 4G clears: the old stamps are ambiguous now
+			std::fill(_stamps.begin(), _stamps.end(), 0);
+			_generation = 1;
+		}
+	}
+
+	int get(PointI p) const
+	{
+		int i = tileIndex(p);
+		return _stamps[i] == _generation ? _tiles[i][offset(p)] : 0;
+	}
+
+	void set(PointI p, int state)
+	{
+		int i = tileIndex(p);
+		if (_stamps[i] != _generation) {
+			if (!_tiles[i])
+				_tiles[i] = std::make_unique<uint8_t[]>(TILE_SIZE * TILE_SIZE);
+			else
+				std::fill_n(_tiles[i].get(), TILE_SIZE * TILE_SIZE, 0);
+			_stamps[i] = _generation;
+		}
+		_tiles[i][offset(p)] = narrow_cast<uint8_t>(state);
+	}
+
+	struct Release
+	{
+		void operator()(TracerHistory* history) const;
+	};
+	using Handle = std::unique_ptr<TracerHistory, Release>;
+
+	// hand out a history for an image of the given size, its memory is reused from earlier calls on this thread
+	static Handle Acquire(int width, int height);
+};
+
+// keep a small number of released instances per thread, there is one in use per DetectorResults or scan task
+static thread_local std::vector<std::unique_ptr<TracerHistory>> tracerHistoryPool;
+static constexpr int TRACER_HISTORY_POOL_SIZE = 2;
+
+TracerHistory::Handle TracerHistory::Acquire(int width, int height)
+{
+	std::unique_ptr<TracerHistory> res;
+	if (tracerHistoryPool.empty()) {
+		res = std::make_unique<TracerHistory>();
+	} else {
+		res = std::move(tracerHistoryPool.back());
+		tracerHistoryPool.pop_back();
+	}
+	res->init(width, height);
+	return Handle(res.release());
+}
+
+void TracerHistory::Release::operator()(TracerHistory* history) const
+{
+	if (Size(tracerHistoryPool) < TRACER_HISTORY_POOL_SIZE)
+		tracerHistoryPool.emplace_back(history);
+	else
+		delete history;
+}
+
 class EdgeTracer : public BitMatrixCursorF
 {
 	enum class StepResult { FOUND, OPEN_END, CLOSED_END };
@@ -539,7 +638,7 @@ class EdgeTracer : public BitMatrixCursorF
 	}
 
 public:
-	ByteMatrix* history = nullptr;
+	TracerHistory* history = nullptr;
 	int state = 0;
 
 	using BitMatrixCursorF::BitMatrixCursor;
@@ -829,64 +928,96 @@ static DetectorResult Scan(EdgeTracer& startTracer, std::array<DMRegressionLine,
 	return {};
 }
 
-static DetectorResults DetectNew(const BitMatrix& image, bool tryHarder, bool tryRotate)
+/**
+ * The 'new' detector: starting in the center of the image, look in one (or all 4) directions for the left (bottom, etc.)
+ * leg of the L-shaped finder pattern and trace the symbol border from there. In tryHarder mode, the same is done along
+ * parallel lines further and further off the center to find off-center and multiple symbols.
+ *
+ * The search is resumable: next() returns the next detected symbol and continues where it left off when called again.
+ * The directions are independent of each other (the history is cleared in between), so a detector constructed for
+ * the range [dirBegin, dirEnd) finds the same symbols as the corresponding part of the full search.
+ */
+class NewDetector
 {
+	const BitMatrix& _image;
+	bool _tryHarder;
+	int _dirEnd;
+	Deadline _deadline;
+	int _minSymbolSize; // the distance between the scan lines in pixel
+
+	// a history log to remember where the tracing already passed by to prevent a later trace from doing the same work twice
+	TracerHistory::Handle _history;
+	// instantiate RegressionLine objects outside of Scan function to prevent repetitive std::vector allocations
+	std::array<DMRegressionLine, 4> _lines;
+
+	int _dir;                          // index of the current scan direction
+	int _line = 0;                     // index of the current scan line in that direction, 0 means not started yet
+	std::optional<EdgeTracer> _tracer; // the tracer of the current scan line, if it might find more symbols
+
 #ifdef PRINT_DEBUG
-	LogMatrixWriter lmw(log, image, 1, "dm-log.pnm");
-//	tryRotate = tryHarder = false;
+	LogMatrixWriter _lmw; // writes the log when the detector is done
 #endif
 
-	// disable expensive multi-line scan to detect off-center symbols for now
-#ifndef __cpp_impl_coroutine
-	tryHarder = false;
+public:
+	static constexpr int NUM_DIRS = 4;
+
+	NewDetector(const BitMatrix& image, bool tryHarder, int dirBegin, int dirEnd, Deadline deadline, float minModuleSize)
+		: _image(image),
+		  _tryHarder(tryHarder),
+		  _dirEnd(dirEnd),
+		  _deadline(deadline),
+		  // minimum realistic size: 8 modules (of the smallest, rectangular symbols) x 2 pixels per module (or the expected size)
+		  _minSymbolSize(std::max(8 * 2, static_cast<int>(8 * minModuleSize))),
+		  _dir(dirBegin)
+#ifdef PRINT_DEBUG
+		  , _lmw(log, image, 1, "dm-log.pnm")
 #endif
+	{
+		if (tryHarder)
+			_history = TracerHistory::Acquire(image.width(), image.height());
+	}
 
-	// a history log to remember where the tracing already passed by to prevent a later trace from doing the same work twice
-	ByteMatrix history;
-	if (tryHarder)
-		history = ByteMatrix(image.width(), image.height());
-
-	// instantiate RegressionLine objects outside of Scan function to prevent repetitive std::vector allocations
-	std::array<DMRegressionLine, 4> lines;
+	DetectorResult next()
+	{
+		constexpr PointF dirs[NUM_DIRS] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
 
-	constexpr int minSymbolSize = 8 * 2; // minimum realistic size in pixel: 8 modules x 2 pixels per module
+		for (; _dir < _dirEnd; ++_dir, _line = 0) {
+			auto dir = dirs[_dir];
+			auto center = PointI(_image.width() / 2, _image.height() / 2);
+			auto startPos = centered(center - center * dir + _minSymbolSize / 2 * dir);
 
-	for (auto dir : {PointF{-1, 0}, {1, 0}, {0, -1}, {0, 1}}) {
-		auto center = PointI(image.width() / 2, image.height() / 2);
-		auto startPos = centered(center - center * dir + minSymbolSize / 2 * dir);
+			if (_line == 0) {
+				if (_history)
+					_history->clear();
+				_line = 1;
+			}
 
-		history.clear();
+			for (; !IsExpired(_deadline); ++_line) {
+				if (!_tracer) {
+					_tracer.emplace(_image, startPos, dir);
+					_tracer->p += _line / 2 * _minSymbolSize * (_line & 1 ? -1 : 1) * _tracer->right();
+					if (_tryHarder)
+						_tracer->history = _history.get();
 
-		for (int i = 1;; ++i) {
-			EdgeTracer tracer(image, startPos, dir);
-			tracer.p += i / 2 * minSymbolSize * (i & 1 ? -1 : 1) * tracer.right();
-			if (tryHarder)
-				tracer.history = &history;
+					if (!_tracer->isIn()) {
+						_tracer.reset();
+						break;
+					}
+				}
 
-			if (!tracer.isIn())
-				break;
+				// keep the tracer, the next call continues the scan behind the found symbol
+				if (auto res = Scan(*_tracer, _lines); res.isValid())
+					return res;
+				_tracer.reset();
 
-#ifdef __cpp_impl_coroutine
-			DetectorResult res;
-			while (res = Scan(tracer, lines), res.isValid())
-				co_yield std::move(res);
-#else
-			if (auto res = Scan(tracer, lines); res.isValid())
-				return res;
-#endif
-
-			if (!tryHarder)
-				break; // only test center lines
+				if (!_tryHarder)
+					break; // only test center lines
+			}
 		}
 
-		if (!tryRotate)
-			break; // only test left direction
+		return {};
 	}
-
-#ifndef __cpp_impl_coroutine
-	return {};
-#endif
-}
+};
 
 /**
 * This method detects a code in a "pure" image -- that is, pure monochrome image
@@ -928,32 +1059,116 @@ static DetectorResult DetectPure(const BitMatrix& image)
 			{{left, top}, {right, top}, {right, bottom}, {left, bottom}}};
 }
 
-DetectorResults Detect(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure)
+struct DetectorResults::State
 {
-#ifdef __cpp_impl_coroutine
-	// First try the very fast DetectPure() path. Also because DetectNew() generally fails with pure module size 1 symbols
-	// TODO: implement a tryRotate version of DetectPure, see #590.
-	if (auto r = DetectPure(image); r.isValid())
-		co_yield std::move(r);
-	else if (!isPure) { // If r.isValid() then there is no point in looking for more (no-pure) symbols
-		bool found = false;
-		for (auto&& r : DetectNew(image, tryHarder, tryRotate)) {
-			found = true;
-			co_yield std::move(r);
-		}
-		if (!found && tryHarder) {
-			if (auto r = DetectOld(image); r.isValid())
-				co_yield std::move(r);
+	enum class Phase { Pure, New, ParallelNew, Old, Done };
+
+	const BitMatrix& image;
+	bool tryHarder;
+	bool isPure;
+	bool tryLegacy;
+	Deadline deadline;
+	Executor* executor;
+	float minModuleSize;
+	NewDetector newDetector;
+	Phase phase = Phase::Pure;
+	bool found = false;
+
+	// results of the ParallelNew phase, in the order the sequential NewDetector would have found them
+	std::vector<DetectorResult> prefetched;
+	int nextPrefetched = 0;
+
+	State(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure, Deadline deadline, Executor* executor,
+		  float minModuleSize, bool tryLegacy)
+		: image(image),
+		  tryHarder(tryHarder),
+		  isPure(isPure),
+		  tryLegacy(tryLegacy),
+		  deadline(deadline),
+		  // the multi-line scans of the 4 directions are worth being run in parallel, a single center line is not
+		  executor(executor && executor->concurrency() > 1 && tryHarder && tryRotate ? executor : nullptr),
+		  minModuleSize(minModuleSize),
+		  newDetector(image, tryHarder, 0, tryRotate ? NewDetector::NUM_DIRS : 1, deadline, minModuleSize)
+	{}
+
+	void detectParallel()
+	{
+		// each task gets its own history and regression lines, the directions do not share any state
+		std::array<std::vector<DetectorResult>, NewDetector::NUM_DIRS> perDir;
+		executor->parallelFor(NewDetector::NUM_DIRS, [&, stats = CurrentStats()](int dir) {
+			StatsContext context(stats);
+			NewDetector detector(image, tryHarder, dir, dir + 1, deadline, minModuleSize);
+			for (auto r = detector.next(); r.isValid(); r = detector.next())
+				perDir[dir].push_back(std::move(r));
+		});
+
+		for (auto& results : perDir)
+			for (auto& r : results)
+				prefetched.push_back(std::move(r));
+	}
+
+	DetectorResult next()
+	{
+		switch (phase) {
+		case Phase::Pure:
+			// First try the very fast DetectPure() path. Also because DetectNew() generally fails with pure module size 1 symbols
+			// TODO: implement a tryRotate version of DetectPure, see #590.
+			if (auto r = DetectPure(image); r.isValid()) {
+				// there is no point in looking for more (no-pure) symbols
+				phase = Phase::Done;
+				return r;
+			}
+			if (isPure)
+				phase = Phase::Done;
+			else if (executor) {
+				detectParallel();
+				phase = Phase::ParallelNew;
+			} else
+				phase = Phase::New;
+			return next();
+		case Phase::New:
+			if (auto r = newDetector.next(); r.isValid()) {
+				found = true;
+				return r;
+			}
+			phase = Phase::Old;
+			return next();
+		case Phase::ParallelNew:
+			if (nextPrefetched < Size(prefetched)) {
+				found = true;
+				return std::move(prefetched[nextPrefetched++]);
+			}
+			phase = Phase::Old;
+			return next();
+		case Phase::Old:
+			phase = Phase::Done;
+			if (!found && tryHarder && tryLegacy && !IsExpired(deadline))
+				return DetectOld(image);
+			return {};
+		case Phase::Done: break;
 		}
+		return {};
 	}
-#else
-	auto result = DetectPure(image);
-	if (!result.isValid() && !isPure)
-		result = DetectNew(image, tryHarder, tryRotate);
-	if (!result.isValid() && tryHarder && !isPure)
-		result = DetectOld(image);
-	return result;
-#endif
+};
+
+DetectorResults::DetectorResults(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure, Deadline deadline,
+								 Executor* executor, float minModuleSize, bool tryLegacy)
+	: _state(std::make_unique<State>(image, tryHarder, tryRotate, isPure, deadline, executor, minModuleSize, tryLegacy))
+{}
+
+DetectorResults::DetectorResults(DetectorResults&&) noexcept = default;
+DetectorResults::~DetectorResults() = default;
+
+bool DetectorResults::next()
+{
+	_current = _state->next();
+	return _current.isValid();
+}
+
+DetectorResults Detect(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure, Deadline deadline,
+					   Executor* executor, float minModuleSize, bool tryLegacy)
+{
+	return {image, tryHarder, tryRotate, isPure, deadline, executor, minModuleSize, tryLegacy};
 }
 
 } // namespace ZXing::DataMatrix
@@ -6,25 +6,73 @@
 
 #pragma once
 
-#ifdef __cpp_impl_coroutine
-#include <Generator.h>
-#include <DetectorResult.h>
-#endif
+#include "Deadline.h"
+#include "DetectorResult.h"
+
+#include <memory>
 
 namespace ZXing {
 
 class BitMatrix;
-class DetectorResult;
+class Executor;
 
 namespace DataMatrix {
 
-#ifdef __cpp_impl_coroutine
-using DetectorResults = Generator<DetectorResult>;
-#else
-using DetectorResults = DetectorResult;
-#endif
+/**
+ * Lazy sequence of detected symbols. The (potentially expensive) search for the next symbol is only continued when
+ * iterating past the current one, so stopping after the first successfully decoded symbol costs nothing extra.
+ * This works the same with and without C++20 coroutine support.
+ */
+class DetectorResults
+{
+	struct State;
+	std::unique_ptr<State> _state;
+	DetectorResult _current;
+
+	bool next();
+
+public:
+	DetectorResults(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure, Deadline deadline, Executor* executor,
+					float minModuleSize, bool tryLegacy);
+	DetectorResults(DetectorResults&&) noexcept;
+	~DetectorResults();
+
+	struct End {};
+	class Iter
+	{
+		DetectorResults* _parent;
+
+	public:
+		explicit Iter(DetectorResults* parent) : _parent(parent) {}
+		DetectorResult& operator*() const { return _parent->_current; }
+		Iter& operator++()
+		{
+			_parent->next();
+			return *this;
+		}
+		bool operator!=(End) const { return _parent->_current.isValid(); }
+	};
+
+	Iter begin()
+	{
+		next();
+		return Iter(this);
+	}
+	End end() const { return {}; }
+};
 
-DetectorResults Detect(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure);
+/**
+ * With an executor and tryHarder + tryRotate, the multi-line scans of the 4 search directions run as parallel tasks.
+ * They are all completed before the first of their results is returned, the order of the results is the same as
+ * without an executor.
+ *
+ * minModuleSize (optional) is the smallest expected module size in pixels, the larger it is, the fewer lines are scanned.
+ *
+ * tryLegacy (optional) enables the white rectangle based detector as a last resort if tryHarder is set and nothing else
+ * has been found, see DecodeHints::tryDataMatrixLegacyDetector().
+ */
+DetectorResults Detect(const BitMatrix& image, bool tryHarder, bool tryRotate, bool isPure, Deadline deadline = Deadline::max(),
+					   Executor* executor = nullptr, float minModuleSize = 0, bool tryLegacy = false);
 
 } // DataMatrix
 } // ZXing
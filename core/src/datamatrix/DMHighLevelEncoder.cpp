@@ -10,6 +10,7 @@
 #include "CharacterSet.h"
 #include "DMEncoderContext.h"
 #include "TextEncoder.h"
+#include "Utf.h"
 #include "ZXAlgorithms.h"
 
 #include <algorithm>
@@ -22,6 +23,9 @@
 #include <numeric>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace ZXing::DataMatrix {
 
@@ -32,9 +36,9 @@ static const uint8_t MACRO_06 = 237;
 static const uint8_t C40_UNLATCH = 254;
 static const uint8_t X12_UNLATCH = 254;
 
-static const std::wstring MACRO_05_HEADER = L"[)>\x1E""05\x1D";
-static const std::wstring MACRO_06_HEADER = L"[)>\x1E""06\x1D";
-static const std::wstring MACRO_TRAILER = L"\x1E\x04";
+static constexpr std::string_view MACRO_05_HEADER = "[)>\x1E""05\x1D";
+static constexpr std::string_view MACRO_06_HEADER = "[)>\x1E""06\x1D";
+static constexpr std::string_view MACRO_TRAILER = "\x1E\x04";
 
 enum
 {
@@ -423,13 +427,20 @@ namespace C40Encoder {
 		return lastCharSize;
 	}
 
-	static void EncodeToCodewords(EncoderContext& context, const std::string& sb, int startPos) {
+	static void EncodeToCodewords(ByteArray& codewords, const std::string& sb, int startPos) {
 		int c1 = sb.at(startPos);
 		int c2 = sb.at(startPos + 1);
 		int c3 = sb.at(startPos + 2);
 		int v = (1600 * c1) + (40 * c2) + c3 + 1;
-		context.addCodeword(narrow_cast<uint8_t>(v / 256));
-		context.addCodeword(narrow_cast<uint8_t>(v % 256));
+		codewords.push_back(narrow_cast<uint8_t>(v / 256));
+		codewords.push_back(narrow_cast<uint8_t>(v % 256));
+	}
+
+	static void EncodeToCodewords(EncoderContext& context, const std::string& sb, int startPos) {
+		ByteArray codewords;
+		EncodeToCodewords(codewords, sb, startPos);
+		for (uint8_t cw : codewords)
+			context.addCodeword(cw);
 	}
 
 	static void WriteNextTriplet(EncoderContext& context, std::string& buffer)
@@ -845,33 +856,309 @@ namespace Base256Encoder {
 
 } // Base256Encoder
 
-static bool StartsWith(const std::wstring& s, const std::wstring& ss)
+static bool StartsWith(std::string_view s, std::string_view ss)
 {
 	return s.length() > ss.length() && s.compare(0, ss.length(), ss) == 0;
 }
 
-static bool EndsWith(const std::wstring& s, const std::wstring& ss)
+static bool EndsWith(std::string_view s, std::string_view ss)
 {
 	return s.length() > ss.length() && s.compare(s.length() - ss.length(), ss.length(), ss) == 0;
 }
 
+/**
+ * The minimal encoder: a shortest path search over the states (position in message, encodation mode) where every edge
+ * encodes the shortest complete unit of its mode (an ASCII character or digit pair, a C40/Text/X12 triplet, an EDIFACT
+ * quadruple or a Base 256 byte) plus the latches/unlatches needed to get there. All edges go forward (or stay at the
+ * same position for unlatches into ASCII), so a single pass over the message finds the cheapest encoding.
+ */
+namespace MinimalEncoder {
+
+	constexpr int NUM_MODES = 6;
+	constexpr int MAX_B256_LENGTH = 1555;
+
+	enum class Edge : uint8_t
+	{
+		None,
+		AsciiChar,
+		AsciiDigits,
+		C40Group,   // C40 or Text triplet(s), padded with a Shift 1 at the end of data
+		C40PadUnlatch, // C40 or Text triplet(s) padded with a Shift 1 and followed by the unlatch, ending in ASCII
+		X12Group,
+		EdfGroup,   // 4 EDIFACT characters, staying in EDIFACT
+		EdfUnlatch, // 0 to 3 EDIFACT characters followed by the unlatch value, ending in ASCII
+		B256Char,
+		Unlatch,    // 254 from C40, Text or X12 to ASCII
+		B256Close,  // leaving Base 256 after its counted bytes, free
+	};
+
+	struct Node
+	{
+		int cost = std::numeric_limits<int>::max();
+		int prev = -1;
+		Edge edge = Edge::None;
+		uint8_t chars = 0;      // number of message characters encoded by the edge
+		uint8_t encodation = 0; // mode the characters of the edge are encoded in
+		int16_t b256Len = 0;    // length of the current Base 256 run
+	};
+
+	static int C40ValueCount(int c, bool text)
+	{
+		if (IsExtendedASCII(c))
+			return 2 + C40ValueCount(c - 128, text); // Shift 2, Upper Shift
+		return (text ? IsNativeText(c) : IsNativeC40(c)) ? 1 : 2;
+	}
+
+	static int EdifactCodewords(int numValues)
+	{
+		return std::min(numValues, 3);
+	}
+
+	// number of ASCII codewords needed for the (at most 2) characters in [pos, end)
+	static int AsciiCodewords(const std::string& msg, int pos, int end)
+	{
+		if (end - pos == 2 && IsDigit(msg[pos]) && IsDigit(msg[pos + 1]))
+			return 1;
+		int res = 0;
+		for (int i = pos; i < end; ++i)
+			res += IsExtendedASCII(msg[i] & 0xff) ? 2 : 1;
+		return res;
+	}
+
+	static void Encode(const std::string& msg, int start, int end, ByteArray& codewords, const std::function<const SymbolInfo*(int)>& lookup)
+	{
+		const int prefix = Size(codewords);
+		std::vector<Node> nodes((end - start + 1) * NUM_MODES);
+		auto index = [&](int pos, int mode) { return (pos - start) * NUM_MODES + mode; };
+		auto relax = [&](int from, int pos, int mode, int cost, Edge edge, int chars, int b256Len = 0, int encodation = -1) {
+			auto& n = nodes[index(pos, mode)];
+			cost += nodes[from].cost;
+			if (cost < n.cost)
+				n = {cost, from, edge, narrow_cast<uint8_t>(chars), narrow_cast<uint8_t>(encodation < 0 ? mode : encodation),
+					 narrow_cast<int16_t>(b256Len)};
+		};
+		auto isNative = [&](int pos, int count, bool (*isNativeMode)(int)) {
+			return pos + count <= end && std::all_of(msg.begin() + pos, msg.begin() + pos + count,
+													 [isNativeMode](char c) { return isNativeMode(c & 0xff); });
+		};
+
+		nodes[index(start, ASCII_ENCODATION)].cost = 0;
+
+		for (int pos = start; pos <= end; ++pos) {
+			// all edges into the non-ASCII modes consume characters, so those nodes are final here
+			const int ascii = index(pos, ASCII_ENCODATION);
+			for (int mode : {C40_ENCODATION, TEXT_ENCODATION, X12_ENCODATION})
+				if (nodes[ascii + mode].cost != std::numeric_limits<int>::max())
+					relax(ascii + mode, pos, ASCII_ENCODATION, 1, Edge::Unlatch, 0);
+			if (nodes[ascii + EDIFACT_ENCODATION].cost != std::numeric_limits<int>::max())
+				relax(ascii + EDIFACT_ENCODATION, pos, ASCII_ENCODATION, EdifactCodewords(1), Edge::EdfUnlatch, 0, 0,
+					  EDIFACT_ENCODATION);
+			if (nodes[ascii + BASE256_ENCODATION].cost != std::numeric_limits<int>::max())
+				relax(ascii + BASE256_ENCODATION, pos, ASCII_ENCODATION, 0, Edge::B256Close, 0);
+
+			if (pos == end)
+				break;
+
+			for (int mode = 0; mode < NUM_MODES; ++mode) {
+				const int from = ascii + mode;
+				if (nodes[from].cost == std::numeric_limits<int>::max())
+					continue;
+				const int latch = mode == ASCII_ENCODATION ? 1 : 0;
+
+				if (mode == ASCII_ENCODATION) {
+					int c = msg[pos] & 0xff;
+					relax(from, pos + 1, ASCII_ENCODATION, IsExtendedASCII(c) ? 2 : 1, Edge::AsciiChar, 1);
+					if (IsDigit(c) && pos + 1 < end && IsDigit(msg[pos + 1]))
+						relax(from, pos + 2, ASCII_ENCODATION, 1, Edge::AsciiDigits, 2);
+					relax(from, pos + 1, BASE256_ENCODATION, 3, Edge::B256Char, 1, 1); // latch, length field, byte
+				}
+
+				if (mode == BASE256_ENCODATION && nodes[from].b256Len < MAX_B256_LENGTH) {
+					int len = nodes[from].b256Len + 1;
+					relax(from, pos + 1, BASE256_ENCODATION, len == 250 ? 2 : 1, Edge::B256Char, 1, len);
+				}
+
+				for (int c40Mode : {C40_ENCODATION, TEXT_ENCODATION})
+					if (mode == ASCII_ENCODATION || mode == c40Mode) {
+						// the shortest group filling complete triplets, or one that needs a Shift 1 as pad in the last
+						// triplet, which then has to be followed by the unlatch or the end of data
+						int values = 0;
+						for (int i = pos; i < end; ++i) {
+							values += C40ValueCount(msg[i] & 0xff, c40Mode == TEXT_ENCODATION);
+							const int len = i + 1 - pos, numCodewords = (values + 2) / 3 * 2;
+							if (values % 3 == 0) {
+								relax(from, i + 1, c40Mode, latch + numCodewords, Edge::C40Group, len);
+								break;
+							} else if (values % 3 == 2 && i + 1 == end) {
+								relax(from, i + 1, c40Mode, latch + numCodewords, Edge::C40Group, len);
+							} else if (values % 3 == 2) {
+								relax(from, i + 1, ASCII_ENCODATION, latch + numCodewords + 1, Edge::C40PadUnlatch, len, 0,
+									  c40Mode);
+							}
+						}
+					}
+
+				if ((mode == ASCII_ENCODATION || mode == X12_ENCODATION) && isNative(pos, 3, IsNativeX12))
+					relax(from, pos + 3, X12_ENCODATION, latch + 2, Edge::X12Group, 3);
+
+				if (mode == ASCII_ENCODATION || mode == EDIFACT_ENCODATION) {
+					for (int len = 1; len <= 3 && isNative(pos, len, IsNativeEDIFACT); ++len)
+						relax(from, pos + len, ASCII_ENCODATION, latch + EdifactCodewords(len + 1), Edge::EdfUnlatch, len, 0,
+							  EDIFACT_ENCODATION);
+					if (isNative(pos, 4, IsNativeEDIFACT))
+						relax(from, pos + 4, EDIFACT_ENCODATION, latch + 3, Edge::EdfGroup, 4);
+				}
+			}
+		}
+
+		// Pick the smallest symbol: ending in ASCII always works. C40/Text/X12 and EDIFACT can end without the unlatch
+		// if at most 1 (C40/Text/X12) or 2 (EDIFACT) codewords are left in the symbol, those may then hold the last
+		// characters in ASCII (see ISO 16022:2006, 5.2.5.2, 5.2.7 and 5.2.8.2).
+		int last = index(end, ASCII_ENCODATION), tail = end;
+		const SymbolInfo* symbolInfo = lookup(prefix + nodes[last].cost);
+		for (int mode : {C40_ENCODATION, TEXT_ENCODATION, X12_ENCODATION, EDIFACT_ENCODATION}) {
+			const int maxRest = mode == EDIFACT_ENCODATION ? 2 : 1;
+			for (int pos = std::max(start, end - 2); pos <= end; ++pos) {
+				const int len = nodes[index(pos, mode)].cost;
+				const int rest = AsciiCodewords(msg, pos, end);
+				if (len == std::numeric_limits<int>::max() || rest > maxRest ||
+					(symbolInfo && prefix + len + rest >= symbolInfo->dataCapacity()))
+					continue;
+				auto candidate = lookup(prefix + len + rest);
+				if (candidate && candidate->dataCapacity() - (prefix + len) <= maxRest &&
+					(!symbolInfo || candidate->dataCapacity() < symbolInfo->dataCapacity())) {
+					symbolInfo = candidate;
+					last = index(pos, mode);
+					tail = pos;
+				}
+			}
+		}
+		if (symbolInfo == nullptr)
+			throw std::invalid_argument("Can't find a symbol arrangement that matches the message. Data codewords: " +
+										std::to_string(prefix + nodes[index(end, ASCII_ENCODATION)].cost));
+
+		std::vector<int> path;
+		for (int i = last; nodes[i].prev != -1; i = nodes[i].prev)
+			path.push_back(i);
+		std::reverse(path.begin(), path.end());
+
+		codewords.reserve(symbolInfo->dataCapacity());
+		std::string values;
+		int b256LengthPos = 0;
+		for (int i : path) {
+			const auto& node = nodes[i];
+			const int fromMode = node.prev % NUM_MODES;
+			const int pos = start + node.prev / NUM_MODES;
+			// every edge starting in ASCII but encoding in a different mode begins with the latch to that mode
+			if (fromMode == ASCII_ENCODATION && node.encodation != ASCII_ENCODATION)
+				codewords.push_back(LATCHES[node.encodation]);
+			values.clear();
+
+			switch (node.edge) {
+			case Edge::AsciiChar: {
+				int c = msg[pos] & 0xff;
+				if (IsExtendedASCII(c)) {
+					codewords.push_back(UPPER_SHIFT);
+					codewords.push_back(narrow_cast<uint8_t>(c - 128 + 1));
+				} else {
+					codewords.push_back(narrow_cast<uint8_t>(c + 1));
+				}
+				break;
+			}
+			case Edge::AsciiDigits: codewords.push_back(ASCIIEncoder::EncodeASCIIDigits(msg[pos], msg[pos + 1])); break;
+			case Edge::C40Group:
+			case Edge::C40PadUnlatch:
+			case Edge::X12Group: {
+				auto encodeChar = node.encodation == C40_ENCODATION ? C40Encoder::EncodeChar
+								  : node.encodation == TEXT_ENCODATION ? DMTextEncoder::EncodeChar
+																	   : X12Encoder::EncodeChar;
+				for (int j = pos; j < pos + node.chars; ++j)
+					encodeChar(msg[j] & 0xff, values);
+				if (Size(values) % 3 == 2)
+					values.push_back('\0'); // Shift 1 as pad at the end of data
+				for (int j = 0; j < Size(values); j += 3)
+					C40Encoder::EncodeToCodewords(codewords, values, j);
+				if (node.edge == Edge::C40PadUnlatch)
+					codewords.push_back(C40_UNLATCH);
+				break;
+			}
+			case Edge::EdfGroup:
+			case Edge::EdfUnlatch:
+				for (int j = pos; j < pos + node.chars; ++j)
+					EdifactEncoder::EncodeChar(msg[j] & 0xff, values);
+				if (node.edge == Edge::EdfUnlatch)
+					values.push_back(31);
+				for (uint8_t cw : EdifactEncoder::EncodeToCodewords(values, 0))
+					codewords.push_back(cw);
+				break;
+			case Edge::B256Char:
+				if (fromMode != BASE256_ENCODATION) {
+					b256LengthPos = Size(codewords);
+					codewords.push_back(0); // length field placeholder
+				}
+				codewords.push_back(static_cast<uint8_t>(msg[pos]));
+				break;
+			case Edge::B256Close: {
+				int dataCount = Size(codewords) - b256LengthPos - 1;
+				if (dataCount > 249) {
+					codewords[b256LengthPos] = narrow_cast<uint8_t>(dataCount / 250 + 249);
+					codewords.insert(codewords.begin() + b256LengthPos + 1, narrow_cast<uint8_t>(dataCount % 250));
+				} else {
+					codewords[b256LengthPos] = narrow_cast<uint8_t>(dataCount);
+				}
+				for (int j = b256LengthPos; j < Size(codewords); ++j)
+					codewords[j] = narrow_cast<uint8_t>(Base256Encoder::Randomize255State(codewords[j], j + 1));
+				break;
+			}
+			case Edge::Unlatch: codewords.push_back(C40_UNLATCH); break;
+			case Edge::None: break;
+			}
+		}
+
+		for (int pos = tail; pos < end; ++pos) {
+			if (pos + 1 < end && IsDigit(msg[pos]) && IsDigit(msg[pos + 1])) {
+				codewords.push_back(ASCIIEncoder::EncodeASCIIDigits(msg[pos], msg[pos + 1]));
+				++pos;
+			} else if (int c = msg[pos] & 0xff; IsExtendedASCII(c))
+				codewords.insert(codewords.end(), {UPPER_SHIFT, narrow_cast<uint8_t>(c - 128 + 1)});
+			else
+				codewords.push_back(narrow_cast<uint8_t>(c + 1));
+		}
+
+		if (Size(codewords) > symbolInfo->dataCapacity())
+			throw std::logic_error("Unexpected minimal encoding length. Please report!");
+
+		//Padding
+		if (Size(codewords) < symbolInfo->dataCapacity())
+			codewords.push_back(PAD);
+		while (Size(codewords) < symbolInfo->dataCapacity())
+			codewords.push_back(Randomize253State(PAD, Size(codewords) + 1));
+	}
+
+} // MinimalEncoder
+
 ByteArray Encode(const std::wstring& msg)
 {
-	return Encode(msg, CharacterSet::ISO8859_1, SymbolShape::NONE, -1, -1, -1, -1);
+	return Encode(ToUtf8(msg), CharacterSet::ISO8859_1, SymbolShape::NONE, -1, -1, -1, -1);
+}
+
+ByteArray Encode(const std::wstring& msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight)
+{
+	return Encode(ToUtf8(msg), charset, shape, minWidth, minHeight, maxWidth, maxHeight);
 }
 
 /**
 * Performs message encoding of a DataMatrix message using the algorithm described in annex P
 * of ISO/IEC 16022:2000(E).
 *
-* @param msg     the message
+* @param msg     the utf8 encoded message
 * @param shape   requested shape. May be {@code SymbolShapeHint.FORCE_NONE},
 *                {@code SymbolShapeHint.FORCE_SQUARE} or {@code SymbolShapeHint.FORCE_RECTANGLE}.
 * @param minSize the minimum symbol size constraint or null for no constraint
 * @param maxSize the maximum symbol size constraint or null for no constraint
 * @return the encoded message (the char values range from 0 to 255)
 */
-ByteArray Encode(const std::wstring& msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight)
+ByteArray Encode(std::string_view msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight)
 {
 	//the codewords 0..255 are encoded as Unicode characters
 	//Encoder[] encoders = {
@@ -932,4 +1219,34 @@ ByteArray Encode(const std::wstring& msg, CharacterSet charset, SymbolShape shap
 	return context.codewords();
 }
 
+ByteArray EncodeMinimal(const std::wstring& msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight,
+						int maxWidth, int maxHeight)
+{
+	return EncodeMinimal(ToUtf8(msg), charset, shape, minWidth, minHeight, maxWidth, maxHeight);
+}
+
+ByteArray EncodeMinimal(std::string_view msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight,
+						int maxWidth, int maxHeight)
+{
+	if (charset == CharacterSet::Unknown)
+		charset = CharacterSet::ISO8859_1;
+
+	std::string bytes = TextEncoder::FromUnicode(msg, charset);
+	ByteArray codewords;
+	int start = 0, end = Size(bytes);
+
+	for (auto [header, macro] : {std::pair{&MACRO_05_HEADER, MACRO_05}, {&MACRO_06_HEADER, MACRO_06}})
+		if (StartsWith(msg, *header) && EndsWith(msg, MACRO_TRAILER)) {
+			codewords.push_back(macro);
+			start = Size(*header);
+			end -= Size(MACRO_TRAILER);
+			break;
+		}
+
+	MinimalEncoder::Encode(bytes, start, end, codewords,
+						   [&](int len) { return SymbolInfo::Lookup(len, shape, minWidth, minHeight, maxWidth, maxHeight); });
+
+	return codewords;
+}
+
 } // namespace ZXing::DataMatrix
@@ -9,6 +9,7 @@
 #include "CharacterSet.h"
 
 #include <string>
+#include <string_view>
 
 namespace ZXing {
 
@@ -24,6 +25,18 @@ enum class SymbolShape;
 */
 ByteArray Encode(const std::wstring& msg);
 ByteArray Encode(const std::wstring& msg, CharacterSet encoding, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight);
+// msg is utf8 encoded, it is converted to the requested character set directly
+ByteArray Encode(std::string_view msg, CharacterSet encoding, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight);
+
+/**
+* Same as Encode() but instead of the look-ahead heuristic of annex P, the encodation modes are chosen by a shortest
+* path search over all possible mode switches. This finds the minimal number of codewords in time linear in the
+* length of the message.
+*/
+ByteArray EncodeMinimal(const std::wstring& msg, CharacterSet encoding, SymbolShape shape, int minWidth, int minHeight,
+						int maxWidth, int maxHeight);
+ByteArray EncodeMinimal(std::string_view msg, CharacterSet encoding, SymbolShape shape, int minWidth, int minHeight,
+						int maxWidth, int maxHeight);
 
 } // DataMatrix
 } // ZXing
@@ -13,46 +13,78 @@
 #include "DecoderResult.h"
 #include "DetectorResult.h"
 #include "Result.h"
+#include "TraceScope.h"
 
+#include <algorithm>
+#include <memory>
+#include <optional>
 #include <utility>
 
 namespace ZXing::DataMatrix {
 
 Result Reader::decode(const BinaryBitmap& image) const
 {
-#ifdef __cpp_impl_coroutine
+	ZX_TRACE_SCOPE("DataMatrix::Reader::decode");
 	return FirstOrDefault(decode(image, 1));
-#else
-	auto binImg = image.getBitMatrix();
-	if (binImg == nullptr)
-		return {};
-
-	auto detectorResult = Detect(*binImg, _hints.tryHarder(), _hints.tryRotate(), _hints.isPure());
-	if (!detectorResult.isValid())
-		return {};
-
-	return Result(Decode(detectorResult.bits()), std::move(detectorResult).position(), BarcodeFormat::DataMatrix);
-#endif
 }
 
-#ifdef __cpp_impl_coroutine
-Results Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+// Every call of next() continues the (lazy) detection up to the next symbol candidate and decodes it.
+class Candidates : public CandidateStream
 {
-	auto binImg = image.getBitMatrix();
-	if (binImg == nullptr)
-		return {};
+	const BinaryBitmap& _image;
+	const DecodeHints& _hints;
+	std::optional<DetectorResults> _detRes;
+	std::optional<DetectorResults::Iter> _it;
 
-	Results results;
-	for (auto&& detRes : Detect(*binImg, _hints.tryHarder(), _hints.tryRotate(), _hints.isPure())) {
+public:
+	Candidates(const BinaryBitmap& image, const DecodeHints& hints) : _image(image), _hints(hints) {}
+
+	bool next(Results& results) override
+	{
+		if (!_detRes) {
+			auto binImg = _image.getBitMatrix();
+			if (binImg == nullptr)
+				return false;
+			_detRes.emplace(Detect(*binImg, _hints.tryHarder(), _hints.tryRotate(), _hints.isPure(), _hints.deadline(),
+								   _image.executor(), _image.minModuleSize(), _hints.tryDataMatrixLegacyDetector()));
+			_it.emplace(_detRes->begin());
+		} else {
+			++*_it;
+		}
+		if (!(*_it != _detRes->end()))
+			return false;
+
+		auto& detRes = **_it;
+		if (_hints.detectOnly()) {
+			// without decoding, the detector may locate the same symbol more than once
+			auto center = Center(detRes.position());
+			if (std::none_of(results.begin(), results.end(), [&](const Result& r) { return IsInside(center, r.position()); })) {
+				auto modules = std::make_shared<const BitMatrix>(std::move(detRes).bits());
+				results.emplace_back(std::move(detRes).position(), BarcodeFormat::DataMatrix, std::move(modules));
+			}
+			return true;
+		}
 		auto decRes = Decode(detRes.bits());
-		if (decRes.isValid(_hints.returnErrors())) {
+		if (decRes.isValid(_hints.returnErrors()))
 			results.emplace_back(std::move(decRes), std::move(detRes).position(), BarcodeFormat::DataMatrix);
-			if (maxSymbols > 0 && Size(results) >= maxSymbols)
-				break;
-		}
+		return true;
 	}
+};
+
+Results Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("DataMatrix::Reader::decode");
+	Results results;
+	Candidates stream(image, _hints);
+	while (!(maxSymbols > 0 && Size(results) >= maxSymbols) && stream.next(results))
+		;
 
 	return results;
 }
-#endif
+
+std::unique_ptr<CandidateStream> Reader::candidates(const BinaryBitmap& image, int) const
+{
+	return std::make_unique<Candidates>(image, _hints);
+}
+
 } // namespace ZXing::DataMatrix
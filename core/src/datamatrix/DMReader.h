@@ -16,9 +16,8 @@ public:
 	using ZXing::Reader::Reader;
 
 	Result decode(const BinaryBitmap& image) const override;
-#ifdef __cpp_impl_coroutine
 	Results decode(const BinaryBitmap& image, int maxSymbols) const override;
-#endif
+	std::unique_ptr<CandidateStream> candidates(const BinaryBitmap& image, int maxSymbols) const override;
 };
 
 } // namespace ZXing::DataMatrix
@@ -9,7 +9,10 @@
 #include "ZXAlgorithms.h"
 #include "ZXTestSupport.h"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 
 namespace ZXing::DataMatrix {
@@ -50,6 +53,30 @@ static constexpr const SymbolInfo PROD_SYMBOLS[] = {
 	{ false, 1558, 620, 22, 22, 36, -1, 62 },
 };
 
+static constexpr int MAX_DATA_CAPACITY = 1558;
+
+static constexpr bool HasShape(const SymbolInfo& symbol, SymbolShape shape)
+{
+	return shape == SymbolShape::NONE || symbol.isRectangular() == (shape == SymbolShape::RECTANGLE);
+}
+
+// For each shape and number of data codewords n, the index of the first symbol of that shape with a capacity of at least
+// n (or Size(PROD_SYMBOLS) if there is none). All symbols before it can be skipped by Lookup(), even with size limits.
+static constexpr auto PROD_SYMBOL_INDEX = [] {
+	std::array<std::array<uint8_t, MAX_DATA_CAPACITY + 1>, 3> res = {};
+	for (auto shape : {SymbolShape::NONE, SymbolShape::SQUARE, SymbolShape::RECTANGLE}) {
+		int i = 0;
+		for (int n = 0; n <= MAX_DATA_CAPACITY; ++n) {
+			while (i < Size(PROD_SYMBOLS) && !(HasShape(PROD_SYMBOLS[i], shape) && PROD_SYMBOLS[i].dataCapacity() >= n))
+				++i;
+			res[static_cast<int>(shape)][n] = narrow_cast<uint8_t>(i);
+		}
+	}
+	return res;
+}();
+
+static_assert(PROD_SYMBOL_INDEX[0][MAX_DATA_CAPACITY] == Size(PROD_SYMBOLS) - 1, "MAX_DATA_CAPACITY is wrong");
+
 static const SymbolInfo* s_symbols = PROD_SYMBOLS;
 static ZXING_IF_NOT_TEST(const) size_t s_symbolCount = Size(PROD_SYMBOLS);
 
@@ -92,12 +119,16 @@ SymbolInfo::Lookup(int dataCodewords, bool allowRectangular)
 const SymbolInfo *
 SymbolInfo::Lookup(int dataCodewords, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight)
 {
-	for (size_t i = 0; i < s_symbolCount; ++i) {
+	size_t first = 0;
+	if (s_symbols == PROD_SYMBOLS) {
+		if (dataCodewords > MAX_DATA_CAPACITY)
+			return nullptr;
+		first = PROD_SYMBOL_INDEX[static_cast<int>(shape)][std::max(dataCodewords, 0)];
+	}
+
+	for (size_t i = first; i < s_symbolCount; ++i) {
 		auto& symbol = s_symbols[i];
-		if (shape == SymbolShape::SQUARE && symbol._rectangular) {
-			continue;
-		}
-		if (shape == SymbolShape::RECTANGLE && !symbol._rectangular) {
+		if (!HasShape(symbol, shape)) {
 			continue;
 		}
 		if (minWidth >= 0 && minHeight >= 0 && (symbol.symbolWidth() < minWidth || symbol.symbolHeight() < minHeight)) {
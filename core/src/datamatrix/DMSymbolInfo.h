@@ -63,7 +63,9 @@ public:
 
 	int interleavedBlockCount() const { return _rsBlockData > 0 ? _dataCapacity / _rsBlockData : 10; /* Symbol 144 */ }
 
-	int dataCapacity() const { return _dataCapacity; }
+	constexpr bool isRectangular() const { return _rectangular; }
+
+	constexpr int dataCapacity() const { return _dataCapacity; }
 
 	int errorCodewords() const { return _errorCodewords; }
 
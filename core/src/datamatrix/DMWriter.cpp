@@ -83,6 +83,11 @@ Writer::Writer() :
 
 BitMatrix
 Writer::encode(const std::wstring& contents, int width, int height) const
+{
+	return encode(ToUtf8(contents), width, height);
+}
+
+BitMatrix Writer::encode(const std::string& contents, int width, int height) const
 {
 	if (contents.empty()) {
 		throw std::invalid_argument("Found empty contents");
@@ -93,7 +98,9 @@ Writer::encode(const std::wstring& contents, int width, int height) const
 	}
 
 	//1. step: Data encodation
-	auto encoded = Encode(contents, _encoding, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight);
+	std::string_view utf8 = contents;
+	auto encoded = _minimalEncoding ? EncodeMinimal(utf8, _encoding, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight)
+									: Encode(utf8, _encoding, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight);
 	const SymbolInfo* symbolInfo = SymbolInfo::Lookup(Size(encoded), _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight);
 	if (symbolInfo == nullptr) {
 		throw std::invalid_argument("Can't find a symbol arrangement that matches the message. Data codewords: " + std::to_string(encoded.size()));
@@ -112,9 +119,4 @@ Writer::encode(const std::wstring& contents, int width, int height) const
 	return Inflate(std::move(result), width, height, _quietZone);
 }
 
-BitMatrix Writer::encode(const std::string& contents, int width, int height) const
-{
-	return encode(FromUtf8(contents), width, height);
-}
-
 } // namespace ZXing::DataMatrix
@@ -49,6 +49,13 @@ public:
 		return *this;
 	}
 
+	/// Choose the encodation modes with an optimal search instead of the look-ahead heuristic of the specification.
+	/// This results in the same or fewer codewords (and hence sometimes smaller symbols) but takes a few times longer.
+	Writer& setMinimalEncoding(bool minimal) {
+		_minimalEncoding = minimal;
+		return *this;
+	}
+
 	BitMatrix encode(const std::wstring& contents, int width, int height) const;
 	BitMatrix encode(const std::string& contents, int width, int height) const;
 
@@ -56,6 +63,7 @@ private:
 	SymbolShape _shapeHint;
 	int _quietZone = 1, _minWidth = -1, _minHeight = -1, _maxWidth = -1, _maxHeight = -1;
 	CharacterSet _encoding;
+	bool _minimalEncoding = false;
 };
 
 } // DataMatrix
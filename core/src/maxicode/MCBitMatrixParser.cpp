@@ -8,8 +8,10 @@
 
 #include "BitMatrix.h"
 #include "ByteArray.h"
+#include "ZXAlgorithms.h"
 
 #include <array>
+#include <cstdint>
 
 namespace ZXing::MaxiCode {
 
@@ -49,18 +51,29 @@ static const std::array<std::array<int, BitMatrixParser::MATRIX_WIDTH>, BitMatri
 	737,736,743,742,749,748,755,754,761,760,767,766,773,772,779,778,785,784,791,790,797,796,803,802,809,808,815,814,863,862,
 };
 
+struct ModulePos
+{
+	uint8_t x, y;
+};
+
+// The inverse of BITNR: the module of each of the 6 bits (MSB first) of each of the 144 codewords
+static const auto CODEWORD_MODULES = [] {
+	std::array<std::array<ModulePos, 6>, 144> res = {};
+	for (int y = 0; y < BitMatrixParser::MATRIX_HEIGHT; y++)
+		for (int x = 0; x < BitMatrixParser::MATRIX_WIDTH; x++)
+			if (int bit = BITNR[y][x]; bit >= 0)
+				res[bit / 6][bit % 6] = {static_cast<uint8_t>(x), static_cast<uint8_t>(y)};
+	return res;
+}();
+
 ByteArray BitMatrixParser::ReadCodewords(const BitMatrix& image)
 {
-	ByteArray result(144);
-	int height = image.height();
-	int width = image.width();
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			int bit = BITNR[y][x];
-			if (bit >= 0 && image.get(x, y)) {
-				result[bit / 6] |= static_cast<uint8_t>(1 << (5 - (bit % 6)));
-			}
-		}
+	ByteArray result(Size(CODEWORD_MODULES));
+	for (int i = 0; i < Size(CODEWORD_MODULES); i++) {
+		int codeword = 0;
+		for (auto [x, y] : CODEWORD_MODULES[i])
+			codeword = (codeword << 1) | image.get(x, y);
+		result[i] = static_cast<uint8_t>(codeword);
 	}
 	return result;
 }
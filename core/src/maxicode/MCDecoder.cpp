@@ -12,6 +12,7 @@
 #include "GenericGF.h"
 #include "MCBitMatrixParser.h"
 #include "ReedSolomonDecoder.h"
+#include "StatsScope.h"
 #include "ZXTestSupport.h"
 
 #include <algorithm>
@@ -27,7 +28,8 @@ static const int ALL = 0;
 static const int EVEN = 1;
 static const int ODD = 2;
 
-static bool CorrectErrors(ByteArray& codewordBytes, int start, int dataCodewords, int ecCodewords, int mode)
+// ecUsage is updated to the maximum of its value and the used fraction of the correction capacity of this block
+static bool CorrectErrors(ByteArray& codewordBytes, int start, int dataCodewords, int ecCodewords, int mode, float& ecUsage)
 {
 	int codewords = dataCodewords + ecCodewords;
 
@@ -41,8 +43,10 @@ static bool CorrectErrors(ByteArray& codewordBytes, int start, int dataCodewords
 			codewordsInts[i / divisor] = codewordBytes[i + start];
 	}
 
-	if (!ReedSolomonDecode(GenericGF::MaxiCodeField64(), codewordsInts, ecCodewords / divisor))
+	int numCorrections = 0;
+	if (!ReedSolomonDecode(GenericGF::MaxiCodeField64(), codewordsInts, ecCodewords / divisor, &numCorrections))
 		return false;
+	ecUsage = std::max(ecUsage, std::min(1.f, 2.f * numCorrections / (ecCodewords / divisor)));
 
 	// Copy back into array of bytes -- only need to worry about the bytes that were data
 	// We don't care about errors in the error-correction codewords
@@ -116,32 +120,40 @@ const static std::array<short, 0x40> CHARSETS[] = {
 };
 // clang-format on
 
-static int GetBit(int bit, const ByteArray& bytes)
+// The structured carrier message fields of modes 2 and 3 are scattered over the 10 codewords of the primary message. Packed
+// into one integer with bit 1 (the MSB of the first codeword) as its most significant bit, each field boils down to a
+// few shifts and masks.
+static uint64_t PrimaryBits(const ByteArray& bytes)
 {
-	bit--;
-	return (bytes[bit / 6] & (1 << (5 - (bit % 6)))) == 0 ? 0 : 1;
+	uint64_t res = 0;
+	for (int i = 0; i < 10; i++)
+		res = (res << 6) | (bytes[i] & 0x3F);
+	return res;
 }
 
-static unsigned int GetInt(const ByteArray& bytes, const ByteArray& x)
+// The count bits starting at (1-based) bit number first of the primary message
+static unsigned int GetBits(uint64_t primary, int first, int count)
 {
-	int len = Size(x);
-	unsigned int val = 0;
-	for (int i = 0; i < len; i++)
-		val += GetBit(x[i], bytes) << (len - i - 1);
+	return narrow_cast<unsigned int>((primary >> (60 - (first - 1) - count)) & ((1u << count) - 1));
+}
 
-	return val;
+// 6 bit value made of bits first..first+3 followed by bits first-6..first-5, used for the length and the characters of the postcode
+static unsigned int GetPostCodeSixBits(uint64_t primary, int first)
+{
+	return GetBits(primary, first, 4) << 2 | GetBits(primary, first - 8, 2);
 }
 
-static unsigned int GetPostCode2Length(const ByteArray& bytes)
+static unsigned int GetPostCode2Length(uint64_t primary)
 {
-	return std::min(GetInt(bytes, {39, 40, 41, 42, 31, 32}), 9U);
+	return std::min(GetPostCodeSixBits(primary, 39), 9U);
 }
 
-static std::string GetPostCode2(const ByteArray& bytes)
+static std::string GetPostCode2(uint64_t primary)
 {
-	unsigned int val = GetInt(bytes,
-				  {33, 34, 35, 36, 25, 26, 27, 28, 29, 30, 19, 20, 21, 22, 23, 24, 13, 14, 15, 16, 17, 18, 7, 8, 9, 10, 11, 12, 1, 2});
-	unsigned int len = GetPostCode2Length(bytes);
+	// bits 33-36, 25-30, 19-24, 13-18, 7-12, 1-2
+	unsigned int val = GetBits(primary, 33, 4) << 26 | GetBits(primary, 25, 6) << 20 | GetBits(primary, 19, 6) << 14 |
+					   GetBits(primary, 13, 6) << 8 | GetBits(primary, 7, 6) << 2 | GetBits(primary, 1, 2);
+	unsigned int len = GetPostCode2Length(primary);
 	// Pad or truncate to length
 	char buf[11]; // 30 bits 0x3FFFFFFF == 1073741823 (10 digits)
 	snprintf(buf, sizeof(buf), "%0*d", len, val);
@@ -149,26 +161,24 @@ static std::string GetPostCode2(const ByteArray& bytes)
 	return buf;
 }
 
-static std::string GetPostCode3(const ByteArray& bytes)
+static std::string GetPostCode3(uint64_t primary)
 {
-	return {
-		(char) CHARSETS[0].at(GetInt(bytes, { 39, 40, 41, 42, 31, 32 })),
-		(char) CHARSETS[0].at(GetInt(bytes, { 33, 34, 35, 36, 25, 26 })),
-		(char) CHARSETS[0].at(GetInt(bytes, { 27, 28, 29, 30, 19, 20 })),
-		(char) CHARSETS[0].at(GetInt(bytes, { 21, 22, 23, 24, 13, 14 })),
-		(char) CHARSETS[0].at(GetInt(bytes, { 15, 16, 17, 18,  7,  8 })),
-		(char) CHARSETS[0].at(GetInt(bytes, { 9,  10, 11, 12,  1,  2 })),
-	};
+	std::string res(6, '\0');
+	for (int i = 0; i < 6; i++)
+		res[i] = (char)CHARSETS[0][GetPostCodeSixBits(primary, 39 - 6 * i)];
+	return res;
 }
 
-static unsigned int GetCountry(const ByteArray& bytes)
+static unsigned int GetCountry(uint64_t primary)
 {
-	return std::min(GetInt(bytes, {53, 54, 43, 44, 45, 46, 47, 48, 37, 38}), 999U);
+	// bits 53-54, 43-48, 37-38
+	return std::min(GetBits(primary, 53, 2) << 8 | GetBits(primary, 43, 6) << 2 | GetBits(primary, 37, 2), 999U);
 }
 
-static unsigned int GetServiceClass(const ByteArray& bytes)
+static unsigned int GetServiceClass(uint64_t primary)
 {
-	return std::min(GetInt(bytes, {55, 56, 57, 58, 59, 60, 49, 50, 51, 52}), 999U);
+	// bits 55-60, 49-52
+	return std::min(GetBits(primary, 55, 6) << 4 | GetBits(primary, 49, 4), 999U);
 }
 
 /**
@@ -272,9 +282,10 @@ DecoderResult Decode(ByteArray&& bytes, const int mode)
 	switch (mode) {
 	case 2:
 	case 3: {
-		auto postcode = mode == 2 ? GetPostCode2(bytes) : GetPostCode3(bytes);
-		auto country  = ToString(GetCountry(bytes), 3);
-		auto service  = ToString(GetServiceClass(bytes), 3);
+		auto primary  = PrimaryBits(bytes);
+		auto postcode = mode == 2 ? GetPostCode2(primary) : GetPostCode3(primary);
+		auto country  = ToString(GetCountry(primary), 3);
+		auto service  = ToString(GetServiceClass(primary), 3);
 		GetMessage(bytes, 10, 84, result, sai);
 		if (result.bytes.asString().compare(0, 7, "[)>\u001E01\u001D") == 0) // "[)>" + RS + "01" + GS
 			result.insert(9, postcode + GS + country + GS + service + GS);
@@ -297,9 +308,11 @@ DecoderResult Decode(ByteArray&& bytes, const int mode)
 
 DecoderResult Decode(const BitMatrix& bits)
 {
+	StatsScope scope(DecodeStats::Stage::Decode);
 	ByteArray codewords = BitMatrixParser::ReadCodewords(bits);
 
-	if (!CorrectErrors(codewords, 0, 10, 10, ALL))
+	float ecUsage = 0;
+	if (!CorrectErrors(codewords, 0, 10, 10, ALL, ecUsage))
 		return ChecksumError();
 
 	int mode = codewords[0] & 0x0F;
@@ -309,13 +322,13 @@ DecoderResult Decode(const BitMatrix& bits)
 	case 3: // Structured Carrier Message (alphanumeric postcode)
 	case 4: // Standard Symbol
 	case 6: // Reader Programming
-		if (CorrectErrors(codewords, 20, 84, 40, EVEN) && CorrectErrors(codewords, 20, 84, 40, ODD))
+		if (CorrectErrors(codewords, 20, 84, 40, EVEN, ecUsage) && CorrectErrors(codewords, 20, 84, 40, ODD, ecUsage))
 			datawords.resize(94, 0);
 		else
 			return ChecksumError();
 		break;
 	case 5: // Full ECC
-		if (CorrectErrors(codewords, 20, 68, 56, EVEN) && CorrectErrors(codewords, 20, 68, 56, ODD))
+		if (CorrectErrors(codewords, 20, 68, 56, EVEN, ecUsage) && CorrectErrors(codewords, 20, 68, 56, ODD, ecUsage))
 			datawords.resize(78, 0);
 		else
 			return ChecksumError();
@@ -326,7 +339,7 @@ DecoderResult Decode(const BitMatrix& bits)
 	std::copy_n(codewords.begin(), 10, datawords.begin());
 	std::copy_n(codewords.begin() + 20, datawords.size() - 10, datawords.begin() + 10);
 
-	return DecodedBitStreamParser::Decode(std::move(datawords), mode);
+	return DecodedBitStreamParser::Decode(std::move(datawords), mode).setEcUsage(ecUsage);
 }
 
 } // namespace ZXing::MaxiCode
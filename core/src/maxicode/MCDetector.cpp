@@ -0,0 +1,266 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MCDetector.h"
+
+#include "BinaryBitmap.h"
+#include "BitMatrix.h"
+#include "BitMatrixCursor.h"
+#include "DetectorResult.h"
+#include "LogMatrix.h"
+#include "MCBitMatrixParser.h"
+#include "Pattern.h"
+#include "ZXAlgorithms.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace ZXing::MaxiCode {
+
+// Seen along any line through its light center, the bullseye consists of 3 dark rings on either side of the center.
+// ISO/IEC 16023:2000 Figure 5 gives the radii of the ring edges as 0.51, 1.18, 1.86, 2.53, 3.20 and 3.87 mm for a
+// module pitch of 0.88 mm, i.e. all rings are about equally wide and the center is about 1.5 times wider than a ring.
+static constexpr auto BULLSEYE_PATTERN = FixedPattern<11, 23>{2, 2, 2, 2, 2, 3, 2, 2, 2, 2, 2};
+
+// The outer edge of the outermost dark ring may touch adjacent data modules, so only the 5 inner edges are traced.
+static constexpr int BULLSEYE_EDGES = 5;
+
+// The mean radius of the 4th (dark to light) and 5th (light to dark) edge in units of the module pitch. Averaging both
+// edges cancels out print growth and binarization bias.
+static constexpr double RING_RADIUS = (2.53 + 3.20) / 2 / 0.88;
+
+// Distance between two module rows in units of the module pitch (the modules are hexagons in a honeycomb layout)
+static const double ROW_PITCH = std::sqrt(3.) / 2;
+
+// Center of the bullseye in the module grid coordinate system of BitMatrixParser, where odd rows are shifted right
+static constexpr int CENTER_X = 14;
+static constexpr int CENTER_Y = 16;
+
+struct OrientationModule
+{
+	int x, y;
+	bool black;
+};
+
+// The 6 groups of 3 modules around the bullseye that encode the orientation of the symbol (see BitMatrixParser::BITNR)
+static constexpr OrientationModule ORIENTATION_MODULES[] = {
+	{10, 9, false}, {11, 9, false},  {11, 10, false}, {17, 9, true},   {17, 10, true},  {18, 10, true},
+	{7, 15, false}, {7, 16, true},   {8, 16, false},  {20, 16, false}, {21, 16, true},  {20, 17, false},
+	{10, 22, false}, {11, 22, true}, {10, 23, false}, {17, 22, false}, {16, 23, true},  {17, 23, false},
+};
+
+// Position of the center of module (x, y) relative to the bullseye in units of the module pitch
+static PointF ModuleCenter(int x, int y)
+{
+	return {x - CENTER_X + (y & 1) * 0.5, (y - CENTER_Y) * ROW_PITCH};
+}
+
+static std::optional<ConcentricPattern> LocateBullseyeCenter(const BitMatrix& image, PointF center, int spread)
+{
+	auto cur = BitMatrixCursorI(image, PointI(center), {});
+	int minSpread = spread, maxSpread = 0;
+	for (auto d : {PointI{0, 1}, {1, 0}}) {
+		int s = CheckSymmetricPattern<true>(cur.setDirection(d), BULLSEYE_PATTERN, spread * 2, true);
+		if (!s)
+			return {};
+		UpdateMinMax(minSpread, maxSpread, s);
+	}
+	for (auto d : {PointI{1, 1}, {1, -1}})
+		if (!CheckSymmetricPattern<true>(cur.setDirection(d), BULLSEYE_PATTERN, spread * 2, false))
+			return {};
+
+	if (maxSpread > 3 * minSpread)
+		return {};
+
+	// the closed rings around the light center determine its position with sub-pixel precision
+	auto center1 = CenterOfRing(image, cur.p, maxSpread, 1);
+	if (!center1 || image.get(*center1))
+		return {};
+	auto centerN = CenterOfRings(image, *center1, maxSpread, BULLSEYE_EDGES);
+	if (!centerN || image.get(*centerN))
+		return {};
+
+	return ConcentricPattern{*centerN, (minSpread + maxSpread) / 2};
+}
+
+std::vector<ConcentricPattern> FindBullseyes(const BitMatrix& image, bool tryHarder, Deadline deadline, const BinaryBitmap* rowCache)
+{
+	std::vector<ConcentricPattern> res;
+
+	int skip = tryHarder ? 1 : std::clamp(image.height() / 2 / 100, 1, 5);
+
+	PatternRow buffer;
+
+	for (int y = skip; y < image.height() - skip && !IsExpired(deadline); y += skip) {
+		PatternView row = rowCache ? rowCache->getBitMatrixPatternRow(y) : (GetPatternRow(image, y, buffer, false), PatternView(buffer));
+		PatternView next = row; // the bullseye pattern starts with the outermost dark ring, i.e. the first bar
+
+		auto isBullseye = [](const PatternView& window, int) { return IsPattern<true>(window, BULLSEYE_PATTERN) != 0; };
+		while (next = FindLeftGuard<BULLSEYE_PATTERN.size()>(next, BULLSEYE_PATTERN.size(), isBullseye), next.isValid()) {
+			PointF p(next.pixelsInFront() + next.sum(5) + next[5] / 2.0, y + 0.5);
+
+			// make sure p is not 'inside' an already found pattern area
+			bool found = false;
+			for (auto old = res.rbegin(); old != res.rend(); ++old) {
+				// search from back to front, stop once we are out of range due to the y-coordinate
+				if (p.y - old->y > old->size / 2)
+					break;
+				if (distance(p, *old) < old->size / 2) {
+					found = true;
+					break;
+				}
+			}
+
+			if (!found) {
+				log(p, 1);
+				if (auto pattern = LocateBullseyeCenter(image, p, Reduce(next))) {
+					log(*pattern, 3);
+					res.push_back(*pattern);
+				}
+			}
+
+			next.skipPair();
+			next.extend();
+		}
+	}
+
+	return res;
+}
+
+// Solves the 3x3 linear system m * x = b with Cramer's rule
+static std::optional<std::array<double, 3>> Solve3x3(const std::array<std::array<double, 3>, 3>& m, const std::array<double, 3>& b)
+{
+	auto det = [](const std::array<std::array<double, 3>, 3>& a) {
+		return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+			   a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+	};
+	double d = det(m);
+	if (std::abs(d) < 1e-12)
+		return {};
+
+	std::array<double, 3> res;
+	for (int i = 0; i < 3; ++i) {
+		auto mi = m;
+		for (int j = 0; j < 3; ++j)
+			mi[j][i] = b[j];
+		res[i] = det(mi) / d;
+	}
+	return res;
+}
+
+std::optional<Bullseye> LocateBullseye(const BitMatrix& image, const ConcentricPattern& fp)
+{
+	// Measure the 4th and 5th edge along a number of rays and fit an ellipse a*x^2 + 2*b*x*y + c*y^2 = 1 to it, which
+	// covers symbols that are viewed at an angle.
+	constexpr int NUM_RAYS = 32;
+	std::array<PointF, NUM_RAYS> points;
+	for (int i = 0; i < NUM_RAYS; ++i) {
+		double alpha = 2 * 3.14159265358979 * i / NUM_RAYS;
+		BitMatrixCursorF cur(image, fp, {std::cos(alpha), std::sin(alpha)});
+		int inner = cur.stepToEdge(BULLSEYE_EDGES - 1, fp.size);
+		int outer = inner ? cur.stepToEdge(1, fp.size) : 0;
+		if (!outer)
+			return {};
+		// the edges lie half a step before the first pixel of the new color
+		points[i] = (inner - 0.5 + outer / 2.) * cur.d;
+	}
+
+	std::array<std::array<double, 3>, 3> m = {};
+	std::array<double, 3> rhs = {};
+	for (auto p : points) {
+		std::array<double, 3> f = {p.x * p.x, 2 * p.x * p.y, p.y * p.y};
+		for (int i = 0; i < 3; ++i) {
+			rhs[i] += f[i];
+			for (int j = 0; j < 3; ++j)
+				m[i][j] += f[i] * f[j];
+		}
+	}
+	auto abc = Solve3x3(m, rhs);
+	if (!abc)
+		return {};
+	auto [a, b, c] = *abc;
+	double det = a * c - b * b;
+	if (a <= 0 || det <= 0)
+		return {};
+
+	// reject anything that is not reasonably close to an ellipse, e.g. a bullseye that is partially covered
+	for (auto p : points)
+		if (std::abs(std::sqrt(a * p.x * p.x + 2 * b * p.x * p.y + c * p.y * p.y) - 1) > 0.15)
+			return {};
+
+	// The symmetric square root of the inverse of [[a, b], [b, c]] maps the unit circle onto the ellipse.
+	double s00 = c / det, s01 = -b / det, s11 = a / det;
+	double sqrtDet = std::sqrt(s00 * s11 - s01 * s01);
+	double t = std::sqrt(s00 + s11 + 2 * sqrtDet);
+	PointF ex = {(s00 + sqrtDet) / t, s01 / t};
+	PointF ey = {s01 / t, (s11 + sqrtDet) / t};
+	if (std::max(length(ex), length(ey)) > 3 * std::min(length(ex), length(ey)))
+		return {};
+
+	// Find the orientation by matching the orientation modules in 1 degree steps. The matching angles form a contiguous
+	// range (unless the symbol is mis-detected), its middle gives the best estimate of the orientation.
+	auto bullseye = [&](int angle) {
+		double alpha = 2 * 3.14159265358979 * angle / 360;
+		PointF right = (std::cos(alpha) * ex + std::sin(alpha) * ey) / RING_RADIUS;
+		PointF down = (-std::sin(alpha) * ex + std::cos(alpha) * ey) / RING_RADIUS;
+		return Bullseye{fp, right, down};
+	};
+
+	std::array<int, 360> scores;
+	for (int angle = 0; angle < 360; ++angle) {
+		auto be = bullseye(angle);
+		scores[angle] = 0;
+		for (auto [x, y, black] : ORIENTATION_MODULES) {
+			auto mc = ModuleCenter(x, y);
+			auto p = be.center + mc.x * be.right + mc.y * be.down;
+			scores[angle] += image.isIn(p) && image.get(p) == black;
+		}
+	}
+
+	// allow for 2 damaged orientation modules
+	int maxScore = *std::max_element(scores.begin(), scores.end());
+	if (maxScore < Size(ORIENTATION_MODULES) - 2)
+		return {};
+
+	int start = FindIf(scores, [&](int s) { return s != maxScore; }) - scores.begin();
+	if (start == Size(scores))
+		return {};
+	int bestFirst = 0, bestLength = 0;
+	for (int i = 1, first = 0, len = 0; i <= 360; ++i) {
+		if (scores[(start + i) % 360] == maxScore) {
+			if (!len++)
+				first = start + i;
+			if (len > bestLength)
+				bestFirst = first, bestLength = len;
+		} else {
+			len = 0;
+		}
+	}
+
+	return bullseye((bestFirst + (bestLength - 1) / 2) % 360);
+}
+
+DetectorResult SampleMaxiCode(const BitMatrix& image, const Bullseye& bullseye, double scale)
+{
+	auto toPixel = [&](PointF m) { return bullseye.center + scale * (m.x * bullseye.right + m.y * bullseye.down); };
+
+	BitMatrix bits(BitMatrixParser::MATRIX_WIDTH, BitMatrixParser::MATRIX_HEIGHT);
+	for (int y = 0; y < bits.height(); ++y)
+		for (int x = 0; x < bits.width(); ++x) {
+			auto p = toPixel(ModuleCenter(x, y));
+			if (image.isIn(p) && image.get(p))
+				bits.set(x, y);
+		}
+
+	// the even rows span 30 module pitches, the odd ones are shifted right by half a pitch and have one module less
+	const double left = -CENTER_X - 0.5, right = left + BitMatrixParser::MATRIX_WIDTH;
+	const double top = -(CENTER_Y + 0.5) * ROW_PITCH, bottom = top + BitMatrixParser::MATRIX_HEIGHT * ROW_PITCH;
+	QuadrilateralI position(toPixel({left, top}), toPixel({right, top}), toPixel({right, bottom}), toPixel({left, bottom}));
+
+	return {std::move(bits), std::move(position)};
+}
+
+} // namespace ZXing::MaxiCode
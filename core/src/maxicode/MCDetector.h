@@ -0,0 +1,51 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "ConcentricFinder.h"
+#include "Deadline.h"
+#include "Point.h"
+
+#include <optional>
+#include <vector>
+
+namespace ZXing {
+
+class BinaryBitmap;
+class BitMatrix;
+class DetectorResult;
+
+namespace MaxiCode {
+
+/**
+ * The geometry of a MaxiCode symbol in the image: the center of its bullseye and the pixel offsets corresponding
+ * to one module pitch along the module rows (right) and one module pitch perpendicular to them (down). The rows of
+ * a MaxiCode are sqrt(3)/2 module pitches apart.
+ */
+struct Bullseye
+{
+	PointF center;
+	PointF right, down;
+};
+
+// rowCache (optional) provides the cached pattern rows of image, see BinaryBitmap::getBitMatrixPatternRow()
+std::vector<ConcentricPattern> FindBullseyes(const BitMatrix& image, bool tryHarder, Deadline deadline = Deadline::max(),
+											 const BinaryBitmap* rowCache = nullptr);
+
+/**
+ * Measures the (possibly skewed) outline of the bullseye rings around fp and determines the orientation of the symbol
+ * from the 18 orientation modules around the bullseye.
+ */
+std::optional<Bullseye> LocateBullseye(const BitMatrix& image, const ConcentricPattern& fp);
+
+/**
+ * Samples the 30x33 hexagonal module grid of the symbol. The module pitch derived from the bullseye rings is multiplied
+ * by scale, which allows the caller to compensate for printing tolerances by trying a few values close to 1.
+ */
+DetectorResult SampleMaxiCode(const BitMatrix& image, const Bullseye& bullseye, double scale = 1);
+
+} // MaxiCode
+} // ZXing
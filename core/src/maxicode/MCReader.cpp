@@ -10,9 +10,17 @@
 #include "BitMatrix.h"
 #include "DecodeHints.h"
 #include "DecoderResult.h"
+#include "DetectorResult.h"
 #include "MCBitMatrixParser.h"
 #include "MCDecoder.h"
+#include "MCDetector.h"
+#include "Quadrilateral.h"
 #include "Result.h"
+#include "TraceScope.h"
+#include "ZXAlgorithms.h"
+
+#include <algorithm>
+#include <utility>
 
 namespace ZXing::MaxiCode {
 
@@ -47,11 +55,58 @@ static BitMatrix ExtractPureBits(const BitMatrix& image)
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
+	ZX_TRACE_SCOPE("MaxiCode::Reader::decode");
+	return FirstOrDefault(decode(image, 1));
+}
+
+Results Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("MaxiCode::Reader::decode");
 	auto binImg = image.getBitMatrix();
 	if (binImg == nullptr)
 		return {};
 
-	//TODO: this only works with effectively 'pure' barcodes. Needs proper detector.
+	Results results;
+	if (!_hints.isPure()) {
+		for (const auto& fp : FindBullseyes(*binImg, _hints.tryHarder(), _hints.deadline(), &image)) {
+			if (IsExpired(_hints.deadline()))
+				break;
+			// skip bullseyes inside an already decoded symbol
+			if (std::any_of(results.begin(), results.end(), [&](const Result& r) { return IsInside(PointI(fp), r.position()); }))
+				continue;
+
+			auto bullseye = LocateBullseye(*binImg, fp);
+			if (!bullseye)
+				continue;
+
+			if (_hints.detectOnly()) {
+				results.emplace_back(SampleMaxiCode(*binImg, *bullseye).position(), BarcodeFormat::MaxiCode);
+				if (maxSymbols > 0 && Size(results) >= maxSymbols)
+					return results;
+				continue;
+			}
+
+			// the module pitch is derived from the size of the bullseye, which is subject to printing tolerances
+			for (double scale : {1., 0.97, 1.03, 0.94, 1.06}) {
+				auto detRes = SampleMaxiCode(*binImg, *bullseye, scale);
+				DecoderResult decRes = Decode(detRes.bits());
+				if (decRes.isValid()) {
+					results.emplace_back(std::move(decRes), std::move(detRes).position(), BarcodeFormat::MaxiCode);
+					break;
+				}
+			}
+			if (maxSymbols > 0 && Size(results) >= maxSymbols)
+				return results;
+		}
+		if (!results.empty())
+			return results;
+	}
+
+	// the fallback below has no position to report
+	if (_hints.detectOnly())
+		return {};
+
+	// the pure image case also serves as a fallback for symbols with a damaged bullseye
 	BitMatrix bits = ExtractPureBits(*binImg);
 	if (bits.empty())
 		return {};
@@ -61,7 +116,8 @@ Reader::decode(const BinaryBitmap& image) const
 	if (!decRes.isValid())
 		return {};
 
-	return Result(std::move(decRes), {}, BarcodeFormat::MaxiCode);
+	results.emplace_back(std::move(decRes), QuadrilateralI{}, BarcodeFormat::MaxiCode);
+	return results;
 }
 
 } // namespace ZXing::MaxiCode
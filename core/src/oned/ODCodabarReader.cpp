@@ -16,11 +16,11 @@
 
 namespace ZXing::OneD {
 
-static const char ALPHABET[] = "0123456789-$:/.+ABCD";
+constexpr char ALPHABET[] = "0123456789-$:/.+ABCD";
 
 // These represent the encodings of characters, as patterns of wide and narrow bars. The 7 least-significant bits of
 // each int correspond to the pattern of wide and narrow, with 1s representing wide and 0s representing narrow.
-static const int CHARACTER_ENCODINGS[] = {
+constexpr int CHARACTER_ENCODINGS[] = {
 	0x03, 0x06, 0x09, 0x60, 0x12, 0x42, 0x21, 0x24, 0x30, 0x48, // 0-9
 	0x0c, 0x18, 0x45, 0x51, 0x54, 0x15, 0x1A, 0x29, 0x0B, 0x0E, // -$:/.+ABCD
 };
@@ -32,6 +32,9 @@ static_assert(Size(ALPHABET) - 1 == Size(CHARACTER_ENCODINGS), "table size misma
 
 // each character has 4 bars and 3 spaces
 constexpr int CHAR_LEN = 7;
+
+// the characters of all 128 narrow/wide patterns
+constexpr auto CHARACTER_TABLE = RowReader::NarrowWideTable<CHAR_LEN>(CHARACTER_ENCODINGS, ALPHABET);
 // quiet zone is half the width of a character symbol
 constexpr float QUIET_ZONE_SCALE = 0.5f;
 
@@ -39,12 +42,20 @@ constexpr float QUIET_ZONE_SCALE = 0.5f;
 // some codabar generator allow the codabar string to be closed by every
 // character. This will cause lots of false positives!
 
+static bool IsStartOrStopSymbol(char c)
+{
+	return 'A' <= c && c <= 'D';
+}
+
 bool IsLeftGuard(const PatternView& view, int spaceInPixel)
 {
-	return spaceInPixel > view.sum() * QUIET_ZONE_SCALE &&
-		   Contains({0x1A, 0x29, 0x0B, 0x0E}, RowReader::NarrowWideBitPattern(view));
+	return spaceInPixel > view.sum() * QUIET_ZONE_SCALE
+		   && IsStartOrStopSymbol(RowReader::DecodeNarrowWidePattern<CHAR_LEN>(view, CHARACTER_TABLE));
 }
 
+// the quiet zone is at least half the width of the 7 element start character: 2 * s > b + 6
+CodabarReader::CodabarReader(const DecodeHints& hints) : RowReader(hints, {1, 5}) {}
+
 Result
 CodabarReader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const
 {
@@ -52,7 +63,6 @@ CodabarReader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<D
 	// absolute minimum would be 2 (meaning 0 'content'). everything below 4 produces too many false
 	// positives.
 	const int minCharCount = 4;
-	auto isStartOrStopSymbol = [](char c) { return 'A' <= c && c <= 'D'; };
 
 	next = FindLeftGuard<CHAR_LEN>(next, minCharCount * CHAR_LEN, IsLeftGuard);
 	if (!next.isValid())
@@ -61,11 +71,13 @@ CodabarReader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<D
 	int xStart = next.pixelsInFront();
 	int maxInterCharacterSpace = next.sum() / 2; // spec actually says 1 narrow space, width/2 is about 4
 
-	std::string txt;
-	txt.reserve(20);
-	txt += DecodeNarrowWidePattern(next, CHARACTER_ENCODINGS, ALPHABET); // read off the start pattern
+	// the Result copies the text anyway, so reuse a scratch buffer: most decoding attempts fail and this way none of
+	// them touches the heap
+	thread_local std::string txt;
+	txt.clear();
+	txt += DecodeNarrowWidePattern<CHAR_LEN>(next, CHARACTER_TABLE); // read off the start pattern
 
-	if (!isStartOrStopSymbol(txt.back()))
+	if (!IsStartOrStopSymbol(txt.back()))
 		return {};
 
 	do {
@@ -73,10 +85,10 @@ CodabarReader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<D
 		if (!next.skipSymbol() || !next.skipSingle(maxInterCharacterSpace))
 			return {};
 
-		txt += DecodeNarrowWidePattern(next, CHARACTER_ENCODINGS, ALPHABET);
+		txt += DecodeNarrowWidePattern<CHAR_LEN>(next, CHARACTER_TABLE);
 		if (txt.back() == 0)
 			return {};
-	} while (!isStartOrStopSymbol(txt.back()));
+	} while (!IsStartOrStopSymbol(txt.back()));
 
 	// next now points to the last decoded symbol
 	// check txt length and whitespace after the last char. See also FindStartPattern.
@@ -85,7 +97,7 @@ CodabarReader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<D
 
 	// remove stop/start characters
 	if (!_hints.returnCodabarStartEnd())
-		txt = txt.substr(1, txt.size() - 2);
+		txt.pop_back(), txt.erase(0, 1);
 
 	// symbology identifier ISO/IEC 15424:2008 4.4.9
 	// if checksum processing were implemented and checksum present and stripped then modifier would be 4
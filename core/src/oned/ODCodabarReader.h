@@ -13,7 +13,7 @@ namespace ZXing::OneD {
 class CodabarReader : public RowReader
 {
 public:
-	using RowReader::RowReader;
+	explicit CodabarReader(const DecodeHints& hints);
 
 	Result decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>& state) const override;
 };
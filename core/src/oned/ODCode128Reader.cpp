@@ -75,10 +75,9 @@ class Raw2TxtDecoder
 	};
 
 public:
-	Raw2TxtDecoder(int startCode) : codeSet(204 - startCode)
-	{
-		txt.reserve(20);
-	}
+	// no txt.reserve() here: most symbols fit into the small string buffer and the majority of decoding attempts
+	// fails anyway, this way they do not touch the heap
+	Raw2TxtDecoder(int startCode) : codeSet(204 - startCode) {}
 
 	bool decode(int code)
 	{
@@ -86,7 +85,8 @@ public:
 
 		if (codeSet == CODE_CODE_C) {
 			if (code < 100) {
-				txt.append(ToString(code, 2));
+				txt.push_back(narrow_cast<char>('0' + code / 10));
+				txt.push_back(narrow_cast<char>('0' + code % 10));
 			} else if (code == CODE_FNC_1) {
 				fnc1(true /*isCodeSetC*/);
 			} else {
@@ -162,27 +162,47 @@ constexpr int CHAR_LEN = 6;
 constexpr float QUIET_ZONE = 5;	// quiet zone spec is 10 modules, real world examples ignore that, see #138
 constexpr int CHAR_SUM = 11;
 
-//TODO: make this a constexpr variable initialization
-static auto E2E_PATTERNS = [] {
-	// This creates an array of ints for fast IndexOf lookup of the edge-2-edge patterns (ISO/IEC 15417:2007(E) Table 2)
-	// e.g. a code pattern of { 2, 1, 2, 2, 2, 2 } becomes the e2e pattern { 3, 3, 4, 4 } and the value 0b11100011110000.
-	std::array<int, 107> res;
-	for (int i = 0; i < Size(res); ++i) {
+// Each of the 4 edge-2-edge widths of a code (ISO/IEC 15417:2007(E) Table 2) is the sum of 2 element widths in [1, 4],
+// e.g. a code pattern of { 2, 1, 2, 2, 2, 2 } becomes the e2e pattern { 3, 3, 4, 4 }. Read as a base 7 number with
+// digits e2e - 2, this is the index into a direct lookup table of 7^4 entries.
+constexpr int E2E_MIN = 2;
+constexpr int E2E_BASE = 7;
+
+static constexpr auto E2E_LOOKUP = [] {
+	std::array<int8_t, E2E_BASE * E2E_BASE * E2E_BASE * E2E_BASE> res = {};
+	for (auto& v : res)
+		v = -1;
+	for (int i = 0; i < Size(Code128::CODE_PATTERNS); ++i) {
 		const auto& a = Code128::CODE_PATTERNS[i];
-		std::array<int, 4> e2e;
+		int index = 0;
 		for (int j = 0; j < 4; j++)
-			e2e[j] = a[j] + a[j + 1];
-		res[i] = ToInt(e2e);
+			index = index * E2E_BASE + a[j] + a[j + 1] - E2E_MIN;
+		if (res[index] == -1)
+			res[index] = narrow_cast<int8_t>(i);
 	}
 	return res;
 }();
 
+static int LookupE2EPattern(const std::array<int, 4>& e2e)
+{
+	int index = 0;
+	for (int v : e2e) {
+		if (v < E2E_MIN || v >= E2E_MIN + E2E_BASE)
+			return -1;
+		index = index * E2E_BASE + v - E2E_MIN;
+	}
+	return E2E_LOOKUP[index];
+}
+
+// the start pattern prefix begins with a 2 module bar: 2 * s >= 2 * QUIET_ZONE * (b - 0.5) / 2.5 - 2
+Code128Reader::Code128Reader(const DecodeHints& hints) : RowReader(hints, {4, -6}) {}
+
 Result Code128Reader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const
 {
 	int minCharCount = 4; // start + payload + checksum + stop
 	auto decodePattern = [](const PatternView& view, bool start = false) {
 		// This is basically the reference algorithm from the specification
-		int code = IndexOf(E2E_PATTERNS, ToInt(NormalizedE2EPattern<CHAR_LEN, CHAR_SUM>(view)));
+		int code = LookupE2EPattern(NormalizedE2EPattern<CHAR_LEN, CHAR_SUM>(view));
 		if (code == -1 && !start) // if the reference algo fails, give the original upstream version a try (required to decode a few samples)
 			code = DecodeDigit(view, Code128::CODE_PATTERNS, MAX_AVG_VARIANCE, MAX_INDIVIDUAL_VARIANCE);
 		return code;
@@ -198,9 +218,12 @@ Result Code128Reader::decodePattern(int rowNumber, PatternView& next, std::uniqu
 		return {};
 
 	int xStart = next.pixelsInFront();
-	ByteArray rawCodes;
-	rawCodes.reserve(20);
-	rawCodes.push_back(narrow_cast<uint8_t>(startCode));
+
+	// instead of collecting the raw codes, sum up the checksum on the fly: the start code has weight 1, the following
+	// codes their position and the last code (the one before the stop code) is the checksum itself
+	int codeCount = 1;
+	int checksum = startCode;
+	int lastCode = startCode;
 
 	Raw2TxtDecoder raw2txt(startCode);
 
@@ -219,10 +242,13 @@ Result Code128Reader::decodePattern(int rowNumber, PatternView& next, std::uniqu
 		if (!raw2txt.decode(code))
 			return {};
 
-		rawCodes.push_back(narrow_cast<uint8_t>(code));
+		if (codeCount > 1)
+			checksum += (codeCount - 1) * lastCode;
+		lastCode = code;
+		++codeCount;
 	}
 
-	if (Size(rawCodes) < minCharCount - 1) // stop code is missing in rawCodes
+	if (codeCount < minCharCount - 1) // stop code is not counted
 		return {};
 
 	// check termination bar (is present and not wider than about 2 modules) and quiet zone (next is now 13 modules
@@ -232,11 +258,7 @@ Result Code128Reader::decodePattern(int rowNumber, PatternView& next, std::uniqu
 		return {};
 
 	Error error;
-	int checksum = rawCodes.front();
-	for (int i = 1; i < Size(rawCodes) - 1; ++i)
-		checksum += i * rawCodes[i];
-	// the last code is the checksum:
-	if (checksum % 103 != rawCodes.back())
+	if (checksum % 103 != lastCode)
 		error = ChecksumError();
 
 	int xStop = next.pixelsTillEnd();
@@ -13,7 +13,7 @@ namespace ZXing::OneD {
 class Code128Reader : public RowReader
 {
 public:
-	using RowReader::RowReader;
+	explicit Code128Reader(const DecodeHints& hints);
 
 	Result decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const override;
 };
@@ -15,7 +15,7 @@
 
 namespace ZXing::OneD {
 
-static const char ALPHABET[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-. $/+%*";
+constexpr char ALPHABET[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-. $/+%*";
 
 /**
 * Each character consists of 5 bars and 4 spaces, 3 of which are wide (i.e. 6 are narrow).
@@ -24,7 +24,7 @@ static const char ALPHABET[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-. $/+%*";
 * The 9 least-significant bits of each int correspond to the pattern of wide and narrow,
 * with 1s representing "wide" and 0s representing "narrow".
 */
-static const int CHARACTER_ENCODINGS[] = {
+constexpr int CHARACTER_ENCODINGS[] = {
 	0x034, 0x121, 0x061, 0x160, 0x031, 0x130, 0x070, 0x025, 0x124, 0x064, // 0-9
 	0x109, 0x049, 0x148, 0x019, 0x118, 0x058, 0x00D, 0x10C, 0x04C, 0x01C, // A-J
 	0x103, 0x043, 0x142, 0x013, 0x112, 0x052, 0x007, 0x106, 0x046, 0x016, // K-T
@@ -43,11 +43,12 @@ static const char PERCENTAGE_MAPPING[26] = {
 	127, 127, 127										// %X to %Z all map to DEL (127)
 };
 
-using CounterContainer = std::array<int, 9>;
-
 // each character has 5 bars and 4 spaces
 constexpr int CHAR_LEN = 9;
 
+// the characters of all 512 narrow/wide patterns
+constexpr auto CHARACTER_TABLE = RowReader::NarrowWideTable<CHAR_LEN>(CHARACTER_ENCODINGS, ALPHABET);
+
 /** Decode the extended string in place. Return false if FormatError occurred.
  * ctrl is either "$%/+" for code39 or "abcd" for code93. */
 bool
@@ -75,6 +76,9 @@ DecodeExtendedCode39AndCode93(std::string& encoded, const char ctrl[4])
 	return true;
 }
 
+// the start pattern begins with a narrow bar and has a 6 module quiet zone: 2 * s >= 2 * 6 * (b - 0.5) / 1.5 - 2
+Code39Reader::Code39Reader(const DecodeHints& hints) : RowReader(hints, {8, -8}) {}
+
 Result Code39Reader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<RowReader::DecodingState>&) const
 {
 	// minimal number of characters that must be present (including start, stop and checksum characters)
@@ -90,21 +94,23 @@ Result Code39Reader::decodePattern(int rowNumber, PatternView& next, std::unique
 	if (!next.isValid())
 		return {};
 
-	if (!isStartOrStopSymbol(DecodeNarrowWidePattern(next, CHARACTER_ENCODINGS, ALPHABET))) // read off the start pattern
+	if (!isStartOrStopSymbol(DecodeNarrowWidePattern<CHAR_LEN>(next, CHARACTER_TABLE))) // read off the start pattern
 		return {};
 
 	int xStart = next.pixelsInFront();
 	int maxInterCharacterSpace = next.sum() / 2; // spec actually says 1 narrow space, width/2 is about 4
 
-	std::string txt;
-	txt.reserve(20);
+	// the Result copies the text anyway, so reuse a scratch buffer: most decoding attempts fail and this way none of
+	// them touches the heap
+	thread_local std::string txt;
+	txt.clear();
 
 	do {
 		// check remaining input width and inter-character space
 		if (!next.skipSymbol() || !next.skipSingle(maxInterCharacterSpace))
 			return {};
 
-		txt += DecodeNarrowWidePattern(next, CHARACTER_ENCODINGS, ALPHABET);
+		txt += DecodeNarrowWidePattern<CHAR_LEN>(next, CHARACTER_TABLE);
 		if (txt.back() == 0)
 			return {};
 	} while (!isStartOrStopSymbol(txt.back()));
@@ -132,7 +138,7 @@ Result Code39Reader::decodePattern(int rowNumber, PatternView& next, std::unique
 	SymbologyIdentifier symbologyIdentifier = {'A', symbologyModifiers[(int)_hints.tryCode39ExtendedMode() * 2 + (int)_hints.validateCode39CheckSum()]};
 
 	int xStop = next.pixelsTillEnd();
-	return Result(std::move(txt), rowNumber, xStart, xStop, BarcodeFormat::Code39, symbologyIdentifier, error);
+	return Result(txt, rowNumber, xStart, xStop, BarcodeFormat::Code39, symbologyIdentifier, error);
 }
 
 } // namespace ZXing::OneD
@@ -18,7 +18,7 @@ public:
 	* or optionally attempt to decode "extended Code 39" sequences that are used to encode
 	* the full ASCII character set.
 	*/
-	using RowReader::RowReader;
+	explicit Code39Reader(const DecodeHints& hints);
 
 	Result decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const override;
 };
@@ -80,6 +80,9 @@ static bool IsStartGuard(const PatternView& window, int spaceInPixel)
 		   RowReader::OneToFourBitPattern<CHAR_LEN, CHAR_SUM>(window) == ASTERISK_ENCODING;
 }
 
+// the start pattern begins with a narrow bar and has a 6 module quiet zone: 2 * s >= 2 * 6 * (b - 0.5) / 1.5 - 2
+Code93Reader::Code93Reader(const DecodeHints& hints) : RowReader(hints, {8, -8}) {}
+
 Result Code93Reader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const
 {
 	// minimal number of characters that must be present (including start, stop, checksum and 1 payload characters)
@@ -91,8 +94,10 @@ Result Code93Reader::decodePattern(int rowNumber, PatternView& next, std::unique
 
 	int xStart = next.pixelsInFront();
 
-	std::string txt;
-	txt.reserve(20);
+	// the Result copies the text anyway, so reuse a scratch buffer: most decoding attempts fail and this way none of
+	// them touches the heap
+	thread_local std::string txt;
+	txt.clear();
 
 	do {
 		// check remaining input width
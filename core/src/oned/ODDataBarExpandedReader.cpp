@@ -119,7 +119,8 @@ constexpr int FINDER_E = 5;
 constexpr int FINDER_F = 6;
 
 // A negative number means the finder pattern is laid out right2left. Note: each finder may only occur once per code.
-static const std::array<std::vector<int>, 10> FINDER_PATTERN_SEQUENCES = {{
+// The sequence with index i consists of the first i + 2 values, the rest is padding.
+static constexpr std::array<std::array<int, 11>, 10> FINDER_PATTERN_SEQUENCES = {{
 	{FINDER_A, -FINDER_A},
 	{FINDER_A, -FINDER_B, FINDER_B},
 	{FINDER_A, -FINDER_C, FINDER_B, -FINDER_D},
@@ -132,7 +133,7 @@ static const std::array<std::vector<int>, 10> FINDER_PATTERN_SEQUENCES = {{
 	{FINDER_A, -FINDER_A, FINDER_B, -FINDER_B, FINDER_C, -FINDER_D, FINDER_D, -FINDER_E, FINDER_E, -FINDER_F, FINDER_F},
 }};
 
-static const std::array<int, 7> VALID_HALF_PAIRS = {{-FINDER_A, FINDER_B, -FINDER_D, FINDER_C, -FINDER_F, FINDER_F, FINDER_E}};
+static constexpr std::array<int, 7> VALID_HALF_PAIRS = {{-FINDER_A, FINDER_B, -FINDER_D, FINDER_C, -FINDER_F, FINDER_F, FINDER_E}};
 
 static int ParseFinderPattern(const PatternView& view, Direction dir)
 {
@@ -236,7 +237,12 @@ static Pairs ReadRowOfPairs(PatternView& next, int rowNumber)
 
 using PairMap = std::map<int, Pairs>;
 
-// inserts all pairs inside row into the PairMap or increases their count respectively.
+// only the N most common pairs per finder are tried in FindValidSequence, this means the absolute maximum number of
+// ChecksumIsValid() evaluations is N^11 (11 is the maximum sequence length).
+constexpr int MAX_PAIRS_PER_FINDER = 2;
+
+// inserts all pairs inside row into the PairMap or increases their count respectively. returns true if the set of
+// pairs FindValidSequence() would look at has changed, i.e. only then it can possibly find a new valid sequence.
 static bool Insert(PairMap& all, Pairs&& row)
 {
 	bool res = false;
@@ -244,14 +250,18 @@ static bool Insert(PairMap& all, Pairs&& row)
 		auto& pairs = all[pair.finder];
 		if (auto i = Find(pairs, pair); i != pairs.end()) {
 			i->count++;
+			bool wasCandidate = i - pairs.begin() < MAX_PAIRS_PER_FINDER;
 			// bubble sort the pairs with the highest view count to the front so we test them first in FindValidSequence
 			while (i != pairs.begin() && i[0].count > i[-1].count) {
 				std::swap(i[-1], i[0]);
 				--i;
 			}
-		} else
+			res |= !wasCandidate && i - pairs.begin() < MAX_PAIRS_PER_FINDER;
+		} else {
 			pairs.push_back(pair);
-		res = true;
+			// all FINDER_A pairs are tried as the start of a sequence
+			res |= pair.finder == FINDER_A || Size(pairs) <= MAX_PAIRS_PER_FINDER;
+		}
 	}
 	return res;
 }
@@ -263,9 +273,7 @@ static bool FindValidSequence(const PairMap& all, ITER begin, ITER end, Pairs& s
 		return ChecksumIsValid(stack);
 
 	if (auto ppairs = all.find(*begin); ppairs != all.end()) {
-		// only try the N most common pairs, this means the absolute maximum number of ChecksumIsValid() evaluations
-		// is N^11 (11 is the maximum sequence length).
-		constexpr int N = 2;
+		constexpr int N = MAX_PAIRS_PER_FINDER;
 		// TODO c++20 ranges::views::take()
 		auto& pairs = ppairs->second;
 		int n = 0;
@@ -296,7 +304,7 @@ static Pairs FindValidSequence(PairMap& all)
 		auto& sequence = FINDER_PATTERN_SEQUENCES[sequenceIndex];
 		stack.push_back(first);
 		// recursively fill the stack with pairs according to the valid finder sequence
-		if (FindValidSequence(all, std::next(std::begin(sequence)), std::end(sequence), stack))
+		if (FindValidSequence(all, sequence.begin() + 1, sequence.begin() + sequenceIndex + 2, stack))
 			break;
 		stack.pop_back();
 	}
@@ -328,6 +336,8 @@ static BitArray BuildBitArray(const Pairs& pairs)
 struct DBERState : public RowReader::DecodingState
 {
 	PairMap allPairs;
+	// set if the last row changed the candidate pairs, otherwise re-running FindValidSequence would be wasted effort
+	bool searchPending = false;
 };
 
 Result DataBarExpandedReader::decodePattern(int rowNumber, PatternView& view,
@@ -341,7 +351,8 @@ Result DataBarExpandedReader::decodePattern(int rowNumber, PatternView& view,
 #else
 	if (!state)
 		state.reset(new DBERState);
-	auto& allPairs = static_cast<DBERState*>(state.get())->allPairs;
+	auto& dberState = *static_cast<DBERState*>(state.get());
+	auto& allPairs = dberState.allPairs;
 
 	// Stacked codes can be laid out in a number of ways. The following rules apply:
 	//  * the first row starts with FINDER_A in left-to-right (l2r) layout
@@ -356,8 +367,13 @@ Result DataBarExpandedReader::decodePattern(int rowNumber, PatternView& view,
 	//    r l r l    |    r l     |     r l r
 	//    L R L R    |    r       |     l
 
-	if (!Insert(allPairs, ReadRowOfPairs<true>(view, rowNumber)))
+	// the pairs seen so far are kept across rows and only a row that adds a new candidate pair triggers a new search.
+	// most rows of a stacked symbol re-read already known pairs, so the CPU time for those is bounded by the number of
+	// pairs in the row instead of the combinatorial sequence search.
+	dberState.searchPending |= Insert(allPairs, ReadRowOfPairs<true>(view, rowNumber));
+	if (!dberState.searchPending)
 		return {};
+	dberState.searchPending = false;
 
 	auto pairs = FindValidSequence(allPairs);
 	if (pairs.empty())
@@ -369,6 +385,8 @@ Result DataBarExpandedReader::decodePattern(int rowNumber, PatternView& view,
 		return {};
 
 	RemovePairs(allPairs, pairs);
+	// removing the decoded pairs may leave another symbol's pairs at the front
+	dberState.searchPending = true;
 
 	// TODO: EstimatePosition misses part of the symbol in the stacked case where the last row contains less pairs than
 	// the first
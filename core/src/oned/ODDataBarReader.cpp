@@ -13,8 +13,12 @@
 #include "ODDataBarCommon.h"
 #include "Result.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
-#include <unordered_set>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace ZXing::OneD {
 
@@ -120,16 +124,26 @@ static Pair ReadPair(const PatternView& view, bool rightPair)
 	return {};
 }
 
-static bool ChecksumIsValid(Pair leftPair, Pair rightPair)
+// The checksum of a symbol is valid if (LeftResidue(leftPair) + RightResidue(rightPair)) % 79 == FinderChecksum(leftPair,
+// rightPair), the finder values (1-9, negative for right pairs) determine the expected checksum
+static int LeftResidue(const Pair& p)
 {
-	auto checksum = [](Pair p) { return p.left.checksum + 4 * p.right.checksum; };
-	int a = (checksum(leftPair) + 16 * checksum(rightPair)) % 79;
-	int b = 9 * (std::abs(leftPair.finder) - 1) + (std::abs(rightPair.finder) - 1);
+	return (p.left.checksum + 4 * p.right.checksum) % 79;
+}
+
+static int RightResidue(const Pair& p)
+{
+	return 16 * (p.left.checksum + 4 * p.right.checksum) % 79;
+}
+
+static int FinderChecksum(int leftFinder, int rightFinder)
+{
+	int b = 9 * (std::abs(leftFinder) - 1) + (std::abs(rightFinder) - 1);
 	if (b > 72)
 		b--;
 	if (b > 8)
 		b--;
-	return a == b;
+	return b;
 }
 
 static std::string ConstructText(Pair leftPair, Pair rightPair)
@@ -144,10 +158,81 @@ static std::string ConstructText(Pair leftPair, Pair rightPair)
 	return txt + GTIN::ComputeCheckDigit(txt);
 }
 
-struct State : public RowReader::DecodingState
+// The pairs seen in the rows so far that are not part of a symbol yet, indexed by their finder value and checksum
+// residue. A new pair only needs to look at the few ones of the other side that complete a valid checksum with it,
+// instead of trying every left x right combination, which gets slow with many symbols in the image.
+class State : public RowReader::DecodingState
 {
-	std::unordered_set<Pair, PairHash> leftPairs;
-	std::unordered_set<Pair, PairHash> rightPairs;
+	// the pairs are indexed by their finder value and the residue their checksums contribute to the symbol checksum,
+	// so a pair only has to be tested against the few stored pairs of the other side that can complete a valid symbol
+	static constexpr int NUM_KEYS = 10 * 79;
+	static int Key(int finder, int residue) { return std::abs(finder) * 79 + residue; }
+
+	std::array<std::vector<Pair>, NUM_KEYS> _leftPairs, _rightPairs;
+	std::vector<std::pair<Pair, bool>> _added; // pairs (and their side) added in the current row
+	std::vector<std::pair<Pair, Pair>> _symbols; // valid left/right combinations, not returned yet
+
+	static int Distance(const Pair& a, const Pair& b)
+	{
+		// rows apart first, then the horizontal gap (0 for adjacent halves of one row and the stacked halves)
+		int gap = std::max(0, std::max(a.xStart, b.xStart) - std::min(a.xStop, b.xStop));
+		return std::abs(a.y - b.y) * 0x10000 + gap;
+	}
+
+	void match(const Pair& pair, bool rightPair)
+	{
+		auto& other = rightPair ? _leftPairs : _rightPairs;
+		const int residue = rightPair ? RightResidue(pair) : LeftResidue(pair);
+		auto& bucket = (rightPair ? _rightPairs : _leftPairs)[Key(pair.finder, residue)];
+		auto self = std::find(bucket.begin(), bucket.end(), pair);
+		if (self == bucket.end())
+			return; // combined already with a pair added before in the same row
+
+		std::vector<Pair>* best = nullptr;
+		std::size_t bestIndex = 0;
+		for (int finder = 1; finder <= 9; ++finder) {
+			int expected = rightPair ? FinderChecksum(finder, pair.finder) : FinderChecksum(pair.finder, finder);
+			auto& candidates = other[Key(finder, (expected - residue + 79) % 79)];
+			for (std::size_t i = 0; i < candidates.size(); ++i)
+				if (!best || Distance(pair, candidates[i]) < Distance(pair, (*best)[bestIndex]))
+					best = &candidates, bestIndex = i;
+		}
+		if (!best)
+			return;
+
+		auto partner = (*best)[bestIndex];
+		bucket.erase(self);
+		best->erase(best->begin() + bestIndex);
+		_symbols.push_back(rightPair ? std::pair{partner, pair} : std::pair{pair, partner});
+	}
+
+public:
+	// stores the pair unless it is known already
+	void add(const Pair& pair, bool rightPair)
+	{
+		auto& bucket = (rightPair ? _rightPairs : _leftPairs)[Key(pair.finder, rightPair ? RightResidue(pair) : LeftResidue(pair))];
+		if (Contains(bucket, pair))
+			return;
+		bucket.push_back(pair);
+		_added.emplace_back(pair, rightPair);
+	}
+
+	// combines each pair added in the current row with the spatially closest compatible one of the other side
+	void endRow()
+	{
+		for (const auto& [pair, rightPair] : _added)
+			match(pair, rightPair);
+		_added.clear();
+	}
+
+	std::optional<std::pair<Pair, Pair>> takeSymbol()
+	{
+		if (_symbols.empty())
+			return {};
+		auto res = _symbols.front();
+		_symbols.erase(_symbols.begin());
+		return res;
+	}
 };
 
 Result DataBarReader::decodePattern(int rowNumber, PatternView& next,
@@ -159,7 +244,8 @@ Result DataBarReader::decodePattern(int rowNumber, PatternView& next,
 	while (next.shift(2)) {
 		if (IsLeftPair(next)) {
 			if (auto leftPair = ReadPair(next, false); leftPair && next.shift(FULL_PAIR_SIZE) && IsRightPair(next)) {
-				if (auto rightPair = ReadPair(next, true); rightPair && ChecksumIsValid(leftPair, rightPair)) {
+				if (auto rightPair = ReadPair(next, true);
+					rightPair && (LeftResidue(leftPair) + RightResidue(rightPair)) % 79 == FinderChecksum(leftPair.finder, rightPair.finder)) {
 					return {ConstructText(leftPair, rightPair), rowNumber, leftPair.xStart, rightPair.xStop,
 							BarcodeFormat::DataBar};
 				}
@@ -177,7 +263,7 @@ Result DataBarReader::decodePattern(int rowNumber, PatternView& next,
 		if (IsLeftPair(next)) {
 			if (auto leftPair = ReadPair(next, false)) {
 				leftPair.y = rowNumber;
-				prevState->leftPairs.insert(leftPair);
+				prevState->add(leftPair, false);
 				next.shift(FULL_PAIR_SIZE - 1);
 			}
 		}
@@ -185,24 +271,20 @@ Result DataBarReader::decodePattern(int rowNumber, PatternView& next,
 		if (next.shift(1) && IsRightPair(next)) {
 			if (auto rightPair = ReadPair(next, true)) {
 				rightPair.y = rowNumber;
-				prevState->rightPairs.insert(rightPair);
+				prevState->add(rightPair, true);
 				next.shift(FULL_PAIR_SIZE + 2);
 			}
 		}
 	}
 
-	for (const auto& leftPair : prevState->leftPairs)
-		for (const auto& rightPair : prevState->rightPairs)
-			if (ChecksumIsValid(leftPair, rightPair)) {
-				// Symbology identifier ISO/IEC 24724:2011 Section 9 and GS1 General Specifications 5.1.3 Figure 5.1.3-2
-				Result res{DecoderResult(Content(ByteArray(ConstructText(leftPair, rightPair)), {'e', '0'}))
-							   .setLineCount(EstimateLineCount(leftPair, rightPair)),
-						   EstimatePosition(leftPair, rightPair), BarcodeFormat::DataBar};
-
-				prevState->leftPairs.erase(leftPair);
-				prevState->rightPairs.erase(rightPair);
-				return res;
-			}
+	prevState->endRow();
+	if (auto symbol = prevState->takeSymbol()) {
+		const auto& [leftPair, rightPair] = *symbol;
+		// Symbology identifier ISO/IEC 24724:2011 Section 9 and GS1 General Specifications 5.1.3 Figure 5.1.3-2
+		return {DecoderResult(Content(ByteArray(ConstructText(leftPair, rightPair)), {'e', '0'}))
+					.setLineCount(EstimateLineCount(leftPair, rightPair)),
+				EstimatePosition(leftPair, rightPair), BarcodeFormat::DataBar};
+	}
 #endif
 
 	// guarantee progress (see loop in ODReader.cpp)
@@ -12,6 +12,7 @@
 #include "ZXAlgorithms.h"
 
 #include <array>
+#include <cstdint>
 
 namespace ZXing::OneD {
 
@@ -19,6 +20,31 @@ constexpr auto START_PATTERN_ = FixedPattern<4, 4>{1, 1, 1, 1};
 constexpr auto STOP_PATTERN_1 = FixedPattern<3, 4>{2, 1, 1};
 constexpr auto STOP_PATTERN_2 = FixedPattern<3, 5>{3, 1, 1};
 
+// each pair of digits is encoded in 5 bars (first digit) interleaved with 5 spaces (second digit)
+constexpr int CHAR_LEN = 10;
+
+// maps each of the 1024 narrow/wide patterns of a pair (see RowReader::NarrowWideBitPattern) to 10 * first + second
+// digit, -1 if not both have exactly 2 wide elements
+constexpr auto DIGIT_PAIRS = [] {
+	// the 2 of 5 wide elements of the digits 0-9, first element in the most significant bit
+	constexpr int DIGITS[] = {0b00110, 0b10001, 0b01001, 0b11000, 0b00101, 0b10100, 0b01100, 0b00011, 0b10010, 0b01010};
+
+	std::array<int8_t, 1 << CHAR_LEN> res = {};
+	for (auto& r : res)
+		r = -1;
+	for (int first = 0; first < 10; ++first)
+		for (int second = 0; second < 10; ++second) {
+			int pattern = 0;
+			for (int i = 4; i >= 0; --i)
+				pattern = (pattern << 2) | (((DIGITS[first] >> i) & 1) << 1) | ((DIGITS[second] >> i) & 1);
+			res[pattern] = static_cast<int8_t>(10 * first + second);
+		}
+	return res;
+}();
+
+// the start pattern begins with a narrow bar and has a 10 module quiet zone: 2 * s >= 2 * 10 * (b - 0.5) / 1.5 - 2
+ITFReader::ITFReader(const DecodeHints& hints) : RowReader(hints, {12, -10}) {}
+
 Result ITFReader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const
 {
 	const int minCharCount = 6;
@@ -28,31 +54,22 @@ Result ITFReader::decodePattern(int rowNumber, PatternView& next, std::unique_pt
 	if (!next.isValid())
 		return {};
 
-	std::string txt;
-	txt.reserve(20);
+	// the Result copies the text anyway, so reuse a scratch buffer: most decoding attempts fail and this way none of
+	// them touches the heap
+	thread_local std::string txt;
+	txt.clear();
 
-	constexpr int weights[] = {1, 2, 4, 7, 0};
 	int xStart = next.pixelsInFront();
-	next = next.subView(4, 10);
+	next = next.subView(4, CHAR_LEN);
 
 	while (next.isValid()) {
-		const auto threshold = NarrowWideThreshold(next);
-		if (!threshold.isValid())
-			break;
-
-		BarAndSpace<int> digits, numWide;
-		for (int i = 0; i < 10; ++i) {
-			if (next[i] > threshold[i] * 2)
-				break;
-			numWide[i] += next[i] > threshold[i];
-			digits[i] += weights[i/2] * (next[i] > threshold[i]);
-		}
-
-		if (numWide.bar != 2 || numWide.space != 2)
+		const int pattern = NarrowWideBitPattern<CHAR_LEN>(next);
+		const int pair = pattern < 0 ? -1 : DIGIT_PAIRS[pattern];
+		if (pair < 0)
 			break;
 
-		for (int i = 0; i < 2; ++i)
-			txt.push_back(ToDigit(digits[i] == 11 ? 0 : digits[i]));
+		txt.push_back(ToDigit(pair / 10));
+		txt.push_back(ToDigit(pair % 10));
 
 		next.skipSymbol();
 	}
@@ -25,7 +25,7 @@ namespace ZXing::OneD {
 class ITFReader : public RowReader
 {
 public:
-	using RowReader::RowReader;
+	explicit ITFReader(const DecodeHints& hints);
 
 	Result decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const override;
 };
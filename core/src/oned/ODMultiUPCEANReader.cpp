@@ -262,9 +262,16 @@ static bool AddOn(PartialResult& res, PatternView begin, int digitCount)
 	return true;
 }
 
+// the guard begins with a narrow bar: 2 * s >= 2 * QUIET_ZONE_LEFT * (b - 0.5) / 1.5 - 2
+MultiUPCEANReader::MultiUPCEANReader(const DecodeHints& hints) : RowReader(hints, {8, -8}) {}
+
 Result MultiUPCEANReader::decodePattern(int rowNumber, PatternView& next, std::unique_ptr<RowReader::DecodingState>&) const
 {
-	const int minSize = 3 + 6*4 + 6; // UPC-E
+	// number of bars and spaces of the smallest requested symbol, e.g. a retail (EAN-13/UPC-A only) setup can stop
+	// searching for a left guard a lot earlier at the end of each row
+	const int minSize = _hints.hasFormat(BarcodeFormat::UPCE) ? 3 + 6*4 + 6
+						: _hints.hasFormat(BarcodeFormat::EAN8) ? 3 + 4*4 + 5 + 4*4 + 3
+																: 3 + 6*4 + 5 + 6*4 + 3;
 
 	next = FindLeftGuard(next, minSize, END_PATTERN, QUIET_ZONE_LEFT);
 	if (!next.isValid())
@@ -282,6 +289,10 @@ Result MultiUPCEANReader::decodePattern(int rowNumber, PatternView& next, std::u
 	if (!GTIN::IsCheckDigitValid(res.format == BarcodeFormat::UPCE ? UPCEANCommon::ConvertUPCEtoUPCA(res.txt) : res.txt))
 		error = ChecksumError();
 
+	// the symbol would be dropped by the caller anyway, so don't bother with the conversions and the add-on below
+	if (error && !_hints.returnErrors())
+		return {};
+
 	// If UPC-A was a requested format and we detected a EAN-13 code with a leading '0', then we drop the '0' and call it
 	// a UPC-A code.
 	// TODO: this is questionable
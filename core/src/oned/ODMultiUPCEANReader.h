@@ -16,7 +16,7 @@ namespace ZXing::OneD {
 class MultiUPCEANReader : public RowReader
 {
 public:
-	using RowReader::RowReader;
+	explicit MultiUPCEANReader(const DecodeHints& hints);
 
 	Result decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const override;
 };
@@ -9,15 +9,35 @@
 
 #include "BinaryBitmap.h"
 #include "DecodeHints.h"
+#include "Executor.h"
+#ifdef ZXING_READER_CODABAR
 #include "ODCodabarReader.h"
+#endif
+#ifdef ZXING_READER_CODE128
 #include "ODCode128Reader.h"
+#endif
+#ifdef ZXING_READER_CODE39
 #include "ODCode39Reader.h"
+#endif
+#ifdef ZXING_READER_CODE93
 #include "ODCode93Reader.h"
+#endif
+#ifdef ZXING_READER_DATABAREXPANDED
 #include "ODDataBarExpandedReader.h"
+#endif
+#ifdef ZXING_READER_DATABAR
 #include "ODDataBarReader.h"
+#endif
+#ifdef ZXING_READER_ITF
 #include "ODITFReader.h"
+#endif
+#ifdef ZXING_READER_UPCEAN
 #include "ODMultiUPCEANReader.h"
+#endif
 #include "Result.h"
+#include "ResultIndex.h"
+#include "StatsScope.h"
+#include "TraceScope.h"
 
 #include <algorithm>
 #include <utility>
@@ -29,9 +49,9 @@
 
 namespace ZXing {
 
-void IncrementLineCount(Result& r)
+void IncrementLineCount(Result& r, int n)
 {
-	++r._lineCount;
+	r._lineCount += n;
 }
 
 } // namespace ZXing
@@ -44,78 +64,121 @@ Reader::Reader(const DecodeHints& hints) : ZXing::Reader(hints)
 
 	auto formats = hints.formats().empty() ? BarcodeFormat::Any : hints.formats();
 
+	// the readers not built (see ZXING_READERS in core/CMakeLists.txt) are left out
+#ifdef ZXING_READER_UPCEAN
 	if (formats.testFlags(BarcodeFormat::EAN13 | BarcodeFormat::UPCA | BarcodeFormat::EAN8 | BarcodeFormat::UPCE))
 		_readers.emplace_back(new MultiUPCEANReader(hints));
+#endif
 
+#ifdef ZXING_READER_CODE39
 	if (formats.testFlag(BarcodeFormat::Code39))
 		_readers.emplace_back(new Code39Reader(hints));
+#endif
+#ifdef ZXING_READER_CODE93
 	if (formats.testFlag(BarcodeFormat::Code93))
 		_readers.emplace_back(new Code93Reader(hints));
+#endif
+#ifdef ZXING_READER_CODE128
 	if (formats.testFlag(BarcodeFormat::Code128))
 		_readers.emplace_back(new Code128Reader(hints));
+#endif
+#ifdef ZXING_READER_ITF
 	if (formats.testFlag(BarcodeFormat::ITF))
 		_readers.emplace_back(new ITFReader(hints));
+#endif
+#ifdef ZXING_READER_CODABAR
 	if (formats.testFlag(BarcodeFormat::Codabar))
 		_readers.emplace_back(new CodabarReader(hints));
+#endif
+#ifdef ZXING_READER_DATABAR
 	if (formats.testFlags(BarcodeFormat::DataBar))
 		_readers.emplace_back(new DataBarReader(hints));
+#endif
+#ifdef ZXING_READER_DATABAREXPANDED
 	if (formats.testFlags(BarcodeFormat::DataBarExpanded))
 		_readers.emplace_back(new DataBarExpandedReader(hints));
+#endif
 }
 
 Reader::~Reader() = default;
 
-/**
-* We're going to examine rows from the middle outward, searching alternately above and below the
-* middle, and farther out each time. rowStep is the number of rows between each successive
-* attempt above and below the middle. So we'd scan row middle, then middle - rowStep, then
-* middle + rowStep, then middle - (2 * rowStep), etc.
-* rowStep is bigger as the image is taller, but is always at least 1. We've somewhat arbitrarily
-* decided that moving up and down by about 1/16 of the image is pretty good; we try more of the
-* image if "trying harder".
-*/
-static Results DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image,
-						bool tryHarder, bool rotate, bool isPure, int maxSymbols, int minLineCount, bool returnErrors)
+// Move next forward to the first position where the start guard of reader could begin (see
+// RowReader::StartGuardSignature), returns false if there is none.
+static bool SkipToStartCandidate(PatternView& next, const RowReader& reader)
 {
-	Results res;
+	auto [barScale, offset] = reader.startGuardSignature();
+	auto i = next.begin();
+	if (!next.isAtFirstBar())
+		while (i < next.end() && 2 * i[-1] < barScale * i[0] + offset)
+			i += 2;
+	if (i >= next.end())
+		return false;
+	next.shift(narrow_cast<int>(i - next.begin()));
+	next.extend();
+	return true;
+}
 
-	std::vector<std::unique_ptr<RowReader::DecodingState>> decodingState(readers.size());
+// merge the position information and line count of result into the same, already known symbol other
+static void MergeInto(Result& other, const Result& result, bool rotate, int lineCount)
+{
+	auto dTop = maxAbsComponent(other.position().topLeft() - result.position().topLeft());
+	auto dBot = maxAbsComponent(other.position().bottomLeft() - result.position().topLeft());
+	auto points = other.position();
+	if (dTop < dBot || (dTop == dBot && rotate ^ (sumAbsComponent(points[0]) > sumAbsComponent(result.position()[0])))) {
+		points[0] = result.position()[0];
+		points[1] = result.position()[1];
+	} else {
+		points[2] = result.position()[2];
+		points[3] = result.position()[3];
+	}
+	other.setPosition(points);
+	IncrementLineCount(other, lineCount);
+}
 
-	int width = image.width();
-	int height = image.height();
+// A symbol crossing the border between two bands (see DoDecode) is found in both of them. The two parts are not
+// overlapping but at most maxGap rows apart.
+static bool IsContinuation(const Result& a, const Result& b, bool rotate, int maxGap)
+{
+	if (a.format() != b.format() || a.bytes() != b.bytes() || a.error() != b.error() || a.orientation() != b.orientation())
+		return false;
 
-	if (rotate)
-		std::swap(width, height);
+	auto gap = rotate ? PointI(maxGap, 0) : PointI(0, maxGap);
+	return HaveIntersectingBoundingBoxes(Translate(a.position(), gap), b.position())
+		   || HaveIntersectingBoundingBoxes(Translate(a.position(), -gap), b.position());
+}
 
-	int middle = height / 2;
-	// TODO: find a better heuristic/parameterization if maxSymbols != 1
-	int rowStep = std::max(1, height / ((tryHarder && !isPure) ? (maxSymbols == 1 ? 256 : 512) : 32));
-	int maxLines = tryHarder ?
-		height :	// Look at the whole image, not just the center
-		15;			// 15 rows spaced 1/32 apart is roughly the middle half of the image
+struct ScanParams
+{
+	int width, height;
+	bool tryHarder, rotate, isPure, returnErrors;
+	int maxSymbols, minLineCount, rowStep;
+	Deadline deadline;
+#ifdef PRINT_DEBUG
+	BitMatrix* dbg;
+#endif
+};
 
-	if (isPure)
-		minLineCount = 1;
+/**
+* Scan the given rows in order and collect the found symbols in res. rows.front() is treated as the first row of a
+* 'pure' image (see the isPure handling below). If a new symbol is found, additional check rows above and below the
+* current one are scanned before continuing with the next row.
+*/
+static void ScanRows(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image,
+					 const std::vector<int>& rows, const ScanParams& scan, Results& res)
+{
+	const int width = scan.width;
+	std::vector<std::unique_ptr<RowReader::DecodingState>> decodingState(readers.size());
 	std::vector<int> checkRows;
+	ResultIndex index(res);
+	// number of symbols in res with at least scan.minLineCount lines
+	int complete = Reduce(res, 0, [&](int n, const Result& r) { return n + (r.lineCount() >= scan.minLineCount); });
 
 	PatternRow bars;
 	bars.reserve(128); // e.g. EAN-13 has 59 bars/spaces
 
-#ifdef PRINT_DEBUG
-	BitMatrix dbg(width, height);
-#endif
-
-	for (int i = 0; i < maxLines; i++) {
-
-		// Scanning from the middle out. Determine which row we're looking at next:
-		int rowStepsAboveOrBelow = (i + 1) / 2;
-		bool isAbove = (i & 0x01) == 0; // i.e. is x even?
-		int rowNumber = middle + rowStep * (isAbove ? rowStepsAboveOrBelow : -rowStepsAboveOrBelow);
+	for (int i = 0; i < Size(rows) && !IsExpired(scan.deadline); i++) {
+		int rowNumber = rows[i];
 		bool isCheckRow = false;
-		if (rowNumber < 0 || rowNumber >= height) {
-			// Oops, if we run off the top or bottom, stop
-			break;
-		}
 
 		// See if we have additional check rows (see below) to process
 		if (checkRows.size()) {
@@ -123,19 +186,20 @@ static Results DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers,
 			rowNumber = checkRows.back();
 			checkRows.pop_back();
 			isCheckRow = true;
-			if (rowNumber < 0 || rowNumber >= height)
+			if (rowNumber < 0 || rowNumber >= scan.height)
 				continue;
 		}
 
-		if (!image.getPatternRow(rowNumber, rotate ? 90 : 0, bars))
+		if (!image.getPatternRow(rowNumber, scan.rotate ? 90 : 0, bars))
 			continue;
+		CountStat(DecodeStats::Counter::RowsScanned);
 
 #ifdef PRINT_DEBUG
 		bool val = false;
 		int x = 0;
 		for (auto b : bars) {
 			for(int j = 0; j < b; ++j)
-				dbg.set(x++, rowNumber, val);
+				scan.dbg->set(x++, rowNumber, val);
 			val = !val;
 		}
 #endif
@@ -156,14 +220,23 @@ static Results DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers,
 			for (size_t r = 0; r < readers.size(); ++r) {
 				// If this is a pure symbol, then checking a single non-empty line is sufficient for all but the stacked
 				// DataBar codes. They are the only ones using the decodingState, which we can use as a flag here.
-				if (isPure && i && !decodingState[r])
+				if (scan.isPure && i && !decodingState[r])
 					continue;
 
 				PatternView next(bars);
 				do {
+					if (!SkipToStartCandidate(next, *readers[r]))
+						break;
 					Result result = readers[r]->decodePattern(rowNumber, next, decodingState[r]);
-					if (result.isValid() || (returnErrors && result.error())) {
-						IncrementLineCount(result);
+					if (result.isValid() || (scan.returnErrors && result.error())) {
+						IncrementLineCount(result, 1);
+						if (int scale = image.patternRowScale(); scale != 1) {
+							// the x coordinates are based on sub-pixel widths
+							auto points = result.position();
+							for (auto& p : points)
+								p.x /= scale;
+							result.setPosition(std::move(points));
+						}
 						if (upsideDown) {
 							// update position (flip horizontally).
 							auto points = result.position();
@@ -172,7 +245,7 @@ static Results DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers,
 							}
 							result.setPosition(std::move(points));
 						}
-						if (rotate) {
+						if (scan.rotate) {
 							auto points = result.position();
 							for (auto& p : points) {
 								p = {p.y, width - p.x - 1};
@@ -181,69 +254,198 @@ static Results DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers,
 						}
 
 						// check if we know this code already
-						for (auto& other : res) {
-							if (result == other) {
-								// merge the position information
-								auto dTop = maxAbsComponent(other.position().topLeft() - result.position().topLeft());
-								auto dBot = maxAbsComponent(other.position().bottomLeft() - result.position().topLeft());
-								auto points = other.position();
-								if (dTop < dBot || (dTop == dBot && rotate ^ (sumAbsComponent(points[0]) >
-																			  sumAbsComponent(result.position()[0])))) {
-									points[0] = result.position()[0];
-									points[1] = result.position()[1];
-								} else {
-									points[2] = result.position()[2];
-									points[3] = result.position()[3];
-								}
-								other.setPosition(points);
-								IncrementLineCount(other);
-								// clear the result, so we don't insert it again below
-								result = Result();
-								break;
-							}
-						}
-
-						if (result.format() != BarcodeFormat::None) {
+						int other = index.findIf(res, result, [&](const Result& o) { return result == o; });
+						if (other != -1) {
+							complete -= res[other].lineCount() >= scan.minLineCount;
+							MergeInto(res[other], result, scan.rotate, 1);
+							complete += res[other].lineCount() >= scan.minLineCount;
+						} else {
+							complete += result.lineCount() >= scan.minLineCount;
+							index.add(result);
 							res.push_back(std::move(result));
 
 							// if we found a valid code we have not seen before but a minLineCount > 1,
 							// add additional check rows above and below the current one
-							if (!isCheckRow && minLineCount > 1 && rowStep > 1) {
+							if (!isCheckRow && scan.minLineCount > 1 && scan.rowStep > 1) {
 								checkRows = {rowNumber - 1, rowNumber + 1};
-								if (rowStep > 2)
+								if (scan.rowStep > 2)
 									checkRows.insert(checkRows.end(), {rowNumber - 2, rowNumber + 2});
 							}
 						}
 
-						if (maxSymbols && Reduce(res, 0, [&](int s, const Result& r) {
-											  return s + (r.lineCount() >= minLineCount);
-										  }) == maxSymbols) {
-							goto out;
-						}
+						if (scan.maxSymbols && complete == scan.maxSymbols)
+							return;
 					}
 					// make sure we make progress and we start the next try on a bar
 					next.shift(2 - (next.index() % 2));
 					next.extend();
-				} while (tryHarder && next.size());
+				} while (scan.tryHarder && next.size());
 			}
 		}
 	}
+}
+
+/**
+* Reorder the rows of a tryHarder scan: first every COARSE-th row of the regular schedule, which are scored by their
+* number of bar/space transitions, then the remaining ones, starting with those next to the highest scoring coarse
+* rows. No row is dropped, so a full scan finds the same symbols. But if the symbol covers only a small part of the
+* image, the scan of a single symbol (see maxSymbols in ScanRows) stops a lot earlier.
+*/
+static void PrioritizeRows(const BinaryBitmap& image, bool rotate, int middle, int rowStep, std::vector<int>& rows)
+{
+	constexpr int COARSE = 8;
+	// the rows are middle + k * rowStep with |k| <= maxK, k is shifted by a multiple of COARSE to be non-negative
+	const int maxK = Reduce(rows, 0, [&](int m, int row) { return std::max(m, std::abs(row - middle)); }) / rowStep;
+	const int shift = (maxK + COARSE - 1) / COARSE * COARSE;
+	auto slot = [&](int k) { return (k + shift + COARSE - 1) / COARSE; }; // index of the (upper) coarse neighbor
+	std::vector<int> coarseScore(2 * shift / COARSE + 2, 0);
+
+	PatternRow bars;
+	std::vector<int> coarse, fine;
+	for (int row : rows) {
+		int k = (row - middle) / rowStep;
+		if (k % COARSE == 0) {
+			coarse.push_back(row);
+			if (image.getPatternRow(row, rotate ? 90 : 0, bars))
+				coarseScore[slot(k)] = Size(bars);
+		} else {
+			fine.push_back(row);
+		}
+	}
+
+	auto score = [&](int row) {
+		int s = slot((row - middle) / rowStep);
+		return std::max(coarseScore[s - 1], coarseScore[s]);
+	};
+	std::stable_sort(fine.begin(), fine.end(), [&](int a, int b) { return score(a) > score(b); });
+
+	rows = std::move(coarse);
+	rows.insert(rows.end(), fine.begin(), fine.end());
+}
+
+/**
+* We're going to examine rows from the middle outward, searching alternately above and below the
+* middle, and farther out each time. rowStep is the number of rows between each successive
+* attempt above and below the middle. So we'd scan row middle, then middle - rowStep, then
+* middle + rowStep, then middle - (2 * rowStep), etc.
+* rowStep is bigger as the image is taller, but is always at least 1. We've somewhat arbitrarily
+* decided that moving up and down by about 1/16 of the image is pretty good; we try more of the
+* image if "trying harder".
+*
+* With tryHarder and an executor (see BinaryBitmap::executor()), the rows are sorted and split into bands that are
+* scanned concurrently, each with its own PatternRow and DecodingState. The results of the bands are merged the same
+* way rows are merged in a single band.
+*
+* With preClassify (see DecodeHints::preClassify()), the rows that do not cross a single Linear or Stacked tile of
+* BinaryBitmap::tileClasses() are dropped from the schedule.
+*/
+static Results DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image,
+						bool tryHarder, bool rotate, bool isPure, int maxSymbols, int minLineCount, bool returnErrors,
+						bool preClassify, Deadline deadline)
+{
+	Results res;
+
+	int width = image.width();
+	int height = image.height();
+
+	if (rotate)
+		std::swap(width, height);
+
+	int middle = height / 2;
+	// TODO: find a better heuristic/parameterization if maxSymbols != 1
+	int rowStep = std::max(1, height / ((tryHarder && !isPure) ? (maxSymbols == 1 ? 256 : 512) : 32));
+	// even the rows of stacked symbols are several modules high, 2 modules apart still cross each of them at least twice
+	if (!isPure)
+		rowStep = std::max(rowStep, static_cast<int>(2 * image.minModuleSize()));
+	int maxLines = tryHarder ?
+		height :	// Look at the whole image, not just the center
+		15;			// 15 rows spaced 1/32 apart is roughly the middle half of the image
+
+	if (isPure)
+		minLineCount = 1;
+
+	std::vector<int> rows;
+	for (int i = 0; i < maxLines; i++) {
+		// Scanning from the middle out. Determine which row we're looking at next:
+		int rowStepsAboveOrBelow = (i + 1) / 2;
+		bool isAbove = (i & 0x01) == 0; // i.e. is x even?
+		int rowNumber = middle + rowStep * (isAbove ? rowStepsAboveOrBelow : -rowStepsAboveOrBelow);
+		if (rowNumber < 0 || rowNumber >= height) {
+			// Oops, if we run off the top or bottom, stop
+			break;
+		}
+		rows.push_back(rowNumber);
+	}
+
+	if (preClassify && !isPure && image.getBitMatrix()) {
+		const auto& tiles = image.tileClasses();
+		auto hasBars = [&](int row) {
+			int t = row / BinaryBitmap::TileSize;
+			for (int i = 0, n = rotate ? tiles.height() : tiles.width(); i < n; ++i) {
+				auto c = rotate ? tiles(t, i) : tiles(i, t);
+				if (c == TileClass::Linear || c == TileClass::Stacked)
+					return true;
+			}
+			return false;
+		};
+		rows.erase(std::remove_if(rows.begin(), rows.end(), [&](int row) { return !hasBars(row); }), rows.end());
+	}
+
+#ifdef PRINT_DEBUG
+	BitMatrix dbg(width, height);
+	const ScanParams params = {width, height, tryHarder, rotate, isPure, returnErrors, maxSymbols, minLineCount, rowStep, deadline, &dbg};
+#else
+	const ScanParams params = {width, height, tryHarder, rotate, isPure, returnErrors, maxSymbols, minLineCount, rowStep, deadline};
+#endif
+
+	// the minimum number of rows per band, fewer than that are not worth the overhead of a parallel task
+	constexpr int MIN_BAND_ROWS = 16;
+	auto executor = image.executor();
+	int bands = executor && tryHarder && !isPure ? std::min(executor->concurrency(), Size(rows) / MIN_BAND_ROWS) : 1;
+
+	if (bands < 2) {
+		if (tryHarder && !isPure)
+			PrioritizeRows(image, rotate, middle, rowStep, rows);
+		ScanRows(readers, image, rows, params, res);
+	} else {
+		// scanning top to bottom in each band keeps the rows of a stacked DataBar symbol together
+		std::sort(rows.begin(), rows.end());
+		std::vector<Results> bandResults(bands);
+		executor->parallelFor(bands, [&, stats = CurrentStats()](int b) {
+			StatsContext context(stats);
+			std::vector<int> bandRows(rows.begin() + Size(rows) * b / bands, rows.begin() + Size(rows) * (b + 1) / bands);
+			ScanRows(readers, image, bandRows, params, bandResults[b]);
+		});
+		ResultIndex index;
+		for (auto& bandRes : bandResults)
+			for (auto& result : bandRes) {
+				int other = index.findIf(res, result, [&](const Result& o) { return IsContinuation(o, result, rotate, 2 * rowStep); });
+				if (other != -1) {
+					MergeInto(res[other], result, rotate, result.lineCount());
+				} else {
+					index.add(result);
+					res.push_back(std::move(result));
+				}
+			}
+	}
 
-out:
 	// remove all symbols with insufficient line count
 	auto it = std::remove_if(res.begin(), res.end(), [&](auto&& r) { return r.lineCount() < minLineCount; });
 	res.erase(it, res.end());
 
-	// if symbols overlap, remove the one with a lower line count
-	for (auto a = res.begin(); a != res.end(); ++a)
-		for (auto b = std::next(a); b != res.end(); ++b)
-			if (HaveIntersectingBoundingBoxes(a->position(), b->position()))
-				*(a->lineCount() < b->lineCount() ? a : b) = Result();
+	// if symbols overlap, remove the one with a lower line count (an already removed one does not overlap anything)
+	for (auto [a, b] : IntersectingBoundingBoxes(res))
+		if (res[a].format() != BarcodeFormat::None && res[b].format() != BarcodeFormat::None)
+			res[res[a].lineCount() < res[b].lineCount() ? a : b] = Result();
 
 	//TODO: C++20 res.erase_if()
 	it = std::remove_if(res.begin(), res.end(), [](auto&& r) { return r.format() == BarcodeFormat::None; });
 	res.erase(it, res.end());
 
+	// the bands stop independently of each other once they found maxSymbols
+	if (maxSymbols > 0 && Size(res) > maxSymbols)
+		res.resize(maxSymbols);
+
 #ifdef PRINT_DEBUG
 	SaveAsPBM(dbg, rotate ? "od-log-r.pnm" : "od-log.pnm");
 #endif
@@ -254,23 +456,26 @@ out:
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
-	auto result =
-		DoDecode(_readers, image, _hints.tryHarder(), false, _hints.isPure(), 1, _hints.minLineCount(), _hints.returnErrors());
+	ZX_TRACE_SCOPE("OneD::Reader::decode");
+	auto result = DoDecode(_readers, image, _hints.tryHarder(), false, _hints.isPure(), 1, _hints.minLineCount(),
+						   _hints.returnErrors(), _hints.preClassify(), _hints.deadline());
 
 	if (result.empty() && _hints.tryRotate())
-		result = DoDecode(_readers, image, _hints.tryHarder(), true, _hints.isPure(), 1, _hints.minLineCount(), _hints.returnErrors());
+		result = DoDecode(_readers, image, _hints.tryHarder(), true, _hints.isPure(), 1, _hints.minLineCount(),
+						  _hints.returnErrors(), _hints.preClassify(), _hints.deadline());
 
 	return FirstOrDefault(std::move(result));
 }
 
 Results Reader::decode(const BinaryBitmap& image, int maxSymbols) const
 {
+	ZX_TRACE_SCOPE("OneD::Reader::decode");
 	auto resH = DoDecode(_readers, image, _hints.tryHarder(), false, _hints.isPure(), maxSymbols, _hints.minLineCount(),
-						 _hints.returnErrors());
+						 _hints.returnErrors(), _hints.preClassify(), _hints.deadline());
 	if ((!maxSymbols || Size(resH) < maxSymbols) && _hints.tryRotate()) {
 		auto resV = DoDecode(_readers, image, _hints.tryHarder(), true, _hints.isPure(), maxSymbols - Size(resH),
-							 _hints.minLineCount(), _hints.returnErrors());
-		resH.insert(resH.end(), resV.begin(), resV.end());
+							 _hints.minLineCount(), _hints.returnErrors(), _hints.preClassify(), _hints.deadline());
+		resH.insert(resH.end(), std::move_iterator(resV.begin()), std::move_iterator(resV.end()));
 	}
 	return resH;
 }
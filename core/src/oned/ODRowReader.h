@@ -13,6 +13,7 @@
 #include "ZXAlgorithms.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
@@ -50,11 +51,25 @@ namespace OneD {
 */
 class RowReader
 {
+public:
+	/**
+	 * A cheap necessary condition for the start guard of a symbology: it can only begin with a bar of width b that
+	 * has a space of width s in front of it if 2 * s >= barScale * b + offset. It is derived from the quiet zone and
+	 * the width of the first bar of the guard pattern (with 1 pixel slack) and lets the OneD::Reader skip positions
+	 * with a cheap integer test before handing the row to decodePattern, where the guard can not possibly match.
+	 */
+	struct StartGuardSignature
+	{
+		int barScale = 0, offset = 0; // the default matches everywhere
+	};
+
 protected:
 	const DecodeHints& _hints;
+	const StartGuardSignature _startGuard;
 
 public:
-	explicit RowReader(const DecodeHints& hints) : _hints(hints) {}
+	explicit RowReader(const DecodeHints& hints) : _hints(hints), _startGuard() {}
+	RowReader(const DecodeHints& hints, StartGuardSignature startGuard) : _hints(hints), _startGuard(startGuard) {}
 	explicit RowReader(DecodeHints&& hints) = delete;
 
 	struct DecodingState
@@ -66,6 +81,8 @@ public:
 
 	virtual Result decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>& state) const = 0;
 
+	StartGuardSignature startGuardSignature() const { return _startGuard; }
+
 	/**
 	 * Determines how closely a set of observed counts of runs of black/white values matches a given
 	 * target pattern. This is reported as the ratio of the total variance from the expected pattern
@@ -142,15 +159,19 @@ public:
 	 * This is useful for codes like Codabar, Code39 and ITF which distinguish between narrow and wide
 	 * bars/spaces. Where wide ones are between 2 and 3 times as wide as the narrow ones.
 	 *
-	 * @param view containing one character
+	 * @param view containing one character of LEN bars/spaces
 	 * @return threshold value for bars and spaces
 	 */
+	template <int LEN>
 	static BarAndSpaceI NarrowWideThreshold(const PatternView& view)
 	{
-		BarAndSpaceI m = {view[0], view[1]};
+		static_assert(LEN > 2);
+		assert(view.size() == LEN);
+		const auto* v = view.data();
+		BarAndSpaceI m = {v[0], v[1]};
 		BarAndSpaceI M = m;
-		for (int i = 2; i < view.size(); ++i)
-			UpdateMinMax(m[i], M[i], view[i]);
+		for (int i = 2; i < LEN; ++i)
+			UpdateMinMax(m[i], M[i], v[i]);
 
 		BarAndSpaceI res;
 		for (int i = 0; i < 2; ++i) {
@@ -167,25 +188,49 @@ public:
 	}
 
 	/**
-	 * @brief ToNarrowWidePattern takes a PatternView, calculates a NarrowWideThreshold and returns int where a '0' bit
-	 * means narrow and a '1' bit means 'wide'.
+	 * @brief NarrowWideBitPattern takes a PatternView of LEN bars/spaces, calculates a NarrowWideThreshold and returns
+	 * an int where a '0' bit means narrow and a '1' bit means 'wide' (first element in the most significant bit), -1 if
+	 * the view can't be classified.
 	 */
+	template <int LEN>
 	static int NarrowWideBitPattern(const PatternView& view)
 	{
-		const auto threshold = NarrowWideThreshold(view);
+		const auto threshold = NarrowWideThreshold<LEN>(view);
 		if (!threshold.isValid())
 			return -1;
 
+		const auto* v = view.data();
 		int pattern = 0;
-		for (int i = 0; i < view.size(); ++i) {
-			if (view[i] > threshold[i] * 2)
+		for (int i = 0; i < LEN; ++i) {
+			if (v[i] > threshold[i] * 2)
 				return -1;
-			AppendBit(pattern, view[i] > threshold[i]);
+			AppendBit(pattern, v[i] > threshold[i]);
 		}
 
 		return pattern;
 	}
 
+	/**
+	 * @brief NarrowWideTable maps every LEN bit pattern of NarrowWideBitPattern<LEN>() directly to its character: the
+	 * one in alphabet at the index of the pattern in encodings, 0 if it is none of them.
+	 */
+	template <int LEN, std::size_t N>
+	static constexpr std::array<char, 1 << LEN> NarrowWideTable(const int (&encodings)[N], const char (&alphabet)[N + 1])
+	{
+		std::array<char, 1 << LEN> res = {};
+		for (std::size_t i = 0; i < N; ++i)
+			res[encodings[i]] = alphabet[i];
+		return res;
+	}
+
+	/// Classify the LEN bars/spaces of view and look up the character in a NarrowWideTable, 0 if there is none
+	template <int LEN>
+	static char DecodeNarrowWidePattern(const PatternView& view, const std::array<char, 1 << LEN>& table)
+	{
+		int pattern = NarrowWideBitPattern<LEN>(view);
+		return pattern < 0 ? 0 : table[pattern];
+	}
+
 	/**
 	 * @brief each bar/space is 1-4 modules wide, we have N bars/spaces, they are SUM modules wide in total
 	 */
@@ -206,12 +251,6 @@ public:
 		int i = IndexOf(table, pattern);
 		return i == -1 ? 0 : alphabet[i];
 	}
-
-	template<typename INDEX, typename ALPHABET>
-	static char DecodeNarrowWidePattern(const PatternView& view, const INDEX& table, const ALPHABET& alphabet)
-	{
-		return LookupBitPattern(NarrowWideBitPattern(view), table, alphabet);
-	}
 };
 
 template<typename Range>
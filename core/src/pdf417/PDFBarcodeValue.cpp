@@ -17,22 +17,40 @@ namespace Pdf417 {
 void
 BarcodeValue::setValue(int value)
 {
-	_values[value] += 1;
+	int i = static_cast<int>(std::lower_bound(_values.begin(), _values.begin() + _size, value) - _values.begin());
+	if (i < _size && _values[i] == value) {
+		_counts[i]++;
+		return;
+	}
+	if (_size == MAX_VALUES) {
+		// Only happens on very noisy input. Give up the least frequent value to make room for the new one.
+		int j = static_cast<int>(std::min_element(_counts.begin(), _counts.end()) - _counts.begin());
+		std::copy(_values.begin() + j + 1, _values.end(), _values.begin() + j);
+		std::copy(_counts.begin() + j + 1, _counts.end(), _counts.begin() + j);
+		_size--;
+		if (j < i)
+			i--;
+	}
+	std::copy_backward(_values.begin() + i, _values.begin() + _size, _values.begin() + _size + 1);
+	std::copy_backward(_counts.begin() + i, _counts.begin() + _size, _counts.begin() + _size + 1);
+	_values[i] = value;
+	_counts[i] = 1;
+	_size++;
 }
 
 /**
 * Determines the maximum occurrence of a set value and returns all values which were set with this occurrence.
-* @return an array of int, containing the values with the highest occurrence, or null, if no value was set
+* @return the values with the highest occurrence, or an empty list, if no value was set
 */
-std::vector<int>
+BarcodeValue::Values
 BarcodeValue::value() const
 {
-	std::vector<int> result;
-	if (!_values.empty()) {
-		int maxConfidence = std::max_element(_values.begin(), _values.end(), [](auto& l, auto& r) { return l.second < r.second; })->second;
-		for (auto [value, count] : _values)
-			if (count == maxConfidence)
-				result.push_back(value);
+	Values result;
+	if (_size > 0) {
+		int maxConfidence = *std::max_element(_counts.begin(), _counts.begin() + _size);
+		for (int i = 0; i < _size; ++i)
+			if (_counts[i] == maxConfidence)
+				result.push_back(_values[i]);
 	}
 	return result;
 }
@@ -40,8 +58,8 @@ BarcodeValue::value() const
 int
 BarcodeValue::confidence(int value) const
 {
-	auto it = _values.find(value);
-	return it != _values.end() ? it->second : 0;
+	auto it = std::find(_values.begin(), _values.begin() + _size, value);
+	return it != _values.begin() + _size ? _counts[it - _values.begin()] : 0;
 }
 
 } // Pdf417
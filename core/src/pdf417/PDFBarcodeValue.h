@@ -6,20 +6,39 @@
 
 #pragma once
 
-#include <map>
-#include <vector>
+#include <array>
 
 namespace ZXing {
 namespace Pdf417 {
 
 /**
+* Collects the votes for the value of a single codeword (or metadata field). The votes are kept in a
+* small fixed number of slots, so neither voting nor a vote matrix of these needs any heap allocation.
+*
 * @author Guenther Grau
 */
 class BarcodeValue
 {
-	std::map<int, int> _values;
-
 public:
+	static constexpr int MAX_VALUES = 8;
+
+	/**
+	* Fixed capacity list of values, sorted in ascending order.
+	*/
+	class Values
+	{
+		std::array<int, MAX_VALUES> _data;
+		int _size = 0;
+
+	public:
+		void push_back(int value) { _data[_size++] = value; }
+		bool empty() const { return _size == 0; }
+		int size() const { return _size; }
+		int operator[](int i) const { return _data[i]; }
+		const int* begin() const { return _data.data(); }
+		const int* end() const { return _data.data() + _size; }
+	};
+
 	/**
 	* Add an occurrence of a value
 	*/
@@ -27,11 +46,17 @@ public:
 
 	/**
 	* Determines the maximum occurrence of a set value and returns all values which were set with this occurrence.
-	* @return an array of int, containing the values with the highest occurrence, or null, if no value was set
+	* @return the values with the highest occurrence, or an empty list, if no value was set
 	*/
-	std::vector<int> value() const;
+	Values value() const;
 
 	int confidence(int value) const;
+
+private:
+	// distinct values sorted in ascending order, and the number of votes each of them got
+	std::array<int, MAX_VALUES> _values;
+	std::array<int, MAX_VALUES> _counts;
+	int _size = 0;
 };
 
 } // Pdf417
@@ -407,32 +407,34 @@ static constexpr const std::array<uint16_t, 2787> CODEWORD_TABLE = {
 };
 
 
-using RatioTableType = std::array<std::array<float, CodewordDecoder::BARS_IN_MODULE>, SYMBOL_COUNT>;
-using ModuleBitCountType = std::array<int, CodewordDecoder::BARS_IN_MODULE>;
+/**
+* Direct index of SYMBOL_TABLE: every symbol starts with a bar and ends with a space, i.e. its bits 16 and 0 are fixed,
+* so the 15 bits in between address its position in SYMBOL_TABLE + 1 (0 for an invalid symbol).
+*/
+using SymbolIndexType = std::array<uint16_t, 1 << 15>;
 
-static const RatioTableType& GetRatioTable()
+static const SymbolIndexType& GetSymbolIndex()
 {
-	static constexpr RatioTableType table = []() constexpr {
-		RatioTableType table{};
-		for (int i = 0; i < SYMBOL_COUNT; i++) {
-			int currentSymbol = SYMBOL_TABLE[i];
-			int currentBit = currentSymbol & 0x1;
-			for (int j = 0; j < CodewordDecoder::BARS_IN_MODULE; j++) {
-				float size = 0.0f;
-				while ((currentSymbol & 0x1) == currentBit) {
-					size += 1.0f;
-					currentSymbol >>= 1;
-				}
-				currentBit = currentSymbol & 0x1;
-				table[i][CodewordDecoder::BARS_IN_MODULE - j - 1] = size / CodewordDecoder::MODULES_IN_CODEWORD;
-			}
-		}
-		return table;
+	static constexpr SymbolIndexType index = []() constexpr {
+		SymbolIndexType index{};
+		for (int i = 0; i < SYMBOL_COUNT; i++)
+			index[(SYMBOL_TABLE[i] >> 1) & 0x7FFF] = static_cast<uint16_t>(i + 1);
+		return index;
 	}();
 
-	return table;
+	return index;
+}
+
+// The position of symbol in SYMBOL_TABLE or -1
+static int SymbolTableIndex(int symbol)
+{
+	if ((symbol & 0x30001) != 0x10000)
+		return -1;
+	return GetSymbolIndex()[(symbol >> 1) & 0x7FFF] - 1;
 }
 
+using ModuleBitCountType = std::array<int, CodewordDecoder::BARS_IN_MODULE>;
+
 static ModuleBitCountType SampleBitCounts(const ModuleBitCountType& moduleBitCount)
 {
 	float bitCountSum = static_cast<float>(Reduce(moduleBitCount));
@@ -470,10 +472,80 @@ static int GetDecodedCodewordValue(const ModuleBitCountType& moduleBitCount)
 	return CodewordDecoder::GetCodeword(decodedValue) == -1 ? -1 : decodedValue;
 }
 
-static int GetClosestDecodedValue(const ModuleBitCountType& moduleBitCount)
+/**
+* Depth-first search over the bar/space widths (in modules) of all symbols for the one whose ratios have the smallest
+* squared distance to the measured ones. The widths of each element are tried from the measured one outwards and a
+* branch is abandoned as soon as its partial error exceeds the best one found so far, so only a small part of the 2787
+* symbols is ever looked at. The errors are summed up in the same order as by a linear search over the ratios of all
+* symbols and of equally distant symbols the smallest wins, i.e. the result is the same.
+*/
+class ClosestSymbolSearch
 {
-	static const RatioTableType& ratioTable = GetRatioTable();
+	const std::array<float, CodewordDecoder::BARS_IN_MODULE>& _ratios;
+	std::array<float, CodewordDecoder::BARS_IN_MODULE + 1> _remainingRatios = {}; // the sums of the ratios from k on
+	float _bestError = std::numeric_limits<float>::max();
+	int _bestSymbol = -1;
+
+	void search(int k, int remainingModules, int symbol, float error)
+	{
+		constexpr int N = CodewordDecoder::BARS_IN_MODULE;
+		if (k == N) {
+			if (SymbolTableIndex(symbol) != -1 && (error < _bestError || (error == _bestError && symbol < _bestSymbol))) {
+				_bestError = error;
+				_bestSymbol = symbol;
+			}
+			return;
+		}
 
+		// returns false if the error of width w (and all widths further away from the target) is too large already
+		auto tryWidth = [&](int w) {
+			float diff = static_cast<float>(w) / CodewordDecoder::MODULES_IN_CODEWORD - _ratios[k];
+			if (error + diff * diff > _bestError)
+				return false;
+			// the squared errors of the remaining elements add up to at least the square of their sum divided by their
+			// number, the slack makes sure that rounding does not drop an equally good symbol
+			float rest = static_cast<float>(remainingModules - w) / CodewordDecoder::MODULES_IN_CODEWORD - _remainingRatios[k + 1];
+			if (error + diff * diff + 0.999f * rest * rest / std::max(1, N - 1 - k) > _bestError)
+				return true;
+			search(k + 1, remainingModules - w, (symbol << w) | (k % 2 == 0 ? (1 << w) - 1 : 0), error + diff * diff);
+			return true;
+		};
+
+		// each element is 1 to 6 modules wide, the ones below and above the target are tried from the inside out
+		const int minWidth = std::max(1, remainingModules - 6 * (N - 1 - k));
+		const int maxWidth = std::min(6, remainingModules - (N - 1 - k));
+		const float target = _ratios[k] * CodewordDecoder::MODULES_IN_CODEWORD;
+		const int below = std::min(maxWidth, static_cast<int>(target));
+		auto searchBelow = [&] {
+			for (int w = below; w >= minWidth && tryWidth(w); --w)
+				;
+		};
+		auto searchAbove = [&] {
+			for (int w = std::max(minWidth, below + 1); w <= maxWidth && tryWidth(w); ++w)
+				;
+		};
+		if (target - below <= 0.5f) {
+			searchBelow();
+			searchAbove();
+		} else {
+			searchAbove();
+			searchBelow();
+		}
+	}
+
+public:
+	explicit ClosestSymbolSearch(const std::array<float, CodewordDecoder::BARS_IN_MODULE>& ratios) : _ratios(ratios)
+	{
+		for (int k = CodewordDecoder::BARS_IN_MODULE - 1; k >= 0; --k)
+			_remainingRatios[k] = _remainingRatios[k + 1] + ratios[k];
+		search(0, CodewordDecoder::MODULES_IN_CODEWORD, 0, 0.0f);
+	}
+
+	int bestSymbol() const { return _bestSymbol; }
+};
+
+static int GetClosestDecodedValue(const ModuleBitCountType& moduleBitCount)
+{
 	int bitCountSum = Reduce(moduleBitCount);
 	std::array<float, CodewordDecoder::BARS_IN_MODULE> bitCountRatios = {};
 	if (bitCountSum > 1) {
@@ -481,24 +553,7 @@ static int GetClosestDecodedValue(const ModuleBitCountType& moduleBitCount)
 			bitCountRatios[i] = moduleBitCount[i] / (float)bitCountSum;
 		}
 	}
-	float bestMatchError = std::numeric_limits<float>::max();
-	int bestMatch = -1;
-	for (size_t j = 0; j < ratioTable.size(); j++) {
-		float error = 0.0f;
-		auto& ratioTableRow = ratioTable[j];
-		for (int k = 0; k < CodewordDecoder::BARS_IN_MODULE; k++) {
-			float diff = ratioTableRow[k] - bitCountRatios[k];
-			error += diff * diff;
-			if (error >= bestMatchError) {
-				break;
-			}
-		}
-		if (error < bestMatchError) {
-			bestMatchError = error;
-			bestMatch = SYMBOL_TABLE[j];
-		}
-	}
-	return bestMatch;
+	return ClosestSymbolSearch(bitCountRatios).bestSymbol();
 }
 
 int
@@ -518,12 +573,8 @@ CodewordDecoder::GetDecodedValue(const std::array<int, BARS_IN_MODULE>& moduleBi
 int
 CodewordDecoder::GetCodeword(int symbol)
 {
-	symbol &= 0x3FFFF;
-	auto it = std::lower_bound(SYMBOL_TABLE.begin(), SYMBOL_TABLE.end(), symbol);
-	if (it != SYMBOL_TABLE.end() && *it == symbol) {
-		return (CODEWORD_TABLE[it - SYMBOL_TABLE.begin()] - 1) % NUMBER_OF_CODEWORDS;
-	}
-	return -1;
+	int index = SymbolTableIndex(symbol & 0x3FFFF);
+	return index == -1 ? -1 : (CODEWORD_TABLE[index] - 1) % NUMBER_OF_CODEWORDS;
 }
 
 } // Pdf417
@@ -10,11 +10,11 @@
 #include "DecoderResult.h"
 #include "PDFDecoderResultExtra.h"
 #include "ZXAlgorithms.h"
-#include "ZXBigInteger.h"
 #include "ZXTestSupport.h"
 
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <sstream>
 #include <utility>
 
@@ -255,7 +255,8 @@ static int ProcessTextECI(std::vector<int>& textCompactionData, int& index, cons
 static int TextCompaction(const std::vector<int>& codewords, int codeIndex, Content& result)
 {
 	// 2 characters per codeword
-	std::vector<int> textCompactionData((codewords[0] - codeIndex) * 2, 0);
+	thread_local std::vector<int> textCompactionData;
+	textCompactionData.assign((codewords[0] - codeIndex) * 2, 0);
 
 	int index = 0;
 	bool end = false;
@@ -450,22 +451,29 @@ Remove leading 1 =>  Result is 000213298174000
 */
 static std::string DecodeBase900toBase10(const std::vector<int>& codewords, int endIndex, int count)
 {
-	// Table containing values for the exponent of 900.
-	static const auto EXP900 = []() {
-		std::array<BigInteger, 16> table = {1, 900};
-		for (size_t i = 2; i < table.size(); ++i)
-			table[i] = table[i - 1] * 900;
-		return table;
-	}();
-
 	assert(count <= 16);
 
-	BigInteger result;
-	for (int i = 0; i < count; i++)
-		result += EXP900[count - i - 1] * codewords[endIndex - count + i];
+	// 900^16 < 10^48, so 6 limbs of 9 decimal digits each (least significant first) hold any result
+	constexpr uint32_t BASE = 1000000000;
+	std::array<uint32_t, 6> limbs = {};
+	int used = 1;
+	for (int i = endIndex - count; i < endIndex; i++) {
+		uint64_t carry = codewords[i];
+		for (int j = 0; j < used; j++) {
+			uint64_t v = uint64_t(limbs[j]) * 900 + carry;
+			limbs[j] = uint32_t(v % BASE);
+			carry = v / BASE;
+		}
+		if (carry)
+			limbs[used++] = uint32_t(carry);
+	}
 
-	std::string resultString = result.toString();
-	if (!resultString.empty() && resultString.front() == '1')
+	std::string resultString = std::to_string(limbs[used - 1]);
+	for (int j = used - 2; j >= 0; j--) {
+		auto digits = std::to_string(limbs[j]);
+		resultString.append(9 - digits.size(), '0').append(digits);
+	}
+	if (resultString.front() == '1')
 		return resultString.substr(1);
 
 	throw FormatError();
@@ -652,6 +660,8 @@ DecoderResult Decode(const std::vector<int>& codewords)
 {
 	Content result;
 	result.symbology = {'L', '2', char(-1)};
+	// numeric compaction is the densest mode with 44 digits per 15 code words
+	result.reserve(3 * codewords[0]);
 
 	bool readerInit = false;
 	auto resultMetadata = std::make_shared<DecoderResultExtra>();
@@ -9,12 +9,12 @@
 #include "BitMatrix.h"
 #include "ZXNullable.h"
 #include "Pattern.h"
+#include "ZXAlgorithms.h"
 
 #include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <limits>
-#include <list>
 #include <vector>
 
 namespace ZXing {
@@ -27,9 +27,9 @@ static const float MAX_INDIVIDUAL_VARIANCE = 0.8f;
 
 // B S B S B S B S Bar/Space pattern
 // 11111111 0 1 0 1 0 1 000
-static const std::vector<int> START_PATTERN = { 8, 1, 1, 1, 1, 1, 1, 3 };
+static constexpr FixedPattern<8, 17> START_PATTERN = { 8, 1, 1, 1, 1, 1, 1, 3 };
 // 1111111 0 1 000 1 0 1 00 1
-static const std::vector<int> STOP_PATTERN = { 7, 1, 1, 3, 1, 1, 1, 2, 1 };
+static constexpr FixedPattern<9, 18> STOP_PATTERN = { 7, 1, 1, 3, 1, 1, 1, 2, 1 };
 static const int MAX_PIXEL_DRIFT = 3;
 static const int MAX_PATTERN_DRIFT = 5;
 // if we set the value too low, then we don't detect the correct height of the bar if the start patterns are damaged.
@@ -51,28 +51,23 @@ static const int BARCODE_MIN_HEIGHT = 10;
 * @param maxIndividualVariance The most any counter can differ before we give up
 * @return ratio of total variance between counters and pattern compared to total pattern size
 */
+template <int LEN, int SUM>
 static float
-PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& pattern, float maxIndividualVariance)
+PatternMatchVariance(const PatternView& counters, const FixedPattern<LEN, SUM>& pattern, float maxIndividualVariance)
 {
 	int total = 0;
-	int patternLength = 0;
-	for (size_t i = 0; i < counters.size(); i++) {
-		total += counters[i];
-		patternLength += pattern[i];
-	}
-	if (total < patternLength) {
+	for (int x = 0; x < LEN; x++)
+		total += counters[x];
+	if (total < SUM) {
 		// If we don't even have one pixel per unit of bar width, assume this
 		// is too small to reliably match, so fail:
 		return std::numeric_limits<float>::max();
 	}
-	// We're going to fake floating-point math in integers. We just need to use more bits.
-	// Scale up patternLength so that intermediate values below like scaledCounter will have
-	// more "significant digits".
-	float unitBarWidth = (float)total / patternLength;
+	float unitBarWidth = (float)total / SUM;
 	maxIndividualVariance *= unitBarWidth;
 
 	float totalVariance = 0.0f;
-	for (size_t x = 0; x < counters.size(); x++) {
+	for (int x = 0; x < LEN; x++) {
 		int counter = counters[x];
 		float scaledPattern = pattern[x] * unitBarWidth;
 		float variance = counter > scaledPattern ? counter - scaledPattern : scaledPattern - counter;
@@ -86,76 +81,77 @@ PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& p
 
 
 /**
-* @param matrix row of black/white values to search
+* @param row run-length encoded row to search (see GetPatternRow)
 * @param column x position to start search
-* @param row y position to start search
-* @param width the number of pixels to search on this row
+* @param width the number of pixels in the row
 * @param pattern pattern of counts of number of black and white pixels that are
 *                 being searched for as a pattern
-* @param counters array of counters, as long as pattern, to re-use
-* @return start/end horizontal offset of guard pattern, as an array of two ints.
+* @param startPos x position of the first pixel of the found pattern
+* @param endPos x position of the first pixel after the found pattern (or the last pixel of the row)
+* @return true if the pattern was found
 */
+template <int LEN, int SUM>
 static bool
-FindGuardPattern(const BitMatrix& matrix, int column, int row, int width, bool whiteFirst, const std::vector<int>& pattern, std::vector<int>& counters, int& startPos, int& endPos)
+FindGuardPattern(const PatternRow& row, int column, int width, const FixedPattern<LEN, SUM>& pattern, int& startPos, int& endPos)
 {
-	std::fill(counters.begin(), counters.end(), 0);
-	int patternLength = Size(pattern);
-	bool isWhite = whiteFirst;
-	int patternStart = column;
-	int pixelDrift = 0;
+	// find the run containing column, the first element of the row is the white space in front of the first bar
+	int i = 0;
+	int x = 0;
+	while (i < Size(row) && x + row[i] <= column)
+		x += row[i++];
+	if (i == Size(row))
+		return false;
 
-	// if there are black pixels left of the current pixel shift to the left, but only for MAX_PIXEL_DRIFT pixels 
-	while (matrix.get(patternStart, row) && patternStart > 0 && pixelDrift++ < MAX_PIXEL_DRIFT) {
-		patternStart--;
+	// if we start inside a bar, include its pixels left of column, but only for MAX_PIXEL_DRIFT pixels.
+	// if we start inside a space, the first candidate starts with the next bar.
+	int patternStart = x;
+	int cut = 0;
+	if (i % 2) {
+		patternStart = std::max(x, column - MAX_PIXEL_DRIFT);
+		cut = patternStart - x;
+	} else {
+		patternStart += row[i++];
 	}
-	int x = patternStart;
-	int counterPosition = 0;
-	for (; x < width; x++) {
-		bool pixel = matrix.get(x, row);
-		if (pixel != isWhite) {
-			counters[counterPosition]++;
-		}
-		else {
-			if (counterPosition == patternLength - 1) {
-				if (PatternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
-					startPos = patternStart;
-					endPos = x;
-					return true;
-				}
-				patternStart += counters[0] + counters[1];
-				std::copy(counters.begin() + 2, counters.end(), counters.begin());
-				counters[patternLength - 2] = 0;
-				counters[patternLength - 1] = 0;
-				counterPosition--;
-			}
-			else {
-				counterPosition++;
-			}
-			counters[counterPosition] = 1;
-			isWhite = !isWhite;
-		}
-	}
-	if (counterPosition == patternLength - 1) {
+
+	Pattern<LEN> counters;
+	for (const int first = i; i + LEN <= Size(row); i += 2, patternStart += counters[0] + counters[1]) {
+		std::copy_n(row.data() + i, LEN, counters.begin());
+		if (i == first)
+			counters[0] -= cut;
 		if (PatternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
 			startPos = patternStart;
-			endPos = x - 1;
+			endPos = patternStart + Reduce(counters, 0);
+			// a pattern ending at the border of the image ends on its last pixel
+			if (endPos == width)
+				endPos--;
 			return true;
 		}
 	}
 	return false;
 }
 
+template <int LEN, int SUM>
 static std::array<Nullable<ResultPoint>, 4>&
-FindRowsWithPattern(const BitMatrix& matrix, int height, int width, int startRow, int startColumn, const std::vector<int>& pattern, std::array<Nullable<ResultPoint>, 4>& result)
+FindRowsWithPattern(const RotatedBitMatrix& matrix, int height, int startRow, int startColumn, const FixedPattern<LEN, SUM>& pattern,
+					PatternRow& patternRow, std::array<Nullable<ResultPoint>, 4>& result)
 {
 	bool found = false;
 	int startPos, endPos;
 	int minStartRow = startRow;
-	std::vector<int> counters(pattern.size(), 0);
+	auto findGuardPattern = [&](int column, int row, int& startPos, int& endPos) {
+		// a pattern never starts more than MAX_PIXEL_DRIFT pixels left of column, skip everything in front of that
+		int offset = std::max(0, column - MAX_PIXEL_DRIFT);
+		matrix.getPatternRow(row, patternRow, offset);
+		if (!FindGuardPattern(patternRow, column - offset, matrix.width() - offset, pattern, startPos, endPos))
+			return false;
+		startPos += offset;
+		endPos += offset;
+		return true;
+	};
 	for (; startRow < height; startRow += ROW_STEP) {
-		if (FindGuardPattern(matrix, startColumn, startRow, width, false, pattern, counters, startPos, endPos)) {
+		if (findGuardPattern(startColumn, startRow, startPos, endPos)) {
 			while (startRow > minStartRow + 1) {
-				if (!FindGuardPattern(matrix, startColumn, --startRow, width, false, pattern, counters, startPos, endPos)) {
+				if (!findGuardPattern(startColumn, --startRow, startPos, endPos)) {
 					startRow++;
 					break;
 				}
@@ -174,7 +170,7 @@ FindRowsWithPattern(const BitMatrix& matrix, int height, int width, int startRow
 		int previousRowEnd = static_cast<int>(result[1].value().x());
 		for (; stopRow < height; stopRow++) {
 			int startPos, endPos;
-			found = FindGuardPattern(matrix, previousRowStart, stopRow, width, false, pattern, counters, startPos, endPos);
+			found = findGuardPattern(previousRowStart, stopRow, startPos, endPos);
 			// a found pattern is only considered to belong to the same barcode if the start and end positions
 			// don't differ too much. Pattern drift should be not bigger than two for consecutive rows. With
 			// a higher number of skipped rows drift could be larger. To keep it simple for now, we allow a slightly
@@ -224,43 +220,43 @@ CopyToResult(std::array<Nullable<ResultPoint>, 8>& result, const std::array<Null
 *           vertices[6] x, y top right codeword area
 *           vertices[7] x, y bottom right codeword area
 */
-static std::array<Nullable<ResultPoint>, 8> FindVertices(const BitMatrix& matrix, int startRow, int startColumn)
+static std::array<Nullable<ResultPoint>, 8> FindVertices(const RotatedBitMatrix& matrix, int startRow, int startColumn)
 {
-	int width = matrix.width();
 	int height = matrix.height();
 
+	PatternRow patternRow;
 	std::array<Nullable<ResultPoint>, 4> tmp;
 	std::array<Nullable<ResultPoint>, 8> result;
-	CopyToResult(result, FindRowsWithPattern(matrix, height, width, startRow, startColumn, START_PATTERN, tmp), INDEXES_START_PATTERN);
+	CopyToResult(result, FindRowsWithPattern(matrix, height, startRow, startColumn, START_PATTERN, patternRow, tmp), INDEXES_START_PATTERN);
 
 	if (result[4] != nullptr) {
 		startColumn = static_cast<int>(result[4].value().x());
 		startRow = static_cast<int>(result[4].value().y());
 #if 1 // 2x speed improvement for images with no PDF417 symbol by not looking for symbols without start guard (which are not conforming to spec anyway)
-		CopyToResult(result, FindRowsWithPattern(matrix, height, width, startRow, startColumn, STOP_PATTERN, tmp), INDEXES_STOP_PATTERN);
+		CopyToResult(result, FindRowsWithPattern(matrix, height, startRow, startColumn, STOP_PATTERN, patternRow, tmp), INDEXES_STOP_PATTERN);
 	}
 #else
 	}
-	CopyToResult(result, FindRowsWithPattern(matrix, height, width, startRow, startColumn, STOP_PATTERN, tmp), INDEXES_STOP_PATTERN);
+	CopyToResult(result, FindRowsWithPattern(matrix, height, startRow, startColumn, STOP_PATTERN, patternRow, tmp), INDEXES_STOP_PATTERN);
 #endif
 	return result;
 }
 
 /**
-* Detects PDF417 codes in an image. Only checks 0 degree rotation
+* Detects PDF417 codes in an image. Only checks the rotation of the given view
 * @param multiple if true, then the image is searched for multiple codes. If false, then at most one code will
 * be found and returned
 * @param bitMatrix bit matrix to detect barcodes in
 * @return List of ResultPoint arrays containing the coordinates of found barcodes
 */
-static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMatrix& bitMatrix, bool multiple)
+static std::vector<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const RotatedBitMatrix& bitMatrix, bool multiple, Deadline deadline)
 {
 	int row = 0;
 	int column = 0;
 	bool foundBarcodeInRow = false;
-	std::list<std::array<Nullable<ResultPoint>, 8>> barcodeCoordinates;
+	std::vector<std::array<Nullable<ResultPoint>, 8>> barcodeCoordinates;
 
-	while (row < bitMatrix.height()) {
+	while (row < bitMatrix.height() && !IsExpired(deadline)) {
 		auto vertices = FindVertices(bitMatrix, row, column);
 
 		if (vertices[0] == nullptr && vertices[3] == nullptr) {
@@ -304,7 +300,6 @@ static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMa
 
 bool HasStartPattern(const BitMatrix& m, bool rotate90)
 {
-	constexpr FixedPattern<8, 17> START_PATTERN = { 8, 1, 1, 1, 1, 1, 1, 3 };
 	constexpr int minSymbolWidth = 3*8+1; // compact symbol
 
 	PatternRow row;
@@ -324,45 +319,32 @@ bool HasStartPattern(const BitMatrix& m, bool rotate90)
 }
 
 /**
-* <p>Detects a PDF417 Code in an image. Only checks 0 and 180 degree rotations.</p>
+* <p>Detects a PDF417 Code in an image. Checks 0 and 180 degree rotations (plus 90 and 270 if tryRotate is set).
+* The image is scanned through a rotated view, no rotated copies are made.</p>
 *
 * @param image barcode image to decode
 * @param multiple if true, then the image is searched for multiple codes. If false, then at most one code will
 * be found and returned
 */
-Detector::Result Detector::Detect(const BinaryBitmap& image, bool multiple, bool tryRotate)
+Detector::Result Detector::Detect(const BinaryBitmap& image, bool multiple, bool tryRotate, Deadline deadline)
 {
-	// construct a 'dummy' shared pointer, just be able to pass it up the call chain in DetectorResult
-	// TODO: reimplement PDF Detector
-	auto binImg = std::shared_ptr<const BitMatrix>(image.getBitMatrix(), [](const BitMatrix*){});
+	auto binImg = image.getBitMatrix();
 	if (!binImg)
 		return {};
 
 	Result result;
 
 	for (int rotate90 = 0; rotate90 <= static_cast<int>(tryRotate); ++rotate90) {
-		if (!HasStartPattern(*binImg, rotate90))
+		if (IsExpired(deadline) || !HasStartPattern(*binImg, rotate90))
 			continue;
 
-		result.rotation = 90 * rotate90;
-		if (rotate90) {
-			auto newBits = std::make_shared<BitMatrix>(binImg->copy());
-			newBits->rotate90();
-			binImg = newBits;
+		for (int rotation : {90 * rotate90, 90 * rotate90 + 180}) {
+			result.bits = RotatedBitMatrix(*binImg, rotation);
+			result.rotation = rotation;
+			result.points = DetectBarcode(result.bits, multiple, deadline);
+			if (!result.points.empty())
+				return result;
 		}
-
-		result.points = DetectBarcode(*binImg, multiple);
-		result.bits = binImg;
-		if (result.points.empty()) {
-			auto newBits = std::make_shared<BitMatrix>(binImg->copy());
-			newBits->rotate180();
-			result.points = DetectBarcode(*newBits, multiple);
-			result.rotation += 180;
-			result.bits = newBits;
-		}
-
-		if (!result.points.empty())
-			return result;
 	}
 
 	return {};
@@ -6,16 +6,16 @@
 
 #pragma once
 
+#include "Deadline.h"
+#include "PDFRotatedBitMatrix.h"
 #include "ResultPoint.h"
 #include "ZXNullable.h"
 
-#include <list>
 #include <array>
-#include <memory>
+#include <vector>
 
 namespace ZXing {
 
-class BitMatrix;
 class BinaryBitmap;
 
 namespace Pdf417 {
@@ -33,12 +33,12 @@ class Detector
 public:
 	struct Result
 	{
-		std::shared_ptr<const BitMatrix> bits;
-		std::list<std::array<Nullable<ResultPoint>, 8>> points;
+		RotatedBitMatrix bits;
+		std::vector<std::array<Nullable<ResultPoint>, 8>> points;
 		int rotation = -1;
 	};
 
-	static Result Detect(const BinaryBitmap& image, bool multiple, bool tryRotate);
+	static Result Detect(const BinaryBitmap& image, bool multiple, bool tryRotate, Deadline deadline = Deadline::max());
 };
 
 } // Pdf417
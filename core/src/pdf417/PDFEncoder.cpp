@@ -498,16 +498,26 @@ static void DetermineDimensions(int minCols, int maxCols, int minRows, int maxRo
 * @throws WriterException if the contents cannot be encoded in this format
 */
 BarcodeMatrix
-Encoder::generateBarcodeLogic(const std::wstring& msg, int errorCorrectionLevel) const
+Encoder::generateBarcodeLogic(std::wstring_view msg, int errorCorrectionLevel) const
+{
+	//1. step: High-level encoding
+	return encodeCodewords(HighLevelEncoder::EncodeHighLevel(msg, _compaction, _encoding), errorCorrectionLevel);
+}
+
+BarcodeMatrix
+Encoder::generateBarcodeLogic(std::string_view msg, int errorCorrectionLevel) const
+{
+	return encodeCodewords(HighLevelEncoder::EncodeHighLevel(msg, _compaction, _encoding), errorCorrectionLevel);
+}
+
+BarcodeMatrix
+Encoder::encodeCodewords(std::vector<int>&& highLevel, int errorCorrectionLevel) const
 {
 	if (errorCorrectionLevel < 0 || errorCorrectionLevel > 8) {
 		throw std::invalid_argument("Error correction level must be between 0 and 8!");
 	}
 
-	//1. step: High-level encoding
 	int errorCorrectionCodeWords = GetErrorCorrectionCodewordCount(errorCorrectionLevel);
-	std::vector<int> highLevel = HighLevelEncoder::EncodeHighLevel(msg, _compaction, _encoding);
-	
 	int sourceCodeWords = Size(highLevel);
 
 	int cols, rows;
@@ -515,18 +525,15 @@ Encoder::generateBarcodeLogic(const std::wstring& msg, int errorCorrectionLevel)
 
 	int pad = GetNumberOfPadCodewords(sourceCodeWords, errorCorrectionCodeWords, cols, rows);
 
-	//2. step: construct data codewords
+	//2. step: construct data codewords in place, prepending the symbol length descriptor
 	if (sourceCodeWords + errorCorrectionCodeWords + 1 > 929) { // +1 for symbol length CW
 		throw std::invalid_argument("Encoded message contains to many code words, message too big");
 	}
 	int n = sourceCodeWords + pad + 1;
-	std::vector<int> dataCodewords;
-	dataCodewords.reserve(n);
-	dataCodewords.push_back(n);
-	dataCodewords.insert(dataCodewords.end(), highLevel.begin(), highLevel.end());
-	for (int i = 0; i < pad; i++) {
-		dataCodewords.push_back(900); //PAD characters
-	}
+	std::vector<int> dataCodewords = std::move(highLevel);
+	dataCodewords.reserve(n + errorCorrectionCodeWords);
+	dataCodewords.insert(dataCodewords.begin(), n);
+	dataCodewords.insert(dataCodewords.end(), pad, 900); //PAD characters
 
 	//3. step: Error correction
 	GenerateErrorCorrection(dataCodewords, errorCorrectionLevel);
@@ -10,6 +10,7 @@
 #include "ZXAlgorithms.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ZXing {
@@ -107,7 +108,7 @@ public:
 		return _matrix[_currentRow];
 	}
 
-	void getScaledMatrix(int xScale, int yScale, std::vector<std::vector<bool>>& output)
+	void getScaledMatrix(int xScale, int yScale, std::vector<std::vector<bool>>& output) const
 	{
 		output.resize(_matrix.size() * yScale);
 		int yMax = Size(output);
@@ -128,7 +129,9 @@ class Encoder
 public:
 	explicit Encoder(bool compact = false) : _compact(compact)  {}
 	
-	BarcodeMatrix generateBarcodeLogic(const std::wstring& msg, int errorCorrectionLevel) const;
+	BarcodeMatrix generateBarcodeLogic(std::wstring_view msg, int errorCorrectionLevel) const;
+	// msg has to be pure ASCII, see HighLevelEncoder::EncodeHighLevel()
+	BarcodeMatrix generateBarcodeLogic(std::string_view msg, int errorCorrectionLevel) const;
 
 	/**
 	* Sets max/min row/col values
@@ -169,6 +172,8 @@ public:
 	static int GetRecommendedMinimumErrorCorrectionLevel(int n);
 
 private:
+	BarcodeMatrix encodeCodewords(std::vector<int>&& highLevel, int errorCorrectionLevel) const;
+
 	bool _compact;
 	Compaction _compaction = Compaction::AUTO;
 	CharacterSet _encoding = CharacterSet::ISO8859_1;
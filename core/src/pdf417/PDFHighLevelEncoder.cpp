@@ -10,13 +10,15 @@
 #include "CharacterSet.h"
 #include "ECI.h"
 #include "TextEncoder.h"
-#include "ZXBigInteger.h"
 #include "ZXAlgorithms.h"
 
 #include <cstdint>
 #include <algorithm>
-#include <string>
+#include <array>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -195,11 +197,35 @@ static bool IsPunctuation(int ch)
 	return (ch & 0x7f) == ch && PUNCTUATION[ch] != -1;
 }
 
-static bool IsText(int ch)
+/**
+* Value of the character ch in the given text compaction submode or -1 if it can not be encoded in that submode.
+*/
+static int TextValue(int ch, int submode)
 {
-	return ch == '\t' || ch == '\n' || ch == '\r' || (ch >= 32 && ch <= 126);
+	switch (submode) {
+	case SUBMODE_ALPHA: return IsAlphaUpper(ch) ? (ch == ' ' ? 26 : ch - 'A') : -1;
+	case SUBMODE_LOWER: return IsAlphaLower(ch) ? (ch == ' ' ? 26 : ch - 'a') : -1;
+	case SUBMODE_MIXED: return IsMixed(ch) ? MIXED[ch] : -1;
+	default: return IsPunctuation(ch) ? PUNCTUATION[ch] : -1;
+	}
 }
 
+/**
+* Text compaction values to latch from one submode [from][to] to another, see ISO/IEC 15438:2015 Figure 5.
+* The first entry is the number of values.
+*/
+static const int8_t SUBMODE_LATCHES[4][4][3] = {
+	{{0}, {1, 27}, {1, 28}, {2, 28, 25}},     // from ALPHA: ll, ml, ml+pl
+	{{2, 28, 28}, {0}, {1, 28}, {2, 28, 25}}, // from LOWER: ml+al, ml, ml+pl
+	{{1, 28}, {1, 27}, {0}, {1, 25}},         // from MIXED: al, ll, pl
+	{{1, 29}, {2, 29, 27}, {2, 29, 28}, {0}}, // from PUNCT: al, al+ll, al+ml
+};
+
+template <typename CharT>
+static std::string ToBytes(std::basic_string_view<CharT> msg, CharacterSet encoding)
+{
+	return TextEncoder::FromUnicode(std::basic_string<CharT>(msg), encoding);
+}
 
 /**
 * Encode parts of the message using Text Compaction as described in ISO/IEC 15438:2001(E),
@@ -212,10 +238,11 @@ static bool IsText(int ch)
 * @param initialSubmode should normally be SUBMODE_ALPHA
 * @return the text submode in which this method ends
 */
-static int EncodeText(const std::wstring& msg, int startpos, int count, int submode, std::vector<int>& output)
+template <typename CharT>
+static int EncodeText(std::basic_string_view<CharT> msg, int startpos, int count, int submode, std::vector<int>& output)
 {
-	std::vector<int> tmp;
-	tmp.reserve(count);
+	thread_local std::vector<int> tmp;
+	tmp.clear();
 	int idx = 0;
 	while (true) {
 		int ch = msg[startpos + idx];
@@ -264,7 +291,7 @@ static int EncodeText(const std::wstring& msg, int startpos, int count, int subm
 				tmp.push_back(27); // ll
 				continue;
 			} else {
-				if (startpos + idx + 1 < count) {
+				if (idx + 1 < count) {
 					int next = msg[startpos + idx + 1];
 					if (IsPunctuation(next)) {
 						submode = SUBMODE_PUNCTUATION;
@@ -362,144 +389,230 @@ static void EncodeBinary(const std::string& bytes, int startpos, int count, int
 }
 
 
-static void EncodeNumeric(const std::wstring& msg, int startpos, int count, std::vector<int>& output)
+template <typename CharT>
+static void EncodeNumeric(std::basic_string_view<CharT> msg, int startpos, int count, std::vector<int>& output)
 {
+	// "1" followed by up to 44 digits is < 10^45, so 5 limbs of 9 decimal digits each (least significant first) hold it
+	constexpr uint32_t BASE = 1000000000;
 	int idx = 0;
-	std::vector<int> tmp;
-	tmp.reserve(count / 3 + 1);
-	BigInteger num900(900);
 	while (idx < count) {
-		tmp.clear();
 		int len = std::min(44, count - idx);
-		auto part = L"1" + msg.substr(startpos + idx, len);
+		int numDigits = len + 1;
+		auto digit = [&](int i) { return i == 0 ? 1 : msg[startpos + idx + i - 1] - '0'; };
+
+		std::array<uint32_t, 5> limbs;
+		int used = (numDigits + 8) / 9;
+		for (int j = 0; j < used; j++) {
+			uint32_t v = 0;
+			for (int i = std::max(0, numDigits - 9 * (j + 1)); i < numDigits - 9 * j; i++)
+				v = v * 10 + digit(i);
+			limbs[j] = v;
+		}
 
-		BigInteger bigint, r;
-		BigInteger::TryParse(part, bigint);
+		// repeated division by 900 yields the codewords, least significant first
+		size_t first = output.size();
 		do {
-			BigInteger::Divide(bigint, num900, bigint, r);
-			tmp.push_back(r.toInt());
-		} while (!bigint.isZero());
+			uint64_t r = 0;
+			for (int j = used - 1; j >= 0; j--) {
+				uint64_t v = r * BASE + limbs[j];
+				limbs[j] = uint32_t(v / 900);
+				r = v % 900;
+			}
+			output.push_back(int(r));
+			while (used > 0 && limbs[used - 1] == 0)
+				used--;
+		} while (used > 0);
 
-		//Reverse temporary string
-		output.insert(output.end(), tmp.rbegin(), tmp.rend());
+		std::reverse(output.begin() + first, output.end());
 		idx += len;
 	}
 }
 
+/**
+* The states of the compaction optimization: the four text submodes (SUBMODE_ALPHA..SUBMODE_PUNCTUATION), numeric
+* compaction and byte compaction. The latter is split into 6 states by the number of bytes in the current six-pack,
+* because 6 bytes are encoded in 5 codewords but any remaining bytes in one codeword each.
+*/
+static const int STATE_NUMERIC = 4;
+static const int STATE_BYTE = 5;
+static const int NUM_STATES = STATE_BYTE + 6;
 
 /**
-* Determines the number of consecutive characters that are encodable using numeric compaction.
-*
-* @param msg      the message
-* @param startpos the start position within the message
-* @return the requested character count
+* Costs are measured in 1/132 of a codeword, so that a text value (1/2) and a digit (15/44) have an integral cost.
+* Leaving a compaction mode rounds up to the next full codeword.
 */
-static int DetermineConsecutiveDigitCount(const std::wstring& msg, int startpos)
+static const int CW = 132;
+static const int TEXT_VALUE_COST = CW / 2;
+static const int DIGIT_COST = CW * 15 / 44;
+
+enum class Step : int8_t { Latch, Shift, ShiftToByte };
+
+struct Transition
 {
-	int count = 0;
-	size_t len = msg.length();
-	size_t idx = startpos;
-	if (idx < len) {
-		int ch = msg[idx];
-		while (IsDigit(ch) && idx < len) {
-			count++;
-			idx++;
-			if (idx < len) {
-				ch = msg[idx];
-			}
-		}
+	int8_t prev;
+	Step step;
+};
+
+struct PathStep
+{
+	int8_t state;
+	Step step;
+};
+
+static int NumBytes(int ch, CharacterSet encoding)
+{
+	switch (encoding) {
+	case CharacterSet::UTF8:
+		if (ch >= 0xDC00 && ch < 0xE000) // low surrogate, counted with the high one
+			return 0;
+		return ch < 0x80 ? 1 : ch < 0x800 ? 2 : (ch < 0xD800 || (ch >= 0xE000 && ch < 0x10000)) ? 3 : 4;
+	case CharacterSet::UTF16BE:
+	case CharacterSet::UTF16LE: return 2;
+	case CharacterSet::UTF32BE:
+	case CharacterSet::UTF32LE: return 4;
+	default: return ch < 0x80 ? 1 : Size(TextEncoder::FromUnicode(std::wstring(1, narrow_cast<wchar_t>(ch)), encoding));
 	}
-	return count;
 }
 
 /**
-* Determines the number of consecutive characters that are encodable using text compaction.
-*
-* @param msg      the message
-* @param startpos the start position within the message
-* @return the requested character count
+* Finds the sequence of compaction modes, text submodes and shifts with the least number of codewords for the whole
+* message (shortest path through the states above, one step per character). Returns the state of each character and
+* the step (latch, shift) that lead to it.
 */
-static int DetermineConsecutiveTextCount(const std::wstring& msg, int startpos)
+template <typename CharT>
+static const std::vector<PathStep>& ChooseCompaction(std::basic_string_view<CharT> msg, CharacterSet encoding)
 {
-	size_t len = msg.length();
-	size_t idx = startpos;
-	while (idx < len) {
-		int ch = msg[idx];
-		int numericCount = 0;
-		while (numericCount < 13 && IsDigit(ch) && idx < len) {
-			numericCount++;
-			idx++;
-			if (idx < len) {
-				ch = msg[idx];
+	constexpr int INF = std::numeric_limits<int>::max() / 2;
+	auto roundUp = [](int cost) { return (cost + CW - 1) / CW * CW; };
+
+	thread_local std::vector<std::array<Transition, NUM_STATES>> transitions;
+	thread_local std::vector<PathStep> path;
+	transitions.resize(msg.size());
+	path.resize(msg.size());
+	// the default compaction mode at the start of a symbol is text compaction, submode alpha
+	std::array<int, NUM_STATES> costs;
+	costs.fill(INF);
+	costs[SUBMODE_ALPHA] = 0;
+	for (size_t i = 0; i < msg.size(); ++i) {
+		int ch = msg[i];
+		bool isDigit = IsDigit(ch);
+		int numBytes = NumBytes(ch, encoding);
+		std::array<int, NUM_STATES> next;
+		next.fill(INF);
+		auto relax = [&](int to, int cost, int from, Step step) {
+			if (cost < next[to]) {
+				next[to] = cost;
+				transitions[i][to] = {narrow_cast<int8_t>(from), step};
 			}
-		}
-		if (numericCount >= 13) {
-			return static_cast<int>(idx - startpos - numericCount);
-		}
-		if (numericCount > 0) {
-			//Heuristic: All text-encodable chars or digits are binary encodable
-			continue;
-		}
-		ch = msg[idx];
+		};
 
-		//Check if character is encodable
-		if (!IsText(ch)) {
-			break;
+		for (int from = 0; from < NUM_STATES; ++from) {
+			int cost = costs[from];
+			if (cost >= INF)
+				continue;
+			bool inText = from < STATE_NUMERIC;
+			int submode = inText ? from : SUBMODE_ALPHA; // a latch to text compaction always starts in submode alpha
+			int textCost = inText ? cost : roundUp(cost) + CW; // 900
+			for (int to = SUBMODE_ALPHA; to <= SUBMODE_PUNCTUATION; ++to)
+				if (TextValue(ch, to) != -1)
+					relax(to, textCost + TEXT_VALUE_COST * (1 + SUBMODE_LATCHES[submode][to][0]), from, Step::Latch);
+			if ((submode != SUBMODE_PUNCTUATION && IsPunctuation(ch)) || (submode == SUBMODE_LOWER && ch >= 'A' && ch <= 'Z'))
+				relax(submode, textCost + 2 * TEXT_VALUE_COST, from, Step::Shift); // ps or as
+			// a padding ps in submode punctuation would latch to alpha, so no byte shift from there
+			if (inText && numBytes == 1 && from != SUBMODE_PUNCTUATION)
+				relax(from, roundUp(cost) + 2 * CW, from, Step::ShiftToByte); // 913
+			// every byte costs one codeword, except the one completing a six-pack
+			int inPack = from >= STATE_BYTE ? from - STATE_BYTE : 0;
+			relax(STATE_BYTE + (inPack + numBytes) % 6,
+				  (from >= STATE_BYTE ? cost : roundUp(cost) + CW) + (numBytes - (inPack + numBytes) / 6) * CW, from, Step::Latch);
+			if (isDigit)
+				relax(STATE_NUMERIC, (from == STATE_NUMERIC ? cost : roundUp(cost) + CW) + DIGIT_COST, from, Step::Latch);
 		}
-		idx++;
+		costs = next;
 	}
-	return static_cast<int>(idx - startpos);
+
+	// backtrack from the cheapest final state
+	auto minCost = std::min_element(costs.begin(), costs.end(), [&](int a, int b) { return roundUp(a) < roundUp(b); });
+	int state = narrow_cast<int>(minCost - costs.begin());
+	for (int i = Size(msg) - 1; i >= 0; --i) {
+		path[i] = {narrow_cast<int8_t>(state), transitions[i][state].step};
+		state = transitions[i][state].prev;
+	}
+	return path;
 }
 
-/**
-* Determines the number of consecutive characters that are encodable using binary compaction.
-*
-* @param msg      the message
-* @param startpos the start position within the message
-* @param encoding the charset used to convert the message to a byte array
-* @return the requested character count
-*/
-static int DetermineConsecutiveBinaryCount(const std::wstring& msg, int startpos)
+template <typename CharT>
+static void EncodeAuto(std::basic_string_view<CharT> msg, CharacterSet encoding, std::vector<int>& output)
 {
-	size_t len = msg.length();
-	size_t idx = startpos;
-	while (idx < len) {
-		int ch = msg[idx];
-		int numericCount = 0;
-
-		while (numericCount < 13 && IsDigit(ch)) {
-			numericCount++;
-			//textCount++;
-			size_t i = idx + numericCount;
-			if (i >= len) {
-				break;
+	const auto& path = ChooseCompaction(msg, encoding);
+
+	thread_local std::vector<int> values;
+	values.clear();
+	auto flushText = [&] {
+		for (size_t i = 0; i + 1 < values.size(); i += 2)
+			output.push_back(values[i] * 30 + values[i + 1]);
+		if (values.size() % 2)
+			output.push_back(values.back() * 30 + 29); // ps
+		values.clear();
+	};
+
+	int len = Size(msg);
+	int submode = SUBMODE_ALPHA;
+	for (int i = 0; i < len;) {
+		int state = path[i].state;
+		int prev = i > 0 ? path[i - 1].state : SUBMODE_ALPHA;
+		if (state >= STATE_NUMERIC) {
+			int end = i + 1;
+			bool isByte = state >= STATE_BYTE;
+			while (end < len && path[end].state >= STATE_NUMERIC && (path[end].state >= STATE_BYTE) == isByte)
+				++end;
+			flushText();
+			if (isByte) {
+				std::string bytes = ToBytes(msg.substr(i, end - i), encoding);
+				EncodeBinary(bytes, 0, Size(bytes), BYTE_COMPACTION, output);
+			} else {
+				output.push_back(LATCH_TO_NUMERIC);
+				EncodeNumeric(msg, i, end - i, output);
 			}
-			ch = msg[i];
+			i = end;
+			continue;
 		}
-		if (numericCount >= 13) {
-			return static_cast<int>(idx - startpos);
+
+		int ch = msg[i];
+		if (prev >= STATE_NUMERIC) {
+			output.push_back(LATCH_TO_TEXT);
+			submode = SUBMODE_ALPHA; // a latch to text compaction always starts in submode alpha
 		}
-		idx++;
+		switch (path[i].step) {
+		case Step::ShiftToByte:
+			flushText();
+			EncodeBinary(ToBytes(msg.substr(i, 1), encoding), 0, 1, TEXT_COMPACTION, output);
+			break;
+		case Step::Shift:
+			if (submode == SUBMODE_LOWER && ch >= 'A' && ch <= 'Z')
+				values.insert(values.end(), {27, ch - 'A'}); // as
+			else
+				values.insert(values.end(), {29, PUNCTUATION[ch]}); // ps
+			break;
+		case Step::Latch: {
+			const auto& latch = SUBMODE_LATCHES[submode][state];
+			values.insert(values.end(), latch + 1, latch + 1 + latch[0]);
+			values.push_back(TextValue(ch, state));
+			submode = state;
+			break;
+		}
+		}
+		++i;
 	}
-	return static_cast<int>(idx - startpos);
+	flushText();
 }
 
-/**
-* Performs high-level encoding of a PDF417 message using the algorithm described in annex P
-* of ISO/IEC 15438:2001(E). If byte compaction has been selected, then only byte compaction
-* is used.
-*
-* @param msg the message
-* @param compaction compaction mode to use
-* @param encoding character encoding used to encode in default or byte compaction
-*  or {@code null} for default / not applicable
-* @return the encoded message (the char values range from 0 to 928)
-*/
-std::vector<int>
-HighLevelEncoder::EncodeHighLevel(const std::wstring& msg, Compaction compaction, CharacterSet encoding)
+template <typename CharT>
+static std::vector<int> EncodeHighLevelImpl(std::basic_string_view<CharT> msg, Compaction compaction, CharacterSet encoding)
 {
 	std::vector<int> highLevel;
-	highLevel.reserve(highLevel.size() + msg.length());
+	// one slot more for the symbol length descriptor, see Encoder::generateBarcodeLogic()
+	highLevel.reserve(msg.length() + 4);
 
 	//the codewords 0..928 are encoded as Unicode characters
 	if (encoding != CharacterSet::ISO8859_1) {
@@ -507,70 +620,47 @@ HighLevelEncoder::EncodeHighLevel(const std::wstring& msg, Compaction compaction
 	}
 
 	int len = Size(msg);
-	int p = 0;
-	int textSubMode = SUBMODE_ALPHA;
 
 	// User selected encoding mode
 	if (compaction == Compaction::TEXT) {
-		EncodeText(msg, p, len, textSubMode, highLevel);
-
+		EncodeText(msg, 0, len, SUBMODE_ALPHA, highLevel);
 	}
 	else if (compaction == Compaction::BYTE) {
-		std::string bytes = TextEncoder::FromUnicode(msg, encoding);
-		EncodeBinary(bytes, p, Size(bytes), BYTE_COMPACTION, highLevel);
+		std::string bytes = ToBytes(msg, encoding);
+		EncodeBinary(bytes, 0, Size(bytes), BYTE_COMPACTION, highLevel);
 	}
 	else if (compaction == Compaction::NUMERIC) {
 		highLevel.push_back(LATCH_TO_NUMERIC);
-		EncodeNumeric(msg, p, len, highLevel);
-
+		EncodeNumeric(msg, 0, len, highLevel);
 	}
 	else {
-		int encodingMode = TEXT_COMPACTION; //Default mode, see 4.4.2.1
-		while (p < len) {
-			int n = DetermineConsecutiveDigitCount(msg, p);
-			if (n >= 13) {
-				highLevel.push_back(LATCH_TO_NUMERIC);
-				encodingMode = NUMERIC_COMPACTION;
-				textSubMode = SUBMODE_ALPHA; //Reset after latch
-				EncodeNumeric(msg, p, n, highLevel);
-				p += n;
-			}
-			else {
-				int t = DetermineConsecutiveTextCount(msg, p);
-				if (t >= 5 || n == len) {
-					if (encodingMode != TEXT_COMPACTION) {
-						highLevel.push_back(LATCH_TO_TEXT);
-						encodingMode = TEXT_COMPACTION;
-						textSubMode = SUBMODE_ALPHA; //start with submode alpha after latch
-					}
-					textSubMode = EncodeText(msg, p, t, textSubMode, highLevel);
-					p += t;
-				}
-				else {
-					int b = DetermineConsecutiveBinaryCount(msg, p);
-					if (b == 0) {
-						b = 1;
-					}
-					std::string bytes = TextEncoder::FromUnicode(msg.substr(p, b), encoding);
-					if (bytes.length() == 1 && encodingMode == TEXT_COMPACTION) {
-						//Switch for one byte (instead of latch)
-						EncodeBinary(bytes, 0, 1, TEXT_COMPACTION, highLevel);
-					}
-					else {
-						//Mode latch performed by encodeBinary()
-						EncodeBinary(bytes, 0, Size(bytes), encodingMode, highLevel);
-						encodingMode = BYTE_COMPACTION;
-						textSubMode = SUBMODE_ALPHA; //Reset after latch
-					}
-					p += b;
-				}
-			}
-		}
+		EncodeAuto(msg, encoding, highLevel);
 	}
 	return highLevel;
 }
 
+/**
+* Performs high-level encoding of a PDF417 message. In AUTO mode the compaction modes, text submodes and shifts are
+* chosen such that the number of codewords is minimal (instead of the heuristic described in annex P of
+* ISO/IEC 15438:2001(E)). If a specific compaction has been selected, then only that compaction is used.
+*
+* @param msg the message
+* @param compaction compaction mode to use
+* @param encoding character encoding used to encode in default or byte compaction
+*  or {@code null} for default / not applicable
+* @return the encoded message (the char values range from 0 to 928)
+*/
+std::vector<int>
+HighLevelEncoder::EncodeHighLevel(std::wstring_view msg, Compaction compaction, CharacterSet encoding)
+{
+	return EncodeHighLevelImpl(msg, compaction, encoding);
+}
 
+std::vector<int>
+HighLevelEncoder::EncodeHighLevel(std::string_view msg, Compaction compaction, CharacterSet encoding)
+{
+	return EncodeHighLevelImpl(msg, compaction, encoding);
+}
 
 } // Pdf417
 } // ZXing
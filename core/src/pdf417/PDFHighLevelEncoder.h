@@ -9,7 +9,7 @@
 
 #include "CharacterSet.h"
 
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace ZXing {
@@ -19,13 +19,14 @@ namespace Pdf417 {
 enum class Compaction;
 
 /**
-* PDF417 high-level encoder following the algorithm described in ISO/IEC 15438:2001(E) in
-* annex P.
+* PDF417 high-level encoder. In AUTO mode it selects the compaction modes with the least number of codewords.
 */
 class HighLevelEncoder
 {
 public:
-	static std::vector<int> EncodeHighLevel(const std::wstring& msg, Compaction compaction, CharacterSet encoding);
+	static std::vector<int> EncodeHighLevel(std::wstring_view msg, Compaction compaction, CharacterSet encoding);
+	// msg has to be pure ASCII, i.e. each char is one character (the string is not decoded as utf8)
+	static std::vector<int> EncodeHighLevel(std::string_view msg, Compaction compaction, CharacterSet encoding);
 };
 
 } // Pdf417
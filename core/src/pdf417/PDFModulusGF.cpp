@@ -47,9 +47,7 @@ ModulusGF::buildMonomial(int degree, int coefficient) const
 	if (coefficient == 0) {
 		return _zero;
 	}
-	std::vector<int> coefficients(degree + 1, 0);
-	coefficients[0] = coefficient;
-	return ModulusPoly(*this, coefficients);
+	return _one.multiplyByMonomial(degree, coefficient);
 }
 
 } // Pdf417
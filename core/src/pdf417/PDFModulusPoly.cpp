@@ -13,27 +13,30 @@
 namespace ZXing {
 namespace Pdf417 {
 
-ModulusPoly::ModulusPoly(const ModulusGF& field, const std::vector<int>& coefficients) :
-	_field(&field)
+ModulusPoly::ModulusPoly(const ModulusGF& field, const int* coefficients, int size) :
+	_field(&field),
+	_size(size)
 {
-	size_t coefficientsLength = coefficients.size();
-	if (coefficientsLength > 1 && coefficients[0] == 0) {
-		// Leading term must be non-zero for anything except the constant polynomial "0"
-		size_t firstNonZero = 1;
-		while (firstNonZero < coefficientsLength && coefficients[firstNonZero] == 0) {
-			firstNonZero++;
-		}
-		if (firstNonZero == coefficientsLength) {
-			_coefficients.resize(1, 0);
-		}
-		else {
-			_coefficients.resize(coefficientsLength - firstNonZero);
-			std::copy(coefficients.begin() + firstNonZero, coefficients.end(), _coefficients.begin());
-		}
+	if (size < 1 || size > MAX_SIZE) {
+		throw std::invalid_argument("Invalid number of ModulusPoly coefficients");
+	}
+	std::copy_n(coefficients, size, _coefficients.begin());
+	normalize();
+}
+
+// Leading term must be non-zero for anything except the constant polynomial "0"
+ModulusPoly&
+ModulusPoly::normalize()
+{
+	int firstNonZero = 0;
+	while (firstNonZero < _size - 1 && _coefficients[firstNonZero] == 0) {
+		firstNonZero++;
 	}
-	else {
-		_coefficients = coefficients;
+	if (firstNonZero > 0) {
+		std::copy(_coefficients.begin() + firstNonZero, _coefficients.begin() + _size, _coefficients.begin());
+		_size -= firstNonZero;
 	}
+	return *this;
 }
 
 /**
@@ -46,14 +49,16 @@ ModulusPoly::evaluateAt(int a) const
 		// Just return the x^0 coefficient
 		return coefficient(0);
 	}
-	size_t size = _coefficients.size();
 	if (a == 1) {
 		// Just the sum of the coefficients
-		const auto op = [this](auto result, const auto coefficient){ return _field->add(result, coefficient);};
-		return std::accumulate(std::begin(_coefficients), std::end(_coefficients), int{}, op);
+		int result = 0;
+		for (int i = 0; i < _size; i++) {
+			result = _field->add(result, _coefficients[i]);
+		}
+		return result;
 	}
 	int result = _coefficients[0];
-	for (size_t i = 1; i < size; i++) {
+	for (int i = 1; i < _size; i++) {
 		result = _field->add(_field->multiply(a, result), _coefficients[i]);
 	}
 	return result;
@@ -72,20 +77,20 @@ ModulusPoly::add(const ModulusPoly& other) const
 		return *this;
 	}
 
-	auto smallerCoefficients = &_coefficients;
-	auto largerCoefficients = &other._coefficients;
-	if (smallerCoefficients->size() > largerCoefficients->size()) {
-		std::swap(smallerCoefficients, largerCoefficients);
+	auto smaller = this;
+	auto larger = &other;
+	if (smaller->_size > larger->_size) {
+		std::swap(smaller, larger);
 	}
-	std::vector<int> sumDiff(largerCoefficients->size());
-	size_t lengthDiff = largerCoefficients->size() - smallerCoefficients->size();
+	ModulusPoly sumDiff(*_field, larger->_size);
+	int lengthDiff = larger->_size - smaller->_size;
 
 	// Copy high-order terms only found in higher-degree polynomial's coefficients
-	std::copy_n(largerCoefficients->begin(), lengthDiff, sumDiff.begin());
-	for (size_t i = lengthDiff; i < largerCoefficients->size(); i++) {
-		sumDiff[i] = _field->add((*smallerCoefficients)[i - lengthDiff], (*largerCoefficients)[i]);
+	std::copy_n(larger->_coefficients.begin(), lengthDiff, sumDiff._coefficients.begin());
+	for (int i = lengthDiff; i < larger->_size; i++) {
+		sumDiff._coefficients[i] = _field->add(smaller->_coefficients[i - lengthDiff], larger->_coefficients[i]);
 	}
-	return ModulusPoly(*_field, sumDiff);
+	return sumDiff.normalize();
 }
 
 ModulusPoly
@@ -109,29 +114,27 @@ ModulusPoly::multiply(const ModulusPoly& other) const
 	if (isZero() || other.isZero()) {
 		return _field->zero();
 	}
-	auto& aCoefficients = _coefficients;
-	size_t aLength = aCoefficients.size();
-	auto& bCoefficients = other._coefficients;
-	size_t bLength = bCoefficients.size();
-	std::vector<int> product(aLength + bLength - 1, 0);
-	for (size_t i = 0; i < aLength; i++) {
-		int aCoeff = aCoefficients[i];
-		for (size_t j = 0; j < bLength; j++) {
-			product[i + j] = _field->add(product[i + j], _field->multiply(aCoeff, bCoefficients[j]));
+	if (_size + other._size - 1 > MAX_SIZE) {
+		throw std::invalid_argument("ModulusPoly product exceeds MAX_SIZE");
+	}
+	ModulusPoly product(*_field, _size + other._size - 1);
+	for (int i = 0; i < _size; i++) {
+		int aCoeff = _coefficients[i];
+		for (int j = 0; j < other._size; j++) {
+			product._coefficients[i + j] = _field->add(product._coefficients[i + j], _field->multiply(aCoeff, other._coefficients[j]));
 		}
 	}
-	return ModulusPoly(*_field, product);
+	return product.normalize();
 }
 
 ModulusPoly
 ModulusPoly::negative() const
 {
-	size_t size = _coefficients.size();
-	std::vector<int> negativeCoefficients(size);
-	for (size_t i = 0; i < size; i++) {
-		negativeCoefficients[i] = _field->subtract(0, _coefficients[i]);
+	ModulusPoly negativeCoefficients(*_field, _size);
+	for (int i = 0; i < _size; i++) {
+		negativeCoefficients._coefficients[i] = _field->subtract(0, _coefficients[i]);
 	}
-	return ModulusPoly(*_field, negativeCoefficients);
+	return negativeCoefficients;
 }
 
 ModulusPoly
@@ -143,12 +146,11 @@ ModulusPoly::multiply(int scalar) const
 	if (scalar == 1) {
 		return *this;
 	}
-	size_t size = _coefficients.size();
-	std::vector<int> product(size);
-	for (size_t i = 0; i < size; i++) {
-		product[i] = _field->multiply(_coefficients[i], scalar);
+	ModulusPoly product(*_field, _size);
+	for (int i = 0; i < _size; i++) {
+		product._coefficients[i] = _field->multiply(_coefficients[i], scalar);
 	}
-	return ModulusPoly(*_field, product);
+	return product;
 }
 
 ModulusPoly
@@ -160,12 +162,14 @@ ModulusPoly::multiplyByMonomial(int degree, int coefficient) const
 	if (coefficient == 0) {
 		return _field->zero();
 	}
-	size_t size = _coefficients.size();
-	std::vector<int> product(size + degree, 0);
-	for (size_t i = 0; i < size; i++) {
-		product[i] = _field->multiply(_coefficients[i], coefficient);
+	if (_size + degree > MAX_SIZE) {
+		throw std::invalid_argument("ModulusPoly product exceeds MAX_SIZE");
+	}
+	ModulusPoly product(*_field, _size + degree);
+	for (int i = 0; i < _size; i++) {
+		product._coefficients[i] = _field->multiply(_coefficients[i], coefficient);
 	}
-	return ModulusPoly(*_field, product);
+	return product;
 }
 
 void
@@ -6,9 +6,9 @@
 
 #pragma once
 
-#include "ZXAlgorithms.h"
-
-#include <utility>
+#include <algorithm>
+#include <array>
+#include <initializer_list>
 #include <vector>
 
 namespace ZXing {
@@ -17,44 +17,76 @@ namespace Pdf417 {
 class ModulusGF;
 
 /**
+* The coefficients are stored inline with a fixed capacity, so none of the polynomial arithmetic of the
+* error correction touches the heap.
+*
 * @author Sean Owen
 * @see com.google.zxing.common.reedsolomon.GenericGFPoly
 */
 class ModulusPoly
 {
+public:
+	// The error correction never needs more than x^512 (PDF417 has at most 512 EC codewords)
+	static constexpr int MAX_SIZE = 513;
+
+private:
 	const ModulusGF* _field = nullptr;
-	std::vector<int> _coefficients;
+	int _size = 0;
+	std::array<int, MAX_SIZE> _coefficients; // highest degree first
+
+	ModulusPoly(const ModulusGF& field, int size) : _field(&field), _size(size) { std::fill_n(_coefficients.begin(), size, 0); }
+	ModulusPoly& normalize();
 
 public:
 	// Build a invalid object, so that this can be used in container or return by reference,
 	// any access to invalid object is undefined behavior.
 	ModulusPoly() = default;
 
-	ModulusPoly(const ModulusGF& field, const std::vector<int>& coefficients);
+	ModulusPoly(const ModulusGF& field, const int* coefficients, int size);
+	ModulusPoly(const ModulusGF& field, std::initializer_list<int> coefficients)
+		: ModulusPoly(field, coefficients.begin(), static_cast<int>(coefficients.size()))
+	{}
+	ModulusPoly(const ModulusGF& field, const std::vector<int>& coefficients)
+		: ModulusPoly(field, coefficients.data(), static_cast<int>(coefficients.size()))
+	{}
+
+	// only copy the used part of the coefficients
+	ModulusPoly(const ModulusPoly& other) : _field(other._field), _size(other._size)
+	{
+		std::copy_n(other._coefficients.begin(), _size, _coefficients.begin());
+	}
+
+	ModulusPoly& operator=(const ModulusPoly& other)
+	{
+		_field = other._field;
+		_size = other._size;
+		std::copy_n(other._coefficients.begin(), _size, _coefficients.begin());
+		return *this;
+	}
 
-	const std::vector<int>& coefficients() const {
-		return _coefficients;
+	const int* coefficients() const {
+		return _coefficients.data();
 	}
 
 	/**
 	* @return degree of this polynomial
 	*/
 	int degree() const {
-		return Size(_coefficients) - 1;
+		return _size - 1;
 	}
 
 	/**
 	* @return true iff this polynomial is the monomial "0"
 	*/
 	bool isZero() const {
-		return _coefficients.at(0) == 0;
+		return _coefficients[0] == 0;
 	}
 
 	/**
 	* @return coefficient of x^degree term in this polynomial
 	*/
 	int coefficient(int degree) const {
-		return _coefficients.at(_coefficients.size() - 1 - degree);
+		return _coefficients[_size - 1 - degree];
 	}
 
 	/**
@@ -72,8 +104,9 @@ public:
 
 	friend void swap(ModulusPoly& a, ModulusPoly& b)
 	{
-		std::swap(a._field, b._field);
-		std::swap(a._coefficients, b._coefficients);
+		ModulusPoly tmp = a;
+		a = b;
+		b = tmp;
 	}
 };
 
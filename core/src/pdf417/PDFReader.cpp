@@ -11,7 +11,10 @@
 #include "PDFCodewordDecoder.h"
 #include "DecodeHints.h"
 #include "DecoderResult.h"
+#include "Executor.h"
 #include "Result.h"
+#include "StatsScope.h"
+#include "TraceScope.h"
 
 #include "BitMatrixCursor.h"
 #include "BinaryBitmap.h"
@@ -63,34 +66,104 @@ static int GetMaxCodewordWidth(const std::array<Nullable<ResultPoint>, 8>& p)
 					std::max(GetMaxWidth(p[1], p[5]), GetMaxWidth(p[7], p[3]) * CodewordDecoder::MODULES_IN_CODEWORD / MODULES_IN_STOP_PATTERN));
 }
 
-static Results DoDecode(const BinaryBitmap& image, bool multiple, bool tryRotate, bool returnErrors)
+// The start and stop patterns of all symbols are detected on the first call of next(), then every call decodes one of
+// them. With an executor, all symbols on e.g. a document page are decoded concurrently in the first call and then
+// reported in detection order.
+class Candidates : public CandidateStream
 {
-	Detector::Result detectorResult = Detector::Detect(image, multiple, tryRotate);
-	if (detectorResult.points.empty())
-		return {};
-
-	auto rotate = [res = detectorResult](PointI p) {
+	const BinaryBitmap& _image;
+	bool _multiple, _tryRotate, _returnErrors, _detectOnly;
+	Deadline _deadline;
+	bool _detected = false;
+	Detector::Result _detectorResult;
+	std::vector<DecoderResult> _decoderResults; // only if decoded in parallel
+	int _next = 0;
+
+	PointI rotate(PointI p) const
+	{
+		const auto& res = _detectorResult;
 		switch(res.rotation) {
-		case 90: return PointI(res.bits->height() - p.y - 1, p.x);
-		case 180: return PointI(res.bits->width() - p.x - 1, res.bits->height() - p.y - 1);
-		case 270: return PointI(p.y, res.bits->width() - p.x - 1);
+		case 90: return PointI(res.bits.height() - p.y - 1, p.x);
+		case 180: return PointI(res.bits.width() - p.x - 1, res.bits.height() - p.y - 1);
+		case 270: return PointI(p.y, res.bits.width() - p.x - 1);
 		}
 		return p;
-	};
+	}
 
-	Results results;
-	for (const auto& points : detectorResult.points) {
-		DecoderResult decoderResult =
-			ScanningDecoder::Decode(*detectorResult.bits, points[4], points[5], points[6], points[7],
-									GetMinCodewordWidth(points), GetMaxCodewordWidth(points));
-		if (decoderResult.isValid(returnErrors)) {
-			auto point = [&](int i) { return rotate(PointI(points[i].value())); };
-			Result result(std::move(decoderResult), {point(0), point(2), point(3), point(1)}, BarcodeFormat::PDF417);
-			results.push_back(result);
-			if (!multiple)
-				return results;
+	QuadrilateralI position(int i) const
+	{
+		auto point = [&](int j) { return rotate(PointI(_detectorResult.points[i][j].value())); };
+		return {point(0), point(2), point(3), point(1)};
+	}
+
+	DecoderResult decode(int i) const
+	{
+		auto& points = _detectorResult.points[i];
+		return ScanningDecoder::Decode(_detectorResult.bits, points[4], points[5], points[6], points[7], GetMinCodewordWidth(points),
+									   GetMaxCodewordWidth(points), _deadline);
+	}
+
+	void detect(Results& results)
+	{
+		_detectorResult = Detector::Detect(_image, _multiple, _tryRotate, _deadline);
+		auto& allPoints = _detectorResult.points;
+
+		// only the symbols with both a start and a stop pattern can be localized without decoding the row indicators
+		if (_detectOnly) {
+			for (int i = 0; i < Size(allPoints); ++i) {
+				if (std::any_of(allPoints[i].begin(), allPoints[i].begin() + 4, [](auto& p) { return p == nullptr; }))
+					continue;
+				results.emplace_back(position(i), BarcodeFormat::PDF417);
+				if (!_multiple)
+					break;
+			}
+			_next = Size(allPoints);
+			return;
+		}
+
+		auto executor = _image.executor();
+		if (_multiple && executor && Size(allPoints) > 1) {
+			_decoderResults.resize(allPoints.size());
+			executor->parallelFor(Size(allPoints), [&, stats = CurrentStats()](int i) {
+				StatsContext context(stats);
+				if (!IsExpired(_deadline))
+					_decoderResults[i] = decode(i);
+			});
+			for (; _next < Size(allPoints); ++_next)
+				if (_decoderResults[_next].isValid(_returnErrors))
+					results.emplace_back(std::move(_decoderResults[_next]), position(_next), BarcodeFormat::PDF417);
+		}
+	}
+
+public:
+	Candidates(const BinaryBitmap& image, bool multiple, bool tryRotate, bool returnErrors, bool detectOnly, Deadline deadline)
+		: _image(image), _multiple(multiple), _tryRotate(tryRotate), _returnErrors(returnErrors), _detectOnly(detectOnly),
+		  _deadline(deadline)
+	{}
+
+	bool next(Results& results) override
+	{
+		if (!_detected) {
+			_detected = true;
+			detect(results);
+			return true;
 		}
+		if (_next >= Size(_detectorResult.points) || IsExpired(_deadline))
+			return false;
+		DecoderResult decoderResult = decode(_next);
+		if (decoderResult.isValid(_returnErrors))
+			results.emplace_back(std::move(decoderResult), position(_next), BarcodeFormat::PDF417);
+		++_next;
+		return true;
 	}
+};
+
+static Results DoDecode(const BinaryBitmap& image, bool multiple, bool tryRotate, bool returnErrors, bool detectOnly, Deadline deadline)
+{
+	Results results;
+	Candidates stream(image, multiple, tryRotate, returnErrors, detectOnly, deadline);
+	while ((multiple || results.empty()) && stream.next(results))
+		;
 	return results;
 }
 
@@ -298,7 +371,8 @@ static Result DecodePure(const BinaryBitmap& image_)
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
-	if (_hints.isPure()) {
+	ZX_TRACE_SCOPE("Pdf417::Reader::decode");
+	if (_hints.isPure() && !_hints.detectOnly()) {
 		auto res = DecodePure(image);
 		if (res.error() != Error::Checksum)
 			return res;
@@ -306,12 +380,18 @@ Reader::decode(const BinaryBitmap& image) const
 		// currently the best option to deal with 'aliased' input like e.g. 03-aliased.png
 	}
 
-	return FirstOrDefault(DoDecode(image, false, _hints.tryRotate(), _hints.returnErrors()));
+	return FirstOrDefault(DoDecode(image, false, _hints.tryRotate(), _hints.returnErrors(), _hints.detectOnly(), _hints.deadline()));
 }
 
 Results Reader::decode(const BinaryBitmap& image, [[maybe_unused]] int maxSymbols) const
 {
-	return DoDecode(image, true, _hints.tryRotate(), _hints.returnErrors());
+	ZX_TRACE_SCOPE("Pdf417::Reader::decode");
+	return DoDecode(image, true, _hints.tryRotate(), _hints.returnErrors(), _hints.detectOnly(), _hints.deadline());
+}
+
+std::unique_ptr<CandidateStream> Reader::candidates(const BinaryBitmap& image, int) const
+{
+	return std::make_unique<Candidates>(image, true, _hints.tryRotate(), _hints.returnErrors(), _hints.detectOnly(), _hints.deadline());
 }
 
 } // Pdf417
@@ -24,6 +24,7 @@ public:
 
 	Result decode(const BinaryBitmap& image) const override;
 	Results decode(const BinaryBitmap& image, int maxSymbols) const override;
+	std::unique_ptr<CandidateStream> candidates(const BinaryBitmap& image, int maxSymbols) const override;
 };
 
 } // namespace ZXing::Pdf417
@@ -0,0 +1,62 @@
+/*
+* Copyright 2016 Nu-book Inc.
+* Copyright 2016 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "BitMatrix.h"
+#include "Pattern.h"
+
+#include <algorithm>
+
+namespace ZXing {
+namespace Pdf417 {
+
+/**
+* Read-only view of a BitMatrix as if it had been rotated by 0, 90, 180 or 270 degrees
+* (in the sense of BitMatrix::rotate90()/rotate180()). The detector and scanning decoder
+* work on this view so that rotated symbols can be found without copying the image.
+*/
+class RotatedBitMatrix
+{
+	const BitMatrix* _bits = nullptr;
+	int _rotation = 0;
+
+public:
+	RotatedBitMatrix() = default;
+	RotatedBitMatrix(const BitMatrix& bits, int rotation) : _bits(&bits), _rotation(rotation) {}
+
+	int rotation() const { return _rotation; }
+	int width() const { return _rotation % 180 ? _bits->height() : _bits->width(); }
+	int height() const { return _rotation % 180 ? _bits->width() : _bits->height(); }
+
+	bool get(int x, int y) const
+	{
+		switch (_rotation) {
+		case 90: return _bits->get(_bits->width() - 1 - y, x);
+		case 180: return _bits->get(_bits->width() - 1 - x, _bits->height() - 1 - y);
+		case 270: return _bits->get(y, _bits->height() - 1 - x);
+		}
+		return _bits->get(x, y);
+	}
+
+	// Run-length encoded row y of the rotated matrix starting at column x, see GetPatternRow()
+	void getPatternRow(int y, PatternRow& row, int x = 0) const
+	{
+		auto head = [x](auto range) { return Range{range.begin() + x, range.end()}; };
+		auto tail = [x](auto range) { return Range{range.begin(), range.end() - x}; };
+		switch (_rotation) {
+		case 90: GetPatternRow(tail(_bits->col(_bits->width() - 1 - y)), row); break;
+		case 180: GetPatternRow(tail(_bits->row(_bits->height() - 1 - y)), row); break;
+		case 270: GetPatternRow(head(_bits->col(y)), row); return; // BitMatrix::col() runs bottom-up
+		default: GetPatternRow(head(_bits->row(y)), row, _bits->rowPitch() - _bits->width()); return;
+		}
+		// the 90 and 180 degree rows run backwards through the matrix
+		std::reverse(row.begin(), row.end());
+	}
+};
+
+} // Pdf417
+} // ZXing
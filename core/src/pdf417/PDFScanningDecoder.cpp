@@ -6,6 +6,7 @@
 
 #include "PDFScanningDecoder.h"
 
+#include "BitArray.h"
 #include "BitMatrix.h"
 #include "DecoderResult.h"
 #include "PDFBarcodeMetadata.h"
@@ -14,9 +15,14 @@
 #include "PDFDetectionResult.h"
 #include "PDFDecoder.h"
 #include "PDFModulusGF.h"
+#include "PDFRotatedBitMatrix.h"
+#include "StatsScope.h"
+#include "TraceScope.h"
 #include "ZXAlgorithms.h"
 #include "ZXTestSupport.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 
 namespace ZXing {
@@ -28,7 +34,7 @@ static const int MAX_EC_CODEWORDS = 512;
 
 using ModuleBitCountType = std::array<int, CodewordDecoder::BARS_IN_MODULE>;
 
-static int AdjustCodewordStartColumn(const BitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int codewordStartColumn, int imageRow)
+static int AdjustCodewordStartColumn(const RotatedBitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int codewordStartColumn, int imageRow)
 {
 	int correctedStartColumn = codewordStartColumn;
 	int increment = leftToRight ? -1 : 1;
@@ -47,7 +53,7 @@ static int AdjustCodewordStartColumn(const BitMatrix& image, int minColumn, int
 	return correctedStartColumn;
 }
 
-static bool GetModuleBitCount(const BitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int startColumn, int imageRow, ModuleBitCountType& moduleBitCount)
+static bool GetModuleBitCount(const RotatedBitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int startColumn, int imageRow, ModuleBitCountType& moduleBitCount)
 {
 	int imageColumn = startColumn;
 	size_t moduleNumber = 0;
@@ -104,7 +110,7 @@ static int GetCodewordBucketNumber(int codeword)
 	return GetCodewordBucketNumber(GetBitCountForCodeword(codeword));
 }
 
-static Nullable<Codeword> DetectCodeword(const BitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int startColumn, int imageRow, int minCodewordWidth, int maxCodewordWidth)
+static Nullable<Codeword> DetectCodeword(const RotatedBitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int startColumn, int imageRow, int minCodewordWidth, int maxCodewordWidth)
 {
 	startColumn = AdjustCodewordStartColumn(image, minColumn, maxColumn, leftToRight, startColumn, imageRow);
 	// we usually know fairly exact now how long a codeword is. We should provide minimum and maximum expected length
@@ -155,7 +161,7 @@ static Nullable<Codeword> DetectCodeword(const BitMatrix& image, int minColumn,
 	return nullptr;
 }
 
-static DetectionResultColumn GetRowIndicatorColumn(const BitMatrix& image, const BoundingBox& boundingBox, const ResultPoint& startPoint, bool leftToRight, int minCodewordWidth, int maxCodewordWidth)
+static DetectionResultColumn GetRowIndicatorColumn(const RotatedBitMatrix& image, const BoundingBox& boundingBox, const ResultPoint& startPoint, bool leftToRight, int minCodewordWidth, int maxCodewordWidth)
 {
 	DetectionResultColumn rowIndicatorColumn(boundingBox, leftToRight ? DetectionResultColumn::RowIndicator::Left : DetectionResultColumn::RowIndicator::Right);
 	for (int i = 0; i < 2; i++) {
@@ -304,12 +310,14 @@ static int GetStartColumn(const DetectionResult& detectionResult, int barcodeCol
 	return leftToRight ? detectionResult.getBoundingBox().value().minX() : detectionResult.getBoundingBox().value().maxX();
 }
 
-static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResult& detectionResult)
+// The votes for all codewords of a symbol, row by row with barcodeColumnCount() + 2 columns (including the row
+// indicators). The storage is reused for every symbol to not hit the allocator on pages full of PDF417 symbols.
+static std::vector<BarcodeValue>& CreateBarcodeMatrix(DetectionResult& detectionResult)
 {
-	std::vector<std::vector<BarcodeValue>> barcodeMatrix(detectionResult.barcodeRowCount());
-	for (auto& row : barcodeMatrix) {
-		row.resize(detectionResult.barcodeColumnCount() + 2);
-	}
+	thread_local std::vector<BarcodeValue> barcodeMatrix;
+	const int rowCount = detectionResult.barcodeRowCount();
+	const int columnCount = detectionResult.barcodeColumnCount() + 2;
+	barcodeMatrix.assign(rowCount * columnCount, {});
 
 	int column = 0;
 	for (auto& resultColumn : detectionResult.allColumns()) {
@@ -318,11 +326,11 @@ static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResul
 				if (codeword != nullptr) {
 					int rowNumber = codeword.value().rowNumber();
 					if (rowNumber >= 0) {
-						if (rowNumber >= Size(barcodeMatrix)) {
+						if (rowNumber >= rowCount) {
 							// We have more rows than the barcode metadata allows for, ignore them.
 							continue;
 						}
-						barcodeMatrix[rowNumber][column].setValue(codeword.value().value());
+						barcodeMatrix[rowNumber * columnCount + column].setValue(codeword.value().value());
 					}
 				}
 			}
@@ -337,20 +345,20 @@ static int GetNumberOfECCodeWords(int barcodeECLevel)
 	return 2 << barcodeECLevel;
 }
 
-static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vector<std::vector<BarcodeValue>>& barcodeMatrix)
+static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vector<BarcodeValue>& barcodeMatrix)
 {
-	auto numberOfCodewords = barcodeMatrix[0][1].value();
+	auto numberOfCodewords = barcodeMatrix[1].value();
 	int calculatedNumberOfCodewords = detectionResult.barcodeColumnCount() * detectionResult.barcodeRowCount() - GetNumberOfECCodeWords(detectionResult.barcodeECLevel());
 	if (calculatedNumberOfCodewords < 1 || calculatedNumberOfCodewords > CodewordDecoder::MAX_CODEWORDS_IN_BARCODE)
 		calculatedNumberOfCodewords = 0;
 	if (numberOfCodewords.empty()) {
 		if (!calculatedNumberOfCodewords)
 			return false;
-		barcodeMatrix[0][1].setValue(calculatedNumberOfCodewords);
+		barcodeMatrix[1].setValue(calculatedNumberOfCodewords);
 	}
 	else if (calculatedNumberOfCodewords && numberOfCodewords[0] != calculatedNumberOfCodewords) {
 		// The calculated one is more reliable as it is derived from the row indicator columns
-		barcodeMatrix[0][1].setValue(calculatedNumberOfCodewords);
+		barcodeMatrix[1].setValue(calculatedNumberOfCodewords);
 	}
 	return true;
 }
@@ -377,7 +385,7 @@ static bool RunEuclideanAlgorithm(ModulusPoly a, ModulusPoly b, int R, ModulusPo
 	ModulusPoly t = field.one();
 
 	// Run Euclidean algorithm until r's degree is less than R/2
-	while (r.degree() >= R / 2) {
+	while (2 * r.degree() >= R) {
 		ModulusPoly rLastLast = rLast;
 		ModulusPoly tLastLast = tLast;
 		rLast = r;
@@ -413,12 +421,13 @@ static bool RunEuclideanAlgorithm(ModulusPoly a, ModulusPoly b, int R, ModulusPo
 	return true;
 }
 
-static bool FindErrorLocations(const ModulusPoly& errorLocator, std::vector<int>& result)
+using ECArray = std::array<int, MAX_EC_CODEWORDS>;
+
+static bool FindErrorLocations(const ModulusPoly& errorLocator, ECArray& result)
 {
 	const ModulusGF& field = GetModulusGF();
 	// This is a direct application of Chien's search
 	int numErrors = errorLocator.degree();
-	result.resize(numErrors);
 	int e = 0;
 	for (int i = 1; i < field.size() && e < numErrors; i++) {
 		if (errorLocator.evaluateAt(i) == 0) {
@@ -429,25 +438,24 @@ static bool FindErrorLocations(const ModulusPoly& errorLocator, std::vector<int>
 	return e == numErrors;
 }
 
-static std::vector<int> FindErrorMagnitudes(const ModulusPoly& errorEvaluator, const ModulusPoly& errorLocator, const std::vector<int>& errorLocations)
+static void FindErrorMagnitudes(const ModulusPoly& errorEvaluator, const ModulusPoly& errorLocator, const ECArray& errorLocations,
+								ECArray& result)
 {
 	const ModulusGF& field = GetModulusGF();
 	int errorLocatorDegree = errorLocator.degree();
-	std::vector<int> formalDerivativeCoefficients(errorLocatorDegree);
+	std::array<int, MAX_EC_CODEWORDS> formalDerivativeCoefficients;
 	for (int i = 1; i <= errorLocatorDegree; i++) {
 		formalDerivativeCoefficients[errorLocatorDegree - i] = field.multiply(i, errorLocator.coefficient(i));
 	}
 
-	ModulusPoly formalDerivative(field, formalDerivativeCoefficients);
+	ModulusPoly formalDerivative(field, formalDerivativeCoefficients.data(), errorLocatorDegree);
 	// This is directly applying Forney's Formula
-	std::vector<int> result(errorLocations.size());
-	for (size_t i = 0; i < result.size(); i++) {
+	for (int i = 0; i < errorLocatorDegree; i++) {
 		int xiInverse = field.inverse(errorLocations[i]);
 		int numerator = field.subtract(0, errorEvaluator.evaluateAt(xiInverse));
 		int denominator = field.inverse(formalDerivative.evaluateAt(xiInverse));
 		result[i] = field.multiply(numerator, denominator);
 	}
-	return result;
 }
 
 /**
@@ -457,59 +465,70 @@ static std::vector<int> FindErrorMagnitudes(const ModulusPoly& errorEvaluator, c
 * @return false if errors cannot be corrected, maybe because of too many errors
 */
 ZXING_EXPORT_TEST_ONLY
-bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const std::vector<int>& erasures [[maybe_unused]], int& nbErrors)
+bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const std::vector<int>& erasures, int& nbErrors)
 {
+	if (numECCodewords < 1 || numECCodewords > MAX_EC_CODEWORDS || Size(erasures) > numECCodewords) {
+		return false;
+	}
+
 	const ModulusGF& field = GetModulusGF();
-	ModulusPoly poly(field, received);
-	std::vector<int> S(numECCodewords);
-	bool error = false;
-	for (int i = numECCodewords; i > 0; i--) {
-		int eval = poly.evaluateAt(field.exp(i));
-		S[numECCodewords - i] = eval;
-		if (eval != 0) {
-			error = true;
+	// Evaluate the received polynomial at a^numECCodewords ... a^1 in a single pass over the codewords
+	// (Horner's method for all points side by side), S is stored highest degree first.
+	ECArray S, points;
+	for (int i = 0; i < numECCodewords; i++) {
+		S[i] = 0;
+		points[i] = field.exp(numECCodewords - i);
+	}
+	for (int c : received) {
+		for (int i = 0; i < numECCodewords; i++) {
+			S[i] = field.add(field.multiply(points[i], S[i]), c);
 		}
 	}
-
-	if (!error) {
+	if (std::all_of(S.begin(), S.begin() + numECCodewords, [](int s) { return s == 0; })) {
 		nbErrors = 0;
 		return true;
 	}
 
-//	ModulusPoly knownErrors = field.one();
-//	for (int erasure : erasures) {
-//		int b = field.exp(Size(received) - 1 - erasure);
-//		// Add (1 - bx) term:
-//		ModulusPoly term(field, { field.subtract(0, b), 1 });
-//		knownErrors = knownErrors.multiply(term);
-//	}
-
-	ModulusPoly syndrome(field, S);
-//	syndrome = syndrome.multiply(knownErrors);
+	ModulusPoly knownErrors = field.one();
+	for (int erasure : erasures) {
+		int b = field.exp(Size(received) - 1 - erasure);
+		// Add (1 - bx) term:
+		ModulusPoly term(field, { field.subtract(0, b), 1 });
+		knownErrors = knownErrors.multiply(term);
+		// With known erasure locations, only the remaining errors have to be located, using the modified
+		// syndrome S(x) * knownErrors(x) mod x^numECCodewords. Each erasure costs one EC codeword, each error two.
+		for (int i = 0; i < numECCodewords - 1; i++) {
+			S[i] = field.subtract(S[i], field.multiply(b, S[i + 1]));
+		}
+	}
 
+	ModulusPoly syndrome(field, S.data(), numECCodewords);
 	ModulusPoly sigma, omega;
-	if (!RunEuclideanAlgorithm(field.buildMonomial(numECCodewords, 1), syndrome, numECCodewords, sigma, omega)) {
+	if (!RunEuclideanAlgorithm(field.buildMonomial(numECCodewords, 1), syndrome, numECCodewords + Size(erasures), sigma, omega)) {
+		return false;
+	}
+	// a non-zero syndrome without any error to locate can't be corrected
+	if ((sigma.degree() == 0 && erasures.empty()) || 2 * sigma.degree() + Size(erasures) > numECCodewords) {
 		return false;
 	}
 
-//	sigma = sigma.multiply(knownErrors);
+	sigma = sigma.multiply(knownErrors);
 
-	std::vector<int> errorLocations;
+	ECArray errorLocations, errorMagnitudes;
 	if (!FindErrorLocations(sigma, errorLocations)) {
 		return false;
 	}
-
-	std::vector<int> errorMagnitudes = FindErrorMagnitudes(omega, sigma, errorLocations);
+	FindErrorMagnitudes(omega, sigma, errorLocations, errorMagnitudes);
 
 	int receivedSize = Size(received);
-	for (size_t i = 0; i < errorLocations.size(); i++) {
+	for (int i = 0; i < sigma.degree(); i++) {
 		int position = receivedSize - 1 - field.log(errorLocations[i]);
 		if (position < 0) {
 			return false;
 		}
 		received[position] = field.subtract(received[position], errorMagnitudes[i]);
 	}
-	nbErrors = Size(errorLocations);
+	nbErrors = sigma.degree();
 	return true;
 }
 
@@ -526,13 +545,21 @@ bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const
 */
 static bool CorrectErrors(std::vector<int>& codewords, const std::vector<int>& erasures, int numECCodewords, int& errorCount)
 {
+	ZX_TRACE_SCOPE("Pdf417::CorrectErrors");
+	StatsScope scope(DecodeStats::Stage::ECC);
 	if (Size(erasures) > numECCodewords / 2 + MAX_ERRORS ||
 		numECCodewords < 0 ||
 		numECCodewords > MAX_EC_CODEWORDS) {
 		// Too many errors or EC Codewords is corrupted
+		CountStat(DecodeStats::Counter::ECFailures);
 		return false;
 	}
-	return DecodeErrorCorrection(codewords, numECCodewords, erasures, errorCount);
+	bool success = DecodeErrorCorrection(codewords, numECCodewords, erasures, errorCount);
+	if (success)
+		CountStat(DecodeStats::Counter::ECCorrections, errorCount);
+	else
+		CountStat(DecodeStats::Counter::ECFailures);
+	return success;
 }
 
 /**
@@ -568,6 +595,7 @@ static bool VerifyCodewordCount(std::vector<int>& codewords, int numECCodewords)
 
 static DecoderResult DecodeCodewords(std::vector<int>& codewords, int numECCodewords, const std::vector<int>& erasures)
 {
+	StatsScope scope(DecodeStats::Stage::Decode);
 	if (codewords.empty())
 		return FormatError();
 
@@ -578,8 +606,11 @@ static DecoderResult DecodeCodewords(std::vector<int>& codewords, int numECCodew
 	if (!VerifyCodewordCount(codewords, numECCodewords))
 		return FormatError();
 
+	// each erasure costs one EC codeword, each other error two
+	float ecUsage = std::clamp(float(2 * correctedErrorsCount - Size(erasures)) / numECCodewords, 0.f, 1.f);
+
 	// Decode the codewords
-	return Decode(codewords).setEcLevel(std::to_string(numECCodewords * 100 / Size(codewords)) + "%");
+	return Decode(codewords).setEcLevel(std::to_string(numECCodewords * 100 / Size(codewords)) + "%").setEcUsage(ecUsage);
 }
 
 DecoderResult DecodeCodewords(std::vector<int>& codewords, int numECCodeWords)
@@ -587,15 +618,56 @@ DecoderResult DecodeCodewords(std::vector<int>& codewords, int numECCodeWords)
 	for (auto& cw : codewords)
 		cw = std::clamp(cw, 0, CodewordDecoder::MAX_CODEWORDS_IN_BARCODE);
 
-	// erasures array has never been actually used inside the error correction code
 	return DecodeCodewords(codewords, numECCodeWords, {});
 }
 
+DecoderResult DecodeModules(const BitMatrix& modules)
+{
+	constexpr int CW = CodewordDecoder::MODULES_IN_CODEWORD;
+
+	// start pattern, left row indicator, data columns, right row indicator and the 18 modules wide stop pattern
+	int numCols = (modules.width() - 1) / CW - 4;
+	if (numCols < 1 || modules.width() != (numCols + 4) * CW + 1)
+		return FormatError("Invalid PDF417 module matrix width");
+
+	// col -1 is the left row indicator
+	auto readCodeword = [&](int y, int col) {
+		int symbol = 0;
+		for (int x = (col + 2) * CW; x < (col + 3) * CW; ++x)
+			AppendBit(symbol, modules.get(x, y));
+		return CodewordDecoder::GetCodeword(symbol);
+	};
+
+	std::vector<int> codewords;
+	codewords.reserve(numCols * modules.height());
+	int numRows = 0;
+	int ecLevel = -1;
+	for (int y = 0; y < modules.height(); ++y) {
+		// the module rows of one codeword row are identical, those of neighboring ones never are (different clusters)
+		if (y > 0 && std::equal(modules.row(y).begin(), modules.row(y).end(), modules.row(y - 1).begin()))
+			continue;
+		// the left row indicator of the second row (cluster 3) holds the error correction level
+		if (numRows == 1) {
+			int indicator = readCodeword(y, -1);
+			if (indicator == -1)
+				return FormatError("Invalid PDF417 row indicator");
+			ecLevel = (indicator % 30) / 3;
+		}
+		for (int col = 0; col < numCols; ++col)
+			codewords.push_back(readCodeword(y, col));
+		++numRows;
+	}
+
+	if (numRows < 3)
+		return FormatError("Invalid PDF417 module matrix height");
+
+	return DecodeCodewords(codewords, NumECCodeWords(ecLevel));
+}
+
 
 /**
-* This method deals with the fact, that the decoding process doesn't always yield a single most likely value. The
-* current error correction implementation doesn't deal with erasures very well, so it's better to provide a value
-* for these ambiguous codewords instead of treating it as an erasure. The problem is that we don't know which of
+* This method deals with the fact, that the decoding process doesn't always yield a single most likely value. We
+* first treat these ambiguous codewords as erasures. If there are too many of them for that, we don't know which of
 * the ambiguous values to choose. We try decode using the first value, and if that fails, we use another of the
 * ambiguous values and try to decode again. This usually only happens on very hard to read and decode barcodes,
 * so decoding the normal barcodes is not affected by this.
@@ -604,15 +676,27 @@ DecoderResult DecodeCodewords(std::vector<int>& codewords, int numECCodeWords)
 * @param ambiguousIndexes array with the indexes that have more than one most likely value
 * @param ambiguousIndexValues two dimensional array that contains the ambiguous values. The first dimension must
 * be the same length as the ambiguousIndexes array
+* @param deadline stop trying further combinations once this has passed
 */
 static DecoderResult CreateDecoderResultFromAmbiguousValues(int ecLevel, std::vector<int>& codewords,
 	const std::vector<int>& erasureArray, const std::vector<int>& ambiguousIndexes,
-	const std::vector<std::vector<int>>& ambiguousIndexValues)
+	const std::vector<std::vector<int>>& ambiguousIndexValues, Deadline deadline)
 {
+	if (!ambiguousIndexes.empty()) {
+		// First treat the ambiguous codewords as erasures. That needs a single error correction run and
+		// succeeds whenever there are enough EC codewords left, which is the common case.
+		auto erasures = erasureArray;
+		erasures.insert(erasures.end(), ambiguousIndexes.begin(), ambiguousIndexes.end());
+		auto received = codewords;
+		auto result = DecodeCodewords(received, NumECCodeWords(ecLevel), erasures);
+		if (result.isValid())
+			return result;
+	}
+
 	std::vector<int> ambiguousIndexCount(ambiguousIndexes.size(), 0);
 
 	int tries = 100;
-	while (tries-- > 0) {
+	while (tries-- > 0 && !IsExpired(deadline)) {
 		for (size_t i = 0; i < ambiguousIndexCount.size(); i++) {
 			codewords[ambiguousIndexes[i]] = ambiguousIndexValues[i][ambiguousIndexCount[i]];
 		}
@@ -641,9 +725,9 @@ static DecoderResult CreateDecoderResultFromAmbiguousValues(int ecLevel, std::ve
 }
 
 
-static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
+static DecoderResult CreateDecoderResult(DetectionResult& detectionResult, Deadline deadline)
 {
-	auto barcodeMatrix = CreateBarcodeMatrix(detectionResult);
+	auto& barcodeMatrix = CreateBarcodeMatrix(detectionResult);
 	if (!AdjustCodewordCount(detectionResult, barcodeMatrix)) {
 		return {};
 	}
@@ -653,7 +737,7 @@ static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
 	std::vector<int> ambiguousIndexesList;
 	for (int row = 0; row < detectionResult.barcodeRowCount(); row++) {
 		for (int column = 0; column < detectionResult.barcodeColumnCount(); column++) {
-			auto values = barcodeMatrix[row][column + 1].value();
+			auto values = barcodeMatrix[row * (detectionResult.barcodeColumnCount() + 2) + column + 1].value();
 			int codewordIndex = row * detectionResult.barcodeColumnCount() + column;
 			if (values.empty()) {
 				erasures.push_back(codewordIndex);
@@ -663,12 +747,12 @@ static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
 			}
 			else {
 				ambiguousIndexesList.push_back(codewordIndex);
-				ambiguousIndexValues.push_back(values);
+				ambiguousIndexValues.emplace_back(values.begin(), values.end());
 			}
 		}
 	}
 	return CreateDecoderResultFromAmbiguousValues(detectionResult.barcodeECLevel(), codewords, erasures,
-												  ambiguousIndexesList, ambiguousIndexValues);
+												  ambiguousIndexesList, ambiguousIndexValues, deadline);
 }
 
 
@@ -677,9 +761,9 @@ static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
 // This approach also allows detecting more details about the barcode, e.g. if a bar type (white or black) is wider 
 // than it should be. This can happen if the scanner used a bad blackpoint.
 DecoderResult
-ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& imageTopLeft, const Nullable<ResultPoint>& imageBottomLeft,
+ScanningDecoder::Decode(const RotatedBitMatrix& image, const Nullable<ResultPoint>& imageTopLeft, const Nullable<ResultPoint>& imageBottomLeft,
 	const Nullable<ResultPoint>& imageTopRight, const Nullable<ResultPoint>& imageBottomRight,
-	int minCodewordWidth, int maxCodewordWidth)
+	int minCodewordWidth, int maxCodewordWidth, Deadline deadline)
 {
 	BoundingBox boundingBox;
 	if (!BoundingBox::Create(image.width(), image.height(), imageTopLeft, imageBottomLeft, imageTopRight, imageBottomRight, boundingBox)) {
@@ -739,7 +823,7 @@ ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& ima
 			}
 		}
 	}
-	return CreateDecoderResult(detectionResult);
+	return CreateDecoderResult(detectionResult, deadline);
 }
 
 } // Pdf417
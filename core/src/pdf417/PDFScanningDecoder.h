@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "Deadline.h"
+
 #include <vector>
 
 namespace ZXing {
@@ -17,16 +19,18 @@ template <typename T> class Nullable;
 
 namespace Pdf417 {
 
+class RotatedBitMatrix;
+
 /**
 * @author Guenther Grau
 */
 class ScanningDecoder
 {
 public:
-	static DecoderResult Decode(const BitMatrix& image,
+	static DecoderResult Decode(const RotatedBitMatrix& image,
 		const Nullable<ResultPoint>& imageTopLeft, const Nullable<ResultPoint>& imageBottomLeft,
 		const Nullable<ResultPoint>& imageTopRight, const Nullable<ResultPoint>& imageBottomRight,
-		int minCodewordWidth, int maxCodewordWidth);
+		int minCodewordWidth, int maxCodewordWidth, Deadline deadline = Deadline::max());
 };
 
 inline int NumECCodeWords(int ecLevel)
@@ -36,5 +40,11 @@ inline int NumECCodeWords(int ecLevel)
 
 DecoderResult DecodeCodewords(std::vector<int>& codewords, int numECCodeWords);
 
+/**
+* Decodes an upright symbol given as its module matrix without quiet zone (e.g. from the Writer), no detection involved.
+* The rows may be any number of modules high.
+*/
+DecoderResult DecodeModules(const BitMatrix& modules);
+
 } // Pdf417
 } // ZXing
@@ -9,6 +9,7 @@
 #include "BitMatrix.h"
 #include "Utf.h"
 
+#include <algorithm>
 #include <utility>
 
 namespace ZXing {
@@ -68,13 +69,8 @@ static BitMatrix BitMatrixFromBitArray(const std::vector<std::vector<bool>>& inp
 	return result;
 }
 
-BitMatrix
-Writer::encode(const std::wstring& contents, int width, int height) const
+static BitMatrix Render(const BarcodeMatrix& resultMatrix, int width, int height, int margin)
 {
-	int margin = _margin >= 0 ? _margin : WHITE_SPACE;
-	int ecLevel = _ecLevel >= 0 ? _ecLevel : DEFAULT_ERROR_CORRECTION_LEVEL;
-
-	BarcodeMatrix resultMatrix = _encoder->generateBarcodeLogic(contents, ecLevel);
 	int aspectRatio = 4; // keep in sync with MODULE_RATIO in PDFEncoder.cpp
 	std::vector<std::vector<bool>> originalScale;
 	resultMatrix.getScaledMatrix(1, aspectRatio, originalScale);
@@ -112,8 +108,22 @@ Writer::encode(const std::wstring& contents, int width, int height) const
 	}
 }
 
+BitMatrix
+Writer::encode(const std::wstring& contents, int width, int height) const
+{
+	int margin = _margin >= 0 ? _margin : WHITE_SPACE;
+	int ecLevel = _ecLevel >= 0 ? _ecLevel : DEFAULT_ERROR_CORRECTION_LEVEL;
+	return Render(_encoder->generateBarcodeLogic(contents, ecLevel), width, height, margin);
+}
+
 BitMatrix Writer::encode(const std::string& contents, int width, int height) const
 {
+	// pure ASCII content is encoded directly, without the conversion to a wide string
+	if (std::all_of(contents.begin(), contents.end(), [](char c) { return (c & 0x80) == 0; })) {
+		int margin = _margin >= 0 ? _margin : WHITE_SPACE;
+		int ecLevel = _ecLevel >= 0 ? _ecLevel : DEFAULT_ERROR_CORRECTION_LEVEL;
+		return Render(_encoder->generateBarcodeLogic(contents, ecLevel), width, height, margin);
+	}
 	return encode(FromUtf8(contents), width, height);
 }
 
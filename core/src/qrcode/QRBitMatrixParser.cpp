@@ -13,7 +13,11 @@
 #include "QRFormatInformation.h"
 #include "QRVersion.h"
 
+#include <array>
+#include <cstdint>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 namespace ZXing::QRCode {
 
@@ -93,38 +97,60 @@ FormatInformation ReadFormatInformation(const BitMatrix& bitMatrix)
 	return FormatInformation::DecodeQR(formatInfoBits1, formatInfoBits2);
 }
 
-static ByteArray ReadQRCodewords(const BitMatrix& bitMatrix, const Version& version, const FormatInformation& formatInfo)
+struct DataModule
+{
+	uint8_t x, y;
+};
+
+// The positions of all data modules of a Model2 or Micro QR code version, for the (Micro) QR code in the order in
+// which they are read: column pairs from right to left, alternatingly from bottom to top and top to bottom. The
+// tables are built once per version on first use, so that reading the codewords is a linear pass over them.
+static const std::vector<DataModule>& DataModules(const Version& version)
 {
-	BitMatrix functionPattern = version.buildFunctionPattern();
+	constexpr int NUM_VERSIONS = 40 + 4;
+	static std::array<std::once_flag, NUM_VERSIONS> once;
+	static std::array<std::vector<DataModule>, NUM_VERSIONS> tables;
 
+	const bool isMicro = version.isMicro();
+	const int index = version.versionNumber() - 1 + isMicro * 40;
+	std::call_once(once[index], [&] {
+		BitMatrix functionPattern = version.buildFunctionPattern();
+		auto& res = tables[index];
+		bool readingUp = true;
+		int dimension = version.dimension();
+		// Read columns in pairs, from right to left
+		for (int x = dimension - 1; x > 0; x -= 2) {
+			// Skip whole column with vertical timing pattern.
+			if (x == 6 && !isMicro)
+				x--;
+			// Read alternatingly from bottom to top then top to bottom
+			for (int row = 0; row < dimension; row++) {
+				int y = readingUp ? dimension - 1 - row : row;
+				for (int col = 0; col < 2; col++) {
+					int xx = x - col;
+					// Ignore bits covered by the function pattern
+					if (!functionPattern.get(xx, y))
+						res.push_back({narrow_cast<uint8_t>(xx), narrow_cast<uint8_t>(y)});
+				}
+			}
+			readingUp = !readingUp; // switch directions
+		}
+	});
+
+	return tables[index];
+}
+
+static ByteArray ReadQRCodewords(const BitMatrix& bitMatrix, const Version& version, const FormatInformation& formatInfo)
+{
 	ByteArray result;
 	result.reserve(version.totalCodewords());
 	uint8_t currentByte = 0;
-	bool readingUp = true;
 	int bitsRead = 0;
-	int dimension = bitMatrix.height();
-	// Read columns in pairs, from right to left
-	for (int x = dimension - 1; x > 0; x -= 2) {
-		// Skip whole column with vertical timing pattern.
-		if (x == 6)
-			x--;
-		// Read alternatingly from bottom to top then top to bottom
-		for (int row = 0; row < dimension; row++) {
-			int y = readingUp ? dimension - 1 - row : row;
-			for (int col = 0; col < 2; col++) {
-				int xx = x - col;
-				// Ignore bits covered by the function pattern
-				if (!functionPattern.get(xx, y)) {
-					// Read a bit
-					AppendBit(currentByte,
-							  GetDataMaskBit(formatInfo.dataMask, xx, y) != getBit(bitMatrix, xx, y, formatInfo.isMirrored));
-					// If we've made a whole byte, save it off
-					if (++bitsRead % 8 == 0)
-						result.push_back(std::exchange(currentByte, 0));
-				}
-			}
-		}
-		readingUp = !readingUp; // switch directions
+	for (auto [x, y] : DataModules(version)) {
+		AppendBit(currentByte, GetDataMaskBit(formatInfo.dataMask, x, y) != getBit(bitMatrix, x, y, formatInfo.isMirrored));
+		// If we've made a whole byte, save it off
+		if (++bitsRead % 8 == 0)
+			result.push_back(std::exchange(currentByte, 0));
 	}
 	if (Size(result) != version.totalCodewords())
 		return {};
@@ -193,8 +219,6 @@ static ByteArray ReadQRCodewordsModel1(const BitMatrix& bitMatrix, const Version
 
 static ByteArray ReadMQRCodewords(const BitMatrix& bitMatrix, const QRCode::Version& version, const FormatInformation& formatInfo)
 {
-	BitMatrix functionPattern = version.buildFunctionPattern();
-
 	// D3 in a Version M1 symbol, D11 in a Version M3-L symbol and D9
 	// in a Version M3-M symbol is a 2x2 square 4-module block.
 	// See ISO 18004:2006 6.7.3.
@@ -205,31 +229,15 @@ static ByteArray ReadMQRCodewords(const BitMatrix& bitMatrix, const QRCode::Vers
 	ByteArray result;
 	result.reserve(version.totalCodewords());
 	uint8_t currentByte = 0;
-	bool readingUp = true;
 	int bitsRead = 0;
-	int dimension = bitMatrix.height();
-	// Read columns in pairs, from right to left
-	for (int x = dimension - 1; x > 0; x -= 2) {
-		// Read alternatingly from bottom to top then top to bottom
-		for (int row = 0; row < dimension; row++) {
-			int y = readingUp ? dimension - 1 - row : row;
-			for (int col = 0; col < 2; col++) {
-				int xx = x - col;
-				// Ignore bits covered by the function pattern
-				if (!functionPattern.get(xx, y)) {
-					// Read a bit
-					AppendBit(currentByte,
-							  GetDataMaskBit(formatInfo.dataMask, xx, y, true) != getBit(bitMatrix, xx, y, formatInfo.isMirrored));
-					++bitsRead;
-					// If we've made a whole byte, save it off; save early if 2x2 data block.
-					if (bitsRead == 8 || (bitsRead == 4 && hasD4mBlock && Size(result) == d4mBlockIndex - 1)) {
-						result.push_back(std::exchange(currentByte, 0));
-						bitsRead = 0;
-					}
-				}
-			}
+	for (auto [x, y] : DataModules(version)) {
+		AppendBit(currentByte, GetDataMaskBit(formatInfo.dataMask, x, y, true) != getBit(bitMatrix, x, y, formatInfo.isMirrored));
+		++bitsRead;
+		// If we've made a whole byte, save it off; save early if 2x2 data block.
+		if (bitsRead == 8 || (bitsRead == 4 && hasD4mBlock && Size(result) == d4mBlockIndex - 1)) {
+			result.push_back(std::exchange(currentByte, 0));
+			bitsRead = 0;
 		}
-		readingUp = !readingUp; // switch directions
 	}
 	if (Size(result) != version.totalCodewords())
 		return {};
@@ -239,6 +247,9 @@ static ByteArray ReadMQRCodewords(const BitMatrix& bitMatrix, const QRCode::Vers
 
 ByteArray ReadCodewords(const BitMatrix& bitMatrix, const Version& version, const FormatInformation& formatInfo)
 {
+	if (bitMatrix.height() != version.dimension())
+		return {};
+
 	switch (version.type()) {
 	case Type::Micro: return ReadMQRCodewords(bitMatrix, version, formatInfo);
 	case Type::Model1: return ReadQRCodewordsModel1(bitMatrix, version, formatInfo);
@@ -17,6 +17,7 @@
 #include "QRFormatInformation.h"
 #include "QRVersion.h"
 #include "ReedSolomonDecoder.h"
+#include "StatsScope.h"
 #include "StructuredAppend.h"
 #include "ZXAlgorithms.h"
 #include "ZXTestSupport.h"
@@ -34,16 +35,20 @@ namespace ZXing::QRCode {
 *
 * @param codewordBytes data and error correction codewords
 * @param numDataCodewords number of codewords that are data bytes
+* @param ecUsage updated to the maximum of its value and the used fraction of the correction capacity of this block
 * @return false if error correction fails
 */
-static bool CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
+static bool CorrectErrors(ByteArray& codewordBytes, int numDataCodewords, float& ecUsage)
 {
-	// First read into an array of ints
-	std::vector<int> codewordsInts(codewordBytes.begin(), codewordBytes.end());
+	// First read into an array of ints (reused for all blocks)
+	thread_local std::vector<int> codewordsInts;
+	codewordsInts.assign(codewordBytes.begin(), codewordBytes.end());
 
 	int numECCodewords = Size(codewordBytes) - numDataCodewords;
-	if (!ReedSolomonDecode(GenericGF::QRCodeField256(), codewordsInts, numECCodewords))
+	int numCorrections = 0;
+	if (!ReedSolomonDecode(GenericGF::QRCodeField256(), codewordsInts, numECCodewords, &numCorrections))
 		return false;
+	ecUsage = std::max(ecUsage, std::min(1.f, 2.f * numCorrections / numECCodewords));
 
 	// Copy back into array of bytes -- only need to worry about the bytes that were data
 	// We don't care about errors in the error-correction codewords
@@ -133,7 +138,8 @@ static char ToAlphaNumericChar(int value)
 static void DecodeAlphanumericSegment(BitSource& bits, int count, Content& result)
 {
 	// Read two characters at a time
-	std::string buffer;
+	thread_local std::string buffer;
+	buffer.clear();
 	while (count > 1) {
 		int nextTwoCharsBits = bits.readBits(11);
 		buffer += ToAlphaNumericChar(nextTwoCharsBits / 45);
@@ -234,6 +240,8 @@ DecoderResult DecodeBitStream(ByteArray&& bytes, const Version& version, ErrorCo
 	Content result;
 	Error error;
 	result.symbology = {'Q', version.isModel1() ? '0' : '1', 1};
+	// numeric mode is the densest one with 3 digits per 10 bits (plus an AIM application indicator of 2 digits)
+	result.reserve(Size(bytes) * 8 * 3 / 10 + 2);
 	StructuredAppendInfo structuredAppend;
 	const int modeBitLength = CodecModeBitsLength(version);
 
@@ -319,8 +327,44 @@ DecoderResult DecodeBitStream(ByteArray&& bytes, const Version& version, ErrorCo
 		.setStructuredAppend(structuredAppend);
 }
 
+namespace {
+
+// Reading the same symbol again (consecutive video frames, downscaled layers, multiple finder pattern sets, ...) results
+// in exactly the same raw codewords. The last few successfully decoded ones are kept per thread to skip the error
+// correction and the bit stream parsing in that case. The codewords are compared in full, so a hit can never return
+// the content of a different symbol.
+struct CachedDecoderResult
+{
+	ByteArray codewords; // key, together with the version and the ec level
+	int versionNumber = 0;
+	Type type = Type::Model2;
+	ErrorCorrectionLevel ecLevel = ErrorCorrectionLevel::Invalid;
+
+	Content content;
+	StructuredAppendInfo structuredAppend;
+	float ecUsage = 0;
+
+	DecoderResult result(bool isMirrored) const
+	{
+		return DecoderResult(Content(content))
+			.setEcLevel(ToString(ecLevel))
+			.setVersionNumber(versionNumber)
+			.setStructuredAppend(structuredAppend)
+			.setIsMirrored(isMirrored)
+			.setEcUsage(ecUsage);
+	}
+};
+
+constexpr int DECODER_CACHE_SIZE = 4;
+
+// most recently used entry first
+thread_local std::vector<CachedDecoderResult> decoderCache;
+
+} // namespace
+
 DecoderResult Decode(const BitMatrix& bits)
 {
+	StatsScope scope(DecodeStats::Stage::Decode);
 	if (!Version::HasValidSize(bits))
 		return FormatError("Invalid symbol size");
 
@@ -339,6 +383,15 @@ DecoderResult Decode(const BitMatrix& bits)
 	if (codewords.empty())
 		return FormatError("Failed to read codewords");
 
+	auto cached = FindIf(decoderCache, [&](const CachedDecoderResult& c) {
+		return c.versionNumber == version.versionNumber() && c.type == version.type() && c.ecLevel == formatInfo.ecLevel
+			   && c.codewords == codewords;
+	});
+	if (cached != decoderCache.end()) {
+		std::rotate(decoderCache.begin(), cached, cached + 1);
+		return decoderCache.front().result(formatInfo.isMirrored);
+	}
+
 	// Separate into data blocks
 	std::vector<DataBlock> dataBlocks = DataBlock::GetDataBlocks(codewords, version, formatInfo.ecLevel);
 	if (dataBlocks.empty())
@@ -351,19 +404,38 @@ DecoderResult Decode(const BitMatrix& bits)
 	auto resultIterator = resultBytes.begin();
 
 	// Error-correct and copy data blocks together into a stream of bytes
+	float ecUsage = 0;
 	for (auto& dataBlock : dataBlocks)
 	{
 		ByteArray& codewordBytes = dataBlock.codewords();
 		int numDataCodewords = dataBlock.numDataCodewords();
 
-		if (!CorrectErrors(codewordBytes, numDataCodewords))
+		if (!CorrectErrors(codewordBytes, numDataCodewords, ecUsage))
 			return ChecksumError();
 
 		resultIterator = std::copy_n(codewordBytes.begin(), numDataCodewords, resultIterator);
 	}
 
 	// Decode the contents of that stream of bytes
-	return DecodeBitStream(std::move(resultBytes), version, formatInfo.ecLevel).setIsMirrored(formatInfo.isMirrored);
+	auto res = DecodeBitStream(std::move(resultBytes), version, formatInfo.ecLevel)
+				   .setIsMirrored(formatInfo.isMirrored)
+				   .setEcUsage(ecUsage);
+
+	if (res.isValid()) {
+		if (Size(decoderCache) < DECODER_CACHE_SIZE)
+			decoderCache.emplace_back();
+		std::rotate(decoderCache.begin(), decoderCache.end() - 1, decoderCache.end());
+		auto& c = decoderCache.front();
+		c.codewords = std::move(codewords);
+		c.versionNumber = version.versionNumber();
+		c.type = version.type();
+		c.ecLevel = formatInfo.ecLevel;
+		c.content = res.content();
+		c.structuredAppend = res.structuredAppend();
+		c.ecUsage = ecUsage;
+	}
+
+	return res;
 }
 
 } // namespace ZXing::QRCode
@@ -7,6 +7,7 @@
 
 #include "QRDetector.h"
 
+#include "BinaryBitmap.h"
 #include "BitArray.h"
 #include "BitMatrix.h"
 #include "BitMatrixCursor.h"
@@ -14,12 +15,15 @@
 #include "GridSampler.h"
 #include "LogMatrix.h"
 #include "Pattern.h"
+#include "PerspectiveTransform.h"
 #include "QRFormatInformation.h"
 #include "QRVersion.h"
 #include "Quadrilateral.h"
 #include "RegressionLine.h"
 
 #include <algorithm>
+#include <array>
+#include <climits>
 #include <cmath>
 #include <cstdlib>
 #include <iterator>
@@ -48,7 +52,8 @@ PatternView FindPattern(const PatternView& view)
 	});
 }
 
-std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder)
+std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder, Deadline deadline,
+												  const BinaryBitmap* rowCache, float minModuleSize, float maxModuleSize)
 {
 	constexpr int MIN_SKIP         = 3;           // 1 pixel/module times 3 modules/center
 	constexpr int MAX_MODULES_FAST = 20 * 4 + 17; // support up to version 20 for mobile clients
@@ -61,24 +66,31 @@ std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool t
 	int skip = (3 * height) / (4 * MAX_MODULES_FAST);
 	if (skip < MIN_SKIP || tryHarder)
 		skip = MIN_SKIP;
+	// the center of the smallest expected pattern is still crossed by at least one row
+	skip = std::max(skip, static_cast<int>(3 * minModuleSize));
+
+	// the width of the pattern along a row is 7 modules, with some slack for binarization errors, perspective and (up to
+	// 45 degree) rotation
+	const int minWidth = static_cast<int>(7 * 0.7f * minModuleSize);
+	const int maxWidth = maxModuleSize > 0 ? static_cast<int>(std::ceil(7 * 1.5f * maxModuleSize)) : INT_MAX;
 
 	std::vector<ConcentricPattern> res;
 	[[maybe_unused]] int N = 0;
-	PatternRow row;
+	PatternRow buffer;
 
-	for (int y = skip - 1; y < height; y += skip) {
-		GetPatternRow(image, y, row, false);
+	for (int y = skip - 1; y < height && !IsExpired(deadline); y += skip) {
+		PatternView row = rowCache ? rowCache->getBitMatrixPatternRow(y) : (GetPatternRow(image, y, buffer, false), PatternView(buffer));
 		PatternView next = row;
 
 		while (next = FindPattern(next), next.isValid()) {
 			PointF p(next.pixelsInFront() + next[0] + next[1] + next[2] / 2.0, y + 0.5);
+			const int width = Reduce(next);
 
 			// make sure p is not 'inside' an already found pattern area
-			if (FindIf(res, [p](const auto& old) { return distance(p, old) < old.size / 2; }) == res.end()) {
+			if (width >= minWidth && width <= maxWidth && FindIf(res, [p](const auto& old) { return distance(p, old) < old.size / 2; }) == res.end()) {
 				log(p);
 				N++;
-				auto pattern = LocateConcentricPattern<E2E>(image, PATTERN, p,
-															Reduce(next) * 3); // 3 for very skewed samples
+				auto pattern = LocateConcentricPattern<E2E>(image, PATTERN, p, width * 3); // 3 for very skewed samples
 				if (pattern) {
 					log(*pattern, 3);
 					log(*pattern + PointF(.2, 0), 3);
@@ -121,17 +133,33 @@ FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns)
 	const double cosUpper = std::cos(45. / 180 * 3.1415); // TODO: use c++20 std::numbers::pi_v
 	const double cosLower = std::cos(135. / 180 * 3.1415);
 
+	// The module count check below limits the sum of the two shorter (scaled) sides of a valid triangle to
+	// (177 * 1.5 - 7) * 2 * (a.size + b.size + c.size) / 21. The (unscaled) distance between any two of its
+	// patterns is at most that sum and b.size, c.size <= 2 * a.size. So only the patterns close to a (relative to
+	// its size) can be part of a valid set, which turns the triple loop below into a loop over pairs of neighbors.
+	// E.g. a sheet of small codes usually has only a few neighbors per pattern.
+	constexpr double MAX_DIST_PER_SIZE = (177 * 1.5 - 7) * 2 * 5 / 21. + 1;
+	std::vector<const ConcentricPattern*> neighbors;
+
 	int nbPatterns = Size(patterns);
 	for (int i = 0; i < nbPatterns - 2; i++) {
-		for (int j = i + 1; j < nbPatterns - 1; j++) {
-			for (int k = j + 1; k < nbPatterns - 0; k++) {
+		const double maxDist2 = std::pow(MAX_DIST_PER_SIZE * patterns[i].size, 2);
+		auto isNear = [maxDist2](const auto& p, const auto& q) { return dot(p - q, p - q) <= maxDist2; };
+
+		// the list is sorted, so the pattern sizes are too different to be part of the same symbol after the first
+		// one that is more than twice as large
+		neighbors.clear();
+		for (int j = i + 1; j < nbPatterns && patterns[j].size <= patterns[i].size * 2; j++)
+			if (isNear(patterns[i], patterns[j]))
+				neighbors.push_back(&patterns[j]);
+
+		for (int j = 0; j < Size(neighbors) - 1; j++) {
+			for (int k = j + 1; k < Size(neighbors); k++) {
 				const auto* a = &patterns[i];
-				const auto* b = &patterns[j];
-				const auto* c = &patterns[k];
-				// if the pattern sizes are too different to be part of the same symbol, skip this
-				// and the rest of the innermost loop (sorted list)
-				if (c->size > a->size * 2)
-					break;
+				const auto* b = neighbors[j];
+				const auto* c = neighbors[k];
+				if (!isNear(*b, *c))
+					continue;
 
 				// Orders the three points in an order [A,B,C] such that AB is less than AC
 				// and BC is less than AC, and the angle between BC and BA is less than 180 degrees.
@@ -202,6 +230,33 @@ FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns)
 	return res;
 }
 
+std::optional<FinderPatternSet> LocateFinderPatternSet(const BitMatrix& image, const QuadrilateralF& position, int dimension)
+{
+	auto mod2Pix = PerspectiveTransform(Rectangle(dimension, dimension), position);
+	if (!mod2Pix.isValid())
+		return {};
+
+	// the search range of a finder pattern of 7 modules, see FindFinderPatterns
+	const int range = static_cast<int>(
+		(distance(position[0], position[1]) + distance(position[0], position[3])) / (2 * dimension) * 7 * 3);
+
+	// start the search at the expected center of the pattern, which needs to be (still) black
+	auto locate = [&](double x, double y) -> std::optional<ConcentricPattern> {
+		auto p = mod2Pix({x, y});
+		if (!image.isIn(p) || !image.get(PointI(p)))
+			return {};
+		return LocateConcentricPattern<E2E>(image, PATTERN, p, range);
+	};
+
+	auto tl = locate(3.5, 3.5);
+	auto tr = tl ? locate(dimension - 3.5, 3.5) : std::nullopt;
+	auto bl = tr ? locate(3.5, dimension - 3.5) : std::nullopt;
+	if (!bl)
+		return {};
+
+	return FinderPatternSet{*bl, *tl, *tr};
+}
+
 static double EstimateModuleSize(const BitMatrix& image, ConcentricPattern a, ConcentricPattern b)
 {
 	BitMatrixCursorF cur(image, a, b - a);
@@ -342,7 +397,7 @@ static const Version* ReadVersion(const BitMatrix& image, int dimension, const P
 	return Version::DecodeVersionInformation(bits[0], bits[1]);
 }
 
-DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp)
+DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp, const LumSource* lum)
 {
 	auto top  = EstimateDimension(image, fp.tl, fp.tr);
 	auto left = EstimateDimension(image, fp.tl, fp.bl);
@@ -499,11 +554,12 @@ DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp)
 													 {*apP(x, y), *apP(x + 1, y), *apP(x + 1, y + 1), *apP(x, y + 1)}}});
 			}
 
-		return SampleGrid(image, dimension, dimension, rois);
+		return lum ? SampleGrid(*lum, dimension, dimension, rois) : SampleGrid(image, dimension, dimension, rois);
 #endif
 	}
 
-	return SampleGrid(image, dimension, dimension, mod2Pix);
+	return lum ? SampleGrid(*lum, dimension, dimension, {ROI{0, dimension, 0, dimension, mod2Pix}})
+			   : SampleGrid(image, dimension, dimension, mod2Pix);
 }
 
 /**
@@ -601,8 +657,31 @@ DetectorResult DetectPureMQR(const BitMatrix& image)
 			{{left, top}, {right, top}, {right, bottom}, {left, bottom}}};
 }
 
+/**
+ * Cheap test whether fp can be the finder pattern of a Micro QR Code symbol: it is surrounded by a ring of light modules
+ * (the separator and the quiet zone), whereas most other candidates (e.g. in the data area of a QR Code symbol)
+ * have dark modules right next to their outer dark ring. Looking from the center in 8 directions, the outer dark ring
+ * must not be considerably wider than the inner light one, which is crossed at the same angle.
+ */
+static bool HasLightSurroundings(const BitMatrix& image, const ConcentricPattern& fp)
+{
+	int darkNeighbors = 0;
+	for (auto d : {PointI{1, 0}, {2, 1}, {1, 1}, {1, 2}, {0, 1}, {-1, 2}, {-1, 1}, {-2, 1}, {-1, 0}, {-2, -1}, {-1, -1}, {-1, -2},
+				   {0, -1}, {1, -2}, {1, -1}, {2, -1}}) {
+		// center, inner light ring, outer dark ring
+		auto pattern = BitMatrixCursorI(image, PointI(fp), d).readPattern<std::array<int, 3>>(fp.size * 2);
+		// tolerate a missing ring (e.g. at the image border) and one dark neighbor (e.g. image noise at a corner)
+		if (pattern[2] && 4 * pattern[2] > 7 * pattern[1] + 4 && ++darkNeighbors > 1)
+			return false;
+	}
+	return true;
+}
+
 DetectorResult SampleMQR(const BitMatrix& image, const ConcentricPattern& fp)
 {
+	if (!HasLightSurroundings(image, fp))
+		return {};
+
 	auto fpQuad = FindConcentricPatternCorners(image, fp, fp.size, 2);
 	if (!fpQuad)
 		return {};
@@ -625,7 +704,7 @@ DetectorResult SampleMQR(const BitMatrix& image, const ConcentricPattern& fp)
 
 		auto check = [&](int i, bool checkOne) {
 			auto p = mod2Pix(centered(FORMAT_INFO_COORDS[i]));
-			return image.isIn(p) && (!checkOne || image.get(p));
+			return image.isIn(p) && (!checkOne || image.getUnchecked(p));
 		};
 
 		// check that we see both innermost timing pattern modules
@@ -654,7 +733,7 @@ DetectorResult SampleMQR(const BitMatrix& image, const ConcentricPattern& fp)
 	for (int i = 0; i < dim; ++i) {
 		auto px = bestPT(centered(PointI{i, dim}));
 		auto py = bestPT(centered(PointI{dim, i}));
-		blackPixels += (image.isIn(px) && image.get(px)) + (image.isIn(py) && image.get(py));
+		blackPixels += (image.isIn(px) && image.getUnchecked(px)) + (image.isIn(py) && image.getUnchecked(py));
 	}
 	if (blackPixels > 2 * dim / 3)
 		return {};
@@ -8,14 +8,19 @@
 #pragma once
 
 #include "ConcentricFinder.h"
+#include "Deadline.h"
 #include "DetectorResult.h"
+#include "Quadrilateral.h"
 
+#include <optional>
 #include <vector>
 
 namespace ZXing {
 
 class DetectorResult;
+class BinaryBitmap;
 class BitMatrix;
+struct LumSource;
 
 namespace QRCode {
 
@@ -27,10 +32,20 @@ struct FinderPatternSet
 using FinderPatterns = std::vector<ConcentricPattern>;
 using FinderPatternSets = std::vector<FinderPatternSet>;
 
-FinderPatterns FindFinderPatterns(const BitMatrix& image, bool tryHarder);
+// rowCache (optional) provides the cached pattern rows of image, see BinaryBitmap::getBitMatrixPatternRow()
+// minModuleSize/maxModuleSize (optional) the expected module size range in pixels, see BinaryBitmap::setModuleSizeRange()
+FinderPatterns FindFinderPatterns(const BitMatrix& image, bool tryHarder, Deadline deadline = Deadline::max(),
+								  const BinaryBitmap* rowCache = nullptr, float minModuleSize = 0, float maxModuleSize = 0);
 FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns);
 
-DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp);
+// Locate the finder patterns of a symbol with the given dimension that was found at position (see
+// DetectorResult::position()) in a previous image, e.g. the last frame of a video stream. This only succeeds if the
+// symbol did not move by more than about a module.
+std::optional<FinderPatternSet> LocateFinderPatternSet(const BitMatrix& image, const QuadrilateralF& position, int dimension);
+
+// lum (optional) is the luminance image image was binarized from, the modules are then sampled from there (the geometry
+// is still determined on image), see DecodeHints::tryLuminanceSampling()
+DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp, const LumSource* lum = nullptr);
 DetectorResult SampleMQR(const BitMatrix& image, const ConcentricPattern& fp);
 
 DetectorResult DetectPureQR(const BitMatrix& image);
@@ -15,6 +15,7 @@
 #include "QRMatrixUtil.h"
 #include "ReedSolomonEncoder.h"
 #include "TextEncoder.h"
+#include "Utf.h"
 #include "ZXTestSupport.h"
 
 #include <algorithm>
@@ -142,7 +143,7 @@ void AppendLengthInfo(int numLetters, const Version& version, CodecMode mode, Bi
 }
 
 ZXING_EXPORT_TEST_ONLY
-void AppendNumericBytes(const std::wstring& content, BitArray& bits)
+void AppendNumericBytes(std::string_view content, BitArray& bits)
 {
 	size_t length = content.length();
 	size_t i = 0;
@@ -170,17 +171,17 @@ void AppendNumericBytes(const std::wstring& content, BitArray& bits)
 }
 
 ZXING_EXPORT_TEST_ONLY
-void AppendAlphanumericBytes(const std::wstring& content, BitArray& bits)
+void AppendAlphanumericBytes(std::string_view content, BitArray& bits)
 {
 	size_t length = content.length();
 	size_t i = 0;
 	while (i < length) {
-		int code1 = GetAlphanumericCode(content[i]);
+		int code1 = GetAlphanumericCode(static_cast<uint8_t>(content[i]));
 		if (code1 == -1) {
 			throw std::invalid_argument("Unexpected contents");
 		}
 		if (i + 1 < length) {
-			int code2 = GetAlphanumericCode(content[i + 1]);
+			int code2 = GetAlphanumericCode(static_cast<uint8_t>(content[i + 1]));
 			if (code2 == -1) {
 				throw std::invalid_argument("Unexpected contents");
 			}
@@ -197,7 +198,7 @@ void AppendAlphanumericBytes(const std::wstring& content, BitArray& bits)
 }
 
 ZXING_EXPORT_TEST_ONLY
-void Append8BitBytes(const std::wstring& content, CharacterSet encoding, BitArray& bits)
+void Append8BitBytes(std::string_view content, CharacterSet encoding, BitArray& bits)
 {
 	for (char b : TextEncoder::FromUnicode(content, encoding)) {
 		bits.appendBits(b, 8);
@@ -205,7 +206,7 @@ void Append8BitBytes(const std::wstring& content, CharacterSet encoding, BitArra
 }
 
 ZXING_EXPORT_TEST_ONLY
-void AppendKanjiBytes(const std::wstring& content, BitArray& bits)
+void AppendKanjiBytes(std::string_view content, BitArray& bits)
 {
 	std::string bytes = TextEncoder::FromUnicode(content, CharacterSet::Shift_JIS);
 	int length = Size(bytes);
@@ -233,10 +234,10 @@ void AppendKanjiBytes(const std::wstring& content, BitArray& bits)
 }
 
 /**
-* Append "bytes" in "mode" mode (encoding) into "bits". On success, store the result in "bits".
+* Append the utf8 encoded "content" in "mode" mode (encoding) into "bits". On success, store the result in "bits".
 */
 ZXING_EXPORT_TEST_ONLY
-void AppendBytes(const std::wstring& content, CodecMode mode, CharacterSet encoding, BitArray& bits)
+void AppendBytes(std::string_view content, CodecMode mode, CharacterSet encoding, BitArray& bits)
 {
 	switch (mode) {
 	case CodecMode::NUMERIC:      AppendNumericBytes(content, bits); break;
@@ -247,6 +248,176 @@ void AppendBytes(const std::wstring& content, CodecMode mode, CharacterSet encod
 	}
 }
 
+struct Segment
+{
+	CodecMode mode;
+	int begin, end; // range of characters in the content
+};
+
+struct CharInfo
+{
+	int pos;         // byte offset of the character in the utf8 content
+	int code;        // unicode code point
+	int8_t numBytes; // in byte mode with the chosen character set
+	bool isKanji;    // can be encoded in kanji mode
+};
+
+static constexpr CodecMode SEGMENT_MODES[] = {CodecMode::NUMERIC, CodecMode::ALPHANUMERIC, CodecMode::BYTE, CodecMode::KANJI};
+
+static int NumBytes(std::string_view utf8Char, int code, CharacterSet charset)
+{
+	switch (charset) {
+	case CharacterSet::UTF8: return Size(utf8Char);
+	case CharacterSet::UTF16BE:
+	case CharacterSet::UTF16LE: return code > 0xffff ? 4 : 2;
+	case CharacterSet::UTF32BE:
+	case CharacterSet::UTF32LE: return 4;
+	default: return code < 0x80 ? 1 : Size(TextEncoder::FromUnicode(utf8Char, charset));
+	}
+}
+
+/**
+* Decodes the utf8 content into one CharInfo per code point plus a terminating entry with pos == content.size().
+*/
+static std::vector<CharInfo> AnalyzeContent(std::string_view content, CharacterSet charset)
+{
+	std::vector<CharInfo> infos;
+	infos.reserve(content.size() + 1);
+	for (int pos = 0; pos < Size(content);) {
+		int start = pos;
+		int code = Utf8NextCodePoint(content, pos);
+		if (code == -1)
+			throw std::invalid_argument("Invalid UTF-8 content");
+		auto utf8Char = content.substr(start, pos - start);
+		CharInfo info = {start, code, narrow_cast<int8_t>(NumBytes(utf8Char, code, charset)), false};
+		// only use kanji mode if Shift_JIS is requested, see ChooseMode()
+		if (charset == CharacterSet::Shift_JIS && code >= 0x80) {
+			auto bytes = TextEncoder::FromUnicode(utf8Char, CharacterSet::Shift_JIS);
+			int sjis = Size(bytes) == 2 ? (bytes[0] & 0xff) << 8 | (bytes[1] & 0xff) : 0;
+			info.isKanji = (sjis >= 0x8140 && sjis <= 0x9ffc) || (sjis >= 0xe040 && sjis <= 0xebbf);
+		}
+		infos.push_back(info);
+	}
+	infos.push_back({Size(content), 0, 0, false});
+	return infos;
+}
+
+/**
+* Split the content into segments such that the encoded bit stream is as short as possible for the given version (the
+* size of the character count indicators only changes between versions 9/10 and 26/27). For each character and each
+* mode, the cheapest encoding of the prefix that ends in a segment of that mode is computed from the previous one, i.e.
+* this runs in linear time. Costs are measured in 1/6 bits, which makes the 10 bits per 3 digits and 11 bits per 2
+* alphanumeric characters exact once a segment is closed (rounded up to full bits).
+*/
+static std::vector<Segment> ChooseSegments(const std::vector<CharInfo>& infos, const Version& version)
+{
+	constexpr int NUM_MODES = Size(SEGMENT_MODES);
+	constexpr int INF = std::numeric_limits<int>::max() / 2;
+
+	const int numChars = Size(infos) - 1;
+	if (numChars == 0)
+		return {{CodecMode::BYTE, 0, 0}};
+
+	std::array<int, NUM_MODES> headCosts;
+	for (int m = 0; m < NUM_MODES; ++m)
+		headCosts[m] = (4 + CharacterCountBits(SEGMENT_MODES[m], version)) * 6;
+
+	// charModes[i][m]: the mode char i is encoded with if the prefix [0, i] ends in mode m, -1 if impossible
+	std::vector<std::array<int8_t, NUM_MODES>> charModes(numChars);
+	auto costs = headCosts;
+	for (int i = 0; i < numChars; ++i) {
+		int c = infos[i].code;
+		std::array<int, NUM_MODES> cur;
+		cur.fill(INF);
+		charModes[i].fill(-1);
+
+		auto extend = [&](int m, int cost) {
+			cur[m] = costs[m] + cost;
+			charModes[i][m] = narrow_cast<int8_t>(m);
+		};
+		if (c >= '0' && c <= '9')
+			extend(0, 20);
+		if (GetAlphanumericCode(c) != -1)
+			extend(1, 33);
+		extend(2, infos[i].numBytes * 8 * 6);
+		if (infos[i].isKanji)
+			extend(3, 13 * 6);
+
+		// switch to a new segment after this character if that is cheaper
+		auto ends = cur;
+		for (int to = 0; to < NUM_MODES; ++to)
+			for (int from = 0; from < NUM_MODES; ++from) {
+				if (ends[from] == INF)
+					continue;
+				int cost = (ends[from] + 5) / 6 * 6 + headCosts[to];
+				if (cost < cur[to]) {
+					cur[to] = cost;
+					charModes[i][to] = narrow_cast<int8_t>(from);
+				}
+			}
+		costs = cur;
+	}
+
+	int mode = 0;
+	for (int m = 1; m < NUM_MODES; ++m)
+		if ((costs[m] + 5) / 6 < (costs[mode] + 5) / 6)
+			mode = m;
+
+	std::vector<Segment> segments;
+	for (int i = numChars - 1; i >= 0; --i) {
+		mode = charModes[i][mode];
+		if (segments.empty() || segments.back().mode != SEGMENT_MODES[mode])
+			segments.push_back({SEGMENT_MODES[mode], i, i + 1});
+		else
+			segments.back().begin = i;
+	}
+	std::reverse(segments.begin(), segments.end());
+	return segments;
+}
+
+/**
+* @return the number of bits of the encoded segments (incl. mode and character count indicators) for the given version
+* or -1 if a segment is too long for its character count indicator. This is computed from the character counts alone,
+* so all versions can be checked without encoding anything.
+*/
+static int SegmentsSize(const std::vector<Segment>& segments, const std::vector<CharInfo>& infos, const Version& version)
+{
+	int numBits = 0;
+	for (auto& s : segments) {
+		int n = s.end - s.begin;
+		int numLetters = n;
+		switch (s.mode) {
+		case CodecMode::NUMERIC: numBits += 10 * (n / 3) + std::array{0, 4, 7}[n % 3]; break;
+		case CodecMode::ALPHANUMERIC: numBits += 11 * (n / 2) + 6 * (n % 2); break;
+		case CodecMode::KANJI: numBits += 13 * n; break;
+		default:
+			numLetters = 0;
+			for (int i = s.begin; i < s.end; ++i)
+				numLetters += infos[i].numBytes;
+			numBits += 8 * numLetters;
+		}
+		int countBits = CharacterCountBits(s.mode, version);
+		if (numLetters >= (1 << countBits))
+			return -1;
+		numBits += 4 + countBits;
+	}
+	return numBits;
+}
+
+static void AppendSegments(std::string_view content, const std::vector<CharInfo>& infos, const std::vector<Segment>& segments,
+						   CharacterSet charset, const Version& version, BitArray& bits)
+{
+	BitArray dataBits;
+	for (auto& s : segments) {
+		auto part = content.substr(infos[s.begin].pos, infos[s.end].pos - infos[s.begin].pos);
+		dataBits = {};
+		AppendBytes(part, s.mode, charset, dataBits);
+		AppendModeInfo(s.mode, bits);
+		AppendLengthInfo(s.mode == CodecMode::BYTE ? dataBits.sizeInBytes() : s.end - s.begin, version, s.mode, bits);
+		bits.appendBitArray(dataBits);
+	}
+}
+
 /**
 * @return true if the number of input bits will fit in a code with the specified version and
 * error correction level.
@@ -264,17 +435,6 @@ static bool WillFit(int numInputBits, const Version& version, ErrorCorrectionLev
 	return numDataBytes >= totalInputBytes;
 }
 
-static const Version& ChooseVersion(int numInputBits, ErrorCorrectionLevel ecLevel)
-{
-	for (int versionNum = 1; versionNum <= 40; versionNum++) {
-		const Version* version = Version::Model2(versionNum);
-		if (WillFit(numInputBits, *version, ecLevel)) {
-			return *version;
-		}
-	}
-	throw std::invalid_argument("Data too big");
-}
-
 /**
 * Terminate bits as described in 8.4.8 and 8.4.9 of JISX0510:2004 (p.24).
 */
@@ -442,45 +602,31 @@ BitArray InterleaveWithECBytes(const BitArray& bits, int numTotalBytes, int numD
 }
 
 
+/**
+* Choose the mask pattern with the lowest penalty and build the matrix with it.
+*/
 static int ChooseMaskPattern(const BitArray& bits, ErrorCorrectionLevel ecLevel, const Version& version, TritMatrix& matrix)
 {
-	int minPenalty = std::numeric_limits<int>::max();  // Lower penalty is better.
-	int bestMaskPattern = -1;
-	// We try all mask patterns to choose the best one.
-	for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; maskPattern++) {
-		BuildMatrix(bits, ecLevel, version, maskPattern, matrix);
-		int penalty = MaskUtil::CalculateMaskPenalty(matrix);
-		if (penalty < minPenalty) {
-			minPenalty = penalty;
-			bestMaskPattern = maskPattern;
-		}
-	}
-	return bestMaskPattern;
-}
-
-static int CalculateBitsNeeded(CodecMode mode, const BitArray& headerBits, const BitArray& dataBits, const Version& version)
-{
-	return headerBits.size() + CharacterCountBits(mode, version) + dataBits.size();
+	// We try all mask patterns to choose the best one (lower penalty is better, the first one wins a tie).
+	Matrix<uint8_t> maskFlips;
+	BuildMatrixForAllMasks(bits, ecLevel, version, matrix, maskFlips);
+	auto penalties = MaskUtil::CalculateMaskPenalties(matrix, maskFlips);
+	int maskPattern = narrow_cast<int>(std::min_element(penalties.begin(), penalties.end()) - penalties.begin());
+
+	for (int y = 0; y < matrix.height(); ++y)
+		for (int x = 0; x < matrix.width(); ++x)
+			if ((maskFlips(x, y) >> maskPattern) & 1)
+				matrix.set(x, y, !matrix.get(x, y));
+	return maskPattern;
 }
 
-/**
-* Decides the smallest version of QR code that will contain all of the provided data.
-* @throws WriterException if the data cannot fit in any version
-*/
-static const Version& RecommendVersion(ErrorCorrectionLevel ecLevel, CodecMode mode, const BitArray& headerBits, const BitArray& dataBits)
+EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet charset, int versionNumber,
+					bool useGs1Format, int maskPattern)
 {
-	// Hard part: need to know version to know how many bits length takes. But need to know how many
-	// bits it takes to know version. First we take a guess at version by assuming version will be
-	// the minimum, 1:
-	int provisionalBitsNeeded = CalculateBitsNeeded(mode, headerBits, dataBits, *Version::Model2(1));
-	const Version& provisionalVersion = ChooseVersion(provisionalBitsNeeded, ecLevel);
-
-	// Use that guess to calculate the right version. I am still not sure this works in 100% of cases.
-	int bitsNeeded = CalculateBitsNeeded(mode, headerBits, dataBits, provisionalVersion);
-	return ChooseVersion(bitsNeeded, ecLevel);
+	return Encode(std::string_view(ToUtf8(content)), ecLevel, charset, versionNumber, useGs1Format, maskPattern);
 }
 
-EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet charset, int versionNumber,
+EncodeResult Encode(std::string_view content, ErrorCorrectionLevel ecLevel, CharacterSet charset, int versionNumber,
 					bool useGs1Format, int maskPattern)
 {
 	bool charsetWasUnknown = charset == CharacterSet::Unknown;
@@ -488,18 +634,13 @@ EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, C
 		charset = DEFAULT_BYTE_MODE_ENCODING;
 	}
 
-	// Pick an encoding mode appropriate for the content. Note that this will not attempt to use
-	// multiple modes / segments even if that were more efficient. Twould be nice.
-	CodecMode mode = ChooseMode(content, charset);
+	auto infos = AnalyzeContent(content, charset);
 
-	// This will store the header information, like mode and
-	// length, as well as "header" segments like an ECI segment.
+	// This will store the header information, like the ECI segment and the FNC1 mode indicator.
 	BitArray headerBits;
-
-	// Append ECI segment if applicable
-	if (mode == CodecMode::BYTE && !charsetWasUnknown) {
-		AppendECI(charset, headerBits);
-	}
+	BitArray eciBits;
+	if (!charsetWasUnknown)
+		AppendECI(charset, eciBits);
 
 	// Append the FNC1 mode header for GS1 formatted data if applicable
 	if (useGs1Format) {
@@ -507,38 +648,42 @@ EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, C
 		AppendModeInfo(CodecMode::FNC1_FIRST_POSITION, headerBits);
 	}
 
-	// (With ECI in place,) Write the mode marker
-	AppendModeInfo(mode, headerBits);
-
-	// Collect data within the main segment, separately, to count its size if needed. Don't add it to
-	// main payload yet.
-	BitArray dataBits;
-	AppendBytes(content, mode, charset, dataBits);
-
-	const Version* version;
-	if (versionNumber > 0) {
-		version = Version::Model2(versionNumber);
-		if (version != nullptr) {
-			int bitsNeeded = CalculateBitsNeeded(mode, headerBits, dataBits, *version);
-			if (!WillFit(bitsNeeded, *version, ecLevel)) {
-				throw std::invalid_argument("Data too big for requested version");
-			}
-		}
-		else {
-			version = &RecommendVersion(ecLevel, mode, headerBits, dataBits);
+	// The optimal segmentation depends on the size of the character count indicators, which only changes between
+	// versions 9/10 and 26/27. The number of bits is computed analytically for each of these classes, which then
+	// directly gives the smallest version that fits. Only that one is actually encoded.
+	const Version* version = nullptr;
+	std::vector<Segment> segments;
+	// The ECI segment is only needed if there is a segment in byte mode
+	auto eciSize = [&] { return FindIf(segments, [](auto& s) { return s.mode == CodecMode::BYTE; }) != segments.end() ? eciBits.size() : 0; };
+	auto numBitsFor = [&](const Version& v) {
+		segments = ChooseSegments(infos, v);
+		int numBits = SegmentsSize(segments, infos, v);
+		return numBits < 0 ? numBits : numBits + headerBits.size() + eciSize();
+	};
+
+	if (versionNumber > 0 && (version = Version::Model2(versionNumber)) != nullptr) {
+		int numBits = numBitsFor(*version);
+		if (numBits < 0 || !WillFit(numBits, *version, ecLevel))
+			throw std::invalid_argument("Data too big for requested version");
+	} else {
+		for (int first : {1, 10, 27}) {
+			int last = first == 1 ? 9 : first == 10 ? 26 : 40;
+			int numBits = numBitsFor(*Version::Model2(last));
+			for (int versionNum = first; numBits >= 0 && versionNum <= last && !version; ++versionNum)
+				if (WillFit(numBits, *Version::Model2(versionNum), ecLevel))
+					version = Version::Model2(versionNum);
+			if (version)
+				break;
 		}
-	}
-	else {
-		version = &RecommendVersion(ecLevel, mode, headerBits, dataBits);
+		if (!version)
+			throw std::invalid_argument("Data too big");
 	}
 
 	BitArray headerAndDataBits;
+	if (eciSize())
+		headerAndDataBits.appendBitArray(eciBits);
 	headerAndDataBits.appendBitArray(headerBits);
-	// Find "length" of main segment and write it
-	int numLetters = mode == CodecMode::BYTE ? dataBits.sizeInBytes() : Size(content);
-	AppendLengthInfo(numLetters, *version, mode, headerAndDataBits);
-	// Put data together into the overall payload
-	headerAndDataBits.appendBitArray(dataBits);
+	AppendSegments(content, infos, segments, charset, *version, headerAndDataBits);
 
 	auto& ecBlocks = version->ecBlocksForLevel(ecLevel);
 	int numDataBytes = version->totalCodewords() - ecBlocks.totalCodewords();
@@ -552,16 +697,18 @@ EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, C
 
 	EncodeResult output;
 	output.ecLevel = ecLevel;
-	output.mode = mode;
+	output.mode = segments.front().mode;
 	output.version = version;
 
-	//  Choose the mask pattern and set to "qrCode".
+	// Build the matrix with the requested or the best mask pattern.
 	int dimension = version->dimension();
 	TritMatrix matrix(dimension, dimension);
-	output.maskPattern = maskPattern != -1 ? maskPattern : ChooseMaskPattern(finalBits, ecLevel, *version, matrix);
-
-	// Build the matrix and set it to "qrCode".
-	BuildMatrix(finalBits, ecLevel, *version, output.maskPattern, matrix);
+	if (maskPattern != -1) {
+		output.maskPattern = maskPattern;
+		BuildMatrix(finalBits, ecLevel, *version, output.maskPattern, matrix);
+	} else {
+		output.maskPattern = ChooseMaskPattern(finalBits, ecLevel, *version, matrix);
+	}
 
 	output.matrix = ToBitMatrix(matrix);
 
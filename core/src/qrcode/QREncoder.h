@@ -9,6 +9,7 @@
 #include "CharacterSet.h"
 
 #include <string>
+#include <string_view>
 
 namespace ZXing::QRCode {
 
@@ -18,4 +19,8 @@ class EncodeResult;
 EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet encoding, int versionNumber,
 					bool useGs1Format, int maskPattern = -1);
 
+// content is utf8 encoded, it is analyzed and converted to the requested character set without an intermediate wide string
+EncodeResult Encode(std::string_view content, ErrorCorrectionLevel ecLevel, CharacterSet encoding, int versionNumber,
+					bool useGs1Format, int maskPattern = -1);
+
 } // namespace ZXing::QRCode
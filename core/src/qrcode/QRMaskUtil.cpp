@@ -6,11 +6,13 @@
 
 #include "QRMaskUtil.h"
 
+#include "BitHacks.h"
+
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
-#include <utility>
 
 namespace ZXing::QRCode::MaskUtil {
 
@@ -20,135 +22,267 @@ static const int N2 = 3;
 static const int N3 = 40;
 static const int N4 = 10;
 
-/**
-* Helper function for applyMaskPenaltyRule1. We need this for doing this calculation in both
-* vertical and horizontal orders respectively.
-*/
-static int ApplyMaskPenaltyRule1Internal(const TritMatrix& matrix, bool isHorizontal)
+// All rules are evaluated on the rows and columns of the matrix packed into bit sets, so each rule boils down to a
+// handful of shifts and logic operations per 64 modules (the result is identical to checking module by module).
+// Bit j of a line is the module at position j, all bits beyond the end of the line are 0. The rules are evaluated
+// with only as many words as the symbol needs (1 up to version 10, 2 up to version 25).
+constexpr int MAX_SIZE = 177; // version 40
+constexpr int WORD_SIZE = 64;
+constexpr int MAX_WORDS = (MAX_SIZE + WORD_SIZE - 1) / WORD_SIZE;
+
+template <int WORDS>
+class Line
 {
-	int penalty = 0;
-	int width = matrix.width();
-	int height = matrix.height();
-	int iLimit = isHorizontal ? height : width;
-	int jLimit = isHorizontal ? width : height;
-	for (int i = 0; i < iLimit; i++) {
-		int numSameBitCells = 0;
-		int prevBit = -1;
-		for (int j = 0; j < jLimit; j++) {
-			int bit = isHorizontal ? matrix.get(j, i) : matrix.get(i, j);
-			if (bit == prevBit) {
-				numSameBitCells++;
-			}
-			else {
-				if (numSameBitCells >= 5) {
-					penalty += N1 + (numSameBitCells - 5);
-				}
-				numSameBitCells = 1;  // Include the cell itself.
-				prevBit = bit;
-			}
-		}
-		if (numSameBitCells >= 5) {
-			penalty += N1 + (numSameBitCells - 5);
-		}
+	std::array<uint64_t, WORDS> _w = {};
+
+public:
+	Line() = default;
+
+	// the first WORDS words of o
+	template <int N>
+	explicit Line(const Line<N>& o)
+	{
+		for (int i = 0; i < WORDS; ++i)
+			_w[i] = o.word(i);
+	}
+
+	// the first n bits set
+	static Line Low(int n)
+	{
+		Line res;
+		for (int i = 0; i < WORDS && n > 0; ++i, n -= WORD_SIZE)
+			res._w[i] = n >= WORD_SIZE ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+		return res;
+	}
+
+	uint64_t& word(int i) { return _w[i]; }
+	uint64_t word(int i) const { return _w[i]; }
+
+	int count() const
+	{
+		int res = 0;
+		for (auto w : _w)
+			res += BitHacks::CountBitsSet(uint32_t(w)) + BitHacks::CountBitsSet(uint32_t(w >> 32));
+		return res;
+	}
+
+	// bit j of the result is bit j + k of this, 0 < k < 64
+	Line operator>>(int k) const
+	{
+		Line res;
+		for (int i = 0; i < WORDS; ++i)
+			res._w[i] = (_w[i] >> k) | (i + 1 < WORDS ? _w[i + 1] << (64 - k) : 0);
+		return res;
+	}
+
+	// bit j of the result is bit j - k of this, 0 < k < 64
+	Line operator<<(int k) const
+	{
+		Line res;
+		for (int i = 0; i < WORDS; ++i)
+			res._w[i] = (_w[i] << k) | (i > 0 ? _w[i - 1] >> (64 - k) : 0);
+		return res;
+	}
+
+#define ZX_LINE_OP(OP) \
+	Line operator OP(const Line& o) const \
+	{ \
+		Line res; \
+		for (int i = 0; i < WORDS; ++i) \
+			res._w[i] = _w[i] OP o._w[i]; \
+		return res; \
 	}
-	return penalty;
+
+	ZX_LINE_OP(&)
+	ZX_LINE_OP(|)
+	ZX_LINE_OP(^)
+#undef ZX_LINE_OP
+
+	Line operator~() const
+	{
+		Line res;
+		for (int i = 0; i < WORDS; ++i)
+			res._w[i] = ~_w[i];
+		return res;
+	}
+};
+
+// Transpose a 64x64 bit block in place, i.e. bit j of a[i] becomes bit i of a[j], see Hacker's Delight, 7-3
+static void Transpose(std::array<uint64_t, WORD_SIZE>& a)
+{
+	uint64_t m = 0x00000000ffffffff;
+	for (int j = 32; j != 0; j >>= 1, m ^= m << j)
+		for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+			uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+			a[k] ^= t << j;
+			a[k | j] ^= t;
+		}
+}
+
+// Transpose an 8x8 bit block, i.e. bit j of byte i becomes bit i of byte j, see Hacker's Delight, 7-3
+static uint64_t Transpose8x8(uint64_t x)
+{
+	uint64_t t;
+	t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AA, x ^= t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCC, x ^= t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0, x ^= t ^ (t << 28);
+	return x;
 }
 
 /**
-* Apply mask penalty rule 1 and return the penalty. Find repetitive cells with the same color and
+* Apply mask penalty rule 1 to one line and return the penalty. Find repetitive cells with the same color and
 * give penalty to them. Example: 00000 or 11111.
 */
-static int ApplyMaskPenaltyRule1(const TritMatrix& matrix)
+template <int W>
+static int ApplyMaskPenaltyRule1(const Line<W>& line, int n)
 {
-	return ApplyMaskPenaltyRule1Internal(matrix, true) + ApplyMaskPenaltyRule1Internal(matrix, false);
+	// bit j is set if module j and j + 1 have the same color
+	auto same = ~(line ^ (line >> 1)) & Line<W>::Low(n - 1);
+	// bit j is set if the modules j to j + 4 have the same color, i.e. a run of length L contains L - 4 of them
+	auto run5 = same & (same >> 1) & (same >> 2) & (same >> 3);
+	// a run of length L >= 5 gets a penalty of N1 + (L - 5), the first 5 module window of a run counts N1 - 1 extra
+	return run5.count() + (N1 - 1) * (run5 & ~(same << 1)).count();
 }
 
 /**
-* Apply mask penalty rule 2 and return the penalty. Find 2x2 blocks with the same color and give
-* penalty to them. This is actually equivalent to the spec's rule, which is to find MxN blocks and give a
+* Apply mask penalty rule 2 to two consecutive rows and return the penalty. Find 2x2 blocks with the same color and
+* give penalty to them. This is actually equivalent to the spec's rule, which is to find MxN blocks and give a
 * penalty proportional to (M-1)x(N-1), because this is the number of 2x2 blocks inside such a block.
 */
-static int ApplyMaskPenaltyRule2(const TritMatrix& matrix)
+template <int W>
+static int ApplyMaskPenaltyRule2(const Line<W>& row0, const Line<W>& row1, int n)
 {
-	int penalty = 0;
-	for (int y = 0; y < matrix.height() - 1; y++) {
-		for (int x = 0; x < matrix.width() - 1; x++) {
-			auto value = matrix.get(x, y);
-			if (value == matrix.get(x+1, y) && value == matrix.get(x, y+1) && value == matrix.get(x+1, y+1)) {
-				penalty++;
-			}
-		}
-	}
-	return N2 * penalty;
-}
-
-template <size_t N>
-static bool HasPatternAt(const std::array<bool, N>& pattern, const Trit* begin, int count, int stride)
-{
-	assert(std::abs(count) <= (int)N);
-	auto end = begin + count * stride;
-	if (count < 0)
-		std::swap(begin, end);
-	auto a = begin;
-	for (auto b = pattern.begin(); a < end && b != pattern.end(); a += stride, ++b)
-		if (*a != *b)
-			return false;
-	return true;
+	auto vertical = ~(row0 ^ row1);
+	auto horizontal = ~(row0 ^ (row0 >> 1));
+	return N2 * (vertical & (vertical >> 1) & horizontal & Line<W>::Low(n - 1)).count();
 }
 
 /**
-* Apply mask penalty rule 3 and return the penalty. Find consecutive runs of 1:1:3:1:1:4
+* Apply mask penalty rule 3 to one line and return the penalty. Find consecutive runs of 1:1:3:1:1:4
 * starting with black, or 4:1:1:3:1:1 starting with white, and give penalty to them.  If we
-* find patterns like 000010111010000, we give penalty once.
+* find patterns like 000010111010000, we give penalty once. Modules outside of the symbol count as white.
 */
-static int ApplyMaskPenaltyRule3(const TritMatrix& matrix)
+template <int W>
+static int ApplyMaskPenaltyRule3(const Line<W>& line, int n)
 {
-	const std::array<bool, 4> white = {0, 0, 0, 0};
-	const std::array<bool, 7> finder = {1, 0, 1, 1, 1, 0, 1};
-	const int whiteSize = Size(white);
-	const int finderSize = Size(finder);
-
-	int numPenalties = 0;
-	int width = matrix.width();
-	int height = matrix.height();
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			auto i = &matrix.get(x, y);
-			if (x <= width - finderSize && HasPatternAt(finder, i, finderSize, 1)
-				&& (HasPatternAt(white, i, -std::min(x, whiteSize), 1)
-					|| HasPatternAt(white, i + finderSize, std::min(width - x - finderSize, whiteSize), 1))) {
-				numPenalties++;
-			}
-			if (y <= height - finderSize && HasPatternAt(finder, i, finderSize, width)
-				&& (HasPatternAt(white, i, -std::min(y, whiteSize), width)
-					|| HasPatternAt(white, i + finderSize * width, std::min(height - y - finderSize, whiteSize), width))) {
-				numPenalties++;
-			}
-		}
-	}
-	return numPenalties * N3;
+	if (n < 7)
+		return 0;
+	auto finder = line & ~(line >> 1) & (line >> 2) & (line >> 3) & (line >> 4) & ~(line >> 5) & (line >> 6) & Line<W>::Low(n - 6);
+	auto whiteBefore = ~((line << 1) | (line << 2) | (line << 3) | (line << 4));
+	auto whiteAfter = ~((line >> 7) | (line >> 8) | (line >> 9) | (line >> 10));
+	return N3 * (finder & (whiteBefore | whiteAfter)).count();
 }
 
 /**
 * Apply mask penalty rule 4 and return the penalty. Calculate the ratio of dark cells and give
 * penalty if the ratio is far from 50%. It gives 10 penalty for 5% distance.
 */
-static int ApplyMaskPenaltyRule4(const TritMatrix& matrix)
+static int ApplyMaskPenaltyRule4(int numDarkCells, int numTotalCells)
 {
-	auto numDarkCells = std::count_if(matrix.begin(), matrix.end(), [](Trit cell) { return cell; });
-	auto numTotalCells = matrix.size();
 	auto fivePercentVariances = std::abs(numDarkCells * 2 - numTotalCells) * 10 / numTotalCells;
-	return narrow_cast<int>(fivePercentVariances * N4);
+	return fivePercentVariances * N4;
 }
 
+using Lines = std::array<Line<MAX_WORDS>, MAX_WORDS * WORD_SIZE>;
+
 // The mask penalty calculation is complicated.  See Table 21 of JISX0510:2004 (p.45) for details.
 // Basically it applies four rules and summate all penalties.
+template <int W>
+static int CalculateMaskPenalty(const Lines& rows, int width, int height)
+{
+	// get the columns by transposing the rows in 64x64 blocks
+	std::array<Line<W>, W * WORD_SIZE> cols;
+	std::array<uint64_t, WORD_SIZE> block;
+	for (int by = 0; by * WORD_SIZE < height; ++by)
+		for (int bx = 0; bx * WORD_SIZE < width; ++bx) {
+			for (int i = 0; i < WORD_SIZE; ++i)
+				block[i] = rows[by * WORD_SIZE + i].word(bx);
+			Transpose(block);
+			for (int i = 0; i < WORD_SIZE; ++i)
+				cols[bx * WORD_SIZE + i].word(by) = block[i];
+		}
+
+	int penalty = 0;
+	int numDarkCells = 0;
+	Line<W> row(rows[0]), next;
+	for (int y = 0; y < height; ++y) {
+		penalty += ApplyMaskPenaltyRule1(row, width) + ApplyMaskPenaltyRule3(row, width);
+		numDarkCells += row.count();
+		if (y < height - 1) {
+			next = Line<W>(rows[y + 1]);
+			penalty += ApplyMaskPenaltyRule2(row, next, width);
+			row = next;
+		}
+	}
+	for (int x = 0; x < width; ++x)
+		penalty += ApplyMaskPenaltyRule1(cols[x], height) + ApplyMaskPenaltyRule3(cols[x], height);
+
+	return penalty + ApplyMaskPenaltyRule4(numDarkCells, width * height);
+}
+
+static int CalculateMaskPenalty(const Lines& rows, int width, int height)
+{
+	assert(width <= MAX_SIZE && height <= MAX_SIZE);
+
+	switch ((std::max(width, height) + WORD_SIZE - 1) / WORD_SIZE) {
+	case 1: return CalculateMaskPenalty<1>(rows, width, height);
+	case 2: return CalculateMaskPenalty<2>(rows, width, height);
+	default: return CalculateMaskPenalty<3>(rows, width, height);
+	}
+}
+
 int CalculateMaskPenalty(const TritMatrix& matrix)
 {
-	return MaskUtil::ApplyMaskPenaltyRule1(matrix)
-		   + MaskUtil::ApplyMaskPenaltyRule2(matrix)
-		   + MaskUtil::ApplyMaskPenaltyRule3(matrix)
-		   + MaskUtil::ApplyMaskPenaltyRule4(matrix);
+	const int width = matrix.width();
+	const int height = matrix.height();
+
+	Lines rows;
+	for (int y = 0; y < height; ++y) {
+		const Trit* row = &matrix.get(0, y);
+		for (int bx = 0; bx * WORD_SIZE < width; ++bx) {
+			uint64_t w = 0;
+			for (int x = bx * WORD_SIZE, end = std::min(width, x + WORD_SIZE); x < end; ++x)
+				w |= uint64_t(row[x]) << (x % WORD_SIZE);
+			rows[y].word(bx) = w;
+		}
+	}
+
+	return CalculateMaskPenalty(rows, width, height);
+}
+
+std::array<int, NUM_MASK_PATTERNS> CalculateMaskPenalties(const TritMatrix& matrix, const Matrix<uint8_t>& maskFlips)
+{
+	const int width = matrix.width();
+	const int height = matrix.height();
+
+	// Pack the rows of all masked matrices in one pass: bit m of maskFlips goes to the lines of mask pattern m, which
+	// for 8 modules at a time is an 8x8 bit transposition.
+	std::array<Lines, NUM_MASK_PATTERNS> masked;
+	for (int y = 0; y < height; ++y) {
+		const Trit* row = &matrix.get(0, y);
+		const uint8_t* flips = &maskFlips.get(0, y);
+		for (int bx = 0; bx * WORD_SIZE < width; ++bx) {
+			uint64_t w = 0;
+			std::array<uint64_t, NUM_MASK_PATTERNS> f = {};
+			for (int x = bx * WORD_SIZE, end = std::min(width, x + WORD_SIZE); x < end; x += 8) {
+				uint64_t lanes = 0;
+				for (int i = 0; i < 8 && x + i < end; ++i) {
+					w |= uint64_t(bool(row[x + i])) << ((x + i) % WORD_SIZE);
+					lanes |= uint64_t(flips[x + i]) << (8 * i);
+				}
+				lanes = Transpose8x8(lanes);
+				for (int m = 0; m < NUM_MASK_PATTERNS; ++m)
+					f[m] |= ((lanes >> (8 * m)) & 0xff) << (x % WORD_SIZE);
+			}
+			for (int m = 0; m < NUM_MASK_PATTERNS; ++m)
+				masked[m][y].word(bx) = w ^ f[m];
+		}
+	}
+
+	std::array<int, NUM_MASK_PATTERNS> res;
+	for (int m = 0; m < NUM_MASK_PATTERNS; ++m)
+		res[m] = CalculateMaskPenalty(masked[m], width, height);
+	return res;
 }
 
 } // namespace ZXing::QRCode::MaskUtil
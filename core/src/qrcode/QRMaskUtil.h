@@ -6,10 +6,20 @@
 
 #pragma once
 
+#include "QRMatrixUtil.h"
 #include "TritMatrix.h"
 
+#include <array>
+#include <cstdint>
+
 namespace ZXing::QRCode::MaskUtil {
 
 int CalculateMaskPenalty(const TritMatrix& matrix);
 
+/**
+ * Calculate the penalties of all mask patterns for the output of BuildMatrixForAllMasks(). The modules are read and
+ * packed only once, the mask patterns are then applied to the packed rows.
+ */
+std::array<int, NUM_MASK_PATTERNS> CalculateMaskPenalties(const TritMatrix& matrix, const Matrix<uint8_t>& maskFlips);
+
 } // namespace ZXing::QRCode::MaskUtil
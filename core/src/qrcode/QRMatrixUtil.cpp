@@ -12,6 +12,7 @@
 #include "QRErrorCorrectionLevel.h"
 #include "QRVersion.h"
 
+#include <array>
 #include <stdexcept>
 #include <string>
 
@@ -180,8 +181,9 @@ static BitArray MakeTypeInfoBits(ErrorCorrectionLevel ecLevel, int maskPattern)
 	return bits;
 }
 
-// Embed type information. On success, modify the matrix.
-static void EmbedTypeInfo(ErrorCorrectionLevel ecLevel, int maskPattern, TritMatrix& matrix)
+// Call set(x, y, bit) for all type info modules. See 8.9 of JISX0510:2004 (p.46).
+template <typename SET>
+static void ForEachTypeInfoBit(ErrorCorrectionLevel ecLevel, int maskPattern, int dimension, SET set)
 {
 	// Type info cells at the left top corner.
 	constexpr PointI TYPE_INFO_COORDINATES[] = {
@@ -196,20 +198,26 @@ static void EmbedTypeInfo(ErrorCorrectionLevel ecLevel, int maskPattern, TritMat
 		// "typeInfoBits".
 		bool bit = typeInfoBits.get(typeInfoBits.size() - 1 - i);
 
-		// Type info bits at the left top corner. See 8.9 of JISX0510:2004 (p.46).
-		matrix.set(TYPE_INFO_COORDINATES[i], bit);
+		// Type info bits at the left top corner.
+		set(TYPE_INFO_COORDINATES[i].x, TYPE_INFO_COORDINATES[i].y, bit);
 
 		if (i < 8) {
 			// Right top corner.
-			matrix.set(matrix.width() - i - 1, 8, bit);
+			set(dimension - i - 1, 8, bit);
 		}
 		else {
 			// Left bottom corner.
-			matrix.set(8, matrix.height() - 7 + (i - 8), bit);
+			set(8, dimension - 7 + (i - 8), bit);
 		}
 	}
 }
 
+// Embed type information. On success, modify the matrix.
+static void EmbedTypeInfo(ErrorCorrectionLevel ecLevel, int maskPattern, TritMatrix& matrix)
+{
+	ForEachTypeInfoBit(ecLevel, maskPattern, matrix.width(), [&](int x, int y, bool bit) { matrix.set(x, y, bit); });
+}
+
 // Make bit vector of version information. On success, store the result in "bits" and return true.
 // See 8.10 of JISX0510:2004 (p.45) for details.
 static BitArray MakeVersionInfoBits(const Version& version)
@@ -250,10 +258,25 @@ static void EmbedVersionInfo(const Version& version, TritMatrix& matrix)
 	}
 }
 
+// Bit m of the result is set if the mask pattern m inverts module (x, y). All patterns repeat every 12 modules.
+static uint8_t DataMaskBits(int x, int y)
+{
+	static const auto table = [] {
+		std::array<std::array<uint8_t, 12>, 12> res = {};
+		for (int j = 0; j < 12; ++j)
+			for (int i = 0; i < 12; ++i)
+				for (int m = 0; m < NUM_MASK_PATTERNS; ++m)
+					res[j][i] |= GetDataMaskBit(m, i, j) << m;
+		return res;
+	}();
+	return table[y % 12][x % 12];
+}
+
 // Embed "dataBits" using "getMaskPattern". On success, modify the matrix and return true.
 // For debugging purposes, it skips masking process if "getMaskPattern" is -1.
+// If maskFlips is given, bit m of each data module is set if mask pattern m inverts it relative to maskPattern.
 // See 8.7 of JISX0510:2004 (p.38) for how to embed data bits.
-static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix& matrix)
+static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix& matrix, Matrix<uint8_t>* maskFlips = nullptr)
 {
 	int bitIndex = 0;
 	int direction = -1;
@@ -281,6 +304,10 @@ static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix&
 					bit = !bit;
 				}
 				matrix.set(xx, y, bit);
+				if (maskFlips) {
+					uint8_t masks = DataMaskBits(xx, y);
+					(*maskFlips)(xx, y) = masks ^ (masks & (1 << maskPattern) ? 0xff : 0);
+				}
 			}
 			y += direction;
 		}
@@ -294,9 +321,7 @@ static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix&
 	}
 }
 
-// Build 2D matrix of QR Code from "dataBits" with "ecLevel", "version" and "getMaskPattern". On
-// success, store the result in "matrix" and return true.
-void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
+static void EmbedFunctionPatterns(const Version& version, TritMatrix& matrix)
 {
 	matrix.clear();
 	// Let's get started with embedding big squares at corners.
@@ -307,6 +332,13 @@ void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const V
 	EmbedPositionAdjustmentPatterns(version, matrix);
 	// Timing patterns should be embedded after position adj. patterns.
 	EmbedTimingPatterns(matrix);
+}
+
+// Build 2D matrix of QR Code from "dataBits" with "ecLevel", "version" and "getMaskPattern". On
+// success, store the result in "matrix" and return true.
+void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
+{
+	EmbedFunctionPatterns(version, matrix);
 	// Type information appear with any version.
 	EmbedTypeInfo(ecLevel, maskPattern, matrix);
 	// Version info appear if version >= 7.
@@ -315,4 +347,19 @@ void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const V
 	EmbedDataBits(dataBits, maskPattern, matrix);
 }
 
+void BuildMatrixForAllMasks(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, TritMatrix& matrix,
+							Matrix<uint8_t>& maskFlips)
+{
+	maskFlips = Matrix<uint8_t>(matrix.width(), matrix.height());
+
+	EmbedFunctionPatterns(version, matrix);
+	EmbedTypeInfo(ecLevel, 0, matrix);
+	for (int m = 1; m < NUM_MASK_PATTERNS; ++m)
+		ForEachTypeInfoBit(ecLevel, m, matrix.width(), [&](int x, int y, bool bit) {
+			maskFlips(x, y) |= (bit != matrix.get(x, y)) << m;
+		});
+	EmbedVersionInfo(version, matrix);
+	EmbedDataBits(dataBits, 0, matrix, &maskFlips);
+}
+
 } // namespace ZXing::QRCode
@@ -8,6 +8,8 @@
 
 #include "TritMatrix.h"
 
+#include <cstdint>
+
 namespace ZXing {
 
 class BitArray;
@@ -21,5 +23,13 @@ constexpr int NUM_MASK_PATTERNS = 8;
 
 void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix);
 
+/**
+ * Build the matrix for mask pattern 0 plus the information to derive the ones for all other mask patterns: bit m of
+ * maskFlips(x, y) is set if the module (x, y) of the matrix for mask pattern m differs from the one in matrix. This
+ * way the data bits are placed only once to evaluate all mask patterns, see MaskUtil::CalculateMaskPenalties().
+ */
+void BuildMatrixForAllMasks(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, TritMatrix& matrix,
+							Matrix<uint8_t>& maskFlips);
+
 } // QRCode
 } // ZXing
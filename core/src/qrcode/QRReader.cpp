@@ -12,17 +12,42 @@
 #include "DecodeHints.h"
 #include "DecoderResult.h"
 #include "DetectorResult.h"
+#include "Executor.h"
+#include "GridSampler.h"
 #include "LogMatrix.h"
+#include "QRBitMatrixParser.h"
 #include "QRDecoder.h"
+#include "QRFormatInformation.h"
 #include "QRDetector.h"
+#include "QRVersion.h"
 #include "Result.h"
+#include "StatsScope.h"
+#include "TraceScope.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
 #include <utility>
+#include <vector>
 
 namespace ZXing::QRCode {
 
+// Without decoding, the format information and the timing patterns are what tells a symbol from three finder
+// patterns of different symbols that happen to form a plausible set, see DecodeHints::detectOnly()
+static bool IsPlausibleQR(const BitMatrix& bits)
+{
+	if (!ReadFormatInformation(bits).isValid())
+		return false;
+	const int n = bits.width();
+	int errors = 0;
+	for (int i = 8; i < n - 8; ++i)
+		errors += (bits.get(i, 6) != (i % 2 == 0)) + (bits.get(6, i) != (i % 2 == 0));
+	return errors <= (n - 16) / 4; // i.e. 1/8 of the timing pattern modules
+}
+
 Result Reader::decode(const BinaryBitmap& image) const
 {
+	ZX_TRACE_SCOPE("QRCode::Reader::decode");
 #if 1
 	if (!_hints.isPure())
 		return FirstOrDefault(decode(image, 1));
@@ -41,11 +66,63 @@ Result Reader::decode(const BinaryBitmap& image) const
 	if (!detectorResult.isValid())
 		return {};
 
-	auto decoderResult = Decode(detectorResult.bits());
+	auto format = detectorResult.bits().width() < 21 ? BarcodeFormat::MicroQRCode : BarcodeFormat::QRCode;
 	auto position = detectorResult.position();
+	if (_hints.detectOnly())
+		return Result(std::move(position), format, std::make_shared<const BitMatrix>(std::move(detectorResult).bits()));
+
+	return Result(Decode(detectorResult.bits()), std::move(position), format);
+}
+
+// Sample the symbol of fpSet from the binarized image and decode it. If that fails, try again with the modules sampled
+// from the luminance image, see DecodeHints::tryLuminanceSampling()
+static std::pair<DetectorResult, DecoderResult> SampleAndDecode(const BinaryBitmap& image, const FinderPatternSet& fpSet,
+																const DecodeHints& hints)
+{
+	auto binImg = image.getBitMatrix();
+	auto detectorResult = SampleQR(*binImg, fpSet);
+	if (!detectorResult.isValid())
+		return {};
+
+	auto decoderResult = Decode(detectorResult.bits());
+	if (!decoderResult.isValid() && hints.tryLuminanceSampling()) {
+		LumSource lum{image.buffer(), image.inverted()};
+		auto lumDetectorResult = SampleQR(*binImg, fpSet, &lum);
+		if (lumDetectorResult.isValid()) {
+			auto lumDecoderResult = Decode(lumDetectorResult.bits());
+			if (lumDecoderResult.isValid())
+				return {std::move(lumDetectorResult), std::move(lumDecoderResult)};
+		}
+	}
+
+	return {std::move(detectorResult), std::move(decoderResult)};
+}
 
-	return Result(std::move(decoderResult), std::move(position),
-				  detectorResult.bits().width() < 21 ? BarcodeFormat::MicroQRCode : BarcodeFormat::QRCode);
+Result Reader::decodeTracked(const BinaryBitmap& image, const Result& previous) const
+{
+	ZX_TRACE_SCOPE("QRCode::Reader::decodeTracked");
+	if (previous.format() != BarcodeFormat::QRCode)
+		return {};
+
+	int versionNumber = std::atoi(previous.version().c_str());
+	if (versionNumber < 1 || versionNumber > 40)
+		return {};
+
+	auto binImg = image.getBitMatrix();
+	if (binImg == nullptr)
+		return {};
+
+	const auto& pos = previous.position();
+	auto fpSet = LocateFinderPatternSet(*binImg, {pos.topLeft(), pos.topRight(), pos.bottomRight(), pos.bottomLeft()},
+										Version::DimensionOfVersion(versionNumber, false));
+	if (!fpSet)
+		return {};
+
+	auto [detectorResult, decoderResult] = SampleAndDecode(image, *fpSet, _hints);
+	if (!decoderResult.isValid())
+		return {};
+
+	return Result(std::move(decoderResult), std::move(detectorResult).position(), BarcodeFormat::QRCode);
 }
 
 void logFPSet(const FinderPatternSet& fps [[maybe_unused]])
@@ -64,71 +141,177 @@ void logFPSet(const FinderPatternSet& fps [[maybe_unused]])
 #endif
 }
 
-Results Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+// The finder pattern search is done on the first call of next(), then every call evaluates one chunk of finder pattern
+// sets and finally one remaining finder pattern after the other as a MicroQRCode.
+class Candidates : public CandidateStream
 {
-	auto binImg = image.getBitMatrix();
-	if (binImg == nullptr)
-		return {};
+	const BinaryBitmap& _image;
+	const DecodeHints& _hints;
+	const BitMatrix* _binImg = nullptr;
 
-#ifdef PRINT_DEBUG
-	LogMatrixWriter lmw(log, *binImg, 5, "qr-log.pnm");
-#endif
+	enum class Phase { Find, QR, MicroQR, Done } _phase = Phase::Find;
+	FinderPatterns _allFPs;
+	FinderPatternSets _allFPSets;
+	std::vector<ConcentricPattern> _usedFPs;
+	int _nextSet = 0, _nextFP = 0;
 
-	auto allFPs = FindFinderPatterns(*binImg, _hints.tryHarder());
+	struct Candidate
+	{
+		bool sampled = false;
+		DecoderResult decoderResult;
+		QuadrilateralI position;
+		std::shared_ptr<const BitMatrix> modules; // only with detectOnly
+	};
+	std::vector<int> _todo;
+	std::vector<Candidate> _candidates;
 
-#ifdef PRINT_DEBUG
-	printf("allFPs: %d\n", Size(allFPs));
-#endif
+	bool isUsed(const FinderPatternSet& fpSet) const
+	{
+		return Contains(_usedFPs, fpSet.bl) || Contains(_usedFPs, fpSet.tl) || Contains(_usedFPs, fpSet.tr);
+	}
 
-	std::vector<ConcentricPattern> usedFPs;
-	Results results;
+	void evaluate(int i)
+	{
+		if (IsExpired(_hints.deadline()))
+			return;
+		if (_hints.detectOnly()) {
+			auto detectorResult = SampleQR(*_binImg, _allFPSets[_todo[i]]);
+			if (detectorResult.isValid() && IsPlausibleQR(detectorResult.bits()))
+				_candidates[i] = {true, {}, detectorResult.position(), std::make_shared<const BitMatrix>(std::move(detectorResult).bits())};
+			return;
+		}
+		auto [detectorResult, decoderResult] = SampleAndDecode(_image, _allFPSets[_todo[i]], _hints);
+		if (detectorResult.isValid())
+			_candidates[i] = {true, std::move(decoderResult), std::move(detectorResult).position(), nullptr};
+	}
+
+	// With an executor, the sets are sampled and decoded speculatively in chunks of a few sets per thread. The results
+	// are then accepted in the original order, so a set is still dropped if one of its finder patterns got used by a
+	// previous set of the same chunk, just like in the sequential case (chunkSize == 1).
+	void nextChunk(Results& results)
+	{
+		auto executor = _image.executor();
+		const int chunkSize = executor ? 4 * executor->concurrency() : 1;
+
+		_todo.clear();
+		for (int end = std::min(_nextSet + chunkSize, Size(_allFPSets)); _nextSet < end; ++_nextSet)
+			if (!isUsed(_allFPSets[_nextSet]))
+				_todo.push_back(_nextSet);
+
+		_candidates.clear();
+		_candidates.resize(_todo.size());
+		if (executor && Size(_todo) > 1)
+			executor->parallelFor(Size(_todo), [this, stats = CurrentStats()](int i) {
+				StatsContext context(stats); // in case this runs on an executor thread
+				evaluate(i);
+			});
+		else
+			for (int i = 0; i < Size(_todo); ++i)
+				evaluate(i);
 
-	if (_hints.hasFormat(BarcodeFormat::QRCode)) {
-		auto allFPSets = GenerateFinderPatternSets(allFPs);
-		for (const auto& fpSet : allFPSets) {
-			if (Contains(usedFPs, fpSet.bl) || Contains(usedFPs, fpSet.tl) || Contains(usedFPs, fpSet.tr))
+		for (int i = 0; i < Size(_todo); ++i) {
+			const auto& fpSet = _allFPSets[_todo[i]];
+			if (isUsed(fpSet))
 				continue;
 
 			logFPSet(fpSet);
 
-			auto detectorResult = SampleQR(*binImg, fpSet);
-			if (detectorResult.isValid()) {
-				auto decoderResult = Decode(detectorResult.bits());
-				auto position = detectorResult.position();
-				if (decoderResult.isValid()) {
-					usedFPs.push_back(fpSet.bl);
-					usedFPs.push_back(fpSet.tl);
-					usedFPs.push_back(fpSet.tr);
-				}
-				if (decoderResult.isValid(_hints.returnErrors())) {
-					results.emplace_back(std::move(decoderResult), std::move(position), BarcodeFormat::QRCode);
-					if (maxSymbols && Size(results) == maxSymbols)
-						break;
-				}
+			auto& [sampled, decoderResult, position, modules] = _candidates[i];
+			if (!sampled)
+				continue;
+			if (decoderResult.isValid() || _hints.detectOnly()) {
+				_usedFPs.push_back(fpSet.bl);
+				_usedFPs.push_back(fpSet.tl);
+				_usedFPs.push_back(fpSet.tr);
 			}
+			if (_hints.detectOnly())
+				results.emplace_back(std::move(position), BarcodeFormat::QRCode, std::move(modules));
+			else if (decoderResult.isValid(_hints.returnErrors()))
+				results.emplace_back(std::move(decoderResult), std::move(position), BarcodeFormat::QRCode);
 		}
 	}
 
-	if (_hints.hasFormat(BarcodeFormat::MicroQRCode) && !(maxSymbols && Size(results) == maxSymbols)) {
-		for (const auto& fp : allFPs) {
-			if (Contains(usedFPs, fp))
-				continue;
+	void nextMicroQR(const ConcentricPattern& fp, Results& results)
+	{
+		auto detectorResult = SampleMQR(*_binImg, fp);
+		if (!detectorResult.isValid())
+			return;
+		if (_hints.detectOnly()) {
+			auto modules = std::make_shared<const BitMatrix>(std::move(detectorResult).bits());
+			results.emplace_back(std::move(detectorResult).position(), BarcodeFormat::MicroQRCode, std::move(modules));
+			return;
+		}
+		auto decoderResult = Decode(detectorResult.bits());
+		if (decoderResult.isValid(_hints.returnErrors()))
+			results.emplace_back(std::move(decoderResult), std::move(detectorResult).position(), BarcodeFormat::MicroQRCode);
+	}
 
-			auto detectorResult = SampleMQR(*binImg, fp);
-			if (detectorResult.isValid()) {
-				auto decoderResult = Decode(detectorResult.bits());
-				auto position = detectorResult.position();
-				if (decoderResult.isValid(_hints.returnErrors())) {
-					results.emplace_back(std::move(decoderResult), std::move(position), BarcodeFormat::MicroQRCode);
-					if (maxSymbols && Size(results) == maxSymbols)
-						break;
-				}
+public:
+	Candidates(const BinaryBitmap& image, const DecodeHints& hints) : _image(image), _hints(hints) {}
 
+	bool next(Results& results) override
+	{
+		switch (_phase) {
+		case Phase::Find:
+			_binImg = _image.getBitMatrix();
+			if (_binImg == nullptr)
+				break;
+			_allFPs = FindFinderPatterns(*_binImg, _hints.tryHarder(), _hints.deadline(), &_image, _image.minModuleSize(),
+										 _image.maxModuleSize());
+			CountStat(DecodeStats::Counter::FinderCandidates, Size(_allFPs));
+#ifdef PRINT_DEBUG
+			printf("allFPs: %d\n", Size(_allFPs));
+#endif
+			if (_hints.hasFormat(BarcodeFormat::QRCode))
+				_allFPSets = GenerateFinderPatternSets(_allFPs);
+			_phase = Phase::QR;
+			[[fallthrough]];
+		case Phase::QR:
+			if (_nextSet < Size(_allFPSets) && !IsExpired(_hints.deadline())) {
+				nextChunk(results);
+				return true;
+			}
+			_phase = Phase::MicroQR;
+			[[fallthrough]];
+		case Phase::MicroQR:
+			while (_hints.hasFormat(BarcodeFormat::MicroQRCode) && _nextFP < Size(_allFPs) && !IsExpired(_hints.deadline())) {
+				const auto& fp = _allFPs[_nextFP++];
+				if (Contains(_usedFPs, fp))
+					continue;
+				nextMicroQR(fp, results);
+				return true;
 			}
+			break;
+		case Phase::Done: break;
 		}
+		_phase = Phase::Done;
+		return false;
 	}
+};
+
+Results Reader::decode(const BinaryBitmap& image, int maxSymbols) const
+{
+	ZX_TRACE_SCOPE("QRCode::Reader::decode");
+#ifdef PRINT_DEBUG
+	auto binImg = image.getBitMatrix();
+	if (binImg == nullptr)
+		return {};
+	LogMatrixWriter lmw(log, *binImg, 5, "qr-log.pnm");
+#endif
+
+	Results results;
+	Candidates stream(image, _hints);
+	while (!(maxSymbols && Size(results) >= maxSymbols) && stream.next(results))
+		;
+	if (maxSymbols && Size(results) > maxSymbols)
+		results.erase(results.begin() + maxSymbols, results.end());
 
 	return results;
 }
 
+std::unique_ptr<CandidateStream> Reader::candidates(const BinaryBitmap& image, int) const
+{
+	return std::make_unique<Candidates>(image, _hints);
+}
+
 } // namespace ZXing::QRCode
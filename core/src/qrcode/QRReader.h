@@ -17,6 +17,11 @@ public:
 
 	Result decode(const BinaryBitmap& image) const override;
 	Results decode(const BinaryBitmap& image, int maxSymbols) const override;
+	std::unique_ptr<CandidateStream> candidates(const BinaryBitmap& image, int maxSymbols) const override;
+
+	/// Find a QR Code symbol of a previous image (e.g. the last frame of a video stream) again at (nearly) the same
+	/// position without searching the whole image, see DecodeHints::trackSymbols()
+	Result decodeTracked(const BinaryBitmap& image, const Result& previous) const;
 };
 
 } // namespace ZXing::QRCode
@@ -11,6 +11,7 @@
 #include "QRECB.h"
 
 #include <limits>
+#include <vector>
 
 namespace ZXing::QRCode {
 
@@ -430,22 +431,54 @@ int Version::Number(const BitMatrix& bitMatrix)
 	return (bitMatrix.height() - DimensionOffset(isMicro)) / DimensionStep(isMicro);
 }
 
+// The remainder of the 18 version information bits divided by the generator polynomial of its BCH code (ISO 18004:2015,
+// Annex D), which is 0 for all (valid or not) codewords and only depends on the error pattern otherwise.
+static uint32_t VersionInfoSyndrome(uint32_t bits)
+{
+	constexpr uint32_t GENERATOR = 0x1F25; // x^12 + x^11 + x^10 + x^9 + x^8 + x^5 + x^2 + 1
+	for (int i = 17; i >= 12; --i)
+		if (bits & (1 << i))
+			bits ^= GENERATOR << (i - 12);
+	return bits;
+}
+
+/**
+ * The error pattern of at most 3 bits (the ones the code can correct, no two codewords differ in less than 8 bits) for
+ * every 12 bit syndrome, or 0xFFFFFFFF if there is no such pattern.
+ */
+static const std::vector<uint32_t>& VersionInfoErrorPatterns()
+{
+	static const auto table = [] {
+		std::vector<uint32_t> res(1 << 12, 0xFFFFFFFF);
+		res[0] = 0;
+		for (int i = 0; i < 18; ++i)
+			for (int j = i; j < 18; ++j)
+				for (int k = j; k < 18; ++k) {
+					uint32_t error = (1 << i) | (1 << j) | (1 << k);
+					res[VersionInfoSyndrome(error)] = error;
+				}
+		return res;
+	}();
+	return table;
+}
+
 const Version* Version::DecodeVersionInformation(int versionBitsA, int versionBitsB)
 {
 	int bestDifference = std::numeric_limits<int>::max();
 	int bestVersion = 0;
-	int i = 0;
-	for (int targetVersion : VERSION_DECODE_INFO) {
-		for (int bits : {versionBitsA, versionBitsB}) {
-			int bitsDifference = BitHacks::CountBitsSet(bits ^ targetVersion);
-			if (bitsDifference < bestDifference) {
-				bestVersion = i + 7;
-				bestDifference = bitsDifference;
-			}
+	for (int bits : {versionBitsA, versionBitsB}) {
+		// instead of comparing the bits to all codewords, correct them and check if the result is a valid one
+		uint32_t error = VersionInfoErrorPatterns()[VersionInfoSyndrome(bits & 0x3FFFF)];
+		uint32_t codeword = (bits & 0x3FFFF) ^ error;
+		int version = codeword >> 12;
+		if (error == 0xFFFFFFFF || version < 7 || version > 40 || codeword != static_cast<uint32_t>(VERSION_DECODE_INFO[version - 7]))
+			continue;
+		// bits beyond the 18 of the codeword are all errors, of two equally near codewords the lower version wins
+		int bitsDifference = BitHacks::CountBitsSet(error) + BitHacks::CountBitsSet(static_cast<uint32_t>(bits) >> 18);
+		if (bitsDifference < bestDifference || (bitsDifference == bestDifference && version < bestVersion)) {
+			bestVersion = version;
+			bestDifference = bitsDifference;
 		}
-		if (bestDifference == 0)
-			break;
-		++i;
 	}
 	// We can tolerate up to 3 bits of error since no two version info codewords will
 	// differ in less than 8 bits.
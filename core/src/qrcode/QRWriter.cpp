@@ -30,6 +30,11 @@ Writer::Writer()
 {}
 
 BitMatrix Writer::encode(const std::wstring& contents, int width, int height) const
+{
+	return encode(ToUtf8(contents), width, height);
+}
+
+BitMatrix Writer::encode(const std::string& contents, int width, int height) const
 {
 	if (contents.empty()) {
 		throw std::invalid_argument("Found empty contents");
@@ -39,13 +44,8 @@ BitMatrix Writer::encode(const std::wstring& contents, int width, int height) co
 		throw std::invalid_argument("Requested dimensions are invalid");
 	}
 
-	EncodeResult code = Encode(contents, _ecLevel, _encoding, _version, _useGs1Format, _maskPattern);
+	EncodeResult code = Encode(std::string_view(contents), _ecLevel, _encoding, _version, _useGs1Format, _maskPattern);
 	return Inflate(std::move(code.matrix), width, height, _margin);
 }
 
-BitMatrix Writer::encode(const std::string& contents, int width, int height) const
-{
-	return encode(FromUtf8(contents), width, height);
-}
-
 } // namespace ZXing::QRCode
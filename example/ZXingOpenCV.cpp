@@ -5,27 +5,57 @@
 
 #include "ZXingOpenCV.h"
 
+#include <cctype>
 #include <iostream>
+#include <string>
 
 using namespace cv;
 
-int main()
+// Usage: ZXingOpenCV [<camera index, video file or stream url, e.g. rtsp://...> [<number of decode threads>]]
+int main(int argc, char* argv[])
 {
+	std::string source = argc > 1 ? argv[1] : "0";
+	int workers = argc > 2 ? std::stoi(argv[2]) : 0;
+
+	VideoCapture cap;
+	if (std::all_of(source.begin(), source.end(), [](unsigned char c) { return std::isdigit(c); }))
+		cap.open(std::stoi(source));
+	else
+		cap.open(source);
+
+	if (!cap.isOpened()) {
+		std::cout << "cannot open " << source << "\n";
+		return 1;
+	}
+
 	namedWindow("Display window");
 
-	Mat image;
-	VideoCapture cap(0);
+	std::mutex mutex;
+	Mat latest;
+	auto hints = ZXing::DecodeHints().setMaxNumberOfSymbols(1).setTrackSymbols(true);
+	VideoDecodePipeline pipeline(cap, hints, [&](VideoDecodePipeline::Frame& frame) {
+		for (auto& r : frame.results) {
+			std::cout << frame.index << ": " << ToString(r.format()) << " " << r.text() << "\n";
+			DrawResult(frame.image, r);
+		}
+		std::lock_guard lock(mutex);
+		latest = frame.image;
+	}, workers);
 
-	if (!cap.isOpened())
-		std::cout << "cannot open camera";
-	else
-		while (waitKey(25) != 27) {
-			cap >> image;
-			auto results = ReadBarcodes(image);
-			for (auto& r : results)
-				DrawResult(image, r);
-			imshow("Display window", image);
+	while (pipeline.running() && waitKey(25) != 27) {
+		Mat image;
+		{
+			std::lock_guard lock(mutex);
+			image = latest;
 		}
+		if (!image.empty())
+			imshow("Display window", image);
+	}
+	pipeline.stop();
+
+	auto stats = pipeline.stats();
+	std::cout << "captured " << stats.captured << ", decoded " << stats.decoded << ", skipped " << stats.skipped
+			  << " frames in " << stats.seconds << " s (" << stats.fps() << " fps)\n";
 
 	return 0;
 }
@@ -9,6 +9,17 @@
 
 #include <opencv2/opencv.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 inline ZXing::ImageView ImageViewFromMat(const cv::Mat& image)
 {
 	using ZXing::ImageFormat;
@@ -42,3 +53,158 @@ inline void DrawResult(cv::Mat& img, ZXing::Result res)
 	cv::polylines(img, &pts, &npts, 1, true, CV_RGB(0, 255, 0));
 	cv::putText(img, res.text(), zx2cv(pos[3]) + cv::Point(0, 20), cv::FONT_HERSHEY_DUPLEX, 0.5, CV_RGB(0, 255, 0));
 }
+
+/**
+ * Decodes the frames of a cv::VideoCapture (camera, video file or network stream like rtsp://...) on a pool of worker
+ * threads: capture thread -> bounded queue -> decode workers -> callback in frame order.
+ *
+ * Every frame is captured into its own cv::Mat, which is handed through the queue and decoded without copying. If the
+ * workers can not keep up with a live stream, the oldest queued frame is dropped, so the latency stays bounded. Each
+ * worker owns a BarcodeReader, so DecodeHints::trackSymbols() finds the symbols of the previous frame quickly.
+ */
+class VideoDecodePipeline
+{
+public:
+	struct Frame
+	{
+		int64_t index = 0; // position in the stream, counting the skipped frames
+		cv::Mat image;
+		ZXing::Results results;
+	};
+
+	struct Stats
+	{
+		int64_t captured = 0, decoded = 0, skipped = 0;
+		double seconds = 0; // from the start until the last decoded frame
+		double fps() const { return seconds > 0 ? decoded / seconds : 0; }
+	};
+
+	/// called for each decoded frame in capture order, from one worker thread at a time
+	using Callback = std::function<void(Frame& frame)>;
+
+	/**
+	 * @param workers  number of decode threads (0 = all cores), each reader runs single threaded
+	 * @param maxQueued  maximum number of frames waiting for a worker before frames are skipped
+	 */
+	VideoDecodePipeline(cv::VideoCapture& capture, const ZXing::DecodeHints& hints, Callback callback, int workers = 0,
+						int maxQueued = 2)
+		: _capture(capture), _callback(std::move(callback)), _maxQueued(std::max(maxQueued, 1)), _start(Clock::now())
+	{
+		if (workers <= 0)
+			workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+		auto workerHints = hints;
+		workerHints.setThreads(1);
+
+		_activeWorkers = workers;
+		for (int i = 0; i < workers; ++i)
+			_workers.emplace_back([this, workerHints] { work(workerHints); });
+		_captureThread = std::thread([this] { captureFrames(); });
+	}
+
+	~VideoDecodePipeline() { stop(); }
+
+	/// Stop capturing, decode the frames already queued and wait for the threads to finish
+	void stop()
+	{
+		_stopRequested = true;
+		join();
+	}
+
+	/// Wait until the end of the stream is reached and all frames are decoded
+	void join()
+	{
+		if (_captureThread.joinable())
+			_captureThread.join();
+		for (auto& worker : _workers)
+			if (worker.joinable())
+				worker.join();
+	}
+
+	bool running() const { return _activeWorkers > 0; }
+
+	Stats stats() const
+	{
+		std::scoped_lock lock(_mutex, _emitMutex);
+		return _stats;
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	void captureFrames()
+	{
+		for (int64_t index = 0; !_stopRequested; ++index) {
+			cv::Mat image; // a new buffer for every frame, owned by the queue entry from here on
+			if (!_capture.read(image) || image.empty())
+				break;
+
+			std::lock_guard lock(_mutex);
+			++_stats.captured;
+			if (static_cast<int>(_queue.size()) >= _maxQueued) {
+				_queue.pop_front();
+				++_stats.skipped;
+			}
+			_queue.push_back({index, std::move(image), {}});
+			_queued.notify_one();
+		}
+
+		std::lock_guard lock(_mutex);
+		_captureDone = true;
+		_queued.notify_all();
+	}
+
+	void work(const ZXing::DecodeHints& hints)
+	{
+		ZXing::BarcodeReader reader(hints);
+		while (true) {
+			Frame frame;
+			int64_t seq;
+			{
+				std::unique_lock lock(_mutex);
+				_queued.wait(lock, [this] { return !_queue.empty() || _captureDone; });
+				if (_queue.empty())
+					break;
+				frame = std::move(_queue.front());
+				_queue.pop_front();
+				seq = _nextSeq++; // the frames taken from the queue are numbered without gaps
+			}
+			frame.results = reader.read(ImageViewFromMat(frame.image));
+			emit(seq, std::move(frame));
+		}
+		--_activeWorkers;
+	}
+
+	// buffer the frames finished out of order until all preceding ones are handed to the callback
+	void emit(int64_t seq, Frame&& frame)
+	{
+		std::lock_guard lock(_emitMutex);
+		_pending.emplace(seq, std::move(frame));
+		for (auto i = _pending.begin(); i != _pending.end() && i->first == _nextEmit; i = _pending.erase(i), ++_nextEmit) {
+			_callback(i->second);
+			++_stats.decoded;
+			_stats.seconds = std::chrono::duration<double>(Clock::now() - _start).count();
+		}
+	}
+
+	cv::VideoCapture& _capture;
+	Callback _callback;
+	const int _maxQueued;
+	const Clock::time_point _start;
+
+	mutable std::mutex _mutex; // guards _queue, _nextSeq, _captureDone, _stats.captured and _stats.skipped
+	std::condition_variable _queued;
+	std::deque<Frame> _queue;
+	int64_t _nextSeq = 0;
+	bool _captureDone = false;
+
+	mutable std::mutex _emitMutex; // guards _pending, _nextEmit, _stats.decoded and _stats.seconds
+	std::map<int64_t, Frame> _pending;
+	int64_t _nextEmit = 0;
+	Stats _stats;
+
+	std::atomic<bool> _stopRequested = false;
+	std::atomic<int> _activeWorkers = 0;
+	std::thread _captureThread;
+	std::vector<std::thread> _workers;
+};
@@ -20,6 +20,11 @@
 #include <QVideoSink>
 #endif
 #include <QElapsedTimer>
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <utility>
 #endif
 
 // This is some sample code to start a discussion about how a minimal and header-only Qt wrapper/helper could look like.
@@ -219,7 +224,7 @@ inline QList<Result> ReadBarcodes(const QVideoFrame& frame, const DecodeHints& h
 	case QVideoFrame::Format_YUV444: fmt = ImageFormat::Lum, pixStride = 3; break;
 #else
 	case QVideoFrameFormat::Format_P010:
-	case QVideoFrameFormat::Format_P016: fmt = ImageFormat::Lum, pixStride = 1; break;
+	case QVideoFrameFormat::Format_P016: fmt = ImageFormat::Lum, pixStride = 2, pixOffset = 1; break;
 #endif
 
 	case FORMAT(AYUV444, AYUV):
@@ -312,6 +317,18 @@ public: \
 	Q_SIGNAL void name##Changed();
 
 
+class BarcodeReader;
+
+// decodes the frames queued via BarcodeReader::processAsync() on the thread pool of the reader
+class DecodeRunnable : public QRunnable
+{
+	BarcodeReader* _reader = nullptr;
+
+public:
+	explicit DecodeRunnable(BarcodeReader* reader) : _reader(reader) {}
+	void run() override;
+};
+
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 class BarcodeReader : public QAbstractVideoFilter, private DecodeHints
 #else
@@ -327,6 +344,15 @@ public:
 	BarcodeReader(QObject* parent = nullptr) : QObject(parent) {}
 #endif
 
+	~BarcodeReader() override
+	{
+		{
+			QMutexLocker lock(&_mutex);
+			_latestFrame = {};
+		}
+		_pool.waitForDone();
+	}
+
 	// TODO: find out how to properly expose QFlags to QML
 	// simply using ZQ_PROPERTY(BarcodeFormats, formats, setFormats)
 	// results in the runtime error "can't assign int to formats"
@@ -351,12 +377,44 @@ public:
 	ZQ_PROPERTY(bool, tryDownscale, setTryDownscale)
 
 public slots:
-	ZXingQt::Result process(const QVideoFrame& image)
+	/// Decode the frame on the calling thread
+	ZXingQt::Result process(const QVideoFrame& image) { return decode(image, *this); }
+
+	/**
+	 * Queue the frame for decoding on a background thread and return immediately, so the camera preview never waits
+	 * for the decoder. If a decode is still running, the frame replaces the one queued before (latest frame wins).
+	 * The signals are emitted on the background thread, i.e. delivered queued to receivers living in the GUI thread.
+	 */
+	void processAsync(const QVideoFrame& image)
+	{
+		QMutexLocker lock(&_mutex);
+		_latestFrame = image; // shallow copy, the frame is mapped on the decoding thread
+		_latestHints = *this; // snapshot, the properties are changed on the GUI thread
+		if (!_decoding) {
+			_decoding = true;
+			_pool.start(new DecodeRunnable(this));
+		}
+	}
+
+signals:
+	void newResult(ZXingQt::Result result);
+	void foundBarcode(ZXingQt::Result result);
+
+private:
+	friend class DecodeRunnable;
+
+	QMutex _mutex; // guards the following three members
+	QVideoFrame _latestFrame;
+	DecodeHints _latestHints;
+	bool _decoding = false;
+	QThreadPool _pool;
+
+	Result decode(const QVideoFrame& image, const DecodeHints& hints)
 	{
 		QElapsedTimer t;
 		t.start();
 
-		auto res = ReadBarcode(image, *this);
+		auto res = ReadBarcode(image, hints);
 
 		res.runTime = t.elapsed();
 
@@ -366,9 +424,23 @@ public slots:
 		return res;
 	}
 
-signals:
-	void newResult(ZXingQt::Result result);
-	void foundBarcode(ZXingQt::Result result);
+	void decodeLatest()
+	{
+		while (true) {
+			QVideoFrame frame;
+			DecodeHints hints;
+			{
+				QMutexLocker lock(&_mutex);
+				if (!_latestFrame.isValid()) {
+					_decoding = false;
+					return;
+				}
+				frame = std::exchange(_latestFrame, QVideoFrame());
+				hints = _latestHints;
+			}
+			decode(frame, hints);
+		}
+	}
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 public:
@@ -386,7 +458,7 @@ public:
 			disconnect(_sink, nullptr, this, nullptr);
 
 		_sink = sink;
-		connect(_sink, &QVideoSink::videoFrameChanged, this, &BarcodeReader::process);
+		connect(_sink, &QVideoSink::videoFrameChanged, this, &BarcodeReader::processAsync);
 	}
 	Q_PROPERTY(QVideoSink* videoSink WRITE setVideoSink)
 #endif
@@ -405,7 +477,11 @@ public:
 
 	QVideoFrame run(QVideoFrame* input, const QVideoSurfaceFormat& /*surfaceFormat*/, RunFlags /*flags*/) override
 	{
-		_filter->process(*input);
+		// frames backed by a texture can only be mapped on the render thread
+		if (input->handleType() == QAbstractVideoBuffer::NoHandle)
+			_filter->processAsync(*input);
+		else
+			_filter->process(*input);
 		return *input;
 	}
 };
@@ -416,6 +492,11 @@ inline QVideoFilterRunnable* BarcodeReader::createFilterRunnable()
 }
 #endif
 
+inline void DecodeRunnable::run()
+{
+	_reader->decodeLatest();
+}
+
 #endif // QT_MULTIMEDIA_LIB
 
 } // namespace ZXingQt
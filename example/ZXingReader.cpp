@@ -8,21 +8,52 @@
 #include "GTIN.h"
 #include "ZXVersion.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <chrono>
+#include <climits>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
 using namespace ZXing;
+namespace fs = std::filesystem;
+
+struct BatchOptions
+{
+	enum class Output { OneLine, CSV, JSONL };
+
+	bool enabled = false;
+	int jobs = 0; // 0 = one worker per core
+	Output output = Output::OneLine;
+	bool stats = false;
+};
 
 static void PrintUsage(const char* exePath)
 {
@@ -34,6 +65,7 @@ static void PrintUsage(const char* exePath)
 			  << "    -format <FORMAT[,...]>\n"
 			  << "               Only detect given format(s) (faster)\n"
 			  << "    -ispure    Assume the image contains only a 'pure'/perfect code (faster)\n"
+			  << "    -adaptive  Use the adaptive (integral image) binarizer, e.g. for uneven illumination\n"
 			  << "    -errors    Include results with errors (like checksum error)\n"
 			  << "    -mode <plain|eci|hri|escaped>\n"
 			  << "               Text mode used to render the raw byte content into text\n"
@@ -41,6 +73,14 @@ static void PrintUsage(const char* exePath)
 			  << "    -bytes     Write (only) the bytes content of the symbol(s) to stdout\n"
 			  << "    -pngout <file name>\n"
 			  << "               Write a copy of the input image with barcodes outlined by a green line\n"
+			  << "\n"
+			  << "Batch mode (enabled by any of the following options or if a directory is given):\n"
+			  << "    -jobs <N>  Number of parallel workers (default: one per core)\n"
+			  << "    -csv       Print one 'file,format,text,error' line per barcode\n"
+			  << "    -jsonl     Print one JSON object per barcode and line\n"
+			  << "    -stats     Print the throughput (images/s, MP/s) to stderr at the end\n"
+			  << "               Directories are scanned recursively, the output is streamed in completion order,\n"
+			  << "               images without barcode are reported with format 'None'\n"
 			  << "    -help      Print usage information\n"
 			  << "    -version   Print version information\n"
 			  << "\n"
@@ -52,7 +92,7 @@ static void PrintUsage(const char* exePath)
 }
 
 static bool ParseOptions(int argc, char* argv[], DecodeHints& hints, bool& oneLine, bool& bytesOnly,
-						 std::vector<std::string>& filePaths, std::string& outPath)
+						 std::vector<std::string>& filePaths, std::string& outPath, BatchOptions& batch)
 {
 #ifdef ZXING_BUILD_EXPERIMENTAL_API
 	hints.setTryDenoise(true);
@@ -74,6 +114,8 @@ static bool ParseOptions(int argc, char* argv[], DecodeHints& hints, bool& oneLi
 		} else if (is("-ispure")) {
 			hints.setIsPure(true);
 			hints.setBinarizer(Binarizer::FixedThreshold);
+		} else if (is("-adaptive")) {
+			hints.setBinarizer(Binarizer::Adaptive);
 		} else if (is("-errors")) {
 			hints.setReturnErrors(true);
 		} else if (is("-format")) {
@@ -106,6 +148,20 @@ static bool ParseOptions(int argc, char* argv[], DecodeHints& hints, bool& oneLi
 			if (++i == argc)
 				return false;
 			outPath = argv[i];
+		} else if (is("-jobs")) {
+			if (++i == argc)
+				return false;
+			batch.enabled = true;
+			batch.jobs = std::max(0, atoi(argv[i]));
+		} else if (is("-csv")) {
+			batch.enabled = true;
+			batch.output = BatchOptions::Output::CSV;
+		} else if (is("-jsonl")) {
+			batch.enabled = true;
+			batch.output = BatchOptions::Output::JSONL;
+		} else if (is("-stats")) {
+			batch.enabled = true;
+			batch.stats = true;
 		} else if (is("-help") || is("--help")) {
 			PrintUsage(argv[0]);
 			exit(0);
@@ -114,10 +170,11 @@ static bool ParseOptions(int argc, char* argv[], DecodeHints& hints, bool& oneLi
 			exit(0);
 		} else {
 			filePaths.push_back(argv[i]);
+			batch.enabled |= fs::is_directory(argv[i]);
 		}
 	}
 
-	return !filePaths.empty();
+	return !filePaths.empty() && !(batch.enabled && (bytesOnly || !outPath.empty()));
 }
 
 std::ostream& operator<<(std::ostream& os, const Position& points)
@@ -149,6 +206,201 @@ void drawRect(const ImageView& image, const Position& pos, bool error)
 		drawLine(image, pos[i], pos[(i + 1) % 4], error);
 }
 
+// Read-only view of a whole file, memory mapped to save the copy into a user space buffer (falls back to reading it)
+class MappedFile
+{
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+	std::vector<uint8_t> _buffer;
+#ifdef _WIN32
+	HANDLE _mapping = nullptr;
+#endif
+
+public:
+	explicit MappedFile(const std::string& path)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER size;
+		if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+			_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (_mapping && (_data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0))))
+				_size = static_cast<size_t>(size.QuadPart);
+		}
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		struct stat st;
+		if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+			void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED) {
+				_data = static_cast<const uint8_t*>(data);
+				_size = st.st_size;
+			}
+		}
+		if (fd >= 0)
+			close(fd);
+#endif
+		if (!_data) {
+			std::ifstream ifs(path, std::ios::binary);
+			_buffer.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+			_data = _buffer.data();
+			_size = _buffer.size();
+		}
+	}
+
+	~MappedFile()
+	{
+		if (_buffer.empty() && _size) {
+#ifdef _WIN32
+			UnmapViewOfFile(_data);
+#else
+			munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+		}
+#ifdef _WIN32
+		if (_mapping)
+			CloseHandle(_mapping);
+#endif
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* data() const { return _data; }
+	int size() const { return static_cast<int>(std::min<size_t>(_size, INT_MAX)); }
+};
+
+static std::string QuoteCSV(const std::string& str)
+{
+	std::string res = "\"";
+	for (char c : str)
+		res += c == '"' ? std::string("\"\"") : std::string(1, c);
+	return res + "\"";
+}
+
+static std::string QuoteJSON(const std::string& str)
+{
+	std::string res = "\"";
+	for (unsigned char c : str) {
+		if (c == '"' || c == '\\') {
+			res += '\\';
+			res += c;
+		} else if (c < 0x20) {
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", c);
+			res += buf;
+		} else {
+			res += c;
+		}
+	}
+	return res + "\"";
+}
+
+static std::string FormatBatchResult(const std::string& filePath, const Result& result, BatchOptions::Output output)
+{
+	auto text = result.isValid() ? result.text(TextMode::Escaped) : std::string();
+	auto error = ToString(result.error());
+	std::ostringstream os;
+	switch (output) {
+	case BatchOptions::Output::OneLine:
+		os << filePath << " " << ToString(result.format());
+		if (result.isValid())
+			os << " \"" << text << "\"";
+		else if (result.error())
+			os << " " << error;
+		break;
+	case BatchOptions::Output::CSV:
+		os << QuoteCSV(filePath) << "," << ToString(result.format()) << "," << QuoteCSV(text) << "," << QuoteCSV(error);
+		break;
+	case BatchOptions::Output::JSONL:
+		os << "{\"file\":" << QuoteJSON(filePath) << ",\"format\":\"" << ToString(result.format()) << "\",\"text\":"
+		   << QuoteJSON(text) << ",\"error\":" << QuoteJSON(error) << ",\"position\":[";
+		for (int i = 0; i < 4; ++i)
+			os << (i ? "," : "") << result.position()[i].x << "," << result.position()[i].y;
+		os << "]}";
+		break;
+	}
+	os << "\n";
+	return os.str();
+}
+
+// Bulk scanning: the files (directories are traversed recursively) are distributed over a number of worker threads,
+// each with its own BarcodeReader, so the buffers of the reader are reused from image to image.
+static int RunBatch(const std::vector<std::string>& paths, const DecodeHints& hints, const BatchOptions& batch)
+{
+	static const std::vector<std::string> extensions = {".png", ".jpg", ".jpeg", ".bmp", ".gif", ".pgm", ".ppm", ".tga", ".psd"};
+	std::vector<std::string> filePaths;
+	for (const auto& path : paths) {
+		if (!fs::is_directory(path)) {
+			filePaths.push_back(path);
+			continue;
+		}
+		std::error_code ec;
+		for (auto it = fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, ec);
+			 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+			auto ext = it->path().extension().string();
+			std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+			if (it->is_regular_file(ec) && std::find(extensions.begin(), extensions.end(), ext) != extensions.end())
+				filePaths.push_back(it->path().string());
+		}
+	}
+
+	std::atomic<int> next = 0, failed = 0, found = 0;
+	std::atomic<int64_t> pixels = 0;
+	std::mutex outputMutex;
+	auto startTime = std::chrono::steady_clock::now();
+
+	auto worker = [&]() {
+		// the internal parallelism of the reader would only compete with the other workers
+		BarcodeReader reader(DecodeHints(hints).setThreads(1));
+		std::string output;
+		for (int i = next++; i < Size(filePaths); i = next++) {
+			const auto& filePath = filePaths[i];
+			MappedFile file(filePath);
+			int width, height, channels;
+			std::unique_ptr<stbi_uc, void (*)(void*)> buffer(
+				stbi_load_from_memory(file.data(), file.size(), &width, &height, &channels, 1), stbi_image_free);
+			if (buffer == nullptr) {
+				std::lock_guard lock(outputMutex);
+				std::cerr << "Failed to read image: " << filePath << " (" << stbi_failure_reason() << ")\n";
+				++failed;
+				continue;
+			}
+
+			auto results = reader.read({buffer.get(), width, height, ImageFormat::Lum});
+			pixels += int64_t(width) * height;
+			found += Size(results);
+			if (results.empty())
+				results.emplace_back();
+
+			output.clear();
+			for (const auto& result : results)
+				output += FormatBatchResult(filePath, result, batch.output);
+			std::lock_guard lock(outputMutex);
+			std::cout << output << std::flush;
+		}
+	};
+
+	int jobs = batch.jobs ? batch.jobs : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	std::vector<std::thread> threads;
+	for (int i = 0; i < std::min(jobs, Size(filePaths)); ++i)
+		threads.emplace_back(worker);
+	for (auto& thread : threads)
+		thread.join();
+
+	if (batch.stats) {
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		int images = Size(filePaths) - failed;
+		std::cerr << "images: " << images << " (" << failed << " failed to load), barcodes: " << found << ", workers: " << jobs
+				  << ", time: " << seconds << " s, " << images / seconds << " images/s, " << pixels / seconds / 1e6
+				  << " MP/s\n";
+	}
+
+	return failed ? -1 : 0;
+}
+
 int main(int argc, char* argv[])
 {
 	DecodeHints hints;
@@ -157,16 +409,19 @@ int main(int argc, char* argv[])
 	std::string outPath;
 	bool oneLine = false;
 	bool bytesOnly = false;
+	BatchOptions batch;
 	int ret = 0;
 
 	hints.setTextMode(TextMode::HRI);
 	hints.setEanAddOnSymbol(EanAddOnSymbol::Read);
 
-	if (!ParseOptions(argc, argv, hints, oneLine, bytesOnly, filePaths, outPath)) {
+	if (!ParseOptions(argc, argv, hints, oneLine, bytesOnly, filePaths, outPath, batch)) {
 		PrintUsage(argv[0]);
 		return -1;
 	}
 
+	if (batch.enabled)
+		return RunBatch(filePaths, hints, batch);
 
 	std::cout.setf(std::ios::boolalpha);
 
@@ -0,0 +1,383 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ReadBarcode.h"
+#include "ZXAlgorithms.h"
+#include "ZXVersion.h"
+#include "ZXingShmRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+using namespace ZXing;
+using namespace ZXingShm;
+
+static void PrintUsage(const char* exePath)
+{
+	std::cout << "Usage: " << exePath << " [options] -serve <name>\n"
+			  << "       " << exePath << " -feed <name> <image file>...\n"
+			  << "       " << exePath << " -stop <name>\n"
+			  << "\n"
+			  << "    -serve <name>  Create the shared memory object <name> (e.g. /zxing) and decode the frames written to it\n"
+			  << "    -feed <name>   Write the images as frames to a served object and print the results (single producer only)\n"
+			  << "    -stop <name>   Make the server of the object exit\n"
+			  << "\n"
+			  << "Options of -serve:\n"
+			  << "    -jobs <n>      Number of worker threads (each with its own reader), default is one per core\n"
+			  << "    -frames <n>    Number of frame slots (default 8)\n"
+			  << "    -framesize <n> Maximum size of the pixel data of a frame in bytes (default 1920x1080x4)\n"
+			  << "    -results <n>   Number of result slots (default 256)\n"
+			  << "    -fast          Skip some lines/pixels during detection (faster)\n"
+			  << "    -format <FORMAT[,...]>\n"
+			  << "                   Only detect given format(s)\n"
+			  << "\n"
+			  << "See ZXingShmRing.h for the layout of the shared memory object.\n";
+}
+
+struct ServerOptions
+{
+	int jobs = 0; // 0 = one worker per core
+	uint32_t frameSlots = 8;
+	uint64_t frameDataSize = 1920 * 1080 * 4;
+	uint32_t resultSlots = 256;
+};
+
+// A shared memory object mapped into the address space of this process
+class SharedMemory
+{
+	void* _data = MAP_FAILED;
+	size_t _size = 0;
+
+public:
+	SharedMemory(const std::string& name, size_t size, bool create)
+	{
+		if (create)
+			shm_unlink(name.c_str()); // a left-over of a crashed server
+		int fd = shm_open(name.c_str(), create ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0600);
+		struct stat st;
+		if (fd >= 0 && (create ? ftruncate(fd, size) == 0 : fstat(fd, &st) == 0)) {
+			_size = create ? size : st.st_size;
+			_data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		}
+		if (fd >= 0)
+			close(fd);
+		if (_data == MAP_FAILED)
+			throw std::runtime_error("Failed to map shared memory object " + name + ": " + strerror(errno));
+	}
+
+	~SharedMemory() { munmap(_data, _size); }
+
+	SharedMemory(const SharedMemory&) = delete;
+	SharedMemory& operator=(const SharedMemory&) = delete;
+
+	Header& header() const { return *static_cast<Header*>(_data); }
+	size_t size() const { return _size; }
+};
+
+static Header& ValidatedHeader(const SharedMemory& shm)
+{
+	auto& h = shm.header();
+	if (shm.size() < sizeof(Header) || h.magic != Magic || h.version != Version || shm.size() < TotalSize(h))
+		throw std::runtime_error("Not a shared memory object of a compatible ZXingShmReader");
+	return h;
+}
+
+// Polling with a growing sleep keeps the latency low under load and the CPU idle when there are no frames
+class Backoff
+{
+	int _us = 0;
+
+public:
+	void reset() { _us = 0; }
+	void wait()
+	{
+		if (_us == 0)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(_us));
+		_us = std::clamp(_us * 2, 1, 1000);
+	}
+};
+
+static std::atomic<bool> interrupted = false;
+
+static void PushResult(Header& h, uint64_t frameId, int index, int count, const Result* result)
+{
+	uint64_t pos;
+	auto* slot = BeginPush(h.results, ResultSlots(h), pos);
+	if (!slot) {
+		++h.droppedResults;
+		return;
+	}
+	slot->frameId = frameId;
+	slot->index = index;
+	slot->count = count;
+	slot->format = static_cast<uint32_t>(result ? result->format() : BarcodeFormat::None);
+	for (int i = 0; i < 4; ++i) {
+		slot->position[2 * i] = result ? result->position()[i].x : 0;
+		slot->position[2 * i + 1] = result ? result->position()[i].y : 0;
+	}
+	auto text = result ? result->text() : std::string();
+	slot->textSize = static_cast<uint32_t>(std::min<size_t>(text.size(), MaxTextSize));
+	std::memcpy(slot->text, text.data(), slot->textSize);
+	EndPush(*slot, pos);
+}
+
+// Each worker has its own BarcodeReader (a persistent reader session) and decodes the frames in place
+static int Serve(const std::string& name, const DecodeHints& hints, const ServerOptions& opts)
+{
+	Header layout = {};
+	layout.frameSlots = opts.frameSlots;
+	layout.resultSlots = opts.resultSlots;
+	layout.frameDataSize = opts.frameDataSize;
+	SharedMemory shm(name, TotalSize(layout), true);
+
+	auto& h = *new (&shm.header()) Header();
+	h.frameSlots = opts.frameSlots;
+	h.resultSlots = opts.resultSlots;
+	h.frameDataSize = opts.frameDataSize;
+	h.frames.capacity = opts.frameSlots;
+	h.results.capacity = opts.resultSlots;
+	for (uint32_t i = 0; i < opts.frameSlots; ++i)
+		(new (FrameSlots(h) + i) FrameSlot())->sequence = i;
+	for (uint32_t i = 0; i < opts.resultSlots; ++i)
+		(new (ResultSlots(h) + i) ResultSlot())->sequence = i;
+	h.version = Version;
+	// the magic is written last, a feeder does not accept the object before it is initialized
+	std::atomic_thread_fence(std::memory_order_release);
+	h.magic = Magic;
+
+	std::signal(SIGINT, [](int) { interrupted = true; });
+	std::signal(SIGTERM, [](int) { interrupted = true; });
+
+	std::atomic<int64_t> frames = 0, invalid = 0;
+	auto worker = [&]() {
+		// the internal parallelism of the reader would only compete with the other workers
+		BarcodeReader reader(DecodeHints(hints).setThreads(1));
+		Backoff backoff;
+		while (!h.stop && !interrupted) {
+			uint64_t pos;
+			auto* slot = BeginPop(h.frames, FrameSlots(h), pos);
+			if (!slot) {
+				backoff.wait();
+				continue;
+			}
+			backoff.reset();
+
+			const auto format = static_cast<ImageFormat>(slot->format);
+			const int64_t pixStride = slot->pixStride ? slot->pixStride : PixStride(format);
+			const int64_t rowStride = slot->rowStride ? slot->rowStride : slot->width * pixStride;
+			Results results;
+			bool valid = slot->width > 0 && slot->height > 0 && pixStride > 0 && rowStride > 0
+						 && (slot->height - 1) * rowStride + slot->width * pixStride <= int64_t(h.frameDataSize);
+			if (valid) {
+				try {
+					results = reader.read(ImageView(FrameData(h, *slot), slot->width, slot->height, format, slot->rowStride,
+													slot->pixStride));
+				} catch (const std::exception&) {
+					valid = false;
+				}
+			}
+			const auto frameId = slot->frameId;
+			EndPop(h.frames, *slot, pos); // the pixels are not needed anymore
+
+			++frames;
+			if (!valid) {
+				++invalid;
+				PushResult(h, frameId, 0, -1, nullptr);
+			} else if (results.empty()) {
+				PushResult(h, frameId, 0, 0, nullptr);
+			}
+			for (int i = 0; i < Size(results); ++i)
+				PushResult(h, frameId, i, Size(results), &results[i]);
+		}
+	};
+
+	int jobs = opts.jobs ? opts.jobs : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	std::cerr << "serving " << name << " with " << jobs << " workers\n";
+	std::vector<std::thread> threads;
+	for (int i = 0; i < jobs; ++i)
+		threads.emplace_back(worker);
+	for (auto& thread : threads)
+		thread.join();
+
+	std::cerr << "frames: " << frames << " (" << invalid << " invalid), dropped results: " << h.droppedResults << "\n";
+	shm_unlink(name.c_str());
+	return 0;
+}
+
+// the alpha channel (if any) is skipped by the pixel stride
+static ImageFormat ImageFormatFromChannels(int channels)
+{
+	switch (channels) {
+	case 1:
+	case 2: return ImageFormat::Lum;
+	case 3: return ImageFormat::RGB;
+	case 4: return ImageFormat::RGBX;
+	default: return ImageFormat::None;
+	}
+}
+
+// Reference producer: writes the images (in their own channel layout) as frames and prints the results. It consumes
+// the results of other producers as well (and drops them), so it has to be the only producer while it runs.
+static int Feed(const std::string& name, const std::vector<std::string>& filePaths)
+{
+	SharedMemory shm(name, 0, false);
+	auto& h = ValidatedHeader(shm);
+	const uint64_t idBase = uint64_t(getpid()) << 32;
+
+	int failed = 0;
+	size_t fed = 0;
+	for (size_t i = 0; i < filePaths.size(); ++i) {
+		int width, height, channels;
+		std::unique_ptr<stbi_uc, void (*)(void*)> buffer(stbi_load(filePaths[i].c_str(), &width, &height, &channels, 0),
+														 stbi_image_free);
+		if (buffer == nullptr || uint64_t(width) * height * channels > h.frameDataSize) {
+			std::cerr << "Failed to read image or too large: " << filePaths[i] << "\n";
+			++failed;
+			continue;
+		}
+
+		uint64_t pos;
+		FrameSlot* slot;
+		for (Backoff backoff; !(slot = BeginPush(h.frames, FrameSlots(h), pos));)
+			backoff.wait(); // a camera would rather drop the frame
+		slot->frameId = idBase + i;
+		slot->width = width;
+		slot->height = height;
+		slot->rowStride = width * channels;
+		slot->pixStride = channels;
+		slot->format = static_cast<uint32_t>(ImageFormatFromChannels(channels));
+		std::memcpy(FrameData(h, *slot), buffer.get(), size_t(width) * height * channels); // a camera would write here directly
+		EndPush(*slot, pos);
+		++fed;
+	}
+
+	// the results of the frames decoded by different workers may be interleaved
+	std::map<uint64_t, int> received;
+	size_t done = 0;
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	for (Backoff backoff; done < fed && std::chrono::steady_clock::now() < deadline;) {
+		uint64_t pos;
+		auto* slot = BeginPop(h.results, ResultSlots(h), pos);
+		if (!slot) {
+			backoff.wait();
+			continue;
+		}
+		backoff.reset();
+		if ((slot->frameId >> 32) == (idBase >> 32)) {
+			const auto& filePath = filePaths[slot->frameId & 0xffffffff];
+			std::cout << filePath << " ";
+			if (slot->count < 0)
+				std::cout << "invalid frame";
+			else
+				std::cout << ToString(static_cast<BarcodeFormat>(slot->format)) << " \""
+						  << std::string(slot->text, slot->textSize) << "\"";
+			std::cout << "\n";
+			done += ++received[slot->frameId] >= std::max(1, slot->count);
+		}
+		EndPop(h.results, *slot, pos);
+	}
+
+	if (done < fed) {
+		std::cerr << "Timeout waiting for the results of " << fed - done << " frames\n";
+		return -1;
+	}
+	return failed ? -1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	DecodeHints hints;
+	hints.setTextMode(TextMode::HRI);
+	hints.setEanAddOnSymbol(EanAddOnSymbol::Read);
+	ServerOptions opts;
+	std::string mode, name;
+	std::vector<std::string> filePaths;
+
+	for (int i = 1; i < argc; ++i) {
+		auto is = [&](const char* str) { return strncmp(argv[i], str, strlen(argv[i])) == 0; };
+		auto value = [&]() {
+			if (++i == argc) {
+				PrintUsage(argv[0]);
+				exit(-1);
+			}
+			return std::string(argv[i]);
+		};
+		if (is("-serve")) {
+			mode = "serve";
+			name = value();
+		} else if (is("-feed")) {
+			mode = "feed";
+			name = value();
+		} else if (is("-stop")) {
+			mode = "stop";
+			name = value();
+		} else if (is("-jobs")) {
+			opts.jobs = std::max(0, std::stoi(value()));
+		} else if (is("-frames")) {
+			opts.frameSlots = std::max(1, std::stoi(value()));
+		} else if (is("-framesize")) {
+			opts.frameDataSize = std::max<long long>(1, std::stoll(value()));
+		} else if (is("-results")) {
+			opts.resultSlots = std::max(1, std::stoi(value()));
+		} else if (is("-fast")) {
+			hints.setTryHarder(false);
+		} else if (is("-format")) {
+			try {
+				hints.setFormats(BarcodeFormatsFromString(value()));
+			} catch (const std::exception& e) {
+				std::cerr << e.what() << "\n";
+				return -1;
+			}
+		} else if (is("-help") || is("--help")) {
+			PrintUsage(argv[0]);
+			return 0;
+		} else if (is("-version") || is("--version")) {
+			std::cout << "ZXingShmReader " << ZXING_VERSION_STR << "\n";
+			return 0;
+		} else {
+			filePaths.push_back(argv[i]);
+		}
+	}
+
+	try {
+		if (mode == "serve" && filePaths.empty())
+			return Serve(name, hints, opts);
+		if (mode == "feed" && !filePaths.empty())
+			return Feed(name, filePaths);
+		if (mode == "stop" && filePaths.empty()) {
+			SharedMemory shm(name, 0, false);
+			ValidatedHeader(shm).stop = 1;
+			return 0;
+		}
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return -1;
+	}
+
+	PrintUsage(argv[0]);
+	return -1;
+}
@@ -0,0 +1,136 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Layout of the shared memory object served by ZXingShmReader, to be included by the processes feeding it frames.
+ *
+ * The object starts with a Header, followed by the frame slots, the result slots and the pixel data of the frame
+ * slots (frameDataSize bytes each). Both rings are bounded multi-producer / multi-consumer queues: a slot whose
+ * sequence equals the position pos is free for the producer claiming pos, one whose sequence is pos + 1 is ready
+ * for the consumer claiming pos, which releases it by setting the sequence to pos + capacity. Claiming a position
+ * is a single compare-and-swap, no locks are involved, so a stalled process never blocks the others.
+ *
+ * A producer fills the pixels of the frame slot it claimed in place and the server decodes them in place, the frame
+ * slot is released only after that, i.e. the pixels are never copied. The results of all producers end up in the
+ * one result ring, the frameId (chosen by the producer) tells them apart.
+ */
+namespace ZXingShm {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+			  "the rings need lock-free (and thereby address-free) atomics");
+
+constexpr uint32_t Magic = 0x5a58534d; // "ZXSM"
+constexpr uint32_t Version = 1;
+constexpr int MaxTextSize = 1024;
+
+struct Ring
+{
+	alignas(64) std::atomic<uint64_t> enqueuePos;
+	alignas(64) std::atomic<uint64_t> dequeuePos;
+	uint32_t capacity;
+};
+
+struct FrameSlot
+{
+	std::atomic<uint64_t> sequence;
+	uint64_t frameId;
+	int32_t width, height, rowStride, pixStride; // in bytes, see ZXing::ImageView
+	uint32_t format; // ZXing::ImageFormat
+};
+
+struct ResultSlot
+{
+	std::atomic<uint64_t> sequence;
+	uint64_t frameId;
+	int32_t index, count; // the symbol is the index-th of count ones found in the frame, count is 0 if there was none
+						  // and -1 if the frame could not be decoded (e.g. invalid descriptor)
+	uint32_t format; // ZXing::BarcodeFormat
+	int32_t position[8]; // x, y of the 4 corners, see ZXing::Position
+	uint32_t textSize;
+	char text[MaxTextSize]; // ZXing::TextMode::HRI, truncated to MaxTextSize bytes (not null terminated)
+};
+
+struct Header
+{
+	uint32_t magic, version;
+	uint32_t frameSlots, resultSlots;
+	uint64_t frameDataSize; // bytes of pixel data per frame slot
+	std::atomic<uint32_t> stop; // set to make the server exit
+	std::atomic<uint64_t> droppedResults; // because the result ring was full
+	Ring frames, results;
+};
+
+constexpr size_t AlignUp(size_t n) { return (n + 63) & ~size_t(63); }
+
+inline size_t FrameSlotsOffset() { return AlignUp(sizeof(Header)); }
+inline size_t ResultSlotsOffset(const Header& h) { return FrameSlotsOffset() + AlignUp(h.frameSlots * sizeof(FrameSlot)); }
+inline size_t FrameDataOffset(const Header& h) { return ResultSlotsOffset(h) + AlignUp(h.resultSlots * sizeof(ResultSlot)); }
+inline size_t TotalSize(const Header& h) { return FrameDataOffset(h) + h.frameSlots * AlignUp(h.frameDataSize); }
+
+inline FrameSlot* FrameSlots(Header& h) { return reinterpret_cast<FrameSlot*>(reinterpret_cast<uint8_t*>(&h) + FrameSlotsOffset()); }
+inline ResultSlot* ResultSlots(Header& h) { return reinterpret_cast<ResultSlot*>(reinterpret_cast<uint8_t*>(&h) + ResultSlotsOffset(h)); }
+
+inline uint8_t* FrameData(Header& h, const FrameSlot& slot)
+{
+	return reinterpret_cast<uint8_t*>(&h) + FrameDataOffset(h) + (&slot - FrameSlots(h)) * AlignUp(h.frameDataSize);
+}
+
+/// Claim a slot to fill, returns nullptr if the ring is full. The slot is published with EndPush(slot, pos).
+template <typename Slot>
+Slot* BeginPush(Ring& ring, Slot* slots, uint64_t& pos)
+{
+	uint64_t p = ring.enqueuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		Slot& slot = slots[p % ring.capacity];
+		auto diff = static_cast<int64_t>(slot.sequence.load(std::memory_order_acquire) - p);
+		if (diff == 0 && ring.enqueuePos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+			pos = p;
+			return &slot;
+		}
+		if (diff < 0)
+			return nullptr;
+		if (diff > 0)
+			p = ring.enqueuePos.load(std::memory_order_relaxed);
+	}
+}
+
+template <typename Slot>
+void EndPush(Slot& slot, uint64_t pos)
+{
+	slot.sequence.store(pos + 1, std::memory_order_release);
+}
+
+/// Claim a filled slot, returns nullptr if the ring is empty. The slot is released with EndPop(ring, slot, pos).
+template <typename Slot>
+Slot* BeginPop(Ring& ring, Slot* slots, uint64_t& pos)
+{
+	uint64_t p = ring.dequeuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		Slot& slot = slots[p % ring.capacity];
+		auto diff = static_cast<int64_t>(slot.sequence.load(std::memory_order_acquire) - (p + 1));
+		if (diff == 0 && ring.dequeuePos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+			pos = p;
+			return &slot;
+		}
+		if (diff < 0)
+			return nullptr;
+		if (diff > 0)
+			p = ring.dequeuePos.load(std::memory_order_relaxed);
+	}
+}
+
+template <typename Slot>
+void EndPop(const Ring& ring, Slot& slot, uint64_t pos)
+{
+	slot.sequence.store(pos + ring.capacity, std::memory_order_release);
+}
+
+} // namespace ZXingShm
@@ -162,7 +162,9 @@ int main(int argc, char* argv[])
 		} else if (ext == "jpg" || ext == "jpeg") {
 			success = stbi_write_jpg(filePath.c_str(), bitmap.width(), bitmap.height(), 1, bitmap.data(), 0);
 		} else if (ext == "svg") {
-			success = (std::ofstream(filePath) << ToSVG(matrix)).good();
+			std::ofstream file(filePath);
+			WriteSVG(file, matrix);
+			success = file.good();
 		}
 
 		if (!success) {
@@ -0,0 +1,571 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitMatrix.h"
+#include "BitMatrixCursor.h"
+#include "FrameQuality.h"
+#include "GenericGF.h"
+#include "GlobalHistogramBinarizer.h"
+#include "GridSampler.h"
+#include "HybridBinarizer.h"
+#include "MultiFormatWriter.h"
+#include "PerspectiveTransform.h"
+#include "ReadBarcode.h"
+#include "ReedSolomonDecoder.h"
+#include "ReedSolomonEncoder.h"
+#include "ThresholdBinarizer.h"
+#include "ZXAlgorithms.h"
+#include "datamatrix/DMDetector.h"
+#include "qrcode/QRDetector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#define ZX_BENCHMARK_HAVE_FORK
+#endif
+
+// Micro benchmarks of the individual stages of the reader pipeline and of the writers, to track regressions. Configure
+// with -DBUILD_BENCHMARKS=ON and run e.g. `ZXingBenchmark --benchmark_filter=Binarizer`. The images are synthesized,
+// so the numbers are comparable between machines with the same CPU without any sample data.
+
+namespace ZXing {
+int BenchmarkExtractLum(const ImageView& iv);
+int BenchmarkLumImagePyramid(const ImageView& iv, int threshold, int factor);
+int BenchmarkBinarizedLumImagePyramid(const ImageView& iv, int threshold, int factor, bool fused, bool derived);
+} // namespace ZXing
+
+using namespace ZXing;
+
+namespace {
+
+/**
+ * A synthetic camera frame: the symbol is drawn with the given module size onto a horizontal gradient with some
+ * noise, all color channels carry the same value. Linear symbols are a quarter of the image high.
+ */
+struct TestImage
+{
+	std::vector<uint8_t> pixels;
+	int width = 0, height = 0;
+	ImageFormat format = ImageFormat::Lum;
+	int dimension = 0;       // number of modules per row
+	QuadrilateralF symbol;   // corners of the symbol in pixel coordinates
+
+	ImageView view() const { return {pixels.data(), width, height, format}; }
+};
+
+TestImage MakeImage(BarcodeFormat barcodeFormat, const std::string& text, int moduleSize, ImageFormat format = ImageFormat::Lum,
+					int width = 1280, int height = 720)
+{
+	const auto modules = MultiFormatWriter(barcodeFormat).encodeModules(text).modules;
+	const bool linear = modules.height() == 1;
+	const int ps = PixStride(format);
+	const int symW = modules.width() * moduleSize;
+	const int symH = linear ? height / 4 : modules.height() * moduleSize;
+	const int x0 = (width - symW) / 2, y0 = (height - symH) / 2;
+
+	TestImage img;
+	img.pixels.resize(size_t(width) * height * ps);
+	img.width = width;
+	img.height = height;
+	img.format = format;
+	img.dimension = modules.width();
+	img.symbol = Rectangle(x0, x0 + symW, y0, y0 + symH, 0);
+
+	uint32_t seed = 42;
+	auto* dst = img.pixels.data();
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x) {
+			bool inside = x >= x0 && x < x0 + symW && y >= y0 && y < y0 + symH;
+			bool black = inside && modules.get((x - x0) / moduleSize, linear ? 0 : (y - y0) / moduleSize);
+			seed = seed * 1664525 + 1013904223;
+			int v = (black ? 40 : 120 + 100 * x / width) + int(seed >> 28) - 8;
+			dst = std::fill_n(dst, ps, static_cast<uint8_t>(std::clamp(v, 0, 255)));
+		}
+
+	return img;
+}
+
+const TestImage& QRImage(ImageFormat format = ImageFormat::Lum)
+{
+	static const TestImage lum = MakeImage(BarcodeFormat::QRCode, "https://github.com/zxing-cpp/zxing-cpp", 8);
+	static const TestImage rgb = MakeImage(BarcodeFormat::QRCode, "https://github.com/zxing-cpp/zxing-cpp", 8, ImageFormat::RGB);
+	static const TestImage rgbx = MakeImage(BarcodeFormat::QRCode, "https://github.com/zxing-cpp/zxing-cpp", 8, ImageFormat::RGBX);
+	switch (format) {
+	case ImageFormat::RGB: return rgb;
+	case ImageFormat::RGBX: return rgbx;
+	default: return lum;
+	}
+}
+
+void SetPixelsProcessed(benchmark::State& state, const TestImage& img)
+{
+	state.SetItemsProcessed(state.iterations() * img.width * img.height);
+}
+
+} // namespace
+
+static void BM_ExtractLum(benchmark::State& state, ImageFormat format)
+{
+	const auto& img = QRImage(format);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(BenchmarkExtractLum(img.view()));
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK_CAPTURE(BM_ExtractLum, RGB, ImageFormat::RGB);
+BENCHMARK_CAPTURE(BM_ExtractLum, RGBX, ImageFormat::RGBX);
+
+static void BM_LumImagePyramid(benchmark::State& state)
+{
+	const auto& img = QRImage();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(BenchmarkLumImagePyramid(img.view(), 100, static_cast<int>(state.range(0))));
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK(BM_LumImagePyramid)->DenseRange(2, 4);
+
+// 0: black points computed by the binarizer, 1: along with the layers, 2: derived from the previous layer
+static void BM_BinarizedLumImagePyramid(benchmark::State& state)
+{
+	// a 12 MP frame, so the layers do not fit into the cache
+	static const auto img = MakeImage(BarcodeFormat::QRCode, "https://github.com/zxing-cpp/zxing-cpp", 32, ImageFormat::Lum, 4000, 3000);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(BenchmarkBinarizedLumImagePyramid(img.view(), 100, 2, state.range(0) == 1, state.range(0) == 2));
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK(BM_BinarizedLumImagePyramid)->DenseRange(0, 2);
+
+static void BM_HybridBinarizer_getBlackMatrix(benchmark::State& state)
+{
+	const auto& img = QRImage();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(HybridBinarizer(img.view()).getBlackMatrix());
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK(BM_HybridBinarizer_getBlackMatrix);
+
+static void BM_GlobalHistogramBinarizer_getPatternRow(benchmark::State& state)
+{
+	const auto img = MakeImage(BarcodeFormat::Code128, "ZXing-C++ 1234567890", 4);
+	GlobalHistogramBinarizer binarizer(img.view());
+	PatternRow row;
+	int y = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(binarizer.getPatternRow(y, 0, row));
+		y = (y + 1) % img.height;
+	}
+	state.SetItemsProcessed(state.iterations() * img.width);
+}
+BENCHMARK(BM_GlobalHistogramBinarizer_getPatternRow);
+
+static void BM_ThresholdBinarizer_getPatternRow(benchmark::State& state)
+{
+	const auto img = MakeImage(BarcodeFormat::Code128, "ZXing-C++ 1234567890", 4);
+	ThresholdBinarizer binarizer(img.view());
+	PatternRow row;
+	int y = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(binarizer.getPatternRow(y, 0, row));
+		y = (y + 1) % img.height;
+	}
+	state.SetItemsProcessed(state.iterations() * img.width);
+}
+BENCHMARK(BM_ThresholdBinarizer_getPatternRow);
+
+static void BM_BitMatrix_GetPatternRow(benchmark::State& state)
+{
+	auto bits = HybridBinarizer(QRImage().view()).getBlackMatrix();
+	PatternRow row;
+	int y = 0;
+	for (auto _ : state) {
+		GetPatternRow(*bits, y, row, false);
+		benchmark::DoNotOptimize(row.data());
+		y = (y + 1) % bits->height();
+	}
+	state.SetItemsProcessed(state.iterations() * bits->width());
+}
+BENCHMARK(BM_BitMatrix_GetPatternRow);
+
+static void BM_EstimateFrameQuality(benchmark::State& state)
+{
+	const auto& img = QRImage();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(EstimateFrameQuality(img.view()));
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK(BM_EstimateFrameQuality);
+
+static void BM_QRCode_FindFinderPatterns(benchmark::State& state)
+{
+	auto bits = HybridBinarizer(QRImage().view()).getBlackMatrix();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(QRCode::FindFinderPatterns(*bits, state.range(0)));
+	SetPixelsProcessed(state, QRImage());
+}
+BENCHMARK(BM_QRCode_FindFinderPatterns)->Arg(false)->Arg(true);
+
+static void BM_DataMatrix_Detect(benchmark::State& state)
+{
+	// the detector traces the borders of the symbol with RegressionLines
+	static const auto img = MakeImage(BarcodeFormat::DataMatrix, "https://github.com/zxing-cpp/zxing-cpp", 8);
+	auto bits = HybridBinarizer(img.view()).getBlackMatrix();
+	for (auto _ : state)
+		for (auto&& res : DataMatrix::Detect(*bits, false, true, false)) {
+			benchmark::DoNotOptimize(res.bits().width());
+			break;
+		}
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK(BM_DataMatrix_Detect);
+
+// a rendered A4 page at 150 dpi with a QR Code of module size 4 in the lower right, as in DecodeHints::isPure use cases
+static const BitMatrix& PurePage()
+{
+	static const BitMatrix page = [] {
+		auto modules = MultiFormatWriter(BarcodeFormat::QRCode).encodeModules("https://github.com/zxing-cpp/zxing-cpp").modules;
+		BitMatrix res(1240, 1754);
+		const int x0 = 900, y0 = 1400;
+		for (int y = 0; y < modules.height() * 4; ++y)
+			for (int x = 0; x < modules.width() * 4; ++x)
+				if (modules.get(x / 4, y / 4))
+					res.set(x0 + x, y0 + y);
+		return res;
+	}();
+	return page;
+}
+
+static void BM_BitMatrix_findBoundingBox(benchmark::State& state)
+{
+	const auto& page = PurePage();
+	int left, top, width, height;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(page.findBoundingBox(left, top, width, height));
+	state.SetItemsProcessed(state.iterations() * page.width() * page.height());
+}
+BENCHMARK(BM_BitMatrix_findBoundingBox);
+
+static void BM_BitMatrix_rotate90(benchmark::State& state)
+{
+	auto bits = PurePage().copy();
+	for (auto _ : state) {
+		bits.rotate90();
+		benchmark::DoNotOptimize(bits.row(0).begin());
+	}
+	state.SetItemsProcessed(state.iterations() * bits.width() * bits.height());
+}
+BENCHMARK(BM_BitMatrix_rotate90);
+
+static void BM_BitMatrix_mirror(benchmark::State& state)
+{
+	auto bits = PurePage().copy();
+	bits.rotate90(); // 1754 x 1240
+	BitMatrix square(1240, 1240);
+	for (int y = 0; y < square.height(); ++y)
+		std::copy_n(bits.row(y).begin(), square.width(), square.row(y).begin());
+	for (auto _ : state) {
+		square.mirror();
+		benchmark::DoNotOptimize(square.row(0).begin());
+	}
+	state.SetItemsProcessed(state.iterations() * square.width() * square.height());
+}
+BENCHMARK(BM_BitMatrix_mirror);
+
+static void BM_ReadPure(benchmark::State& state)
+{
+	static const auto lum = ToMatrix<uint8_t>(PurePage());
+	const ImageView iv(lum.data(), lum.width(), lum.height(), ImageFormat::Lum);
+	const auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode).setIsPure(true).setBinarizer(Binarizer::BoolCast);
+	if (ReadBarcodes(iv, hints).empty())
+		state.SkipWithError("symbol not found");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(ReadBarcodes(iv, hints));
+	state.SetItemsProcessed(state.iterations() * lum.width() * lum.height());
+}
+BENCHMARK(BM_ReadPure);
+
+static void BM_BarcodeReader_read(benchmark::State& state)
+{
+	const auto& img = QRImage();
+	BarcodeReader reader(DecodeHints().setFormats(BarcodeFormat::QRCode).setMaxNumberOfSymbols(1).setThreads(1));
+	if (reader.read(img.view()).empty())
+		state.SkipWithError("symbol not found");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(reader.read(img.view()));
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK(BM_BarcodeReader_read);
+
+static void BM_BarcodeReader_adaptiveReaderOrder(benchmark::State& state)
+{
+	// a stream of DataMatrix frames, read with all formats enabled, with the fixed or the adaptive reader order
+	static const auto lum =
+		ToMatrix<uint8_t>(MultiFormatWriter(BarcodeFormat::DataMatrix).setMargin(20).encode("ZXing DataMatrix 0123456789", 640, 480));
+	const ImageView iv(lum.data(), lum.width(), lum.height(), ImageFormat::Lum);
+	BarcodeReader reader(DecodeHints().setMaxNumberOfSymbols(1).setThreads(1).setAdaptiveReaderOrder(state.range(0)));
+	if (reader.read(iv).empty())
+		state.SkipWithError("symbol not found");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(reader.read(iv));
+	state.SetItemsProcessed(state.iterations() * lum.width() * lum.height());
+}
+BENCHMARK(BM_BarcodeReader_adaptiveReaderOrder)->Arg(0)->Arg(1);
+
+static void BM_BarcodeReader_escalate(benchmark::State& state)
+{
+	// the default (thorough) hints on an easy image, with all passes or with the escalation policy
+	const auto& img = QRImage();
+	BarcodeReader reader(DecodeHints().setThreads(1).setEscalate(state.range(0)));
+	if (reader.read(img.view()).empty())
+		state.SkipWithError("symbol not found");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(reader.read(img.view()));
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK(BM_BarcodeReader_escalate)->Arg(0)->Arg(1);
+
+static void BM_ReadDetectOnly(benchmark::State& state)
+{
+	// a page of 4 x 3 QR Codes, decoded or only located
+	constexpr int N = 4, M = 3, S = 240;
+	static const auto lum = [] {
+		Matrix<uint8_t> res(N * S, M * S, 0xff);
+		for (int i = 0; i < N * M; ++i) {
+			auto qr = ToMatrix<uint8_t>(MultiFormatWriter(BarcodeFormat::QRCode).setMargin(10).encode(
+				"https://github.com/zxing-cpp/zxing-cpp/" + std::to_string(i), S, S));
+			for (int y = 0; y < qr.height(); ++y)
+				std::copy_n(&qr(0, y), qr.width(), &res(i % N * S, i / N * S + y));
+		}
+		return res;
+	}();
+	const ImageView iv(lum.data(), lum.width(), lum.height(), ImageFormat::Lum);
+	const auto hints = DecodeHints()
+						   .setFormats(BarcodeFormat::QRCode)
+						   .setTryInvert(false)
+						   .setTryDownscale(false)
+						   .setThreads(1)
+						   .setDetectOnly(state.range(0));
+	if (Size(ReadBarcodes(iv, hints)) != N * M)
+		state.SkipWithError("symbols not found");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(ReadBarcodes(iv, hints));
+	state.SetItemsProcessed(state.iterations() * lum.width() * lum.height());
+}
+BENCHMARK(BM_ReadDetectOnly)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+static void BM_ReadFirstSymbol(benchmark::State& state)
+{
+	// a row of 6 damaged (undecodable) QR Codes and a DataMatrix, only the first symbol found is wanted
+	constexpr int N = 6, S = 200, M = 5;
+	static const auto lum = [] {
+		Matrix<uint8_t> res((N + 1) * S, S, 0xff);
+		uint32_t seed = 42;
+		for (int i = 0; i < N; ++i) {
+			auto text = "https://github.com/zxing-cpp/zxing-cpp/" + std::to_string(i);
+			auto modules = MultiFormatWriter(BarcodeFormat::QRCode).encodeModules(text).modules;
+			const int n = modules.width();
+			for (int y = 0; y < n * M; ++y)
+				for (int x = 0; x < n * M; ++x) {
+					int mx = x / M, my = y / M;
+					bool black = modules.get(mx, my);
+					if (mx > 8 && my > 8 && mx < n - 8 && my < n - 8 && (seed = seed * 1664525 + 1013904223) >> 30 == 0)
+						black = !black;
+					res.set(i * S + 20 + x, 20 + y, black ? 0 : 0xff);
+				}
+		}
+		auto dm = ToMatrix<uint8_t>(MultiFormatWriter(BarcodeFormat::DataMatrix).setMargin(20).encode("ZXing DataMatrix", S, S));
+		for (int y = 0; y < dm.height(); ++y)
+			std::copy_n(&dm(0, y), dm.width(), &res(N * S, y));
+		return res;
+	}();
+	const ImageView iv(lum.data(), lum.width(), lum.height(), ImageFormat::Lum);
+	const auto hints = DecodeHints()
+						   .setFormats(BarcodeFormat::QRCode | BarcodeFormat::DataMatrix)
+						   .setMaxNumberOfSymbols(1)
+						   .setTryInvert(false)
+						   .setTryDownscale(false)
+						   .setThreads(1);
+	auto res = ReadBarcodes(iv, hints);
+	if (Size(res) != 1 || res.front().format() != BarcodeFormat::DataMatrix)
+		state.SkipWithError("symbol not found");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(ReadBarcodes(iv, hints));
+	state.SetItemsProcessed(state.iterations() * lum.width() * lum.height());
+}
+BENCHMARK(BM_ReadFirstSymbol)->Unit(benchmark::kMillisecond);
+
+static void BM_ReadLinearWall(benchmark::State& state)
+{
+	// an 'inventory wall' of 15 x 15 different Code128 labels
+	constexpr int N = 15, W = 200, H = 60;
+	static const auto lum = [] {
+		Matrix<uint8_t> res(N * W, N * H, 0xff);
+		for (int i = 0; i < N * N; ++i) {
+			auto label = ToMatrix<uint8_t>(MultiFormatWriter(BarcodeFormat::Code128).setMargin(10).encode(std::to_string(1000 + i), W, H));
+			for (int y = 0; y < label.height(); ++y)
+				std::copy_n(&label(0, y), label.width(), &res(i % N * W, i / N * H + y));
+		}
+		return res;
+	}();
+	const ImageView iv(lum.data(), lum.width(), lum.height(), ImageFormat::Lum);
+	const auto hints = DecodeHints()
+						   .setFormats(BarcodeFormat::Code128)
+						   .setMaxNumberOfSymbols(0xff)
+						   .setTryRotate(false)
+						   .setTryInvert(false)
+						   .setTryDownscale(false)
+						   .setThreads(1);
+	if (Size(ReadBarcodes(iv, hints)) != N * N)
+		state.SkipWithError("symbols not found");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(ReadBarcodes(iv, hints));
+	state.SetItemsProcessed(state.iterations() * lum.width() * lum.height());
+}
+BENCHMARK(BM_ReadLinearWall)->Unit(benchmark::kMillisecond);
+
+static void BM_ReadPreClassify(benchmark::State& state)
+{
+	// a single EAN-13 label in a 1280x720 frame, read with all formats enabled
+	static const auto lum = [] {
+		Matrix<uint8_t> res(1280, 720, 0xff);
+		auto label = ToMatrix<uint8_t>(MultiFormatWriter(BarcodeFormat::EAN13).setMargin(10).encode("4006381333931", 400, 150));
+		for (int y = 0; y < label.height(); ++y)
+			std::copy_n(&label(0, y), label.width(), &res(440, 285 + y));
+		return res;
+	}();
+	const ImageView iv(lum.data(), lum.width(), lum.height(), ImageFormat::Lum);
+	const auto hints = DecodeHints().setTryHarder(true).setThreads(1).setPreClassify(state.range(0));
+	if (Size(ReadBarcodes(iv, hints)) != 1)
+		state.SkipWithError("symbol not found");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(ReadBarcodes(iv, hints));
+	state.SetItemsProcessed(state.iterations() * lum.width() * lum.height());
+}
+BENCHMARK(BM_ReadPreClassify)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+static void BM_BitMatrixCursor_countEdges(benchmark::State& state)
+{
+	const auto& img = QRImage();
+	auto bits = HybridBinarizer(img.view()).getBlackMatrix();
+	const PointI dir = state.range(0) ? PointI(0, 1) : PointI(1, 0);
+	const int length = state.range(0) ? bits->height() : bits->width();
+	for (auto _ : state)
+		for (int i = 0; i < (state.range(0) ? bits->width() : bits->height()); i += 4) {
+			BitMatrixCursorI cur(*bits, state.range(0) ? PointI(i, 0) : PointI(0, i), dir);
+			benchmark::DoNotOptimize(cur.countEdges(length));
+		}
+	SetPixelsProcessed(state, img);
+}
+BENCHMARK(BM_BitMatrixCursor_countEdges)->Arg(0)->Arg(1);
+
+static void BM_SampleGrid(benchmark::State& state)
+{
+	const auto& img = QRImage();
+	auto bits = HybridBinarizer(img.view()).getBlackMatrix();
+	auto mod2Pix = PerspectiveTransform(Rectangle(0, img.dimension, 0, img.dimension, 0), img.symbol);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(SampleGrid(*bits, img.dimension, img.dimension, mod2Pix));
+	state.SetItemsProcessed(state.iterations() * img.dimension * img.dimension);
+}
+BENCHMARK(BM_SampleGrid);
+
+static void BM_ReedSolomonDecode(benchmark::State& state)
+{
+	const auto& field = GenericGF::QRCodeField256();
+	const int numECCodeWords = 30, numErrors = static_cast<int>(state.range(0));
+	std::vector<int> message(255);
+	for (int i = 0; i < Size(message); ++i)
+		message[i] = (i * 37 + 11) & 0xff;
+	ReedSolomonEncode(field, message, numECCodeWords);
+
+	std::vector<int> received;
+	for (auto _ : state) {
+		received = message;
+		for (int i = 0; i < numErrors; ++i)
+			received[(i * 97) % Size(received)] ^= 0x5a;
+		benchmark::DoNotOptimize(ReedSolomonDecode(field, received, numECCodeWords));
+	}
+}
+BENCHMARK(BM_ReedSolomonDecode)->Arg(0)->Arg(5)->Arg(15);
+
+#ifdef ZX_BENCHMARK_HAVE_FORK
+// The first read of a format in a fresh process, i.e. including the tables its reader builds on first use, e.g. the
+// QR Code data module and format information tables. Each iteration forks a child that creates the image, reads it
+// twice and reports both times through a pipe. The tables the writer shares with the reader are warm already, and so
+// are all tables if the parent did read anything before, hence run it on its own: --benchmark_filter=ColdRead
+static void BM_ColdRead(benchmark::State& state, BarcodeFormat format, std::string text)
+{
+	double warm = 0;
+	for (auto _ : state) {
+		int fds[2];
+		if (pipe(fds) != 0) {
+			state.SkipWithError("pipe() failed");
+			break;
+		}
+		pid_t pid = fork();
+		if (pid == 0) {
+			close(fds[0]);
+			auto img = MakeImage(format, text, 3);
+			const auto hints = DecodeHints().setFormats(format);
+			double seconds[2] = {-1, -1};
+			for (auto& s : seconds) {
+				auto start = std::chrono::steady_clock::now();
+				auto res = ReadBarcodes(img.view(), hints);
+				if (!res.empty())
+					s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+			_exit(write(fds[1], seconds, sizeof(seconds)) == sizeof(seconds) ? 0 : 1);
+		}
+		close(fds[1]);
+		double seconds[2] = {-1, -1};
+		bool ok = pid > 0 && read(fds[0], seconds, sizeof(seconds)) == sizeof(seconds);
+		close(fds[0]);
+		if (pid > 0)
+			waitpid(pid, nullptr, 0);
+		if (!ok || seconds[0] < 0 || seconds[1] < 0) {
+			state.SkipWithError("symbol not found");
+			break;
+		}
+		state.SetIterationTime(seconds[0]);
+		warm += seconds[1];
+	}
+	state.counters["warm_ms"] = benchmark::Counter(warm * 1000, benchmark::Counter::kAvgIterations);
+}
+#define ZX_COLD_READ(FORMAT, TEXT) \
+	BENCHMARK_CAPTURE(BM_ColdRead, FORMAT, BarcodeFormat::FORMAT, TEXT)->UseManualTime()->Unit(benchmark::kMillisecond)
+ZX_COLD_READ(Aztec, "ZXing-C++ benchmark: Aztec 0123456789");
+ZX_COLD_READ(Code128, "ZXing-C++ 0123456789");
+ZX_COLD_READ(DataMatrix, "ZXing-C++ benchmark: DataMatrix 0123456789");
+ZX_COLD_READ(EAN13, "123456789012");
+ZX_COLD_READ(PDF417, "ZXing-C++ benchmark: PDF417 0123456789");
+ZX_COLD_READ(QRCode, "ZXing-C++ benchmark: QRCode 0123456789");
+#endif
+
+static void BM_Write(benchmark::State& state, BarcodeFormat format, std::string text)
+{
+	MultiFormatWriter writer(format);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(writer.encodeModules(text));
+}
+BENCHMARK_CAPTURE(BM_Write, Aztec, BarcodeFormat::Aztec, "ZXing-C++ benchmark: Aztec 0123456789");
+BENCHMARK_CAPTURE(BM_Write, Codabar, BarcodeFormat::Codabar, "A0123456789A");
+BENCHMARK_CAPTURE(BM_Write, Code39, BarcodeFormat::Code39, "ZXING 0123456789");
+BENCHMARK_CAPTURE(BM_Write, Code93, BarcodeFormat::Code93, "ZXING 0123456789");
+BENCHMARK_CAPTURE(BM_Write, Code128, BarcodeFormat::Code128, "ZXing-C++ 0123456789");
+BENCHMARK_CAPTURE(BM_Write, DataMatrix, BarcodeFormat::DataMatrix, "ZXing-C++ benchmark: DataMatrix 0123456789");
+BENCHMARK_CAPTURE(BM_Write, EAN8, BarcodeFormat::EAN8, "1234567");
+BENCHMARK_CAPTURE(BM_Write, EAN13, BarcodeFormat::EAN13, "123456789012");
+BENCHMARK_CAPTURE(BM_Write, ITF, BarcodeFormat::ITF, "0123456789");
+BENCHMARK_CAPTURE(BM_Write, PDF417, BarcodeFormat::PDF417, "ZXing-C++ benchmark: PDF417 0123456789");
+BENCHMARK_CAPTURE(BM_Write, QRCode, BarcodeFormat::QRCode, "ZXing-C++ benchmark: QRCode 0123456789");
+BENCHMARK_CAPTURE(BM_Write, UPCA, BarcodeFormat::UPCA, "12345678901");
+BENCHMARK_CAPTURE(BM_Write, UPCE, BarcodeFormat::UPCE, "1234567");
+
+BENCHMARK_MAIN();
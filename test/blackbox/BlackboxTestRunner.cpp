@@ -14,7 +14,9 @@
 #include <fmt/core.h>
 #include <fmt/ostream.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <exception>
 #include <fstream>
 #include <map>
@@ -170,6 +172,133 @@ void preloadImageCache(const std::vector<fs::path>& imgPaths)
 	totalImageLoadTime += timeSince(startTime);
 }
 
+static PerfOptions perfOptions;
+
+struct PerfSeries
+{
+	std::string binarizer;
+	std::vector<double> latencies; // in us
+	double p50 = 0, p95 = 0, p99 = 0;
+};
+
+// key: "<folder>/<fast|slow|pure>", i.e. the latencies of all rotations of a hint configuration are pooled
+static std::map<std::string, PerfSeries> perfResults;
+
+static const char* binarizerName(Binarizer binarizer)
+{
+	switch (binarizer) {
+	case Binarizer::LocalAverage: return "LocalAverage";
+	case Binarizer::GlobalHistogram: return "GlobalHistogram";
+	case Binarizer::FixedThreshold: return "FixedThreshold";
+	case Binarizer::BoolCast: return "BoolCast";
+	case Binarizer::Adaptive: return "Adaptive";
+	}
+	return "Unknown";
+}
+
+// in performance mode (see PerfOptions), the image is read repeatedly and the latency of every read is recorded
+static Result readBarcode(const ImageView& image, const DecodeHints& hints, const std::string& perfKey)
+{
+	if (!perfOptions.repetitions)
+		return ReadBarcode(image, hints);
+
+	auto& series = perfResults[perfKey];
+	series.binarizer = binarizerName(hints.binarizer());
+	Result result;
+	for (int i = 0; i < perfOptions.repetitions; ++i) {
+		auto startTime = std::chrono::steady_clock::now();
+		result = ReadBarcode(image, hints);
+		series.latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count());
+	}
+	return result;
+}
+
+// nearest-rank percentile
+static double percentile(const std::vector<double>& sorted, int p)
+{
+	int rank = (p * Size(sorted) + 99) / 100;
+	return sorted.empty() ? 0 : sorted[std::max(rank, 1) - 1];
+}
+
+static void writePerfJson(const fs::path& path)
+{
+	std::ofstream ofs(path);
+	// one configuration per line, so readPerfBaseline does not need a JSON parser
+	fmt::print(ofs, "{{\n  \"repetitions\": {},\n  \"results\": {{\n", perfOptions.repetitions);
+	int i = 0;
+	for (const auto& [key, series] : perfResults)
+		fmt::print(ofs, "    \"{}\": {{\"binarizer\": \"{}\", \"samples\": {}, \"p50_us\": {:.1f}, \"p95_us\": {:.1f}, \"p99_us\": {:.1f}}}{}\n",
+				   key, series.binarizer, series.latencies.size(), series.p50, series.p95, series.p99,
+				   ++i < Size(perfResults) ? "," : "");
+	fmt::print(ofs, "  }}\n}}\n");
+	if (!ofs)
+		fmt::print("WARNING: could not write {}\n", path.string());
+}
+
+static std::map<std::string, PerfSeries> readPerfBaseline(const fs::path& path)
+{
+	std::map<std::string, PerfSeries> res;
+	std::ifstream ifs(path);
+	std::string line;
+	while (std::getline(ifs, line)) {
+		auto value = [&line](std::string_view name) {
+			auto pos = line.find(fmt::format("\"{}\": ", name));
+			return pos == std::string::npos ? 0. : std::atof(line.c_str() + pos + name.size() + 4);
+		};
+		auto begin = line.find('"'), end = line.find('"', begin + 1);
+		if (begin == std::string::npos || end == std::string::npos || line.find("\"p50_us\"") == std::string::npos)
+			continue;
+		auto& series = res[line.substr(begin + 1, end - begin - 1)];
+		series.p50 = value("p50_us");
+		series.p95 = value("p95_us");
+		series.p99 = value("p99_us");
+	}
+	return res;
+}
+
+static void printPerfResults()
+{
+	fmt::print("\n{:32} {:>15} {:>7} {:>9} {:>9} {:>9}\n", "latency [us]", "binarizer", "samples", "p50", "p95", "p99");
+	for (auto& [key, series] : perfResults) {
+		std::sort(series.latencies.begin(), series.latencies.end());
+		series.p50 = percentile(series.latencies, 50);
+		series.p95 = percentile(series.latencies, 95);
+		series.p99 = percentile(series.latencies, 99);
+		fmt::print("{:32} {:>15} {:7} {:9.0f} {:9.0f} {:9.0f}\n", key, series.binarizer, series.latencies.size(), series.p50,
+				   series.p95, series.p99);
+	}
+
+	if (!perfOptions.jsonPath.empty())
+		writePerfJson(perfOptions.jsonPath);
+
+	if (perfOptions.baselinePath.empty())
+		return;
+
+	auto baseline = readPerfBaseline(perfOptions.baselinePath);
+	if (baseline.empty()) {
+		fmt::print("WARNING: could not read baseline {}\n", perfOptions.baselinePath.string());
+		++failed;
+		return;
+	}
+
+	// p99 is too noisy for a handful of images to be used as a criterion, it is only reported
+	auto isSlower = [](double current, double base) { return base > 0 && current > base * (1 + perfOptions.tolerance); };
+	int regressions = 0;
+	for (const auto& [key, series] : perfResults) {
+		auto base = baseline.find(key);
+		if (base == baseline.end())
+			continue;
+		if (isSlower(series.p50, base->second.p50) || isSlower(series.p95, base->second.p95)) {
+			fmt::print("    Performance regression ({}): p50 {:.0f} vs {:.0f} us, p95 {:.0f} vs {:.0f} us\n", key, series.p50,
+					   base->second.p50, series.p95, base->second.p95);
+			++regressions;
+		}
+	}
+	fmt::print("baseline:    {} of {} configurations slower than the tolerance of {:.0f}%\n", regressions, Size(perfResults),
+			   perfOptions.tolerance * 100);
+	failed += regressions;
+}
+
 static std::string printPositiveTestStats(int imageCount, const TestCase::TC& tc)
 {
 	int passCount = imageCount - Size(tc.misReadFiles) - Size(tc.notDetectedFiles);
@@ -235,8 +364,9 @@ static void doRunTests(const fs::path& directory, std::string_view format, int t
 			hints.setIsPure(tc.name == "pure");
 			if (hints.isPure())
 				hints.setBinarizer(Binarizer::FixedThreshold);
+			auto perfKey = fmt::format("{}/{}", folderName.string(), tc.name);
 			for (const auto& imgPath : imgPaths) {
-				auto result = ReadBarcode(ImageLoader::load(imgPath).rotated(test.rotation), hints);
+				auto result = readBarcode(ImageLoader::load(imgPath).rotated(test.rotation), hints, perfKey);
 				if (result.isValid()) {
 					auto error = checkResult(imgPath, format, result);
 					if (!error.empty())
@@ -255,6 +385,27 @@ static void doRunTests(const fs::path& directory, std::string_view format, int t
 	}
 }
 
+// average per frame latency of a 'live preview' setup, i.e. without tryHarder/tryRotate/tryInvert/tryDownscale
+static void doRunLatencyBenchmark(const fs::path& directory, DecodeHints hints)
+{
+	constexpr int ROUNDS = 5;
+	auto imgPaths = getImagesInDirectory(directory);
+	if (imgPaths.empty())
+		return;
+
+	hints.setTryHarder(false).setTryRotate(false).setTryInvert(false).setTryDownscale(false);
+	int detected = 0;
+	auto startTime = std::chrono::steady_clock::now();
+	for (int i = 0; i < ROUNDS; ++i)
+		for (const auto& imgPath : imgPaths)
+			detected += ReadBarcode(ImageLoader::load(imgPath), hints).isValid();
+	auto duration = std::chrono::steady_clock::now() - startTime;
+	auto perFrame = std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / (ROUNDS * Size(imgPaths));
+
+	fmt::print("{:20} @ fast, {:3} | {}: {:3} detected | latency: {:5} us/frame\n", directory.stem().string(),
+			   Size(imgPaths), ToString(hints.formats()), detected / ROUNDS, perFrame);
+}
+
 static Result readMultiple(const std::vector<fs::path>& imgPaths, std::string_view format)
 {
 	Results allResults;
@@ -307,8 +458,10 @@ static void doRunStructuredAppendTest(const fs::path& directory, std::string_vie
 	}
 }
 
-int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>& includedTests)
+int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>& includedTests, const PerfOptions& perf)
 {
+	perfOptions = perf;
+
 	auto hasTest = [&includedTests](const fs::path& dir) {
 		auto stem = dir.stem().string();
 		return includedTests.empty() || Contains(includedTests, stem) ||
@@ -321,6 +474,11 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 			doRunTests(testPathPrefix / directory, format, total, tests, hints);
 	};
 
+	auto runLatencyBenchmark = [&](std::string_view directory, const DecodeHints& hints) {
+		if (hasTest(directory))
+			doRunLatencyBenchmark(testPathPrefix / directory, hints);
+	};
+
 	auto runStructuredAppendTest = [&](std::string_view directory, std::string_view format, int total,
 									   const std::vector<TestCase>& tests) {
 		if (hasTest(directory))
@@ -353,21 +511,21 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 			{  0, 27, 180 },
 			{  0, 27, 270 },
 			{ 28, 0, pure },
-		});
+		}, DecodeHints().setTryDataMatrixLegacyDetector(true));
 
 		runTests("datamatrix-2", "DataMatrix", 13, {
 			{ 13, 13, 0   },
 			{  0, 13, 90  },
 			{  0, 13, 180 },
 			{  0, 13, 270 },
-		});
+		}, DecodeHints().setTryDataMatrixLegacyDetector(true));
 
 		runTests("datamatrix-3", "DataMatrix", 20, {
 			{ 19, 20, 0   },
 			{  0, 20, 90  },
 			{  0, 20, 180 },
 			{  0, 20, 270 },
-		});
+		}, DecodeHints().setTryDataMatrixLegacyDetector(true));
 
 		runTests("datamatrix-4", "DataMatrix", 21, {
 			{ 21, 21, 0   },
@@ -375,7 +533,7 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 			{  0, 21, 180 },
 			{  0, 21, 270 },
 			{ 19, 0, pure },
-		});
+		}, DecodeHints().setTryDataMatrixLegacyDetector(true));
 
 		runTests("codabar-1", "Codabar", 11, {
 			{ 11, 11, 0   },
@@ -448,6 +606,10 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 			{ 8, 13, 180 },
 		});
 
+		// retail point of sale setup: only EAN-13/UPC-A, see the left guard search and checksum pruning in MultiUPCEANReader
+		for (auto dir : {"ean13-1", "ean13-2", "ean13-3", "ean13-4"})
+			runLatencyBenchmark(dir, DecodeHints().setFormats(BarcodeFormat::EAN13 | BarcodeFormat::UPCA));
+
 		runTests("ean13-extension-1", "EAN-13", 5, {
 			{ 3, 5, 0 },
 			{ 3, 5, 180 },
@@ -656,6 +818,8 @@ int runBlackBoxTests(const fs::path& testPathPrefix, const std::set<std::string>
 		// clang-format on
 
 		int totalTime = timeSince(startTime);
+		if (perfOptions.repetitions)
+			printPerfResults();
 		int decodeTime = totalTime - totalImageLoadTime;
 		fmt::print("load time:   {} ms.\n", totalImageLoadTime);
 		fmt::print("decode time: {} ms.\n", decodeTime);
@@ -12,6 +12,14 @@
 
 namespace ZXing::Test {
 
-int runBlackBoxTests(const fs::path& blackboxPath, const std::set<std::string>& includedTests);
+struct PerfOptions
+{
+	int repetitions = 0;     // number of reads per image, 0 disables the performance mode
+	fs::path jsonPath;       // if set, the latency percentiles are written to this file
+	fs::path baselinePath;   // if set, the percentiles are compared to this file (written by a previous run)
+	double tolerance = 0.25; // relative slowdown of p50 or p95 vs. the baseline that is counted as a failure
+};
+
+int runBlackBoxTests(const fs::path& blackboxPath, const std::set<std::string>& includedTests, const PerfOptions& perf = {});
 
 } // ZXing::Test
@@ -10,11 +10,13 @@
 #include "ZXAlgorithms.h"
 #include "ZXFilesystem.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <set>
+#include <string_view>
 
 using namespace ZXing;
 using namespace ZXing::Test;
@@ -28,7 +30,13 @@ int getEnv(const char* name, int fallback = 0)
 int main(int argc, char** argv)
 {
 	if (argc <= 1) {
-		std::cout << "Usage: " << argv[0] << " <test_path_prefix>" << std::endl;
+		std::cout << "Usage: " << argv[0] << " <test_path_prefix> [-t<test>]... [--perf[=N]] [--json=<file>] [--baseline=<file>] [--tolerance=<percent>]\n"
+				  << "       " << argv[0] << " <image file>...\n"
+				  << "\n"
+				  << "  --perf[=N]        read each image N (default 10) times and report the p50/p95/p99 latencies\n"
+				  << "  --json=<file>     write the latencies to a JSON file (implies --perf)\n"
+				  << "  --baseline=<file> fail if p50 or p95 are slower than in a JSON file of a previous run (implies --perf)\n"
+				  << "  --tolerance=<%>   allowed slowdown compared to the baseline (default 25)\n";
 		return 0;
 	}
 
@@ -55,12 +63,29 @@ int main(int argc, char** argv)
 		return 0;
 	} else {
 		std::set<std::string> includedTests;
+		PerfOptions perf;
+		auto option = [](const char* arg, std::string_view name) -> const char* {
+			auto len = name.size();
+			if (std::strncmp(arg, name.data(), len) != 0 || (arg[len] != '\0' && arg[len] != '='))
+				return nullptr;
+			return arg[len] == '=' ? arg + len + 1 : arg + len;
+		};
 		for (int i = 2; i < argc; ++i) {
-			if (std::strlen(argv[i]) > 2 && argv[i][0] == '-' && argv[i][1] == 't') {
+			if (auto val = option(argv[i], "--perf")) {
+				perf.repetitions = *val ? std::max(1, atoi(val)) : 10;
+			} else if (auto val = option(argv[i], "--json")) {
+				perf.jsonPath = val;
+			} else if (auto val = option(argv[i], "--baseline")) {
+				perf.baselinePath = val;
+			} else if (auto val = option(argv[i], "--tolerance")) {
+				perf.tolerance = atof(val) / 100;
+			} else if (std::strlen(argv[i]) > 2 && argv[i][0] == '-' && argv[i][1] == 't') {
 				includedTests.insert(argv[i] + 2);
 			}
 		}
+		if (!perf.repetitions && (!perf.jsonPath.empty() || !perf.baselinePath.empty()))
+			perf.repetitions = 10;
 
-		return runBlackBoxTests(pathPrefix, includedTests);
+		return runBlackBoxTests(pathPrefix, includedTests, perf);
 	}
 }
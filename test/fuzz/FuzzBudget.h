@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026 ZXing authors
+ */
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#if __has_include(<sanitizer/allocator_interface.h>)
+#include <sanitizer/allocator_interface.h>
+#define ZX_FUZZ_COUNT_ALLOCATIONS
+#endif
+
+// Performance fuzzing: a FuzzBudget aborts (i.e. makes libFuzzer report the input as a crash) if the code running
+// during its lifetime takes longer or allocates more heap memory in total than the given budget. This turns
+// algorithmic complexity blowups (e.g. quadratic candidate generation on dense noise) into reproducible test cases,
+// long before they would hit the -timeout/-rss_limit_mb of libFuzzer. All budgets are multiplied by the environment
+// variable ZXING_FUZZ_BUDGET_SCALE (default 1), e.g. for slower machines or additional sanitizers.
+
+namespace ZXing::Fuzz {
+
+inline std::atomic<size_t> AllocatedBytes = 0;
+
+#ifdef ZX_FUZZ_COUNT_ALLOCATIONS
+inline void MallocHook(const volatile void*, size_t size)
+{
+	AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+inline void FreeHook(const volatile void*) {}
+
+inline const bool HooksInstalled = __sanitizer_install_malloc_and_free_hooks(MallocHook, FreeHook);
+#endif
+
+inline double BudgetScale()
+{
+	static const double scale = [] {
+		auto env = std::getenv("ZXING_FUZZ_BUDGET_SCALE");
+		return env ? std::atof(env) : 1.0;
+	}();
+	return scale > 0 ? scale : 1.0;
+}
+
+class FuzzBudget
+{
+	using Clock = std::chrono::steady_clock;
+
+	const char* _name;
+	Clock::time_point _start = Clock::now();
+	size_t _startBytes = AllocatedBytes.load();
+	double _maxMilliseconds;
+	double _maxBytes;
+
+public:
+	FuzzBudget(const char* name, double maxMilliseconds, double maxBytes)
+		: _name(name), _maxMilliseconds(maxMilliseconds * BudgetScale()), _maxBytes(maxBytes * BudgetScale())
+	{}
+
+	~FuzzBudget()
+	{
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - _start).count();
+		double bytes = static_cast<double>(AllocatedBytes.load() - _startBytes);
+		if (ms > _maxMilliseconds) {
+			std::fprintf(stderr, "%s: time budget exceeded: %.1f ms > %.1f ms\n", _name, ms, _maxMilliseconds);
+			std::abort();
+		}
+		if (bytes > _maxBytes) {
+			std::fprintf(stderr, "%s: allocation budget exceeded: %.0f bytes > %.0f bytes\n", _name, bytes, _maxBytes);
+			std::abort();
+		}
+	}
+
+	FuzzBudget(const FuzzBudget&) = delete;
+	FuzzBudget& operator=(const FuzzBudget&) = delete;
+};
+
+} // namespace ZXing::Fuzz
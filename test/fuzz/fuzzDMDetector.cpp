@@ -0,0 +1,44 @@
+/*
+ * Copyright 2026 ZXing authors
+ */
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "BitMatrix.h"
+#include "DetectorResult.h"
+#include "FuzzBudget.h"
+#include "datamatrix/DMDetector.h"
+
+using namespace ZXing;
+
+// The DataMatrix detector (tryHarder, i.e. including the edge tracing multi-symbol detector) on an arbitrary bit
+// matrix. The first byte selects the width in bytes, every bit of the rest is a pixel, scaled up by 2 to get
+// traceable edges.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if (size < 2)
+		return 0;
+
+	int rowBytes = 1 + data[0] % 32;
+	int width = rowBytes * 8 * 2;
+	int height = static_cast<int>((size - 1) / rowBytes) * 2;
+	if (height < 16)
+		return 0;
+
+	BitMatrix image(width, height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			if ((data[1 + (y / 2) * rowBytes + x / 16] >> (x / 2 % 8)) & 1)
+				image.set(x, y);
+
+	Fuzz::FuzzBudget budget("DataMatrix::Detect", 50 + width * height * 0.01, 4e6 + width * height * 100.);
+	try {
+		for (auto&& res : DataMatrix::Detect(image, true, true, false))
+			(void)res;
+	} catch (...) {
+	}
+
+	return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026 ZXing authors
+ */
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "BitMatrix.h"
+#include "DecoderResult.h"
+#include "FuzzBudget.h"
+#include "ResultPoint.h"
+#include "ZXNullable.h"
+#include "pdf417/PDFRotatedBitMatrix.h"
+#include "pdf417/PDFScanningDecoder.h"
+
+using namespace ZXing;
+using namespace ZXing::Pdf417;
+
+// The PDF417 scanning decoder on an arbitrary bit matrix with the image corners as symbol corners. Noisy rows produce
+// many ambiguous codeword values, which are resolved by trying combinations of them (see
+// CreateDecoderResultFromAmbiguousValues), so this is where a complexity blowup would show up. The first byte
+// selects the width in bytes and the module width, every bit of the rest is a module.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if (size < 2)
+		return 0;
+
+	int rowBytes = 1 + data[0] % 32;
+	int moduleWidth = 1 + (data[0] >> 5) % 3;
+	int width = rowBytes * 8 * moduleWidth;
+	int height = static_cast<int>((size - 1) / rowBytes);
+	if (height < 3)
+		return 0;
+
+	BitMatrix image(width, height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			if ((data[1 + y * rowBytes + x / moduleWidth / 8] >> (x / moduleWidth % 8)) & 1)
+				image.set(x, y);
+
+	auto corner = [](int x, int y) { return Nullable<ResultPoint>(ResultPoint(x, y)); };
+	Fuzz::FuzzBudget budget("Pdf417::ScanningDecoder", 50 + width * height * 0.01, 4e6 + width * height * 100.);
+	try {
+		ScanningDecoder::Decode(RotatedBitMatrix(image, 0), corner(0, 0), corner(0, height - 1), corner(width - 1, 0),
+								corner(width - 1, height - 1), 17 * moduleWidth - 2, 17 * moduleWidth + 2);
+	} catch (...) {
+	}
+
+	return 0;
+}
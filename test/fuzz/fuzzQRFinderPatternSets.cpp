@@ -0,0 +1,37 @@
+/*
+ * Copyright 2026 ZXing authors
+ */
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FuzzBudget.h"
+#include "qrcode/QRDetector.h"
+
+#include <algorithm>
+
+using namespace ZXing;
+using namespace ZXing::QRCode;
+
+// GenerateFinderPatternSets on an arbitrary list of finder patterns (x, y: 2 bytes each, size: 1 byte). The input
+// is limited to the number of patterns a dense image can realistically produce (e.g. a sheet of small symbols or
+// noise), the budget has to hold for a worst case arrangement of those.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	constexpr int MAX_PATTERNS = 300;
+
+	FinderPatterns patterns;
+	for (size_t i = 0; i + 5 <= size && patterns.size() < MAX_PATTERNS; i += 5) {
+		ConcentricPattern p;
+		p.x = (data[i] << 8 | data[i + 1]) % 4096;
+		p.y = (data[i + 2] << 8 | data[i + 3]) % 4096;
+		p.size = 7 + data[i + 4] % 64;
+		patterns.push_back(p);
+	}
+
+	Fuzz::FuzzBudget budget("GenerateFinderPatternSets", 250, 4e6);
+	GenerateFinderPatternSets(patterns);
+
+	return 0;
+}
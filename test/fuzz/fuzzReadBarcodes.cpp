@@ -0,0 +1,36 @@
+/*
+ * Copyright 2026 ZXing authors
+ */
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FuzzBudget.h"
+#include "ReadBarcode.h"
+
+using namespace ZXing;
+
+// The whole reader pipeline with all formats on an arbitrary grayscale image. The first byte selects the width, the
+// rest are the pixels. The budget grows linearly with the number of pixels, anything superlinear gets reported.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if (size < 2)
+		return 0;
+
+	int width = 8 + data[0] % 249;
+	int height = static_cast<int>((size - 1) / width);
+	if (height < 8)
+		return 0;
+
+	auto hints = DecodeHints().setTryHarder(true).setTryRotate(true).setTryInvert(true).setReturnErrors(true);
+	double pixels = double(width) * height;
+
+	Fuzz::FuzzBudget budget("ReadBarcodes", 100 + pixels * 0.02, 16e6 + pixels * 400);
+	try {
+		ReadBarcodes({data + 1, width, height, ImageFormat::Lum}, hints);
+	} catch (...) {
+	}
+
+	return 0;
+}
@@ -0,0 +1,58 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AdaptiveBinarizer.h"
+
+#include "BitMatrix.h"
+#include "MultiFormatWriter.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace ZXing;
+
+// Helper to render a barcode with a strong horizontal illumination gradient, where the black modules on the bright
+// side are lighter than the white ones on the dark side
+static std::vector<uint8_t> MakeUnevenImage(BarcodeFormat format, const std::string& text, int width, int height)
+{
+	auto bits = MultiFormatWriter(format).setMargin(10).encode(text, width, height);
+	std::vector<uint8_t> buf(bits.width() * bits.height());
+	for (int y = 0; y < bits.height(); ++y)
+		for (int x = 0; x < bits.width(); ++x) {
+			int light = 40 + 215 * x / bits.width();
+			buf[y * bits.width() + x] = static_cast<uint8_t>(bits.get(x, y) ? light * 4 / 10 : light);
+		}
+	return buf;
+}
+
+TEST(AdaptiveBinarizerTest, UnevenIllumination)
+{
+	auto buf = MakeUnevenImage(BarcodeFormat::QRCode, "Adaptive", 300, 300);
+	ImageView iv(buf.data(), 300, 300, ImageFormat::Lum);
+
+	AdaptiveBinarizer bin(iv);
+	auto bits = bin.getBitMatrix();
+	ASSERT_NE(bits, nullptr);
+	EXPECT_FALSE(bits->get(5, 5));     // bright quiet zone
+	EXPECT_FALSE(bits->get(5, 150));   // dark quiet zone
+
+	auto res = ReadBarcodes(iv, DecodeHints().setBinarizer(Binarizer::Adaptive).setFormats(BarcodeFormat::QRCode));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), "Adaptive");
+}
+
+TEST(AdaptiveBinarizerTest, LinearCodes)
+{
+	auto buf = MakeUnevenImage(BarcodeFormat::Code128, "Adaptive", 400, 60);
+	ImageView iv(buf.data(), 400, 60, ImageFormat::Lum);
+
+	for (int rotation : {0, 90, 180, 270}) {
+		auto res = ReadBarcodes(iv.rotated(rotation), DecodeHints().setBinarizer(Binarizer::Adaptive).setFormats(BarcodeFormat::Code128));
+		ASSERT_EQ(res.size(), 1) << rotation;
+		EXPECT_EQ(res[0].text(), "Adaptive");
+	}
+}
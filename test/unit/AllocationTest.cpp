@@ -0,0 +1,197 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ReadBarcode.h"
+
+#include "BitMatrix.h"
+#include "ConcentricFinder.h"
+#include "MultiFormatWriter.h"
+#include "ZXConfig.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// This file is built into its own executable (AllocationTest), because it replaces the global operator new to count
+// the heap allocations of the calling thread. It guards the steady state of a reused BarcodeReader: after the first
+// read() of an image (the warm-up), which sizes the internal buffers and caches, subsequent reads of the same image must
+// allocate exactly the same every time (no growth) and stay within a fixed budget per symbology. What remains is the
+// BitMatrix of the binarizer, the detector and decoder book keeping and the returned Results. The budgets are about
+// 25% above what libstdc++ needs, lower them when the hot path gets leaner. With std::pmr support, the pattern row cache
+// shared by the 2D detectors is served from the arena of the BarcodeReader (see ArenaResource).
+
+namespace {
+
+thread_local bool counting = false;
+thread_local long allocCount = 0;
+thread_local long allocBytes = 0;
+
+void* CountedAlloc(std::size_t size, std::size_t alignment = 0)
+{
+	if (counting) {
+		++allocCount;
+		allocBytes += static_cast<long>(size);
+	}
+	// aligned_alloc needs the size to be a multiple of the alignment
+	size = alignment ? (size + alignment - 1) / alignment * alignment : std::max<std::size_t>(size, 1);
+#ifdef _WIN32
+	void* p = alignment ? _aligned_malloc(size, alignment) : std::malloc(size);
+#else
+	void* p = alignment ? std::aligned_alloc(alignment, size) : std::malloc(size);
+#endif
+	if (p)
+		return p;
+	throw std::bad_alloc();
+}
+
+void AlignedFree(void* p)
+{
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	try {
+		return CountedAlloc(size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void* operator new(std::size_t size, std::align_val_t al) { return CountedAlloc(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return CountedAlloc(size, static_cast<std::size_t>(al)); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { AlignedFree(p); }
+
+using namespace ZXing;
+
+namespace {
+
+struct Allocations
+{
+	long count = 0, bytes = 0;
+};
+
+// Count the allocations done by f() on the calling thread
+template <typename FUNC>
+Allocations CountAllocations(FUNC f)
+{
+	allocCount = allocBytes = 0;
+	counting = true;
+	f();
+	counting = false;
+	return {allocCount, allocBytes};
+}
+
+struct Sample
+{
+	BarcodeFormat format;
+	std::string text;
+	int width, height;
+	long maxCount;  // maximum number of allocations per read in the steady state
+	long maxBytes;  // maximum number of bytes allocated per read in the steady state
+};
+
+void CheckSteadyState(const Sample& s)
+{
+	auto img = ToMatrix<uint8_t>(MultiFormatWriter(s.format).setMargin(10).encode(s.text, s.width, s.height));
+	ImageView iv(img.data(), img.width(), img.height(), ImageFormat::Lum);
+
+	// single threaded, so all allocations happen on this thread
+	BarcodeReader reader(DecodeHints().setFormats(s.format).setMaxNumberOfSymbols(1).setThreads(1));
+
+	auto warmUp = CountAllocations([&] { ASSERT_EQ(reader.read(iv).size(), 1); });
+
+	Allocations first;
+	for (int i = 0; i < 10; ++i) {
+		Results res;
+		auto a = CountAllocations([&] { res = reader.read(iv); });
+		ASSERT_EQ(res.size(), 1) << ToString(s.format);
+		EXPECT_EQ(res.front().text(), s.text);
+
+		if (i == 0)
+			first = a;
+		// the steady state does not change from read to read
+		EXPECT_EQ(a.count, first.count) << ToString(s.format) << " read " << i;
+		EXPECT_EQ(a.bytes, first.bytes) << ToString(s.format) << " read " << i;
+	}
+
+	std::printf("%-10s warm-up: %5ld allocations %8ld bytes, steady state: %5ld allocations %8ld bytes\n",
+				ToString(s.format).c_str(), warmUp.count, warmUp.bytes, first.count, first.bytes);
+
+	EXPECT_LE(first.count, s.maxCount) << ToString(s.format);
+	EXPECT_LE(first.bytes, s.maxBytes) << ToString(s.format);
+	EXPECT_LE(first.bytes, warmUp.bytes) << ToString(s.format);
+}
+
+} // namespace
+
+TEST(AllocationTest, CountingWorks)
+{
+	auto a = CountAllocations([] { delete new int(1); });
+	EXPECT_EQ(a.count, 1);
+	EXPECT_EQ(a.bytes, sizeof(int));
+}
+
+TEST(AllocationTest, QRCode)
+{
+#ifdef ZX_HAVE_PMR
+	constexpr long maxCount = 60;
+#else
+	constexpr long maxCount = 200;
+#endif
+	CheckSteadyState({BarcodeFormat::QRCode, "https://github.com/zxing-cpp/zxing-cpp", 320, 320, maxCount, 260000});
+}
+
+TEST(AllocationTest, EAN13)
+{
+	CheckSteadyState({BarcodeFormat::EAN13, "4006381333931", 400, 100, 45, 7500});
+}
+
+TEST(AllocationTest, DataMatrix)
+{
+	CheckSteadyState({BarcodeFormat::DataMatrix, "ZXing DataMatrix 0123456789", 240, 240, 30, 90000});
+}
+
+TEST(AllocationTest, PDF417)
+{
+	CheckSteadyState({BarcodeFormat::PDF417, "ZXing PDF417 0123456789", 400, 160, 45, 100000});
+}
+
+TEST(AllocationTest, ConcentricPatternCorners)
+{
+	// the top left finder pattern of a QR Code with a module size of 8 and a quiet zone of 4 modules
+	auto bits = MultiFormatWriter(BarcodeFormat::QRCode).setMargin(4).encode("ZXing", 0, 0);
+	bits = Inflate(std::move(bits), bits.width() * 8, bits.height() * 8, 0);
+	const PointF center((4 + 3.5) * 8, (4 + 3.5) * 8);
+
+	auto warmUp = CountAllocations([&] { ASSERT_TRUE(FindConcentricPatternCorners(bits, center, 7 * 8, 2)); });
+	auto a = CountAllocations([&] { ASSERT_TRUE(FindConcentricPatternCorners(bits, center, 7 * 8, 2)); });
+
+	EXPECT_GT(warmUp.count, 0); // the per thread ring point buffer
+	EXPECT_EQ(a.count, 0);
+}
@@ -0,0 +1,84 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ArenaResource.h"
+
+#include "gtest/gtest.h"
+
+#ifdef ZX_HAVE_PMR
+
+#include <vector>
+
+using namespace ZXing;
+
+namespace {
+
+// forwards to new/delete and counts the allocations
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	int count = 0;
+	int live = 0;
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		++count, ++live;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+	{
+		--live;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+};
+
+void Session(ArenaResource& arena, int n)
+{
+	std::pmr::vector<std::pmr::vector<int>> rows(&arena);
+	for (int i = 0; i < n; ++i)
+		rows.emplace_back(i + 1, i);
+	for (int i = 0; i < n; ++i)
+		ASSERT_EQ(rows[i].back(), i);
+}
+
+} // namespace
+
+TEST(ArenaResourceTest, SteadyState)
+{
+	CountingResource upstream;
+	{
+		ArenaResource arena(&upstream);
+		EXPECT_EQ(arena.capacity(), 0u);
+
+		Session(arena, 100);
+		EXPECT_GT(upstream.count, 0);
+		arena.release();
+		EXPECT_GT(arena.capacity(), 100 * (100 + 1) / 2 * sizeof(int));
+		EXPECT_EQ(upstream.live, 1); // the initial buffer of the next session
+
+		// the same work again is served from the initial buffer
+		int count = upstream.count;
+		for (int i = 0; i < 3; ++i) {
+			Session(arena, 100);
+			arena.release();
+		}
+		EXPECT_EQ(upstream.count, count);
+
+		// more work grows the buffer once
+		auto capacity = arena.capacity();
+		Session(arena, 200);
+		arena.release();
+		EXPECT_GT(arena.capacity(), capacity);
+		count = upstream.count;
+		Session(arena, 200);
+		arena.release();
+		EXPECT_EQ(upstream.count, count);
+	}
+	EXPECT_EQ(upstream.live, 0);
+}
+
+#endif // ZX_HAVE_PMR
@@ -0,0 +1,155 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BinaryBitmap.h"
+
+#include "BitMatrix.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace ZXing;
+
+namespace {
+
+// binary bitmap serving a fixed BitMatrix
+class MatrixBitmap : public BinaryBitmap
+{
+	const BitMatrix& _bits;
+	int _rowAlignment;
+
+public:
+	explicit MatrixBitmap(const BitMatrix& bits, int rowAlignment = 1)
+		: BinaryBitmap(ImageView(nullptr, bits.width(), bits.height(), ImageFormat::Lum)), _bits(bits), _rowAlignment(rowAlignment)
+	{}
+	bool getPatternRow(int, int, PatternRow&) const override { return false; }
+	std::shared_ptr<const BitMatrix> getBlackMatrix() const override
+	{
+		auto res = std::make_shared<BitMatrix>(_bits.width(), _bits.height(), _rowAlignment);
+		for (int y = 0; y < _bits.height(); ++y)
+			std::copy(_bits.row(y).begin(), _bits.row(y).end(), res->row(y).begin());
+		return res;
+	}
+};
+
+// reference implementation of the closing operation using a temporary matrix
+template <typename F>
+void SumFilter(const BitMatrix& in, BitMatrix& out, F func)
+{
+	const auto* in0 = in.row(0).begin();
+	const auto* in1 = in.row(1).begin();
+	const auto* in2 = in.row(2).begin();
+
+	for (auto *out1 = out.row(1).begin() + 1, *end = out.row(out.height() - 1).begin() - 1; out1 != end; ++in0, ++in1, ++in2, ++out1) {
+		int sum = 0;
+		for (int j = 0; j < 3; ++j)
+			sum += in0[j] + in1[j] + in2[j];
+
+		*out1 = func(sum);
+	}
+}
+
+BitMatrix Close(const BitMatrix& in)
+{
+	BitMatrix res = in.copy();
+	BitMatrix tmp(in.width(), in.height());
+	SumFilter(res, tmp, [](int sum) { return (sum > 0 * BitMatrix::SET_V) * BitMatrix::SET_V; });
+	SumFilter(tmp, res, [](int sum) { return (sum == 9 * BitMatrix::SET_V) * BitMatrix::SET_V; });
+	return res;
+}
+
+// the cached row including the leading white run, see PatternView(const PatternRow&)
+PatternRow ToRow(PatternView view)
+{
+	return PatternRow(view.begin() - 1, view.end());
+}
+
+} // namespace
+
+TEST(BinaryBitmapTest, Close)
+{
+	std::srand(42);
+	for (auto [w, h] : {std::pair{3, 3}, {4, 7}, {17, 5}, {64, 64}, {101, 33}}) {
+		for (int density : {10, 50, 90}) {
+			BitMatrix bits(w, h);
+			for (int y = 0; y < h; ++y)
+				for (int x = 0; x < w; ++x)
+					bits.set(x, y, std::rand() % 100 < density);
+
+			for (int rowAlignment : {1, BitMatrix::ROW_ALIGNMENT}) {
+				MatrixBitmap bitmap(bits, rowAlignment);
+				bitmap.getBitMatrix();
+				bitmap.close();
+				EXPECT_TRUE(bitmap.closed());
+				EXPECT_TRUE(*bitmap.getBitMatrix() == Close(bits)) << w << "x" << h << " " << density << " " << rowAlignment;
+			}
+		}
+	}
+}
+
+TEST(BinaryBitmapTest, PatternRowCache)
+{
+	BitMatrix bits(20, 3);
+	for (int x : {0, 1, 5, 6, 7, 19})
+		bits.set(x, 1);
+
+	MatrixBitmap bitmap(bits);
+	ASSERT_NE(bitmap.getBitMatrix(), nullptr);
+
+	PatternRow expected;
+	GetPatternRow(bits, 1, expected, false);
+	EXPECT_EQ(ToRow(bitmap.getBitMatrixPatternRow(1)), expected);
+	EXPECT_EQ(bitmap.getBitMatrixPatternRow(1).data(), bitmap.getBitMatrixPatternRow(1).data());
+
+	// rows 0 and 1 are cached before inverting (and get transformed in place), row 2 is not
+	bitmap.getBitMatrixPatternRow(0);
+	bitmap.invert();
+	for (int y = 0; y < 3; ++y) {
+		GetPatternRow(*bitmap.getBitMatrix(), y, expected, false);
+		EXPECT_EQ(ToRow(bitmap.getBitMatrixPatternRow(y)), expected) << y;
+	}
+	EXPECT_EQ(ToRow(bitmap.getBitMatrixPatternRow(1)).front(), 2); // the 2 black pixels at the start are now white
+
+	bitmap.invert();
+	for (int y = 0; y < 3; ++y) {
+		GetPatternRow(bits, y, expected, false);
+		EXPECT_EQ(ToRow(bitmap.getBitMatrixPatternRow(y)), expected) << y;
+	}
+}
+
+#ifdef ZX_HAVE_PMR
+TEST(BinaryBitmapTest, PatternRowCacheMemoryResource)
+{
+	struct CountingResource : std::pmr::memory_resource
+	{
+		int count = 0;
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			++count;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+		{
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+		bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+	} resource;
+
+	BitMatrix bits(20, 3);
+	bits.set(5, 1);
+
+	MatrixBitmap bitmap(bits);
+	bitmap.setMemoryResource(&resource);
+	ASSERT_NE(bitmap.getBitMatrix(), nullptr);
+	EXPECT_EQ(resource.count, 1); // the vector of rows
+
+	PatternRow expected;
+	GetPatternRow(bits, 1, expected, false);
+	EXPECT_EQ(ToRow(bitmap.getBitMatrixPatternRow(1)), expected);
+	EXPECT_EQ(resource.count, 2);
+}
+#endif
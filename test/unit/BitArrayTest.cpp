@@ -0,0 +1,78 @@
+/*
+* Copyright 2017 Axel Waggershauser
+* Copyright 2007 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitArray.h"
+#include "BitArrayUtility.h"
+#include "ByteArray.h"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+using namespace ZXing;
+
+TEST(BitArrayTest, GetSet)
+{
+	BitArray array(150);
+	for (int i = 0; i < array.size(); i += 3)
+		array.set(i, true);
+	for (int i = 0; i < array.size(); ++i)
+		EXPECT_EQ(array.get(i), i % 3 == 0) << i;
+	array.set(63, false);
+	array.set(64, true);
+	EXPECT_FALSE(array.get(63));
+	EXPECT_TRUE(array.get(64));
+	EXPECT_THROW(array.get(150), std::out_of_range);
+}
+
+TEST(BitArrayTest, AppendBits)
+{
+	BitArray array;
+	// cross the word boundary with a number of different alignments
+	for (int i = 0; i < 20; ++i)
+		array.appendBits(0x1E, 6);
+	array.appendBits(0xDEADBEEF, 32);
+	array.appendBit(true);
+
+	EXPECT_EQ(array.size(), 20 * 6 + 32 + 1);
+	for (int i = 0; i < 20; ++i)
+		EXPECT_EQ(array.getBits(6 * i, 6), 0x1E) << i;
+	EXPECT_EQ(static_cast<unsigned>(array.getBits(120, 32)), 0xDEADBEEF);
+	EXPECT_TRUE(array.get(152));
+	EXPECT_EQ(Utility::ToString(array).substr(0, 12), ".XXXX..XXXX.");
+}
+
+TEST(BitArrayTest, AppendBitArray)
+{
+	auto a = Utility::ParseBitArray("1011", '1');
+	auto b = Utility::ParseBitArray("110010111011101000101111010100101011010101101010101011011010101110101", '1');
+	a.appendBitArray(b);
+	EXPECT_EQ(Utility::ToString(a, '1', '0'), "1011" "110010111011101000101111010100101011010101101010101011011010101110101");
+
+	BitArray c;
+	c.appendBitArray(b);
+	EXPECT_EQ(c, b);
+}
+
+TEST(BitArrayTest, ToBytes)
+{
+	BitArray array;
+	array.appendBits(0x12345, 20);
+	EXPECT_EQ(array.toBytes(), ByteArray({0x12, 0x34, 0x50}));
+	EXPECT_EQ(array.toBytes(4, 2), ByteArray({0x23, 0x45}));
+	EXPECT_THROW(array.toBytes(4, 3), std::out_of_range);
+}
+
+TEST(BitArrayTest, ReverseAndXor)
+{
+	auto a = Utility::ParseBitArray("1100000000000000000000000000000000000000000000000000000000000000001", '1');
+	a.reverse();
+	EXPECT_EQ(Utility::ToString(a, '1', '0'), "1000000000000000000000000000000000000000000000000000000000000000011");
+
+	auto b = Utility::ParseBitArray("1010000000000000000000000000000000000000000000000000000000000000010", '1');
+	a.bitwiseXOR(b);
+	EXPECT_EQ(Utility::ToString(a, '1', '0'), "0010000000000000000000000000000000000000000000000000000000000000001");
+}
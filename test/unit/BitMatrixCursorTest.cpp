@@ -0,0 +1,133 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitMatrixCursor.h"
+#include "PseudoRandom.h"
+
+#include "gtest/gtest.h"
+
+using namespace ZXing;
+
+namespace {
+
+// the pixel by pixel implementation of BitMatrixCursor::stepToEdge
+template <typename POINT>
+int StepToEdgeReference(BitMatrixCursor<POINT>& cur, int nth, int range, bool backup)
+{
+	int steps = 0;
+	auto lv = cur.testAt(cur.p);
+
+	while (nth && (!range || steps < range) && lv.isValid()) {
+		++steps;
+		auto v = cur.testAt(cur.p + steps * cur.d);
+		if (lv != v) {
+			lv = v;
+			--nth;
+		}
+	}
+	if (backup)
+		--steps;
+	cur.p += steps * cur.d;
+	return steps * (nth == 0);
+}
+
+// runs of random length, so that some are longer than the 16 pixels compared at once
+BitMatrix RandomRuns(int width, int height, PseudoRandom& rnd)
+{
+	BitMatrix res(width, height);
+	bool black = false;
+	for (int i = 0, run = 0; i < width * height; ++i, --run) {
+		if (run <= 0) {
+			black = !black;
+			run = rnd.next(1, rnd.next(0, 1) ? 4 : 40);
+		}
+		res.set(i % width, i / width, black);
+	}
+	return res;
+}
+
+template <typename POINT>
+void CheckStepToEdge(const BitMatrix& image, PseudoRandom& rnd)
+{
+	const POINT dirs[] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+	for (int i = 0; i < 2000; ++i) {
+		POINT p(rnd.next(0, image.width() - 1), rnd.next(0, image.height() - 1));
+		if constexpr (std::is_same_v<POINT, PointF>)
+			p += PointF(0.5, 0.5);
+		BitMatrixCursor<POINT> fast(image, p, dirs[i % 4]), ref = fast;
+		int nth = rnd.next(1, 4), range = rnd.next(0, 1) ? 0 : rnd.next(1, 100);
+		bool backup = rnd.next(0, 1);
+
+		EXPECT_EQ(fast.stepToEdge(nth, range, backup), StepToEdgeReference(ref, nth, range, backup));
+		EXPECT_EQ(fast.p, ref.p);
+	}
+}
+
+} // namespace
+
+TEST(BitMatrixCursorTest, RunLength)
+{
+	std::vector<uint8_t> row(100, 0);
+	row[70] = 1;
+	EXPECT_EQ(RunLength(row.data(), 1, 99), 70);
+	EXPECT_EQ(RunLength(row.data(), 1, 69), 70);
+	EXPECT_EQ(RunLength(row.data(), 1, 20), 21);
+	EXPECT_EQ(RunLength(row.data() + 99, -1, 99), 29);
+	EXPECT_EQ(RunLength(row.data() + 99, -1, 28), 29);
+	EXPECT_EQ(RunLength(row.data() + 20, -1, 20), 21);
+	EXPECT_EQ(RunLength(row.data(), 10, 9), 7);
+	EXPECT_EQ(RunLength(row.data(), 1, 0), 1);
+	EXPECT_EQ(RunLength(nullptr, 1, -1), 1); // past the border, nothing is read
+}
+
+TEST(BitMatrixCursorTest, StepToEdgeMatchesPixelByPixel)
+{
+	PseudoRandom rnd(42);
+	for (auto [w, h] : {std::pair{1, 1}, {5, 3}, {17, 40}, {200, 150}}) {
+		auto image = RandomRuns(w, h, rnd);
+		CheckStepToEdge<PointI>(image, rnd);
+		CheckStepToEdge<PointF>(image, rnd);
+	}
+}
+
+TEST(BitMatrixCursorTest, FastEdgeToEdgeCounter)
+{
+	PseudoRandom rnd(7);
+	auto image = RandomRuns(200, 150, rnd);
+	const PointI dirs[] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, 1}};
+	for (int i = 0; i < 2000; ++i) {
+		BitMatrixCursorI cur(image, {rnd.next(0, 199), rnd.next(0, 149)}, dirs[i % 6]);
+		FastEdgeToEdgeCounter fast(cur);
+
+		// the pixel by pixel implementation of FastEdgeToEdgeCounter::stepToNextEdge
+		int stride = cur.d.y * image.rowPitch() + cur.d.x;
+		const uint8_t* p = image.row(cur.p.y).begin() + cur.p.x;
+		int maxStepsX = cur.d.x ? (cur.d.x > 0 ? image.width() - 1 - cur.p.x : cur.p.x) : INT_MAX;
+		int maxStepsY = cur.d.y ? (cur.d.y > 0 ? image.height() - 1 - cur.p.y : cur.p.y) : INT_MAX;
+		int stepsToBorder = std::min(maxStepsX, maxStepsY);
+		auto stepToNextEdge = [&](int range) {
+			int maxSteps = std::min(stepsToBorder, range);
+			int steps = 0;
+			do {
+				if (++steps > maxSteps) {
+					if (maxSteps == stepsToBorder)
+						break;
+					else
+						return 0;
+				}
+			} while (p[steps * stride] == p[0]);
+			p += steps * stride;
+			stepsToBorder -= steps;
+			return steps;
+		};
+
+		for (int range : {rnd.next(1, 60), rnd.next(1, 60), 300}) {
+			int steps = fast.stepToNextEdge(range);
+			EXPECT_EQ(steps, stepToNextEdge(range));
+			if (!steps || stepsToBorder < 0)
+				break;
+		}
+	}
+}
@@ -0,0 +1,45 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitMatrixIO.h"
+
+#include "gtest/gtest.h"
+#include <sstream>
+
+using namespace ZXing;
+
+TEST(BitMatrixIOTest, SVG)
+{
+	auto m = ParseBitMatrix("XXX.X\n"
+							"..XX.\n",
+							'X', false);
+
+	auto svg = ToSVG(m, 1);
+	EXPECT_NE(svg.find("viewBox=\"0 0 7 4\""), std::string::npos);
+	auto path = svg.substr(svg.find(" d=\"") + 4);
+	path = path.substr(0, path.find('"'));
+	EXPECT_EQ(path, "M1,1h3v1h-3zM5,1h1v1h-1zM3,2h2v1h-2z");
+}
+
+TEST(BitMatrixIOTest, PBM)
+{
+	auto m = ParseBitMatrix("X.X\n"
+							".X.\n",
+							'X', false);
+
+	std::ostringstream out;
+	WritePBM(out, m, 1, 2);
+	auto pbm = out.str();
+
+	const std::string header = "P4\n10 8\n";
+	ASSERT_EQ(pbm.substr(0, header.size()), header);
+	auto data = pbm.substr(header.size());
+	ASSERT_EQ(data.size(), 8u * 2);
+
+	// quiet zone rows, 2 rows "..XX..XX..", 2 rows "....XX....", quiet zone rows
+	const uint8_t expected[] = {0, 0, 0, 0, 0x33, 0, 0x33, 0, 0x0c, 0, 0x0c, 0, 0, 0, 0, 0};
+	for (int i = 0; i < 16; ++i)
+		EXPECT_EQ(static_cast<uint8_t>(data[i]), expected[i]) << i;
+}
@@ -0,0 +1,146 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitMatrix.h"
+
+#include "Pattern.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace ZXing;
+
+TEST(BitMatrixTest, FindBoundingBoxEmpty)
+{
+	int left, top, width, height;
+	EXPECT_FALSE(BitMatrix(100, 30).findBoundingBox(left, top, width, height));
+	EXPECT_FALSE(BitMatrix(3, 2).findBoundingBox(left, top, width, height));
+}
+
+TEST(BitMatrixTest, FindBoundingBox)
+{
+	// compare with a pixel by pixel search for boxes of all sizes and alignments, the word scans have scalar tails
+	uint32_t seed = 1;
+	auto rand = [&seed](int n) { return int((seed = seed * 1103515245 + 12345) >> 16) % n; };
+
+	for (int i = 0; i < 500; ++i) {
+		const int w = 1 + rand(150), h = 1 + rand(20);
+		BitMatrix bits(w, h);
+		const int n = 1 + rand(5);
+		int minX = w, minY = h, maxX = -1, maxY = -1;
+		for (int j = 0; j < n; ++j) {
+			int x = rand(w), y = rand(h);
+			bits.set(x, y);
+			minX = std::min(minX, x), maxX = std::max(maxX, x);
+			minY = std::min(minY, y), maxY = std::max(maxY, y);
+		}
+
+		int left, top, width, height;
+		ASSERT_TRUE(bits.findBoundingBox(left, top, width, height));
+		EXPECT_EQ(left, minX) << w << "x" << h;
+		EXPECT_EQ(top, minY) << w << "x" << h;
+		EXPECT_EQ(width, maxX - minX + 1) << w << "x" << h;
+		EXPECT_EQ(height, maxY - minY + 1) << w << "x" << h;
+
+		EXPECT_FALSE(bits.findBoundingBox(left, top, width, height, maxX - minX + 2)); // minSize > width
+	}
+}
+
+static BitMatrix RandomMatrix(int width, int height, uint32_t seed, int rowAlignment = 1)
+{
+	BitMatrix res(width, height, rowAlignment);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			res.set(x, y, ((seed = seed * 1103515245 + 12345) >> 16) & 1);
+	return res;
+}
+
+TEST(BitMatrixTest, Rotate)
+{
+	// sizes that are not a multiple of the tile size
+	for (auto [w, h] : {std::pair{1, 1}, {3, 40}, {37, 21}, {64, 64}}) {
+		const auto orig = RandomMatrix(w, h, w * h);
+
+		auto bits = orig.copy();
+		bits.rotate90();
+		ASSERT_EQ(bits.width(), h);
+		ASSERT_EQ(bits.height(), w);
+		for (int y = 0; y < h; ++y)
+			for (int x = 0; x < w; ++x)
+				ASSERT_EQ(bits.get(y, w - 1 - x), orig.get(x, y)) << x << "," << y;
+
+		bits = orig.copy();
+		bits.rotate180();
+		for (int y = 0; y < h; ++y)
+			for (int x = 0; x < w; ++x)
+				ASSERT_EQ(bits.get(w - 1 - x, h - 1 - y), orig.get(x, y)) << x << "," << y;
+
+		for (int i = 0; i < 4; ++i)
+			bits.rotate90();
+		bits.rotate180();
+		EXPECT_TRUE(bits == orig);
+	}
+}
+
+TEST(BitMatrixTest, Mirror)
+{
+	for (int n : {1, 15, 16, 17, 50}) {
+		const auto orig = RandomMatrix(n, n, n);
+		auto bits = orig.copy();
+		bits.mirror();
+		for (int y = 0; y < n; ++y)
+			for (int x = 0; x < n; ++x)
+				ASSERT_EQ(bits.get(x, y), orig.get(y, x)) << x << "," << y;
+	}
+}
+
+TEST(BitMatrixTest, PaddedRows)
+{
+	// a matrix with padded rows behaves like the unpadded one with the same pixels
+	for (int w : {1, 15, 16, 31, 32, 33, 50}) {
+		const int h = w == 50 ? 50 : 7;
+		const auto plain = RandomMatrix(w, h, w);
+		const auto padded = RandomMatrix(w, h, w, BitMatrix::ROW_ALIGNMENT);
+		EXPECT_EQ(plain.rowPitch(), w);
+		EXPECT_EQ(padded.rowPitch() % BitMatrix::ROW_ALIGNMENT, 0);
+		EXPECT_GE(padded.rowPitch(), w);
+		for (int y = 0; y < h; ++y)
+			EXPECT_EQ(reinterpret_cast<uintptr_t>(padded.row(y).begin()) % BitMatrix::ROW_ALIGNMENT, 0u);
+		EXPECT_TRUE(plain == padded);
+
+		auto check = [&](auto op) {
+			auto a = plain.copy(), b = padded.copy();
+			op(a), op(b);
+			EXPECT_TRUE(a == b) << w;
+			// the padding stays unset
+			for (int y = 0; y < b.height(); ++y)
+				for (const auto* p = b.row(y).end(); p < b.row(y).begin() + b.rowPitch(); ++p)
+					ASSERT_EQ(*p, BitMatrix::UNSET_V) << w << " " << y;
+		};
+		check([](BitMatrix& m) { m.flipAll(); });
+		check([](BitMatrix& m) { m.rotate180(); });
+		check([](BitMatrix& m) { m.rotate90(); });
+		if (w == h)
+			check([](BitMatrix& m) { m.mirror(); });
+
+		int l0 = 0, t0 = 0, w0 = 0, h0 = 0, l1 = 0, t1 = 0, w1 = 0, h1 = 0;
+		EXPECT_EQ(plain.findBoundingBox(l0, t0, w0, h0), padded.findBoundingBox(l1, t1, w1, h1));
+		EXPECT_EQ(l0, l1);
+		EXPECT_EQ(t0, t1);
+		EXPECT_EQ(w0, w1);
+		EXPECT_EQ(h0, h1);
+
+		for (bool transpose : {false, true}) {
+			PatternRow r0, r1;
+			for (int i = 0; i < (transpose ? w : h); ++i) {
+				GetPatternRow(plain, i, r0, transpose);
+				GetPatternRow(padded, i, r1, transpose);
+				EXPECT_EQ(r0, r1) << w << " " << i << " " << transpose;
+			}
+		}
+	}
+}
@@ -0,0 +1,61 @@
+/*
+* Copyright 2017 Axel Waggershauser
+* Copyright 2007 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitSource.h"
+#include "ByteArray.h"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+using namespace ZXing;
+
+TEST(BitSourceTest, Source)
+{
+	ByteArray bytes{1, 2, 3, 4, 5};
+	BitSource source(bytes);
+	EXPECT_EQ(40, source.available());
+	EXPECT_EQ(0, source.readBits(1));
+	EXPECT_EQ(39, source.available());
+	EXPECT_EQ(0, source.readBits(6));
+	EXPECT_EQ(33, source.available());
+	EXPECT_EQ(1, source.readBits(1));
+	EXPECT_EQ(32, source.available());
+	EXPECT_EQ(2, source.readBits(8));
+	EXPECT_EQ(24, source.available());
+	EXPECT_EQ(12, source.readBits(10));
+	EXPECT_EQ(14, source.available());
+	EXPECT_EQ(16, source.readBits(8));
+	EXPECT_EQ(6, source.available());
+	EXPECT_EQ(5, source.readBits(6));
+	EXPECT_EQ(0, source.available());
+	EXPECT_THROW(source.readBits(1), std::out_of_range);
+}
+
+TEST(BitSourceTest, WideReads)
+{
+	ByteArray bytes{0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x0f};
+	BitSource source(bytes);
+	EXPECT_EQ(0x1, source.readBits(4));
+	EXPECT_EQ(0x23456789, source.readBits(32));
+	EXPECT_EQ(0xabcdef00, static_cast<unsigned>(source.readBits(32)));
+	EXPECT_EQ(8, source.byteOffset());
+	EXPECT_EQ(4, source.bitOffset());
+	EXPECT_EQ(0xf, source.peakBits(4));
+	EXPECT_EQ(0xf, source.readBits(4));
+}
+
+TEST(BitSourceTest, PartialLastByte)
+{
+	ByteArray bytes{0xff, 0xe0};
+	BitSource source(bytes, 11);
+	EXPECT_EQ(11, source.available());
+	EXPECT_EQ(0x7ff, source.peakBits(11));
+	EXPECT_THROW(source.peakBits(12), std::out_of_range);
+	source.skipBits(10);
+	EXPECT_EQ(1, source.readBits(1));
+	EXPECT_EQ(0, source.available());
+}
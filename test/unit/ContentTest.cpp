@@ -70,6 +70,31 @@ TEST(ContentTest, GuessEncoding)
 		EXPECT_EQ(c.guessEncoding(), CharacterSet::Shift_JIS);
 		EXPECT_EQ(c.utf8(), u8"A\u30C6Z");
 	}
+
+	{ // long ASCII runs around the multi-byte chars, the guess follows appended bytes
+		Content c;
+		c.append(std::string(40, 'a') + "\r\n" + std::string(40, '~'));
+		EXPECT_EQ(c.guessEncoding(), CharacterSet::ISO8859_1);
+		c.append(ByteArray{0xC3, 0xA9});
+		c.append(std::string(40, ' '));
+		EXPECT_EQ(c.guessEncoding(), CharacterSet::UTF8);
+		c.append(ByteArray{0x81, 0x40});
+		EXPECT_EQ(c.guessEncoding(), CharacterSet::Shift_JIS);
+	}
+
+	{ // all blocks with unknown encoding count, the guess follows appended contents
+		Content c;
+		c.append(ByteArray{'A', 0x83});
+		c.switchEncoding(CharacterSet::ISO8859_5);
+		c.append(ByteArray{'A', 0xE9, 'Z'});
+		EXPECT_EQ(c.guessEncoding(), CharacterSet::ISO8859_1);
+
+		Content other;
+		other.switchEncoding(CharacterSet::Unknown);
+		other.append(ByteArray{0x65, 'Z'});
+		c.append(other);
+		EXPECT_EQ(c.guessEncoding(), CharacterSet::Shift_JIS);
+	}
 }
 
 TEST(ContentTest, ECI)
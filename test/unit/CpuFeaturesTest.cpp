@@ -0,0 +1,67 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "CpuFeatures.h"
+#include "GenericGF.h"
+#include "PseudoRandom.h"
+#include "ReedSolomonDecoder.h"
+#include "ReedSolomonEncoder.h"
+#include "Scope.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace ZXing;
+
+namespace {
+
+int Baseline() { return 0; }
+int WithSSSE3() { return 1; }
+int WithAVX2() { return 2; }
+
+} // namespace
+
+TEST(CpuFeaturesTest, SelectKernel)
+{
+	SCOPE_EXIT([] { SetCpuFeatureMask(~0u); });
+	const Kernel<int (*)()> kernels[] = {{AVX2 | SSSE3, WithAVX2}, {SSSE3, WithSSSE3}, {0, Baseline}};
+
+	SetCpuFeatureMask(0);
+	EXPECT_EQ(CpuFeatures(), 0u);
+	EXPECT_EQ(SelectKernel(kernels)(), 0);
+
+	SetCpuFeatureMask(SSSE3);
+	EXPECT_EQ(SelectKernel(kernels)(), CpuFeatures() & SSSE3 ? 1 : 0);
+
+	SetCpuFeatureMask(~0u);
+	const uint32_t features = CpuFeatures();
+	EXPECT_EQ(SelectKernel(kernels)(), (features & (AVX2 | SSSE3)) == (AVX2 | SSSE3) ? 2 : (features & SSSE3 ? 1 : 0));
+}
+
+// all variants of a kernel have to compute the same, here the syndromes of the Reed-Solomon decoder
+TEST(CpuFeaturesTest, ReedSolomonVariants)
+{
+	SCOPE_EXIT([] { SetCpuFeatureMask(~0u); });
+	const auto& field = GenericGF::QRCodeField256();
+	PseudoRandom random(0x2026);
+	for (int n = 0; n < 50; ++n) {
+		const int numData = random.next(1, 200), numEC = random.next(2, 50);
+		std::vector<int> message(numData + numEC);
+		for (int i = 0; i < numData; ++i)
+			message[i] = random.next(0, 255);
+		ReedSolomonEncode(field, message, numEC);
+		auto expected = message;
+		for (int e = random.next(0, numEC / 2); e > 0; --e)
+			message[random.next(0, numData + numEC - 1)] = random.next(0, 255);
+
+		for (uint32_t mask : {0u, ~0u}) {
+			SetCpuFeatureMask(mask);
+			auto received = message;
+			ASSERT_TRUE(ReedSolomonDecode(field, received, numEC)) << n << " " << mask;
+			EXPECT_EQ(received, expected) << n << " " << mask;
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FrameQuality.h"
+
+#include "BitMatrix.h"
+#include "DecodeStats.h"
+#include "MultiFormatWriter.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+using namespace ZXing;
+
+namespace {
+
+// an EAN-13 label with a module size of 5 on a gray 800 x 300 frame, motion blurred horizontally over blur pixels
+Matrix<uint8_t> MakeFrame(int blur)
+{
+	auto label = MultiFormatWriter(BarcodeFormat::EAN13).setMargin(10).encode("4006381333931", 600, 150);
+	Matrix<uint8_t> frame(800, 300, 200);
+	for (int y = 0; y < label.height(); ++y)
+		for (int x = 0; x < label.width(); ++x)
+			frame.set(100 + x, 75 + y, label.get(x, y) ? 30 : 220);
+
+	Matrix<uint8_t> res(frame.width(), frame.height());
+	for (int y = 0; y < frame.height(); ++y)
+		for (int x = 0; x < frame.width(); ++x) {
+			int sum = 0;
+			for (int i = 0; i < blur; ++i)
+				sum += frame.get(std::min(x + i, frame.width() - 1), y);
+			res.set(x, y, sum / blur);
+		}
+	return res;
+}
+
+ImageView ToImageView(const Matrix<uint8_t>& img)
+{
+	return {img.data(), img.width(), img.height(), ImageFormat::Lum};
+}
+
+} // namespace
+
+TEST(FrameQualityTest, Flat)
+{
+	Matrix<uint8_t> flat(320, 240, 128);
+	auto q = EstimateFrameQuality(ToImageView(flat));
+	EXPECT_EQ(q.contrast, 0);
+	EXPECT_EQ(q.sharpness, 0);
+}
+
+TEST(FrameQualityTest, Blur)
+{
+	auto sharp = EstimateFrameQuality(ToImageView(MakeFrame(1)));
+	EXPECT_NEAR(sharp.contrast, 190, 16); // the histogram has a resolution of 8
+	EXPECT_EQ(sharp.sharpness, 100);
+
+	// an edge blurred over n pixels has a sharpness of about 100 / n
+	int last = sharp.sharpness;
+	for (int blur : {2, 3, 5}) {
+		auto q = EstimateFrameQuality(ToImageView(MakeFrame(blur)));
+		EXPECT_NEAR(q.sharpness, 100 / blur, 10) << blur;
+		EXPECT_LT(q.sharpness, last);
+		last = q.sharpness;
+	}
+}
+
+TEST(FrameQualityTest, Gate)
+{
+	DecodeStats stats;
+	const auto hints = DecodeHints().setFormats(BarcodeFormat::EAN13).setTryDownscale(false).setMinFrameSharpness(30).setStats(&stats);
+
+	auto sharp = MakeFrame(1);
+	EXPECT_EQ(ReadBarcodes(ToImageView(sharp), hints).size(), 1);
+	EXPECT_EQ(stats.count(DecodeStats::Counter::SkippedFrames), 0);
+
+	// still readable without the gate
+	auto blurred = MakeFrame(5);
+	EXPECT_EQ(ReadBarcodes(ToImageView(blurred), DecodeHints(hints).setMinFrameSharpness(0)).size(), 1);
+	EXPECT_EQ(ReadBarcodes(ToImageView(blurred), hints).size(), 0);
+	EXPECT_EQ(stats.count(DecodeStats::Counter::SkippedFrames), 1);
+}
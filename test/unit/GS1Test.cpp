@@ -344,3 +344,23 @@ TEST(HRIFromGS1, MultiVariable)
 {
 	EXPECT_EQ(HRIFromGS1("70041234\x1d""81111234"), "(7004)1234(8111)1234");
 }
+
+TEST(ParseGS1, Elements)
+{
+	std::string_view gs1 = "0100614141999996\x1d""10ABC123\x1d""3103000123";
+	auto elements = ParseGS1(gs1);
+	ASSERT_EQ(elements.size(), 3u);
+	EXPECT_EQ(elements[0].ai, "01");
+	EXPECT_EQ(elements[0].value, "00614141999996");
+	EXPECT_EQ(elements[1].ai, "10");
+	EXPECT_EQ(elements[1].value, "ABC123");
+	EXPECT_EQ(elements[2].ai, "3103");
+	EXPECT_EQ(elements[2].value, "000123");
+
+	// the views point into the input
+	EXPECT_EQ(elements[1].value.data(), gs1.data() + 19);
+
+	EXPECT_TRUE(ParseGS1("").empty());
+	EXPECT_TRUE(ParseGS1("01006141419999").empty()); // too short
+	EXPECT_TRUE(ParseGS1("0100614141999996\x1d""2A").empty()); // unknown AI
+}
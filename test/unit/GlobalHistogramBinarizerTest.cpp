@@ -0,0 +1,118 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "GlobalHistogramBinarizer.h"
+
+#include "BitMatrix.h"
+#include "Pattern.h"
+#include "ZXAlgorithms.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace ZXing;
+
+TEST(GlobalHistogramBinarizerTest, RotatedPatternRows)
+{
+	// an image with 2 bytes per pixel (the second one being garbage) that is not a multiple of the tile size
+	const int width = 77, height = 45;
+	std::vector<uint8_t> buf(width * height * 2);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x) {
+			buf[(y * width + x) * 2] = ((x / 3 + y / 5) % 3) ? 30 + x : 220 - y;
+			buf[(y * width + x) * 2 + 1] = 0x55;
+		}
+	ImageView iv(buf.data(), width, height, ImageFormat::Lum, width * 2, 2);
+	GlobalHistogramBinarizer bitmap(iv);
+
+	for (int rotation : {90, 180, 270, -90}) {
+		// reference: a contiguous copy of the rotated image, read without rotation
+		auto rotated = iv.rotated(rotation);
+		std::vector<uint8_t> copy(rotated.width() * rotated.height());
+		for (int y = 0; y < rotated.height(); ++y)
+			for (int x = 0; x < rotated.width(); ++x)
+				copy[y * rotated.width() + x] = *rotated.data(x, y);
+		GlobalHistogramBinarizer reference({copy.data(), rotated.width(), rotated.height(), ImageFormat::Lum});
+
+		for (int row = 0; row < rotated.height(); ++row) {
+			PatternRow expected, actual;
+			bool ok = reference.getPatternRow(row, 0, expected);
+			EXPECT_EQ(bitmap.getPatternRow(row, rotation, actual), ok) << rotation << " " << row;
+			if (ok)
+				EXPECT_EQ(actual, expected) << rotation << " " << row;
+		}
+	}
+}
+
+TEST(GlobalHistogramBinarizerTest, DenseAndStridedRowsMatch)
+{
+	// densely packed rows take the SIMD code paths, strided ones the scalar ones. Noisy content with steep edges makes
+	// for sharpened values far outside [0, 255] and many pixels close to the threshold.
+	const int width = 203, height = 40;
+	std::vector<uint8_t> dense(width * height), strided(width * height * 3);
+	uint32_t seed = 42;
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x) {
+			seed = seed * 1664525 + 1013904223;
+			int noise = int(seed >> 24) % (8 + y);
+			uint8_t v = narrow_cast<uint8_t>(std::clamp(((x / (1 + y % 4)) % 2 ? 40 : 210) + noise - (8 + y) / 2, 0, 255));
+			dense[y * width + x] = v;
+			strided[(y * width + x) * 3] = v;
+		}
+	GlobalHistogramBinarizer a({dense.data(), width, height, ImageFormat::Lum});
+	GlobalHistogramBinarizer b({strided.data(), width, height, ImageFormat::Lum, width * 3, 3});
+
+	for (int row = 0; row < height; ++row) {
+		PatternRow expected, actual;
+		bool ok = b.getPatternRow(row, 0, expected);
+		EXPECT_EQ(a.getPatternRow(row, 0, actual), ok) << row;
+		if (ok)
+			EXPECT_EQ(actual, expected) << row;
+	}
+
+	auto ma = a.getBitMatrix(), mb = b.getBitMatrix();
+	ASSERT_EQ(ma == nullptr, mb == nullptr);
+	if (ma)
+		EXPECT_TRUE(*ma == *mb);
+}
+
+TEST(GlobalHistogramBinarizerTest, SubPixelPatternRow)
+{
+	// a row of bars with a module size of 1.5 pixels, starting at a fractional pixel offset, each pixel being the
+	// area average of the bars and spaces it covers
+	const std::vector<int> modules = {1, 2, 1, 1, 3, 2, 1, 1, 2};
+	const float moduleSize = 1.5f, start = 10.25f;
+	std::vector<float> edges = {start};
+	for (int m : modules)
+		edges.push_back(edges.back() + m * moduleSize);
+
+	const int width = 40, height = 3;
+	std::vector<uint8_t> buf(width * height);
+	for (int x = 0; x < width; ++x) {
+		float black = 0;
+		for (int i = 0; i < Size(modules); i += 2)
+			black += std::max(0.f, std::min(x + 1.f, edges[i + 1]) - std::max(float(x), edges[i]));
+		for (int y = 0; y < height; ++y)
+			buf[y * width + x] = narrow_cast<uint8_t>(std::lround(220 - 190 * black));
+	}
+
+	GlobalHistogramBinarizer bitmap({buf.data(), width, height, ImageFormat::Lum}, true);
+	const int scale = bitmap.patternRowScale();
+	EXPECT_EQ(scale, 4);
+
+	PatternRow row;
+	ASSERT_TRUE(bitmap.getPatternRow(1, 0, row));
+	ASSERT_EQ(Size(row), Size(modules) + 2);
+	EXPECT_EQ(Reduce(row), width * scale);
+	EXPECT_NEAR(row.front(), start * scale, scale / 2);
+	for (int i = 0; i < Size(modules); ++i)
+		EXPECT_NEAR(row[i + 1], modules[i] * moduleSize * scale, scale / 2) << i;
+
+	GlobalHistogramBinarizer integer({buf.data(), width, height, ImageFormat::Lum});
+	EXPECT_EQ(integer.patternRowScale(), 1);
+}
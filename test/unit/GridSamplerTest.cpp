@@ -0,0 +1,72 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "GridSampler.h"
+
+#include "BitMatrix.h"
+#include "BitMatrixIO.h"
+#include "MultiFormatWriter.h"
+
+#include "gtest/gtest.h"
+
+using namespace ZXing;
+
+TEST(GridSamplerTest, SampleLuminance)
+{
+	const auto modules = MultiFormatWriter(BarcodeFormat::QRCode).setMargin(0).encodeModules("GridSampler").modules;
+	const int dim = modules.width(), ms = 4, border = 8;
+
+	// strong illumination gradient: black on the right is brighter than white on the left
+	Matrix<uint8_t> img(dim * ms + 2 * border, dim * ms + 2 * border, 0);
+	for (int y = 0; y < img.height(); ++y)
+		for (int x = 0; x < img.width(); ++x) {
+			int mx = (x - border) / ms, my = (y - border) / ms;
+			bool black = x >= border && y >= border && mx < dim && my < dim && modules.get(mx, my);
+			int light = 180 * x / img.width();
+			img.set(x, y, (black ? 10 : 70) + light);
+		}
+	ImageView iv(img.data(), img.width(), img.height(), ImageFormat::Lum);
+
+	auto mod2Pix = PerspectiveTransform(Rectangle(0, dim, 0, dim, 0), Rectangle(border, border + dim * ms, border, border + dim * ms, 0));
+	ROIs rois = {{0, dim, 0, dim, mod2Pix}};
+
+	auto res = SampleGrid(LumSource{iv, false}, dim, dim, rois);
+	ASSERT_TRUE(res.isValid());
+	EXPECT_EQ(ToString(res.bits()), ToString(modules));
+	EXPECT_EQ(res.position().topLeft(), PointI(border, border));
+
+	auto inv = SampleGrid(LumSource{iv, true}, dim, dim, rois);
+	ASSERT_TRUE(inv.isValid());
+	auto inverted = modules.copy();
+	inverted.flipAll();
+	EXPECT_EQ(ToString(inv.bits()), ToString(inverted));
+
+	// the same geometry checks as for the BitMatrix version
+	ROIs outside = {{0, dim, 0, dim, PerspectiveTransform(Rectangle(0, dim, 0, dim, 0), Rectangle(-4, dim * ms, 0, dim * ms, 0))}};
+	EXPECT_FALSE(SampleGrid(LumSource{iv, false}, dim, dim, outside).isValid());
+	EXPECT_FALSE(SampleGrid(LumSource{ImageView(img.data(), img.width(), img.height(), ImageFormat::RGB), false}, dim, dim, rois).isValid());
+}
+
+TEST(GridSamplerTest, ProjectRowSinglePrecision)
+{
+	// strong perspective onto a large image, the float projection has to stay well within a pixel of the double one
+	PerspectiveTransform mod2Pix({PointF{0, 0}, {177, 0}, {177, 177}, {0, 177}}, {PointF{100, 120}, {3950, 90}, {3600, 3080}, {80, 3900}});
+	ASSERT_TRUE(mod2Pix.isValid());
+
+	constexpr int N = 64;
+	double xd[N], yd[N];
+	float xf[N], yf[N];
+	for (int y = 0; y < 177; ++y)
+		for (int x = 0; x < 177; x += N) {
+			int n = std::min(N, 177 - x);
+			PointF p(x + 0.5, y + 0.5);
+			mod2Pix.projectRow(p, n, xd, yd);
+			mod2Pix.projectRow(p, n, xf, yf);
+			for (int i = 0; i < n; ++i) {
+				EXPECT_NEAR(xf[i], xd[i], 1e-2);
+				EXPECT_NEAR(yf[i], yd[i], 1e-2);
+			}
+		}
+}
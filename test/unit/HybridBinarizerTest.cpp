@@ -0,0 +1,113 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "HybridBinarizer.h"
+
+#include "BitMatrix.h"
+#include "Executor.h"
+#include "Matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace ZXing;
+
+TEST(HybridBinarizerTest, ParallelBandsMatchSerial)
+{
+	// smooth gradients plus some texture and flat (low contrast) areas to exercise the neighbor correction
+	const int width = 301, height = 1003;
+	std::vector<uint8_t> buf(width * height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			buf[y * width + x] = (y / 100) % 2 ? 200 : static_cast<uint8_t>(127 + 120 * std::sin(x * 0.2) * std::cos(y * 0.05));
+	ImageView iv(buf.data(), width, height, ImageFormat::Lum);
+
+	// getBitMatrix() returns a pointer into the cache of the binarizer, so it needs to stay alive
+	HybridBinarizer serialBinarizer(iv);
+	auto serial = serialBinarizer.getBitMatrix();
+	ASSERT_NE(serial, nullptr);
+
+	for (int threads : {2, 3, 8}) {
+		ThreadExecutor executor(threads);
+		HybridBinarizer parallelBinarizer(iv, &executor);
+		auto parallel = parallelBinarizer.getBitMatrix();
+		ASSERT_NE(parallel, nullptr);
+		EXPECT_TRUE(*parallel == *serial);
+	}
+}
+
+TEST(HybridBinarizerTest, PrecomputedBlackPoints)
+{
+	const int width = 203, height = 157; // neither a multiple of the block size
+	std::vector<uint8_t> buf(width * height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			buf[y * width + x] = (x / 50) % 2 ? 60 : static_cast<uint8_t>(127 + 120 * std::sin(x * 0.3) * std::cos(y * 0.1));
+	ImageView iv(buf.data(), width, height, ImageFormat::Lum);
+
+	HybridBinarizer reference(iv);
+	auto expected = reference.getBitMatrix();
+	ASSERT_NE(expected, nullptr);
+
+	// one block row at a time, like LumImagePyramid does while downscaling
+	constexpr int BS = HybridBinarizer::BlockSize;
+	Matrix<HybridBinarizer::BlockStatistics> stats((width + BS - 1) / BS, (height + BS - 1) / BS);
+	for (int y = 0; y < stats.height(); ++y)
+		HybridBinarizer::CalculateBlockStatistics(iv, y, y + 1, stats);
+	auto blackPoints = HybridBinarizer::BlackPoints(stats);
+
+	HybridBinarizer binarizer(iv, nullptr, false, &blackPoints);
+	auto bits = binarizer.getBitMatrix();
+	ASSERT_NE(bits, nullptr);
+	EXPECT_TRUE(*bits == *expected);
+}
+
+TEST(HybridBinarizerTest, DerivedBlockStatistics)
+{
+	const int width = 406, height = 314, factor = 2;
+	std::vector<uint8_t> buf(width * height);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			buf[y * width + x] = (x / 100) % 2 ? 60 + (x + y) % 3 : static_cast<uint8_t>(127 + 120 * std::sin(x * 0.15) * std::cos(y * 0.05));
+	ImageView iv(buf.data(), width, height, ImageFormat::Lum);
+
+	const int dw = width / factor, dh = height / factor; // 203 x 157, neither a multiple of the block size
+	std::vector<uint8_t> down(dw * dh);
+	for (int y = 0; y < dh; ++y)
+		for (int x = 0; x < dw; ++x)
+			down[y * dw + x] = (buf[2 * y * width + 2 * x] + buf[2 * y * width + 2 * x + 1] + buf[(2 * y + 1) * width + 2 * x]
+								+ buf[(2 * y + 1) * width + 2 * x + 1] + 2) / 4;
+	ImageView div(down.data(), dw, dh, ImageFormat::Lum);
+
+	constexpr int BS = HybridBinarizer::BlockSize;
+	Matrix<HybridBinarizer::BlockStatistics> parent((width + BS - 1) / BS, (height + BS - 1) / BS);
+	HybridBinarizer::CalculateBlockStatistics(iv, 0, parent.height(), parent);
+	Matrix<HybridBinarizer::BlockStatistics> exact((dw + BS - 1) / BS, (dh + BS - 1) / BS), derived(exact.width(), exact.height());
+	HybridBinarizer::CalculateBlockStatistics(div, 0, exact.height(), exact);
+	HybridBinarizer::DeriveBlockStatistics(div, parent, width, height, factor, derived);
+
+	for (int y = 0; y < exact.height(); ++y) {
+		for (int x = 0; x < exact.width(); ++x) {
+			const auto &e = exact(x, y), &d = derived(x, y);
+			if (x == exact.width() - 1 || y == exact.height() - 1) {
+				// not aligned with the parent blocks -> computed from the pixels
+				EXPECT_EQ(d.sum, e.sum);
+				EXPECT_EQ(d.min, e.min);
+				EXPECT_EQ(d.max, e.max);
+			} else {
+				EXPECT_NEAR(d.sum / (BS * BS), e.sum / (BS * BS), 1);
+				if (e.max - e.min > 24)
+					EXPECT_GT(d.max - d.min, 24);
+				else
+					EXPECT_LE(d.min, e.min);
+			}
+		}
+	}
+
+	EXPECT_THROW(HybridBinarizer::DeriveBlockStatistics(iv, parent, width, height, factor, derived), std::invalid_argument);
+}
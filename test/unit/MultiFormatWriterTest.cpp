@@ -0,0 +1,116 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MultiFormatWriter.h"
+
+#include "BitMatrix.h"
+#include "Executor.h"
+#include "ZXAlgorithms.h"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ZXing;
+
+TEST(MultiFormatWriterTest, BatchMatchesSingle)
+{
+	std::vector<std::string> contents;
+	for (int i = 0; i < 50; ++i)
+		contents.push_back("LABEL-" + std::to_string(i * 7919));
+
+	ThreadExecutor executor(4);
+	for (auto format : {BarcodeFormat::QRCode, BarcodeFormat::DataMatrix, BarcodeFormat::Aztec, BarcodeFormat::PDF417,
+						BarcodeFormat::Code128}) {
+		auto writer = MultiFormatWriter(format).setMargin(2);
+		std::vector<BitMatrix> serial, parallel;
+		writer.encodeBatch(contents, 100, 100, serial);
+		writer.encodeBatch(contents, 100, 100, parallel, &executor);
+		ASSERT_EQ(serial.size(), contents.size());
+		ASSERT_EQ(parallel.size(), contents.size());
+		for (size_t i = 0; i < contents.size(); ++i) {
+			auto single = writer.encode(contents[i], 100, 100);
+			EXPECT_TRUE(serial[i] == single) << ToString(format) << " " << i;
+			EXPECT_TRUE(parallel[i] == single) << ToString(format) << " " << i;
+		}
+	}
+}
+
+TEST(MultiFormatWriterTest, BatchRethrows)
+{
+	ThreadExecutor executor(4);
+	std::vector<std::string> contents = {"123456789012", "not a number", "123456789012"};
+	std::vector<BitMatrix> res;
+	EXPECT_THROW(MultiFormatWriter(BarcodeFormat::EAN13).encodeBatch(contents, 100, 100, res, &executor),
+				 std::invalid_argument);
+}
+
+TEST(MultiFormatWriterTest, ModulesAndRasterizer)
+{
+	for (auto format : {BarcodeFormat::QRCode, BarcodeFormat::DataMatrix, BarcodeFormat::Aztec}) {
+		auto symbol = MultiFormatWriter(format).encodeModules("ZXing module matrix");
+		EXPECT_EQ(symbol.quietZone, format == BarcodeFormat::QRCode ? 4 : format == BarcodeFormat::DataMatrix ? 1 : 0);
+
+		// the rasterizer produces the same pixels as the writer, one scanline at a time
+		auto inflated = MultiFormatWriter(format).setMargin(symbol.quietZone).encode("ZXing module matrix", 211, 187);
+		ScanlineRasterizer rasterizer(symbol.modules, 211, 187, symbol.quietZone);
+		ASSERT_EQ(rasterizer.width(), inflated.width());
+		ASSERT_EQ(rasterizer.height(), inflated.height());
+		std::vector<uint8_t> line(rasterizer.width());
+		for (int y = 0; y < rasterizer.height(); ++y) {
+			rasterizer.render(y, line.data(), 1, 0);
+			for (int x = 0; x < rasterizer.width(); ++x)
+				ASSERT_EQ(bool(line[x]), inflated.get(x, y)) << ToString(format) << " " << x << "," << y;
+		}
+	}
+
+	auto pdf417 = MultiFormatWriter(BarcodeFormat::PDF417).encodeModules("1234");
+	EXPECT_EQ(pdf417.modules.height() % 4, 0); // the rows are 4 modules high
+	EXPECT_EQ(pdf417.quietZone, 2);
+
+	auto symbol = MultiFormatWriter(BarcodeFormat::Code128).encodeModules("1234");
+	EXPECT_EQ(symbol.modules.height(), 1);
+	EXPECT_EQ(symbol.quietZone, 10);
+
+	// linear symbols are stretched to the full height
+	ScanlineRasterizer rasterizer(symbol.modules, 300, 50, symbol.quietZone);
+	EXPECT_EQ(rasterizer.scale(), (300 - 20) / symbol.modules.width());
+	std::vector<uint8_t> first(rasterizer.width()), last(rasterizer.width());
+	rasterizer.render(0, first.data());
+	rasterizer.render(49, last.data());
+	EXPECT_EQ(first, last);
+	EXPECT_EQ(first[0], 0xff);
+}
+
+TEST(MultiFormatWriterTest, RowAndBars)
+{
+	std::pair<BarcodeFormat, std::string> samples[] = {
+		{BarcodeFormat::Codabar, "A1234B"}, {BarcodeFormat::Code39, "ZXING-39"}, {BarcodeFormat::Code93, "ZXING-93"},
+		{BarcodeFormat::Code128, "ZXing 128"}, {BarcodeFormat::EAN8, "1234567"}, {BarcodeFormat::EAN13, "123456789012"},
+		{BarcodeFormat::ITF, "1234567890"}, {BarcodeFormat::UPCA, "12345678901"}, {BarcodeFormat::UPCE, "0123456"},
+	};
+	for (auto& [format, contents] : samples) {
+		auto writer = MultiFormatWriter(format);
+		auto modules = writer.encodeModules(contents).modules;
+		auto row = writer.encodeRow(contents);
+		ASSERT_EQ(row.size(), modules.width()) << ToString(format);
+		for (int x = 0; x < row.size(); ++x)
+			EXPECT_EQ(row.get(x), modules.get(x, 0)) << ToString(format) << " " << x;
+
+		auto bars = writer.encodeBars(contents);
+		ASSERT_EQ(bars.size() % 2, 1u) << ToString(format);
+		for (int x = 0, i = 0; i < Size(bars); x += bars[i++]) {
+			EXPECT_GT(bars[i], 0);
+			EXPECT_EQ(row.get(x), i % 2 == 0) << ToString(format) << " " << i;
+		}
+	}
+
+	EXPECT_EQ(MultiFormatWriter(BarcodeFormat::EAN8).encodeBars("1234567").front(), 1); // start guard 101
+	EXPECT_THROW(MultiFormatWriter(BarcodeFormat::QRCode).encodeRow("1234"), std::invalid_argument);
+	EXPECT_THROW(MultiFormatWriter(BarcodeFormat::PDF417).encodeBars("1234"), std::invalid_argument);
+}
@@ -64,3 +64,43 @@ TEST(PatternTest, WhiteBlack)
 		EXPECT_EQ(pr[2], 0);
 	}
 }
+
+TEST(PatternTest, ThresholdPatternRow)
+{
+	// compare with a pixel by pixel reference on random rows with long and short runs, all strides and alignments
+	auto reference = [](const uint8_t* p, int n, int stride, uint8_t threshold, bool invert) {
+		PatternRow res;
+		bool last = false;
+		int runStart = 0;
+		for (int i = 0; i < n; ++i)
+			if (bool v = (p[i * stride] <= threshold) != invert; v != last) {
+				res.push_back(narrow_cast<PatternType>(i - runStart));
+				runStart = i;
+				last = v;
+			}
+		res.push_back(narrow_cast<PatternType>(n - runStart));
+		if (last)
+			res.push_back(0);
+		return res;
+	};
+
+	uint32_t seed = 1;
+	auto rand = [&seed] { return (seed = seed * 1103515245 + 12345) >> 16; };
+
+	for (int n = 1; n < 100; ++n)
+		for (int stride : {1, 3, -1}) {
+			std::vector<uint8_t> buf(n * 3);
+			for (int i = 0; i < Size(buf);) {
+				int len = 1 + rand() % (rand() % 2 ? 3 : 40);
+				uint8_t v = narrow_cast<uint8_t>(rand() % 256);
+				for (; len-- && i < Size(buf); ++i)
+					buf[i] = v;
+			}
+			const uint8_t* p = stride < 0 ? buf.data() + n - 1 : buf.data();
+			for (uint8_t threshold : {0, 127, 255})
+				for (bool invert : {false, true}) {
+					ThresholdPatternRow(p, n, stride, threshold, invert, pr);
+					EXPECT_EQ(pr, reference(p, n, stride, threshold, invert)) << n << " " << stride << " " << int(threshold);
+				}
+		}
+}
@@ -0,0 +1,1167 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ReadBarcode.h"
+
+#include "BinarizerBackend.h"
+#include "BitMatrix.h"
+#include "DecodeStats.h"
+#include "DecoderResult.h"
+#include "Executor.h"
+#include "HybridBinarizer.h"
+#include "MultiFormatReader.h"
+#include "MultiFormatWriter.h"
+#include "Trace.h"
+#include "ZXAlgorithms.h"
+#include "aztec/AZReader.h"
+#include "qrcode/QRReader.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ZXing;
+
+namespace {
+
+// Helper to render a barcode into a black/white luminance buffer
+Matrix<uint8_t> MakeImage(BarcodeFormat format, const std::string& text, int width, int height)
+{
+	return ToMatrix<uint8_t>(MultiFormatWriter(format).setMargin(10).encode(text, width, height));
+}
+
+ImageView ToImageView(const Matrix<uint8_t>& img)
+{
+	return {img.data(), img.width(), img.height(), ImageFormat::Lum};
+}
+
+// A QR Code Result being symbol index of a structured append sequence with the given count and id
+Result MakeSequenceResult(const std::string& text, int index, int count, const std::string& id)
+{
+	Content content;
+	content.symbology = {'Q', '1'};
+	content.append(text);
+	return Result(DecoderResult(std::move(content)).setStructuredAppend({index, count, id}), {}, BarcodeFormat::QRCode);
+}
+
+} // namespace
+
+TEST(ReadBarcodeTest, BarcodeReaderMatchesReadBarcodes)
+{
+	auto img = MakeImage(BarcodeFormat::QRCode, "BarcodeReader", 200, 200);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode);
+
+	auto expected = ReadBarcodes(ToImageView(img), hints);
+	ASSERT_EQ(expected.size(), 1);
+	EXPECT_EQ(expected[0].text(), "BarcodeReader");
+
+	BarcodeReader reader(hints);
+	for (int i = 0; i < 3; ++i) {
+		auto res = reader.read(ToImageView(img));
+		ASSERT_EQ(res.size(), 1);
+		EXPECT_EQ(res[0].text(), expected[0].text());
+		EXPECT_EQ(res[0].position(), expected[0].position());
+	}
+}
+
+TEST(ReadBarcodeTest, BarcodeReaderChangingImageSize)
+{
+	BarcodeReader reader(DecodeHints().setFormats(BarcodeFormat::QRCode | BarcodeFormat::Code128).setDownscaleThreshold(150));
+
+	for (int size : {300, 120, 400}) {
+		auto img = MakeImage(BarcodeFormat::QRCode, std::to_string(size), size, size);
+		auto res = reader.read(ToImageView(img));
+		ASSERT_EQ(res.size(), 1);
+		EXPECT_EQ(res[0].text(), std::to_string(size));
+	}
+
+	auto img = MakeImage(BarcodeFormat::Code128, "Code128", 300, 80);
+	auto res = reader.read(ToImageView(img));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].format(), BarcodeFormat::Code128);
+	EXPECT_EQ(res[0].text(), "Code128");
+}
+
+TEST(ReadBarcodeTest, ParallelMatchesSerial)
+{
+	auto img = MakeImage(BarcodeFormat::QRCode, "Parallel", 800, 800);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode | BarcodeFormat::DataMatrix);
+
+	auto serial = ReadBarcodes(ToImageView(img), hints);
+	auto parallel = ReadBarcodes(ToImageView(img), DecodeHints(hints).setThreads(4));
+	ASSERT_EQ(serial.size(), 1);
+	ASSERT_EQ(parallel.size(), serial.size());
+	EXPECT_EQ(parallel[0].text(), serial[0].text());
+	EXPECT_EQ(parallel[0].position(), serial[0].position());
+	EXPECT_EQ(parallel[0].isInverted(), serial[0].isInverted());
+}
+
+TEST(ReadBarcodeTest, CustomExecutor)
+{
+	// sequential executor running the tasks in reverse order to check the order independent merging
+	struct ReverseExecutor : public Executor
+	{
+		int calls = 0;
+		void parallelFor(int n, const std::function<void(int)>& func) override
+		{
+			++calls;
+			for (int i = n - 1; i >= 0; --i)
+				func(i);
+		}
+		int concurrency() const override { return 2; }
+	};
+
+	auto img = MakeImage(BarcodeFormat::QRCode, "Executor", 800, 800);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode);
+	auto serial = ReadBarcodes(ToImageView(img), hints);
+
+	ReverseExecutor executor;
+	auto res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setExecutor(&executor));
+	EXPECT_EQ(executor.calls, 1);
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), serial[0].text());
+	EXPECT_EQ(res[0].position(), serial[0].position());
+
+	auto global = std::make_shared<ReverseExecutor>();
+	SetDefaultExecutor(global);
+	res = ReadBarcodes(ToImageView(img), hints);
+	SetDefaultExecutor(nullptr);
+	EXPECT_EQ(global->calls, 1);
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), serial[0].text());
+}
+
+TEST(ReadBarcodeTest, Batch)
+{
+	std::vector<Matrix<uint8_t>> imgs;
+	for (int i = 0; i < 8; ++i)
+		imgs.push_back(MakeImage(i % 2 ? BarcodeFormat::QRCode : BarcodeFormat::DataMatrix, std::to_string(i), 120, 120));
+	std::vector<ImageView> ivs;
+	for (auto& img : imgs)
+		ivs.push_back(ToImageView(img));
+
+	for (int threads : {1, 3}) {
+		auto res = ReadBarcodes(ivs, DecodeHints().setThreads(threads));
+		ASSERT_EQ(res.size(), ivs.size());
+		for (int i = 0; i < Size(res); ++i) {
+			ASSERT_EQ(res[i].size(), 1);
+			EXPECT_EQ(res[i][0].text(), std::to_string(i));
+		}
+	}
+}
+
+TEST(ReadBarcodeTest, RegionsOfInterest)
+{
+	auto left = MakeImage(BarcodeFormat::QRCode, "left", 150, 150);
+	auto right = MakeImage(BarcodeFormat::QRCode, "right", 150, 150);
+	Matrix<uint8_t> img(300, 150);
+	for (int y = 0; y < 150; ++y)
+		for (int x = 0; x < 150; ++x) {
+			img.set(x, y, left.get(x, y));
+			img.set(x + 150, y, right.get(x, y));
+		}
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode);
+	EXPECT_EQ(ReadBarcodes(ToImageView(img), hints).size(), 2);
+
+	auto res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setRegionsOfInterest({{160, 0, 140, 150}}));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), "right");
+	EXPECT_GT(res[0].position().topLeft().x, 150);
+
+	// overlapping regions must not report the same symbol twice, out of image regions are ignored
+	res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setRegionsOfInterest({{0, 0, 150, 150}, {-10, -10, 200, 200}, {400, 0, 10, 10}}));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), "left");
+	EXPECT_LT(res[0].position().topRight().x, 150);
+}
+
+TEST(ReadBarcodeTest, Tiles)
+{
+	// three symbols in a 1000 x 400 image, the middle one straddles the border of the first two of the 400 x 400 tiles
+	Matrix<uint8_t> img(1000, 400, 255);
+	const std::vector<std::pair<std::string, PointI>> symbols = {{"first", {20, 20}}, {"second", {270, 200}}, {"third", {820, 100}}};
+	for (const auto& [text, pos] : symbols) {
+		auto qr = MakeImage(BarcodeFormat::QRCode, text, 150, 150);
+		for (int y = 0; y < qr.height(); ++y)
+			for (int x = 0; x < qr.width(); ++x)
+				img.set(pos.x + x, pos.y + y, qr.get(x, y));
+	}
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode).setTileSize(400).setTileOverlap(160);
+	DecodeStats stats;
+	auto res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setStats(&stats));
+	ASSERT_EQ(res.size(), 3);
+	for (int i = 0; i < 3; ++i) {
+		EXPECT_EQ(res[i].text(), symbols[i].first);
+		// positions are in full image coordinates
+		auto pos = res[i].position().topLeft();
+		EXPECT_NEAR(pos.x, symbols[i].second.x + 10, 5) << i;
+		EXPECT_NEAR(pos.y, symbols[i].second.y + 10, 5) << i;
+	}
+	EXPECT_EQ(stats.count(DecodeStats::Counter::Layers), 4); // one per tile (400 is below the downscale threshold)
+
+	// the tiles in parallel give the same results
+	auto parallel = ReadBarcodes(ToImageView(img), DecodeHints(hints).setThreads(4));
+	ASSERT_EQ(parallel.size(), res.size());
+	for (int i = 0; i < Size(res); ++i) {
+		EXPECT_EQ(parallel[i].text(), res[i].text());
+		EXPECT_EQ(parallel[i].position(), res[i].position());
+	}
+
+	EXPECT_EQ(ReadBarcodes(ToImageView(img), DecodeHints(hints).setMaxNumberOfSymbols(2)).size(), 2);
+	// without enough overlap, the middle one is lost
+	EXPECT_EQ(ReadBarcodes(ToImageView(img), DecodeHints(hints).setTileOverlap(40)).size(), 2);
+
+	// the image may be wider than 65535 pixels
+	Matrix<uint8_t> wide(70000, 100, 255);
+	auto code128 = MakeImage(BarcodeFormat::Code128, "wide", 300, 80);
+	for (int y = 0; y < code128.height(); ++y)
+		for (int x = 0; x < code128.width(); ++x)
+			wide.set(69000 + x, 10 + y, code128.get(x, y));
+	res = ReadBarcodes(ToImageView(wide), DecodeHints().setFormats(BarcodeFormat::Code128).setTileSize(2048).setTileOverlap(400));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), "wide");
+	EXPECT_GT(res[0].position().topLeft().x, 69000);
+}
+
+TEST(ReadBarcodeTest, ResultCallback)
+{
+	// two symbols side by side and three in tiles
+	auto left = MakeImage(BarcodeFormat::QRCode, "left", 150, 150);
+	auto right = MakeImage(BarcodeFormat::QRCode, "right", 150, 150);
+	Matrix<uint8_t> img(1000, 400, 255);
+	for (int y = 0; y < 150; ++y)
+		for (int x = 0; x < 150; ++x) {
+			img.set(x + 20, y + 20, left.get(x, y));
+			img.set(x + 820, y + 100, right.get(x, y));
+		}
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode);
+	for (const auto& h : {hints, DecodeHints(hints).setThreads(4), DecodeHints(hints).setTileSize(400),
+						  DecodeHints(hints).setTileSize(400).setThreads(4), DecodeHints(hints).setRegionsOfInterest({{0, 0, 1000, 400}})}) {
+		auto expected = ReadBarcodes(ToImageView(img), h);
+		ASSERT_EQ(expected.size(), 2);
+
+		Results passed;
+		auto res = ReadBarcodes(ToImageView(img), h, [&](const Result& r) {
+			passed.push_back(r);
+			return true;
+		});
+		EXPECT_EQ(res, expected);
+		EXPECT_EQ(passed, expected);
+
+		// stopping after the first one
+		passed.clear();
+		res = ReadBarcodes(ToImageView(img), h, [&](const Result& r) {
+			passed.push_back(r);
+			return false;
+		});
+		ASSERT_EQ(passed.size(), 1);
+		EXPECT_EQ(res, passed);
+		EXPECT_EQ(res[0], expected[0]);
+	}
+
+	// results that are not found by a search (here of an unchanged frame) are passed as well
+	BarcodeReader reader(DecodeHints(hints).setFrameChangeThreshold(1));
+	reader.read(ToImageView(img));
+	int calls = 0;
+	auto res = reader.read(ToImageView(img), [&](const Result&) { return ++calls < 2; });
+	EXPECT_EQ(calls, 2);
+	EXPECT_EQ(res.size(), 2);
+}
+
+TEST(ReadBarcodeTest, ImageRowSource)
+{
+	// delivers the rows of an image in strips of 7 rows
+	struct StripSource : ImageRowSource
+	{
+		const Matrix<uint8_t>& img;
+		int next = 0;
+
+		explicit StripSource(const Matrix<uint8_t>& img) : img(img) {}
+		int width() const override { return img.width(); }
+		ImageFormat format() const override { return ImageFormat::Lum; }
+		int readRows(uint8_t* dst, int rowStride, int maxRows) override
+		{
+			int n = std::min({7, maxRows, img.height() - next});
+			for (int i = 0; i < n; ++i, ++next)
+				std::copy_n(img.data() + next * img.width(), img.width(), dst + i * rowStride);
+			return n;
+		}
+	};
+
+	// the second symbol straddles the border of the first two 400 row bands
+	Matrix<uint8_t> img(300, 2000, 255);
+	const std::vector<std::pair<std::string, PointI>> symbols = {{"first", {20, 20}}, {"second", {100, 320}}, {"third", {50, 1800}}};
+	for (const auto& [text, pos] : symbols) {
+		auto qr = MakeImage(BarcodeFormat::QRCode, text, 150, 150);
+		for (int y = 0; y < qr.height(); ++y)
+			for (int x = 0; x < qr.width(); ++x)
+				img.set(pos.x + x, pos.y + y, qr.get(x, y));
+	}
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode).setTileSize(400).setTileOverlap(160);
+	StripSource source(img);
+	auto res = ReadBarcodes(source, hints);
+	EXPECT_EQ(source.next, img.height());
+	ASSERT_EQ(res.size(), 3);
+	for (int i = 0; i < 3; ++i) {
+		EXPECT_EQ(res[i].text(), symbols[i].first);
+		auto pos = res[i].position().topLeft();
+		EXPECT_NEAR(pos.x, symbols[i].second.x + 10, 5) << i;
+		EXPECT_NEAR(pos.y, symbols[i].second.y + 10, 5) << i;
+	}
+
+	// the same as reading the image as a whole
+	auto expected = ReadBarcodes(ToImageView(img), DecodeHints(hints).setTileSize(0));
+	ASSERT_EQ(expected.size(), res.size());
+	for (int i = 0; i < Size(res); ++i)
+		EXPECT_EQ(expected[i].text(), res[i].text());
+
+	// no more rows than needed are pulled
+	StripSource first(img);
+	res = ReadBarcodes(first, DecodeHints(hints).setMaxNumberOfSymbols(1));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(first.next, 400);
+}
+
+TEST(ReadBarcodeTest, ProvidedDownscaledLayers)
+{
+	// a "downscaled" layer showing a different symbol than the full resolution image proves it is used as is
+	Matrix<uint8_t> full(600, 600, 255), layer(400, 400, 255);
+	auto put = [](Matrix<uint8_t>& img, const Matrix<uint8_t>& symbol, PointI pos) {
+		for (int y = 0; y < symbol.height(); ++y)
+			for (int x = 0; x < symbol.width(); ++x)
+				img.set(pos.x + x, pos.y + y, symbol.get(x, y));
+	};
+	put(full, MakeImage(BarcodeFormat::QRCode, "full", 150, 150), {20, 20});
+	put(layer, MakeImage(BarcodeFormat::QRCode, "layer", 120, 120), {200, 200});
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode);
+	auto inLayer = ReadBarcode(ToImageView(layer), hints);
+	ASSERT_TRUE(inLayer.isValid());
+	for (int threads : {1, 4}) {
+		DecodeStats stats;
+		auto res = ReadBarcodes(ToImageView(full), {ToImageView(layer)}, DecodeHints(hints).setThreads(threads).setStats(&stats));
+		ASSERT_EQ(res.size(), 2) << threads;
+		EXPECT_EQ(res[0].text(), "full");
+		EXPECT_EQ(res[1].text(), "layer");
+		// the positions of the layer are scaled by the non-integral factor 1.5
+		for (int i = 0; i < 4; ++i) {
+			EXPECT_NEAR(res[1].position()[i].x, inLayer.position()[i].x * 1.5, 1) << i;
+			EXPECT_NEAR(res[1].position()[i].y, inLayer.position()[i].y * 1.5, 1) << i;
+		}
+		EXPECT_EQ(stats.count(DecodeStats::Counter::Layers), 2);
+	}
+
+	// the software pyramid would not look at a 600 pixel image at all
+	EXPECT_EQ(ReadBarcodes(ToImageView(full), hints).size(), 1);
+	EXPECT_THROW(ReadBarcodes(ToImageView(layer), {ToImageView(full)}, hints), std::invalid_argument);
+}
+
+TEST(ReadBarcodeTest, BinarizerBackend)
+{
+	// a fixed threshold, to be run on the GPU in real life
+	struct Backend : BinarizerBackend
+	{
+		std::atomic<int> prepared = 0, binarized = 0;
+		bool decline = false;
+
+		void prepare(const ImageView&) override { ++prepared; }
+		bool binarize(const ImageView& iv, uint8_t* dst) override
+		{
+			++binarized;
+			if (decline)
+				return false;
+			for (int y = 0; y < iv.height(); ++y)
+				for (int x = 0; x < iv.width(); ++x)
+					*dst++ = *iv.data(x, y) < 128 ? 0xff : 0;
+			return true;
+		}
+	};
+
+	auto img = MakeImage(BarcodeFormat::QRCode, "GPU", 1200, 1200);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode);
+	auto expected = ReadBarcodes(ToImageView(img), hints);
+	ASSERT_EQ(expected.size(), 1);
+
+	for (bool decline : {false, true}) {
+		Backend backend;
+		backend.decline = decline;
+		auto res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setBinarizerBackend(&backend));
+		ASSERT_EQ(res.size(), 1) << decline;
+		EXPECT_EQ(res[0].text(), expected[0].text());
+		EXPECT_EQ(res[0].position(), expected[0].position());
+		// both layers of the pyramid (1200 and 400 pixels) are announced and binarized
+		EXPECT_EQ(backend.prepared, 2);
+		EXPECT_EQ(backend.binarized, 2);
+	}
+
+	// the backend only replaces the LocalAverage binarizer
+	Backend backend;
+	ReadBarcodes(ToImageView(img), DecodeHints(hints).setBinarizer(Binarizer::GlobalHistogram).setBinarizerBackend(&backend));
+	EXPECT_EQ(backend.binarized, 0);
+}
+
+TEST(ReadBarcodeTest, Deadline)
+{
+	auto img = MakeImage(BarcodeFormat::QRCode, "Deadline", 200, 200);
+
+	BarcodeReader reader(DecodeHints().setDeadline(std::chrono::steady_clock::now() - std::chrono::seconds(1)));
+	EXPECT_TRUE(reader.read(ToImageView(img)).empty());
+	EXPECT_TRUE(reader.deadlineExceeded());
+
+	BarcodeReader reader2(DecodeHints().setDeadline(std::chrono::steady_clock::now() + std::chrono::hours(1)));
+	auto res = reader2.read(ToImageView(img));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), "Deadline");
+	EXPECT_FALSE(reader2.deadlineExceeded());
+}
+
+TEST(ReadBarcodeTest, CoarseToFine)
+{
+	auto left = MakeImage(BarcodeFormat::QRCode, "left", 400, 400);
+	auto right = MakeImage(BarcodeFormat::DataMatrix, "right", 400, 400);
+	Matrix<uint8_t> img(800, 400);
+	for (int y = 0; y < 400; ++y)
+		for (int x = 0; x < 400; ++x) {
+			img.set(x, y, left.get(x, y));
+			img.set(x + 400, y, right.get(x, y));
+		}
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode | BarcodeFormat::DataMatrix);
+	auto expected = ReadBarcodes(ToImageView(img), hints);
+	auto res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setCoarseToFine(true));
+	ASSERT_EQ(expected.size(), 2);
+	ASSERT_EQ(res.size(), 2);
+	for (int i = 0; i < 2; ++i) {
+		EXPECT_EQ(res[i].text(), expected[i].text());
+		EXPECT_EQ(res[i].format(), expected[i].format());
+	}
+}
+
+TEST(ReadBarcodeTest, DownscaleFactors)
+{
+	// odd image sizes make sure the scalar tail of the (SIMD) downscaling code is covered as well
+	auto img = MakeImage(BarcodeFormat::QRCode, "Downscale", 1001, 1001);
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode).setDownscaleThreshold(100);
+
+	for (int factor : {2, 3, 4}) {
+		auto res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setDownscaleFactor(factor));
+		ASSERT_EQ(res.size(), 1);
+		EXPECT_EQ(res[0].text(), "Downscale");
+	}
+}
+
+TEST(ReadBarcodeTest, RGBFormats)
+{
+	auto lum = MakeImage(BarcodeFormat::QRCode, "RGB", 201, 201);
+	auto expected = ReadBarcodes(ToImageView(lum), DecodeHints().setBinarizer(Binarizer::GlobalHistogram));
+	ASSERT_EQ(expected.size(), 1);
+
+	for (auto format : {ImageFormat::RGB, ImageFormat::BGR, ImageFormat::RGBX, ImageFormat::XRGB, ImageFormat::BGRX,
+						ImageFormat::XBGR}) {
+		const int ps = PixStride(format);
+		std::vector<uint8_t> buffer(lum.size() * ps, 0x42); // 0x42 in the X channel
+		for (int i = 0; i < lum.size(); ++i) {
+			buffer[i * ps + RedIndex(format)] = lum.data()[i];
+			buffer[i * ps + GreenIndex(format)] = lum.data()[i];
+			buffer[i * ps + BlueIndex(format)] = lum.data()[i];
+		}
+		ImageView iv(buffer.data(), lum.width(), lum.height(), format);
+		for (auto binarizer : {Binarizer::GlobalHistogram, Binarizer::LocalAverage}) {
+			auto res = ReadBarcodes(iv, DecodeHints().setBinarizer(binarizer));
+			ASSERT_EQ(res.size(), 1);
+			EXPECT_EQ(res[0].text(), "RGB");
+			EXPECT_EQ(res[0].position(), expected[0].position());
+		}
+	}
+}
+
+TEST(ReadBarcodeTest, YUVFormats)
+{
+	auto lum = MakeImage(BarcodeFormat::QRCode, "YUV", 201, 201);
+
+	for (auto format : {ImageFormat::NV12, ImageFormat::NV21, ImageFormat::I420, ImageFormat::YUYV, ImageFormat::UYVY}) {
+		const int ps = PixStride(format), yIndex = BlueIndex(format);
+		std::vector<uint8_t> buffer(lum.size() * ps, 0x80); // 0x80 is the neutral chroma value
+		for (int i = 0; i < lum.size(); ++i)
+			buffer[i * ps + yIndex] = lum.data()[i];
+
+		ImageView iv(buffer.data(), lum.width(), lum.height(), format);
+		EXPECT_EQ(iv.format(), ImageFormat::Lum);
+		EXPECT_EQ(iv.pixStride(), ps);
+		EXPECT_EQ(*iv.data(3, 5), lum.get(3, 5));
+
+		for (auto binarizer : {Binarizer::LocalAverage, Binarizer::GlobalHistogram}) {
+			auto res = ReadBarcodes(iv, DecodeHints().setBinarizer(binarizer).setFormats(BarcodeFormat::QRCode));
+			ASSERT_EQ(res.size(), 1);
+			EXPECT_EQ(res[0].text(), "YUV");
+		}
+	}
+}
+
+TEST(ReadBarcodeTest, StridedLum)
+{
+	auto lum = MakeImage(BarcodeFormat::QRCode, "Strided", 201, 201);
+
+	for (int ps : {1, 2, 3, 4, 5}) {
+		std::vector<uint8_t> buffer(lum.size() * ps, 0x00);
+		for (int i = 0; i < lum.size(); ++i)
+			buffer[i * ps + ps - 1] = lum.data()[i];
+
+		// e.g. the alpha channel of a RGBA buffer, binarized in place
+		ImageView iv(buffer.data() + ps - 1, lum.width(), lum.height(), ImageFormat::Lum, 0, ps);
+		auto res = ReadBarcodes(iv, DecodeHints().setFormats(BarcodeFormat::QRCode));
+		ASSERT_EQ(res.size(), 1);
+		EXPECT_EQ(res[0].text(), "Strided");
+	}
+}
+
+TEST(ReadBarcodeTest, TrackSymbols)
+{
+	auto symbol = MakeImage(BarcodeFormat::QRCode, "Tracked", 150, 150);
+	auto frame = [&](int dx) {
+		Matrix<uint8_t> img(400, 200, 0xff);
+		for (int y = 0; y < 150; ++y)
+			for (int x = 0; x < 150; ++x)
+				img.set(x + 50 + dx, y + 25, symbol.get(x, y));
+		return img;
+	};
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode).setMaxNumberOfSymbols(1);
+	BarcodeReader reader(DecodeHints(hints).setTrackSymbols(true));
+	for (int dx : {0, 5, 10, 20, 200, 190}) {
+		auto img = frame(dx);
+		auto expected = ReadBarcodes(ToImageView(img), hints);
+		auto res = reader.read(ToImageView(img));
+		ASSERT_EQ(expected.size(), 1);
+		ASSERT_EQ(res.size(), 1) << dx;
+		EXPECT_EQ(res[0].text(), "Tracked");
+		EXPECT_EQ(res[0].position(), expected[0].position()) << dx;
+	}
+
+	Matrix<uint8_t> empty(400, 200, 0xff);
+	EXPECT_TRUE(reader.read(ToImageView(empty)).empty());
+}
+
+TEST(ReadBarcodeTest, TrackIds)
+{
+	auto symbol = MakeImage(BarcodeFormat::QRCode, "Tracked", 150, 150);
+	auto frame = [&](int dx) {
+		Matrix<uint8_t> img(400, 200, 0xff);
+		for (int y = 0; y < 150; ++y)
+			for (int x = 0; x < 150; ++x)
+				img.set(x + 50 + dx, y + 25, symbol.get(x, y));
+		return img;
+	};
+	Matrix<uint8_t> empty(400, 200, 0xff);
+	using Type = BarcodeReader::TrackEvent::Type;
+
+	BarcodeReader reader(DecodeHints().setFormats(BarcodeFormat::QRCode).setMaxNumberOfSymbols(1).setTrackSymbols(true));
+
+	auto res = reader.read(ToImageView(frame(0)));
+	ASSERT_EQ(res.size(), 1);
+	const int id = res[0].trackId();
+	EXPECT_EQ(id, 1);
+	ASSERT_EQ(reader.trackEvents().size(), 1);
+	EXPECT_EQ(reader.trackEvents()[0].type, Type::Enter);
+	EXPECT_EQ(reader.trackEvents()[0].result.trackId(), id);
+
+	// moving symbol keeps its id, short dropouts are bridged
+	for (int dx : {5, 10, -1, 20, 30}) {
+		auto img = dx < 0 ? Matrix<uint8_t>(400, 200, 0xff) : frame(dx);
+		res = reader.read(ToImageView(img));
+		EXPECT_TRUE(reader.trackEvents().empty()) << dx;
+		if (dx >= 0) {
+			ASSERT_EQ(res.size(), 1);
+			EXPECT_EQ(res[0].trackId(), id) << dx;
+		}
+	}
+
+	for (int i = 1; i <= BarcodeReader::TrackTimeout; ++i) {
+		EXPECT_TRUE(reader.read(ToImageView(empty)).empty());
+		EXPECT_EQ(reader.trackEvents().size(), i == BarcodeReader::TrackTimeout);
+	}
+	EXPECT_EQ(reader.trackEvents()[0].type, Type::Leave);
+	EXPECT_EQ(reader.trackEvents()[0].result.trackId(), id);
+	EXPECT_EQ(reader.trackEvents()[0].result.text(), "Tracked");
+
+	// reappearing symbol gets a new id
+	res = reader.read(ToImageView(frame(0)));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].trackId(), id + 1);
+	ASSERT_EQ(reader.trackEvents().size(), 1);
+	EXPECT_EQ(reader.trackEvents()[0].type, Type::Enter);
+
+	// not tracked without DecodeHints::trackSymbols
+	res = BarcodeReader(DecodeHints().setFormats(BarcodeFormat::QRCode)).read(ToImageView(frame(0)));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].trackId(), 0);
+}
+
+TEST(ReadBarcodeTest, DecodeStats)
+{
+	using Stage = DecodeStats::Stage;
+	using Counter = DecodeStats::Counter;
+
+	auto qr = MakeImage(BarcodeFormat::QRCode, "Stats", 200, 200);
+	auto code128 = MakeImage(BarcodeFormat::Code128, "Stats", 300, 80);
+
+	DecodeStats stats;
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode | BarcodeFormat::Code128).setTryInvert(false).setStats(&stats);
+	ASSERT_EQ(ReadBarcodes(ToImageView(qr), hints).size(), 1);
+	ASSERT_EQ(ReadBarcodes(ToImageView(code128), hints).size(), 1);
+
+	EXPECT_EQ(stats.count(Counter::Reads), 2);
+	EXPECT_GE(stats.count(Counter::Layers), 2);
+	EXPECT_EQ(stats.count(Counter::InvertPasses), 0);
+	EXPECT_GE(stats.count(Counter::FinderCandidates), 3);
+	EXPECT_GT(stats.count(Counter::RowsScanned), 0);
+	EXPECT_EQ(stats.count(Counter::ECFailures), 0);
+	for (auto stage : {Stage::Binarize, Stage::Detect, Stage::Sample, Stage::Decode, Stage::ECC})
+		EXPECT_GT(stats.duration(stage).count(), 0) << DecodeStats::Name(stage);
+
+	// the reads are accumulated until reset, also from the parallel code path
+	ReadBarcodes(ToImageView(qr), DecodeHints(hints).setTryInvert(true).setThreads(4));
+	EXPECT_EQ(stats.count(Counter::Reads), 3);
+	EXPECT_GE(stats.count(Counter::InvertPasses), 1);
+
+	std::map<std::string, double> exported;
+	stats.forEach([&](const std::string& name, double value) { exported[name] = value; });
+	EXPECT_EQ(exported.size(), DecodeStats::StageCount + DecodeStats::CounterCount);
+	EXPECT_EQ(exported["reads_total"], 3);
+	EXPECT_GT(exported["binarize_seconds_total"], 0);
+
+	stats.reset();
+	EXPECT_EQ(stats.count(Counter::Reads), 0);
+	EXPECT_EQ(stats.duration(Stage::Detect).count(), 0);
+
+	// without stats nothing is recorded
+	ReadBarcodes(ToImageView(qr), DecodeHints(hints).setStats(nullptr));
+	EXPECT_EQ(stats.count(Counter::Reads), 0);
+}
+
+TEST(ReadBarcodeTest, Escalate)
+{
+	using Counter = DecodeStats::Counter;
+
+	auto qr = MakeImage(BarcodeFormat::QRCode, "Escalate", 200, 200);
+	auto inverted = qr.copy();
+	for (int y = 0; y < inverted.height(); ++y)
+		for (int x = 0; x < inverted.width(); ++x)
+			inverted.set(x, y, 255 - inverted.get(x, y));
+
+	DecodeStats stats;
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode | BarcodeFormat::Code128).setStats(&stats).setEscalate(true);
+	BarcodeReader reader(hints);
+
+	// found by the fast pass, none of the regular passes runs
+	auto res = reader.read(ToImageView(qr));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res.front().text(), "Escalate");
+	EXPECT_EQ(stats.count(Counter::Escalations), 0);
+	EXPECT_EQ(stats.count(Counter::Layers), 0);
+
+	// found by the inverted pass over the full resolution layer, the downscaled layers are not processed
+	res = reader.read(ToImageView(inverted));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res.front().text(), "Escalate");
+	EXPECT_TRUE(res.front().isInverted());
+	EXPECT_EQ(stats.count(Counter::Escalations), 1);
+	EXPECT_EQ(stats.count(Counter::Layers), 1);
+	EXPECT_EQ(stats.count(Counter::InvertPasses), 1);
+
+	// the same results as without escalation, also with threads
+	for (const auto* img : {&qr, &inverted}) {
+		auto expected = ReadBarcodes(ToImageView(*img), DecodeHints(hints).setEscalate(false));
+		res = ReadBarcodes(ToImageView(*img), DecodeHints(hints).setThreads(4));
+		ASSERT_EQ(res.size(), expected.size());
+		EXPECT_EQ(res.front().text(), expected.front().text());
+		EXPECT_EQ(res.front().position(), expected.front().position());
+	}
+}
+
+TEST(ReadBarcodeTest, FrameChangeThreshold)
+{
+	auto qr = MakeImage(BarcodeFormat::QRCode, "Conveyor", 200, 200);
+	auto dm = MakeImage(BarcodeFormat::DataMatrix, "Conveyor", 200, 200);
+	DecodeStats stats;
+	BarcodeReader reader(DecodeHints().setFrameChangeThreshold(4).setStats(&stats));
+
+	ASSERT_EQ(reader.read(ToImageView(qr)).size(), 1);
+	EXPECT_EQ(stats.count(DecodeStats::Counter::UnchangedFrames), 0);
+
+	// the same scene with a little noise is not decoded again
+	auto noisy = qr.copy();
+	for (int y = 0; y < noisy.height(); ++y)
+		for (int x = y % 7; x < noisy.width(); x += 7)
+			noisy(x, y) = noisy(x, y) ? 253 : 2;
+	auto res = reader.read(ToImageView(noisy));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res.front().text(), "Conveyor");
+	EXPECT_EQ(stats.count(DecodeStats::Counter::UnchangedFrames), 1);
+
+	// a new scene is
+	res = reader.read(ToImageView(dm));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res.front().format(), BarcodeFormat::DataMatrix);
+	EXPECT_EQ(stats.count(DecodeStats::Counter::UnchangedFrames), 1);
+	EXPECT_EQ(stats.count(DecodeStats::Counter::Reads), 3);
+
+	// the comparison is with the last image decoded, so a slow drift does not go unnoticed
+	stats.reset();
+	ASSERT_EQ(reader.read(ToImageView(qr)).size(), 1);
+	auto drifted = qr.copy();
+	for (int step = 1; step <= 4; ++step) {
+		for (int y = 0; y < drifted.height(); ++y)
+			for (int x = 0; x < drifted.width(); ++x)
+				drifted(x, y) = std::max(0, drifted(x, y) - 2);
+		EXPECT_EQ(reader.read(ToImageView(drifted)).size(), 1);
+		EXPECT_EQ(stats.count(DecodeStats::Counter::UnchangedFrames), (step + 1) / 2) << step;
+	}
+}
+
+TEST(ReadBarcodeTest, FallbackBinarizers)
+{
+	// dark gray on light gray: invisible to BoolCast (only 0 is black), fine for FixedThreshold
+	auto img = MakeImage(BarcodeFormat::QRCode, "Fallback", 200, 200);
+	for (int y = 0; y < img.height(); ++y)
+		for (int x = 0; x < img.width(); ++x)
+			img(x, y) = img(x, y) ? 200 : 60;
+	DecodeStats stats;
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode).setBinarizer(Binarizer::BoolCast).setStats(&stats);
+
+	EXPECT_TRUE(ReadBarcodes(ToImageView(img), hints).empty());
+
+	hints.setFallbackBinarizers({Binarizer::BoolCast, Binarizer::FixedThreshold, Binarizer::LocalAverage});
+	for (int threads : {1, 4}) {
+		for (bool isPure : {false, true}) {
+			stats.reset();
+			auto res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setThreads(threads).setIsPure(isPure));
+			ASSERT_EQ(res.size(), 1) << threads << isPure;
+			EXPECT_EQ(res.front().text(), "Fallback");
+			// the duplicate BoolCast is skipped and LocalAverage is not needed anymore
+			EXPECT_EQ(stats.count(DecodeStats::Counter::FallbackPasses), 1) << threads << isPure;
+			EXPECT_EQ(stats.count(DecodeStats::Counter::Reads), 1);
+		}
+	}
+
+	// GlobalHistogram binarizes the rows for the linear readers like LocalAverage, with only linear formats requested
+	// there is nothing left to try
+	stats.reset();
+	auto linear = DecodeHints().setFormats(BarcodeFormat::Code128).setFallbackBinarizers({Binarizer::GlobalHistogram}).setStats(&stats);
+	EXPECT_TRUE(ReadBarcodes(ToImageView(img), linear).empty());
+	EXPECT_EQ(stats.count(DecodeStats::Counter::FallbackPasses), 0);
+	ReadBarcodes(ToImageView(img), DecodeHints(linear).setFormats(BarcodeFormat::Code128 | BarcodeFormat::DataMatrix));
+	EXPECT_EQ(stats.count(DecodeStats::Counter::FallbackPasses), 1);
+}
+
+TEST(ReadBarcodeTest, ModuleSizeRange)
+{
+	DecodeStats stats;
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode | BarcodeFormat::DataMatrix | BarcodeFormat::Code128)
+					 .setTryInvert(false)
+					 .setStats(&stats);
+
+	// the symbol width in modules
+	for (auto [format, modules] : {std::pair{BarcodeFormat::QRCode, 21}, {BarcodeFormat::DataMatrix, 16}, {BarcodeFormat::Code128, 145}}) {
+		// with a quiet zone of several modules, the odd image size gives non-integral layer scale factors
+		auto symbol = MakeImage(format, "ModuleSize", 600, format == BarcodeFormat::Code128 ? 150 : 600);
+		Matrix<uint8_t> img(1001, 999, 255);
+		for (int y = 0; y < symbol.height(); ++y)
+			for (int x = 0; x < symbol.width(); ++x)
+				img.set(x + 200, y + 200, symbol.get(x, y));
+		stats.reset();
+		auto expected = ReadBarcodes(ToImageView(img), hints);
+		ASSERT_EQ(expected.size(), 1) << ToString(format);
+		EXPECT_GE(stats.count(DecodeStats::Counter::Layers), 1);
+
+		const float moduleSize = 580.f / modules;
+		stats.reset();
+		auto res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setModuleSizeRange(moduleSize * 0.8f, moduleSize * 1.2f));
+		ASSERT_EQ(res.size(), 1) << ToString(format);
+		EXPECT_EQ(res[0].text(), "ModuleSize");
+		// only the one downscaled layer in which the modules are about 5 pixels large
+		EXPECT_EQ(stats.count(DecodeStats::Counter::Layers), 1) << ToString(format);
+		// the y coordinates of a linear symbol are the ones of the scanned rows
+		for (int i = 0; i < 4; ++i) {
+			EXPECT_NEAR(res[0].position()[i].x, expected[0].position()[i].x, moduleSize) << ToString(format) << i;
+			if (format != BarcodeFormat::Code128)
+				EXPECT_NEAR(res[0].position()[i].y, expected[0].position()[i].y, moduleSize) << ToString(format) << i;
+		}
+	}
+
+	// the finder patterns of a QR Code with much larger modules than expected are not even looked at
+	auto img = MakeImage(BarcodeFormat::QRCode, "ModuleSize", 1000, 1000);
+	EXPECT_TRUE(ReadBarcodes(ToImageView(img), DecodeHints(hints).setModuleSizeRange(1, 2)).empty());
+}
+
+TEST(ReadBarcodeTest, MinConfidence)
+{
+	using Counter = DecodeStats::Counter;
+
+	DecodeStats stats;
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode | BarcodeFormat::Code128).setTryInvert(true).setStats(&stats);
+
+	// a clean symbol needs no error correction
+	auto img = MakeImage(BarcodeFormat::QRCode, "Confidence", 1000, 1000);
+	auto res = ReadBarcodes(ToImageView(img), hints);
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].confidence(), 1);
+	EXPECT_GT(stats.count(Counter::Layers), 1);
+	EXPECT_GT(stats.count(Counter::InvertPasses), 0);
+
+	// only the first pass is needed
+	stats.reset();
+	res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setMinConfidence(1));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), "Confidence");
+	EXPECT_EQ(stats.count(Counter::Layers), 1);
+	EXPECT_EQ(stats.count(Counter::InvertPasses), 0);
+
+	res = ReadBarcodes(ToImageView(img), DecodeHints(hints).setMinConfidence(1).setThreads(4));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), "Confidence");
+
+	// a damaged symbol is still read, with a lower confidence, but does not stop the search
+	auto damaged = img.copy();
+	for (int y = 450; y < 550; ++y)
+		for (int x = 450; x < 550; ++x)
+			damaged.set(x, y, 255 - damaged.get(x, y));
+	stats.reset();
+	res = ReadBarcodes(ToImageView(damaged), DecodeHints(hints).setMinConfidence(1));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0].text(), "Confidence");
+	EXPECT_GE(res[0].confidence(), 0.5);
+	EXPECT_LT(res[0].confidence(), 1);
+	EXPECT_GT(stats.count(Counter::Layers), 1);
+
+	// linear symbols are rated by the number of matching scan lines
+	res = ReadBarcodes(ToImageView(MakeImage(BarcodeFormat::Code128, "Confidence", 400, 100)), hints);
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_FLOAT_EQ(res[0].confidence(), res[0].lineCount() / (res[0].lineCount() + 1.f));
+	EXPECT_EQ(Result().confidence(), 0);
+}
+
+TEST(ReadBarcodeTest, FormatOverrides)
+{
+	auto hints = DecodeHints().setTryHarder(false).setTryRotate(false).setTryInvert(false).setFormatOverrides({
+		{BarcodeFormat::DataMatrix, true, std::nullopt, true, std::nullopt},
+		{BarcodeFormat::LinearCodes, std::nullopt, true, std::nullopt, 3},
+	});
+	EXPECT_TRUE(hints.forFormats(BarcodeFormat::DataMatrix).tryHarder());
+	EXPECT_TRUE(hints.forFormats(BarcodeFormat::DataMatrix).tryInvert());
+	EXPECT_FALSE(hints.forFormats(BarcodeFormat::DataMatrix).tryRotate());
+	EXPECT_FALSE(hints.forFormats(BarcodeFormat::QRCode).tryHarder());
+	EXPECT_TRUE(hints.forFormats(BarcodeFormat::EAN13).tryRotate());
+	EXPECT_EQ(hints.forFormats(BarcodeFormat::EAN13).minLineCount(), 3);
+	EXPECT_EQ(hints.forFormats(BarcodeFormat::QRCode).minLineCount(), 2);
+	EXPECT_TRUE(hints.tryInvertAny());
+	EXPECT_FALSE(DecodeHints(hints).setFormatOverrides({}).tryInvertAny());
+
+	auto invert = [](Matrix<uint8_t> img) {
+		for (int y = 0; y < img.height(); ++y)
+			for (int x = 0; x < img.width(); ++x)
+				img.set(x, y, 255 - img.get(x, y));
+		return img;
+	};
+	auto rotate = [](const Matrix<uint8_t>& img) {
+		Matrix<uint8_t> res(img.height(), img.width());
+		for (int y = 0; y < img.height(); ++y)
+			for (int x = 0; x < img.width(); ++x)
+				res.set(img.height() - 1 - y, x, img.get(x, y));
+		return res;
+	};
+
+	// only the overridden formats are read inverted
+	auto dm = invert(MakeImage(BarcodeFormat::DataMatrix, "Override", 200, 200));
+	auto qr = invert(MakeImage(BarcodeFormat::QRCode, "Override", 200, 200));
+	EXPECT_EQ(ReadBarcodes(ToImageView(dm), hints).size(), 1);
+	EXPECT_EQ(ReadBarcodes(ToImageView(qr), hints).size(), 0);
+	EXPECT_EQ(ReadBarcodes(ToImageView(qr), DecodeHints(hints).setTryInvert(true)).size(), 1);
+
+	// only the linear formats are read rotated
+	auto ean = rotate(MakeImage(BarcodeFormat::EAN13, "4006381333931", 300, 100));
+	EXPECT_EQ(ReadBarcodes(ToImageView(ean), hints).size(), 1);
+	EXPECT_EQ(ReadBarcodes(ToImageView(ean), DecodeHints(hints).setFormatOverrides({})).size(), 0);
+}
+
+TEST(ReadBarcodeTest, DetectOnly)
+{
+	struct Sample
+	{
+		BarcodeFormat format;
+		std::string text;
+		int width, height;
+	};
+	for (const auto& s : {Sample{BarcodeFormat::QRCode, "DetectOnly", 200, 200}, Sample{BarcodeFormat::DataMatrix, "DetectOnly", 200, 200},
+						  Sample{BarcodeFormat::Aztec, "DetectOnly", 200, 200}, Sample{BarcodeFormat::PDF417, "DetectOnly", 400, 160},
+						  Sample{BarcodeFormat::EAN13, "4006381333931", 300, 100}}) {
+		auto img = MakeImage(s.format, s.text, s.width, s.height);
+		auto hints = DecodeHints().setFormats(s.format);
+		auto expected = ReadBarcodes(ToImageView(img), hints);
+		auto located = ReadBarcodes(ToImageView(img), hints.setDetectOnly(true));
+		ASSERT_EQ(expected.size(), 1) << ToString(s.format);
+		ASSERT_EQ(located.size(), 1) << ToString(s.format);
+
+		const auto& r = located.front();
+		EXPECT_TRUE(r.isValid()) << ToString(s.format);
+		EXPECT_EQ(r.format(), s.format);
+		EXPECT_TRUE(IsInside(Center(expected.front().position()), r.position())) << ToString(s.format);
+		if (s.format == BarcodeFormat::EAN13) {
+			// the linear readers still decode
+			EXPECT_FALSE(r.isDetectOnly());
+			EXPECT_EQ(r.text(), s.text);
+		} else {
+			EXPECT_TRUE(r.isDetectOnly()) << ToString(s.format);
+			EXPECT_TRUE(r.bytes().empty()) << ToString(s.format);
+		}
+	}
+
+	// several symbols, each located once
+	Matrix<uint8_t> page(600, 300, 255);
+	for (int i = 0; i < 3; ++i) {
+		auto qr = MakeImage(BarcodeFormat::QRCode, std::to_string(i), 150, 150);
+		for (int y = 0; y < qr.height(); ++y)
+			for (int x = 0; x < qr.width(); ++x)
+				page.set(i * 200 + x, 50 + y, qr.get(x, y));
+	}
+	auto located = ReadBarcodes(ToImageView(page), DecodeHints().setDetectOnly(true));
+	EXPECT_EQ(located.size(), 3);
+	for (const auto& r : located)
+		EXPECT_EQ(r.format(), BarcodeFormat::QRCode);
+}
+
+TEST(ReadBarcodeTest, TraceSink)
+{
+	struct RecordingSink : public TraceSink
+	{
+		std::mutex mutex;
+		std::vector<std::string> events;
+		void begin(const char* name) override
+		{
+			std::lock_guard lock(mutex);
+			events.push_back(std::string("B ") + name);
+		}
+		void end(const char* name) override
+		{
+			std::lock_guard lock(mutex);
+			events.push_back(std::string("E ") + name);
+		}
+	};
+
+	auto img = MakeImage(BarcodeFormat::QRCode, "Trace", 200, 200);
+	RecordingSink sink;
+	SetTraceSink(&sink);
+	auto res = ReadBarcodes(ToImageView(img), DecodeHints().setFormats(BarcodeFormat::QRCode));
+	SetTraceSink(nullptr);
+	ASSERT_EQ(res.size(), 1);
+
+#ifdef ZXING_BUILD_TRACING
+	ASSERT_FALSE(sink.events.empty());
+	EXPECT_EQ(sink.events.front(), "B BarcodeReader::read");
+	EXPECT_EQ(sink.events.back(), "E BarcodeReader::read");
+	for (auto name : {"HybridBinarizer::getBlackMatrix", "QRCode::Reader::decode", "ReedSolomonDecode"})
+		EXPECT_TRUE(Contains(sink.events, std::string("B ") + name)) << name;
+
+	// single threaded read, so the events need to be properly nested
+	std::vector<std::string> stack;
+	for (const auto& e : sink.events) {
+		if (e[0] == 'B') {
+			stack.push_back(e.substr(2));
+		} else {
+			ASSERT_FALSE(stack.empty());
+			EXPECT_EQ(stack.back(), e.substr(2));
+			stack.pop_back();
+		}
+	}
+	EXPECT_TRUE(stack.empty());
+#else
+	EXPECT_TRUE(sink.events.empty());
+#endif
+}
+
+TEST(ReadBarcodeTest, DecodeModules)
+{
+	std::pair<BarcodeFormat, std::string> samples[] = {
+		{BarcodeFormat::Aztec, "Aztec module matrix"}, {BarcodeFormat::DataMatrix, "DataMatrix module matrix"},
+		{BarcodeFormat::PDF417, "PDF417 module matrix"}, {BarcodeFormat::QRCode, "QRCode module matrix"},
+		{BarcodeFormat::Codabar, "A1234B"}, {BarcodeFormat::Code39, "ZXING-39"}, {BarcodeFormat::Code93, "ZXING-93"},
+		{BarcodeFormat::Code128, "ZXing 128"}, {BarcodeFormat::EAN8, "12345670"}, {BarcodeFormat::EAN13, "1234567890128"},
+		{BarcodeFormat::ITF, "1234567890"}, {BarcodeFormat::UPCA, "123456789012"}, {BarcodeFormat::UPCE, "01234565"},
+	};
+	for (auto& [format, text] : samples) {
+		auto modules = MultiFormatWriter(format).encodeModules(text).modules;
+		auto res = DecodeModules(modules, format);
+		EXPECT_TRUE(res.isValid()) << ToString(format);
+		EXPECT_EQ(res.format(), format);
+		EXPECT_EQ(res.text(), text) << ToString(format);
+		EXPECT_TRUE(VerifyModules(modules, format, text)) << ToString(format);
+		EXPECT_FALSE(VerifyModules(modules, format, text + "X")) << ToString(format);
+	}
+
+	// a few broken modules are corrected by the 2D decoders
+	auto modules = MultiFormatWriter(BarcodeFormat::QRCode).encodeModules("QRCode module matrix").modules;
+	modules.flip(10, 12);
+	EXPECT_TRUE(VerifyModules(modules, BarcodeFormat::QRCode, "QRCode module matrix"));
+
+	// a broken bar is not
+	modules = MultiFormatWriter(BarcodeFormat::Code128).encodeModules("ZXing 128").modules;
+	modules.flip(20, 0);
+	EXPECT_FALSE(VerifyModules(modules, BarcodeFormat::Code128, "ZXing 128"));
+
+	EXPECT_FALSE(DecodeModules(BitMatrix(19, 19), BarcodeFormat::Aztec).isValid());
+	EXPECT_FALSE(DecodeModules(BitMatrix(120, 12), BarcodeFormat::PDF417).isValid());
+}
+
+TEST(ReadBarcodeTest, SerializedModules)
+{
+	for (auto format : {BarcodeFormat::QRCode, BarcodeFormat::DataMatrix, BarcodeFormat::Aztec}) {
+		auto img = MakeImage(format, "Edge", 200, 200);
+		for (bool inverted : {false, true}) {
+			if (inverted)
+				for (int y = 0; y < img.height(); ++y)
+					for (int x = 0; x < img.width(); ++x)
+						img(x, y) = 255 - img(x, y);
+			auto hints = DecodeHints().setFormats(format);
+			auto expected = ReadBarcodes(ToImageView(img), hints);
+			auto located = ReadBarcodes(ToImageView(img), DecodeHints(hints).setDetectOnly(true));
+			ASSERT_EQ(expected.size(), 1) << ToString(format);
+			ASSERT_EQ(located.size(), 1) << ToString(format);
+			ASSERT_NE(located.front().modules(), nullptr) << ToString(format);
+
+			// only the serialized modules cross the network
+			auto data = SerializeModules(located.front());
+			EXPECT_LT(data.size(), 100) << ToString(format);
+			auto detected = DeserializeModules(data);
+			EXPECT_TRUE(detected.isDetectOnly());
+			EXPECT_EQ(detected.format(), format);
+			EXPECT_EQ(detected.position(), located.front().position());
+			EXPECT_EQ(detected.isInverted(), inverted);
+			EXPECT_TRUE(*detected.modules() == *located.front().modules());
+
+			auto res = DecodeModules(detected);
+			EXPECT_TRUE(res.isValid()) << ToString(format);
+			EXPECT_EQ(res.text(), "Edge");
+			EXPECT_EQ(res.format(), format);
+			EXPECT_EQ(res.position(), located.front().position());
+			EXPECT_EQ(res.isInverted(), expected.front().isInverted());
+		}
+	}
+
+	auto located = ReadBarcodes(ToImageView(MakeImage(BarcodeFormat::QRCode, "Edge", 200, 200)), DecodeHints().setDetectOnly(true));
+	ASSERT_EQ(located.size(), 1);
+	auto data = SerializeModules(located.front());
+	auto truncated = data;
+	truncated.pop_back();
+	EXPECT_THROW(DeserializeModules(truncated), std::invalid_argument);
+	data[3] = 2;
+	EXPECT_THROW(DeserializeModules(data), std::invalid_argument);
+	EXPECT_THROW(DeserializeModules(ByteArray("ZXM")), std::invalid_argument);
+	EXPECT_THROW(SerializeModules(Result()), std::invalid_argument);
+	EXPECT_THROW(DecodeModules(Result()), std::invalid_argument);
+}
+
+TEST(ReadBarcodeTest, AdaptiveReaderOrder)
+{
+	auto dm = MakeImage(BarcodeFormat::DataMatrix, "ZXing DataMatrix", 200, 200);
+	auto qr = MakeImage(BarcodeFormat::QRCode, "ZXing QRCode", 200, 200);
+	const auto hints = DecodeHints()
+						   .setFormats(BarcodeFormat::EAN13 | BarcodeFormat::QRCode | BarcodeFormat::DataMatrix)
+						   .setTryHarder(false)
+						   .setAdaptiveReaderOrder(true);
+	MultiFormatReader reader(hints);
+	// the readers in order of construction: linear first (without tryHarder), then QRCode and DataMatrix
+	EXPECT_EQ(reader.readerOrder(), std::vector<int>({0, 1, 2}));
+
+	for (int i = 0; i < 10; ++i)
+		EXPECT_EQ(reader.read(HybridBinarizer(ToImageView(dm))).format(), BarcodeFormat::DataMatrix);
+	EXPECT_EQ(reader.readerOrder().front(), 2);
+
+	// the input changes, after a while the QRCode reader moves to the front
+	for (int i = 0; i < 50; ++i)
+		EXPECT_EQ(reader.read(HybridBinarizer(ToImageView(qr))).format(), BarcodeFormat::QRCode);
+	EXPECT_EQ(reader.readerOrder().front(), 1);
+
+	// without the hint, the order is fixed
+	auto fixedHints = DecodeHints(hints).setAdaptiveReaderOrder(false);
+	MultiFormatReader fixed(fixedHints);
+	for (int i = 0; i < 10; ++i)
+		EXPECT_EQ(fixed.read(HybridBinarizer(ToImageView(dm))).format(), BarcodeFormat::DataMatrix);
+	EXPECT_EQ(fixed.readerOrder(), std::vector<int>({0, 1, 2}));
+}
+
+TEST(ReadBarcodeTest, InterleavedCandidates)
+{
+	// three QR Codes and an Aztec symbol
+	Matrix<uint8_t> page(800, 250, 255);
+	for (int i = 0; i < 4; ++i) {
+		auto sym = MakeImage(i < 3 ? BarcodeFormat::QRCode : BarcodeFormat::Aztec, std::to_string(i), 150, 150);
+		for (int y = 0; y < sym.height(); ++y)
+			for (int x = 0; x < sym.width(); ++x)
+				page.set(i * 200 + x, 50 + y, sym.get(x, y));
+	}
+	HybridBinarizer image(ToImageView(page));
+	const auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode | BarcodeFormat::Aztec);
+
+	// draining the candidates of a reader finds the same symbols as its decode(), one candidate per step
+	QRCode::Reader qr(hints, true);
+	auto stream = qr.candidates(image, 0);
+	Results found;
+	while (found.empty() && stream->next(found))
+		;
+	EXPECT_EQ(found.size(), 1);
+	while (stream->next(found))
+		;
+	EXPECT_FALSE(stream->next(found));
+	auto decoded = qr.decode(image, 0);
+	ASSERT_EQ(found.size(), 3);
+	ASSERT_EQ(decoded.size(), 3);
+	for (int i = 0; i < 3; ++i)
+		EXPECT_EQ(found[i].text(), decoded[i].text());
+
+	Aztec::Reader az(hints, true);
+	Results azFound;
+	for (auto azStream = az.candidates(image, 0); azStream->next(azFound);)
+		;
+	ASSERT_EQ(azFound.size(), 1);
+	EXPECT_EQ(azFound.front().text(), "3");
+
+	// with a single symbol wanted, the interleaved readers stop at the first one
+	MultiFormatReader reader(hints);
+	EXPECT_EQ(reader.readMultiple(image).size(), 4);
+	auto first = reader.readMultiple(image, 1);
+	ASSERT_EQ(first.size(), 1);
+	EXPECT_TRUE(first.front().isValid());
+	EXPECT_EQ(first.front().text(), found.front().text());
+}
+
+TEST(ReadBarcodeTest, MergeStructuredAppendSequences)
+{
+	Results results = {MakeSequenceResult("ab", 1, 2, "a"), MakeSequenceResult("Y", 0, 3, "b"), MakeSequenceResult("12", 0, 2, "a"),
+					   MakeSequenceResult("Z", 2, 3, "b"), MakeSequenceResult("X", 1, 3, "b")};
+
+	auto merged = MergeStructuredAppendSequences(results);
+	ASSERT_EQ(merged.size(), 2);
+	EXPECT_EQ(merged[0].text(), "12ab");
+	EXPECT_EQ(merged[1].text(), "YXZ");
+	EXPECT_FALSE(merged[0].isPartOfSequence());
+
+	// the input is left untouched
+	EXPECT_EQ(results[0].text(), "ab");
+
+	// symbol 2 of sequence "b" is missing
+	auto incomplete = MergeStructuredAppendSequence({results[1], results[4]});
+	EXPECT_EQ(incomplete.text(), "YX");
+	EXPECT_TRUE(incomplete.error());
+}
@@ -0,0 +1,68 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "RegressionLine.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+using namespace ZXing;
+
+// the points of a slightly tilted line, far away from the origin and with +/-0.5 pixel of noise
+static std::vector<PointF> NoisyLine(int n)
+{
+	std::vector<PointF> res;
+	for (int i = 0; i < n; ++i)
+		res.push_back(PointF(3000 + i, 2000 + 0.1 * i + (i % 3 - 1) * 0.5));
+	return res;
+}
+
+TEST(RegressionLineTest, Incremental)
+{
+	auto points = NoisyLine(100);
+
+	RegressionLine line;
+	line.setDirectionInward({0, 1});
+	for (auto p : points)
+		line.add(p);
+	EXPECT_TRUE(line.evaluate());
+
+	// the batch line has no inward direction, so its normal might point the other way
+	RegressionLine batch(points.data(), points.data() + points.size());
+	EXPECT_NEAR(std::abs(dot(line.normal(), batch.normal())), 1, 1e-12);
+	EXPECT_NEAR(line.distance(PointF(0, 0)), batch.distance(PointF(0, 0)), 1e-6);
+	EXPECT_NEAR(line.distance(points[50]), 0.5, 0.1);
+
+	// removing points updates the moments as well
+	RegressionLine middle(points.data() + 1, points.data() + points.size() - 1);
+	line.pop_front();
+	line.pop_back();
+	EXPECT_TRUE(line.evaluate());
+	EXPECT_NEAR(line.distance(PointF(0, 0)), middle.distance(PointF(0, 0)), 1e-6);
+	EXPECT_NEAR(line.centroid().x, 3049.5, 1e-9);
+}
+
+TEST(RegressionLineTest, Outliers)
+{
+	auto points = NoisyLine(40);
+	points[10].y += 5;
+	points[30].y -= 5;
+
+	RegressionLine line;
+	line.setDirectionInward({0, 1});
+	for (auto p : points)
+		line.add(p);
+
+	EXPECT_TRUE(line.evaluate(1.0));
+	EXPECT_EQ(Size(line.points()), 40); // not updated
+
+	EXPECT_TRUE(line.evaluate(1.0, true));
+	ASSERT_EQ(Size(line.points()), 38);
+	EXPECT_EQ(line.points()[10], points[11]);
+	EXPECT_EQ(line.points()[29], points[31]);
+	EXPECT_NEAR(line.centroid().x, 3000 + (780 - 10 - 30) / 38., 1e-9);
+	EXPECT_NEAR(line.normal().x, -0.1 / std::sqrt(1.01), 0.01);
+}
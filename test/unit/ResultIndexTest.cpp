@@ -0,0 +1,74 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ResultIndex.h"
+
+#include "DecoderResult.h"
+#include "PseudoRandom.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ZXing;
+
+namespace {
+
+Result RandomResult(PseudoRandom& rnd)
+{
+	const std::string text(1, static_cast<char>('0' + rnd.next(0, 3)));
+	const int x = rnd.next(0, 1000), y = rnd.next(0, 1000), size = rnd.next(1, 200);
+
+	if (rnd.next(0, 1))
+		return Result(text, y, x, x + size, rnd.next(0, 1) ? BarcodeFormat::EAN13 : BarcodeFormat::Code128, {'E', '0'});
+
+	Content content;
+	content.symbology = {'Q', '1'};
+	content.append(text);
+	DecoderResult decoderResult(std::move(content));
+	if (rnd.next(0, 4) == 0)
+		decoderResult.setError(ChecksumError());
+	return Result(std::move(decoderResult), Position({x, y}, {x + size, y}, {x + size, y + size}, {x, y + size}),
+				  rnd.next(0, 1) ? BarcodeFormat::QRCode : BarcodeFormat::DataMatrix);
+}
+
+} // namespace
+
+TEST(ResultIndexTest, FindMatchesLinearSearch)
+{
+	PseudoRandom rnd(42);
+	Results results;
+	ResultIndex index;
+	for (int i = 0; i < 2000; ++i) {
+		auto r = RandomResult(rnd);
+		auto it = Find(results, r);
+		ASSERT_EQ(index.find(results, r), it == results.end() ? -1 : narrow_cast<int>(it - results.begin())) << i;
+		if (it == results.end()) {
+			index.add(r);
+			results.push_back(std::move(r));
+		}
+	}
+	EXPECT_GT(results.size(), 100);
+}
+
+TEST(ResultIndexTest, IntersectingBoundingBoxes)
+{
+	PseudoRandom rnd(42);
+	Results results;
+	for (int i = 0; i < 300; ++i)
+		results.push_back(RandomResult(rnd));
+
+	std::vector<std::pair<int, int>> expected;
+	for (int i = 0; i < Size(results); ++i)
+		for (int j = i + 1; j < Size(results); ++j)
+			if (HaveIntersectingBoundingBoxes(results[i].position(), results[j].position()))
+				expected.emplace_back(i, j);
+
+	EXPECT_FALSE(expected.empty());
+	EXPECT_EQ(IntersectingBoundingBoxes(results), expected);
+	EXPECT_TRUE(IntersectingBoundingBoxes({}).empty());
+}
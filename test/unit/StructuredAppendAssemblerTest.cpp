@@ -0,0 +1,87 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "StructuredAppendAssembler.h"
+
+#include "DecoderResult.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <utility>
+
+using namespace ZXing;
+
+static Result MakeSequenceResult(const std::string& text, int index, int count, const std::string& id,
+								 BarcodeFormat format = BarcodeFormat::QRCode)
+{
+	Content content;
+	content.symbology = {'Q', '1'};
+	content.reserve(1000); // like a decoder does
+	content.append(text);
+	return Result(DecoderResult(std::move(content)).setStructuredAppend({index, count, id}), {}, format);
+}
+
+TEST(StructuredAppendAssemblerTest, Incremental)
+{
+	StructuredAppendAssembler assembler;
+
+	// two interleaved sequences, symbols repeated as in consecutive frames
+	EXPECT_FALSE(assembler.add(MakeSequenceResult("ab", 1, 2, "a")).isValid());
+	EXPECT_FALSE(assembler.add(MakeSequenceResult("X", 1, 3, "b")).isValid());
+	EXPECT_FALSE(assembler.add(MakeSequenceResult("ab", 1, 2, "a")).isValid());
+	EXPECT_FALSE(assembler.add(MakeSequenceResult("Z", 2, 3, "b")).isValid());
+	EXPECT_EQ(assembler.pendingSequences(), 2);
+	// the same id with a different format or size is a different sequence
+	EXPECT_FALSE(assembler.add(MakeSequenceResult("12", 0, 2, "a", BarcodeFormat::DataMatrix)).isValid());
+	EXPECT_FALSE(assembler.add(MakeSequenceResult("12", 0, 3, "a")).isValid());
+	EXPECT_EQ(assembler.pendingSequences(), 4);
+
+	auto a = assembler.add(MakeSequenceResult("12", 0, 2, "a"));
+	ASSERT_TRUE(a.isValid());
+	EXPECT_EQ(a.text(), "12ab");
+	EXPECT_EQ(a.format(), BarcodeFormat::QRCode);
+	EXPECT_EQ(a.sequenceSize(), 2);
+	EXPECT_EQ(a.sequenceId(), "a");
+	EXPECT_FALSE(a.isPartOfSequence());
+	EXPECT_EQ(assembler.pendingSequences(), 3);
+
+	// the same as merging all symbols at once
+	Results all = {MakeSequenceResult("Y", 0, 3, "b"), MakeSequenceResult("X", 1, 3, "b"), MakeSequenceResult("Z", 2, 3, "b")};
+	auto merged = assembler.add(Results{all[0], MakeSequenceResult("nope", 0, 1, "c")});
+	ASSERT_EQ(merged.size(), 2);
+	EXPECT_EQ(merged[0], MergeStructuredAppendSequence(all));
+	EXPECT_EQ(merged[0].text(), "YXZ");
+	EXPECT_EQ(merged[1].text(), "nope");
+
+	// results without a sequence are ignored
+	EXPECT_FALSE(assembler.add(Result("1234", 0, 0, 10, BarcodeFormat::Code128, {'C', '0'})).isValid());
+	EXPECT_EQ(assembler.pendingSequences(), 2);
+
+	assembler.clear();
+	EXPECT_EQ(assembler.pendingSequences(), 0);
+	EXPECT_EQ(assembler.memoryUsage(), 0);
+}
+
+TEST(StructuredAppendAssemblerTest, MemoryBudget)
+{
+	StructuredAppendAssembler assembler(4000);
+	const std::string payload(500, 'x');
+
+	for (int i = 0; i < 20; ++i) {
+		EXPECT_FALSE(assembler.add(MakeSequenceResult(payload, 0, 2, std::to_string(i))).isValid());
+		// only the compact content counts, not the capacity reserved by the decoder
+		EXPECT_LE(assembler.memoryUsage(), 4000);
+	}
+	EXPECT_GT(assembler.pendingSequences(), 2);
+	EXPECT_LT(assembler.pendingSequences(), 8);
+	EXPECT_EQ(assembler.pendingSequences() + assembler.evictedSequences(), 20);
+
+	// the oldest ones are gone, the most recent ones still complete
+	EXPECT_FALSE(assembler.add(MakeSequenceResult("y", 1, 2, "0")).isValid());
+	auto res = assembler.add(MakeSequenceResult("y", 1, 2, "19"));
+	ASSERT_TRUE(res.isValid());
+	EXPECT_EQ(res.text(), payload + "y");
+}
@@ -4,8 +4,11 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "CharacterSet.h"
+#include "PseudoRandom.h"
 #include "TextDecoder.h"
 #include "Utf.h"
+#include "ZXAlgorithms.h"
+#include "libzueci/zueci.h"
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -91,6 +94,41 @@ TEST(TextDecoderTest, AppendAllASCIIRange00_7F)
 	}
 }
 
+TEST(TextDecoderTest, AppendUTF8SameAsZueci)
+{
+	// Valid UTF-8 is copied straight through, everything else goes through zueci. Both need to agree.
+	const std::vector<std::vector<uint8_t>> pieces = {
+		{'A'}, {'~'}, {0x00}, {0x7F}, {0xC3, 0xA4}, {0xE2, 0x82, 0xAC}, {0xEF, 0xBB, 0xBF}, {0xEF, 0xBF, 0xBE},
+		{0xF0, 0x9F, 0x98, 0x80}, {0xF4, 0x8F, 0xBF, 0xBF},
+		// invalid: stray continuation, overlong forms, surrogate, beyond U+10FFFF, truncated sequences, 0xFF
+		{0x80}, {0xBF}, {0xC0, 0x80}, {0xC1, 0xBF}, {0xE0, 0x80, 0x80}, {0xED, 0xA0, 0x80}, {0xF0, 0x80, 0x80, 0x80},
+		{0xF4, 0x90, 0x80, 0x80}, {0xF5, 0x80, 0x80, 0x80}, {0xC3}, {0xE2, 0x82}, {0xF0, 0x9F, 0x98}, {0xFF},
+	};
+
+	PseudoRandom random(42);
+	for (int i = 0; i < 2000; ++i) {
+		std::vector<uint8_t> data;
+		int numPieces = random.next(0, 40);
+		bool valid = i % 2 == 0; // half of the strings only consist of valid pieces
+		for (int j = 0; j < numPieces; ++j) {
+			auto& piece = pieces[random.next(0, valid ? 9 : Size(pieces) - 1)];
+			data.insert(data.end(), piece.begin(), piece.end());
+		}
+
+		std::string str;
+		TextDecoder::Append(str, data.data(), data.size(), CharacterSet::UTF8);
+
+		int len = 0;
+		zueci_dest_len_utf8(26, data.data(), Size(data), 0xFFFD, ZUECI_FLAG_SB_STRAIGHT_THRU, &len);
+		std::string expected(len, 0);
+		zueci_eci_to_utf8(26, data.data(), Size(data), 0xFFFD, ZUECI_FLAG_SB_STRAIGHT_THRU,
+						  reinterpret_cast<unsigned char*>(expected.data()), &len);
+		expected.resize(len);
+
+		EXPECT_EQ(str, expected) << i;
+	}
+}
+
 TEST(TextDecoderTest, AppendISO8859Range80_9F)
 {
 	uint8_t data[0xA0 - 0x80];
@@ -4,6 +4,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "Utf.h"
+#include "PseudoRandom.h"
 
 #include "gtest/gtest.h"
 #include <vector>
@@ -41,3 +42,46 @@ TEST(TextUtfEncodingTest, FromUtf8)
 //	EXPECT_EQ(FromUtf8("A\xE8G"), L"AG");                   // Bad UTF-8 (missing continuation bytes)
 //	EXPECT_EQ(FromUtf8("A\xED\xA0\x80G"), L"AG");           // Bad UTF-8 (unpaired high surrogate U+D800)
 }
+
+TEST(TextUtfEncodingTest, RoundTrip)
+{
+	// mostly ASCII runs of different lengths, to cover the vectorized paths and their scalar tails
+	PseudoRandom rand(42);
+	for (int len = 0; len < 100; ++len)
+		for (int nonAscii : {0, 1, 4, 50}) {
+			std::u32string cps;
+			for (int i = 0; i < len; ++i) {
+				char32_t cp = rand.next(0, 99) < nonAscii ? rand.next<char32_t>(0x80, 0x10ffff) : rand.next<char32_t>(0, 0x7f);
+				if (cp >= 0xd800 && cp < 0xe000) // no surrogates
+					cp -= 0x800;
+				cps.push_back(cp);
+			}
+
+			std::string utf8;
+			std::wstring wstr;
+			for (char32_t cp : cps) {
+				if (cp < 0x80)
+					utf8 += static_cast<char>(cp);
+				else if (cp < 0x800)
+					utf8 += {static_cast<char>(0xc0 | cp >> 6), static_cast<char>(0x80 | (cp & 0x3f))};
+				else if (cp < 0x10000)
+					utf8 += {static_cast<char>(0xe0 | cp >> 12), static_cast<char>(0x80 | (cp >> 6 & 0x3f)),
+							 static_cast<char>(0x80 | (cp & 0x3f))};
+				else
+					utf8 += {static_cast<char>(0xf0 | cp >> 18), static_cast<char>(0x80 | (cp >> 12 & 0x3f)),
+							 static_cast<char>(0x80 | (cp >> 6 & 0x3f)), static_cast<char>(0x80 | (cp & 0x3f))};
+
+				if (sizeof(wchar_t) == 2 && cp > 0xffff)
+					wstr += {static_cast<wchar_t>(0xd7c0 + (cp >> 10)), static_cast<wchar_t>(0xdc00 + (cp & 0x3ff))};
+				else
+					wstr += static_cast<wchar_t>(cp);
+			}
+
+			EXPECT_EQ(ToUtf8(wstr), utf8);
+			EXPECT_EQ(FromUtf8(utf8), wstr);
+		}
+
+	// invalid UTF-8 after a long ASCII run
+	EXPECT_EQ(FromUtf8(std::string(20, 'a') + "\xE8G").substr(0, 20), std::wstring(20, L'a'));
+	EXPECT_EQ(FromUtf8(std::string(20, 'a') + "\x80" + std::string(20, 'b')).substr(0, 20), std::wstring(20, L'a'));
+}
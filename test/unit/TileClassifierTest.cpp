@@ -0,0 +1,106 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TileClassifier.h"
+
+#include "BitMatrix.h"
+#include "MultiFormatWriter.h"
+#include "ReadBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+using namespace ZXing;
+
+namespace {
+
+// a white width x height image with the symbol in the center, rotated by deg degrees
+BitMatrix Render(BarcodeFormat format, const std::string& text, int w, int h, double deg, int width = 640, int height = 640)
+{
+	auto bits = MultiFormatWriter(format).setMargin(0).encode(text, w, h);
+	BitMatrix res(width, height);
+	double c = std::cos(deg * 3.14159265358979 / 180), s = std::sin(deg * 3.14159265358979 / 180);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x) {
+			double u = c * (x - width / 2) + s * (y - height / 2) + bits.width() / 2.0;
+			double v = -s * (x - width / 2) + c * (y - height / 2) + bits.height() / 2.0;
+			if (u >= 0 && v >= 0 && u < bits.width() && v < bits.height() && bits.get(int(u), int(v)))
+				res.set(x, y);
+		}
+	return res;
+}
+
+int Count(const Matrix<TileClass>& tiles, TileClass c)
+{
+	return static_cast<int>(std::count(tiles.begin(), tiles.end(), c));
+}
+
+void Paste(BitMatrix& dst, const BitMatrix& src, int left, int top)
+{
+	for (int y = 0; y < src.height(); ++y)
+		for (int x = 0; x < src.width(); ++x)
+			dst.set(left + x, top + y, src.get(x, y));
+}
+
+} // namespace
+
+TEST(TileClassifierTest, Empty)
+{
+	auto tiles = ClassifyTiles(BitMatrix(100, 70));
+	EXPECT_EQ(tiles.width(), 4);
+	EXPECT_EQ(tiles.height(), 3);
+	EXPECT_EQ(Count(tiles, TileClass::Empty), 12);
+	EXPECT_EQ(TileClassMask(tiles), 1 << int(TileClass::Empty));
+}
+
+TEST(TileClassifierTest, Linear)
+{
+	for (double deg : {0., 11., 22.5, 45., 90.}) {
+		auto tiles = ClassifyTiles(Render(BarcodeFormat::Code128, "ZXing 1234567890", 400, 150, deg));
+		int bars = Count(tiles, TileClass::Linear) + Count(tiles, TileClass::Stacked);
+		EXPECT_GT(bars, 40) << deg;
+		EXPECT_GT(bars, 4 * Count(tiles, TileClass::Matrix)) << deg;
+	}
+}
+
+TEST(TileClassifierTest, Matrix)
+{
+	// with modules of more than about a quarter of the tile size, more and more tiles see only a single straight edge
+	auto bars = [](const Matrix<TileClass>& tiles) { return Count(tiles, TileClass::Linear) + Count(tiles, TileClass::Stacked); };
+	for (double deg : {0., 11., 22.5, 45.}) {
+		auto tiles = ClassifyTiles(Render(BarcodeFormat::QRCode, "https://github.com/zxing-cpp/zxing-cpp", 200, 200, deg));
+		EXPECT_GT(Count(tiles, TileClass::Matrix), 2 * bars(tiles)) << deg;
+
+		tiles = ClassifyTiles(Render(BarcodeFormat::DataMatrix, "ZXing DataMatrix 0123456789", 160, 160, deg));
+		EXPECT_GT(Count(tiles, TileClass::Matrix), 2 * bars(tiles)) << deg;
+	}
+}
+
+TEST(TileClassifierTest, PreClassify)
+{
+	// a linear and a matrix symbol side by side, read with and without pre-classification
+	BitMatrix image(800, 400);
+	Paste(image, Render(BarcodeFormat::EAN13, "4006381333931", 300, 100, 0, 400, 200), 0, 100);
+	Paste(image, Render(BarcodeFormat::QRCode, "ZXing", 200, 200, 0, 300, 300), 450, 50);
+	auto lum = ToMatrix<uint8_t>(image);
+	ImageView iv(lum.data(), lum.width(), lum.height(), ImageFormat::Lum);
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::EAN13 | BarcodeFormat::QRCode | BarcodeFormat::DataMatrix);
+	auto expected = ReadBarcodes(iv, hints);
+	auto results = ReadBarcodes(iv, hints.setPreClassify(true));
+	ASSERT_EQ(expected.size(), 2);
+	ASSERT_EQ(results.size(), expected.size());
+	for (size_t i = 0; i < results.size(); ++i) {
+		EXPECT_EQ(results[i].format(), expected[i].format());
+		EXPECT_EQ(results[i].text(), expected[i].text());
+	}
+
+	// nothing but bars: the matrix readers are skipped, the linear one still finds its symbol
+	lum = ToMatrix<uint8_t>(Render(BarcodeFormat::EAN13, "4006381333931", 300, 100, 0, 400, 200));
+	results = ReadBarcodes({lum.data(), lum.width(), lum.height(), ImageFormat::Lum}, hints);
+	ASSERT_EQ(results.size(), 1);
+	EXPECT_EQ(results.front().text(), "4006381333931");
+}
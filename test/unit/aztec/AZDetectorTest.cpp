@@ -12,6 +12,7 @@
 #include "Utf.h"
 #include "aztec/AZDecoder.h"
 #include "aztec/AZDetectorResult.h"
+#include "aztec/AZEncoder.h"
 
 #include "gtest/gtest.h"
 #include <string_view>
@@ -187,6 +188,39 @@ TEST(AZDetectorTest, ErrorInOrientationBitsNotCompact)
 	);
 }
 
+TEST(AZDetectorTest, ErrorInModeMessage)
+{
+	// every 1- and 2-bit error in the mode message of compact and full symbols, with 1 and 3 pixels per module
+	const std::string data = "AZTEC";
+	for (int layers : {-1, -4, 1, 5}) {
+		auto enc = Aztec::Encoder::Encode(data, Aztec::Encoder::DEFAULT_EC_PERCENT, layers);
+		int center = enc.matrix.width() / 2;
+		int radius = enc.compact ? 5 : 7;
+		std::vector<Point> modeMessagePoints;
+		for (int k = 2 - radius; k <= radius - 2; ++k)
+			if (enc.compact || k != 0)
+				for (auto p : {Point{k, -radius}, {radius, k}, {k, radius}, {-radius, k}})
+					modeMessagePoints.push_back({center + p.x, center + p.y});
+		ASSERT_EQ(Size(modeMessagePoints), enc.compact ? 28 : 40);
+
+		for (int error1 = 0; error1 < Size(modeMessagePoints); error1++) {
+			for (int error2 = error1; error2 < Size(modeMessagePoints); error2++) {
+				BitMatrix copy = enc.matrix.copy();
+				copy.flip(modeMessagePoints[error1].x, modeMessagePoints[error1].y);
+				if (error2 > error1)
+					copy.flip(modeMessagePoints[error2].x, modeMessagePoints[error2].y);
+				for (int scale : {1, 3}) {
+					auto r = Aztec::Detect(Inflate(copy.copy(), copy.width() * scale, copy.height() * scale, 2 * scale), true, false);
+					ASSERT_TRUE(r.isValid());
+					EXPECT_EQ(r.nbLayers(), enc.layers);
+					EXPECT_EQ(r.isCompact(), enc.compact);
+					EXPECT_EQ(data, ToUtf8(Aztec::Decode(r).text()));
+				}
+			}
+		}
+	}
+}
+
 TEST(AZDetectorTest, ReaderInitFull2Layers)
 {
 	{
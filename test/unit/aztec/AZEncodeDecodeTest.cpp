@@ -9,12 +9,14 @@
 #include "DecoderResult.h"
 #include "PseudoRandom.h"
 #include "TextEncoder.h"
+#include "aztec/AZBitLayout.h"
 #include "aztec/AZDecoder.h"
 #include "aztec/AZDetectorResult.h"
 #include "aztec/AZEncoder.h"
 #include "aztec/AZWriter.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <utility>
 
 namespace testing {
@@ -228,3 +230,31 @@ TEST(AZEncodeDecodeTest, AztecWriter)
 							   Aztec::Encoder::DEFAULT_EC_PERCENT, Aztec::Encoder::DEFAULT_AZTEC_LAYERS);
 	EXPECT_EQ(matrix, aztec.matrix);
 }
+
+TEST(AZEncodeDecodeTest, BitLayout)
+{
+	for (bool compact : {true, false})
+		for (int layers = 1; layers <= (compact ? 4 : 32); ++layers) {
+			const auto& layout = Aztec::BitLayout(compact, layers);
+			ASSERT_EQ(Size(layout), Aztec::TotalBitsInLayer(layers, compact));
+
+			int baseMatrixSize = (compact ? 11 : 14) + layers * 4;
+			int matrixSize = compact ? baseMatrixSize : baseMatrixSize + 1 + 2 * ((baseMatrixSize / 2 - 1) / 15);
+			int center = matrixSize / 2;
+			BitMatrix used(matrixSize);
+			for (auto [x, y] : layout) {
+				ASSERT_TRUE(x < matrixSize && y < matrixSize);
+				ASSERT_FALSE(used.get(x, y)) << "duplicate " << int(x) << "x" << int(y);
+				used.set(x, y);
+				// outside of the bullseye + mode message and not on an alignment line
+				EXPECT_GT(std::max(std::abs(x - center), std::abs(y - center)), compact ? 5 : 7);
+				if (!compact) {
+					EXPECT_NE(std::abs(x - center) % 16, 0);
+					EXPECT_NE(std::abs(y - center) % 16, 0);
+				}
+			}
+		}
+
+	EXPECT_TRUE(Aztec::BitLayout(true, 5).empty());
+	EXPECT_TRUE(Aztec::BitLayout(false, 0).empty());
+}
@@ -0,0 +1,76 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "aztec/AZReader.h"
+
+#include "BitMatrix.h"
+#include "DecodeHints.h"
+#include "Executor.h"
+#include "Result.h"
+#include "ThresholdBinarizer.h"
+#include "aztec/AZWriter.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+
+static std::vector<std::string> TextsAndPositions(const Results& results)
+{
+	std::vector<std::string> res;
+	for (auto& r : results)
+		res.push_back(r.text() + "@" + std::to_string(r.position()[0].x) + "x" + std::to_string(r.position()[0].y));
+	return res;
+}
+
+TEST(AZReaderTest, ManySymbols)
+{
+	// a sheet of boarding passes, every other one with a bullseye but a broken mode message
+	const int cols = 6, rows = 4, scale = 4, size = 23 * scale, gap = 30;
+	Matrix<uint8_t> img(cols * (size + gap) + gap, rows * (size + gap) + gap, 0xff);
+	for (int r = 0; r < rows; ++r)
+		for (int c = 0; c < cols; ++c) {
+			auto m = Aztec::Writer().encode("boarding pass " + std::to_string(r * cols + c), 0, 0);
+			const int center = m.width() / 2;
+			const bool broken = (r + c) % 2;
+			for (int y = 0; y < m.height(); ++y)
+				for (int x = 0; x < m.width(); ++x) {
+					// invert the ring of orientation marks and mode message bits around the bullseye
+					bool set = m.get(x, y) != (broken && std::max(std::abs(x - center), std::abs(y - center)) == 5);
+					for (int dy = 0; dy < scale; ++dy)
+						for (int dx = 0; dx < scale; ++dx)
+							img.set(gap + c * (size + gap) + x * scale + dx, gap + r * (size + gap) + y * scale + dy,
+									set ? 0 : 0xff);
+				}
+		}
+	ImageView iv(img.data(), img.width(), img.height(), ImageFormat::Lum);
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::Aztec);
+	Aztec::Reader reader(hints);
+
+	ThresholdBinarizer serialBitmap(iv);
+	auto serial = TextsAndPositions(reader.decode(serialBitmap, 0));
+	ASSERT_EQ(Size(serial), cols * rows / 2);
+	for (auto& s : serial) {
+		int i = std::stoi(s.substr(14));
+		EXPECT_EQ((i / cols + i % cols) % 2, 0) << s;
+	}
+
+	// no symbol lost because of the broken ones in front of it
+	EXPECT_EQ(TextsAndPositions(reader.decode(serialBitmap, 5)), std::vector<std::string>(serial.begin(), serial.begin() + 5));
+
+	for (int threads : {2, 3, 8}) {
+		ThreadExecutor executor(threads);
+		ThresholdBinarizer bitmap(iv);
+		bitmap.setExecutor(&executor);
+		EXPECT_EQ(TextsAndPositions(reader.decode(bitmap, 0)), serial) << threads;
+		EXPECT_EQ(TextsAndPositions(reader.decode(bitmap, 5)), std::vector<std::string>(serial.begin(), serial.begin() + 5))
+			<< threads;
+	}
+}
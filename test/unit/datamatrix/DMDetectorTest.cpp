@@ -0,0 +1,103 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "datamatrix/DMDetector.h"
+#include "datamatrix/DMWriter.h"
+#include "BitMatrix.h"
+#include "DetectorResult.h"
+#include "Executor.h"
+
+#include "gtest/gtest.h"
+
+using namespace ZXing;
+using namespace ZXing::DataMatrix;
+
+static void Paste(BitMatrix& image, const BitMatrix& symbol, int left, int top)
+{
+	for (int y = 0; y < symbol.height(); ++y)
+		for (int x = 0; x < symbol.width(); ++x)
+			image.set(left + x, top + y, symbol.get(x, y));
+}
+
+TEST(DMDetectorTest, MultipleOffCenterSymbols)
+{
+	Writer writer;
+	writer.setMargin(0);
+	BitMatrix image(400, 300);
+	Paste(image, writer.encode(L"first", 60, 60), 40, 30);
+	Paste(image, writer.encode(L"second", 60, 60), 280, 200);
+
+	std::vector<PointI> found;
+	for (auto&& res : Detect(image, true, true, false))
+		found.push_back(res.position().topLeft());
+
+	ASSERT_EQ(found.size(), 2);
+	EXPECT_EQ(found[0], PointI(40, 30));
+	EXPECT_EQ(found[1], PointI(280, 200));
+
+	// without tryHarder, only the lines through the center are scanned
+	int count = 0;
+	for (auto&& res : Detect(image, false, true, false))
+		count += res.isValid();
+	EXPECT_EQ(count, 0);
+}
+
+TEST(DMDetectorTest, ResumableScan)
+{
+	Writer writer;
+	writer.setMargin(0);
+	BitMatrix image(400, 300);
+	Paste(image, writer.encode(L"first", 60, 60), 40, 30);
+	Paste(image, writer.encode(L"second", 60, 60), 280, 200);
+
+	auto results = Detect(image, true, true, false);
+	auto i = results.begin();
+	ASSERT_TRUE(i != results.end());
+	EXPECT_EQ((*i).position().topLeft(), PointI(40, 30));
+	++i;
+	ASSERT_TRUE(i != results.end());
+	EXPECT_EQ((*i).position().topLeft(), PointI(280, 200));
+	++i;
+	EXPECT_FALSE(i != results.end());
+}
+
+TEST(DMDetectorTest, ParallelMatchesSequential)
+{
+	Writer writer;
+	writer.setMargin(0);
+	BitMatrix image(600, 400);
+	for (int i = 0; i < 6; ++i)
+		Paste(image, writer.encode(L"tray " + std::to_wstring(i), 60, 60), 40 + (i % 3) * 200, 40 + (i / 3) * 200);
+
+	std::vector<QuadrilateralI> sequential, parallel;
+	for (auto&& res : Detect(image, true, true, false))
+		sequential.push_back(res.position());
+
+	ThreadExecutor executor(4);
+	for (auto&& res : Detect(image, true, true, false, Deadline::max(), &executor))
+		parallel.push_back(res.position());
+
+	EXPECT_GE(sequential.size(), 6);
+	EXPECT_EQ(parallel, sequential);
+}
+
+TEST(DMDetectorTest, RepeatedScansOfDifferentSizes)
+{
+	// the tracer history is recycled between calls, make sure nothing of a previous scan leaks into the next one
+	Writer writer;
+	writer.setMargin(0);
+	auto symbol = writer.encode(L"repeat", 60, 60);
+
+	for (int i = 0; i < 6; ++i) {
+		BitMatrix image(i % 2 ? 400 : 250, 300);
+		Paste(image, symbol, 30, 40);
+		int count = 0;
+		for (auto&& res : Detect(image, true, true, false)) {
+			EXPECT_EQ(res.position().topLeft(), PointI(30, 40));
+			++count;
+		}
+		EXPECT_GE(count, 1);
+	}
+}
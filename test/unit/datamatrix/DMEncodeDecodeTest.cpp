@@ -20,9 +20,11 @@ using namespace ZXing;
 
 namespace {
 
-	void TestEncodeDecode(const std::wstring& data, DataMatrix::SymbolShape shape = DataMatrix::SymbolShape::NONE)
+	void TestEncodeDecode(const std::wstring& data, DataMatrix::SymbolShape shape = DataMatrix::SymbolShape::NONE,
+						  bool minimal = false)
 	{
-		BitMatrix matrix = DataMatrix::Writer().setMargin(0).setShapeHint(shape).encode(data, 0, 0);
+		BitMatrix matrix =
+			DataMatrix::Writer().setMargin(0).setShapeHint(shape).setMinimalEncoding(minimal).encode(data, 0, 0);
 		ASSERT_EQ(matrix.empty(), false);
 
 		DecoderResult res = DataMatrix::Decode(matrix);
@@ -112,3 +114,21 @@ TEST(DMEncodeDecodeTest, EDIFACTWithEOD)
 			TestEncodeDecode(data, shape);
 }
 
+TEST(DMEncodeDecodeTest, EncodeDecodeMinimal)
+{
+	using namespace DataMatrix;
+	std::wstring text[] = {
+		L"Abc123!",
+		L"A1b2C3d4A1b2C3d4A1b2C3d4",
+		L"3i0QnD^RcZO[\\#!]1,9zIJ{1z3qrvsq",
+		L"https://test~[******]_",
+		L"*CH/GN1/022/00",
+		L"http://test/~!@#*^%&)__ ;:'\"[]{}\\|-+-=`1029384",
+		L"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ",
+	};
+
+	for (auto& data : text)
+		for (size_t len = 1; len <= data.size(); ++len)
+			for (auto shape : {SymbolShape::NONE, SymbolShape::SQUARE, SymbolShape::RECTANGLE})
+				TestEncodeDecode(data.substr(0, len), shape, true);
+}
@@ -352,6 +352,28 @@ TEST(DMHighLevelEncodeTest, EDIFACTWithEODBug)
 	EXPECT_EQ(visualized, "98 99 100 240 242 223 129 8 49 5 129 147");
 }
 
+TEST(DMHighLevelEncodeTest, MinimalEncoding)
+{
+	auto encode = [](const std::wstring& text, bool minimal,
+					 DataMatrix::SymbolShape shape = DataMatrix::SymbolShape::NONE) {
+		return minimal ? DataMatrix::EncodeMinimal(text, CharacterSet::ISO8859_1, shape, -1, -1, -1, -1)
+					   : DataMatrix::Encode(text, CharacterSet::ISO8859_1, shape, -1, -1, -1, -1);
+	};
+
+	// mixed digit pairs and lower case letters, annex P stays in ASCII
+	EXPECT_EQ(Size(encode(L"A1b2C3d4A1b2C3d4A1b2C3d4", false)), 30);
+	EXPECT_EQ(Size(encode(L"A1b2C3d4A1b2C3d4A1b2C3d4", true)), 22);
+	EXPECT_EQ(Size(encode(L"http://www.example.com/ABC?DEF=123", false)), 32);
+	EXPECT_EQ(Size(encode(L"http://www.example.com/ABC?DEF=123", true)), 30);
+
+	// the minimal encoding never needs a larger symbol
+	std::wstring texts[] = {L"fiykmj*Rh2`,e6", L"AIMAIMAIM\xCB", L"ABC>ABC123>AB", L"CREX-TAN:hFORM:-60", L"*MEMANT-1F-MESTECH",
+							L"abc<->ABCDE", L"Hello World!", L"[)>\x1E""05\x1D""5555\x1C""6666\x1E\x04", CreateBinaryMessage(20)};
+	for (auto& text : texts)
+		for (auto shape : {DataMatrix::SymbolShape::NONE, DataMatrix::SymbolShape::SQUARE, DataMatrix::SymbolShape::RECTANGLE})
+			EXPECT_LE(Size(encode(text, true, shape)), Size(encode(text, false, shape))) << text.size();
+}
+
 //  @Ignore
 //  @Test  
 //  public void testDataURL() {
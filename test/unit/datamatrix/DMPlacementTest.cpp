@@ -7,6 +7,7 @@
 #include "BitMatrixIO.h"
 #include "ByteArray.h"
 #include "datamatrix/DMBitLayout.h"
+#include "datamatrix/DMVersion.h"
 
 #include "gtest/gtest.h"
 #include <algorithm>
@@ -45,3 +46,32 @@ TEST(DMPlacementTest, Placement)
 			"001011001010\n";
 		EXPECT_EQ(expected, ToString(matrix, '1', '0', false));
 }
+
+TEST(DMPlacementTest, RoundTripAllVersions)
+{
+	int numVersions = 0;
+	for (int height = 8; height <= 144; height += 2)
+		for (int width = 8; width <= 144; width += 2) {
+			auto version = VersionForDimensions(height, width);
+			if (!version)
+				continue;
+			++numVersions;
+
+			ByteArray codewords(version->totalCodewords());
+			for (int i = 0; i < Size(codewords); ++i)
+				codewords[i] = narrow_cast<uint8_t>(i * 37 + height + width);
+
+			auto data = BitMatrixFromCodewords(codewords, version->dataWidth(), version->dataHeight());
+			ASSERT_EQ(data.width(), version->dataWidth());
+
+			// embed the mapping matrix into a symbol (the alignment patterns themselves are irrelevant here)
+			BitMatrix symbol(width, height);
+			for (int y = 0; y < data.height(); ++y)
+				for (int x = 0; x < data.width(); ++x)
+					symbol.set(x + 1 + (x / version->dataBlockWidth) * 2, y + 1 + (y / version->dataBlockHeight) * 2,
+							   data.get(x, y));
+
+			EXPECT_EQ(CodewordsFromBitMatrix(symbol, *version), codewords) << width << "x" << height;
+		}
+	EXPECT_EQ(numVersions, 48);
+}
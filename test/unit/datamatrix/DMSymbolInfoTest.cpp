@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "datamatrix/DMSymbolInfo.h"
+#include "datamatrix/DMVersion.h"
 
 #include "gtest/gtest.h"
 
@@ -80,3 +81,28 @@ TEST(DMSymbolInfoTest, SymbolInfo)
 	info = SymbolInfo::Lookup(63, SymbolShape::NONE, minWidth, minHeight, maxWidth, maxHeight);
 	EXPECT_EQ(nullptr, info);
 }
+
+TEST(DMSymbolInfoTest, LookupAll)
+{
+	for (auto shape : {SymbolShape::NONE, SymbolShape::SQUARE, SymbolShape::RECTANGLE}) {
+		const SymbolInfo* prev = SymbolInfo::Lookup(1, shape);
+		for (int n = 1; n <= 1559; ++n) {
+			auto info = SymbolInfo::Lookup(n, shape);
+			// the smallest symbol of the shape with enough capacity
+			if (prev && prev->dataCapacity() >= n)
+				EXPECT_EQ(info, prev) << n;
+			if (!info)
+				continue;
+			EXPECT_GE(info->dataCapacity(), n);
+			if (shape != SymbolShape::NONE)
+				EXPECT_EQ(info->isRectangular(), shape == SymbolShape::RECTANGLE);
+			EXPECT_EQ(info, SymbolInfo::Lookup(n, shape, 0, 0, 144, 144));
+
+			auto version = VersionForDimensions(info->symbolHeight(), info->symbolWidth());
+			ASSERT_NE(version, nullptr) << n;
+			EXPECT_EQ(version->totalCodewords(), info->codewordCount());
+			prev = info;
+		}
+		EXPECT_EQ(SymbolInfo::Lookup(1559, shape), nullptr);
+	}
+}
@@ -0,0 +1,143 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "maxicode/MCReader.h"
+
+#include "BitMatrix.h"
+#include "ByteArray.h"
+#include "DecodeHints.h"
+#include "GenericGF.h"
+#include "Matrix.h"
+#include "ReedSolomonEncoder.h"
+#include "Result.h"
+#include "ThresholdBinarizer.h"
+#include "maxicode/MCBitMatrixParser.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+using MaxiCode::BitMatrixParser;
+
+// Builds the module matrix of a mode 4 symbol containing text (upper case letters, digits and spaces only)
+static BitMatrix Symbol(const std::string& text)
+{
+	std::vector<int> codewords(144, 33); // PAD
+	codewords[0] = 4;
+	for (int i = 0; i < Size(text); ++i) {
+		char c = text[i];
+		codewords[i < 9 ? 1 + i : 20 + i - 9] = c == ' ' ? 32 : c >= 'A' ? c - 'A' + 1 : c;
+	}
+
+	std::vector<int> primary(codewords.begin(), codewords.begin() + 20);
+	ReedSolomonEncode(GenericGF::MaxiCodeField64(), primary, 10);
+	std::copy(primary.begin(), primary.end(), codewords.begin());
+	for (int odd = 0; odd < 2; ++odd) {
+		std::vector<int> secondary;
+		for (int i = odd; i < 124; i += 2)
+			secondary.push_back(codewords[20 + i]);
+		ReedSolomonEncode(GenericGF::MaxiCodeField64(), secondary, 20);
+		for (int i = odd; i < 124; i += 2)
+			codewords[20 + i] = secondary[i / 2];
+	}
+
+	// find the codeword bit stored in each module by reading single module matrices
+	BitMatrix res(BitMatrixParser::MATRIX_WIDTH, BitMatrixParser::MATRIX_HEIGHT);
+	for (int y = 0; y < res.height(); ++y)
+		for (int x = 0; x < res.width(); ++x) {
+			BitMatrix probe(res.width(), res.height());
+			probe.set(x, y);
+			auto bytes = BitMatrixParser::ReadCodewords(probe);
+			for (int i = 0; i < Size(bytes); ++i)
+				if (bytes[i] && (codewords[i] & bytes[i]))
+					res.set(x, y);
+		}
+
+	// the dark orientation modules
+	for (auto [x, y] : {PointI{17, 9}, {17, 10}, {18, 10}, {7, 16}, {21, 16}, {11, 22}, {16, 23}})
+		res.set(x, y);
+
+	return res;
+}
+
+// Draws the symbol with hexagonal modules of the given pitch (in pixels) around center, rotated by angle (in degrees)
+// and compressed horizontally by squeeze (as if viewed at an angle)
+static void Draw(Matrix<uint8_t>& img, const BitMatrix& symbol, PointF center, double pitch, double angle, double squeeze = 1)
+{
+	const double rowPitch = std::sqrt(3.) / 2;
+	// ISO/IEC 16023:2000 Figure 5 bullseye ring radii for a module pitch of 0.88 mm
+	const double radii[] = {0.51, 1.18, 1.86, 2.53, 3.20, 3.87};
+	const double a = angle * 3.14159265358979 / 180;
+	for (int py = 0; py < img.height(); ++py)
+		for (int px = 0; px < img.width(); ++px) {
+			double dx = (px + 0.5 - center.x) / squeeze, dy = py + 0.5 - center.y;
+			double u = (std::cos(a) * dx + std::sin(a) * dy) / pitch;
+			double v = (-std::sin(a) * dx + std::cos(a) * dy) / pitch;
+			double r = std::sqrt(u * u + v * v) * 0.88;
+			bool black = false;
+			if (r < radii[5]) {
+				black = (std::upper_bound(std::begin(radii), std::end(radii), r) - std::begin(radii)) % 2;
+			} else {
+				// the module with the nearest center, i.e. the honeycomb of hexagonal modules
+				double best = 1e9;
+				for (int y = int(std::floor(v / rowPitch)) + 16; y <= int(std::ceil(v / rowPitch)) + 16; ++y) {
+					int x = int(std::round(u + 14 - (y & 1) * 0.5));
+					double d = std::hypot(u - (x - 14 + (y & 1) * 0.5), v - (y - 16) * rowPitch);
+					if (d < best && x >= 0 && x < symbol.width() && y >= 0 && y < symbol.height()) {
+						best = d;
+						black = symbol.get(x, y);
+					}
+				}
+				black &= best < 0.6;
+			}
+			if (black)
+				img.set(px, py, 0);
+		}
+}
+
+static std::vector<std::string> Texts(const Results& results)
+{
+	std::vector<std::string> res;
+	for (auto& r : results)
+		res.push_back(r.text());
+	return res;
+}
+
+TEST(MCReaderTest, RotatedAndScaled)
+{
+	auto hints = DecodeHints().setFormats(BarcodeFormat::MaxiCode);
+	MaxiCode::Reader reader(hints);
+	auto symbol = Symbol("PARCEL 0815 ROTATED");
+
+	for (double pitch : {5.5, 9.})
+		for (double angle : {0., 17., 90., 135., 222., 301.})
+			for (double squeeze : {1., 0.8}) {
+				Matrix<uint8_t> img(int(45 * pitch), int(45 * pitch), 0xff);
+				Draw(img, symbol, {img.width() / 2.3, img.height() / 1.8}, pitch, angle, squeeze);
+				ThresholdBinarizer bitmap(ImageView(img.data(), img.width(), img.height(), ImageFormat::Lum));
+				auto res = reader.decode(bitmap);
+				EXPECT_TRUE(res.isValid()) << pitch << " " << angle << " " << squeeze;
+				EXPECT_EQ(res.text(), "PARCEL 0815 ROTATED") << pitch << " " << angle << " " << squeeze;
+				EXPECT_TRUE(IsInside(PointI(img.width() / 2.3, img.height() / 1.8), res.position()));
+			}
+}
+
+TEST(MCReaderTest, ManySymbols)
+{
+	auto hints = DecodeHints().setFormats(BarcodeFormat::MaxiCode);
+	MaxiCode::Reader reader(hints);
+
+	Matrix<uint8_t> img(760, 400, 0xff);
+	Draw(img, Symbol("FIRST"), {190, 180}, 6, 10);
+	Draw(img, Symbol("SECOND"), {560, 220}, 5.5, 250);
+
+	ThresholdBinarizer bitmap(ImageView(img.data(), img.width(), img.height(), ImageFormat::Lum));
+	EXPECT_EQ(Texts(reader.decode(bitmap, 0)), (std::vector<std::string>{"FIRST", "SECOND"}));
+	EXPECT_EQ(Texts(reader.decode(bitmap, 1)), (std::vector<std::string>{"FIRST"}));
+}
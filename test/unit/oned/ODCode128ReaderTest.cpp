@@ -5,6 +5,8 @@
 
 #include "oned/ODCode128Reader.h"
 
+#include "oned/ODCode128Patterns.h"
+
 #include "DecodeHints.h"
 #include "Result.h"
 
@@ -109,3 +111,23 @@ TEST(ODCode128ReaderTest, ReaderInit)
 		EXPECT_EQ(result.text(), "92");
 	}
 }
+
+TEST(ODCode128ReaderTest, AllCodeSetCValues)
+{
+	// every code value 0..99 followed by its checksum, scaled to 3 pixels per module
+	for (int code = 0; code < 100; ++code) {
+		PatternRow row = {30};
+		for (int c : {105, code, (105 + code) % 103, 106})
+			for (int w : Code128::CODE_PATTERNS[c])
+				row.push_back(narrow_cast<PatternType>(3 * w));
+		row.insert(row.end(), {3 * 2, 30}); // termination bar of the stop pattern and quiet zone
+
+		std::unique_ptr<Code128Reader::DecodingState> state;
+		DecodeHints hints;
+		Code128Reader reader(hints);
+		PatternView next(row);
+		auto result = reader.decodePattern(0, next, state);
+		EXPECT_TRUE(result.isValid()) << code;
+		EXPECT_EQ(result.text(), std::to_string(100 + code).substr(1)) << code;
+	}
+}
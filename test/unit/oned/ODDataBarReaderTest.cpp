@@ -36,3 +36,29 @@ TEST(ODDataBarReaderTest, Composite)
 		EXPECT_EQ(result.text(), "01234567890128");
 	}
 }
+
+TEST(ODDataBarReaderTest, Stacked)
+{
+	// the Composite symbol from above split into its left and right half on two rows, like with DataBar Stacked
+	PatternRow left = { 1, 1, 2, 3, 1, 2, 1, 2, 4, 1, 3, 3, 7, 1, 1, 3, 1, 2, 1, 1, 1, 4, 2, 1, 1 };
+	PatternRow right = { 1, 1, 1, 4, 1, 1, 2, 3, 1, 1, 2, 1, 1, 2, 8, 3, 3, 2, 2, 1, 4, 1, 1, 2, 1, 1 };
+	PatternRow noise = { 1, 1, 1, 2, 3, 1, 1, 4, 2, 1, 1, 1 };
+
+	DecodeHints hints;
+	DataBarReader reader(hints);
+	std::unique_ptr<RowReader::DecodingState> state;
+
+	auto decode = [&](int rowNumber, const PatternRow& row) {
+		PatternView next(row);
+		return reader.decodePattern(rowNumber, next, state);
+	};
+
+	EXPECT_FALSE(decode(0, left).isValid());
+	EXPECT_FALSE(decode(1, noise).isValid());
+	Result result = decode(2, right);
+	EXPECT_TRUE(result.isValid());
+	EXPECT_EQ(result.text(), "01234567890128");
+
+	// both halves have been combined already
+	EXPECT_FALSE(decode(3, right).isValid());
+}
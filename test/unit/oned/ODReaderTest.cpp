@@ -0,0 +1,105 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "oned/ODReader.h"
+
+#include "BitMatrix.h"
+#include "DecodeHints.h"
+#include "Executor.h"
+#include "MultiFormatWriter.h"
+#include "Result.h"
+#include "ThresholdBinarizer.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+
+static std::vector<std::string> Texts(const Results& results)
+{
+	std::vector<std::string> res;
+	for (auto& r : results)
+		res.push_back(ToString(r.format()) + ":" + r.text());
+	std::sort(res.begin(), res.end());
+	return res;
+}
+
+TEST(ODReaderTest, ParallelRowsMatchSerial)
+{
+	// three symbols stacked on top of each other, so that they end up in different bands
+	const int width = 400, height = 900;
+	Matrix<uint8_t> img(width, height, 0xff);
+	auto paste = [&](BarcodeFormat format, const std::string& text, int y0) {
+		auto m = ToMatrix<uint8_t>(MultiFormatWriter(format).setMargin(0).encode(text, 300, 120));
+		for (int y = 0; y < m.height(); ++y)
+			for (int x = 0; x < m.width(); ++x)
+				img.set(50 + x, y0 + y, m(x, y));
+	};
+	paste(BarcodeFormat::EAN13, "123456789012", 50);
+	paste(BarcodeFormat::Code128, "parallel", 390);
+	paste(BarcodeFormat::Code39, "ROWS", 730);
+	ImageView iv(img.data(), width, height, ImageFormat::Lum);
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::LinearCodes).setTryHarder(true);
+	OneD::Reader reader(hints);
+
+	ThresholdBinarizer serialBitmap(iv);
+	auto serial = Texts(reader.decode(serialBitmap, 0));
+	ASSERT_EQ(serial, (std::vector<std::string>{"Code128:parallel", "Code39:ROWS", "EAN-13:1234567890128"}));
+
+	for (int threads : {2, 3, 8}) {
+		ThreadExecutor executor(threads);
+		ThresholdBinarizer bitmap(iv);
+		bitmap.setExecutor(&executor);
+		EXPECT_EQ(Texts(reader.decode(bitmap, 0)), serial) << threads;
+		EXPECT_TRUE(reader.decode(bitmap).isValid()) << threads;
+		EXPECT_EQ(reader.decode(bitmap, 2).size(), 2) << threads;
+	}
+}
+
+TEST(ODReaderTest, SmallSymbolInTallImage)
+{
+	// the symbol covers only about 5% of the height, far away from the middle
+	const int width = 300, height = 2000;
+	Matrix<uint8_t> img(width, height, 0xff);
+	auto m = ToMatrix<uint8_t>(MultiFormatWriter(BarcodeFormat::Code128).setMargin(0).encode("conveyor", 250, 100));
+	for (int y = 0; y < m.height(); ++y)
+		for (int x = 0; x < m.width(); ++x)
+			img.set(25 + x, 1750 + y, m(x, y));
+	ImageView iv(img.data(), width, height, ImageFormat::Lum);
+
+	for (int minLineCount : {1, 2, 4}) {
+		auto hints = DecodeHints().setFormats(BarcodeFormat::Code128).setTryHarder(true).setMinLineCount(minLineCount);
+		OneD::Reader reader(hints);
+		ThresholdBinarizer bitmap(iv);
+		auto result = reader.decode(bitmap);
+		EXPECT_EQ(result.text(), "conveyor") << minLineCount;
+		EXPECT_GE(result.lineCount(), minLineCount);
+		EXPECT_EQ(reader.decode(bitmap, 0).size(), 1);
+	}
+}
+
+TEST(ODReaderTest, NarrowWideAlphabets)
+{
+	// every character of the narrow/wide symbologies (every pair of digits for ITF) goes through the lookup tables
+	std::string itf;
+	for (int i = 0; i < 100; ++i)
+		itf += std::to_string(100 + i).substr(1);
+	for (auto [format, text] : {std::pair{BarcodeFormat::Code39, std::string("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-. $/+%")},
+								{BarcodeFormat::Codabar, std::string("A0123456789-$:/.+B")},
+								{BarcodeFormat::Codabar, std::string("C01D")},
+								{BarcodeFormat::ITF, itf.substr(0, 70)},
+								{BarcodeFormat::ITF, itf.substr(70, 70)},
+								{BarcodeFormat::ITF, itf.substr(140)}}) {
+		auto m = ToMatrix<uint8_t>(MultiFormatWriter(format).setMargin(20).encode(text, 0, 20));
+		ImageView iv(m.data(), m.width(), m.height(), ImageFormat::Lum);
+		OneD::Reader reader(DecodeHints().setFormats(format).setReturnCodabarStartEnd(true));
+		ThresholdBinarizer bitmap(iv);
+		EXPECT_EQ(reader.decode(bitmap).text(), text) << ToString(format);
+	}
+}
@@ -0,0 +1,54 @@
+/*
+* Copyright 2016 Nu-book Inc.
+* Copyright 2016 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "pdf417/PDFBarcodeValue.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace ZXing::Pdf417;
+
+static std::vector<int> Values(const BarcodeValue& bv)
+{
+	auto values = bv.value();
+	return {values.begin(), values.end()};
+}
+
+TEST(PDF417BarcodeValueTest, Votes)
+{
+	BarcodeValue bv;
+	EXPECT_TRUE(bv.value().empty());
+
+	bv.setValue(7);
+	bv.setValue(3);
+	bv.setValue(7);
+	EXPECT_EQ(Values(bv), std::vector<int>({7}));
+	EXPECT_EQ(bv.confidence(7), 2);
+	EXPECT_EQ(bv.confidence(3), 1);
+	EXPECT_EQ(bv.confidence(5), 0);
+
+	// ties are reported in ascending order
+	bv.setValue(3);
+	bv.setValue(1);
+	bv.setValue(1);
+	EXPECT_EQ(Values(bv), std::vector<int>({1, 3, 7}));
+}
+
+TEST(PDF417BarcodeValueTest, Overflow)
+{
+	BarcodeValue bv;
+	for (int i = 0; i < BarcodeValue::MAX_VALUES; ++i)
+		for (int j = 0; j <= i; ++j)
+			bv.setValue(100 + i);
+
+	// the least frequent value (100) gives way to the new one
+	bv.setValue(50);
+	EXPECT_EQ(bv.confidence(100), 0);
+	EXPECT_EQ(bv.confidence(50), 1);
+	EXPECT_EQ(bv.confidence(101), 2);
+	EXPECT_EQ(Values(bv), std::vector<int>({100 + BarcodeValue::MAX_VALUES - 1}));
+}
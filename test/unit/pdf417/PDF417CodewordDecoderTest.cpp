@@ -0,0 +1,114 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "pdf417/PDFCodewordDecoder.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Pdf417;
+
+using Widths = std::array<int, CodewordDecoder::BARS_IN_MODULE>;
+
+// All symbols (the bar/space widths of 17 modules that GetCodeword() accepts) in ascending order of their bit value
+static std::vector<std::pair<int, Widths>> AllSymbols()
+{
+	std::vector<std::pair<int, Widths>> res;
+	Widths w;
+	auto generate = [&](auto&& self, int k, int remaining, int bits) -> void {
+		if (k == CodewordDecoder::BARS_IN_MODULE) {
+			if (remaining == 0 && CodewordDecoder::GetCodeword(bits) != -1)
+				res.emplace_back(bits, w);
+			return;
+		}
+		for (w[k] = 1; w[k] <= std::min(6, remaining); ++w[k])
+			self(self, k + 1, remaining - w[k], (bits << w[k]) | (k % 2 == 0 ? (1 << w[k]) - 1 : 0));
+	};
+	generate(generate, 0, CodewordDecoder::MODULES_IN_CODEWORD, 0);
+	std::sort(res.begin(), res.end(), [](auto& a, auto& b) { return a.first < b.first; });
+	return res;
+}
+
+TEST(PDF417CodewordDecoderTest, Symbols)
+{
+	auto symbols = AllSymbols();
+	EXPECT_EQ(symbols.size(), 2787);
+
+	// every codeword exists in each of the 3 clusters
+	std::vector<int> count(CodewordDecoder::NUMBER_OF_CODEWORDS);
+	for (auto& [bits, widths] : symbols) {
+		++count[CodewordDecoder::GetCodeword(bits)];
+		EXPECT_EQ(CodewordDecoder::GetDecodedValue(widths), bits);
+	}
+	for (int c = 0; c < CodewordDecoder::NUMBER_OF_CODEWORDS - 1; ++c)
+		EXPECT_EQ(count[c], 3) << c;
+
+	EXPECT_EQ(CodewordDecoder::GetCodeword(0), -1);
+	EXPECT_EQ(CodewordDecoder::GetCodeword(symbols[0].first | 1), -1);
+	EXPECT_EQ(CodewordDecoder::GetCodeword(symbols[0].first | 1 << 17), -1);
+	EXPECT_EQ(CodewordDecoder::GetCodeword(symbols[0].first | 1 << 18), CodewordDecoder::GetCodeword(symbols[0].first));
+}
+
+TEST(PDF417CodewordDecoderTest, ClosestSymbol)
+{
+	auto symbols = AllSymbols();
+
+	// the symbol with the smallest squared distance of the width ratios, the first one of equally distant ones
+	auto linearSearch = [&](const Widths& widths) {
+		int sum = 0;
+		for (int w : widths)
+			sum += w;
+		float bestError = std::numeric_limits<float>::max();
+		int best = -1;
+		for (auto& [bits, symbolWidths] : symbols) {
+			float error = 0;
+			for (int k = 0; k < CodewordDecoder::BARS_IN_MODULE; ++k) {
+				float diff = static_cast<float>(symbolWidths[k]) / CodewordDecoder::MODULES_IN_CODEWORD - widths[k] / (float)sum;
+				error += diff * diff;
+			}
+			if (error < bestError)
+				bestError = error, best = bits;
+		}
+		return best;
+	};
+
+	// GetDecodedValue() first samples the widths at the centers of the 17 modules, only if that gives no valid symbol, the
+	// closest one is looked for
+	auto sampledSymbol = [](const Widths& widths) {
+		int sum = 0;
+		for (int w : widths)
+			sum += w;
+		int bits = 0;
+		for (int i = 0, k = 0, previous = 0; i < CodewordDecoder::MODULES_IN_CODEWORD; ++i) {
+			float center = sum / (2.f * CodewordDecoder::MODULES_IN_CODEWORD) + (i * float(sum)) / CodewordDecoder::MODULES_IN_CODEWORD;
+			if (previous + widths[k] <= center && k + 1 < CodewordDecoder::BARS_IN_MODULE)
+				previous += widths[k++];
+			bits = (bits << 1) | (k % 2 == 0);
+		}
+		return CodewordDecoder::GetCodeword(bits) == -1 ? -1 : bits;
+	};
+
+	int tested = 0;
+	for (int i = 0; i < 2787; i += 7) {
+		for (int k = 0; k < CodewordDecoder::BARS_IN_MODULE; ++k) {
+			Widths widths = symbols[i].second;
+			for (auto& w : widths)
+				w *= 3;
+			widths[k] += k % 2 ? 4 : -2;
+			if (widths[k] < 1)
+				continue;
+			if (sampledSymbol(widths) != -1)
+				continue;
+			EXPECT_EQ(CodewordDecoder::GetDecodedValue(widths), linearSearch(widths)) << i << " " << k;
+			++tested;
+		}
+	}
+	EXPECT_GT(tested, 500);
+}
@@ -48,9 +48,10 @@ static void CheckDecode(std::vector<int>& received)
 	CheckDecode(received, std::vector<int>());
 }
 
-static void Corrupt(std::vector<int>& received, int howMany, PseudoRandom& random, int max)
+static std::vector<int> Corrupt(std::vector<int>& received, int howMany, PseudoRandom& random, int max)
 {
 	std::vector<bool> corrupted(received.size(), false);
+	std::vector<int> locations;
 	for (int j = 0; j < howMany; j++) {
 		int location = random.next(0, Size(received) - 1);
 		int value = random.next(0, max - 1);
@@ -60,8 +61,10 @@ static void Corrupt(std::vector<int>& received, int howMany, PseudoRandom& rando
 		else {
 			corrupted[location] = true;
 			received[location] = value;
+			locations.push_back(location);
 		}
 	}
+	return locations;
 }
 
 
@@ -100,3 +103,35 @@ TEST(PDF417ErrorCorrectionTest, TooManyErrors)
 	int nbError = 0;
 	EXPECT_FALSE(DecodeErrorCorrection(received, ECC_BYTES, std::vector<int>(), nbError));
 }
+
+TEST(PDF417ErrorCorrectionTest, MaxErasures)
+{
+	PseudoRandom random(0x12345678);
+	for (int testIterations = 0; testIterations < 100; testIterations++) {
+		std::vector<int> received(PDF417_TEST_WITH_EC, PDF417_TEST_WITH_EC + Size(PDF417_TEST_WITH_EC));
+		auto erasures = Corrupt(received, MAX_ERASURES, random, 929);
+		CheckDecode(received, erasures);
+	}
+}
+
+TEST(PDF417ErrorCorrectionTest, ErasuresAndErrors)
+{
+	PseudoRandom random(0x12345678);
+	for (int testIterations = 0; testIterations < 100; testIterations++) {
+		std::vector<int> received(PDF417_TEST_WITH_EC, PDF417_TEST_WITH_EC + Size(PDF417_TEST_WITH_EC));
+		// only the first half of the corrupted codewords is known, each of the others costs two EC codewords
+		auto erasures = Corrupt(received, MAX_ERRORS + MAX_ERRORS / 2, random, 929);
+		erasures.resize(MAX_ERRORS);
+		CheckDecode(received, erasures);
+	}
+}
+
+TEST(PDF417ErrorCorrectionTest, TooManyErasures)
+{
+	std::vector<int> received(PDF417_TEST_WITH_EC, PDF417_TEST_WITH_EC + Size(PDF417_TEST_WITH_EC));
+	PseudoRandom random(0x12345678);
+	auto erasures = Corrupt(received, MAX_ERRORS + 2, random, 929);
+	erasures.resize(2);
+	int nbError = 0;
+	EXPECT_FALSE(DecodeErrorCorrection(received, ECC_BYTES, erasures, nbError));
+}
@@ -16,7 +16,25 @@ using namespace ZXing::Pdf417;
 TEST(PDF417HighLevelEncoderTest, EncodeAuto)
 {
 	auto encoded = HighLevelEncoder::EncodeHighLevel(L"ABCD", Compaction::AUTO, CharacterSet::UTF8);
-	EXPECT_EQ(encoded, std::vector<int>({ 0x39f, 0x1A, 0x385, 'A', 'B', 'C', 'D' }));
+	EXPECT_EQ(encoded, std::vector<int>({ 0x39f, 0x1A, 1, '?' }));
+}
+
+TEST(PDF417HighLevelEncoderTest, EncodeAutoMinimal)
+{
+	// shift to byte for a single non-text character, ps/as shifts instead of latches
+	EXPECT_EQ(HighLevelEncoder::EncodeHighLevel(L"A\u00E9b", Compaction::AUTO, CharacterSet::ISO8859_1),
+			  std::vector<int>({ 29, 913, 0xe9, 811 }));
+	EXPECT_EQ(HighLevelEncoder::EncodeHighLevel(L"ab-cd", Compaction::AUTO, CharacterSet::ISO8859_1),
+			  std::vector<int>({ 810, 59, 482, 119 }));
+
+	// numeric compaction for a long enough run of digits, back to text in submode alpha
+	auto encoded = HighLevelEncoder::EncodeHighLevel(L"Aa1234567890123456789012b", Compaction::AUTO, CharacterSet::ISO8859_1);
+	EXPECT_EQ(encoded, std::vector<int>({ 27, 29, 902, 23, 439, 739, 333, 729, 883, 621, 112, 900, 811 }));
+
+	// ASCII input does not need a wide string
+	EXPECT_EQ(HighLevelEncoder::EncodeHighLevel(std::string_view("Aa1234567890123456789012b"), Compaction::AUTO,
+												CharacterSet::ISO8859_1),
+			  encoded);
 }
 
 TEST(PDF417HighLevelEncoderTest, EncodeAutoWithSpecialChars)
@@ -0,0 +1,59 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "pdf417/PDFReader.h"
+
+#include "BitMatrix.h"
+#include "DecodeHints.h"
+#include "Executor.h"
+#include "Result.h"
+#include "ThresholdBinarizer.h"
+#include "pdf417/PDFWriter.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+
+static std::vector<std::string> TextsAndPositions(const Results& results)
+{
+	std::vector<std::string> res;
+	for (auto& r : results)
+		res.push_back(r.text() + "@" + std::to_string(r.position()[0].x) + "x" + std::to_string(r.position()[0].y));
+	return res;
+}
+
+TEST(PDF417ReaderTest, ManySymbols)
+{
+	// a document page carrying a couple of PDF417 symbols
+	const int cols = 2, rows = 4, gap = 40;
+	std::vector<BitMatrix> symbols;
+	for (int i = 0; i < cols * rows; ++i)
+		symbols.push_back(Pdf417::Writer().setMargin(0).encode(L"document page symbol " + std::to_wstring(i), 0, 0));
+	const int width = symbols[0].width(), height = symbols[0].height();
+	Matrix<uint8_t> img(cols * (width + gap) + gap, rows * (height + gap) + gap, 0xff);
+	for (int i = 0; i < cols * rows; ++i)
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+				if (symbols[i].get(x, y))
+					img.set(gap + (i % cols) * (width + gap) + x, gap + (i / cols) * (height + gap) + y, 0);
+	ImageView iv(img.data(), img.width(), img.height(), ImageFormat::Lum);
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::PDF417);
+	Pdf417::Reader reader(hints);
+
+	ThresholdBinarizer serialBitmap(iv);
+	auto serial = TextsAndPositions(reader.decode(serialBitmap, 0));
+	EXPECT_EQ(Size(serial), cols * rows);
+
+	for (int threads : {2, 3, 8}) {
+		ThreadExecutor executor(threads);
+		ThresholdBinarizer bitmap(iv);
+		bitmap.setExecutor(&executor);
+		EXPECT_EQ(TextsAndPositions(reader.decode(bitmap, 0)), serial) << threads;
+	}
+}
@@ -71,3 +71,19 @@ TEST(QRBitMatrixParserTest, MQRCodeM3M)
 	EXPECT_EQ(0x0, codewords[8]);
 	EXPECT_EQ(0x89, codewords[9]);
 }
+
+TEST(QRBitMatrixParserTest, DataModuleCountOfAllVersions)
+{
+	FormatInformation format;
+	format.ecLevel = ErrorCorrectionLevel::Low;
+	for (int i = 1; i <= 40; ++i) {
+		const auto version = Version::Model2(i);
+		EXPECT_EQ(ReadCodewords(BitMatrix(version->dimension()), *version, format).size(), version->totalCodewords()) << i;
+	}
+	for (int i = 1; i <= 4; ++i) {
+		const auto version = Version::Micro(i);
+		EXPECT_EQ(ReadCodewords(BitMatrix(version->dimension()), *version, format).size(), version->totalCodewords()) << i;
+	}
+	// a bit matrix that does not match the version
+	EXPECT_TRUE(ReadCodewords(BitMatrix(25), *Version::Model2(1), format).empty());
+}
@@ -0,0 +1,54 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "qrcode/QRDecoder.h"
+
+#include "BitMatrix.h"
+#include "DecoderResult.h"
+#include "MultiFormatWriter.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+using namespace ZXing;
+using namespace ZXing::QRCode;
+
+static BitMatrix Transposed(const BitMatrix& bits)
+{
+	BitMatrix res(bits.height(), bits.width());
+	for (int y = 0; y < bits.height(); ++y)
+		for (int x = 0; x < bits.width(); ++x)
+			res.set(y, x, bits.get(x, y));
+	return res;
+}
+
+TEST(QRDecoderTest, RepeatedDecode)
+{
+	// decoding the same symbol again is served from the per thread cache, this must not make any difference
+	auto a = MultiFormatWriter(BarcodeFormat::QRCode).setMargin(0).setEccLevel(1).encode("first symbol", 1, 1);
+	auto b = MultiFormatWriter(BarcodeFormat::QRCode).setMargin(0).setEccLevel(7).encode("second symbol", 1, 1);
+
+	auto firstA = Decode(a);
+	auto firstB = Decode(b);
+	ASSERT_TRUE(firstA.isValid());
+	ASSERT_TRUE(firstB.isValid());
+	EXPECT_EQ(firstB.ecLevel(), "H");
+	for (int i = 0; i < 6; ++i) {
+		const auto& first = i % 2 ? firstB : firstA;
+		auto res = Decode(i % 2 ? b : a);
+		ASSERT_TRUE(res.isValid());
+		EXPECT_EQ(res.content().text(TextMode::Plain), i % 2 ? "second symbol" : "first symbol");
+		EXPECT_EQ(res.content().bytes, first.content().bytes);
+		EXPECT_EQ(res.ecLevel(), first.ecLevel());
+		EXPECT_EQ(res.versionNumber(), first.versionNumber());
+		EXPECT_FALSE(res.isMirrored());
+	}
+
+	auto mirrored = Decode(Transposed(a));
+	ASSERT_TRUE(mirrored.isValid());
+	EXPECT_EQ(mirrored.content().text(TextMode::Plain), "first symbol");
+	EXPECT_TRUE(mirrored.isMirrored());
+}
@@ -9,6 +9,8 @@
 #include "CharacterSet.h"
 #include "TextDecoder.h"
 #include "Utf.h"
+#include "DecoderResult.h"
+#include "qrcode/QRDecoder.h"
 #include "qrcode/QREncoder.h"
 #include "qrcode/QRCodecMode.h"
 #include "qrcode/QREncodeResult.h"
@@ -22,11 +24,11 @@ namespace ZXing {
 		CodecMode ChooseMode(const std::wstring& content, CharacterSet encoding);
 		void AppendModeInfo(CodecMode mode, BitArray& bits);
 		void AppendLengthInfo(int numLetters, const Version& version, CodecMode mode, BitArray& bits);
-		void AppendNumericBytes(const std::wstring& content, BitArray& bits);
-		void AppendAlphanumericBytes(const std::wstring& content, BitArray& bits);
-		void Append8BitBytes(const std::wstring& content, CharacterSet encoding, BitArray& bits);
-		void AppendKanjiBytes(const std::wstring& content, BitArray& bits);
-		void AppendBytes(const std::wstring& content, CodecMode mode, CharacterSet encoding, BitArray& bits);
+		void AppendNumericBytes(std::string_view content, BitArray& bits);
+		void AppendAlphanumericBytes(std::string_view content, BitArray& bits);
+		void Append8BitBytes(std::string_view content, CharacterSet encoding, BitArray& bits);
+		void AppendKanjiBytes(std::string_view content, BitArray& bits);
+		void AppendBytes(std::string_view content, CodecMode mode, CharacterSet encoding, BitArray& bits);
 		void TerminateBits(int numDataBytes, BitArray& bits);
 		void GetNumDataBytesAndNumECBytesForBlockID(int numTotalBytes, int numDataBytes, int numRSBlocks, int blockID, int& numDataBytesInBlock, int& numECBytesInBlock);
 		void GenerateECBytes(const ByteArray& dataBytes, int numEcBytesInBlock, ByteArray& ecBytes);
@@ -39,11 +41,16 @@ using namespace ZXing::QRCode;
 using namespace ZXing::Utility;
 
 namespace {
-	std::wstring ShiftJISString(const std::vector<uint8_t>& bytes)
+	std::string ShiftJISUtf8(const std::vector<uint8_t>& bytes)
 	{
 		std::string str;
 		TextDecoder::Append(str, bytes.data(), bytes.size(), CharacterSet::Shift_JIS);
-		return FromUtf8(str);
+		return str;
+	}
+
+	std::wstring ShiftJISString(const std::vector<uint8_t>& bytes)
+	{
+		return FromUtf8(ShiftJISUtf8(bytes));
 	}
 
 	std::string RemoveSpace(std::string s)
@@ -287,37 +294,38 @@ TEST(QREncoderTest, EncodeShiftjisNumeric)
 TEST(QREncoderTest, EncodeGS1)
 {
 	auto qrCode = Encode(L"100001%11171218", ErrorCorrectionLevel::High, CharacterSet::Unknown, 0, true, -1);
+	// "100001%" alphanumeric ('%' is the FNC1) followed by "11171218" numeric is 3 bits shorter than all alphanumeric
 	EXPECT_EQ(qrCode.mode, CodecMode::ALPHANUMERIC);
 	EXPECT_EQ(qrCode.ecLevel, ErrorCorrectionLevel::High);
 	ASSERT_NE(qrCode.version, nullptr);
 	EXPECT_EQ(qrCode.version->versionNumber(), 2);
-	EXPECT_EQ(qrCode.maskPattern, 4);
+	EXPECT_EQ(qrCode.maskPattern, 5);
 	EXPECT_EQ(ToString(qrCode.matrix),
-		"X X X X X X X     X X X X   X   X   X X X X X X X \n"
-		"X           X   X X           X X   X           X \n"
-		"X   X X X   X           X X X   X   X   X X X   X \n"
-		"X   X X X   X     X   X     X X     X   X X X   X \n"
-		"X   X X X   X       X X X       X   X   X X X   X \n"
-		"X           X   X X   X X   X X     X           X \n"
+		"X X X X X X X   X   X     X X   X   X X X X X X X \n"
+		"X           X           X       X   X           X \n"
+		"X   X X X   X   X   X   X X X X X   X   X X X   X \n"
+		"X   X X X   X       X   X X   X X   X   X X X   X \n"
+		"X   X X X   X   X   X X X   X   X   X   X X X   X \n"
+		"X           X     X X     X X X     X           X \n"
 		"X X X X X X X   X   X   X   X   X   X X X X X X X \n"
-		"                X X   X X   X X                   \n"
-		"        X X X X     X X       X X   X X       X   \n"
-		"  X X   X X     X X X       X X X X X X X       X \n"
-		"    X X X X X   X X X X X   X             X X X   \n"
-		"X   X X X     X X X   X X X X X   X X   X X X     \n"
-		"  X   X     X X X X X X     X X   X           X   \n"
-		"X     X X X     X X       X X   X   X   X         \n"
-		"    X     X X X   X X   X X X   X X X   X X X X   \n"
-		"      X X     X     X     X X     X       X X X   \n"
-		"X X   X   X X   X   X       X X X X X X X         \n"
-		"                X X   X       X X       X X   X   \n"
-		"X X X X X X X   X   X   X   X X X   X   X         \n"
-		"X           X   X X       X   X X       X   X X   \n"
-		"X   X X X   X   X X X           X X X X X X     X \n"
-		"X   X X X   X             X X X     X X   X       \n"
-		"X   X X X   X       X X   X   X X X   X X     X   \n"
-		"X           X     X X   X X X X X   X   X X       \n"
-		"X X X X X X X       X         X X     X X     X X \n");
+		"                X X   X   X   X X                 \n"
+		"          X X       X               X   X   X   X \n"
+		"X X X X   X     X       X   X           X   X   X \n"
+		"      X     X   X       X           X X X X     X \n"
+		"X   X X X     X X   X   X     X X   X   X     X X \n"
+		"X     X X X X       X X     X   X X       X X     \n"
+		"X X     X     X         X X     X X X X X         \n"
+		"X   X     X X X X X X     X X       X   X X     X \n"
+		"X   X   X       X         X   X     X X X   X   X \n"
+		"X   X   X   X X X     X     X   X X X X X X       \n"
+		"                X           X X X       X X   X   \n"
+		"X X X X X X X     X X X X     X X   X   X X   X X \n"
+		"X           X   X X X       X   X       X X     X \n"
+		"X   X X X   X     X X   X     X X X X X X X X   X \n"
+		"X   X X X   X     X         X X X   X   X   X     \n"
+		"X   X X X   X     X   X     X X     X           X \n"
+		"X           X         X     X     X     X     X X \n"
+		"X X X X X X X           X X X     X   X X X X   X \n");
 }
 
 TEST(QREncoderTest, EncodeGS1ModeHeaderWithECI)
@@ -352,6 +360,35 @@ TEST(QREncoderTest, EncodeGS1ModeHeaderWithECI)
 		"X X X X X X X     X X X   X X   X     X   \n");
 }
 
+TEST(QREncoderTest, EncodeMixedSegments)
+{
+	// GS1 digital link: all in byte mode needs version 5-M, with the digit runs in numeric mode it fits in version 4-M
+	std::wstring content = L"https://id.gs1.org/01/09506000134352/10/ABC123/21/4711000012345678";
+	auto qrCode = Encode(content, ErrorCorrectionLevel::Medium, CharacterSet::Unknown, 0, false, -1);
+	EXPECT_EQ(qrCode.mode, CodecMode::BYTE);
+	ASSERT_NE(qrCode.version, nullptr);
+	EXPECT_EQ(qrCode.version->versionNumber(), 4);
+
+	auto res = Decode(qrCode.matrix);
+	EXPECT_TRUE(res.isValid());
+	EXPECT_EQ(res.text(), content);
+}
+
+TEST(QREncoderTest, EncodeUtf8)
+{
+	// the utf8 entry point gives the same symbol as the wide string one, also for multi byte and non-BMP characters
+	std::string content = "Gr\xC3\xBC\xC3\x9F" "e 0123456789 \xE6\xBC\xA2\xE5\xAD\x97 \xF0\x9F\x98\x80 ABC";
+	for (auto charset : {CharacterSet::UTF8, CharacterSet::UTF16BE, CharacterSet::UTF32LE}) {
+		auto utf8 = Encode(std::string_view(content), ErrorCorrectionLevel::Low, charset, 0, false, -1);
+		auto wide = Encode(FromUtf8(content), ErrorCorrectionLevel::Low, charset, 0, false, -1);
+		EXPECT_EQ(utf8.version->versionNumber(), wide.version->versionNumber());
+		EXPECT_EQ(utf8.matrix, wide.matrix);
+	}
+
+	EXPECT_THROW(Encode(std::string_view("\xC3"), ErrorCorrectionLevel::Low, CharacterSet::UTF8, 0, false, -1),
+				 std::invalid_argument);
+}
+
 TEST(QREncoderTest, AppendModeInfo)
 {
 	BitArray bits;
@@ -386,27 +423,27 @@ TEST(QREncoderTest, AppendNumericBytes)
 {
 	// 1 = 01 = 0001 in 4 bits.
 	BitArray bits;
-	AppendNumericBytes(L"1", bits);
+	AppendNumericBytes("1", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("...X"));
 
 	// 12 = 0xc = 0001100 in 7 bits.
 	bits = BitArray();
-	AppendNumericBytes(L"12", bits);
+	AppendNumericBytes("12", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("...XX.."));
 
 	// 123 = 0x7b = 0001111011 in 10 bits.
 	bits = BitArray();
-	AppendNumericBytes(L"123", bits);
+	AppendNumericBytes("123", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("...XXXX. XX"));
 
 	// 1234 = "123" + "4" = 0001111011 + 0100
 	bits = BitArray();
-	AppendNumericBytes(L"1234", bits);
+	AppendNumericBytes("1234", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("...XXXX. XX.X.."));
 
 	// Empty.
 	bits = BitArray();
-	AppendNumericBytes(L"", bits);
+	AppendNumericBytes("", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace(""));
 }
 
@@ -414,38 +451,38 @@ TEST(QREncoderTest, AppendAlphanumericBytes)
 {
 	// A = 10 = 0xa = 001010 in 6 bits
 	BitArray bits;
-	AppendAlphanumericBytes(L"A", bits);
+	AppendAlphanumericBytes("A", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("..X.X."));
 
 	// AB = 10 * 45 + 11 = 461 = 0x1cd = 00111001101 in 11 bits
 	bits = BitArray();
-	AppendAlphanumericBytes(L"AB", bits);
+	AppendAlphanumericBytes("AB", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("..XXX..X X.X"));
 
 	// ABC = "AB" + "C" = 00111001101 + 001100
 	bits = BitArray();
-	AppendAlphanumericBytes(L"ABC", bits);
+	AppendAlphanumericBytes("ABC", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("..XXX..X X.X..XX. ."));
 
 	// Empty.
 	bits = BitArray();
-	AppendAlphanumericBytes(L"", bits);
+	AppendAlphanumericBytes("", bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace(""));
 
 	// Invalid data.
-	EXPECT_THROW(AppendAlphanumericBytes(L"abc", bits), std::invalid_argument);
+	EXPECT_THROW(AppendAlphanumericBytes("abc", bits), std::invalid_argument);
 }
 
 TEST(QREncoderTest, Append8BitBytes)
 {
 	// 0x61, 0x62, 0x63
 	BitArray bits;
-	Append8BitBytes(L"abc", CharacterSet::Unknown, bits);
+	Append8BitBytes("abc", CharacterSet::Unknown, bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace(".XX....X .XX...X. .XX...XX"));
 	
 	// Empty.
 	bits = BitArray();
-	Append8BitBytes(L"", CharacterSet::Unknown, bits);
+	Append8BitBytes("", CharacterSet::Unknown, bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace(""));
 }
 
@@ -453,10 +490,10 @@ TEST(QREncoderTest, Append8BitBytes)
 TEST(QREncoderTest, AppendKanjiBytes)
 {
 	BitArray bits;
-	AppendKanjiBytes(ShiftJISString({ 0x93, 0x5f }), bits);
+	AppendKanjiBytes(ShiftJISUtf8({ 0x93, 0x5f }), bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace(".XX.XX.. XXXXX"));
 	
-	AppendKanjiBytes(ShiftJISString({ 0xe4, 0xaa }), bits);
+	AppendKanjiBytes(ShiftJISUtf8({ 0xe4, 0xaa }), bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace(".XX.XX.. XXXXXXX. X.X.X.X. X."));
 }
 
@@ -465,32 +502,32 @@ TEST(QREncoderTest, AppendBytes)
 	// Should use appendNumericBytes.
 	// 1 = 01 = 0001 in 4 bits.
 	BitArray bits;
-	AppendBytes(L"1", CodecMode::NUMERIC, CharacterSet::Unknown, bits);
+	AppendBytes("1", CodecMode::NUMERIC, CharacterSet::Unknown, bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("...X"));
 
 	// Should use appendAlphanumericBytes.
 	// A = 10 = 0xa = 001010 in 6 bits
 	bits = BitArray();
-	AppendBytes(L"A", CodecMode::ALPHANUMERIC, CharacterSet::Unknown, bits);
+	AppendBytes("A", CodecMode::ALPHANUMERIC, CharacterSet::Unknown, bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace("..X.X."));
 
 	// Lower letters such as 'a' cannot be encoded in MODE_ALPHANUMERIC.
 	bits = BitArray();
-	EXPECT_THROW(AppendBytes(L"a", CodecMode::ALPHANUMERIC, CharacterSet::Unknown, bits), std::invalid_argument);
+	EXPECT_THROW(AppendBytes("a", CodecMode::ALPHANUMERIC, CharacterSet::Unknown, bits), std::invalid_argument);
 
 	// Should use append8BitBytes.
 	// 0x61, 0x62, 0x63
 	bits = BitArray();
-	AppendBytes(L"abc", CodecMode::BYTE, CharacterSet::Unknown, bits);
+	AppendBytes("abc", CodecMode::BYTE, CharacterSet::Unknown, bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace(".XX....X .XX...X. .XX...XX"));
 
 	// Anything can be encoded in QRCode.MODE_8BIT_BYTE.
-	AppendBytes(L"\0", CodecMode::BYTE, CharacterSet::Unknown, bits);
+	AppendBytes("\0", CodecMode::BYTE, CharacterSet::Unknown, bits);
 
 	// Should use appendKanjiBytes.
 	// 0x93, 0x5f
 	bits = BitArray();
-	AppendBytes(ShiftJISString({0x93, 0x5f}), CodecMode::KANJI, CharacterSet::Unknown, bits);
+	AppendBytes(ShiftJISUtf8({0x93, 0x5f}), CodecMode::KANJI, CharacterSet::Unknown, bits);
 	EXPECT_EQ(ToString(bits), RemoveSpace(".XX.XX.. XXXXX"));
 }
 
@@ -6,8 +6,12 @@
 
 #include "qrcode/QRFormatInformation.h"
 
+#include "BitHacks.h"
+
 #include "gtest/gtest.h"
 
+#include <vector>
+
 using namespace ZXing;
 using namespace ZXing::QRCode;
 
@@ -89,3 +93,31 @@ TEST(QRFormatInformationTest, DecodeMicroWithBitDifference)
 //	EXPECT_NE(expected.errorCorrectionLevel(),
 //			  FormatInformation::DecodeFormatInformation(MICRO_MASKED_TEST_FORMAT_INFO ^ 0x3f).errorCorrectionLevel());
 }
+
+TEST(QRFormatInformationTest, LookupMatchesLinearSearch)
+{
+	// the unmasked codewords, see ISO 18004:2015, Annex C, Table C.1
+	std::vector<uint32_t> codewords;
+	for (uint32_t data = 0; data < 32; ++data) {
+		uint32_t rem = data << 10;
+		for (int i = 14; i >= 10; --i)
+			if (rem & (1 << i))
+				rem ^= 0x537 << (i - 10);
+		codewords.push_back(data << 10 | rem);
+	}
+
+	for (uint32_t bits = 0; bits < (1 << 15); ++bits) {
+		auto fi = FormatInformation::DecodeMQR(bits);
+		uint32_t mirrored = BitHacks::Reverse(bits) >> 17;
+		int bestDist = 255, bestData = 255, bestIndex = 255;
+		for (int index : {0, 1})
+			for (uint32_t data = 0; data < 32; ++data)
+				if (int dist = BitHacks::CountBitsSet((index ? mirrored : bits) ^ FORMAT_INFO_MASK_MICRO ^ codewords[data]); dist < bestDist)
+					bestDist = dist, bestData = data, bestIndex = index;
+		ASSERT_EQ(fi.hammingDistance, bestDist) << bits;
+		ASSERT_EQ(fi.bitsIndex, bestIndex) << bits;
+		// the order of Table C.1 breaks ties between equally distant codewords, not the value of the data bits
+		if (bestDist <= 3)
+			ASSERT_EQ(fi.data, bestData) << bits;
+	}
+}
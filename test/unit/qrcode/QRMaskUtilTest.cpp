@@ -0,0 +1,124 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "qrcode/QRMaskUtil.h"
+
+#include "BitArray.h"
+#include "qrcode/QRErrorCorrectionLevel.h"
+#include "qrcode/QRMatrixUtil.h"
+#include "qrcode/QRVersion.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+using namespace ZXing;
+using namespace ZXing::QRCode;
+
+// straight forward module by module implementation of the 4 penalty rules (section 6.8.2.1)
+static int ReferencePenalty(const TritMatrix& m)
+{
+	const int w = m.width(), h = m.height();
+	auto at = [&](int i, int j, bool horizontal) { return bool(horizontal ? m.get(j, i) : m.get(i, j)); };
+	int penalty = 0;
+
+	for (bool horizontal : {true, false}) {
+		const int iLimit = horizontal ? h : w, jLimit = horizontal ? w : h;
+		for (int i = 0; i < iLimit; ++i) {
+			// rule 1: runs of 5 + k same colored modules cost 3 + k
+			for (int j = 0, run = 0; j <= jLimit; ++j, ++run)
+				if (j == jLimit || (j > 0 && at(i, j, horizontal) != at(i, j - 1, horizontal))) {
+					if (run >= 5)
+						penalty += 3 + run - 5;
+					run = 0;
+				}
+			// rule 3: 1011101 with 4 light modules on one side (outside of the symbol is light)
+			for (int j = 0; j + 7 <= jLimit; ++j) {
+				bool finder = true;
+				for (int k = 0; k < 7; ++k)
+					finder &= at(i, j + k, horizontal) == bool(0b1011101 & (1 << k));
+				bool before = true, after = true;
+				for (int k = 1; k <= 4; ++k) {
+					before &= j - k < 0 || !at(i, j - k, horizontal);
+					after &= j + 6 + k >= jLimit || !at(i, j + 6 + k, horizontal);
+				}
+				penalty += 40 * (finder && (before || after));
+			}
+		}
+	}
+
+	// rule 2: 2x2 blocks of the same color
+	for (int y = 0; y < h - 1; ++y)
+		for (int x = 0; x < w - 1; ++x) {
+			bool v = m.get(x, y);
+			penalty += 3 * (v == m.get(x + 1, y) && v == m.get(x, y + 1) && v == m.get(x + 1, y + 1));
+		}
+
+	// rule 4: 10 for every 5% the ratio of dark modules is away from 50%
+	int dark = static_cast<int>(std::count_if(m.begin(), m.end(), [](Trit t) { return bool(t); }));
+	penalty += std::abs(dark * 2 - m.size()) * 10 / m.size() * 10;
+
+	return penalty;
+}
+
+TEST(QRMaskUtilTest, MatchesReference)
+{
+	std::mt19937 rng(42);
+	for (int size : {1, 5, 7, 11, 21, 63, 64, 65, 101, 128, 129, 177}) {
+		for (int density : {2, 8, 64}) {
+			// sparse matrices produce long runs, finder like patterns show up in the dense ones
+			TritMatrix m(size, size);
+			for (int y = 0; y < size; ++y)
+				for (int x = 0; x < size; ++x)
+					m.set(x, y, rng() % density == 0);
+			EXPECT_EQ(MaskUtil::CalculateMaskPenalty(m), ReferencePenalty(m)) << size << " " << density;
+		}
+	}
+
+	TritMatrix m(13, 7);
+	for (int x = 0; x < 13; ++x)
+		m.set(x, 3, bool(0b0000001011101 & (1 << x)));
+	EXPECT_EQ(MaskUtil::CalculateMaskPenalty(m), ReferencePenalty(m));
+}
+
+TEST(QRMaskUtilTest, EncodedSymbols)
+{
+	for (int versionNumber : {1, 7, 40}) {
+		const Version& version = *Version::Model2(versionNumber);
+		BitArray bits;
+		for (int i = 0; i < version.totalCodewords() * 8; ++i)
+			bits.appendBit((i * 2654435761u >> 7) & 1);
+		TritMatrix m(version.dimension(), version.dimension());
+		for (int mask = 0; mask < NUM_MASK_PATTERNS; ++mask) {
+			BuildMatrix(bits, ErrorCorrectionLevel::Medium, version, mask, m);
+			EXPECT_EQ(MaskUtil::CalculateMaskPenalty(m), ReferencePenalty(m)) << versionNumber << " " << mask;
+		}
+	}
+}
+
+TEST(QRMaskUtilTest, AllMasksAtOnce)
+{
+	for (int versionNumber : {1, 7, 11, 27, 40}) {
+		const Version& version = *Version::Model2(versionNumber);
+		BitArray bits;
+		for (int i = 0; i < version.totalCodewords() * 8; ++i)
+			bits.appendBit((i * 2654435761u >> 5) & 1);
+		TritMatrix all(version.dimension(), version.dimension()), m(version.dimension(), version.dimension());
+		Matrix<uint8_t> maskFlips;
+		BuildMatrixForAllMasks(bits, ErrorCorrectionLevel::Quality, version, all, maskFlips);
+		auto penalties = MaskUtil::CalculateMaskPenalties(all, maskFlips);
+		for (int mask = 0; mask < NUM_MASK_PATTERNS; ++mask) {
+			BuildMatrix(bits, ErrorCorrectionLevel::Quality, version, mask, m);
+			EXPECT_EQ(penalties[mask], MaskUtil::CalculateMaskPenalty(m)) << versionNumber << " " << mask;
+			int diffs = 0;
+			for (int y = 0; y < m.height(); ++y)
+				for (int x = 0; x < m.width(); ++x)
+					diffs += bool(m.get(x, y)) != (bool(all.get(x, y)) != bool((maskFlips(x, y) >> mask) & 1));
+			EXPECT_EQ(diffs, 0) << versionNumber << " " << mask;
+		}
+	}
+}
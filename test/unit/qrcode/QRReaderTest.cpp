@@ -0,0 +1,136 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "qrcode/QRReader.h"
+
+#include "BitMatrix.h"
+#include "BitMatrixIO.h"
+#include "DecodeHints.h"
+#include "Executor.h"
+#include "MultiFormatWriter.h"
+#include "Result.h"
+#include "ThresholdBinarizer.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+
+static std::vector<std::string> TextsAndPositions(const Results& results)
+{
+	std::vector<std::string> res;
+	for (auto& r : results)
+		res.push_back(r.text() + "@" + std::to_string(r.position()[0].x) + "x" + std::to_string(r.position()[0].y));
+	return res;
+}
+
+TEST(QRReaderTest, ParallelSetsMatchSerial)
+{
+	// a grid of symbols, so that there are many finder pattern sets, most of them made of patterns of different symbols
+	const int cols = 4, rows = 3, size = 120, gap = 40;
+	Matrix<uint8_t> img(cols * (size + gap) + gap, rows * (size + gap) + gap, 0xff);
+	for (int r = 0; r < rows; ++r)
+		for (int c = 0; c < cols; ++c) {
+			auto text = "pallet item " + std::to_string(r * cols + c);
+			auto m = ToMatrix<uint8_t>(MultiFormatWriter(BarcodeFormat::QRCode).setMargin(0).encode(text, size, size));
+			for (int y = 0; y < m.height(); ++y)
+				for (int x = 0; x < m.width(); ++x)
+					img.set(gap + c * (size + gap) + x, gap + r * (size + gap) + y, m(x, y));
+		}
+	ImageView iv(img.data(), img.width(), img.height(), ImageFormat::Lum);
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode);
+	QRCode::Reader reader(hints, true);
+
+	ThresholdBinarizer serialBitmap(iv);
+	auto serial = TextsAndPositions(reader.decode(serialBitmap, 0));
+	ASSERT_EQ(serial.size(), cols * rows);
+
+	for (int threads : {2, 3, 8}) {
+		ThreadExecutor executor(threads);
+		ThresholdBinarizer bitmap(iv);
+		bitmap.setExecutor(&executor);
+		EXPECT_EQ(TextsAndPositions(reader.decode(bitmap, 0)), serial) << threads;
+		EXPECT_EQ(TextsAndPositions(reader.decode(bitmap, 5)), std::vector<std::string>(serial.begin(), serial.begin() + 5))
+			<< threads;
+	}
+}
+
+TEST(QRReaderTest, DecodeTracked)
+{
+	auto m = ToMatrix<uint8_t>(MultiFormatWriter(BarcodeFormat::QRCode).setMargin(0).encode("tracked symbol", 150, 150));
+	auto frame = [&](int dx, int dy) {
+		Matrix<uint8_t> img(400, 300, 0xff);
+		for (int y = 0; y < m.height(); ++y)
+			for (int x = 0; x < m.width(); ++x)
+				img.set(100 + dx + x, 50 + dy + y, m(x, y));
+		return img;
+	};
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::QRCode);
+	QRCode::Reader reader(hints, true);
+
+	auto img0 = frame(0, 0);
+	auto first = reader.decode(ThresholdBinarizer(ImageView(img0.data(), img0.width(), img0.height(), ImageFormat::Lum)));
+	ASSERT_TRUE(first.isValid());
+
+	// the symbol moved a few pixels
+	auto img1 = frame(6, -4);
+	ThresholdBinarizer moved(ImageView(img1.data(), img1.width(), img1.height(), ImageFormat::Lum));
+	auto tracked = reader.decodeTracked(moved, first);
+	ASSERT_TRUE(tracked.isValid());
+	EXPECT_EQ(tracked.text(), "tracked symbol");
+	EXPECT_EQ(tracked.position(), reader.decode(moved).position());
+
+	// the symbol moved too far away to be found at the old position
+	auto img2 = frame(140, 80);
+	EXPECT_FALSE(reader.decodeTracked(ThresholdBinarizer(ImageView(img2.data(), img2.width(), img2.height(), ImageFormat::Lum)), first).isValid());
+}
+
+TEST(QRReaderTest, RotatedMicroQRCode)
+{
+	// M3-L symbol, see MQRDecoderTest.MQRCodeM3L
+	const auto bits = ParseBitMatrix("XXXXXXX X X X X\n"
+									 "X     X    X X \n"
+									 "X XXX X XXXXXXX\n"
+									 "X XXX X X X  XX\n"
+									 "X XXX X    X XX\n"
+									 "X     X X X X X\n"
+									 "XXXXXXX  X  XX \n"
+									 "         X X  X\n"
+									 "XXXXXX    X X X\n"
+									 "   X  XX    XXX\n"
+									 "XXX XX XXXX XXX\n"
+									 " X    X  XXX X \n"
+									 "X XXXXX XXX X X\n"
+									 " X    X  X XXX \n"
+									 "XXX XX X X XXXX\n",
+									 88, false);
+
+	auto hints = DecodeHints().setFormats(BarcodeFormat::MicroQRCode);
+	QRCode::Reader reader(hints, true);
+
+	const int moduleSize = 6, size = 200;
+	for (double angle : {0., 10., 17., 30., 45., 62., 90.}) {
+		// render the symbol rotated around the image center by angle degrees
+		Matrix<uint8_t> img(size, size, 0xff);
+		const double c = std::cos(angle / 180 * 3.1415926), s = std::sin(angle / 180 * 3.1415926);
+		for (int y = 0; y < size; ++y)
+			for (int x = 0; x < size; ++x) {
+				double dx = x + 0.5 - size / 2., dy = y + 0.5 - size / 2.;
+				int mx = int(std::floor((c * dx + s * dy) / moduleSize + bits.width() / 2.));
+				int my = int(std::floor((-s * dx + c * dy) / moduleSize + bits.height() / 2.));
+				if (bits.isIn(PointI(mx, my)) && bits.get(mx, my))
+					img.set(x, y, 0);
+			}
+
+		auto res = reader.decode(ThresholdBinarizer(ImageView(img.data(), img.width(), img.height(), ImageFormat::Lum)), 0);
+		ASSERT_EQ(res.size(), 1) << angle;
+		EXPECT_EQ(res[0].format(), BarcodeFormat::MicroQRCode) << angle;
+	}
+}
@@ -6,10 +6,14 @@
 
 #include "qrcode/QRVersion.h"
 
+#include "BitHacks.h"
 #include "BitMatrix.h"
+#include "ZXAlgorithms.h"
 
 #include "gtest/gtest.h"
 
+#include <vector>
+
 using namespace ZXing;
 using namespace ZXing::QRCode;
 
@@ -61,6 +65,32 @@ TEST(QRVersionTest, DecodeVersionInformation)
 	DoTestVersion(32, 0x209D5);
 }
 
+TEST(QRVersionTest, DecodeVersionInformationMatchesLinearSearch)
+{
+	// the codewords of versions 7 to 40, see ISO 18004:2015 Annex D
+	const std::vector<int> codewords = {
+		0x07C94, 0x085BC, 0x09A99, 0x0A4D3, 0x0BBF6, 0x0C762, 0x0D847, 0x0E60D, 0x0F928, 0x10B78, 0x1145D, 0x12A17,
+		0x13532, 0x149A6, 0x15683, 0x168C9, 0x177EC, 0x18EC4, 0x191E1, 0x1AFAB, 0x1B08E, 0x1CC1A, 0x1D33F, 0x1ED75,
+		0x1F250, 0x209D5, 0x216F0, 0x228BA, 0x2379F, 0x24B0B, 0x2542E, 0x26A64, 0x27541, 0x28C69,
+	};
+
+	auto linearSearch = [&](int bits) {
+		int best = 0, bestDiff = 4;
+		for (int i = 0; i < Size(codewords); ++i)
+			if (int diff = BitHacks::CountBitsSet(bits ^ codewords[i]); diff < bestDiff)
+				best = i + 7, bestDiff = diff;
+		return best;
+	};
+
+	for (int bits = 0; bits < (1 << 18); ++bits) {
+		auto version = Version::DecodeVersionInformation(bits);
+		ASSERT_EQ(version ? version->versionNumber() : 0, linearSearch(bits)) << bits;
+	}
+	// the nearer of the two copies wins
+	EXPECT_EQ(Version::DecodeVersionInformation(0x07C94 ^ 0b111, 0x085BC ^ 0b11)->versionNumber(), 8);
+	EXPECT_EQ(Version::DecodeVersionInformation(0x07C94 ^ 0b1, 0x085BC ^ 0b1)->versionNumber(), 7);
+}
+
 TEST(QRVersionTest, MicroVersionForNumber)
 {
 	auto version = Version::Micro(0);
@@ -66,6 +66,7 @@ class MainActivity : AppCompatActivity() {
 	private val permissionsRequestCode = 1
 	private val beeper = ToneGenerator(AudioManager.STREAM_NOTIFICATION, 50)
 	private val decodeHints = ZXingCpp.DecodeHints()
+	private var reader: ZXingCpp.Reader? = null
 
 	private var lastText = String()
 	private var doSaveImage: Boolean = false
@@ -246,9 +247,15 @@ class MainActivity : AppCompatActivity() {
 						tryDownscale = binding.tryDownscale.isChecked
 					}
 
+					// the native reader is kept between frames and only recreated if the hints changed
+					if (reader?.hints != decodeHints) {
+						reader?.close()
+						reader = ZXingCpp.Reader(decodeHints.copy())
+					}
+
 					resultText = try {
 						image.use {
-							ZXingCpp.read(it, decodeHints)
+							reader!!.read(it)
 						}.apply {
 							runtime2 += firstOrNull()?.time ?: 0
 						}.joinToString("\n") { result ->
@@ -333,6 +340,15 @@ class MainActivity : AppCompatActivity() {
 		}
 	}
 
+	override fun onDestroy() {
+		super.onDestroy()
+		// the reader is only used on the analyzer thread, so release it there after the last frame
+		executor.execute {
+			reader?.close()
+			reader = null
+		}
+	}
+
 	override fun onRequestPermissionsResult(
 		requestCode: Int,
 		permissions: Array<out String>,
@@ -26,15 +26,24 @@ static uint16_t LowSurrogate(uint32_t ucs4)
 
 static void Utf32toUtf16(const uint32_t* utf32, size_t length, std::vector<uint16_t>& result)
 {
-	result.clear();
-	result.reserve(length);
+	size_t surrogates = 0;
+	for (size_t i = 0; i < length; ++i)
+		surrogates += RequiresSurrogates(utf32[i]);
+
+	result.resize(length + surrogates);
+	uint16_t* out = result.data();
+	if (!surrogates) { // the common case, a plain narrowing loop the compiler vectorizes
+		for (size_t i = 0; i < length; ++i)
+			out[i] = uint16_t(utf32[i]);
+		return;
+	}
 	for (size_t i = 0; i < length; ++i) {
 		uint32_t c = utf32[i];
 		if (RequiresSurrogates(c)) {
-			result.push_back(HighSurrogate(c));
-			result.push_back(LowSurrogate(c));
+			*out++ = HighSurrogate(c);
+			*out++ = LowSurrogate(c);
 		} else {
-			result.push_back(c);
+			*out++ = uint16_t(c);
 		}
 	}
 }
@@ -6,10 +6,16 @@
 #include "JNIUtils.h"
 #include "ReadBarcode.h"
 
+#include <algorithm>
 #include <android/bitmap.h>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <exception>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 using namespace ZXing;
 using namespace std::string_literals;
@@ -88,6 +94,8 @@ static Binarizer BinarizerFromString(const std::string& name)
 		return Binarizer::FixedThreshold;
 	} else if (name == "BOOL_CAST") {
 		return Binarizer::BoolCast;
+	} else if (name == "ADAPTIVE") {
+		return Binarizer::Adaptive;
 	} else {
 		throw std::invalid_argument("Invalid binarizer name");
 	}
@@ -119,6 +127,33 @@ static jstring ThrowJavaException(JNIEnv* env, const char* message)
 	return nullptr;
 }
 
+// The class loader of this library, set when the first Pipeline is created. On a natively attached thread (the
+// Pipeline worker) FindClass only sees the system classes, so the ones of this library have to be loaded through it.
+static jobject gClassLoader = nullptr;
+static jmethodID gLoadClass = nullptr;
+
+static void InitClassLoader(JNIEnv* env, jobject thiz)
+{
+	if (gClassLoader)
+		return;
+	jclass cls = env->GetObjectClass(thiz);
+	jobject loader = env->CallObjectMethod(cls, env->GetMethodID(env->FindClass("java/lang/Class"), "getClassLoader",
+																  "()Ljava/lang/ClassLoader;"));
+	gClassLoader = env->NewGlobalRef(loader);
+	gLoadClass = env->GetMethodID(env->FindClass("java/lang/ClassLoader"), "loadClass", "(Ljava/lang/String;)Ljava/lang/Class;");
+}
+
+static jclass FindLibClass(JNIEnv* env, const std::string& name)
+{
+	jclass cls = env->FindClass(name.c_str());
+	if (cls || !gClassLoader)
+		return cls;
+	env->ExceptionClear();
+	auto dotted = name;
+	std::replace(dotted.begin(), dotted.end(), '/', '.');
+	return static_cast<jclass>(env->CallObjectMethod(gClassLoader, gLoadClass, C2JString(env, dotted)));
+}
+
 static jobject CreateAndroidPoint(JNIEnv* env, const PointT<int>& point)
 {
 	jclass cls = env->FindClass("android/graphics/Point");
@@ -128,7 +163,7 @@ static jobject CreateAndroidPoint(JNIEnv* env, const PointT<int>& point)
 
 static jobject CreatePosition(JNIEnv* env, const Position& position)
 {
-	jclass cls = env->FindClass("com/zxingcpp/ZXingCpp$Position");
+	jclass cls = FindLibClass(env, "com/zxingcpp/ZXingCpp$Position");
 	auto constructor = env->GetMethodID(
 		cls, "<init>",
 		"(Landroid/graphics/Point;"
@@ -156,14 +191,14 @@ static jbyteArray CreateByteArray(JNIEnv* env, const std::vector<uint8_t>& byteA
 static jobject CreateEnum(JNIEnv* env, const char* value, const char* type)
 {
 	auto className = "com/zxingcpp/ZXingCpp$"s + type;
-	jclass cls = env->FindClass(className.c_str());
+	jclass cls = FindLibClass(env, className);
 	jfieldID fidCT = env->GetStaticFieldID(cls, value, ("L" + className + ";").c_str());
 	return env->GetStaticObjectField(cls, fidCT);
 }
 
 static jobject CreateError(JNIEnv* env, const Error& error)
 {
-	jclass cls = env->FindClass("com/zxingcpp/ZXingCpp$Error");
+	jclass cls = FindLibClass(env, "com/zxingcpp/ZXingCpp$Error");
 	auto constructor = env->GetMethodID(cls, "<init>", "(Lcom/zxingcpp/ZXingCpp$ErrorType;" "Ljava/lang/String;)V");
 	return env->NewObject(cls, constructor, CreateEnum(env, JavaErrorTypeName(error.type()), "ErrorType"),
 						  C2JString(env, error.msg()));
@@ -171,7 +206,7 @@ static jobject CreateError(JNIEnv* env, const Error& error)
 
 static jobject CreateResult(JNIEnv* env, const Result& result, int time)
 {
-	jclass cls = env->FindClass("com/zxingcpp/ZXingCpp$Result");
+	jclass cls = FindLibClass(env, "com/zxingcpp/ZXingCpp$Result");
 	auto constructor = env->GetMethodID(
 		cls, "<init>",
 		"(Lcom/zxingcpp/ZXingCpp$Format;"
@@ -210,23 +245,34 @@ static jobject CreateResult(JNIEnv* env, const Result& result, int time)
 	);
 }
 
-static jobject Read(JNIEnv *env, ImageView image, const DecodeHints& hints)
+static jobject CreateResultList(JNIEnv* env, const Results& results, int time)
+{
+	auto cls = env->FindClass("java/util/ArrayList");
+	auto list = env->NewObject(cls, env->GetMethodID(cls, "<init>", "()V"));
+	if (!results.empty()) {
+		auto add = env->GetMethodID(cls, "add", "(Ljava/lang/Object;)Z");
+		for (const auto& result: results)
+			env->CallBooleanMethod(list, add, CreateResult(env, result, time));
+	}
+	return list;
+}
+
+template <typename READ>
+static std::pair<Results, int> TimedRead(READ read)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+	auto results = read();
+	auto duration = std::chrono::high_resolution_clock::now() - startTime;
+//	LOGD("time: %4d ms\n", (int)std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+	return {std::move(results), static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count())};
+}
+
+template <typename READ>
+static jobject Read(JNIEnv *env, READ read)
 {
 	try {
-		auto startTime = std::chrono::high_resolution_clock::now();
-		auto results = ReadBarcodes(image, hints);
-		auto duration = std::chrono::high_resolution_clock::now() - startTime;
-//		LOGD("time: %4d ms\n", (int)std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
-		auto time = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-
-		auto cls = env->FindClass("java/util/ArrayList");
-		auto list = env->NewObject(cls, env->GetMethodID(cls, "<init>", "()V"));
-		if (!results.empty()) {
-			auto add = env->GetMethodID(cls, "add", "(Ljava/lang/Object;)Z");
-			for (const auto& result: results)
-				env->CallBooleanMethod(list, add, CreateResult(env, result, time));
-		}
-		return list;
+		auto [results, time] = TimedRead(read);
+		return CreateResultList(env, results, time);
 	} catch (const std::exception& e) {
 		return ThrowJavaException(env, e.what());
 	} catch (...) {
@@ -291,18 +337,61 @@ static DecodeHints CreateDecodeHints(JNIEnv* env, jobject hints)
 		;
 }
 
+static ImageView YBufferView(JNIEnv* env, jobject yBuffer, jint rowStride, jint left, jint top, jint width, jint height,
+							 jint rotation)
+{
+	const uint8_t* pixels = static_cast<uint8_t *>(env->GetDirectBufferAddress(yBuffer));
+
+	return ImageView{pixels + top * rowStride + left, width, height, ImageFormat::Lum, rowStride}.rotated(rotation);
+}
+
 extern "C" JNIEXPORT jobject JNICALL
 Java_com_zxingcpp_ZXingCpp_readYBuffer(
 	JNIEnv *env, jobject thiz, jobject yBuffer, jint rowStride,
 	jint left, jint top, jint width, jint height, jint rotation, jobject hints)
 {
-	const uint8_t* pixels = static_cast<uint8_t *>(env->GetDirectBufferAddress(yBuffer));
+	auto image = YBufferView(env, yBuffer, rowStride, left, top, width, height, rotation);
+	auto decodeHints = CreateDecodeHints(env, hints);
 
-	auto image =
-		ImageView{pixels + top * rowStride + left, width, height, ImageFormat::Lum, rowStride}
-			.rotated(rotation);
+	return Read(env, [&] { return ReadBarcodes(image, decodeHints); });
+}
+
+// The native side of ZXingCpp.Reader: the handle is a BarcodeReader owned by the kotlin object. Keeping it alive
+// between frames saves the DecodeHints conversion (a dozen JNI field lookups) and lets the reader reuse its internal
+// working memory, so a camera analyzer does not allocate per frame inside the library.
+
+static BarcodeReader* ReaderFromHandle(jlong handle)
+{
+	if (!handle)
+		throw std::invalid_argument("Reader is closed");
+	return reinterpret_cast<BarcodeReader*>(handle);
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_zxingcpp_ZXingCpp_createReader(JNIEnv* env, jobject thiz, jobject hints)
+{
+	try {
+		return reinterpret_cast<jlong>(new BarcodeReader(CreateDecodeHints(env, hints)));
+	} catch (const std::exception& e) {
+		ThrowJavaException(env, e.what());
+		return 0;
+	}
+}
 
-	return Read(env, image, CreateDecodeHints(env, hints));
+extern "C" JNIEXPORT void JNICALL
+Java_com_zxingcpp_ZXingCpp_destroyReader(JNIEnv* env, jobject thiz, jlong handle)
+{
+	delete reinterpret_cast<BarcodeReader*>(handle);
+}
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_zxingcpp_ZXingCpp_readYBufferWithReader(
+	JNIEnv *env, jobject thiz, jlong handle, jobject yBuffer, jint rowStride,
+	jint left, jint top, jint width, jint height, jint rotation)
+{
+	auto image = YBufferView(env, yBuffer, rowStride, left, top, width, height, rotation);
+
+	return Read(env, [&] { return ReaderFromHandle(handle)->read(image); });
 }
 
 struct LockedPixels
@@ -348,6 +437,147 @@ Java_com_zxingcpp_ZXingCpp_readBitmap(
 		ImageView{pixels, (int)bmInfo.width, (int)bmInfo.height, fmt, (int)bmInfo.stride}
 			.cropped(left, top, width, height)
 			.rotated(rotation);
+	auto decodeHints = CreateDecodeHints(env, hints);
+
+	return Read(env, [&] { return ReadBarcodes(image, decodeHints); });
+}
+
+// The native side of ZXingCpp.Pipeline: frames are copied into a single slot mailbox and decoded on a worker thread.
+// A frame that is still waiting when the next one arrives is dropped, so the latency does not depend on the camera
+// frame rate: the worker always picks up the most recent frame once it is done with the previous one. The slot is
+// handed over with atomic exchanges, the mutex/condition variable pair is only used to let the idle worker sleep.
+class Pipeline
+{
+	struct Frame
+	{
+		std::vector<uint8_t> pixels;
+		int width = 0, height = 0, rotation = 0;
+	};
+
+	JavaVM* _vm = nullptr;
+	jobject _target = nullptr; // global ref to the kotlin Pipeline object
+	jmethodID _deliver = nullptr;
+	BarcodeReader _reader;
+	std::atomic<Frame*> _mailbox{nullptr};
+	std::atomic<Frame*> _spare{nullptr}; // recycled frame, saves the allocation of the pixel buffer
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	bool _stop = false;
+	std::thread _worker;
+
+	void recycle(Frame* frame)
+	{
+		Frame* expected = nullptr;
+		if (!_spare.compare_exchange_strong(expected, frame))
+			delete frame;
+	}
+
+	void run()
+	{
+		JNIEnv* env = nullptr;
+		_vm->AttachCurrentThread(&env, nullptr);
+		while (true) {
+			{
+				std::unique_lock lock(_mutex);
+				_cv.wait(lock, [this] { return _stop || _mailbox.load() != nullptr; });
+				if (_stop)
+					break;
+			}
+			Frame* frame = _mailbox.exchange(nullptr);
+			if (!frame)
+				continue;
+			try {
+				auto image = ImageView{frame->pixels.data(), frame->width, frame->height, ImageFormat::Lum}.rotated(frame->rotation);
+				auto [results, time] = TimedRead([&] { return _reader.read(image); });
+				recycle(frame);
+				if (env->PushLocalFrame(64) == 0) {
+					env->CallVoidMethod(_target, _deliver, CreateResultList(env, results, time));
+					if (env->ExceptionCheck()) {
+						env->ExceptionDescribe();
+						env->ExceptionClear();
+					}
+					env->PopLocalFrame(nullptr);
+				}
+			} catch (const std::exception& e) {
+				LOGE("Pipeline: %s", e.what());
+			}
+		}
+		_vm->DetachCurrentThread();
+	}
+
+public:
+	Pipeline(JNIEnv* env, jobject target, const DecodeHints& hints) : _reader(hints)
+	{
+		env->GetJavaVM(&_vm);
+		_target = env->NewGlobalRef(target);
+		_deliver = env->GetMethodID(env->GetObjectClass(target), "deliver", "(Ljava/util/List;)V");
+		_worker = std::thread([this] { run(); });
+	}
+
+	~Pipeline()
+	{
+		{
+			std::lock_guard lock(_mutex);
+			_stop = true;
+		}
+		_cv.notify_one();
+		_worker.join();
+		delete _mailbox.load();
+		delete _spare.load();
+
+		JNIEnv* env = nullptr;
+		if (_vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_OK)
+			env->DeleteGlobalRef(_target);
+	}
+
+	// returns false if a frame that had not been picked up by the worker yet was dropped
+	bool submit(const uint8_t* pixels, int rowStride, int width, int height, int rotation)
+	{
+		Frame* frame = _spare.exchange(nullptr);
+		if (!frame)
+			frame = new Frame;
+		frame->pixels.resize(size_t(width) * height);
+		for (int y = 0; y < height; ++y)
+			std::copy_n(pixels + size_t(y) * rowStride, width, frame->pixels.data() + size_t(y) * width);
+		frame->width = width;
+		frame->height = height;
+		frame->rotation = rotation;
+
+		Frame* stale = _mailbox.exchange(frame);
+		if (stale)
+			recycle(stale);
+		{
+			std::lock_guard lock(_mutex); // avoids a lost wakeup between the worker's check and its wait
+		}
+		_cv.notify_one();
+		return stale == nullptr;
+	}
+};
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_zxingcpp_ZXingCpp_createPipeline(JNIEnv* env, jobject thiz, jobject hints, jobject target)
+{
+	try {
+		InitClassLoader(env, thiz);
+		return reinterpret_cast<jlong>(new Pipeline(env, target, CreateDecodeHints(env, hints)));
+	} catch (const std::exception& e) {
+		ThrowJavaException(env, e.what());
+		return 0;
+	}
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_zxingcpp_ZXingCpp_destroyPipeline(JNIEnv* env, jobject thiz, jlong handle)
+{
+	delete reinterpret_cast<Pipeline*>(handle);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_zxingcpp_ZXingCpp_submitYBuffer(
+	JNIEnv* env, jobject thiz, jlong handle, jobject yBuffer, jint rowStride,
+	jint left, jint top, jint width, jint height, jint rotation)
+{
+	const uint8_t* pixels = static_cast<uint8_t *>(env->GetDirectBufferAddress(yBuffer));
 
-	return Read(env, image, CreateDecodeHints(env, hints));
+	return reinterpret_cast<Pipeline*>(handle)->submit(pixels + top * rowStride + left, rowStride, width, height, rotation);
 }
@@ -48,7 +48,7 @@ public object ZXingCpp {
 	}
 
 	public enum class Binarizer {
-		LOCAL_AVERAGE, GLOBAL_HISTOGRAM, FIXED_THRESHOLD, BOOL_CAST
+		LOCAL_AVERAGE, GLOBAL_HISTOGRAM, FIXED_THRESHOLD, BOOL_CAST, ADAPTIVE
 	}
 
 	public enum class EanAddOnSymbol {
@@ -115,10 +115,94 @@ public object ZXingCpp {
 		val time: Int // for development/debug purposes only
 	)
 
-	public fun read(image: ImageProxy, hints: DecodeHints): List<Result> {
+	// A Reader keeps a native decoder alive between calls, which is what a camera analyzer wants: the hints are
+	// converted only once and the library can reuse its working memory instead of allocating it for every frame.
+	// The cropRect passed to read() restricts the decoding to a region of interest (e.g. the part of the image shown
+	// in the viewfinder), only that part is binarized. It is given in image coordinates and clipped to image.cropRect.
+	// A Reader is not thread safe and has to be close()d to release the native resources.
+	public class Reader(public val hints: DecodeHints) : AutoCloseable {
+		private var handle: Long = ZXingCpp.createReader(hints)
+
+		public fun read(image: ImageProxy, cropRect: Rect = image.cropRect): List<Result> {
+			ZXingCpp.checkFormat(image)
+			check(handle != 0L) { "Reader is closed" }
+
+			val roi = Rect(cropRect)
+			if (!roi.intersect(image.cropRect))
+				return listOf()
+
+			return ZXingCpp.readYBufferWithReader(
+				handle,
+				image.planes[0].buffer,
+				image.planes[0].rowStride,
+				roi.left,
+				roi.top,
+				roi.width(),
+				roi.height(),
+				image.imageInfo.rotationDegrees
+			)
+		}
+
+		override fun close() {
+			if (handle != 0L) {
+				ZXingCpp.destroyReader(handle)
+				handle = 0
+			}
+		}
+	}
+
+	// A Pipeline decodes frames on a native worker thread instead of the calling (analyzer) thread. submit() only
+	// copies the Y plane of the (cropped) frame into a single slot mailbox and returns immediately, so the ImageProxy
+	// can be closed right away. If the worker is still busy when the next frame arrives, the waiting frame is dropped
+	// and replaced, i.e. the latency does not depend on the camera frame rate on slow devices. The results of every
+	// decoded frame are passed to onResult on the worker thread. close() stops the worker, it must not be called
+	// from within onResult.
+	public class Pipeline(
+		hints: DecodeHints, private val onResult: (List<Result>) -> Unit
+	) : AutoCloseable {
+		private var handle: Long = ZXingCpp.createPipeline(hints, this)
+
+		// returns false if a previously submitted frame had to be dropped
+		public fun submit(image: ImageProxy, cropRect: Rect = image.cropRect): Boolean {
+			ZXingCpp.checkFormat(image)
+			check(handle != 0L) { "Pipeline is closed" }
+
+			val roi = Rect(cropRect)
+			if (!roi.intersect(image.cropRect))
+				return true
+
+			return ZXingCpp.submitYBuffer(
+				handle,
+				image.planes[0].buffer,
+				image.planes[0].rowStride,
+				roi.left,
+				roi.top,
+				roi.width(),
+				roi.height(),
+				image.imageInfo.rotationDegrees
+			)
+		}
+
+		// called from the native worker thread
+		@Suppress("unused")
+		private fun deliver(results: List<Result>) = onResult(results)
+
+		override fun close() {
+			if (handle != 0L) {
+				ZXingCpp.destroyPipeline(handle)
+				handle = 0
+			}
+		}
+	}
+
+	private fun checkFormat(image: ImageProxy) {
 		check(image.format in supportedYUVFormats) {
 			"Invalid image format: ${image.format}. Must be one of: $supportedYUVFormats"
 		}
+	}
+
+	public fun read(image: ImageProxy, hints: DecodeHints): List<Result> {
+		checkFormat(image)
 
 		return readYBuffer(
 			image.planes[0].buffer,
@@ -147,4 +231,20 @@ public object ZXingCpp {
 	private external fun readBitmap(
 		bitmap: Bitmap, left: Int, top: Int, width: Int, height: Int, rotation: Int, hints: DecodeHints
 	): List<Result>
+
+	private external fun createReader(hints: DecodeHints): Long
+
+	private external fun destroyReader(handle: Long)
+
+	private external fun readYBufferWithReader(
+		handle: Long, yBuffer: ByteBuffer, rowStride: Int, left: Int, top: Int, width: Int, height: Int, rotation: Int
+	): List<Result>
+
+	private external fun createPipeline(hints: DecodeHints, target: Pipeline): Long
+
+	private external fun destroyPipeline(handle: Long)
+
+	private external fun submitYBuffer(
+		handle: Long, yBuffer: ByteBuffer, rowStride: Int, left: Int, top: Int, width: Int, height: Int, rotation: Int
+	): Boolean
 }
@@ -62,13 +62,24 @@ int main(int argc, char** argv)
 
 	zxing_ImageView* iv = zxing_ImageView_new(data, width, height, zxing_ImageFormat_Lum, 0, 0);
 
-	zxing_Results* results = zxing_ReadBarcodes(iv, hints);
+	zxing_BarcodeReader* reader = zxing_BarcodeReader_new(hints);
+	zxing_Results* results = zxing_BarcodeReader_read(reader, iv);
+
+	/* the batch and the free function find the same symbols as the reader */
+	const zxing_ImageView* ivs[2] = {iv, iv};
+	zxing_Results* batch[2];
+	zxing_ReadBarcodesBatch(ivs, 2, hints, batch);
+	for (int i = 0; i < 2; ++i) {
+		if (zxing_Results_size(batch[i]) != zxing_Results_size(results))
+			return 3;
+		zxing_Results_delete(batch[i]);
+	}
 
 	if (results) {
 		for (int i = 0, n = zxing_Results_size(results); i < n; ++i) {
 			const zxing_Result* result = zxing_Results_at(results, i);
 
-			printF("Text       : %s\n", zxing_Result_text(result));
+			printf("Text       : %s\n", zxing_Result_textView(result));
 			printF("Format     : %s\n", zxing_BarcodeFormatToString(zxing_Result_format(result)));
 			printF("Content    : %s\n", zxing_ContentTypeToString(zxing_Result_contentType(result)));
 			printF("Identifier : %s\n", zxing_Result_symbologyIdentifier(result));
@@ -85,6 +96,7 @@ int main(int argc, char** argv)
 		printf("No barcode found\n");
 	}
 
+	zxing_BarcodeReader_delete(reader);
 	zxing_ImageView_delete(iv);
 	zxing_DecodeHints_delete(hints);
 	stbi_image_free(data);
@@ -8,6 +8,8 @@
 
 #include "ReadBarcode.h"
 
+#include <vector>
+
 using namespace ZXing;
 
 char* copy(std::string_view sv)
@@ -205,6 +207,17 @@ bool zxing_Result_isMirrored(const zxing_Result* result)
 	return result->isMirrored();
 }
 
+const uint8_t* zxing_Result_bytesView(const zxing_Result* result, int* len)
+{
+	*len = Size(result->bytes());
+	return result->bytes().data();
+}
+
+const char* zxing_Result_textView(const zxing_Result* result)
+{
+	return result->text().c_str();
+}
+
 /*
  * ZXing/ReadBarcode.h
  */
@@ -243,4 +256,33 @@ const zxing_Result* zxing_Results_at(const zxing_Results* results, int i)
 	return &(*results)[i];
 }
 
+void zxing_ReadBarcodesBatch(const zxing_ImageView* const* ivs, int count, const zxing_DecodeHints* hints,
+							 zxing_Results** results)
+{
+	std::vector<ImageView> views;
+	views.reserve(count);
+	for (int i = 0; i < count; ++i)
+		views.push_back(*ivs[i]);
+
+	auto res = ReadBarcodes(views, *hints);
+	for (int i = 0; i < count; ++i)
+		results[i] = !res[i].empty() ? new Results(std::move(res[i])) : NULL;
+}
+
+zxing_BarcodeReader* zxing_BarcodeReader_new(const zxing_DecodeHints* hints)
+{
+	return new BarcodeReader(*hints);
+}
+
+void zxing_BarcodeReader_delete(zxing_BarcodeReader* reader)
+{
+	delete reader;
+}
+
+zxing_Results* zxing_BarcodeReader_read(zxing_BarcodeReader* reader, const zxing_ImageView* iv)
+{
+	auto res = reader->read(*iv);
+	return !res.empty() ? new Results(std::move(res)) : NULL;
+}
+
 } // extern "C"
@@ -14,12 +14,14 @@
 
 #include "DecodeHints.h"
 #include "ImageView.h"
+#include "ReadBarcode.h"
 #include "Result.h"
 
 typedef ZXing::ImageView zxing_ImageView;
 typedef ZXing::DecodeHints zxing_DecodeHints;
 typedef ZXing::Result zxing_Result;
 typedef ZXing::Results zxing_Results;
+typedef ZXing::BarcodeReader zxing_BarcodeReader;
 
 extern "C"
 {
@@ -29,6 +31,7 @@ typedef struct zxing_ImageView zxing_ImageView;
 typedef struct zxing_DecodeHints zxing_DecodeHints;
 typedef struct zxing_Result zxing_Result;
 typedef struct zxing_Results zxing_Results;
+typedef struct zxing_BarcodeReader zxing_BarcodeReader;
 
 #endif
 
@@ -46,6 +49,11 @@ typedef enum
 	zxing_ImageFormat_XRGB = 0x04010203,
 	zxing_ImageFormat_BGRX = 0x04020100,
 	zxing_ImageFormat_XBGR = 0x04030201,
+	zxing_ImageFormat_NV12 = 0x41000000,
+	zxing_ImageFormat_NV21 = 0x51000000,
+	zxing_ImageFormat_I420 = 0x61000000,
+	zxing_ImageFormat_YUYV = 0x42000000,
+	zxing_ImageFormat_UYVY = 0x42010101,
 } zxing_ImageFormat;
 
 zxing_ImageView* zxing_ImageView_new(const uint8_t* data, int width, int height, zxing_ImageFormat format, int rowStride,
@@ -104,6 +112,7 @@ typedef enum
 	zxing_Binarizer_GlobalHistogram,
 	zxing_Binarizer_FixedThreshold,
 	zxing_Binarizer_BoolCast,
+	zxing_Binarizer_Adaptive,
 } zxing_Binarizer;
 
 typedef enum
@@ -165,6 +174,11 @@ int zxing_Result_orientation(const zxing_Result* result);
 bool zxing_Result_isInverted(const zxing_Result* result);
 bool zxing_Result_isMirrored(const zxing_Result* result);
 
+/* The following accessors return borrowed pointers into the result, they are valid as long as the result is alive and
+ * must not be freed. The text is rendered on first access, i.e. the first call must not happen concurrently. */
+const uint8_t* zxing_Result_bytesView(const zxing_Result* result, int* len);
+const char* zxing_Result_textView(const zxing_Result* result);
+
 /*
  * ZXing/ReadBarcode.h
  */
@@ -178,6 +192,19 @@ void zxing_Results_delete(zxing_Results* results);
 int zxing_Results_size(const zxing_Results* results);
 const zxing_Result* zxing_Results_at(const zxing_Results* results, int i);
 
+/* Reads barcodes from count images, results[i] is set to the results of ivs[i] (NULL if none is found). If the hints
+ * allow for multiple threads, the images are decoded in parallel. */
+void zxing_ReadBarcodesBatch(const zxing_ImageView* const* ivs, int count, const zxing_DecodeHints* hints,
+							 zxing_Results** results);
+
+/* A reader meant to be used repeatedly, e.g. on the frames of a video stream. The hints are copied, the reader graph
+ * and the internal image buffers are set up once and reused by every read call. A reader is not thread-safe, use one
+ * per thread. */
+zxing_BarcodeReader* zxing_BarcodeReader_new(const zxing_DecodeHints* hints);
+void zxing_BarcodeReader_delete(zxing_BarcodeReader* reader);
+
+zxing_Results* zxing_BarcodeReader_read(zxing_BarcodeReader* reader, const zxing_ImageView* iv);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,67 @@
+// Copyright 2026 ZXing authors
+//
+// SPDX-License-Identifier: Apache-2.0
+
+import AVFoundation
+import ZXingCpp
+
+/// Swift concurrency interface over a `ZXIBarcodeScanner`, i.e. a native reader session decoding the frames of a
+/// capture session on a queue of its own, newer frames replacing the ones not yet decoded.
+///
+///     let scanner = BarcodeScanner()
+///     scanner.attach(to: videoDataOutput)
+///     for await results in scanner.results {
+///         print(results.map(\.text))
+///     }
+@available(iOS 13.0, macOS 10.15, *)
+public actor BarcodeScanner {
+    /// The native session, it is the sample buffer delegate of the outputs passed to `attach(to:)`
+    public nonisolated let session: ZXIBarcodeScanner
+
+    /// The results of each decoded frame in which at least one symbol was found. A consumer slower than the decoder
+    /// only gets the newest ones. The sequence ends when `finish()` is called.
+    public nonisolated let results: AsyncStream<[ZXIResult]>
+
+    private let continuation: AsyncStream<[ZXIResult]>.Continuation
+    private let captureQueue = DispatchQueue(label: "com.zxing_cpp.ios.capture")
+
+    public init(hints: ZXIDecodeHints = ZXIDecodeHints()) {
+        let session = ZXIBarcodeScanner(hints: hints)
+        var streamContinuation: AsyncStream<[ZXIResult]>.Continuation?
+        self.results = AsyncStream(bufferingPolicy: .bufferingNewest(1)) { streamContinuation = $0 }
+        let continuation = streamContinuation!
+        self.continuation = continuation
+        self.session = session
+        // decoder errors of single frames are not fatal for the stream, such frames are skipped
+        session.resultHandler = { results, _ in
+            if let results = results {
+                continuation.yield(results)
+            }
+        }
+        continuation.onTermination = { _ in session.resultHandler = nil }
+    }
+
+    /// Deliver the frames of the output to the session. The capture queue only hands the frames over, it is never
+    /// blocked by the decoder.
+    public nonisolated func attach(to output: AVCaptureVideoDataOutput) {
+        output.alwaysDiscardsLateVideoFrames = true
+        output.setSampleBufferDelegate(session, queue: captureQueue)
+    }
+
+    /// The hints used from the next frame on
+    public var hints: ZXIDecodeHints { session.hints }
+
+    public func setHints(_ hints: ZXIDecodeHints) {
+        session.hints = hints
+    }
+
+    /// Number of frames decoded / dropped so far
+    public nonisolated var decodedFrames: Int { Int(session.decodedFrames) }
+    public nonisolated var droppedFrames: Int { Int(session.droppedFrames) }
+
+    /// Stop delivering results and end the `results` sequence
+    public func finish() {
+        session.resultHandler = nil
+        continuation.finish()
+    }
+}
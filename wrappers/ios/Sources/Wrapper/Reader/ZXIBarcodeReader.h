@@ -10,6 +10,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Keep one reader per capture session: it holds the decoder state between calls, so frames can be read at full
+/// frame rate. Because of that state, a reader must not be used from several threads at the same time.
 @interface ZXIBarcodeReader : NSObject
 @property(nonatomic, strong) ZXIDecodeHints *hints;
 
@@ -21,6 +23,8 @@ NS_ASSUME_NONNULL_BEGIN
 -(nullable NSArray<ZXIResult *> *)readCGImage:(nonnull CGImageRef)image
                                 error:(NSError *__autoreleasing  _Nullable *)error;
 
+/// Bi-planar and planar YUV (420v/420f/y420/f420), packed YUV (2vuy/yuvs), gray (L008) and 24/32 bit RGB buffers
+/// (e.g. BGRA, 32ARGB) are read in place, other formats are converted via CoreImage first.
 -(nullable NSArray<ZXIResult *> *)readCVPixelBuffer:(nonnull CVPixelBufferRef)pixelBuffer
                                       error:(NSError *__autoreleasing  _Nullable *)error;
 
@@ -11,6 +11,8 @@
 #import "ZXIPosition+Helper.h"
 #import "ZXIErrors.h"
 
+#import <memory>
+
 using namespace ZXing;
 
 NSString *stringToNSString(const std::string &text) {
@@ -38,7 +40,11 @@ ZXIGTIN *getGTIN(const Result &result) {
 @property (nonatomic, strong) CIContext* ciContext;
 @end
 
-@implementation ZXIBarcodeReader
+@implementation ZXIBarcodeReader {
+    // The core reader is kept between calls, so a capture delegate decoding frame after frame does not set up the
+    // decoder (and its working memory) again each time. It is recreated whenever the (mutable) hints changed.
+    std::unique_ptr<BarcodeReader> _reader;
+}
 
 - (instancetype)init {
     return [self initWithHints: [[ZXIDecodeHints alloc] init]];
@@ -51,35 +57,52 @@ ZXIGTIN *getGTIN(const Result &result) {
     return self;
 }
 
-- (NSArray<ZXIResult *> *)readCVPixelBuffer:(nonnull CVPixelBufferRef)pixelBuffer
-                                      error:(NSError *__autoreleasing _Nullable *)error {
-    OSType pixelFormat = CVPixelBufferGetPixelFormatType(pixelBuffer);
-
-    // We tried to work with all luminance based formats listed in kCVPixelFormatType
-    // but only the following ones seem to be supported on iOS.
+static ImageFormat ImageFormatFromPixelFormat(OSType pixelFormat) {
     switch (pixelFormat) {
+        // planar formats: the view references plane 0, i.e. the Y samples
         case kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange:
         case kCVPixelFormatType_420YpCbCr8BiPlanarFullRange:
-            NSInteger cols = CVPixelBufferGetWidth(pixelBuffer);
-            NSInteger rows = CVPixelBufferGetHeight(pixelBuffer);
-            NSInteger bytesPerRow = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0);
-            CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
-            const uint8_t * bytes = static_cast<const uint8_t *>(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0));
-            ImageView imageView = ImageView(
-                                            static_cast<const uint8_t *>(bytes),
-                                            static_cast<int>(cols),
-                                            static_cast<int>(rows),
-                                            ImageFormat::Lum,
-                                            static_cast<int>(bytesPerRow),
-                                            0);
-            NSArray* results = [self readImageView:imageView error:error];
-            CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
-            return results;
+        case kCVPixelFormatType_420YpCbCr8Planar:
+        case kCVPixelFormatType_420YpCbCr8PlanarFullRange:
+        case kCVPixelFormatType_OneComponent8:
+            return ImageFormat::Lum;
+        case kCVPixelFormatType_422YpCbCr8: return ImageFormat::UYVY;
+        case kCVPixelFormatType_422YpCbCr8_yuvs: return ImageFormat::YUYV;
+        case kCVPixelFormatType_32BGRA: return ImageFormat::BGRX;
+        case kCVPixelFormatType_32ARGB: return ImageFormat::XRGB;
+        case kCVPixelFormatType_32RGBA: return ImageFormat::RGBX;
+        case kCVPixelFormatType_32ABGR: return ImageFormat::XBGR;
+        case kCVPixelFormatType_24RGB: return ImageFormat::RGB;
+        case kCVPixelFormatType_24BGR: return ImageFormat::BGR;
+        default: return ImageFormat::None;
     }
+}
 
-    // If given pixel format is not a supported type with a luminance channel we just use the
-    // default method
-    return [self readCIImage:[[CIImage alloc] initWithCVImageBuffer:pixelBuffer] error:error];
+- (NSArray<ZXIResult *> *)readCVPixelBuffer:(nonnull CVPixelBufferRef)pixelBuffer
+                                      error:(NSError *__autoreleasing _Nullable *)error {
+    ImageFormat format = ImageFormatFromPixelFormat(CVPixelBufferGetPixelFormatType(pixelBuffer));
+
+    // If given pixel format is not one the core can read in place we just use the default method (expensive, as it
+    // renders the whole frame via CoreImage)
+    if (format == ImageFormat::None)
+        return [self readCIImage:[[CIImage alloc] initWithCVImageBuffer:pixelBuffer] error:error];
+
+    bool planar = CVPixelBufferIsPlanar(pixelBuffer);
+    NSInteger cols = planar ? CVPixelBufferGetWidthOfPlane(pixelBuffer, 0) : CVPixelBufferGetWidth(pixelBuffer);
+    NSInteger rows = planar ? CVPixelBufferGetHeightOfPlane(pixelBuffer, 0) : CVPixelBufferGetHeight(pixelBuffer);
+    NSInteger bytesPerRow = planar ? CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0) : CVPixelBufferGetBytesPerRow(pixelBuffer);
+
+    CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+    const void * bytes = planar ? CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0) : CVPixelBufferGetBaseAddress(pixelBuffer);
+    ImageView imageView = ImageView(
+                                    static_cast<const uint8_t *>(bytes),
+                                    static_cast<int>(cols),
+                                    static_cast<int>(rows),
+                                    format,
+                                    static_cast<int>(bytesPerRow));
+    NSArray* results = [self readImageView:imageView error:error];
+    CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+    return results;
 }
 
 - (NSArray<ZXIResult *> *)readCIImage:(nonnull CIImage *)image
@@ -136,10 +159,21 @@ ZXIGTIN *getGTIN(const Result &result) {
     return resultingHints;
 }
 
+static bool HaveSameSettings(const DecodeHints& a, const DecodeHints& b) {
+    // only the properties set by DecodeHintsFromZXIOptions are relevant
+    return a.tryRotate() == b.tryRotate() && a.tryHarder() == b.tryHarder() && a.tryInvert() == b.tryInvert()
+        && a.tryDownscale() == b.tryDownscale() && a.tryCode39ExtendedMode() == b.tryCode39ExtendedMode()
+        && a.validateCode39CheckSum() == b.validateCode39CheckSum() && a.validateITFCheckSum() == b.validateITFCheckSum()
+        && a.formats() == b.formats() && a.maxNumberOfSymbols() == b.maxNumberOfSymbols();
+}
+
 - (NSArray<ZXIResult*> *)readImageView:(ImageView)imageView
                                  error:(NSError *__autoreleasing _Nullable *)error {
     try {
-        Results results = ReadBarcodes(imageView, [ZXIBarcodeReader DecodeHintsFromZXIOptions:self.hints]);
+        DecodeHints hints = [ZXIBarcodeReader DecodeHintsFromZXIOptions:self.hints];
+        if (!_reader || !HaveSameSettings(_reader->hints(), hints))
+            _reader = std::make_unique<BarcodeReader>(hints);
+        Results results = _reader->read(imageView);
         NSMutableArray* zxiResults = [NSMutableArray array];
         for (auto result: results) {
             [zxiResults addObject:
@@ -0,0 +1,38 @@
+// Copyright 2026 ZXing authors
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#import <Foundation/Foundation.h>
+#import <AVFoundation/AVFoundation.h>
+#import <CoreVideo/CoreVideo.h>
+#import "ZXIResult.h"
+#import "ZXIDecodeHints.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^ZXIScanResultHandler)(NSArray<ZXIResult *> *_Nullable results, NSError *_Nullable error);
+
+/// Decodes the frames of a capture session on a queue of its own, so the capture queue is never blocked by the decoder.
+/// Frames arriving while another one is decoded replace each other: only the newest one is decoded next, the older
+/// ones are dropped. Set the scanner as the sample buffer delegate of an AVCaptureVideoDataOutput or submit the pixel
+/// buffers yourself. All methods may be called from any thread.
+@interface ZXIBarcodeScanner : NSObject <AVCaptureVideoDataOutputSampleBufferDelegate>
+
+/// Used for the next frame decoded. Assign a new object instead of modifying the current one while scanning.
+@property(atomic, strong) ZXIDecodeHints *hints;
+
+/// Called on the decoding queue for each frame in which symbols were found or the decoder failed
+@property(atomic, copy, nullable) ZXIScanResultHandler resultHandler;
+
+/// Number of frames decoded / dropped so far
+@property(atomic, readonly) NSUInteger decodedFrames;
+@property(atomic, readonly) NSUInteger droppedFrames;
+
+-(instancetype)initWithHints:(ZXIDecodeHints*)hints;
+
+/// Queue a frame for decoding, returns immediately. The buffer is retained until it is decoded or dropped.
+-(void)submitPixelBuffer:(nonnull CVPixelBufferRef)pixelBuffer;
+
+@end
+
+NS_ASSUME_NONNULL_END
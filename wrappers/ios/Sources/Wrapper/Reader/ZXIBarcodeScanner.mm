@@ -0,0 +1,107 @@
+// Copyright 2026 ZXing authors
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#import "ZXIBarcodeScanner.h"
+#import "ZXIBarcodeReader.h"
+
+#import <os/lock.h>
+
+@implementation ZXIBarcodeScanner {
+    // only used on _queue, it keeps the decoder state between the frames
+    ZXIBarcodeReader *_reader;
+    dispatch_queue_t _queue;
+    os_unfair_lock _lock;
+    // guarded by _lock: the newest frame not yet decoded, whether a drain block is scheduled / running and the counters
+    CVPixelBufferRef _pending;
+    BOOL _draining;
+    NSUInteger _decodedFrames;
+    NSUInteger _droppedFrames;
+}
+
+- (instancetype)init {
+    return [self initWithHints: [[ZXIDecodeHints alloc] init]];
+}
+
+- (instancetype)initWithHints:(ZXIDecodeHints*)hints {
+    self = [super init];
+    self.hints = hints;
+    _reader = [[ZXIBarcodeReader alloc] initWithHints:hints];
+    dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0);
+    _queue = dispatch_queue_create("com.zxing_cpp.ios.scanner", attr);
+    _lock = OS_UNFAIR_LOCK_INIT;
+    return self;
+}
+
+- (void)dealloc {
+    if (_pending)
+        CVPixelBufferRelease(_pending);
+}
+
+- (NSUInteger)decodedFrames {
+    os_unfair_lock_lock(&_lock);
+    NSUInteger res = _decodedFrames;
+    os_unfair_lock_unlock(&_lock);
+    return res;
+}
+
+- (NSUInteger)droppedFrames {
+    os_unfair_lock_lock(&_lock);
+    NSUInteger res = _droppedFrames;
+    os_unfair_lock_unlock(&_lock);
+    return res;
+}
+
+- (void)submitPixelBuffer:(nonnull CVPixelBufferRef)pixelBuffer {
+    CVPixelBufferRetain(pixelBuffer);
+    os_unfair_lock_lock(&_lock);
+    CVPixelBufferRef dropped = _pending;
+    _pending = pixelBuffer;
+    BOOL schedule = !_draining;
+    _draining = YES;
+    if (dropped)
+        ++_droppedFrames;
+    os_unfair_lock_unlock(&_lock);
+
+    if (dropped)
+        CVPixelBufferRelease(dropped);
+    if (schedule)
+        dispatch_async(_queue, ^{ [self drain]; });
+}
+
+- (void)drain {
+    for (;;) {
+        os_unfair_lock_lock(&_lock);
+        CVPixelBufferRef pixelBuffer = _pending;
+        _pending = NULL;
+        if (!pixelBuffer)
+            _draining = NO;
+        os_unfair_lock_unlock(&_lock);
+        if (!pixelBuffer)
+            return;
+
+        @autoreleasepool {
+            _reader.hints = self.hints;
+            NSError *error = nil;
+            NSArray<ZXIResult *> *results = [_reader readCVPixelBuffer:pixelBuffer error:&error];
+            CVPixelBufferRelease(pixelBuffer);
+            os_unfair_lock_lock(&_lock);
+            ++_decodedFrames;
+            os_unfair_lock_unlock(&_lock);
+
+            ZXIScanResultHandler handler = self.resultHandler;
+            if (handler && (results.count || error))
+                handler(results, error);
+        }
+    }
+}
+
+- (void)captureOutput:(AVCaptureOutput *)output
+    didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer
+           fromConnection:(AVCaptureConnection *)connection {
+    CVImageBufferRef pixelBuffer = CMSampleBufferGetImageBuffer(sampleBuffer);
+    if (pixelBuffer)
+        [self submitPixelBuffer:pixelBuffer];
+}
+
+@end
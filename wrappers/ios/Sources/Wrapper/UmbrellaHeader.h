@@ -6,6 +6,7 @@
 #define UmbrellaHeader_h
 
 #import "Reader/ZXIBarcodeReader.h"
+#import "Reader/ZXIBarcodeScanner.h"
 #import "Reader/ZXIResult.h"
 #import "Reader/ZXIPosition.h"
 #import "Reader/ZXIPoint.h"
@@ -60,6 +60,87 @@ class TestReadWrite(unittest.TestCase):
 		res = zxingcpp.read_barcodes(img)[0]
 		self.check_res(res, format, text)
 
+	def test_write_read_reader(self):
+		format = BF.QRCode
+		reader = zxingcpp.BarcodeReader(formats=format, track_symbols=True)
+		for text in ["I have the best words.", "I have the best readers."]:
+			res = reader.read(zxingcpp.write_barcode(format, text))
+			self.assertEqual(len(res), 1)
+			self.check_res(res[0], format, text)
+
+		self.assertEqual(reader.read(self.zeroes((100, 100))), [])
+
+	def test_write_read_async(self):
+		import asyncio
+		format = BF.QRCode
+		texts = ["I have the best words.", "I have the best futures."]
+
+		async def read_all():
+			imgs = [zxingcpp.write_barcode(format, text) for text in texts]
+			return await asyncio.gather(*[zxingcpp.read_barcodes_async(img) for img in imgs])
+
+		res = asyncio.run(read_all())
+		for r, text in zip(res, texts):
+			self.assertEqual(len(r), 1)
+			self.check_res(r[0], format, text)
+
+		self.assertRaises(RuntimeError, zxingcpp.read_barcodes_async, zxingcpp.write_barcode(format, texts[0]))
+
+	def test_write_read_batch(self):
+		format = BF.QRCode
+		texts = ["I have the best words.", "I have the best batches."]
+		imgs = [zxingcpp.write_barcode(format, text) for text in texts]
+
+		res = zxingcpp.read_barcodes_batch(imgs + [self.zeroes((100, 100))])
+		self.assertEqual(len(res), 3)
+		for r, text in zip(res, texts):
+			self.assertEqual(len(r), 1)
+			self.check_res(r[0], format, text)
+		self.assertEqual(res[2], [])
+
+	@unittest.skipIf(not has_numpy, "need numpy for read/write tests")
+	def test_write_read_batch_numpy(self):
+		import numpy as np
+		format = BF.QRCode
+		texts = ["I have the best words.", "I have the best batches.", "I have the best frames."]
+		imgs = np.stack([np.array(zxingcpp.write_barcode(format, text, width=100, height=100)) for text in texts])
+
+		res = zxingcpp.read_barcodes_batch(imgs[..., np.newaxis], threads=2)
+		self.assertEqual([r[0].text for r in res], texts)
+
+		self.assertRaisesRegex(
+			TypeError, "Incompatible buffer dimension", zxingcpp.read_barcodes_batch, imgs
+		)
+
+	def test_write_barcodes_read_batch(self):
+		format = BF.QRCode
+		texts = ["I have the best words.", "I have the best batches, the very best batches.", "I"]
+		batch = zxingcpp.write_barcodes(texts, format, threads=2)
+		self.assertEqual(len(batch), 3)
+		self.assertEqual(batch.shape[1:], zxingcpp.write_barcode(format, texts[1]).shape)
+
+		data = memoryview(batch)
+		self.assertEqual(data.shape, batch.shape)
+		self.assertTrue(data.readonly)
+		size = batch.shape[1] * batch.shape[2]
+		frames = [data.tobytes()[i * size:(i + 1) * size] for i in range(len(batch))]
+		res = zxingcpp.read_barcodes_batch([memoryview(f).cast("B", shape=batch.shape[1:]) for f in frames])
+		self.assertEqual([r[0].text for r in res], texts)
+
+		self.assertRaises(ValueError, zxingcpp.write_barcodes, ["1234", "x"], BF.EAN13)
+
+	@unittest.skipIf(not has_numpy, "need numpy for read/write tests")
+	def test_write_barcodes_numpy(self):
+		import numpy as np
+		texts = ["I have the best words.", "I have the best frames."]
+		batch = zxingcpp.write_barcodes(texts, BF.QRCode, width=100, height=100)
+		imgs = np.asarray(batch)
+		self.assertEqual(imgs.shape, (2, 100, 100))
+		self.assertFalse(imgs.flags.writeable)
+
+		res = zxingcpp.read_barcodes_batch(imgs[..., np.newaxis])
+		self.assertEqual([r[0].text for r in res], texts)
+
 	@staticmethod
 	def zeroes(shape):
 		return memoryview(b"0" * math.prod(shape)).cast("B", shape=shape)
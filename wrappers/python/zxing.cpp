@@ -13,15 +13,24 @@
 
 // Writer
 #include "BitMatrix.h"
+#include "Executor.h"
 #include "Matrix.h"
 #include "MultiFormatWriter.h"
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <optional>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 using namespace ZXing;
@@ -36,11 +45,10 @@ std::ostream& operator<<(std::ostream& os, const Position& points) {
 	return os;
 }
 
-auto read_barcodes_impl(py::object _image, const BarcodeFormats& formats, bool try_rotate, bool try_downscale, TextMode text_mode,
-						Binarizer binarizer, bool is_pure, EanAddOnSymbol ean_add_on_symbol, bool return_errors,
-						uint8_t max_number_of_symbols = 0xff)
+DecodeHints make_hints(const BarcodeFormats& formats, bool try_rotate, bool try_downscale, TextMode text_mode, Binarizer binarizer,
+					   bool is_pure, EanAddOnSymbol ean_add_on_symbol, bool return_errors, uint8_t max_number_of_symbols = 0xff)
 {
-	const auto hints = DecodeHints()
+	return DecodeHints()
 		.setFormats(formats)
 		.setTryRotate(try_rotate)
 		.setTryDownscale(try_downscale)
@@ -50,6 +58,18 @@ auto read_barcodes_impl(py::object _image, const BarcodeFormats& formats, bool t
 		.setMaxNumberOfSymbols(max_number_of_symbols)
 		.setEanAddOnSymbol(ean_add_on_symbol)
 		.setReturnErrors(return_errors);
+}
+
+// The uint8_t buffer of an image, it keeps the python object (e.g. a converted PIL image) alive as long as it is in use
+struct ImageBuffer
+{
+	py::object image;
+	py::buffer_info info;
+	ImageFormat format = ImageFormat::None; // known from the object (PIL) or derived from the number of channels
+};
+
+ImageBuffer request_buffer(py::object _image)
+{
 	const auto _type = std::string(py::str(py::type::of(_image)));
 	py::buffer buffer;
 	ImageFormat imgfmt = ImageFormat::None;
@@ -123,12 +143,18 @@ auto read_barcodes_impl(py::object _image, const BarcodeFormats& formats, bool t
 	if (info.format != py::format_descriptor<uint8_t>::format())
 		throw py::type_error("Incompatible buffer format: expected a uint8_t array.");
 
-	if (info.ndim != 2 && info.ndim != 3)
+	return {_image, std::move(info), imgfmt};
+}
+
+// A view of one image of height x width x channels pixels (shape has 2 or 3 elements), rows and pixels are contiguous
+ImageView image_view(const uint8_t* bytes, int ndim, const py::ssize_t* shape, ImageFormat imgfmt)
+{
+	if (ndim != 2 && ndim != 3)
 		throw py::type_error("Incompatible buffer dimension (needs to be 2 or 3).");
 
-	const auto height = narrow_cast<int>(info.shape[0]);
-	const auto width = narrow_cast<int>(info.shape[1]);
-	const auto channels = info.ndim == 2 ? 1 : narrow_cast<int>(info.shape[2]);
+	const auto height = narrow_cast<int>(shape[0]);
+	const auto width = narrow_cast<int>(shape[1]);
+	const auto channels = ndim == 2 ? 1 : narrow_cast<int>(shape[2]);
 	if (imgfmt == ImageFormat::None) {
 		// Assume grayscale or BGR image depending on channels number
 		if (channels == 1)
@@ -139,10 +165,21 @@ auto read_barcodes_impl(py::object _image, const BarcodeFormats& formats, bool t
 			throw py::value_error("Unsupported number of channels for buffer: " + std::to_string(channels));
 	}
 
-	const auto bytes = static_cast<uint8_t*>(info.ptr);
+	return {bytes, width, height, imgfmt, width * channels, channels};
+}
+
+auto read_barcodes_impl(py::object _image, const BarcodeFormats& formats, bool try_rotate, bool try_downscale, TextMode text_mode,
+						Binarizer binarizer, bool is_pure, EanAddOnSymbol ean_add_on_symbol, bool return_errors,
+						uint8_t max_number_of_symbols = 0xff)
+{
+	const auto hints = make_hints(formats, try_rotate, try_downscale, text_mode, binarizer, is_pure, ean_add_on_symbol,
+								  return_errors, max_number_of_symbols);
+	const auto buffer = request_buffer(_image);
+	const auto iv = image_view(static_cast<const uint8_t*>(buffer.info.ptr), narrow_cast<int>(buffer.info.ndim),
+							   buffer.info.shape.data(), buffer.format);
 	// Disables the GIL during zxing processing (restored automatically upon completion)
 	py::gil_scoped_release release;
-	return ReadBarcodes({bytes, width, height, imgfmt, width * channels, channels}, hints);
+	return ReadBarcodes(iv, hints);
 }
 
 std::optional<Result> read_barcode(py::object _image, const BarcodeFormats& formats, bool try_rotate, bool try_downscale,
@@ -161,6 +198,165 @@ Results read_barcodes(py::object _image, const BarcodeFormats& formats, bool try
 							  return_errors);
 }
 
+std::vector<Results> read_barcodes_batch(py::object _images, const BarcodeFormats& formats, bool try_rotate, bool try_downscale,
+										 TextMode text_mode, Binarizer binarizer, bool is_pure, EanAddOnSymbol ean_add_on_symbol,
+										 bool return_errors, uint8_t threads)
+{
+	const auto hints = make_hints(formats, try_rotate, try_downscale, text_mode, binarizer, is_pure, ean_add_on_symbol,
+								  return_errors).setThreads(threads);
+
+	std::vector<ImageBuffer> buffers;
+	std::vector<ImageView> ivs;
+	if (py::isinstance<py::list>(_images) || py::isinstance<py::tuple>(_images)) {
+		for (auto image : _images)
+			buffers.push_back(request_buffer(py::reinterpret_borrow<py::object>(image)));
+		for (const auto& buffer : buffers)
+			ivs.push_back(image_view(static_cast<const uint8_t*>(buffer.info.ptr), narrow_cast<int>(buffer.info.ndim),
+									 buffer.info.shape.data(), buffer.format));
+	} else {
+		// a single array of N frames of height x width x channels pixels
+		const auto& buffer = buffers.emplace_back(request_buffer(_images));
+		if (buffer.info.ndim != 4)
+			throw py::type_error("Incompatible buffer dimension (needs to be 4 for a batch of images).");
+		for (py::ssize_t i = 0; i < buffer.info.shape[0]; ++i)
+			ivs.push_back(image_view(static_cast<const uint8_t*>(buffer.info.ptr) + i * buffer.info.strides[0], 3,
+									 buffer.info.shape.data() + 1, buffer.format));
+	}
+
+	// Disables the GIL once for the whole batch, the images are decoded in parallel by the library
+	py::gil_scoped_release release;
+	return ReadBarcodes(ivs, hints);
+}
+
+// The worker threads the *_async functions decode on, so neither the event loop nor any other python thread is blocked
+class AsyncPool
+{
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	std::deque<std::function<void()>> _tasks;
+	std::vector<std::thread> _threads;
+	bool _stop = false;
+
+public:
+	explicit AsyncPool(int threads)
+	{
+		for (int i = 0; i < threads; ++i)
+			_threads.emplace_back([this] {
+				while (true) {
+					std::function<void()> task;
+					{
+						std::unique_lock lock(_mutex);
+						_cv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+						if (_stop)
+							return;
+						task = std::move(_tasks.front());
+						_tasks.pop_front();
+					}
+					task();
+				}
+			});
+	}
+
+	void post(std::function<void()> task)
+	{
+		{
+			std::lock_guard lock(_mutex);
+			if (_stop)
+				throw std::runtime_error("zxingcpp is shutting down");
+			_tasks.push_back(std::move(task));
+		}
+		_cv.notify_one();
+	}
+
+	// Called at interpreter exit with the GIL held: the running tasks are finished, the queued ones are dropped
+	void shutdown()
+	{
+		std::deque<std::function<void()>> dropped;
+		{
+			std::lock_guard lock(_mutex);
+			_stop = true;
+			std::swap(dropped, _tasks);
+		}
+		_cv.notify_all();
+		{
+			// the running tasks need the GIL to complete their futures
+			py::gil_scoped_release release;
+			for (auto& thread : _threads)
+				thread.join();
+		}
+		_threads.clear();
+		// dropped is destroyed here, i.e. the python objects of the queued tasks are released while holding the GIL
+	}
+
+	static AsyncPool& instance()
+	{
+		// intentionally leaked, the threads are joined by shutdown() which is registered with atexit
+		static auto pool = new AsyncPool(std::max(1u, std::thread::hardware_concurrency()));
+		return *pool;
+	}
+};
+
+// Completes an asyncio future, called on the thread of its event loop (see call_soon_threadsafe)
+void complete_future(py::object future, py::object result, py::object exception)
+{
+	if (future.attr("done")().cast<bool>()) // e.g. cancelled
+		return;
+	if (exception.is_none())
+		future.attr("set_result")(result);
+	else
+		future.attr("set_exception")(exception);
+}
+
+py::object read_barcodes_async(py::object _image, const BarcodeFormats& formats, bool try_rotate, bool try_downscale,
+							   TextMode text_mode, Binarizer binarizer, bool is_pure, EanAddOnSymbol ean_add_on_symbol,
+							   bool return_errors)
+{
+	// the image buffer is pinned (not copied) until the decoding is done
+	struct Job
+	{
+		ImageBuffer buffer;
+		DecodeHints hints;
+		py::object loop, future;
+	};
+
+	auto loop = py::module_::import("asyncio").attr("get_running_loop")();
+	auto future = loop.attr("create_future")();
+	auto job = std::make_shared<Job>(Job{request_buffer(_image),
+										 make_hints(formats, try_rotate, try_downscale, text_mode, binarizer, is_pure,
+													ean_add_on_symbol, return_errors),
+										 loop, future});
+	// check the image on the calling thread, so that errors are raised directly
+	image_view(static_cast<const uint8_t*>(job->buffer.info.ptr), narrow_cast<int>(job->buffer.info.ndim),
+			   job->buffer.info.shape.data(), job->buffer.format);
+
+	AsyncPool::instance().post([job]() mutable {
+		Results results;
+		std::string error;
+		try {
+			const auto& info = job->buffer.info;
+			results = ReadBarcodes(image_view(static_cast<const uint8_t*>(info.ptr), narrow_cast<int>(info.ndim),
+											  info.shape.data(), job->buffer.format),
+								   job->hints);
+		} catch (const std::exception& e) {
+			error = e.what();
+		}
+
+		py::gil_scoped_acquire acquire;
+		try {
+			py::object exception = py::none();
+			if (!error.empty())
+				exception = py::module_::import("builtins").attr("RuntimeError")(error);
+			job->loop.attr("call_soon_threadsafe")(py::cpp_function(&complete_future), job->future, py::cast(std::move(results)),
+												   exception);
+		} catch (py::error_already_set&) {
+			// the event loop has been closed in the meantime, nobody is waiting for the result anymore
+		}
+		job.reset(); // release the python objects while holding the GIL
+	});
+
+	return future;
+}
+
 Matrix<uint8_t> write_barcode(BarcodeFormat format, std::string text, int width, int height, int quiet_zone, int ec_level)
 {
 	auto writer = MultiFormatWriter(format).setEncoding(CharacterSet::UTF8).setMargin(quiet_zone).setEccLevel(ec_level);
@@ -168,6 +364,54 @@ Matrix<uint8_t> write_barcode(BarcodeFormat format, std::string text, int width,
 	return ToMatrix<uint8_t>(bitmap);
 }
 
+// The symbols of write_barcodes stacked into one contiguous count x height x width buffer of 8-bit grayscale pixels
+struct BitmapBatch
+{
+	std::vector<uint8_t> data;
+	int count = 0, height = 0, width = 0;
+};
+
+BitmapBatch write_barcodes(const std::vector<std::string>& texts, BarcodeFormat format, int width, int height, int quiet_zone,
+						   int ec_level, uint8_t threads)
+{
+	// Disables the GIL once for the whole batch, the texts have been converted already
+	py::gil_scoped_release release;
+
+	auto writer = MultiFormatWriter(format).setEncoding(CharacterSet::UTF8).setMargin(quiet_zone).setEccLevel(ec_level);
+	auto executor = SelectExecutor(DecodeHints().setThreads(threads));
+	std::vector<BitMatrix> symbols;
+	writer.encodeBatch(texts, width, height, symbols, executor.get());
+
+	BitmapBatch batch;
+	batch.count = Size(symbols);
+	for (const auto& symbol : symbols) {
+		batch.height = std::max(batch.height, symbol.height());
+		batch.width = std::max(batch.width, symbol.width());
+	}
+
+	// a symbol larger than requested makes all others grow, they are centered on white (like the quiet zone)
+	const size_t frameSize = size_t(batch.height) * batch.width;
+	batch.data.resize(frameSize * batch.count);
+	auto render = [&](int i) {
+		const auto& symbol = symbols[i];
+		uint8_t* frame = batch.data.data() + frameSize * i;
+		std::memset(frame, 0xff, frameSize);
+		const int left = (batch.width - symbol.width()) / 2, top = (batch.height - symbol.height()) / 2;
+		for (int y = 0; y < symbol.height(); ++y) {
+			uint8_t* dst = frame + size_t(top + y) * batch.width + left;
+			for (int x = 0; x < symbol.width(); ++x)
+				dst[x] = symbol.get(x, y) ? 0 : 0xff;
+		}
+	};
+	if (executor && executor->concurrency() > 1)
+		executor->parallelFor(batch.count, render);
+	else
+		for (int i = 0; i < batch.count; ++i)
+			render(i);
+
+	return batch;
+}
+
 
 PYBIND11_MODULE(zxingcpp, m)
 {
@@ -210,6 +454,7 @@ PYBIND11_MODULE(zxingcpp, m)
 		.def(py::init<BarcodeFormat>());
 	py::implicitly_convertible<BarcodeFormat, BarcodeFormats>();
 	py::enum_<Binarizer>(m, "Binarizer", "Enumeration of binarizers used before decoding images")
+		.value("Adaptive", Binarizer::Adaptive)
 		.value("BoolCast", Binarizer::BoolCast)
 		.value("FixedThreshold", Binarizer::FixedThreshold)
 		.value("GlobalHistogram", Binarizer::GlobalHistogram)
@@ -404,6 +649,98 @@ PYBIND11_MODULE(zxingcpp, m)
 		":rtype: zxing.Result\n"
 		":return: a list of zxing results containing decoded symbols, the list is empty if none is found"
 	);
+	m.def("read_barcodes_async", &read_barcodes_async,
+		py::arg("image"),
+		py::arg("formats") = BarcodeFormats{},
+		py::arg("try_rotate") = true,
+		py::arg("try_downscale") = true,
+		py::arg("text_mode") = TextMode::HRI,
+		py::arg("binarizer") = Binarizer::LocalAverage,
+		py::arg("is_pure") = false,
+		py::arg("ean_add_on_symbol") = EanAddOnSymbol::Ignore,
+		py::arg("return_errors") = false,
+		"Read (decode) multiple barcodes from an image without blocking the running asyncio event loop.\n\n"
+		"The image is decoded on an internal pool of native threads (one per core) and must not be modified until the\n"
+		"returned future is done, it is referenced and not copied. The parameters are the same as for ``read_barcodes``.\n\n"
+		":rtype: asyncio.Future\n"
+		":return: a future of the list of zxing results, it needs to be awaited from within the running event loop"
+	);
+	m.def("read_barcodes_batch", &read_barcodes_batch,
+		py::arg("images"),
+		py::arg("formats") = BarcodeFormats{},
+		py::arg("try_rotate") = true,
+		py::arg("try_downscale") = true,
+		py::arg("text_mode") = TextMode::HRI,
+		py::arg("binarizer") = Binarizer::LocalAverage,
+		py::arg("is_pure") = false,
+		py::arg("ean_add_on_symbol") = EanAddOnSymbol::Ignore,
+		py::arg("return_errors") = false,
+		py::arg("threads") = 0,
+		"Read (decode) multiple barcodes from each image of a batch of images.\n\n"
+		"The GIL is released once for the whole batch and the images are decoded in parallel.\n\n"
+		":type images: list|tuple|numpy.ndarray\n"
+		":param images: The images to decode. This can be either:\n"
+		"  - a list or tuple of images, each one of the types supported by ``read_barcodes``\n"
+		"  - a 4D numpy array of N BGR or grayscale images (shape N x height x width x channels)\n"
+		":type formats: zxing.BarcodeFormat|zxing.BarcodeFormats\n"
+		":param formats: the format(s) to decode. If ``None``, decode all formats.\n"
+		":type try_rotate: bool\n"
+		":param try_rotate: see ``read_barcodes``\n"
+		":type try_downscale: bool\n"
+		":param try_downscale: see ``read_barcodes``\n"
+		":type text_mode: zxing.TextMode\n"
+		":param text_mode: see ``read_barcodes``\n"
+		":type binarizer: zxing.Binarizer\n"
+		":param binarizer: see ``read_barcodes``\n"
+		":type is_pure: bool\n"
+		":param is_pure: see ``read_barcodes``\n"
+		":type ean_add_on_symbol: zxing.EanAddOnSymbol\n"
+		":param ean_add_on_symbol: see ``read_barcodes``\n"
+		":type return_errors: bool\n"
+		":param return_errors: see ``read_barcodes``\n"
+		":type threads: int\n"
+		":param threads: the number of threads used to decode the images. Default is 0, i.e. all cores.\n"
+		":rtype: list[list[zxing.Result]]\n"
+		":return: a list with the list of results of each image, in the same order as the images"
+	);
+	py::class_<BarcodeReader>(m, "BarcodeReader",
+		"Reader meant to be used repeatedly, e.g. on the frames of a video stream.\n\n"
+		"The hints and the reader graph are set up once and the internal image buffers are recycled between calls.\n"
+		"An instance is not thread-safe, use one per thread.")
+		.def(py::init([](const BarcodeFormats& formats, bool try_rotate, bool try_downscale, TextMode text_mode,
+						 Binarizer binarizer, bool is_pure, EanAddOnSymbol ean_add_on_symbol, bool return_errors,
+						 bool track_symbols) {
+				 return std::make_unique<BarcodeReader>(make_hints(formats, try_rotate, try_downscale, text_mode, binarizer,
+																   is_pure, ean_add_on_symbol, return_errors)
+															.setTrackSymbols(track_symbols));
+			 }),
+			py::arg("formats") = BarcodeFormats{},
+			py::arg("try_rotate") = true,
+			py::arg("try_downscale") = true,
+			py::arg("text_mode") = TextMode::HRI,
+			py::arg("binarizer") = Binarizer::LocalAverage,
+			py::arg("is_pure") = false,
+			py::arg("ean_add_on_symbol") = EanAddOnSymbol::Ignore,
+			py::arg("return_errors") = false,
+			py::arg("track_symbols") = false,
+			"Create a reader, the parameters are the same as for ``read_barcodes``.\n\n"
+			":type track_symbols: bool\n"
+			":param track_symbols: if ``True``, the symbols found in the last image are looked for at their previous\n"
+			"  position first. Default is False.")
+		.def("read",
+			[](BarcodeReader& reader, py::object image) {
+				const auto buffer = request_buffer(image);
+				const auto iv = image_view(static_cast<const uint8_t*>(buffer.info.ptr), narrow_cast<int>(buffer.info.ndim),
+										   buffer.info.shape.data(), buffer.format);
+				py::gil_scoped_release release;
+				return reader.read(iv);
+			},
+			py::arg("image"),
+			"Read (decode) multiple barcodes from an image, see ``read_barcodes`` for the supported image types.\n\n"
+			":rtype: list[zxing.Result]\n"
+			":return: a list of zxing results containing decoded symbols, the list is empty if none is found");
+	py::module_::import("atexit").attr("register")(py::cpp_function([] { AsyncPool::instance().shutdown(); }));
+
 	py::class_<Matrix<uint8_t>>(m, "Bitmap", py::buffer_protocol())
 		.def_property_readonly(
 			"__array_interface__",
@@ -423,6 +760,22 @@ PYBIND11_MODULE(zxingcpp, m)
 			};
 		});
 
+	// only the buffer protocol, an __array_interface__ like the one of Bitmap would copy the whole batch
+	py::class_<BitmapBatch>(m, "BitmapBatch", py::buffer_protocol())
+		.def_property_readonly("shape", [](const BitmapBatch& b) { return py::make_tuple(b.count, b.height, b.width); })
+		.def("__len__", [](const BitmapBatch& b) { return b.count; })
+		.def_buffer([](const BitmapBatch& b) -> py::buffer_info {
+			return {
+				const_cast<uint8_t*>(b.data.data()),
+				sizeof(uint8_t),
+				py::format_descriptor<uint8_t>::format(),
+				3,
+				{b.count, b.height, b.width},
+				{sizeof(uint8_t) * b.height * b.width, sizeof(uint8_t) * b.width, sizeof(uint8_t)},
+				true // read-only
+			};
+		});
+
 	m.def("write_barcode", &write_barcode,
 		py::arg("format"),
 		py::arg("text"),
@@ -448,4 +801,32 @@ PYBIND11_MODULE(zxingcpp, m)
 		":param ec_level: error correction level of the barcode (Used for Aztec, PDF417, and QRCode only).\n"
 		":rtype: zxing.Bitmap\n"
 	);
+	m.def("write_barcodes", &write_barcodes,
+		py::arg("texts"),
+		py::arg("format"),
+		py::arg("width") = 0,
+		py::arg("height") = 0,
+		py::arg("quiet_zone") = -1,
+		py::arg("ec_level") = -1,
+		py::arg("threads") = 0,
+		"Write (encode) a list of texts into barcodes of the same format and return them as one stacked buffer\n\n"
+		"The GIL is released once for the whole batch and the symbols are encoded in parallel. The result is a single\n"
+		"contiguous count x height x width 8-bit grayscale buffer, e.g. ``numpy.asarray(batch)[i]`` is a view of the\n"
+		"i-th symbol without a copy. All symbols have the size of the largest one, smaller ones are centered on white.\n\n"
+		":type texts: list[str]\n"
+		":param texts: the texts of the barcodes\n"
+		":type format: zxing.BarcodeFormat\n"
+		":param format: format of the barcodes to create\n"
+		":type width: int\n"
+		":param width: see ``write_barcode``\n"
+		":type height: int\n"
+		":param height: see ``write_barcode``\n"
+		":type quiet_zone: int\n"
+		":param quiet_zone: see ``write_barcode``\n"
+		":type ec_level: int\n"
+		":param ec_level: see ``write_barcode``\n"
+		":type threads: int\n"
+		":param threads: the number of threads used to encode the texts. Default is 0, i.e. all cores.\n"
+		":rtype: zxing.BitmapBatch\n"
+	);
 }
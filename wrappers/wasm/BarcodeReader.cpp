@@ -11,6 +11,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -27,38 +28,45 @@ struct ReadResult
 	std::string symbologyIdentifier{};
 };
 
+static DecodeHints MakeHints(bool tryHarder, const std::string& format, int maxSymbols)
+{
+	DecodeHints hints;
+	hints.setTryHarder(tryHarder);
+	hints.setTryRotate(tryHarder);
+	hints.setTryInvert(tryHarder);
+	hints.setTryDownscale(tryHarder);
+	hints.setFormats(BarcodeFormatsFromString(format));
+	hints.setMaxNumberOfSymbols(maxSymbols);
+//	hints.setReturnErrors(maxSymbols > 1);
+	return hints;
+}
+
+static std::vector<ReadResult> ToReadResults(const Results& results)
+{
+	std::vector<ReadResult> readResults{};
+	readResults.reserve(results.size());
+
+	thread_local const emscripten::val Uint8Array = emscripten::val::global("Uint8Array");
+
+	for (auto&& result : results) {
+		const ByteArray& bytes = result.bytes();
+		readResults.push_back({
+			ToString(result.format()),
+			result.text(),
+			Uint8Array.new_(emscripten::typed_memory_view(bytes.size(), bytes.data())),
+			ToString(result.error()),
+			result.position(),
+			result.symbologyIdentifier()
+		});
+	}
+
+	return readResults;
+}
+
 std::vector<ReadResult> readBarcodes(ImageView iv, bool tryHarder, const std::string& format, int maxSymbols)
 {
 	try {
-		DecodeHints hints;
-		hints.setTryHarder(tryHarder);
-		hints.setTryRotate(tryHarder);
-		hints.setTryInvert(tryHarder);
-		hints.setTryDownscale(tryHarder);
-		hints.setFormats(BarcodeFormatsFromString(format));
-		hints.setMaxNumberOfSymbols(maxSymbols);
-//		hints.setReturnErrors(maxSymbols > 1);
-
-		auto results = ReadBarcodes(iv, hints);
-
-		std::vector<ReadResult> readResults{};
-		readResults.reserve(results.size());
-
-		thread_local const emscripten::val Uint8Array = emscripten::val::global("Uint8Array");
-
-		for (auto&& result : results) {
-			const ByteArray& bytes = result.bytes();
-			readResults.push_back({
-				ToString(result.format()),
-				result.text(),
-				Uint8Array.new_(emscripten::typed_memory_view(bytes.size(), bytes.data())),
-				ToString(result.error()),
-				result.position(),
-				result.symbologyIdentifier()
-			});
-		}
-
-		return readResults;
+		return ToReadResults(ReadBarcodes(iv, MakeHints(tryHarder, format, maxSymbols)));
 	} catch (const std::exception& e) {
 		return {{"", "", {}, e.what()}};
 	} catch (...) {
@@ -67,6 +75,67 @@ std::vector<ReadResult> readBarcodes(ImageView iv, bool tryHarder, const std::st
 	return {};
 }
 
+/**
+ * A ReaderSession is meant for decoding a stream of (camera) frames. It keeps the decoder state and a pixel buffer
+ * on the wasm heap alive between calls: JavaScript asks for the buffer once per frame size via buffer(), writes the
+ * pixels directly into Module.HEAPU8 at that address and calls read(). This saves the malloc/free pair and the heap
+ * growth checks per frame. Note: with ALLOW_MEMORY_GROWTH the HEAPU8 view has to be looked up again after every call
+ * into the module, the address itself stays valid until the frame size changes.
+ *
+ * The buffer holds either RGBA pixels (e.g. ImageData, 4 channels) or plain luminance values (1 channel), e.g. the
+ * output of a WebGL shader that already did the gray scale conversion and downscaling, which cuts the amount of data
+ * to copy into the heap by a factor of 4 (or more).
+ */
+class ReaderSession
+{
+	BarcodeReader _reader;
+	std::vector<uint8_t> _pixels;
+	int _width = 0, _height = 0;
+	ImageFormat _format = ImageFormat::RGBX;
+
+	static DecodeHints SessionHints(bool tryHarder, const std::string& format, int maxSymbols, int threads)
+	{
+		auto hints = MakeHints(tryHarder, format, maxSymbols);
+#ifdef __EMSCRIPTEN_PTHREADS__
+		hints.setThreads(threads);
+#else
+		(void)threads; // without pthreads support there is only the main thread
+#endif
+		return hints;
+	}
+
+public:
+	ReaderSession(bool tryHarder, std::string format, int maxSymbols, int threads)
+		: _reader(SessionHints(tryHarder, format, maxSymbols, threads))
+	{}
+
+	int buffer(int width, int height, int channels)
+	{
+		if (width <= 0 || height <= 0 || (channels != 1 && channels != 4))
+			return 0;
+		_width = width;
+		_height = height;
+		_format = channels == 1 ? ImageFormat::Lum : ImageFormat::RGBX;
+		_pixels.resize(channels * size_t(width) * height);
+		return reinterpret_cast<int>(_pixels.data());
+	}
+
+	int buffer(int width, int height) { return buffer(width, height, 4); }
+
+	std::vector<ReadResult> read()
+	{
+		try {
+			if (_pixels.empty())
+				return {{"", "", {}, "No pixel buffer, call buffer(width, height) first"}};
+			return ToReadResults(_reader.read({_pixels.data(), _width, _height, _format}));
+		} catch (const std::exception& e) {
+			return {{"", "", {}, e.what()}};
+		} catch (...) {
+			return {{"", "", {}, "Unknown error"}};
+		}
+	}
+};
+
 std::vector<ReadResult> readBarcodesFromImage(int bufferPtr, int bufferLength, bool tryHarder, std::string format, int maxSymbols)
 {
 	int width, height, channels;
@@ -94,6 +163,12 @@ ReadResult readBarcodeFromPixmap(int bufferPtr, int imgWidth, int imgHeight, boo
 	return FirstOrDefault(readBarcodesFromPixmap(bufferPtr, imgWidth, imgHeight, tryHarder, format, 1));
 }
 
+std::vector<ReadResult> readBarcodesFromLuminance(int bufferPtr, int imgWidth, int imgHeight, bool tryHarder, std::string format,
+												  int maxSymbols)
+{
+	return readBarcodes({reinterpret_cast<uint8_t*>(bufferPtr), imgWidth, imgHeight, ImageFormat::Lum}, tryHarder, format, maxSymbols);
+}
+
 EMSCRIPTEN_BINDINGS(BarcodeReader)
 {
 	using namespace emscripten;
@@ -121,4 +196,11 @@ EMSCRIPTEN_BINDINGS(BarcodeReader)
 
 	function("readBarcodesFromImage", &readBarcodesFromImage);
 	function("readBarcodesFromPixmap", &readBarcodesFromPixmap);
+	function("readBarcodesFromLuminance", &readBarcodesFromLuminance);
+
+	class_<ReaderSession>("ReaderSession")
+		.constructor<bool, std::string, int, int>()
+		.function("buffer", select_overload<int(int, int)>(&ReaderSession::buffer))
+		.function("buffer", select_overload<int(int, int, int)>(&ReaderSession::buffer))
+		.function("read", &ReaderSession::read);
 };
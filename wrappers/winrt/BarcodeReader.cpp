@@ -17,12 +17,15 @@
 #include "Utf.h"
 
 #include <algorithm>
+#include <collection.h>
 #include <MemoryBuffer.h>
+#include <ppltasks.h>
 #include <stdexcept>
 #include <wrl.h>
 
 using namespace Microsoft::WRL;
 using namespace Windows::Foundation;
+using namespace Windows::Foundation::Collections;
 using namespace Windows::Graphics::Imaging;
 
 namespace ZXing {
@@ -154,44 +157,61 @@ static Platform::String^ ToPlatformString(const std::string& str)
 	return ref new Platform::String(wstr.c_str(), (unsigned)wstr.length());
 }
 
+static ImageFormat ImageFormatFromBitmap(BitmapPixelFormat format)
+{
+	switch (format) {
+	case BitmapPixelFormat::Gray8: return ImageFormat::Lum;
+	case BitmapPixelFormat::Bgra8: return ImageFormat::BGRX;
+	case BitmapPixelFormat::Rgba8: return ImageFormat::RGBX;
+	case BitmapPixelFormat::Nv12: return ImageFormat::NV12; // plane 0 holds the Y samples
+	case BitmapPixelFormat::Yuy2: return ImageFormat::YUYV;
+	default: throw std::runtime_error("Unsupported BitmapPixelFormat");
+	}
+}
+
+// Reads directly from the locked buffer of the bitmap, i.e. without any format conversion or copy.
+static Results ReadBitmap(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight, const DecodeHints& hints)
+{
+	cropWidth = cropWidth <= 0 ? bitmap->PixelWidth : std::min(bitmap->PixelWidth, cropWidth);
+	cropHeight = cropHeight <= 0 ? bitmap->PixelHeight : std::min(bitmap->PixelHeight, cropHeight);
+	int cropLeft = (bitmap->PixelWidth - cropWidth) / 2;
+	int cropTop = (bitmap->PixelHeight - cropHeight) / 2;
+
+	ImageFormat fmt = ImageFormatFromBitmap(bitmap->BitmapPixelFormat);
+
+	auto inBuffer = bitmap->LockBuffer(BitmapBufferAccessMode::Read);
+	auto inMemRef = inBuffer->CreateReference();
+	ComPtr<IMemoryBufferByteAccess> inBufferAccess;
+
+	if (FAILED(ComPtr<IUnknown>(reinterpret_cast<IUnknown*>(inMemRef)).As(&inBufferAccess)))
+		throw std::runtime_error("Failed to read bitmap's data");
+
+	BYTE* inBytes = nullptr;
+	UINT32 inCapacity = 0;
+	inBufferAccess->GetBuffer(&inBytes, &inCapacity);
+
+	auto plane = inBuffer->GetPlaneDescription(0);
+	auto img = ImageView(inBytes + plane.StartIndex, plane.Width, plane.Height, fmt, plane.Stride)
+				   .cropped(cropLeft, cropTop, cropWidth, cropHeight);
+
+	return ReadBarcodes(img, hints);
+}
+
+ReadResult^ BarcodeReader::ConvertResult(const Result& result)
+{
+	return ref new ReadResult(ToPlatformString(ZXing::ToString(result.format())), ToPlatformString(result.text()),
+							  ConvertNativeToRuntime(result.format()));
+}
+
 ReadResult^
 BarcodeReader::Read(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
 {
 	try {
-		cropWidth = cropWidth <= 0 ? bitmap->PixelWidth : std::min(bitmap->PixelWidth, cropWidth);
-		cropHeight = cropHeight <= 0 ? bitmap->PixelHeight : std::min(bitmap->PixelHeight, cropHeight);
-		int cropLeft = (bitmap->PixelWidth - cropWidth) / 2;
-		int cropTop = (bitmap->PixelHeight - cropHeight) / 2;
-
-		auto inBuffer = bitmap->LockBuffer(BitmapBufferAccessMode::Read);
-		auto inMemRef = inBuffer->CreateReference();
-		ComPtr<IMemoryBufferByteAccess> inBufferAccess;
-
-		if (SUCCEEDED(ComPtr<IUnknown>(reinterpret_cast<IUnknown*>(inMemRef)).As(&inBufferAccess))) {
-			BYTE* inBytes = nullptr;
-			UINT32 inCapacity = 0;
-			inBufferAccess->GetBuffer(&inBytes, &inCapacity);
-
-			ImageFormat fmt = ImageFormat::None;
-			switch (bitmap->BitmapPixelFormat)
-			{
-			case BitmapPixelFormat::Gray8: fmt = ImageFormat::Lum; break;
-			case BitmapPixelFormat::Bgra8: fmt = ImageFormat::BGRX; break;
-			case BitmapPixelFormat::Rgba8: fmt = ImageFormat::RGBX; break;
-			default:
-				throw std::runtime_error("Unsupported BitmapPixelFormat");
-			}
-
-			auto img = ImageView(inBytes, bitmap->PixelWidth, bitmap->PixelHeight, fmt, inBuffer->GetPlaneDescription(0).Stride)
-						   .cropped(cropLeft, cropTop, cropWidth, cropHeight);
-
-			auto result = ReadBarcode(img, *m_hints);
-			if (result.isValid()) {
-				return ref new ReadResult(ToPlatformString(ZXing::ToString(result.format())), ToPlatformString(result.text()), ConvertNativeToRuntime(result.format()));
-			}
-		} else {
-			throw std::runtime_error("Failed to read bitmap's data");
-		}
+		DecodeHints hints = *m_hints;
+		hints.setMaxNumberOfSymbols(1);
+		auto results = ReadBitmap(bitmap, cropWidth, cropHeight, hints);
+		if (!results.empty() && results.front().isValid())
+			return ConvertResult(results.front());
 	}
 	catch (const std::exception& e) {
 		OutputDebugStringA(e.what());
@@ -201,4 +221,30 @@ BarcodeReader::Read(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
 	return nullptr;
 }
 
+IAsyncOperation<IVectorView<ReadResult^>^>^
+BarcodeReader::ReadBarcodesAsync(SoftwareBitmap^ bitmap, int cropWidth, int cropHeight)
+{
+	DecodeHints hints = *m_hints;
+	return concurrency::create_async([bitmap, cropWidth, cropHeight, hints](concurrency::cancellation_token ct) {
+		// the core can not be interrupted once it runs, so a cancellation is honored before and after the decoding
+		if (ct.is_canceled())
+			concurrency::cancel_current_task();
+
+		auto readResults = ref new Platform::Collections::Vector<ReadResult^>();
+		try {
+			for (auto& result : ReadBitmap(bitmap, cropWidth, cropHeight, hints))
+				if (result.isValid())
+					readResults->Append(ConvertResult(result));
+		}
+		catch (const std::exception& e) {
+			OutputDebugStringA(e.what());
+		}
+
+		if (ct.is_canceled())
+			concurrency::cancel_current_task();
+
+		return readResults->GetView();
+	});
+}
+
 } // ZXing
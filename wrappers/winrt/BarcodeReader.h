@@ -32,6 +32,7 @@ public enum class BarcodeType : int {
 };
 
 class DecodeHints;
+class Result;
 ref class ReadResult;
 
 public ref class BarcodeReader sealed
@@ -43,6 +44,10 @@ public:
 
 	ReadResult^ Read(Windows::Graphics::Imaging::SoftwareBitmap^ bitmap, int cropWidth, int cropHeight);
 
+	// Reads all barcodes on the thread pool. Supports Gray8, Bgra8, Rgba8, Nv12 and Yuy2 bitmaps (read in place).
+	Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<ReadResult^>^>^
+	ReadBarcodesAsync(Windows::Graphics::Imaging::SoftwareBitmap^ bitmap, int cropWidth, int cropHeight);
+
 private:
 	~BarcodeReader();
 
@@ -50,6 +55,7 @@ private:
 
 	static BarcodeFormat ConvertRuntimeToNative(BarcodeType type);
 	static BarcodeType ConvertNativeToRuntime(BarcodeFormat format);
+	static ReadResult^ ConvertResult(const Result& result);
 
 	std::unique_ptr<DecodeHints> m_hints;
 };